@@ -0,0 +1,186 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * bm-fixture.h: the set up the xlator benchmarks here share.  A benchmark
+ *               gets a process context with the pools fops need, then
+ *               loads the xlator it measures between bm_top, from which
+ *               it winds, and, if it gives sink fops, bm_sink below:
+ *
+ *               ctx = bm_ctx_new ();
+ *               xl = bm_xlator_new (ctx, "wb-bm", "performance/write-behind",
+ *                                   &sink_fops, "cache-size", "1MB", NULL);
+ *               ...
+ *               bm_xlator_fini (xl);
+ *
+ *               It is included rather than linked, so that each benchmark
+ *               still builds with a single gcc command.
+ */
+
+#ifndef _BM_FIXTURE_H
+#define _BM_FIXTURE_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "glusterfs.h"
+#include "globals.h"
+#include "xlator.h"
+#include "stack.h"
+#include "call-stub.h"
+#include "mem-pool.h"
+#include "iobuf.h"
+#include "event.h"
+
+static glusterfs_graph_t   bm_graph;
+static xlator_t            bm_top;
+static xlator_t            bm_sink;
+static struct xlator_cbks  bm_sink_cbks;
+
+static inline double
+bm_now (void)
+{
+        struct timeval tv = {0,};
+
+        gettimeofday (&tv, NULL);
+        return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* a context with the pools of a glusterfs process, and without memory
+ * accounting, which is not what is measured */
+static inline glusterfs_ctx_t *
+bm_ctx_new (void)
+{
+        glusterfs_ctx_t *ctx = NULL;
+
+        gf_global_mem_acct_enable_set (0);
+
+        ctx = glusterfs_ctx_new ();
+        if (!ctx || glusterfs_globals_init (ctx))
+                return NULL;
+        THIS->ctx = ctx;
+
+        ctx->pool = GF_CALLOC (1, sizeof (call_pool_t), gf_common_mt_char);
+        if (!ctx->pool)
+                return NULL;
+
+        INIT_LIST_HEAD (&ctx->pool->all_frames);
+        LOCK_INIT (&ctx->pool->lock);
+
+        ctx->pool->frame_mem_pool = mem_pool_new (call_frame_t, 4096);
+        ctx->pool->stack_mem_pool = mem_pool_new (call_stack_t, 1024);
+        ctx->stub_mem_pool = mem_pool_new (call_stub_t, 1024);
+        ctx->dict_pool = mem_pool_new (dict_t, 1024);
+        ctx->dict_pair_pool = mem_pool_new (data_pair_t, 1024);
+        ctx->dict_data_pool = mem_pool_new (data_t, 1024);
+        ctx->logbuf_pool = mem_pool_new (log_buf_t, 256);
+        ctx->iobuf_pool = iobuf_pool_new ();
+        ctx->event_pool = event_pool_new (16384, 1);
+        if (!ctx->pool->frame_mem_pool || !ctx->pool->stack_mem_pool ||
+            !ctx->stub_mem_pool || !ctx->dict_pool || !ctx->dict_pair_pool ||
+            !ctx->dict_data_pool || !ctx->logbuf_pool || !ctx->iobuf_pool ||
+            !ctx->event_pool)
+                return NULL;
+
+        return ctx;
+}
+
+/* Loads and inits @type as bm_top's child, on top of bm_sink if
+ * @sink_fops is given. The options follow as key, value pairs, ending
+ * with NULL. */
+static inline xlator_t *
+bm_xlator_new (glusterfs_ctx_t *ctx, const char *name, const char *type,
+               struct xlator_fops *sink_fops, ...)
+{
+        xlator_t      *xl     = NULL;
+        xlator_list_t *child  = NULL;
+        xlator_list_t *parent = NULL;
+        const char    *key    = NULL;
+        const char    *value  = NULL;
+        va_list        ap;
+
+        bm_graph.xl_count = sink_fops ? 3 : 2;
+
+        bm_top.name = (char *)name;
+        bm_top.type = "bm/top";
+        bm_top.ctx = ctx;
+        bm_top.graph = &bm_graph;
+        bm_top.xl_id = 0;
+
+        xl = GF_CALLOC (1, sizeof (*xl), gf_common_mt_xlator_t);
+        parent = GF_CALLOC (1, sizeof (*parent), gf_common_mt_xlator_list_t);
+        if (!xl || !parent)
+                return NULL;
+
+        if (gf_asprintf (&xl->name, "%s-%s", name,
+                         strrchr (type, '/') + 1) < 0)
+                return NULL;
+        xl->ctx = ctx;
+        xl->graph = &bm_graph;
+        xl->xl_id = 1;
+        if (xlator_set_type (xl, type)) {
+                fprintf (stderr, "cannot load %s\n", type);
+                return NULL;
+        }
+
+        xl->options = dict_new ();
+        if (!xl->options)
+                return NULL;
+
+        va_start (ap, sink_fops);
+        while ((key = va_arg (ap, const char *))) {
+                value = va_arg (ap, const char *);
+                if (dict_set_dynstr_with_alloc (xl->options, (char *)key,
+                                                value)) {
+                        va_end (ap);
+                        return NULL;
+                }
+        }
+        va_end (ap);
+
+        if (sink_fops) {
+                if (gf_asprintf (&bm_sink.name, "%s-sink", name) < 0)
+                        return NULL;
+                bm_sink.type = "bm/sink";
+                bm_sink.ctx = ctx;
+                bm_sink.fops = sink_fops;
+                bm_sink.cbks = &bm_sink_cbks;
+                bm_sink.graph = &bm_graph;
+                bm_sink.xl_id = 2;
+
+                child = GF_CALLOC (1, sizeof (*child),
+                                   gf_common_mt_xlator_list_t);
+                if (!child)
+                        return NULL;
+                child->xlator = &bm_sink;
+                xl->children = child;
+        }
+
+        parent->xlator = &bm_top;
+        xl->parents = parent;
+
+        if (xlator_init (xl)) {
+                fprintf (stderr, "%s init failed\n", type);
+                return NULL;
+        }
+
+        return xl;
+}
+
+static inline void
+bm_xlator_fini (xlator_t *xl)
+{
+        fflush (stdout);
+        xl->fini (xl);
+}
+
+#endif /* _BM_FIXTURE_H */
@@ -0,0 +1,205 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * changelog-bm: creates per second through features/changelog from several
+ *               threads, with changelog off, on, on with group commit and
+ *               on with group commit not waiting for the records to be
+ *               written.  Every create is an entry record, so each one is
+ *               appended to the journal.  The child completes the creates at
+ *               once, what is measured is the cost of journaling them.
+ *
+ * gcc -O2 -pthread changelog-bm.c -I<srcdir>/libglusterfs/src -I<builddir> \
+ *     -include config.h -DGF_LINUX_HOST_OS -lglusterfs -o changelog-bm
+ *
+ * ./changelog-bm <brick dir> [threads] [creates per thread] \
+ *                [changelog on|off] [group-commit on|off] \
+ *                [group-commit-delay msecs]
+ *
+ * changelog.so is loaded from XLATORDIR and listens on a socket for its
+ * consumers, so glusterfs must be installed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bm-fixture.h"
+
+#define DEFAULT_THREADS  8
+#define DEFAULT_CREATES  100000
+
+struct bm_thread {
+        pthread_t        thread;
+        int              id;
+        inode_table_t   *table;
+};
+
+static xlator_t           *changelog;
+static long                creates = DEFAULT_CREATES;
+
+static int32_t
+sink_create (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+             mode_t mode, mode_t umask, fd_t *fd, dict_t *xdata)
+{
+        struct iatt buf = {0,};
+
+        buf.ia_type = IA_IFREG;
+        STACK_UNWIND_STRICT (create, frame, 0, 0, fd, loc->inode, &buf,
+                             &buf, &buf, NULL);
+        return 0;
+}
+
+static struct xlator_fops  sink_fops = {
+        .create = sink_create,
+};
+
+static int32_t
+bm_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+        int32_t op_errno, ...)
+{
+        if (op_ret < 0) {
+                fprintf (stderr, "fop failed: %s\n", strerror (op_errno));
+                exit (1);
+        }
+
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+/* the sink completes in the winding thread, so each create is done by the
+   time STACK_WIND returns */
+static void *
+bm_creator (void *data)
+{
+        struct bm_thread *t     = data;
+        call_frame_t     *frame = NULL;
+        inode_t          *inode = NULL;
+        fd_t             *fd    = NULL;
+        dict_t           *xdata = NULL;
+        loc_t             loc   = {0,};
+        uuid_t            gfid  = {0,};
+        char              name[64];
+        long              i     = 0;
+
+        inode = inode_new (t->table);
+        fd = inode ? fd_create (inode, O_RDWR) : NULL;
+        xdata = dict_new ();
+        if (!fd || !xdata ||
+            dict_set_static_bin (xdata, "gfid-req", gfid, sizeof (gfid))) {
+                fprintf (stderr, "out of memory\n");
+                exit (1);
+        }
+
+        loc.inode = inode;
+        loc.pargfid[15] = 1;
+        loc.name = name;
+        loc.path = name;
+
+        for (i = 0; i < creates; i++) {
+                snprintf (name, sizeof (name), "bm-%d-%ld", t->id, i);
+                gf_uuid_generate (gfid);
+
+                frame = create_frame (&bm_top, bm_top.ctx->pool);
+                if (!frame) {
+                        fprintf (stderr, "out of memory\n");
+                        exit (1);
+                }
+                frame->root->op = GF_FOP_CREATE;
+
+                STACK_WIND (frame, (fop_create_cbk_t) bm_cbk, changelog,
+                            changelog->fops->create, &loc, O_CREAT | O_RDWR,
+                            0644, 0022, fd, xdata);
+        }
+
+        dict_unref (xdata);
+        fd_unref (fd);
+        inode_unref (inode);
+
+        return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t  *ctx          = NULL;
+        inode_table_t    *table        = NULL;
+        struct bm_thread *threads      = NULL;
+        const char       *brick        = NULL;
+        const char       *active       = "on";
+        const char       *group_commit = "on";
+        const char       *delay        = "0";
+        long              nthreads     = DEFAULT_THREADS;
+        double            start        = 0;
+        double            elapsed      = 0;
+        long              i            = 0;
+        char              dir[PATH_MAX];
+
+        if (argc > 1)
+                brick = argv[1];
+        if (argc > 2)
+                nthreads = strtol (argv[2], NULL, 0);
+        if (argc > 3)
+                creates = strtol (argv[3], NULL, 0);
+        if (argc > 4)
+                active = argv[4];
+        if (argc > 5)
+                group_commit = argv[5];
+        if (argc > 6)
+                delay = argv[6];
+
+        if (!brick || nthreads < 1 || creates < 1) {
+                fprintf (stderr, "usage: %s <brick dir> [threads] "
+                         "[creates per thread] [changelog on|off] "
+                         "[group-commit on|off] [group-commit-delay msecs]\n",
+                         argv[0]);
+                return 1;
+        }
+
+        snprintf (dir, sizeof (dir), "%s/.glusterfs/changelogs", brick);
+
+        /* top -> changelog -> sink */
+        ctx = bm_ctx_new ();
+        changelog = ctx ? bm_xlator_new (ctx, "changelog-bm",
+                                         "features/changelog", &sink_fops,
+                                         "changelog-brick", brick,
+                                         "changelog-dir", dir,
+                                         "changelog", active,
+                                         "group-commit", group_commit,
+                                         "group-commit-delay", delay,
+                                         NULL) : NULL;
+        if (!changelog)
+                return 1;
+
+        table = inode_table_new (0, &bm_top);
+        threads = calloc (nthreads, sizeof (*threads));
+        if (!table || !threads)
+                return 1;
+
+        start = bm_now ();
+        for (i = 0; i < nthreads; i++) {
+                threads[i].id = i;
+                threads[i].table = table;
+                if (pthread_create (&threads[i].thread, NULL, bm_creator,
+                                    &threads[i]))
+                        return 1;
+        }
+        for (i = 0; i < nthreads; i++)
+                pthread_join (threads[i].thread, NULL);
+        elapsed = bm_now () - start;
+
+        printf ("changelog %-3s group-commit %-3s delay %-4s: %ld threads, "
+                "%ld creates in %.3fs, %.0f creates/s\n", active,
+                group_commit, delay, nthreads, nthreads * creates, elapsed,
+                nthreads * creates / elapsed);
+
+        return 0;
+}
@@ -0,0 +1,266 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * dict-bm: measures serialize/unserialize throughput of a typical fop xdata
+ *          dict, in the original and in the compact wire format, and the
+ *          cost of dict_set/dict_get/dict_copy/dict_foreach on dicts of
+ *          typical sizes.
+ *
+ * gcc -O2 -o dict-bm dict-bm.c -I<srcdir>/libglusterfs/src -I<builddir> \
+ *     -include config.h -DGF_LINUX_HOST_OS -lglusterfs
+ *
+ * ./dict-bm [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "glusterfs.h"
+#include "globals.h"
+#include "dict.h"
+#include "mem-pool.h"
+
+#define DEFAULT_ITERATIONS 200000
+#define MAX_KEYS           32
+
+typedef int32_t (*serialize_fn) (dict_t *, char **, u_int *);
+
+static double
+now (void)
+{
+        struct timeval tv = {0,};
+
+        gettimeofday (&tv, NULL);
+        return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* what a replicated, quota enabled lookup carries in its xdata */
+static dict_t *
+xdata_new (void)
+{
+        dict_t        *xdata = NULL;
+        static char    gfid[16] = {0x7e, 0x11, };
+        static char    pending[12];
+        static char    quota[24];
+
+        xdata = dict_new ();
+        if (!xdata)
+                return NULL;
+
+        dict_set_static_bin (xdata, "gfid-req", gfid, sizeof (gfid));
+        dict_set_static_bin (xdata, "trusted.afr.patchy-client-0", pending,
+                             sizeof (pending));
+        dict_set_static_bin (xdata, "trusted.afr.patchy-client-1", pending,
+                             sizeof (pending));
+        dict_set_static_bin (xdata, "trusted.afr.dirty", pending,
+                             sizeof (pending));
+        dict_set_int32 (xdata, "glusterfs.inodelk-count", 0);
+        dict_set_int32 (xdata, "glusterfs.entrylk-count", 0);
+        dict_set_int32 (xdata, "glusterfs.parent-entrylk", 0);
+        dict_set_int32 (xdata, "link-count", 1);
+        dict_set_static_bin (xdata, "trusted.glusterfs.quota.size", quota,
+                             sizeof (quota));
+        dict_set_int32 (xdata, "trusted.glusterfs.dht.linkto", 0);
+        dict_set_str (xdata, "bm.unknown-key", "value");
+
+        return xdata;
+}
+
+static int
+same (dict_t *a, dict_t *b)
+{
+        data_pair_t *pair  = NULL;
+        data_t      *value = NULL;
+
+        if (a->count != b->count)
+                return 0;
+
+        for (pair = a->members_list; pair; pair = pair->next) {
+                value = dict_get (b, pair->key);
+                if (!value || !is_data_equal (value, pair->value))
+                        return 0;
+        }
+
+        return 1;
+}
+
+static int
+run (const char *name, dict_t *xdata, serialize_fn serialize, long count)
+{
+        char     *buf   = NULL;
+        u_int     len   = 0;
+        dict_t   *fill  = NULL;
+        double    start = 0;
+        double    ser   = 0;
+        double    unser = 0;
+        long      i     = 0;
+
+        for (i = 0; i < count; i++) {
+                start = now ();
+                if (serialize (xdata, &buf, &len) < 0) {
+                        fprintf (stderr, "%s: serialize failed\n", name);
+                        return -1;
+                }
+                ser += now () - start;
+
+                fill = dict_new ();
+                start = now ();
+                if (dict_unserialize (buf, len, &fill) < 0) {
+                        fprintf (stderr, "%s: unserialize failed\n", name);
+                        return -1;
+                }
+                unser += now () - start;
+
+                if (i == 0 && !same (xdata, fill)) {
+                        fprintf (stderr, "%s: dict changed on the way\n", name);
+                        return -1;
+                }
+
+                dict_unref (fill);
+                GF_FREE (buf);
+        }
+
+        printf ("%-8s %6u bytes  serialize %10.0f/s  unserialize %10.0f/s\n",
+                name, len, count / ser, count / unser);
+
+        return 0;
+}
+
+static int
+count_one (dict_t *d, char *key, data_t *value, void *data)
+{
+        (*(int *)data)++;
+        return 0;
+}
+
+/* ns per operation for a dict of @nkeys keys built from @keys */
+static int
+run_ops (char **keys, int nkeys, long count)
+{
+        dict_t   *d     = NULL;
+        dict_t   *copy  = NULL;
+        data_t   *value = NULL;
+        double    start = 0;
+        double    set   = 0;
+        double    get   = 0;
+        double    cp    = 0;
+        double    each  = 0;
+        long      i     = 0;
+        int       j     = 0;
+        int       seen  = 0;
+
+        for (i = 0; i < count; i++) {
+                d = dict_new ();
+
+                start = now ();
+                for (j = 0; j < nkeys; j++)
+                        dict_set_int32 (d, keys[j], j);
+                set += now () - start;
+
+                start = now ();
+                for (j = 0; j < nkeys; j++) {
+                        value = dict_get (d, keys[j]);
+                        if (!value || data_to_int32 (value) != j) {
+                                fprintf (stderr, "%d keys: lost %s\n", nkeys,
+                                         keys[j]);
+                                return -1;
+                        }
+                }
+                get += now () - start;
+
+                start = now ();
+                copy = dict_copy_with_ref (d, NULL);
+                cp += now () - start;
+
+                seen = 0;
+                start = now ();
+                dict_foreach (copy, count_one, &seen);
+                each += now () - start;
+
+                if (seen != nkeys) {
+                        fprintf (stderr, "%d keys: copy has %d\n", nkeys,
+                                 seen);
+                        return -1;
+                }
+
+                dict_unref (copy);
+                dict_unref (d);
+        }
+
+        printf ("%2d keys  set %6.1f ns  get %6.1f ns  copy %7.1f ns  "
+                "foreach %6.1f ns\n", nkeys, set * 1e9 / count / nkeys,
+                get * 1e9 / count / nkeys, cp * 1e9 / count,
+                each * 1e9 / count);
+
+        return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t *ctx   = NULL;
+        dict_t          *xdata = NULL;
+        long             count = DEFAULT_ITERATIONS;
+        char            *keys[MAX_KEYS];
+        data_pair_t     *pair  = NULL;
+        int              nkeys = 0;
+        int              sizes[] = {4, 8, 32};
+        int              i     = 0;
+
+        if (argc > 1)
+                count = strtol (argv[1], NULL, 0);
+
+        /* measure the dict code, not the memory accounting */
+        gf_global_mem_acct_enable_set (0);
+
+        ctx = glusterfs_ctx_new ();
+        if (!ctx || glusterfs_globals_init (ctx))
+                return 1;
+        THIS->ctx = ctx;
+
+        ctx->dict_pool = mem_pool_new (dict_t, 1024);
+        ctx->dict_pair_pool = mem_pool_new (data_pair_t, 1024);
+        ctx->dict_data_pool = mem_pool_new (data_t, 1024);
+        ctx->logbuf_pool = mem_pool_new (log_buf_t, 256);
+        if (!ctx->dict_pool || !ctx->dict_pair_pool || !ctx->dict_data_pool ||
+            !ctx->logbuf_pool)
+                return 1;
+
+        xdata = xdata_new ();
+        if (!xdata)
+                return 1;
+
+        if (run ("legacy", xdata, dict_allocate_and_serialize, count) ||
+            run ("compact", xdata, dict_allocate_and_serialize_compact, count))
+                return 1;
+
+        /* the xdata keys first, then made up ones */
+        for (pair = xdata->members_list; pair && nkeys < MAX_KEYS;
+             pair = pair->next)
+                keys[nkeys++] = gf_strdup (pair->key);
+        while (nkeys < MAX_KEYS) {
+                if (gf_asprintf (&keys[nkeys], "bm.key-%d", nkeys) < 0)
+                        return 1;
+                nkeys++;
+        }
+
+        for (i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+                if (run_ops (keys, sizes[i], count))
+                        return 1;
+
+        for (i = 0; i < nkeys; i++)
+                GF_FREE (keys[i]);
+        dict_unref (xdata);
+
+        return 0;
+}
@@ -0,0 +1,241 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * iot-bm: drives performance/io-threads from several submitting threads
+ *         with fops that complete as soon as they reach the child, so that
+ *         what is measured is the queueing and dispatching done by
+ *         io-threads itself.  A third of the fops are high priority (stat),
+ *         a third normal (setattr) and a third low (truncate).
+ *
+ * gcc -O2 -pthread iot-bm.c -I<srcdir>/libglusterfs/src -I<builddir> \
+ *     -include config.h -DGF_LINUX_HOST_OS -lglusterfs -o iot-bm
+ *
+ * ./iot-bm [submitters] [fops per submitter] [thread-count] [in flight]
+ *
+ * io-threads.so is loaded from XLATORDIR, so glusterfs must be installed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "bm-fixture.h"
+
+#define DEFAULT_SUBMITTERS   4
+#define DEFAULT_FOPS         200000
+#define DEFAULT_THREADS      "16"
+#define DEFAULT_INFLIGHT     32
+
+struct submitter {
+        pthread_t        thread;
+        pthread_mutex_t  lock;
+        pthread_cond_t   cond;
+        long             inflight;
+        long             done;
+        uint64_t         queue_delay;
+};
+
+static xlator_t  *iot;
+static long       fops_per_submitter = DEFAULT_FOPS;
+static long       max_inflight = DEFAULT_INFLIGHT;
+
+static int32_t
+sink_stat (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+        struct iatt buf = {0,};
+
+        STACK_UNWIND_STRICT (stat, frame, 0, 0, &buf, NULL);
+        return 0;
+}
+
+static int32_t
+sink_setattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+              struct iatt *stbuf, int32_t valid, dict_t *xdata)
+{
+        struct iatt buf = {0,};
+
+        STACK_UNWIND_STRICT (setattr, frame, 0, 0, &buf, &buf, NULL);
+        return 0;
+}
+
+static int32_t
+sink_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
+               dict_t *xdata)
+{
+        struct iatt buf = {0,};
+
+        STACK_UNWIND_STRICT (truncate, frame, 0, 0, &buf, &buf, NULL);
+        return 0;
+}
+
+static struct xlator_fops  sink_fops = {
+        .stat     = sink_stat,
+        .setattr  = sink_setattr,
+        .truncate = sink_truncate,
+};
+
+static void
+bm_done (call_frame_t *frame)
+{
+        struct submitter *s = frame->local;
+
+        frame->local = NULL;
+
+        pthread_mutex_lock (&s->lock);
+        {
+                s->queue_delay += frame->root->queue_delay;
+                s->inflight--;
+                s->done++;
+                pthread_cond_signal (&s->cond);
+        }
+        pthread_mutex_unlock (&s->lock);
+
+        STACK_DESTROY (frame->root);
+}
+
+static int32_t
+bm_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, struct iatt *buf,
+             dict_t *xdata)
+{
+        bm_done (frame);
+        return 0;
+}
+
+static int32_t
+bm_attr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, struct iatt *pre,
+             struct iatt *post, dict_t *xdata)
+{
+        bm_done (frame);
+        return 0;
+}
+
+static void *
+submit (void *data)
+{
+        struct submitter *s     = data;
+        call_frame_t     *frame = NULL;
+        loc_t             loc   = {0,};
+        struct iatt       attr  = {0,};
+        long              i     = 0;
+
+        loc.path = "/iot-bm";
+        loc.name = "iot-bm";
+
+        for (i = 0; i < fops_per_submitter; i++) {
+                pthread_mutex_lock (&s->lock);
+                {
+                        while (s->inflight >= max_inflight)
+                                pthread_cond_wait (&s->cond, &s->lock);
+                        s->inflight++;
+                }
+                pthread_mutex_unlock (&s->lock);
+
+                frame = create_frame (&bm_top, bm_top.ctx->pool);
+                if (!frame) {
+                        fprintf (stderr, "out of frames\n");
+                        exit (1);
+                }
+                frame->local = s;
+
+                switch (i % 3) {
+                case 0:
+                        STACK_WIND (frame, bm_stat_cbk, iot, iot->fops->stat,
+                                    &loc, NULL);
+                        break;
+                case 1:
+                        STACK_WIND (frame, bm_attr_cbk, iot,
+                                    iot->fops->setattr, &loc, &attr,
+                                    GF_SET_ATTR_MODE, NULL);
+                        break;
+                default:
+                        STACK_WIND (frame, bm_attr_cbk, iot,
+                                    iot->fops->truncate, &loc, 0, NULL);
+                        break;
+                }
+        }
+
+        pthread_mutex_lock (&s->lock);
+        {
+                while (s->inflight)
+                        pthread_cond_wait (&s->cond, &s->lock);
+        }
+        pthread_mutex_unlock (&s->lock);
+
+        return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t   *ctx        = NULL;
+        struct submitter  *submitters = NULL;
+        const char        *threads    = DEFAULT_THREADS;
+        int                count      = DEFAULT_SUBMITTERS;
+        double             start      = 0;
+        double             elapsed    = 0;
+        long               done       = 0;
+        uint64_t           delay      = 0;
+        int                i          = 0;
+
+        if (argc > 1)
+                count = strtol (argv[1], NULL, 0);
+        if (argc > 2)
+                fops_per_submitter = strtol (argv[2], NULL, 0);
+        if (argc > 3)
+                threads = argv[3];
+        if (argc > 4)
+                max_inflight = strtol (argv[4], NULL, 0);
+
+        if (count < 1 || fops_per_submitter < 1 || max_inflight < 1) {
+                fprintf (stderr, "usage: %s [submitters] [fops per "
+                         "submitter] [thread-count] [in flight]\n", argv[0]);
+                return 1;
+        }
+
+        /* top -> io-threads -> sink */
+        ctx = bm_ctx_new ();
+        iot = ctx ? bm_xlator_new (ctx, "iot-bm", "performance/io-threads",
+                                   &sink_fops, "thread-count", threads,
+                                   NULL) : NULL;
+        if (!iot)
+                return 1;
+
+        submitters = GF_CALLOC (count, sizeof (*submitters),
+                                gf_common_mt_char);
+        if (!submitters)
+                return 1;
+
+        start = bm_now ();
+        for (i = 0; i < count; i++) {
+                pthread_mutex_init (&submitters[i].lock, NULL);
+                pthread_cond_init (&submitters[i].cond, NULL);
+                if (pthread_create (&submitters[i].thread, NULL, submit,
+                                    &submitters[i]))
+                        return 1;
+        }
+
+        for (i = 0; i < count; i++) {
+                pthread_join (submitters[i].thread, NULL);
+                done += submitters[i].done;
+                delay += submitters[i].queue_delay;
+        }
+        elapsed = bm_now () - start;
+
+        printf ("%2d submitters  %s threads  %10.0f fops/s  "
+                "queue delay %8.1f us\n", count, threads, done / elapsed,
+                (double)delay / done);
+
+        bm_xlator_fini (iot);
+
+        return 0;
+}
@@ -0,0 +1,344 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * iot-xattrop-bm: the fops a brick sees for replicated writes, driven
+ *                 through performance/io-threads.  Each transaction is
+ *                 finodelk, fxattrop, writev, fxattrop and finodelk again
+ *                 on one of a few hot files, with many transactions in
+ *                 flight.  The child serializes finodelk and fxattrop on a
+ *                 per-inode mutex held for [work] us, as features/locks and
+ *                 storage/posix do, while writes to a file run in parallel.
+ *                 Run once with inode-affinity off and once on.
+ *
+ * gcc -O2 -pthread iot-xattrop-bm.c -I<srcdir>/libglusterfs/src \
+ *     -I<builddir> -include config.h -DGF_LINUX_HOST_OS -lglusterfs \
+ *     -o iot-xattrop-bm
+ *
+ * ./iot-xattrop-bm [inode-affinity] [transactions] [files] [in flight]
+ *                  [work us]
+ *
+ * io-threads.so is loaded from XLATORDIR, so glusterfs must be installed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "bm-fixture.h"
+
+#define DEFAULT_TRANSACTIONS 100000
+#define DEFAULT_FILES        2
+#define DEFAULT_INFLIGHT     64
+#define DEFAULT_WORK         5
+#define MAX_FILES            64
+
+enum {
+        STEP_LOCK = 0,
+        STEP_PRE_OP,
+        STEP_WRITE,
+        STEP_POST_OP,
+        STEP_UNLOCK,
+        STEP_DONE,
+};
+
+struct bm_file {
+        fd_t            *fd;
+        pthread_mutex_t  mutex;     /* what the child serializes on */
+};
+
+struct transaction {
+        struct bm_file  *file;
+        int              step;
+};
+
+static xlator_t           *iot;
+static struct bm_file      files[MAX_FILES];
+static int                 nfiles = DEFAULT_FILES;
+static long                work = DEFAULT_WORK;
+static struct iobuf       *iobuf;
+static dict_t             *xattr;
+
+static pthread_mutex_t     bm_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      bm_cond = PTHREAD_COND_INITIALIZER;
+static long                started;
+static long                finished;
+static long                transactions = DEFAULT_TRANSACTIONS;
+static long                max_inflight = DEFAULT_INFLIGHT;
+
+static void
+usage_get (double *cpu, long *csw)
+{
+        struct rusage ru = {{0,},};
+
+        getrusage (RUSAGE_SELF, &ru);
+        *cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0 +
+               ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+        *csw = ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+/* stands in for the syscalls done under the lock */
+static void
+busy (long us)
+{
+        double until = bm_now () + us / 1000000.0;
+
+        while (bm_now () < until)
+                ;
+}
+
+static struct bm_file *
+file_of (fd_t *fd)
+{
+        int i = 0;
+
+        for (i = 0; i < nfiles; i++)
+                if (files[i].fd == fd)
+                        return &files[i];
+        abort ();
+}
+
+static int32_t
+sink_finodelk (call_frame_t *frame, xlator_t *this, const char *volume,
+               fd_t *fd, int32_t cmd, struct gf_flock *lock, dict_t *xdata)
+{
+        struct bm_file *file = file_of (fd);
+
+        pthread_mutex_lock (&file->mutex);
+        busy (work / 2);
+        pthread_mutex_unlock (&file->mutex);
+
+        STACK_UNWIND_STRICT (finodelk, frame, 0, 0, NULL);
+        return 0;
+}
+
+static int32_t
+sink_fxattrop (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               gf_xattrop_flags_t flags, dict_t *dict, dict_t *xdata)
+{
+        struct bm_file *file = file_of (fd);
+
+        pthread_mutex_lock (&file->mutex);
+        busy (work);
+        pthread_mutex_unlock (&file->mutex);
+
+        STACK_UNWIND_STRICT (fxattrop, frame, 0, 0, dict, NULL);
+        return 0;
+}
+
+static int32_t
+sink_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             struct iovec *vector, int32_t count, off_t offset,
+             uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+        struct iatt buf = {0,};
+
+        busy (work);
+
+        STACK_UNWIND_STRICT (writev, frame, iov_length (vector, count), 0,
+                             &buf, &buf, NULL);
+        return 0;
+}
+
+static struct xlator_fops  sink_fops = {
+        .finodelk = sink_finodelk,
+        .fxattrop = sink_fxattrop,
+        .writev   = sink_writev,
+};
+
+static void bm_step (call_frame_t *frame);
+
+static int32_t
+bm_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+        int32_t op_errno, ...)
+{
+        struct transaction *t = frame->local;
+
+        if (op_ret < 0) {
+                fprintf (stderr, "fop failed: %s\n", strerror (op_errno));
+                exit (1);
+        }
+
+        t->step++;
+        bm_step (frame);
+        return 0;
+}
+
+static void
+bm_start (void)
+{
+        struct transaction *t     = NULL;
+        call_frame_t       *frame = NULL;
+
+        t = calloc (1, sizeof (*t));
+        frame = create_frame (&bm_top, bm_top.ctx->pool);
+        if (!t || !frame) {
+                fprintf (stderr, "out of memory\n");
+                exit (1);
+        }
+
+        t->file = &files[random () % nfiles];
+        frame->local = t;
+        bm_step (frame);
+}
+
+/* winds the next fop of the transaction, or starts another one */
+static void
+bm_step (call_frame_t *frame)
+{
+        struct transaction *t      = frame->local;
+        struct gf_flock     flock  = {0,};
+        struct iobref      *iobref = NULL;
+        struct iovec        vector = {0,};
+        gf_boolean_t        more   = _gf_false;
+
+        switch (t->step) {
+        case STEP_LOCK:
+        case STEP_UNLOCK:
+                flock.l_type = (t->step == STEP_LOCK) ? F_WRLCK : F_UNLCK;
+                STACK_WIND (frame, (fop_finodelk_cbk_t) bm_cbk, iot,
+                            iot->fops->finodelk, "bm", t->file->fd,
+                            F_SETLK, &flock, NULL);
+                return;
+
+        case STEP_PRE_OP:
+        case STEP_POST_OP:
+                STACK_WIND (frame, (fop_fxattrop_cbk_t) bm_cbk, iot,
+                            iot->fops->fxattrop, t->file->fd,
+                            GF_XATTROP_ADD_ARRAY, xattr, NULL);
+                return;
+
+        case STEP_WRITE:
+                iobref = iobref_new ();
+                if (!iobref) {
+                        fprintf (stderr, "out of memory\n");
+                        exit (1);
+                }
+                iobref_add (iobref, iobuf);
+                vector.iov_base = iobuf->ptr;
+                vector.iov_len = 4096;
+                STACK_WIND (frame, (fop_writev_cbk_t) bm_cbk, iot,
+                            iot->fops->writev, t->file->fd, &vector, 1, 0, 0,
+                            iobref, NULL);
+                iobref_unref (iobref);
+                return;
+        }
+
+        frame->local = NULL;
+        free (t);
+        STACK_DESTROY (frame->root);
+
+        pthread_mutex_lock (&bm_lock);
+        {
+                finished++;
+                if (started < transactions) {
+                        started++;
+                        more = _gf_true;
+                }
+                pthread_cond_signal (&bm_cond);
+        }
+        pthread_mutex_unlock (&bm_lock);
+
+        if (more)
+                bm_start ();
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t *ctx       = NULL;
+        inode_table_t   *table     = NULL;
+        inode_t         *inode     = NULL;
+        const char      *affinity  = "off";
+        double           start     = 0;
+        double           elapsed   = 0;
+        double           cpu_start = 0;
+        double           cpu_end   = 0;
+        long             csw_start = 0;
+        long             csw_end   = 0;
+        long             i         = 0;
+
+        if (argc > 1)
+                affinity = argv[1];
+        if (argc > 2)
+                transactions = strtol (argv[2], NULL, 0);
+        if (argc > 3)
+                nfiles = strtol (argv[3], NULL, 0);
+        if (argc > 4)
+                max_inflight = strtol (argv[4], NULL, 0);
+        if (argc > 5)
+                work = strtol (argv[5], NULL, 0);
+
+        if (transactions < 1 || nfiles < 1 || nfiles > MAX_FILES ||
+            max_inflight < 1 || work < 0) {
+                fprintf (stderr, "usage: %s [inode-affinity] [transactions] "
+                         "[files] [in flight] [work us]\n", argv[0]);
+                return 1;
+        }
+
+        /* top -> io-threads -> sink */
+        ctx = bm_ctx_new ();
+        iot = ctx ? bm_xlator_new (ctx, "iot-xattrop-bm",
+                                   "performance/io-threads", &sink_fops,
+                                   "inode-affinity", affinity, NULL) : NULL;
+        if (!iot)
+                return 1;
+
+        table = inode_table_new (0, &bm_top);
+        iobuf = iobuf_get2 (ctx->iobuf_pool, 4096);
+        xattr = dict_new ();
+        if (!table || !iobuf || !xattr ||
+            dict_set_static_bin (xattr, "trusted.afr.bm-client-0",
+                                 calloc (1, 12), 12))
+                return 1;
+
+        for (i = 0; i < nfiles; i++) {
+                inode = inode_new (table);
+                files[i].fd = inode ? fd_create (inode, O_RDWR) : NULL;
+                if (!files[i].fd)
+                        return 1;
+                gf_uuid_generate (inode->gfid);
+                pthread_mutex_init (&files[i].mutex, NULL);
+        }
+
+        srandom (1);
+
+        usage_get (&cpu_start, &csw_start);
+        start = bm_now ();
+
+        pthread_mutex_lock (&bm_lock);
+        started = min (max_inflight, transactions);
+        pthread_mutex_unlock (&bm_lock);
+        for (i = 0; i < min (max_inflight, transactions); i++)
+                bm_start ();
+
+        pthread_mutex_lock (&bm_lock);
+        {
+                while (finished < transactions)
+                        pthread_cond_wait (&bm_cond, &bm_lock);
+        }
+        pthread_mutex_unlock (&bm_lock);
+
+        elapsed = bm_now () - start;
+        usage_get (&cpu_end, &csw_end);
+
+        printf ("inode-affinity %-3s %2d files %4ld in flight  "
+                "%8.0f transactions/s  %7.1f cpu us  %6.2f switches "
+                "per transaction\n", affinity, nfiles, max_inflight,
+                transactions / elapsed,
+                (cpu_end - cpu_start) * 1000000.0 / transactions,
+                (double)(csw_end - csw_start) / transactions);
+
+        bm_xlator_fini (iot);
+
+        return 0;
+}
@@ -0,0 +1,232 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * posix-readdirp-bm: time to readdirp through a large directory on a
+ *                    storage/posix brick, the way a brick serves `ls -l`
+ *                    or a self-heal crawl: 128k readdirp replies, each
+ *                    entry stat'ed and asked for two afr xattrs.  The brick
+ *                    root is filled with [entries] files, carrying a gfid,
+ *                    on the first run.  Compare readdirp-threads 0 (one
+ *                    entry after the other) with a few helpers.  When run
+ *                    as root outside a container the page cache is dropped
+ *                    before every pass, otherwise the numbers are warm.
+ *
+ * gcc -O2 -pthread posix-readdirp-bm.c -I<srcdir>/libglusterfs/src \
+ *     -I<builddir> -include config.h -DGF_LINUX_HOST_OS -lglusterfs \
+ *     -o posix-readdirp-bm
+ *
+ * ./posix-readdirp-bm <brick dir> [entries] [readdirp-threads] [passes]
+ *
+ * posix.so is loaded from XLATORDIR, so glusterfs must be installed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/xattr.h>
+
+#include "bm-fixture.h"
+
+#define DEFAULT_ENTRIES 100000
+#define DEFAULT_PASSES  3
+#define READDIRP_SIZE   131072
+
+static xlator_t           *posix;
+
+static int                 last_ret;
+static int                 last_errno;
+static long                last_count;
+static off_t               last_off;
+
+/* storage/posix is synchronous: the callbacks run before the wind returns */
+static int32_t
+bm_opendir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, fd_t *fd, dict_t *xdata)
+{
+        last_ret = op_ret;
+        last_errno = op_errno;
+        return 0;
+}
+
+static int32_t
+bm_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                 dict_t *xdata)
+{
+        gf_dirent_t *entry = NULL;
+
+        last_ret = op_ret;
+        last_errno = op_errno;
+        last_count = 0;
+
+        if (op_ret <= 0)
+                return 0;
+
+        list_for_each_entry (entry, &entries->list, list) {
+                last_off = entry->d_off;
+                if (entry->inode)
+                        last_count++;
+        }
+
+        return 0;
+}
+
+static int
+populate (const char *dir, long entries)
+{
+        char     path[PATH_MAX] = {0,};
+        uuid_t   gfid;
+        long     i  = 0;
+        int      fd = -1;
+
+        snprintf (path, sizeof (path), "%s/f%07ld", dir, entries - 1);
+        if (access (path, F_OK) == 0)
+                return 0;
+
+        printf ("creating %ld files in %s\n", entries, dir);
+        for (i = 0; i < entries; i++) {
+                snprintf (path, sizeof (path), "%s/f%07ld", dir, i);
+                fd = open (path, O_CREAT | O_WRONLY, 0644);
+                if (fd < 0)
+                        return -1;
+                gf_uuid_generate (gfid);
+                if (fsetxattr (fd, "trusted.gfid", gfid, 16, 0)) {
+                        close (fd);
+                        return -1;
+                }
+                close (fd);
+        }
+
+        return 0;
+}
+
+static void
+drop_caches (void)
+{
+        int fd = -1;
+
+        sync ();
+        fd = open ("/proc/sys/vm/drop_caches", O_WRONLY);
+        if (fd < 0)
+                return;
+        if (write (fd, "3", 1) != 1)
+                fprintf (stderr, "could not drop caches\n");
+        close (fd);
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t *ctx      = NULL;
+        inode_table_t   *table    = NULL;
+        call_frame_t    *frame    = NULL;
+        dict_t          *xattr    = NULL;
+        fd_t            *fd       = NULL;
+        loc_t            loc      = {0,};
+        const char      *dir      = NULL;
+        const char      *threads  = "0";
+        long             entries  = DEFAULT_ENTRIES;
+        long             passes   = DEFAULT_PASSES;
+        long             seen     = 0;
+        long             pass     = 0;
+        double           start    = 0;
+        double           elapsed  = 0;
+
+        if (argc < 2) {
+                fprintf (stderr, "usage: %s <brick dir> [entries] "
+                         "[readdirp-threads] [passes]\n", argv[0]);
+                return 1;
+        }
+        dir = argv[1];
+        if (argc > 2)
+                entries = strtol (argv[2], NULL, 0);
+        if (argc > 3)
+                threads = argv[3];
+        if (argc > 4)
+                passes = strtol (argv[4], NULL, 0);
+
+        if (entries < 1 || passes < 1) {
+                fprintf (stderr, "bad entries or passes\n");
+                return 1;
+        }
+
+        if (populate (dir, entries)) {
+                perror ("populating brick");
+                return 1;
+        }
+
+        /* top -> posix */
+        ctx = bm_ctx_new ();
+        posix = ctx ? bm_xlator_new (ctx, "posix-readdirp-bm",
+                                     "storage/posix", NULL, "directory", dir,
+                                     "readdirp-threads", threads,
+                                     NULL) : NULL;
+        if (!posix)
+                return 1;
+
+        table = inode_table_new (0, posix);
+        xattr = dict_new ();
+        if (!table || !xattr ||
+            dict_set_int32 (xattr, "trusted.afr.bm-client-0", 0) ||
+            dict_set_int32 (xattr, "trusted.afr.bm-client-1", 0))
+                return 1;
+
+        loc.path = "/";
+        loc.inode = inode_ref (table->root);
+        gf_uuid_copy (loc.gfid, loc.inode->gfid);
+
+        for (pass = 0; pass < passes; pass++) {
+                drop_caches ();
+
+                fd = fd_create (loc.inode, 0);
+                frame = create_frame (&bm_top, ctx->pool);
+                if (!fd || !frame)
+                        return 1;
+
+                start = bm_now ();
+
+                STACK_WIND (frame, bm_opendir_cbk, posix,
+                            posix->fops->opendir, &loc, fd, NULL);
+                if (last_ret < 0) {
+                        fprintf (stderr, "opendir failed: %s\n",
+                                 strerror (last_errno));
+                        return 1;
+                }
+
+                seen = 0;
+                last_off = 0;
+                do {
+                        STACK_WIND (frame, bm_readdirp_cbk, posix,
+                                    posix->fops->readdirp, fd, READDIRP_SIZE,
+                                    last_off, xattr);
+                        if (last_ret < 0 && last_errno != ENOENT) {
+                                fprintf (stderr, "readdirp failed: %s\n",
+                                         strerror (last_errno));
+                                return 1;
+                        }
+                        seen += last_count;
+                } while (last_ret > 0);
+
+                elapsed = bm_now () - start;
+
+                STACK_DESTROY (frame->root);
+                fd_unref (fd);
+
+                printf ("readdirp-threads %-2s  %7ld entries  %8.1f ms  "
+                        "%9.0f entries/s\n", threads, seen, elapsed * 1000,
+                        seen / elapsed);
+        }
+
+        bm_xlator_fini (posix);
+
+        return 0;
+}
@@ -0,0 +1,318 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * wb-bm: random writes to one file through performance/write-behind with
+ *        many of them outstanding, the way databases and VM images write.
+ *        The child completes writes after a fixed latency from a thread of
+ *        its own, so write-behind holds up to [iodepth] writes in its
+ *        queues and what is measured is the cost of keeping them ordered.
+ *
+ * gcc -O2 -pthread wb-bm.c -I<srcdir>/libglusterfs/src -I<builddir> \
+ *     -include config.h -DGF_LINUX_HOST_OS -lglusterfs -o wb-bm
+ *
+ * ./wb-bm [writes] [iodepth] [block size] [latency us]
+ *
+ * write-behind.so is loaded from XLATORDIR, so glusterfs must be installed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "bm-fixture.h"
+
+#define DEFAULT_WRITES       200000
+#define DEFAULT_IODEPTH      256
+#define DEFAULT_BLOCK_SIZE   4096
+#define DEFAULT_LATENCY      200
+#define FILE_SIZE            (1ULL << 30)
+
+struct completion {
+        call_frame_t      *frame;
+        size_t             size;
+        struct completion *next;
+};
+
+static xlator_t           *wb;
+static long                latency = DEFAULT_LATENCY;
+
+static pthread_mutex_t     sink_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      sink_cond = PTHREAD_COND_INITIALIZER;
+static struct completion  *sink_head;
+static struct completion **sink_tail = &sink_head;
+
+static pthread_mutex_t     bm_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      bm_cond = PTHREAD_COND_INITIALIZER;
+static long                inflight;
+
+/* cpu time of the whole process, the sink sleeping does not count */
+static double
+cpu (void)
+{
+        struct rusage ru = {{0,},};
+
+        getrusage (RUSAGE_SELF, &ru);
+        return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0 +
+                ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+}
+
+/* unwinds the writes reaching the child [latency] us after they did */
+static void *
+sink_complete (void *data)
+{
+        struct completion *c   = NULL;
+        struct iatt        buf = {0,};
+
+        for (;;) {
+                pthread_mutex_lock (&sink_lock);
+                {
+                        while (!sink_head)
+                                pthread_cond_wait (&sink_cond, &sink_lock);
+                        c = sink_head;
+                        sink_head = NULL;
+                        sink_tail = &sink_head;
+                }
+                pthread_mutex_unlock (&sink_lock);
+
+                usleep (latency);
+
+                while (c) {
+                        struct completion *next = c->next;
+
+                        buf.ia_size = FILE_SIZE;
+                        STACK_UNWIND_STRICT (writev, c->frame, c->size, 0,
+                                             &buf, &buf, NULL);
+                        free (c);
+                        c = next;
+                }
+        }
+
+        return NULL;
+}
+
+static int32_t
+sink_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+           fd_t *fd, dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (open, frame, 0, 0, fd, NULL);
+        return 0;
+}
+
+static int32_t
+sink_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             struct iovec *vector, int32_t count, off_t offset,
+             uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+        struct completion *c = calloc (1, sizeof (*c));
+
+        if (!c) {
+                fprintf (stderr, "out of memory\n");
+                exit (1);
+        }
+        c->frame = frame;
+        c->size = iov_length (vector, count);
+
+        pthread_mutex_lock (&sink_lock);
+        {
+                *sink_tail = c;
+                sink_tail = &c->next;
+                pthread_cond_signal (&sink_cond);
+        }
+        pthread_mutex_unlock (&sink_lock);
+
+        return 0;
+}
+
+static int32_t
+sink_flush (call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (flush, frame, 0, 0, NULL);
+        return 0;
+}
+
+static struct xlator_fops  sink_fops = {
+        .open   = sink_open,
+        .writev = sink_writev,
+        .flush  = sink_flush,
+};
+
+static int32_t
+bm_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+        int32_t op_errno, ...)
+{
+        if (op_ret < 0) {
+                fprintf (stderr, "fop failed: %s\n", strerror (op_errno));
+                exit (1);
+        }
+
+        pthread_mutex_lock (&bm_lock);
+        {
+                inflight--;
+                pthread_cond_signal (&bm_cond);
+        }
+        pthread_mutex_unlock (&bm_lock);
+
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+static void
+bm_drain (void)
+{
+        pthread_mutex_lock (&bm_lock);
+        {
+                while (inflight)
+                        pthread_cond_wait (&bm_cond, &bm_lock);
+        }
+        pthread_mutex_unlock (&bm_lock);
+}
+
+/* waits for a slot among [max] + 1 in flight and takes it */
+static void
+bm_wait (long max)
+{
+        pthread_mutex_lock (&bm_lock);
+        {
+                while (inflight > max)
+                        pthread_cond_wait (&bm_cond, &bm_lock);
+                inflight++;
+        }
+        pthread_mutex_unlock (&bm_lock);
+}
+
+static void
+bm_write (fd_t *fd, off_t offset, struct iobuf *iobuf, size_t size)
+{
+        call_frame_t  *frame  = NULL;
+        struct iobref *iobref = NULL;
+        struct iovec   vector = {0,};
+
+        frame = create_frame (&bm_top, bm_top.ctx->pool);
+        iobref = iobref_new ();
+        if (!frame || !iobref) {
+                fprintf (stderr, "out of memory\n");
+                exit (1);
+        }
+
+        iobref_add (iobref, iobuf);
+        vector.iov_base = iobuf->ptr;
+        vector.iov_len = size;
+
+        STACK_WIND (frame, (fop_writev_cbk_t) bm_cbk, wb, wb->fops->writev,
+                    fd, &vector, 1, offset, 0, iobref, NULL);
+
+        iobref_unref (iobref);
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t *ctx        = NULL;
+        inode_table_t   *table      = NULL;
+        inode_t         *inode      = NULL;
+        fd_t            *fd         = NULL;
+        struct iobuf    *iobuf      = NULL;
+        call_frame_t    *frame      = NULL;
+        loc_t            loc        = {0,};
+        pthread_t        completer;
+        char             window[32];
+        long             writes     = DEFAULT_WRITES;
+        long             iodepth    = DEFAULT_IODEPTH;
+        size_t           block_size = DEFAULT_BLOCK_SIZE;
+        uint64_t         blocks     = 0;
+        double           start      = 0;
+        double           elapsed    = 0;
+        double           cpu_start  = 0;
+        long             i          = 0;
+
+        if (argc > 1)
+                writes = strtol (argv[1], NULL, 0);
+        if (argc > 2)
+                iodepth = strtol (argv[2], NULL, 0);
+        if (argc > 3)
+                block_size = strtol (argv[3], NULL, 0);
+        if (argc > 4)
+                latency = strtol (argv[4], NULL, 0);
+
+        if (writes < 1 || iodepth < 1 || block_size < 1 ||
+            block_size > 128 * 1024 || latency < 0) {
+                fprintf (stderr, "usage: %s [writes] [iodepth] [block size] "
+                         "[latency us]\n", argv[0]);
+                return 1;
+        }
+
+        /* room in the window for [iodepth] writes, 512KB at least */
+        snprintf (window, sizeof (window), "%zu",
+                  max (iodepth * block_size, (size_t)(512 * GF_UNIT_KB)));
+
+        /* top -> write-behind -> sink */
+        ctx = bm_ctx_new ();
+        wb = ctx ? bm_xlator_new (ctx, "wb-bm", "performance/write-behind",
+                                  &sink_fops, "cache-size", window,
+                                  NULL) : NULL;
+        if (!wb)
+                return 1;
+
+        if (pthread_create (&completer, NULL, sink_complete, NULL))
+                return 1;
+
+        table = inode_table_new (0, &bm_top);
+        inode = table ? inode_new (table) : NULL;
+        fd = inode ? fd_create (inode, O_RDWR) : NULL;
+        iobuf = iobuf_get2 (ctx->iobuf_pool, block_size);
+        if (!fd || !iobuf)
+                return 1;
+        gf_uuid_generate (inode->gfid);
+        memset (iobuf->ptr, 0xa5, block_size);
+
+        loc.inode = inode;
+        loc.path = "/wb-bm";
+
+        frame = create_frame (&bm_top, ctx->pool);
+        if (!frame)
+                return 1;
+        bm_wait (0);
+        STACK_WIND (frame, (fop_open_cbk_t) bm_cbk, wb, wb->fops->open, &loc,
+                    O_RDWR, fd, NULL);
+
+        /* writes past the end of file are ordered against all that follows,
+           the file is preallocated as a VM image would be */
+        blocks = FILE_SIZE / block_size;
+        bm_wait (0);
+        bm_write (fd, (blocks - 1) * block_size, iobuf, block_size);
+
+        srandom (1);
+        start = bm_now ();
+        cpu_start = cpu ();
+        for (i = 0; i < writes; i++) {
+                bm_wait (iodepth - 1);
+                bm_write (fd, (random () % blocks) * block_size, iobuf,
+                          block_size);
+        }
+
+        frame = create_frame (&bm_top, ctx->pool);
+        if (!frame)
+                return 1;
+        bm_wait (iodepth - 1);
+        STACK_WIND (frame, (fop_flush_cbk_t) bm_cbk, wb, wb->fops->flush, fd,
+                    NULL);
+        bm_drain ();
+        elapsed = bm_now () - start;
+
+        printf ("iodepth %4ld  bs %6zu  %10.0f writes/s  %8.2f cpu us/write\n",
+                iodepth, block_size, writes / elapsed,
+                (cpu () - cpu_start) * 1000000.0 / writes);
+
+        return 0;
+}
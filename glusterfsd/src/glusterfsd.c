@@ -126,6 +126,12 @@ static struct argp_option gf_options[] = {
          "buffer size, [default: 5]"},
         {"log-flush-timeout", ARGP_LOG_FLUSH_TIMEOUT, "LOG-FLUSH-TIMEOUT", 0,
          "Set log flush timeout, [default: 2 minutes]"},
+        {"log-async", ARGP_LOG_ASYNC_KEY, "BOOL", OPTION_ARG_OPTIONAL,
+         "Hand log messages over to a writer thread instead of writing "
+         "them in the logging thread [default: off]"},
+        {"log-rate-limit", ARGP_LOG_RATE_LIMIT_KEY, "MSGS-PER-SEC", 0,
+         "With --log-async, write at most this many messages per second "
+         "and drop the rest, 0 for no limit [default: 0]"},
 
         {0, 0, 0, 0, "Advanced Options:"},
         {"volfile-server-port", ARGP_VOLFILE_SERVER_PORT_KEY, "PORT", 0,
@@ -192,6 +198,9 @@ static struct argp_option gf_options[] = {
 	 "Do not purge the cache on file open"},
         {"global-timer-wheel", ARGP_GLOBAL_TIMER_WHEEL, "BOOL",
          OPTION_ARG_OPTIONAL, "Instantiate process global timer-wheel"},
+        {"event-pin-workers", ARGP_EVENT_PIN_WORKERS_KEY, "BOOL",
+         OPTION_ARG_OPTIONAL, "Pin every connection to one event thread, "
+         "which then picks up its events in batches without re-arming"},
 
         {0, 0, 0, 0, "Fuse options:"},
         {"direct-io-mode", ARGP_DIRECT_IO_MODE_KEY, "BOOL", OPTION_ARG_OPTIONAL,
@@ -1137,6 +1146,22 @@ parse_opts (int key, char *arg, struct argp_state *state)
                 cmd_args->global_timer_wheel = 1;
                 break;
 
+        case ARGP_EVENT_PIN_WORKERS_KEY:
+                if (!arg)
+                        arg = "on";
+
+                if (gf_string2boolean (arg, &b) == 0) {
+                        cmd_args->event_pin_workers = b;
+
+                        break;
+                }
+
+                argp_failure (state, -1, 0,
+                              "unknown event-pin-workers setting \"%s\"",
+                              arg);
+
+                break;
+
 	case ARGP_GID_TIMEOUT_KEY:
 		if (!gf_string2int(arg, &cmd_args->gid_timeout)) {
 			cmd_args->gid_timeout_set = _gf_true;
@@ -1260,6 +1285,29 @@ no_oom_api:
 
                 break;
 
+        case ARGP_LOG_ASYNC_KEY:
+                if (!arg)
+                        arg = "on";
+
+                if (gf_string2boolean (arg, &b) == 0) {
+                        cmd_args->log_async = b;
+
+                        break;
+                }
+
+                argp_failure (state, -1, 0,
+                              "unknown log-async setting \"%s\"", arg);
+
+                break;
+
+        case ARGP_LOG_RATE_LIMIT_KEY:
+                if (gf_string2uint32 (arg, &cmd_args->log_rate_limit)) {
+                        argp_failure (state, -1, 0,
+                                      "unknown log rate limit %s", arg);
+                }
+
+                break;
+
         case ARGP_SECURE_MGMT_KEY:
                 if (!arg)
                         arg = "yes";
@@ -2491,6 +2539,14 @@ main (int argc, char *argv[])
                 goto out;
         }
 
+        /* before glusterfs_volumes_init() registers the first fd */
+        if (cmd->event_pin_workers)
+                (void) event_pool_pin_workers (ctx->event_pool);
+
+        /* the writer is a thread, so this too _after_ daemonize() */
+        if (cmd->log_async)
+                (void) gf_log_async_start (ctx, cmd->log_rate_limit);
+
         /* do this _after_ daemonize() */
         if (cmd->global_timer_wheel) {
                 ret = glusterfs_global_timer_wheel_init (ctx);
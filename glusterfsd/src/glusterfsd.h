@@ -96,6 +96,9 @@ enum argp_option_keys {
 #ifdef GF_LINUX_HOST_OS
         ARGP_OOM_SCORE_ADJ_KEY            = 176,
 #endif
+        ARGP_EVENT_PIN_WORKERS_KEY        = 177,
+        ARGP_LOG_ASYNC_KEY                = 178,
+        ARGP_LOG_RATE_LIMIT_KEY           = 179,
 };
 
 struct _gfd_vol_top_priv_t {
@@ -26,6 +26,7 @@ typedef struct _call_stub {
         uint32_t jnl_meta_len;
         uint32_t jnl_data_len;
         void (*serialize) (struct _call_stub *, char *, char *);
+        struct timespec queued; /* set by xlators queueing the stub */
 
 	union {
 		fop_lookup_t lookup;
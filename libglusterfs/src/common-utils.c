@@ -580,6 +580,39 @@ xldump (xlator_t *each, void *d)
 }
 
 
+/* Per fop, how many xlators a wind from the top actually goes through
+ * once the pass-through ones are skipped, against the depth of the graph
+ * on that path. */
+static void
+xldump_fop_depth (xlator_t *top)
+{
+        char        line[96];
+        const char *name = NULL;
+        int         len  = 0;
+        int         i    = 0;
+
+        gf_msg_plain (GF_LOG_WARNING, "fop depth (effective/graph):");
+
+        for (i = 0; i < GF_XLATOR_FOP_SLOTS; i++) {
+                name = xlator_fop_slot_name (i);
+                if (!name)
+                        continue;
+
+                len += snprintf (line + len, sizeof (line) - len,
+                                 " %13s %2d/%-2d", name,
+                                 xlator_fop_depth (top, i, _gf_true),
+                                 xlator_fop_depth (top, i, _gf_false));
+                if (len + 20 >= sizeof (line)) {
+                        gf_msg_plain (GF_LOG_WARNING, "%s", line);
+                        len = 0;
+                }
+        }
+
+        if (len)
+                gf_msg_plain (GF_LOG_WARNING, "%s", line);
+}
+
+
 void
 gf_log_dump_graph (FILE *specfp, glusterfs_graph_t *graph)
 {
@@ -592,6 +625,8 @@ gf_log_dump_graph (FILE *specfp, glusterfs_graph_t *graph)
 
 	xlator_foreach_depth_first (graph->top, xldump, &xld);
 
+        xldump_fop_depth (graph->top);
+
         gf_msg_plain (GF_LOG_WARNING,
                       "+---------------------------------------"
                       "---------------------------------------+");
@@ -19,7 +19,6 @@
 #include "glusterfs.h"
 #include "common-utils.h"
 #include "dict.h"
-#include "hashfn.h"
 #include "logging.h"
 #include "compat.h"
 #include "compat-errno.h"
@@ -50,40 +49,18 @@ get_new_data ()
 dict_t *
 get_new_dict_full (int size_hint)
 {
-        dict_t *dict = mem_get0 (THIS->ctx->dict_pool);
+        dict_t *dict = mem_get (THIS->ctx->dict_pool);
 
         if (!dict) {
                 return NULL;
         }
 
+        /* members_inline[] is set up pair by pair in dict_pair_get () */
+        memset (dict, 0, offsetof (dict_t, members_inline));
+
+        /* Only ever 1.  The index in "members" is sized by the number of
+         * pairs instead, see dict_index_build (). */
         dict->hash_size = size_hint;
-        if (size_hint == 1) {
-                /*
-                 * This is the only case we ever see currently.  If we ever
-                 * need to support resizing the hash table, the resize function
-                 * will have to take into account the possibility that
-                 * "members" is not separately allocated (i.e. don't just call
-                 * realloc() blindly.
-                 */
-                dict->members = &dict->members_internal;
-        }
-        else {
-                /*
-                 * We actually need to allocate space for size_hint *pointers*
-                 * but we actually allocate space for one *structure*.  Since
-                 * a data_pair_t consists of five pointers, we're wasting four
-                 * pointers' worth for N=1, and will overrun what we allocated
-                 * for N>5.  If anybody ever starts using size_hint, we'll need
-                 * to fix this.
-                 */
-                GF_ASSERT (size_hint <=
-                           (sizeof(data_pair_t) / sizeof(data_pair_t *)));
-                dict->members = mem_get0 (THIS->ctx->dict_pair_pool);
-                if (!dict->members) {
-                        mem_put (dict);
-                        return NULL;
-                }
-        }
 
         LOCK_INIT (&dict->lock);
 
@@ -264,10 +241,62 @@ err_out:
         return NULL;
 }
 
+/* Word at a time over the whole key; keys of one dict often differ only
+ * in a few characters ("trusted.afr.<volume>-client-<N>"). */
+static inline uint32_t
+dict_key_hash (const char *key, size_t *len)
+{
+        uint64_t h = 0;
+        uint64_t w = 0;
+        size_t   n = 0;
+
+        n = strlen (key);
+        *len = n;
+
+        for (h = n; n >= sizeof (w); n -= sizeof (w), key += sizeof (w)) {
+                memcpy (&w, key, sizeof (w));
+                h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+                h ^= h >> 29;
+        }
+        if (n) {
+                w = 0;
+                memcpy (&w, key, n);
+                h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        }
+
+        return (uint32_t)(h >> 32);
+}
+
+static data_pair_t *
+dict_lookup_hashed (dict_t *this, const char *key, uint32_t hash)
+{
+        data_pair_t *pair = NULL;
+        uint32_t     mask = 0;
+        uint32_t     i    = 0;
+
+        if (this->members) {
+                mask = this->index_size - 1;
+                for (i = hash & mask; (pair = this->members[i]) != NULL;
+                     i = (i + 1) & mask) {
+                        if (pair->key_hash == hash && !strcmp (pair->key, key))
+                                return pair;
+                }
+                return NULL;
+        }
+
+        for (pair = this->members_list; pair != NULL; pair = pair->next) {
+                if (pair->key_hash == hash && !strcmp (pair->key, key))
+                        return pair;
+        }
+
+        return NULL;
+}
+
 static data_pair_t *
 dict_lookup_common (dict_t *this, char *key)
 {
-        int hashval = 0;
+        size_t len = 0;
+
         if (!this || !key) {
                 gf_msg_callingfn ("dict", GF_LOG_WARNING, EINVAL,
                                   LG_MSG_INVALID_ARG,
@@ -275,20 +304,7 @@ dict_lookup_common (dict_t *this, char *key)
                 return NULL;
         }
 
-        /* If the divisor is 1, the modulo is always 0,
-         * in such case avoid hash calculation.
-         */
-        if (this->hash_size != 1)
-                hashval = SuperFastHash (key, strlen (key)) % this->hash_size;
-
-        data_pair_t *pair;
-
-        for (pair = this->members[hashval]; pair != NULL; pair = pair->hash_next) {
-                if (pair->key && !strcmp (pair->key, key))
-                        return pair;
-        }
-
-        return NULL;
+        return dict_lookup_hashed (this, key, dict_key_hash (key, &len));
 }
 
 int32_t
@@ -315,13 +331,102 @@ dict_lookup (dict_t *this, char *key, data_t **data)
         return 0;
 }
 
+static data_pair_t *
+dict_pair_get (dict_t *this)
+{
+        int i = 0;
+
+        for (i = 0; i < DICT_INLINE_PAIRS; i++) {
+                if (!(this->inline_used & (1U << i))) {
+                        this->inline_used |= (1U << i);
+                        return &this->members_inline[i];
+                }
+        }
+
+        return mem_get (THIS->ctx->dict_pair_pool);
+}
+
+static void
+dict_pair_put (dict_t *this, data_pair_t *pair)
+{
+        if (pair->key != pair->key_inline && !dict_key_is_interned (pair->key))
+                GF_FREE (pair->key);
+
+        if (pair >= this->members_inline &&
+            pair < this->members_inline + DICT_INLINE_PAIRS)
+                this->inline_used &= ~(1U << (pair - this->members_inline));
+        else
+                mem_put (pair);
+}
+
+static void
+dict_index_insert (dict_t *this, data_pair_t *pair)
+{
+        uint32_t mask = this->index_size - 1;
+        uint32_t i    = 0;
+
+        for (i = pair->key_hash & mask; this->members[i] != NULL;
+             i = (i + 1) & mask)
+                ;
+        this->members[i] = pair;
+}
+
+/* Indexes all of members_list at a load factor of at most 1/2.  If that
+ * cannot be allocated the dict goes back to scanning members_list. */
+static void
+dict_index_build (dict_t *this)
+{
+        data_pair_t *pair = NULL;
+        uint32_t     size = DICT_INDEX_MIN * 2;
+
+        while (size < (uint32_t)this->count * 2)
+                size <<= 1;
+
+        GF_FREE (this->members);
+        this->index_size = 0;
+        this->members = GF_CALLOC (size, sizeof (*this->members),
+                                   gf_common_mt_dict_index_t);
+        if (!this->members)
+                return;
+
+        this->index_size = size;
+        for (pair = this->members_list; pair != NULL; pair = pair->next)
+                dict_index_insert (this, pair);
+}
+
+/* linear probing, so close the gap instead of leaving a tombstone */
+static void
+dict_index_remove (dict_t *this, data_pair_t *pair)
+{
+        uint32_t mask = this->index_size - 1;
+        uint32_t i    = 0;
+        uint32_t j    = 0;
+        uint32_t home = 0;
+
+        for (i = pair->key_hash & mask; this->members[i] != pair;
+             i = (i + 1) & mask)
+                ;
+
+        for (j = (i + 1) & mask; this->members[j] != NULL;
+             j = (j + 1) & mask) {
+                home = this->members[j]->key_hash & mask;
+                /* stays if its home slot is cyclically in (i, j] */
+                if ((i < j) ? (i < home && home <= j)
+                            : (i < home || home <= j))
+                        continue;
+                this->members[i] = this->members[j];
+                i = j;
+        }
+        this->members[i] = NULL;
+}
+
 static int32_t
 dict_set_lk (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
 {
-        int hashval = 0;
         data_pair_t *pair;
         char key_free = 0;
-        int tmp = 0;
+        uint32_t hash = 0;
+        size_t len = 0;
         int ret = 0;
 
         if (!key) {
@@ -332,17 +437,11 @@ dict_set_lk (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
                 key_free = 1;
         }
 
-        /* If the divisor is 1, the modulo is always 0,
-         * in such case avoid hash calculation.
-         */
-        if (this->hash_size != 1) {
-                tmp = SuperFastHash (key, strlen (key));
-                hashval = (tmp % this->hash_size);
-        }
+        hash = dict_key_hash (key, &len);
 
         /* Search for a existing key if 'replace' is asked for */
         if (replace) {
-                pair = dict_lookup_common (this, key);
+                pair = dict_lookup_hashed (this, key, hash);
 
                 if (pair) {
                         data_t *unref_data = pair->value;
@@ -355,17 +454,11 @@ dict_set_lk (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
                 }
         }
 
-        if (this->free_pair_in_use) {
-                pair = mem_get0 (THIS->ctx->dict_pair_pool);
-                if (!pair) {
-                        if (key_free)
-                                GF_FREE (key);
-                        return -1;
-                }
-        }
-        else {
-                pair = &this->free_pair;
-                this->free_pair_in_use = _gf_true;
+        pair = dict_pair_get (this);
+        if (!pair) {
+                if (key_free)
+                        GF_FREE (key);
+                return -1;
         }
 
         if (key_free) {
@@ -373,25 +466,26 @@ dict_set_lk (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
                 pair->key = key;
                 key_free = 0;
         }
+        else if (dict_key_is_interned (key)) {
+                /* static, see dict_unserialize_compact() */
+                pair->key = key;
+        }
+        else if (len < DICT_KEY_INLINE) {
+                pair->key = pair->key_inline;
+                memcpy (pair->key, key, len + 1);
+        }
         else {
-                pair->key = (char *) GF_CALLOC (1, strlen (key) + 1,
+                pair->key = (char *) GF_CALLOC (1, len + 1,
                                                 gf_common_mt_char);
                 if (!pair->key) {
-                        if (pair == &this->free_pair) {
-                                this->free_pair_in_use = _gf_false;
-                        }
-                        else {
-                                mem_put (pair);
-                        }
+                        dict_pair_put (this, pair);
                         return -1;
                 }
-                strcpy (pair->key, key);
+                memcpy (pair->key, key, len + 1);
         }
+        pair->key_hash = hash;
         pair->value = data_ref (value);
 
-        pair->hash_next = this->members[hashval];
-        this->members[hashval] = pair;
-
         pair->next = this->members_list;
         pair->prev = NULL;
         if (this->members_list)
@@ -399,8 +493,11 @@ dict_set_lk (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
         this->members_list = pair;
         this->count++;
 
-        if (key_free)
-                GF_FREE (key);
+        if (this->members && this->count * 2 <= this->index_size)
+                dict_index_insert (this, pair);
+        else if (this->members || this->count > DICT_INDEX_MIN)
+                dict_index_build (this);
+
         return 0;
 }
 
@@ -497,7 +594,8 @@ dict_key_count (dict_t *this)
 void
 dict_del (dict_t *this, char *key)
 {
-        int hashval = 0;
+        data_pair_t *pair = NULL;
+        size_t       len  = 0;
 
         if (!this || !key) {
                 gf_msg_callingfn ("dict", GF_LOG_WARNING, EINVAL,
@@ -507,45 +605,23 @@ dict_del (dict_t *this, char *key)
 
         LOCK (&this->lock);
 
-        /* If the divisor is 1, the modulo is always 0,
-         * in such case avoid hash calculation.
-         */
-        if (this->hash_size != 1)
-                hashval = SuperFastHash (key, strlen (key)) % this->hash_size;
-
-        data_pair_t *pair = this->members[hashval];
-        data_pair_t *prev = NULL;
-
-        while (pair) {
-                if (strcmp (pair->key, key) == 0) {
-                        if (prev)
-                                prev->hash_next = pair->hash_next;
-                        else
-                                this->members[hashval] = pair->hash_next;
-
-                        data_unref (pair->value);
+        pair = dict_lookup_hashed (this, key, dict_key_hash (key, &len));
+        if (pair) {
+                if (this->members)
+                        dict_index_remove (this, pair);
 
-                        if (pair->prev)
-                                pair->prev->next = pair->next;
-                        else
-                                this->members_list = pair->next;
+                data_unref (pair->value);
 
-                        if (pair->next)
-                                pair->next->prev = pair->prev;
+                if (pair->prev)
+                        pair->prev->next = pair->next;
+                else
+                        this->members_list = pair->next;
 
-                        GF_FREE (pair->key);
-                        if (pair == &this->free_pair) {
-                                this->free_pair_in_use = _gf_false;
-                        }
-                        else {
-                                mem_put (pair);
-                        }
-                        this->count--;
-                        break;
-                }
+                if (pair->next)
+                        pair->next->prev = pair->prev;
 
-                prev = pair;
-                pair = pair->hash_next;
+                dict_pair_put (this, pair);
+                this->count--;
         }
 
         UNLOCK (&this->lock);
@@ -570,16 +646,11 @@ dict_destroy (dict_t *this)
         while (prev) {
                 pair = pair->next;
                 data_unref (prev->value);
-                GF_FREE (prev->key);
-                if (prev != &this->free_pair) {
-                        mem_put (prev);
-                }
+                dict_pair_put (this, prev);
                 prev = pair;
         }
 
-        if (this->members != &this->members_internal) {
-                mem_put (this->members);
-        }
+        GF_FREE (this->members);
 
         GF_FREE (this->extra_free);
         free (this->extra_stdfree);
@@ -2651,6 +2722,538 @@ out:
 }
 
 
+/**
+ * Compact serialization format, used on connections whose peer announced
+ * that it can decode it:
+ *  -------- -------  ------------------------------------------------------
+ * | magic  | count | tag | [suffix len] | [key \0] | val len | value      |
+ *  -------- -------  ------------------------------------------------------
+ *     4     varint  varint    varint                  varint  <val len>
+ *
+ * All variable length integers are unsigned LEB128. The low two bits of the
+ * tag say how the key is encoded, the rest is a number n:
+ *  DICT_KEY_LITERAL:  n is the key length, the key follows
+ *  DICT_KEY_INTERNED: the key is dict_wire_keys[n], nothing follows
+ *  DICT_KEY_PREFIXED: the key is dict_wire_prefixes[n] followed by the
+ *                     suffix, whose length comes next
+ *
+ * The magic reads as a negative count in the format above, which older
+ * versions reject instead of misparsing.
+ */
+
+#define DICT_COMPACT_MAGIC         0xFFDC0001
+#define DICT_VARINT_MAX            5
+
+#define DICT_KEY_LITERAL           0
+#define DICT_KEY_INTERNED          1
+#define DICT_KEY_PREFIXED          2
+#define DICT_KEY_TYPE_MASK         3
+#define DICT_KEY_TYPE_BITS         2
+
+/* The position of a key in these tables is its id on the wire: add new keys
+ * at the end only, and never remove or reorder them. */
+#define DICT_WIRE_KEYS                                                  \
+        DICT_WIRE_KEY ("gfid-req")                                      \
+        DICT_WIRE_KEY ("trusted.gfid")                                  \
+        DICT_WIRE_KEY ("trusted.glusterfs.dht")                         \
+        DICT_WIRE_KEY ("trusted.glusterfs.dht.linkto")                  \
+        DICT_WIRE_KEY ("trusted.glusterfs.dht.commithash")              \
+        DICT_WIRE_KEY ("trusted.afr.dirty")                             \
+        DICT_WIRE_KEY ("trusted.ec.config")                             \
+        DICT_WIRE_KEY ("trusted.ec.size")                               \
+        DICT_WIRE_KEY ("trusted.ec.version")                            \
+        DICT_WIRE_KEY ("trusted.ec.dirty")                              \
+        DICT_WIRE_KEY ("trusted.ec.heal")                               \
+        DICT_WIRE_KEY ("trusted.glusterfs.quota.size")                  \
+        DICT_WIRE_KEY ("trusted.glusterfs.quota.limit-set")             \
+        DICT_WIRE_KEY ("trusted.glusterfs.quota.limit-objects")         \
+        DICT_WIRE_KEY ("trusted.glusterfs.quota.dirty")                 \
+        DICT_WIRE_KEY ("trusted.glusterfs.shard.block-size")            \
+        DICT_WIRE_KEY ("trusted.glusterfs.shard.file-size")             \
+        DICT_WIRE_KEY ("trusted.bit-rot.version")                       \
+        DICT_WIRE_KEY ("trusted.bit-rot.signature")                     \
+        DICT_WIRE_KEY ("trusted.bit-rot.bad-file")                      \
+        DICT_WIRE_KEY ("trusted.glusterfs.volume-id")                   \
+        DICT_WIRE_KEY ("trusted.glusterfs.pathinfo")                    \
+        DICT_WIRE_KEY ("trusted.glusterfs.node-uuid")                   \
+        DICT_WIRE_KEY ("security.selinux")                              \
+        DICT_WIRE_KEY ("system.posix_acl_access")                       \
+        DICT_WIRE_KEY ("system.posix_acl_default")                      \
+        DICT_WIRE_KEY ("glusterfs.inodelk-count")                       \
+        DICT_WIRE_KEY ("glusterfs.entrylk-count")                       \
+        DICT_WIRE_KEY ("glusterfs.posixlk-count")                       \
+        DICT_WIRE_KEY ("glusterfs.inodelk-dom-count")                   \
+        DICT_WIRE_KEY ("glusterfs.parent-entrylk")                      \
+        DICT_WIRE_KEY ("glusterfs.open-fd-count")                       \
+        DICT_WIRE_KEY ("glusterfs.write-is-append")                     \
+        DICT_WIRE_KEY ("glusterfs.write-update-atomic")                 \
+        DICT_WIRE_KEY ("glusterfs.content")                             \
+        DICT_WIRE_KEY ("glusterfs.bad-inode")                           \
+        DICT_WIRE_KEY ("glusterfs.version.xchg")                        \
+        DICT_WIRE_KEY ("glusterfs.preop.parent.key")                    \
+        DICT_WIRE_KEY ("glusterfs-internal-fop")                        \
+        DICT_WIRE_KEY ("glusterfs.xattrop_index_gfid")                  \
+        DICT_WIRE_KEY ("glusterfs.xattrop_index_count")                 \
+        DICT_WIRE_KEY ("glusterfs.xattrop_dirty_gfid")                  \
+        DICT_WIRE_KEY ("glusterfs.xattrop_dirty_count")                 \
+        DICT_WIRE_KEY ("get-link-count")                                \
+        DICT_WIRE_KEY ("gf_request_link_count")                         \
+        DICT_WIRE_KEY ("link-count")                                    \
+        DICT_WIRE_KEY ("dht-get-iatt-in-xattr")                         \
+        DICT_WIRE_KEY ("unlink-only-if-dht-linkto-file")                \
+        DICT_WIRE_KEY ("dont-unlink-for-open-fd")                       \
+        DICT_WIRE_KEY ("changelog.rename-op")                           \
+        DICT_WIRE_KEY ("list-xattr")
+
+/* longer prefixes before the shorter ones they start with */
+static const char *dict_wire_prefixes[] = {
+        "trusted.glusterfs.quota.",
+        "trusted.glusterfs.",
+        "trusted.afr.",
+        "trusted.pgfid.",
+        "trusted.ec.",
+        "trusted.",
+        "glusterfs.",
+        "security.",
+        "user.",
+};
+
+#define DICT_WIRE_NPREFIXES  (sizeof (dict_wire_prefixes) /            \
+                              sizeof (dict_wire_prefixes[0]))
+
+/* all interned keys in one piece of memory, so that dict_key_is_interned()
+ * can tell them from allocated keys */
+static const char dict_wire_key_blob[] =
+#define DICT_WIRE_KEY(key) key "\0"
+        DICT_WIRE_KEYS
+#undef DICT_WIRE_KEY
+        ;
+
+#define DICT_WIRE_MAX_KEYS   256
+#define DICT_WIRE_HASH_SIZE  512     /* power of 2, > 2 * DICT_WIRE_MAX_KEYS */
+#define DICT_WIRE_KEY_MAX    1024    /* longest prefixed key */
+
+struct dict_wire_slot {
+        const char *key;
+        uint32_t    hash;       /* dict_key_hash(), as in data_pair_t */
+        int         id;
+};
+
+static const char            *dict_wire_keys[DICT_WIRE_MAX_KEYS];
+static struct dict_wire_slot  dict_wire_hash[DICT_WIRE_HASH_SIZE];
+static size_t                 dict_wire_prefix_len[DICT_WIRE_NPREFIXES];
+static char                   dict_wire_prefix_first[256]; /* any prefix
+                                                              starts so */
+static int                    dict_wire_nkeys;
+static pthread_once_t         dict_wire_once = PTHREAD_ONCE_INIT;
+
+static void
+dict_wire_keys_init (void)
+{
+        const char *key = NULL;
+        size_t      len = 0;
+        uint32_t    h   = 0;
+        int         i   = 0;
+
+        for (key = dict_wire_key_blob;
+             key < dict_wire_key_blob + sizeof (dict_wire_key_blob) - 1;
+             key += len + 1) {
+                GF_ASSERT (dict_wire_nkeys < DICT_WIRE_MAX_KEYS);
+
+                h = dict_key_hash (key, &len);
+                for (i = h & (DICT_WIRE_HASH_SIZE - 1);
+                     dict_wire_hash[i].key;
+                     i = (i + 1) & (DICT_WIRE_HASH_SIZE - 1))
+                        ;
+                dict_wire_hash[i].key = key;
+                dict_wire_hash[i].hash = h;
+                dict_wire_hash[i].id = dict_wire_nkeys;
+
+                dict_wire_keys[dict_wire_nkeys++] = key;
+        }
+
+        for (i = 0; i < DICT_WIRE_NPREFIXES; i++) {
+                dict_wire_prefix_len[i] = strlen (dict_wire_prefixes[i]);
+                dict_wire_prefix_first[(uint8_t) dict_wire_prefixes[i][0]] = 1;
+        }
+}
+
+gf_boolean_t
+dict_key_is_interned (const char *key)
+{
+        return (key >= dict_wire_key_blob &&
+                key < dict_wire_key_blob + sizeof (dict_wire_key_blob));
+}
+
+/* returns the id of the key of @pair or -1; the hash dict_set_lk() kept
+ * spares hashing it again */
+static int
+dict_wire_key_lookup (data_pair_t *pair)
+{
+        int i = 0;
+
+        for (i = pair->key_hash & (DICT_WIRE_HASH_SIZE - 1);
+             dict_wire_hash[i].key;
+             i = (i + 1) & (DICT_WIRE_HASH_SIZE - 1)) {
+                if (dict_wire_hash[i].hash == pair->key_hash &&
+                    !strcmp (dict_wire_hash[i].key, pair->key))
+                        return dict_wire_hash[i].id;
+        }
+
+        return -1;
+}
+
+/* @key is known to be one of dict_wire_keys[], which are in address order */
+static int
+dict_wire_key_id (const char *key)
+{
+        int lo  = 0;
+        int hi  = dict_wire_nkeys - 1;
+        int mid = 0;
+
+        while (lo < hi) {
+                mid = (lo + hi + 1) / 2;
+                if (key < dict_wire_keys[mid])
+                        hi = mid - 1;
+                else
+                        lo = mid;
+        }
+
+        return lo;
+}
+
+static inline char *
+dict_varint_put (char *buf, uint32_t val)
+{
+        while (val >= 0x80) {
+                *buf++ = (char)(val | 0x80);
+                val >>= 7;
+        }
+        *buf++ = (char)val;
+
+        return buf;
+}
+
+/* returns the position after the integer, or NULL if it does not end
+ * before @end */
+static inline char *
+dict_varint_get (char *buf, char *end, uint32_t *val)
+{
+        uint32_t result = 0;
+        int      shift  = 0;
+        uint8_t  byte   = 0;
+
+        do {
+                if (buf >= end || shift > 28)
+                        return NULL;
+                byte = (uint8_t)*buf++;
+                result |= (uint32_t)(byte & 0x7f) << shift;
+                shift += 7;
+        } while (byte & 0x80);
+
+        *val = result;
+        return buf;
+}
+
+/* how the key of one pair goes on the wire, worked out while sizing the
+ * buffer so that the key is looked at only once */
+struct dict_wire_enc {
+        uint32_t    tag;
+        uint32_t    len;        /* of @rest, which follows the tag */
+        const char *rest;       /* NULL for interned keys */
+};
+
+#define DICT_WIRE_ENC_STACK  32
+
+static void
+dict_wire_key_encode (data_pair_t *pair, struct dict_wire_enc *enc)
+{
+        size_t keylen = 0;
+        size_t plen   = 0;
+        int    id     = 0;
+        int    i      = 0;
+
+        if (dict_key_is_interned (pair->key))
+                id = dict_wire_key_id (pair->key);
+        else
+                id = dict_wire_key_lookup (pair);
+
+        if (id >= 0) {
+                enc->tag = (id << DICT_KEY_TYPE_BITS) | DICT_KEY_INTERNED;
+                enc->len = 0;
+                enc->rest = NULL;
+                return;
+        }
+
+        keylen = strlen (pair->key);
+
+        if (dict_wire_prefix_first[(uint8_t) pair->key[0]] &&
+            keylen < DICT_WIRE_KEY_MAX) {
+                for (i = 0; i < DICT_WIRE_NPREFIXES; i++) {
+                        plen = dict_wire_prefix_len[i];
+                        if (keylen > plen &&
+                            !memcmp (pair->key, dict_wire_prefixes[i], plen)) {
+                                enc->tag = (i << DICT_KEY_TYPE_BITS) |
+                                           DICT_KEY_PREFIXED;
+                                enc->len = keylen - plen;
+                                enc->rest = pair->key + plen;
+                                return;
+                        }
+                }
+        }
+
+        enc->tag = (keylen << DICT_KEY_TYPE_BITS) | DICT_KEY_LITERAL;
+        enc->len = keylen;
+        enc->rest = pair->key;
+}
+
+/* NB: to be called with this->lock held, @enc as set up by
+ * dict_allocate_and_serialize_compact() */
+static int
+dict_serialize_compact_lk (dict_t *this, struct dict_wire_enc *enc,
+                           char *buf, char *end)
+{
+        int           ret     = -EINVAL;
+        data_pair_t  *pair    = NULL;
+        char         *start   = buf;
+        int32_t       count   = 0;
+        uint32_t      netword = 0;
+
+        count = this->count;
+        netword = hton32 (DICT_COMPACT_MAGIC);
+        memcpy (buf, &netword, sizeof (netword));
+        buf += DICT_HDR_LEN;
+        buf = dict_varint_put (buf, count);
+
+        for (pair = this->members_list; count;
+             pair = pair->next, count--, enc++) {
+                if (buf + 3 * DICT_VARINT_MAX + enc->len + 1 +
+                    pair->value->len > end) {
+                        gf_msg ("dict", GF_LOG_ERROR, 0,
+                                LG_MSG_UNDERSIZED_BUF, "dict changed while "
+                                "being serialized");
+                        goto out;
+                }
+
+                buf = dict_varint_put (buf, enc->tag);
+                if (enc->rest) {
+                        if ((enc->tag & DICT_KEY_TYPE_MASK) ==
+                            DICT_KEY_PREFIXED)
+                                buf = dict_varint_put (buf, enc->len);
+                        memcpy (buf, enc->rest, enc->len + 1);
+                        buf += enc->len + 1;
+                }
+
+                buf = dict_varint_put (buf, pair->value->len);
+                if (pair->value->data && pair->value->len) {
+                        memcpy (buf, pair->value->data, pair->value->len);
+                        buf += pair->value->len;
+                }
+        }
+
+        ret = buf - start;
+out:
+        return ret;
+}
+
+/**
+ * dict_allocate_and_serialize_compact - serialize a dictionary in the compact
+ *                                       format into an allocated buffer
+ *
+ * @this:   dict to serialize
+ * @buf:    the allocated buffer is stored in here, to be freed by the caller
+ * @length: the length of the serialized dict
+ *
+ * Only for peers that announced to understand the format, dict_unserialize()
+ * takes either format.
+ *
+ * @return: success: 0
+ *          failure: -errno
+ */
+int32_t
+dict_allocate_and_serialize_compact (dict_t *this, char **buf, u_int *length)
+{
+        int                    ret   = -EINVAL;
+        size_t                 len   = 0;
+        data_pair_t           *pair  = NULL;
+        int32_t                count = 0;
+        int32_t                i     = 0;
+        struct dict_wire_enc   stack_enc[DICT_WIRE_ENC_STACK];
+        struct dict_wire_enc  *enc   = stack_enc;
+
+        if (!this || !buf) {
+                gf_msg_debug ("dict", 0, "dict OR buf is NULL");
+                goto out;
+        }
+
+        (void) pthread_once (&dict_wire_once, dict_wire_keys_init);
+
+        LOCK (&this->lock);
+        {
+                count = this->count;
+                if (count < 0) {
+                        gf_msg ("dict", GF_LOG_ERROR, EINVAL,
+                                LG_MSG_COUNT_LESS_THAN_ZERO, "count (%d) < 0!",
+                                count);
+                        goto unlock;
+                }
+
+                if (count > DICT_WIRE_ENC_STACK) {
+                        enc = GF_MALLOC (count * sizeof (*enc),
+                                         gf_common_mt_char);
+                        if (!enc) {
+                                ret = -ENOMEM;
+                                goto unlock;
+                        }
+                }
+
+                /* an upper bound, varints are taken at their longest */
+                len = DICT_HDR_LEN + DICT_VARINT_MAX;
+                for (pair = this->members_list, i = 0; i < count;
+                     pair = pair->next, i++) {
+                        if (!pair || !pair->key || !pair->value) {
+                                gf_msg ("dict", GF_LOG_ERROR, 0,
+                                        LG_MSG_PAIRS_LESS_THAN_COUNT, "less "
+                                        "than count data pairs found!");
+                                goto unlock;
+                        }
+
+                        if (pair->value->len < 0) {
+                                gf_msg ("dict", GF_LOG_ERROR, EINVAL,
+                                        LG_MSG_VALUE_LENGTH_LESS_THAN_ZERO,
+                                        "value->len (%d) < 0",
+                                        pair->value->len);
+                                goto unlock;
+                        }
+
+                        dict_wire_key_encode (pair, &enc[i]);
+                        len += 3 * DICT_VARINT_MAX + enc[i].len + 1 +
+                               pair->value->len;
+                }
+
+                *buf = GF_MALLOC (len, gf_common_mt_char);
+                if (*buf == NULL) {
+                        ret = -ENOMEM;
+                        goto unlock;
+                }
+
+                ret = dict_serialize_compact_lk (this, enc, *buf, *buf + len);
+                if (ret < 0) {
+                        GF_FREE (*buf);
+                        *buf = NULL;
+                        goto unlock;
+                }
+
+                if (length != NULL)
+                        *length = ret;
+                ret = 0;
+        }
+unlock:
+        UNLOCK (&this->lock);
+
+        if (enc != stack_enc)
+                GF_FREE (enc);
+out:
+        return ret;
+}
+
+static int32_t
+dict_unserialize_compact (char *orig_buf, int32_t size, dict_t **fill)
+{
+        char     *buf    = orig_buf + DICT_HDR_LEN;
+        char     *end    = orig_buf + size;
+        char     *key    = NULL;
+        char      keybuf[DICT_WIRE_KEY_MAX];
+        data_t   *value  = NULL;
+        uint32_t  count  = 0;
+        uint32_t  tag    = 0;
+        uint32_t  n      = 0;
+        uint32_t  len    = 0;
+        uint32_t  vallen = 0;
+        size_t    plen   = 0;
+        int       ret    = -1;
+        uint32_t  i      = 0;
+
+        (void) pthread_once (&dict_wire_once, dict_wire_keys_init);
+
+        buf = dict_varint_get (buf, end, &count);
+        if (!buf)
+                goto undersized;
+
+        (*fill)->count = 0;
+
+        for (i = 0; i < count; i++) {
+                buf = dict_varint_get (buf, end, &tag);
+                if (!buf)
+                        goto undersized;
+                n = tag >> DICT_KEY_TYPE_BITS;
+
+                switch (tag & DICT_KEY_TYPE_MASK) {
+                case DICT_KEY_INTERNED:
+                        if (n >= dict_wire_nkeys)
+                                goto bad_key;
+                        /* dict_set_lk() does not copy interned keys */
+                        key = (char *)dict_wire_keys[n];
+                        break;
+
+                case DICT_KEY_PREFIXED:
+                        if (n >= DICT_WIRE_NPREFIXES)
+                                goto bad_key;
+                        buf = dict_varint_get (buf, end, &len);
+                        if (!buf || len >= end - buf)
+                                goto undersized;
+                        plen = dict_wire_prefix_len[n];
+                        if (plen + len >= sizeof (keybuf) || buf[len] != '\0')
+                                goto bad_key;
+                        memcpy (keybuf, dict_wire_prefixes[n], plen);
+                        memcpy (keybuf + plen, buf, len + 1);
+                        key = keybuf;
+                        buf += len + 1;
+                        break;
+
+                case DICT_KEY_LITERAL:
+                        if (n >= end - buf)
+                                goto undersized;
+                        if (buf[n] != '\0')
+                                goto bad_key;
+                        key = buf;
+                        buf += n + 1;
+                        break;
+
+                default:
+                        goto bad_key;
+                }
+
+                buf = dict_varint_get (buf, end, &vallen);
+                if (!buf || vallen > end - buf || vallen > INT32_MAX)
+                        goto undersized;
+
+                value = get_new_data ();
+                if (!value)
+                        goto out;
+                value->len  = vallen;
+                value->data = memdup (buf, vallen);
+                value->is_static = 0;
+                buf += vallen;
+
+                dict_add (*fill, key, value);
+        }
+
+        ret = 0;
+        goto out;
+
+bad_key:
+        gf_msg_callingfn ("dict", GF_LOG_ERROR, EINVAL, LG_MSG_INVALID_ARG,
+                          "invalid key in compact dict (tag %u)", tag);
+        goto out;
+undersized:
+        gf_msg_callingfn ("dict", GF_LOG_ERROR, 0, LG_MSG_UNDERSIZED_BUF,
+                          "undersized buffer passed for compact dict "
+                          "(size %d)", size);
+out:
+        return ret;
+}
+
 /**
  * dict_unserialize - unserialize a buffer into a dict
  *
@@ -2712,6 +3315,11 @@ dict_unserialize (char *orig_buf, int32_t size, dict_t **fill)
         }
 
         memcpy (&hostord, buf, sizeof(hostord));
+        if ((uint32_t) ntoh32 (hostord) == DICT_COMPACT_MAGIC) {
+                ret = dict_unserialize_compact (orig_buf, size, fill);
+                goto out;
+        }
+
         count = ntoh32 (hostord);
         buf += DICT_HDR_LEN;
 
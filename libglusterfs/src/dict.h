@@ -23,13 +23,24 @@ typedef struct _dict dict_t;
 typedef struct _data_pair data_pair_t;
 
 
-#define GF_PROTOCOL_DICT_SERIALIZE(this,from_dict,to,len,ope,labl) do { \
+#define GF_PROTOCOL_DICT_SERIALIZE(this,from_dict,to,len,ope,labl)      \
+        GF_PROTOCOL_DICT_SERIALIZE_FMT (this, from_dict, to, len, ope, labl, \
+                                        _gf_false)
+
+/* @compact: the peer decodes dict_allocate_and_serialize_compact() output */
+#define GF_PROTOCOL_DICT_SERIALIZE_FMT(this,from_dict,to,len,ope,labl,compact) \
+        do {                                                            \
                 int    _ret     = 0;                                     \
                                                                         \
                 if (!from_dict)                                         \
                         break;                                          \
                                                                         \
-                _ret = dict_allocate_and_serialize (from_dict, to, &len);\
+                if (compact)                                            \
+                        _ret = dict_allocate_and_serialize_compact      \
+                                        (from_dict, to, &len);          \
+                else                                                    \
+                        _ret = dict_allocate_and_serialize (from_dict,  \
+                                                            to, &len);  \
                 if (_ret < 0) {                                          \
                         gf_msg (this->name, GF_LOG_WARNING, 0,          \
                                 LG_MSG_DICT_SERIAL_FAILED,            \
@@ -69,12 +80,22 @@ struct _data {
         gf_lock_t      lock;
 };
 
+/* A dict keeps its first DICT_INLINE_PAIRS pairs, and keys shorter than
+ * DICT_KEY_INLINE, inside the dict_t itself, so that the typical xdata dict
+ * is one allocation.  Lookups scan members_list until the dict grows past
+ * DICT_INDEX_MIN pairs, after which an open-addressed index is kept in
+ * "members".  Both are sized so that dict_t fits a 512 byte pool object. */
+#define DICT_INLINE_PAIRS       6
+#define DICT_KEY_INLINE         28
+#define DICT_INDEX_MIN          16
+
 struct _data_pair {
-        struct _data_pair *hash_next;
         struct _data_pair *prev;
         struct _data_pair *next;
         data_t            *value;
         char              *key;
+        uint32_t           key_hash;
+        char               key_inline[DICT_KEY_INLINE];
 };
 
 struct _dict {
@@ -87,9 +108,9 @@ struct _dict {
         char           *extra_free;
         char           *extra_stdfree;
         gf_lock_t       lock;
-        data_pair_t    *members_internal;
-        data_pair_t     free_pair;
-        gf_boolean_t    free_pair_in_use;
+        uint32_t        index_size;
+        uint32_t        inline_used;
+        data_pair_t     members_inline[DICT_INLINE_PAIRS];
 };
 
 typedef gf_boolean_t (*dict_match_t) (dict_t *d, char *k, data_t *v,
@@ -114,6 +135,9 @@ int32_t dict_serialize (dict_t *dict, char *buf);
 int32_t dict_unserialize (char *buf, int32_t size, dict_t **fill);
 
 int32_t dict_allocate_and_serialize (dict_t *this, char **buf, u_int *length);
+int32_t dict_allocate_and_serialize_compact (dict_t *this, char **buf,
+                                             u_int *length);
+gf_boolean_t dict_key_is_interned (const char *key);
 
 void dict_unref (dict_t *dict);
 dict_t *dict_ref (dict_t *dict);
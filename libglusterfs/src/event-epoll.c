@@ -22,10 +22,12 @@
 #include "common-utils.h"
 #include "syscall.h"
 #include "libglusterfs-messages.h"
+#include "statedump.h"
 
 
 #ifdef HAVE_SYS_EPOLL_H
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 
 struct event_slot_epoll {
@@ -35,6 +37,7 @@ struct event_slot_epoll {
 	int ref;
 	int do_close;
 	int in_handler;
+	int worker; /* owning poller when the pool is pinned, else -1 */
 	void *data;
 	event_handler_t handler;
 	gf_lock_t lock;
@@ -45,6 +48,22 @@ struct event_thread_data {
         int    event_index;
 };
 
+/* Per poller state.  The counters are only written by the poller owning the
+ * entry, nfds is protected by event_pool->mutex. */
+struct event_worker_epoll {
+        int       epfd;       /* private epoll fd, pinned mode only */
+        int       wakefd;     /* eventfd used to kick the poller out of
+                                 epoll_wait(), pinned mode only */
+        int       nfds;       /* fds pinned to this poller */
+        uint64_t  waits;      /* epoll_wait() calls returning events */
+        uint64_t  events;     /* events dispatched */
+        uint64_t  rearms;     /* EPOLL_CTL_MOD calls after a handler */
+        int       max_batch;  /* largest batch seen from epoll_wait() */
+};
+
+/* ev_data->idx of the wakefd registered in a pinned poller's epoll fd */
+#define EVENT_EPOLL_WAKE_IDX (-1)
+
 static struct event_slot_epoll *
 __event_newtable (struct event_pool *event_pool, int table_idx)
 {
@@ -58,6 +77,7 @@ __event_newtable (struct event_pool *event_pool, int table_idx)
 
 	for (i = 0; i < EVENT_EPOLL_SLOTS; i++) {
 		table[i].fd = -1;
+		table[i].worker = -1;
 		LOCK_INIT (&table[i].lock);
 	}
 
@@ -110,6 +130,7 @@ __event_slot_alloc (struct event_pool *event_pool, int fd)
 			gen = table[i].gen;
 			memset (&table[i], 0, sizeof (table[i]));
 			table[i].gen = gen + 1;
+			table[i].worker = -1;
 
 			LOCK_INIT (&table[i].lock);
 
@@ -239,6 +260,7 @@ event_pool_new_epoll (int count, int eventthreadcount)
 {
         struct event_pool *event_pool = NULL;
         int                epfd = -1;
+        int                i = 0;
 
         event_pool = GF_CALLOC (1, sizeof (*event_pool),
                                 gf_common_mt_event_pool);
@@ -258,6 +280,21 @@ event_pool_new_epoll (int count, int eventthreadcount)
                 goto out;
         }
 
+        event_pool->workers = GF_CALLOC (EVENT_MAX_THREADS,
+                                         sizeof (*event_pool->workers),
+                                         gf_common_mt_event_pool);
+        if (!event_pool->workers) {
+                sys_close (epfd);
+                GF_FREE (event_pool);
+                event_pool = NULL;
+                goto out;
+        }
+
+        for (i = 0; i < EVENT_MAX_THREADS; i++) {
+                event_pool->workers[i].epfd = -1;
+                event_pool->workers[i].wakefd = -1;
+        }
+
         event_pool->fd = epfd;
 
         event_pool->count = count;
@@ -309,6 +346,183 @@ __slot_update_events (struct event_slot_epoll *slot, int poll_in, int poll_out)
 }
 
 
+static int
+__slot_epfd (struct event_pool *event_pool, struct event_slot_epoll *slot)
+{
+        if (slot->worker == -1)
+                return event_pool->fd;
+
+        return event_pool->workers[slot->worker].epfd;
+}
+
+
+/* Creates the private epoll fd of poller @index (0 based) and the eventfd
+ * used to wake it up, unless they already exist. */
+static int
+__event_worker_init (struct event_pool *event_pool, int index)
+{
+        struct event_worker_epoll *worker = NULL;
+        struct epoll_event         epoll_event = {0, };
+        struct event_data         *ev_data = (void *)&epoll_event.data;
+        int                        ret = -1;
+
+        worker = &event_pool->workers[index];
+        if (worker->epfd != -1)
+                return 0;
+
+        worker->epfd = epoll_create (event_pool->count);
+        if (worker->epfd == -1) {
+                gf_msg ("epoll", GF_LOG_ERROR, errno,
+                        LG_MSG_EPOLL_FD_CREATE_FAILED, "epoll fd creation "
+                        "failed for poller %d", index + 1);
+                goto out;
+        }
+
+        worker->wakefd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (worker->wakefd == -1) {
+                gf_msg ("epoll", GF_LOG_ERROR, errno,
+                        LG_MSG_EPOLL_FD_CREATE_FAILED, "eventfd creation "
+                        "failed for poller %d", index + 1);
+                goto err;
+        }
+
+        epoll_event.events = EPOLLIN;
+        ev_data->idx = EVENT_EPOLL_WAKE_IDX;
+        ev_data->gen = 0;
+
+        ret = epoll_ctl (worker->epfd, EPOLL_CTL_ADD, worker->wakefd,
+                         &epoll_event);
+        if (ret == -1) {
+                gf_msg ("epoll", GF_LOG_ERROR, errno,
+                        LG_MSG_EPOLL_FD_ADD_FAILED, "failed to add wakeup "
+                        "fd(=%d) to epoll fd(=%d)", worker->wakefd,
+                        worker->epfd);
+                goto err;
+        }
+
+        return 0;
+err:
+        sys_close (worker->epfd);
+        worker->epfd = -1;
+        if (worker->wakefd != -1) {
+                sys_close (worker->wakefd);
+                worker->wakefd = -1;
+        }
+out:
+        return -1;
+}
+
+
+/* Returns the least loaded of the configured pollers other than @exclude,
+ * or -1 if none is usable. */
+static int
+__event_worker_pick (struct event_pool *event_pool, int exclude)
+{
+        int i = 0;
+        int count = 0;
+        int best = -1;
+
+        count = event_pool->eventthreadcount;
+        if (count > EVENT_MAX_THREADS)
+                count = EVENT_MAX_THREADS;
+        if (count <= 0)
+                count = 1;
+
+        for (i = 0; i < count; i++) {
+                if (i == exclude)
+                        continue;
+                /* once dispatching, skip pollers that failed to start */
+                if (event_pool->pollers[0] && !event_pool->pollers[i])
+                        continue;
+                if (__event_worker_init (event_pool, i))
+                        continue;
+                if (best == -1 ||
+                    event_pool->workers[i].nfds < event_pool->workers[best].nfds)
+                        best = i;
+        }
+
+        return best;
+}
+
+
+static void
+__event_worker_wake (struct event_pool *event_pool, int index)
+{
+        uint64_t one = 1;
+
+        if (event_pool->workers[index].wakefd == -1)
+                return;
+
+        (void) sys_write (event_pool->workers[index].wakefd, &one,
+                          sizeof (one));
+}
+
+
+/* Called by a pinned poller that is about to exit: hands every fd it owns
+ * over to the remaining pollers. NB: called under event_pool->mutex. */
+static void
+__event_worker_migrate (struct event_pool *event_pool, int index)
+{
+        struct event_slot_epoll *table = NULL;
+        struct event_slot_epoll *slot = NULL;
+        struct epoll_event       epoll_event = {0, };
+        struct event_data       *ev_data = (void *)&epoll_event.data;
+        int                      i = 0;
+        int                      j = 0;
+        int                      target = -1;
+        int                      ret = -1;
+
+        for (i = 0; i < EVENT_EPOLL_TABLES; i++) {
+                table = event_pool->ereg[i];
+                if (!table || !event_pool->slots_used[i])
+                        continue;
+
+                for (j = 0; j < EVENT_EPOLL_SLOTS; j++) {
+                        slot = &table[j];
+
+                        LOCK (&slot->lock);
+                        {
+                                if (slot->fd == -1 || slot->worker != index)
+                                        goto next;
+
+                                target = __event_worker_pick (event_pool,
+                                                              index);
+                                if (target == -1)
+                                        goto next;
+
+                                epoll_ctl (event_pool->workers[index].epfd,
+                                           EPOLL_CTL_DEL, slot->fd, NULL);
+
+                                epoll_event.events = slot->events;
+                                ev_data->idx = i * EVENT_EPOLL_SLOTS + j;
+                                ev_data->gen = slot->gen;
+
+                                ret = epoll_ctl (event_pool->workers[target].epfd,
+                                                 EPOLL_CTL_ADD, slot->fd,
+                                                 &epoll_event);
+                                if (ret == -1) {
+                                        gf_msg ("epoll", GF_LOG_ERROR, errno,
+                                                LG_MSG_EPOLL_FD_MIGRATE_FAILED,
+                                                "failed to move fd(=%d) from "
+                                                "poller %d to poller %d",
+                                                slot->fd, index + 1,
+                                                target + 1);
+                                        slot->worker = -1;
+                                        event_pool->workers[index].nfds--;
+                                        goto next;
+                                }
+
+                                slot->worker = target;
+                                event_pool->workers[index].nfds--;
+                                event_pool->workers[target].nfds++;
+                        }
+                next:
+                        UNLOCK (&slot->lock);
+                }
+        }
+}
+
+
 int
 event_register_epoll (struct event_pool *event_pool, int fd,
                       event_handler_t handler,
@@ -353,39 +567,65 @@ event_register_epoll (struct event_pool *event_pool, int fd,
 
 	assert (slot->fd == fd);
 
+        /* with pinned pollers, hold the pool mutex so that the chosen
+           poller cannot hand its fds over (__event_worker_migrate())
+           before this one is added to its epoll fd
+        */
+        if (event_pool->pinned)
+                pthread_mutex_lock (&event_pool->mutex);
+
 	LOCK (&slot->lock);
 	{
-		/* make epoll 'singleshot', which
-		   means we need to re-add the fd with
-		   epoll_ctl(EPOLL_CTL_MOD) after delivery of every
-		   single event. This assures us that while a poller
-		   thread has picked up and is processing an event,
-		   another poller will not try to pick this at the same
-		   time as well.
-		*/
-
-		slot->events = EPOLLPRI | EPOLLHUP | EPOLLERR | EPOLLONESHOT;
+		slot->events = EPOLLPRI | EPOLLHUP | EPOLLERR;
 		slot->handler = handler;
 		slot->data = data;
 
+                if (event_pool->pinned) {
+                        /* only the owning poller ever waits on this fd,
+                           so handlers are naturally serialized and the
+                           fd can stay armed.
+                        */
+                        slot->worker = __event_worker_pick (event_pool, -1);
+                        if (slot->worker == -1)
+                                goto unlock;
+                } else {
+                        /* make epoll 'singleshot', which
+                           means we need to re-add the fd with
+                           epoll_ctl(EPOLL_CTL_MOD) after delivery of every
+                           single event. This assures us that while a poller
+                           thread has picked up and is processing an event,
+                           another poller will not try to pick this at the
+                           same time as well.
+                        */
+                        slot->events |= EPOLLONESHOT;
+                }
+
 		__slot_update_events (slot, poll_in, poll_out);
 
 		epoll_event.events = slot->events;
 		ev_data->idx = idx;
 		ev_data->gen = slot->gen;
 
-		ret = epoll_ctl (event_pool->fd, EPOLL_CTL_ADD, fd,
-				 &epoll_event);
+		ret = epoll_ctl (__slot_epfd (event_pool, slot), EPOLL_CTL_ADD,
+                                 fd, &epoll_event);
 		/* check ret after UNLOCK() to avoid deadlock in
 		   event_slot_unref()
 		*/
+                if (ret == -1)
+                        slot->worker = -1;
+                else if (slot->worker != -1)
+                        event_pool->workers[slot->worker].nfds++;
 	}
+unlock:
 	UNLOCK (&slot->lock);
 
+        if (event_pool->pinned)
+                pthread_mutex_unlock (&event_pool->mutex);
+
 	if (ret == -1) {
 		gf_msg ("epoll", GF_LOG_ERROR, errno,
                         LG_MSG_EPOLL_FD_ADD_FAILED, "failed to add fd(=%d) to "
-                        "epoll fd(=%d)", fd, event_pool->fd);
+                        "epoll", fd);
 		event_slot_unref (event_pool, slot, idx);
 		idx = -1;
 	}
@@ -401,6 +641,7 @@ event_unregister_epoll_common (struct event_pool *event_pool, int fd,
 			       int idx, int do_close)
 {
         int  ret = -1;
+        int  worker = -1;
 	struct event_slot_epoll *slot = NULL;
 
         GF_VALIDATE_OR_GOTO ("event", event_pool, out);
@@ -411,22 +652,34 @@ event_unregister_epoll_common (struct event_pool *event_pool, int fd,
 
 	LOCK (&slot->lock);
 	{
-                ret = epoll_ctl (event_pool->fd, EPOLL_CTL_DEL, fd, NULL);
+                ret = epoll_ctl (__slot_epfd (event_pool, slot),
+                                 EPOLL_CTL_DEL, fd, NULL);
 
                 if (ret == -1) {
                         gf_msg ("epoll", GF_LOG_ERROR, errno,
                                 LG_MSG_EPOLL_FD_DEL_FAILED, "fail to del "
                                 "fd(=%d) from epoll fd(=%d)", fd,
-                                event_pool->fd);
+                                __slot_epfd (event_pool, slot));
                         goto unlock;
                 }
 
 		slot->do_close = do_close;
 		slot->gen++; /* detect unregister in dispatch_handler() */
+
+                worker = slot->worker;
+                slot->worker = -1;
         }
 unlock:
 	UNLOCK (&slot->lock);
 
+        if (worker != -1) {
+                pthread_mutex_lock (&event_pool->mutex);
+                {
+                        event_pool->workers[worker].nfds--;
+                }
+                pthread_mutex_unlock (&event_pool->mutex);
+        }
+
 	event_slot_unref (event_pool, slot, idx); /* one for event_register() */
 	event_slot_unref (event_pool, slot, idx); /* one for event_slot_get() */
 out:
@@ -462,6 +715,7 @@ event_select_on_epoll (struct event_pool *event_pool, int fd, int idx,
                        int poll_in, int poll_out)
 {
         int ret = -1;
+        int old_events = 0;
 	struct event_slot_epoll *slot = NULL;
         struct epoll_event epoll_event = {0, };
         struct event_data *ev_data = (void *)&epoll_event.data;
@@ -475,13 +729,21 @@ event_select_on_epoll (struct event_pool *event_pool, int fd, int idx,
 
 	LOCK (&slot->lock);
 	{
+                old_events = slot->events;
 		__slot_update_events (slot, poll_in, poll_out);
 
 		epoll_event.events = slot->events;
 		ev_data->idx = idx;
 		ev_data->gen = slot->gen;
 
-		if (slot->in_handler)
+                if (slot->worker != -1) {
+                        /* pinned fds are level triggered and never
+                           need re-arming, so only tell epoll about an
+                           actual change of interest.
+                        */
+                        if (slot->events == old_events)
+                                goto unlock;
+                } else if (slot->in_handler)
 			/* in_handler indicates at least one thread
 			   executing event_dispatch_epoll_handler()
 			   which will perform epoll_ctl(EPOLL_CTL_MOD)
@@ -496,8 +758,8 @@ event_select_on_epoll (struct event_pool *event_pool, int fd, int idx,
 			*/
 			goto unlock;
 
-		ret = epoll_ctl (event_pool->fd, EPOLL_CTL_MOD, fd,
-				 &epoll_event);
+		ret = epoll_ctl (__slot_epfd (event_pool, slot), EPOLL_CTL_MOD,
+                                 fd, &epoll_event);
 		if (ret == -1) {
 			gf_msg ("epoll", GF_LOG_ERROR, errno,
                                 LG_MSG_EPOLL_FD_MODIFY_FAILED, "failed to "
@@ -517,7 +779,8 @@ out:
 
 static int
 event_dispatch_epoll_handler (struct event_pool *event_pool,
-                              struct epoll_event *event)
+                              struct epoll_event *event,
+                              struct event_worker_epoll *self)
 {
         struct event_data  *ev_data = NULL;
 	struct event_slot_epoll *slot = NULL;
@@ -591,12 +854,14 @@ pre_unlock:
 
 		/* This call also picks up the changes made by another
 		   thread calling event_select_on_epoll() while this
-		   thread was busy in handler()
+		   thread was busy in handler(). Pinned fds were never
+		   disarmed and need no re-arming.
 		*/
-                if (slot->in_handler == 0) {
+                if (slot->worker == -1 && slot->in_handler == 0) {
                         event->events = slot->events;
                         ret = epoll_ctl (event_pool->fd, EPOLL_CTL_MOD,
                                          fd, event);
+                        self->rearms++;
                 }
 	}
 post_unlock:
@@ -611,12 +876,17 @@ out:
 static void *
 event_dispatch_epoll_worker (void *data)
 {
-        struct epoll_event  event;
+        struct epoll_event  events[EVENT_EPOLL_BATCH];
         int                 ret = -1;
         struct event_thread_data *ev_data = data;
 	struct event_pool  *event_pool;
+        struct event_worker_epoll *self = NULL;
         int                 myindex = -1;
         int                 timetodie = 0;
+        int                 epfd = -1;
+        int                 maxevents = 1;
+        int                 i = 0;
+        uint64_t            wakeups = 0;
 
         GF_VALIDATE_OR_GOTO ("event", ev_data, out);
 
@@ -628,12 +898,35 @@ event_dispatch_epoll_worker (void *data)
         gf_msg ("epoll", GF_LOG_INFO, 0, LG_MSG_STARTED_EPOLL_THREAD, "Started"
                 " thread with index %d", myindex);
 
+        self = &event_pool->workers[myindex - 1];
+
         pthread_mutex_lock (&event_pool->mutex);
         {
                 event_pool->activethreadcount++;
+
+                if (event_pool->pinned) {
+                        if (__event_worker_init (event_pool, myindex - 1)) {
+                                event_pool->pollers[myindex - 1] = 0;
+                                event_pool->activethreadcount--;
+                                timetodie = 1;
+                        }
+                        epfd = self->epfd;
+                        /* every event on this epoll fd is ours to handle,
+                           so fetch as many as are ready. Shared pollers
+                           keep taking one at a time, so that a slow
+                           handler does not hold up events another idle
+                           poller could be handling.
+                        */
+                        maxevents = EVENT_EPOLL_BATCH;
+                } else {
+                        epfd = event_pool->fd;
+                }
         }
         pthread_mutex_unlock (&event_pool->mutex);
 
+        if (timetodie)
+                goto out;
+
 	for (;;) {
                 if (event_pool->eventthreadcount < myindex) {
                         /* ...time to die, thread count was decreased below
@@ -645,6 +938,12 @@ event_dispatch_epoll_worker (void *data)
                         {
                                 if (event_pool->eventthreadcount <
                                     myindex) {
+                                        /* hand our fds over while nobody
+                                         * can register new ones */
+                                        if (event_pool->pinned)
+                                                __event_worker_migrate (
+                                                        event_pool,
+                                                        myindex - 1);
                                         /* if found true in critical section,
                                          * die */
                                         event_pool->pollers[myindex - 1] = 0;
@@ -662,7 +961,7 @@ event_dispatch_epoll_worker (void *data)
                         }
                 }
 
-                ret = epoll_wait (event_pool->fd, &event, 1, -1);
+                ret = epoll_wait (epfd, events, maxevents, -1);
 
                 if (ret == 0)
                         /* timeout */
@@ -672,7 +971,26 @@ event_dispatch_epoll_worker (void *data)
                         /* sys call */
                         continue;
 
-		ret = event_dispatch_epoll_handler (event_pool, &event);
+                if (ret < 0)
+                        continue;
+
+                self->waits++;
+                self->events += ret;
+                if (ret > self->max_batch)
+                        self->max_batch = ret;
+
+                for (i = 0; i < ret; i++) {
+                        if (((struct event_data *)&events[i].data)->idx ==
+                            EVENT_EPOLL_WAKE_IDX) {
+                                /* reconfigure or destroy kicked us */
+                                (void) sys_read (self->wakefd, &wakeups,
+                                                 sizeof (wakeups));
+                                continue;
+                        }
+
+                        event_dispatch_epoll_handler (event_pool, &events[i],
+                                                      self);
+                }
         }
 out:
         if (ev_data)
@@ -852,12 +1170,94 @@ event_reconfigure_threads_epoll (struct event_pool *event_pool, int value)
 
                 /* if value decreases, threads will terminate, themselves */
                 event_pool->eventthreadcount = value;
+
+                /* pinned pollers only wait on their own epoll fd, which
+                 * may be idle, so nudge the ones that have to go */
+                if (event_pool->pinned) {
+                        for (i = value; i < oldthreadcount &&
+                                        i < EVENT_MAX_THREADS; i++) {
+                                if (event_pool->pollers[i] != 0)
+                                        __event_worker_wake (event_pool, i);
+                        }
+                }
         }
         pthread_mutex_unlock (&event_pool->mutex);
 
         return 0;
 }
 
+static int
+event_pool_pin_workers_epoll (struct event_pool *event_pool)
+{
+        int i = 0;
+        int ret = -1;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                if (event_pool_dispatched_unlocked (event_pool))
+                        goto unlock;
+
+                for (i = 0; i < EVENT_EPOLL_TABLES; i++) {
+                        if (event_pool->slots_used[i])
+                                goto unlock;
+                }
+
+                event_pool->pinned = 1;
+                ret = 0;
+        }
+unlock:
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        if (ret)
+                gf_msg ("epoll", GF_LOG_WARNING, 0, LG_MSG_PIN_WORKERS_FAILED,
+                        "fds are already registered, not pinning them to "
+                        "poller threads");
+
+        return ret;
+}
+
+
+static void
+event_pool_dump_epoll (struct event_pool *event_pool)
+{
+        struct event_worker_epoll *worker = NULL;
+        char                       key[GF_DUMP_MAX_BUF_LEN];
+        int                        i = 0;
+
+        /* avoid statedump hanging on a wedged event pool */
+        if (pthread_mutex_trylock (&event_pool->mutex))
+                return;
+
+        gf_proc_dump_add_section ("event-pool");
+        gf_proc_dump_write ("mode", "%s",
+                            event_pool->pinned ? "pinned" : "shared");
+        gf_proc_dump_write ("eventthreadcount", "%d",
+                            event_pool->eventthreadcount);
+        gf_proc_dump_write ("activethreadcount", "%d",
+                            event_pool->activethreadcount);
+        gf_proc_dump_write ("auto_thread_count", "%d",
+                            event_pool->auto_thread_count);
+
+        for (i = 0; i < EVENT_MAX_THREADS; i++) {
+                if (event_pool->pollers[i] == 0)
+                        continue;
+
+                worker = &event_pool->workers[i];
+
+                snprintf (key, sizeof (key), "event-pool.poller.%d", i + 1);
+                gf_proc_dump_add_section ("%s", key);
+                if (event_pool->pinned)
+                        gf_proc_dump_write ("pinned_fds", "%d", worker->nfds);
+                gf_proc_dump_write ("epoll_waits", "%"PRIu64, worker->waits);
+                gf_proc_dump_write ("events", "%"PRIu64, worker->events);
+                gf_proc_dump_write ("rearms", "%"PRIu64, worker->rearms);
+                gf_proc_dump_write ("max_batch", "%d", worker->max_batch);
+        }
+
+        pthread_mutex_unlock (&event_pool->mutex);
+}
+
+
 /* This function is the destructor for the event_pool data structure
  * Should be called only after poller_threads_destroy() is called,
  * else will lead to crashes.
@@ -881,9 +1281,17 @@ event_pool_destroy_epoll (struct event_pool *event_pool)
                 }
         }
 
+        for (i = 0; i < EVENT_MAX_THREADS; i++) {
+                if (event_pool->workers[i].epfd != -1)
+                        sys_close (event_pool->workers[i].epfd);
+                if (event_pool->workers[i].wakefd != -1)
+                        sys_close (event_pool->workers[i].wakefd);
+        }
+
         pthread_mutex_destroy (&event_pool->mutex);
         pthread_cond_destroy (&event_pool->cond);
 
+        GF_FREE (event_pool->workers);
         GF_FREE (event_pool->evcache);
         GF_FREE (event_pool->reg);
         GF_FREE (event_pool);
@@ -899,7 +1307,9 @@ struct event_ops event_ops_epoll = {
         .event_unregister_close    = event_unregister_close_epoll,
         .event_dispatch            = event_dispatch_epoll,
         .event_reconfigure_threads = event_reconfigure_threads_epoll,
-        .event_pool_destroy        = event_pool_destroy_epoll
+        .event_pool_destroy        = event_pool_destroy_epoll,
+        .event_pool_pin_workers    = event_pool_pin_workers_epoll,
+        .event_pool_dump           = event_pool_dump_epoll
 };
 
 #endif
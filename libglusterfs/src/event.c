@@ -167,6 +167,38 @@ out:
         return ret;
 }
 
+/* Switch the pool to one epoll fd per poller thread, with every registered fd
+ * pinned to a single poller.  Only possible before the first registration. */
+int
+event_pool_pin_workers (struct event_pool *event_pool)
+{
+        int ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        if (!event_pool->ops->event_pool_pin_workers) {
+                gf_msg ("event", GF_LOG_WARNING, ENOTSUP,
+                        LG_MSG_PIN_WORKERS_FAILED, "pinning fds to poller "
+                        "threads is not supported by this event backend");
+                goto out;
+        }
+
+        ret = event_pool->ops->event_pool_pin_workers (event_pool);
+out:
+        return ret;
+}
+
+
+void
+event_pool_dump (struct event_pool *event_pool)
+{
+        if (!event_pool || !event_pool->ops->event_pool_dump)
+                return;
+
+        event_pool->ops->event_pool_dump (event_pool);
+}
+
+
 int
 poller_destroy_handler (int fd, int idx, void *data,
                        int poll_out, int poll_in, int poll_err)
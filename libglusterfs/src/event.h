@@ -17,6 +17,7 @@ struct event_pool;
 struct event_ops;
 struct event_slot_poll;
 struct event_slot_epoll;
+struct event_worker_epoll;
 struct event_data {
 	int idx;
 	int gen;
@@ -29,6 +30,7 @@ typedef int (*event_handler_t) (int fd, int idx, void *data,
 #define EVENT_EPOLL_TABLES 1024
 #define EVENT_EPOLL_SLOTS 1024
 #define EVENT_MAX_THREADS  1024
+#define EVENT_EPOLL_BATCH  32
 
 struct event_pool {
 	struct event_ops *ops;
@@ -71,6 +73,17 @@ struct event_pool {
          */
         int auto_thread_count;
 
+        /*
+         * When set, every registered fd is pinned to one poller thread,
+         * each of which waits on its own epoll fd.  Events are then picked
+         * up in batches of up to EVENT_EPOLL_BATCH and the fd never has to
+         * be re-armed after its handler ran (no EPOLLONESHOT).  Must be
+         * chosen before the first fd is registered, see
+         * event_pool_pin_workers().
+         */
+        int pinned;
+        struct event_worker_epoll *workers; /* EVENT_MAX_THREADS entries */
+
 };
 
 struct event_ops {
@@ -93,6 +106,10 @@ struct event_ops {
         int (*event_reconfigure_threads) (struct event_pool *event_pool,
                                           int newcount);
         int (*event_pool_destroy) (struct event_pool *event_pool);
+
+        int (*event_pool_pin_workers) (struct event_pool *event_pool);
+
+        void (*event_pool_dump) (struct event_pool *event_pool);
 };
 
 struct event_pool *event_pool_new (int count, int eventthreadcount);
@@ -107,4 +124,6 @@ int event_dispatch (struct event_pool *event_pool);
 int event_reconfigure_threads (struct event_pool *event_pool, int value);
 int event_pool_destroy (struct event_pool *event_pool);
 int event_dispatch_destroy (struct event_pool *event_pool);
+int event_pool_pin_workers (struct event_pool *event_pool);
+void event_pool_dump (struct event_pool *event_pool);
 #endif /* _EVENT_H_ */
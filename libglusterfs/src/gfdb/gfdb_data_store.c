@@ -395,6 +395,47 @@ insert_record (gfdb_conn_node_t *_conn_node,
 
 
 
+/*Libgfdb API Function: Used to update the heat of many files at once
+ *                      Refer CTR Xlator features/changetimerecorder for usage
+ * Arguments:
+ *      _conn_node     :  GFDB Connection node
+ *      heat_records   :  Array of heat records
+ *      count          :  Number of records in the array
+ * Returns : if successful return 0 or
+ *          -ve value in case of failure*/
+int
+insert_heat_records (gfdb_conn_node_t *_conn_node,
+                     gfdb_heat_record_t *heat_records, int count)
+{
+        int ret                                 = 0;
+        gfdb_db_operations_t *db_operations_t   = NULL;
+        void *gf_db_connection                  = NULL;
+
+        CHECK_CONN_NODE(_conn_node);
+
+        if (count <= 0)
+                return 0;
+
+        db_operations_t = &_conn_node->gfdb_connection.gfdb_db_operations;
+        gf_db_connection = _conn_node->gfdb_connection.gf_db_connection;
+
+        if (db_operations_t->insert_heat_records_op) {
+                ret = db_operations_t->insert_heat_records_op (
+                                                gf_db_connection,
+                                                heat_records, count);
+                if (ret) {
+                        gf_msg (GFDB_DATA_STORE, GF_LOG_ERROR, 0,
+                                LG_MSG_INSERT_OR_UPDATE_FAILED, "Batched "
+                                "heat update of %d records failed", count);
+                }
+        }
+
+        return ret;
+}
+
+
+
+
 /*Libgfdb API Function: Used to delete record from the database
  *                      NOTE: In the current gfdb_sqlite3 plugin
  *                      implementation this function is dummy.
@@ -85,6 +85,22 @@ insert_record(gfdb_conn_node_t *, gfdb_db_record_t *gfdb_db_record);
 
 
 
+/*Libgfdb API Function: Used to update the heat i.e access/change times and
+ *                      frequency counters of many files at once. All the
+ *                      records are applied in a single transaction.
+ *                      Refer CTR Xlator features/changetimerecorder for usage
+ * Arguments:
+ *      _conn_node     :  GFDB Connection node
+ *      heat_records   :  Array of heat records
+ *      count          :  Number of records in the array
+ * Returns : if successful return 0 or
+ *          -ve value in case of failure*/
+int
+insert_heat_records (gfdb_conn_node_t *_conn_node,
+                     gfdb_heat_record_t *heat_records, int count);
+
+
+
 
 /*Libgfdb API Function: Used to delete record from the database
  *                      NOTE: In the current gfdb_sqlite3 plugin
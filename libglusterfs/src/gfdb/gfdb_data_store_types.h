@@ -279,6 +279,21 @@ typedef struct gfdb_db_record {
 } gfdb_db_record_t;
 
 
+/* Heat of one inode accumulated over many fops, used to update the
+ * times and counters of GF_FILE_TB in bulk using insert_heat_records api.
+ * A zero time leaves the corresponding column untouched and the counters
+ * are added to the ones already in the database. */
+typedef struct gfdb_heat_record {
+        uuid_t                          gfid;
+        gfdb_time_t                     write_wind_time;
+        gfdb_time_t                     write_unwind_time;
+        gfdb_time_t                     read_wind_time;
+        gfdb_time_t                     read_unwind_time;
+        uint32_t                        write_freq;
+        uint32_t                        read_freq;
+} gfdb_heat_record_t;
+
+
 /*******************************************************************************
  *
  *                           Signatures for the plugin functions
@@ -331,6 +346,20 @@ typedef int
 
 
 
+/*Used to apply a batch of heat records in a single transaction
+ * Arguments:
+ *      db_conn        : plugin specific data base connection
+ *      heat_records   : Array of heat records
+ *      count          : Number of records in the array
+ * Returns : if successful return 0 or
+ *          -ve value in case of failure*/
+typedef int
+(*gfdb_insert_heat_records_t)(void *db_conn,
+                              gfdb_heat_record_t *heat_records,
+                              int count);
+
+
+
 
 /*Used to delete record from the database
  * Arguments:
@@ -492,6 +521,7 @@ typedef struct gfdb_db_operations {
         gfdb_init_db_t                        init_db_op;
         gfdb_fini_db_t                        fini_db_op;
         gfdb_insert_record_t                  insert_record_op;
+        gfdb_insert_heat_records_t            insert_heat_records_op;
         gfdb_delete_record_t                  delete_record_op;
         gfdb_compact_db_t                     compact_db_op;
         gfdb_find_all_t                       find_all_op;
@@ -29,8 +29,11 @@ gf_sql_connection_init ()
                 gf_msg (GFDB_STR_SQLITE3, GF_LOG_ERROR, ENOMEM,
                         LG_MSG_NO_MEMORY, "Error allocating memory to "
                         "gf_sql_connection_t ");
+                goto out;
         }
 
+        pthread_mutex_init (&gf_sql_conn->write_lock, NULL);
+out:
         return gf_sql_conn;
 }
 
@@ -39,6 +42,8 @@ gf_sql_connection_fini (gf_sql_connection_t **sql_connection)
 {
         if (!sql_connection)
                 return;
+        if (*sql_connection)
+                pthread_mutex_destroy (&(*sql_connection)->write_lock);
         GF_FREE (*sql_connection);
         *sql_connection = NULL;
 }
@@ -238,6 +243,7 @@ gf_sqlite3_fill_db_operations(gfdb_db_operations_t  *gfdb_db_ops)
         gfdb_db_ops->fini_db_op = gf_sqlite3_fini;
 
         gfdb_db_ops->insert_record_op = gf_sqlite3_insert;
+        gfdb_db_ops->insert_heat_records_op = gf_sqlite3_insert_heat;
         gfdb_db_ops->delete_record_op = gf_sqlite3_delete;
         gfdb_db_ops->compact_db_op = gf_sqlite3_vacuum;
 
@@ -524,10 +530,13 @@ int gf_sqlite3_insert(void *db_conn, gfdb_db_record_t *gfdb_db_record)
 {
         int ret                         =       -1;
         gf_sql_connection_t *sql_conn   =       db_conn;
+        gf_boolean_t locked             =       _gf_false;
 
         CHECK_SQL_CONN(sql_conn, out);
         GF_VALIDATE_OR_GOTO(GFDB_STR_SQLITE3, gfdb_db_record, out);
 
+        pthread_mutex_lock (&sql_conn->write_lock);
+        locked = _gf_true;
 
         switch (gfdb_db_record->gfdb_fop_path) {
         case GFDB_FOP_WIND:
@@ -576,6 +585,34 @@ int gf_sqlite3_insert(void *db_conn, gfdb_db_record_t *gfdb_db_record)
                 goto out;
         }
 
+        ret = 0;
+out:
+        if (locked)
+                pthread_mutex_unlock (&sql_conn->write_lock);
+        return ret;
+}
+
+int
+gf_sqlite3_insert_heat (void *db_conn, gfdb_heat_record_t *heat_records,
+                        int count)
+{
+        int ret                         =       -1;
+        gf_sql_connection_t *sql_conn   =       db_conn;
+
+        CHECK_SQL_CONN(sql_conn, out);
+        GF_VALIDATE_OR_GOTO(GFDB_STR_SQLITE3, heat_records, out);
+
+        pthread_mutex_lock (&sql_conn->write_lock);
+        {
+                ret = gf_sql_update_heat (sql_conn, heat_records, count);
+        }
+        pthread_mutex_unlock (&sql_conn->write_lock);
+        if (ret) {
+                gf_msg (GFDB_STR_SQLITE3, GF_LOG_ERROR, 0,
+                        LG_MSG_UPDATE_FAILED, "Failed batched heat update");
+                goto out;
+        }
+
         ret = 0;
 out:
         return ret;
@@ -1234,7 +1271,11 @@ gf_sqlite3_clear_files_heat (void *db_conn)
 
         CHECK_SQL_CONN (sql_conn, out);
 
-        ret = gf_sql_clear_counters (sql_conn);
+        pthread_mutex_lock (&sql_conn->write_lock);
+        {
+                ret = gf_sql_clear_counters (sql_conn);
+        }
+        pthread_mutex_unlock (&sql_conn->write_lock);
         if (ret) {
                 gf_msg (GFDB_STR_SQLITE3, GF_LOG_ERROR, 0,
                         LG_MSG_CLEAR_COUNTER_FAILED, "Failed to clear "
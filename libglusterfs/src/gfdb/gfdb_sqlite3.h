@@ -127,6 +127,11 @@ typedef struct gf_sql_connection {
         gf_sql_journal_mode_t   journal_mode;
         gf_sql_sync_t           synchronous;
         gf_sql_auto_vacuum_t    auto_vacuum;
+        /* Writes of the fops and batched heat updates share
+         * sqlite3_db_conn. A batch runs in a transaction of its own, which
+         * writes made on the connection meanwhile would join and be rolled
+         * back with, so they are serialised with it. */
+        pthread_mutex_t         write_lock;
 } gf_sql_connection_t;
 
 
@@ -255,6 +260,7 @@ int gf_sqlite3_init (dict_t *args, void **db_conn);
 /*insert/update/delete modules*/
 int gf_sqlite3_insert (void *db_conn, gfdb_db_record_t *);
 int gf_sqlite3_delete (void *db_conn, gfdb_db_record_t *);
+int gf_sqlite3_insert_heat (void *db_conn, gfdb_heat_record_t *, int);
 
 /*querying modules*/
 int gf_sqlite3_find_all (void *db_conn, gf_query_callback_t,
@@ -981,6 +981,149 @@ out:
 }
 
 
+/* Binds a time that may be zero: zero keeps the value already in the row */
+static int
+gf_sql_bind_heat_time (sqlite3_stmt *stmt, int index, gfdb_time_t *heat_time)
+{
+        int ret = -1;
+
+        ret = sqlite3_bind_int (stmt, index, heat_time->tv_sec);
+        if (ret != SQLITE_OK)
+                goto out;
+
+        ret = sqlite3_bind_int (stmt, index + 1, heat_time->tv_usec);
+out:
+        return ret;
+}
+
+/*
+ * Applies a batch of heat records in one transaction, with one prepared
+ * statement reused for all of them. Inode fops on a busy brick hit the
+ * same few files over and over; a single commit for thousands of them is
+ * far cheaper than a journal sync per fop. The caller holds
+ * sql_conn->write_lock, so that no other write joins the transaction.
+ *
+ * */
+int
+gf_sql_update_heat (gf_sql_connection_t  *sql_conn,
+                    gfdb_heat_record_t   *heat_records,
+                    int                  count)
+{
+        int ret                         = -1;
+        int i                           = 0;
+        int failed                      = 0;
+        char *sql_strerror              = NULL;
+        sqlite3_stmt *update_stmt       = NULL;
+        gfdb_heat_record_t *rec         = NULL;
+        char gfid_str[GF_UUID_BUF_SIZE] = "";
+        char *update_str                = "UPDATE "
+                GF_FILE_TABLE
+                " SET "
+                GF_COL_WSEC " = CASE WHEN ?1 > 0 THEN ?1 ELSE "
+                        GF_COL_WSEC " END, "
+                GF_COL_WMSEC " = CASE WHEN ?1 > 0 THEN ?2 ELSE "
+                        GF_COL_WMSEC " END, "
+                GF_COL_UWSEC " = CASE WHEN ?3 > 0 THEN ?3 ELSE "
+                        GF_COL_UWSEC " END, "
+                GF_COL_UWMSEC " = CASE WHEN ?3 > 0 THEN ?4 ELSE "
+                        GF_COL_UWMSEC " END, "
+                GF_COL_WSEC_READ " = CASE WHEN ?5 > 0 THEN ?5 ELSE "
+                        GF_COL_WSEC_READ " END, "
+                GF_COL_WMSEC_READ " = CASE WHEN ?5 > 0 THEN ?6 ELSE "
+                        GF_COL_WMSEC_READ " END, "
+                GF_COL_UWSEC_READ " = CASE WHEN ?7 > 0 THEN ?7 ELSE "
+                        GF_COL_UWSEC_READ " END, "
+                GF_COL_UWMSEC_READ " = CASE WHEN ?7 > 0 THEN ?8 ELSE "
+                        GF_COL_UWMSEC_READ " END, "
+                GF_COL_WRITE_FREQ_CNTR " = " GF_COL_WRITE_FREQ_CNTR " + ?9, "
+                GF_COL_READ_FREQ_CNTR " = " GF_COL_READ_FREQ_CNTR " + ?10"
+                " WHERE " GF_COL_GF_ID " = ?11 ;";
+
+        CHECK_SQL_CONN (sql_conn, out);
+        GF_VALIDATE_OR_GOTO (GFDB_STR_SQLITE3, heat_records, out);
+
+        ret = sqlite3_prepare_v2 (sql_conn->sqlite3_db_conn, update_str, -1,
+                                  &update_stmt, 0);
+        if (ret != SQLITE_OK) {
+                gf_msg (GFDB_STR_SQLITE3, GF_LOG_ERROR, 0,
+                        LG_MSG_PREPARE_FAILED, "Failed preparing heat update "
+                        "statement %s : %s", update_str,
+                        sqlite3_errmsg (sql_conn->sqlite3_db_conn));
+                ret = -1;
+                goto out;
+        }
+
+        ret = sqlite3_exec (sql_conn->sqlite3_db_conn, "BEGIN;", NULL, NULL,
+                            &sql_strerror);
+        if (ret != SQLITE_OK) {
+                gf_msg (GFDB_STR_SQLITE3, GF_LOG_ERROR, 0, LG_MSG_EXEC_FAILED,
+                        "Failed to begin heat transaction : %s",
+                        sql_strerror);
+                sqlite3_free (sql_strerror);
+                ret = -1;
+                goto out;
+        }
+
+        for (i = 0; i < count; i++) {
+                rec = &heat_records[i];
+                uuid_utoa_r (rec->gfid, gfid_str);
+
+                if (gf_sql_bind_heat_time (update_stmt, 1,
+                                           &rec->write_wind_time) ||
+                    gf_sql_bind_heat_time (update_stmt, 3,
+                                           &rec->write_unwind_time) ||
+                    gf_sql_bind_heat_time (update_stmt, 5,
+                                           &rec->read_wind_time) ||
+                    gf_sql_bind_heat_time (update_stmt, 7,
+                                           &rec->read_unwind_time) ||
+                    sqlite3_bind_int (update_stmt, 9,
+                                      rec->write_freq) != SQLITE_OK ||
+                    sqlite3_bind_int (update_stmt, 10,
+                                      rec->read_freq) != SQLITE_OK ||
+                    sqlite3_bind_text (update_stmt, 11, gfid_str, -1,
+                                       SQLITE_TRANSIENT) != SQLITE_OK) {
+                        gf_msg (GFDB_STR_SQLITE3, GF_LOG_ERROR, 0,
+                                LG_MSG_BINDING_FAILED, "Failed binding heat "
+                                "of %s : %s", gfid_str,
+                                sqlite3_errmsg (sql_conn->sqlite3_db_conn));
+                        failed++;
+                } else if (sqlite3_step (update_stmt) != SQLITE_DONE) {
+                        gf_msg_debug (GFDB_STR_SQLITE3, 0, "Failed updating "
+                                      "heat of %s : %s", gfid_str,
+                                      sqlite3_errmsg (
+                                              sql_conn->sqlite3_db_conn));
+                        failed++;
+                }
+
+                sqlite3_reset (update_stmt);
+                sqlite3_clear_bindings (update_stmt);
+        }
+
+        ret = sqlite3_exec (sql_conn->sqlite3_db_conn, "COMMIT;", NULL, NULL,
+                            &sql_strerror);
+        if (ret != SQLITE_OK) {
+                gf_msg (GFDB_STR_SQLITE3, GF_LOG_ERROR, 0, LG_MSG_EXEC_FAILED,
+                        "Failed to commit heat of %d files : %s", count,
+                        sql_strerror);
+                sqlite3_free (sql_strerror);
+                sqlite3_exec (sql_conn->sqlite3_db_conn, "ROLLBACK;", NULL,
+                              NULL, NULL);
+                ret = -1;
+                goto out;
+        }
+
+        if (failed)
+                gf_msg (GFDB_STR_SQLITE3, GF_LOG_WARNING, 0,
+                        LG_MSG_UPDATE_FAILED, "Heat of %d out of %d files "
+                        "could not be updated", failed, count);
+
+        ret = 0;
+out:
+        sqlite3_finalize (update_stmt);
+        return ret;
+}
+
+
 int
 gf_sql_update_delete_wind (gf_sql_connection_t  *sql_conn,
                           gfdb_db_record_t     *gfdb_db_record)
@@ -37,6 +37,11 @@ int
 gf_sql_delete_unwind (gf_sql_connection_t  *sql_conn,
                           gfdb_db_record_t     *gfdb_db_record);
 
+int
+gf_sql_update_heat (gf_sql_connection_t  *sql_conn,
+                    gfdb_heat_record_t   *heat_records,
+                    int                  count);
+
 
 
 
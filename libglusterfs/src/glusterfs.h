@@ -335,6 +335,8 @@ struct _cmd_args {
         gf_log_format_t  log_format;
         uint32_t         log_buf_size;
         uint32_t         log_flush_timeout;
+        int              log_async;
+        uint32_t         log_rate_limit;
         int32_t          max_connect_attempts;
         char            *print_exports;
         char            *print_netgroups;
@@ -362,6 +364,9 @@ struct _cmd_args {
         /* need a process wide timer-wheel? */
         int              global_timer_wheel;
 
+        /* pin each connection to one event thread? */
+        int              event_pin_workers;
+
         struct list_head xlator_options;  /* list of xlator_option_t */
 
 	/* fuse options */
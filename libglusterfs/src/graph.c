@@ -328,6 +328,8 @@ glusterfs_graph_init (glusterfs_graph_t *graph)
                 trav = trav->next;
         }
 
+        xlator_tree_fop_bypass (graph->top);
+
         return 0;
 }
 
@@ -943,6 +945,7 @@ glusterfs_graph_reconfigure (glusterfs_graph_t *oldgraph,
         xlator_t        *old_xl   = NULL;
         xlator_t        *new_xl   = NULL;
         xlator_list_t   *trav;
+        int              ret      = -1;
 
         GF_ASSERT (oldgraph);
         GF_ASSERT (newgraph);
@@ -958,7 +961,9 @@ glusterfs_graph_reconfigure (glusterfs_graph_t *oldgraph,
         }
 
         if (strcmp (old_xl->type, "protocol/server") != 0) {
-                return xlator_tree_reconfigure (old_xl, new_xl);
+                ret = xlator_tree_reconfigure (old_xl, new_xl);
+                xlator_tree_fop_bypass (oldgraph->top);
+                return ret;
         }
 
         /* Some options still need to be handled by the server translator. */
@@ -971,7 +976,9 @@ glusterfs_graph_reconfigure (glusterfs_graph_t *oldgraph,
 
         for (trav = old_xl->children; trav; trav = trav->next) {
                 if (strcmp (trav->xlator->name, new_xl->name) == 0) {
-                        return xlator_tree_reconfigure (trav->xlator, new_xl);
+                        ret = xlator_tree_reconfigure (trav->xlator, new_xl);
+                        xlator_tree_fop_bypass (trav->xlator);
+                        return ret;
                 }
         }
 
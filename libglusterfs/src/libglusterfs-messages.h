@@ -37,7 +37,7 @@
 
 #define GLFS_LG_BASE            GLFS_MSGID_COMP_LIBGLUSTERFS
 
-#define GLFS_LG_NUM_MESSAGES    210
+#define GLFS_LG_NUM_MESSAGES    213
 
 #define GLFS_LG_MSGID_END       (GLFS_LG_BASE + GLFS_LG_NUM_MESSAGES + 1)
 /* Messaged with message IDs */
@@ -1794,6 +1794,33 @@
 
 #define LG_MSG_UTIMENSAT_FAILED                          (GLFS_LG_BASE + 210)
 
+/*!
+ * @messageid
+ * @diagnosis
+ * @recommendedaction
+ *
+ */
+
+#define LG_MSG_PIN_WORKERS_FAILED                        (GLFS_LG_BASE + 211)
+
+/*!
+ * @messageid
+ * @diagnosis
+ * @recommendedaction
+ *
+ */
+
+#define LG_MSG_EPOLL_FD_MIGRATE_FAILED                   (GLFS_LG_BASE + 212)
+
+/*!
+ * @messageid
+ * @diagnosis
+ * @recommendedaction
+ *
+ */
+
+#define LG_MSG_LOG_MSGS_DROPPED                          (GLFS_LG_BASE + 213)
+
 /*!
  * @messageid
  * @diagnosis
@@ -35,6 +35,10 @@
 #define GF_LOG_BACKTRACE_DEPTH  5
 #define GF_LOG_BACKTRACE_SIZE   4096
 #define GF_LOG_TIMESTR_SIZE     256
+#define GF_LOG_RING_SIZE        128     /* records per thread, power of 2 */
+#define GF_LOG_REC_NAME_SIZE    64
+#define GF_LOG_REC_MSG_SIZE     512
+#define GF_LOG_ASYNC_BATCH      1024
 
 #include "xlator.h"
 #include "logging.h"
@@ -422,6 +426,11 @@ gf_log_disable_suppression_before_exit (glusterfs_ctx_t *ctx)
          */
 
         gf_log_set_log_buf_size (0);
+
+        /* write out whatever the asynchronous writer has not written yet,
+         * everything after this is logged synchronously */
+        gf_log_async_stop (ctx);
+
         pthread_mutex_lock (&ctx->log.log_buf_lock);
         {
                 if (ctx->log.log_flush_timer) {
@@ -659,6 +668,10 @@ gf_log_globals_init (void *data, gf_loglevel_t level)
 
         INIT_LIST_HEAD (&ctx->log.lru_queue);
 
+        pthread_mutex_init (&ctx->log.async_lock, NULL);
+
+        INIT_LIST_HEAD (&ctx->log.async_rings);
+
 #ifdef GF_LINUX_HOST_OS
         /* For the 'syslog' output. one can grep 'GlusterFS' in syslog
            for serious logs */
@@ -1338,11 +1351,12 @@ gf_log_syslog (glusterfs_ctx_t *ctx, const char *domain, const char *file,
         return 0;
 }
 
-static int
-gf_log_glusterlog (glusterfs_ctx_t *ctx, const char *domain, const char *file,
-                   const char *function, int32_t line, gf_loglevel_t level,
-                   int errnum, uint64_t msgid, char **appmsgstr, char *callstr,
-                   struct timeval tv, int graph_id, gf_log_format_t fmt)
+static char *
+gf_log_glusterlog_fmt (const char *domain, const char *file,
+                       const char *function, int32_t line, gf_loglevel_t level,
+                       int errnum, uint64_t msgid, const char *appmsgstr,
+                       char *callstr, struct timeval tv, int graph_id,
+                       gf_log_format_t fmt)
 {
         char             timestr[GF_LOG_TIMESTR_SIZE] = {0,};
         char            *header = NULL;
@@ -1351,9 +1365,6 @@ gf_log_glusterlog (glusterfs_ctx_t *ctx, const char *domain, const char *file,
         size_t           hlen  = 0, flen = 0, mlen = 0;
         int              ret  = 0;
 
-        /* rotate if required */
-        gf_log_rotate(ctx);
-
         /* format the time stamp */
         gf_time_fmt (timestr, sizeof timestr, tv.tv_sec, gf_timefmt_FT);
         snprintf (timestr + strlen (timestr), sizeof timestr - strlen (timestr),
@@ -1408,49 +1419,554 @@ gf_log_glusterlog (glusterfs_ctx_t *ctx, const char *domain, const char *file,
         /* generate the full message to log */
         hlen = strlen (header);
         flen = footer? strlen (footer) : 0;
-        mlen = strlen (*appmsgstr);
+        mlen = strlen (appmsgstr);
         msg = GF_MALLOC (hlen + flen + mlen + 1, gf_common_mt_char);
         if (!msg) {
-                ret = -1;
                 goto err;
         }
 
         strcpy (msg, header);
-        strcpy (msg + hlen, *appmsgstr);
+        strcpy (msg + hlen, appmsgstr);
         if (footer)
                 strcpy (msg + hlen + mlen, footer);
 
-        pthread_mutex_lock (&ctx->log.logfile_mutex);
-        {
-                if (ctx->log.logfile) {
-                        fprintf (ctx->log.logfile, "%s\n", msg);
-                        fflush (ctx->log.logfile);
-                } else if (ctx->log.loglevel >= level) {
-                        fprintf (stderr, "%s\n", msg);
-                        fflush (stderr);
-                }
+err:
+        GF_FREE (header);
+        GF_FREE (footer);
+
+        return msg;
+}
+
+/* NB: called with ctx->log.logfile_mutex held, the caller flushes */
+static void
+__gf_log_glusterlog_write (glusterfs_ctx_t *ctx, gf_loglevel_t level,
+                           const char *msg)
+{
+        if (ctx->log.logfile) {
+                fprintf (ctx->log.logfile, "%s\n", msg);
+        } else if (ctx->log.loglevel >= level) {
+                fprintf (stderr, "%s\n", msg);
+        }
 
 #ifdef GF_LINUX_HOST_OS
-                /* We want only serious logs in 'syslog', not our debug
-                 * and trace logs */
-                if (ctx->log.gf_log_syslog && level &&
-                        (level <= ctx->log.sys_log_level))
-                        syslog ((level-1), "%s\n", msg);
+        /* We want only serious logs in 'syslog', not our debug
+         * and trace logs */
+        if (ctx->log.gf_log_syslog && level &&
+                (level <= ctx->log.sys_log_level))
+                syslog ((level-1), "%s\n", msg);
 #endif
+}
+
+static void
+__gf_log_glusterlog_flush (glusterfs_ctx_t *ctx)
+{
+        if (ctx->log.logfile)
+                fflush (ctx->log.logfile);
+        else
+                fflush (stderr);
+}
+
+/*
+ * Asynchronous logging
+ *
+ * Every thread that logs gets its own ring of records, which only that
+ * thread fills and only the writer thread empties, so queueing a message
+ * needs neither a lock nor a system call. Only the caller's message text is
+ * formatted in the logging thread (its arguments do not outlive the call),
+ * the time stamp, header and errno string are rendered by the writer. The
+ * writer collects records from all rings, writes them in time order with a
+ * single flush per batch and optionally caps the number of messages written
+ * per second. A full ring or the rate limit drops messages instead of
+ * blocking the caller; the drops are counted and reported in the log.
+ */
+
+typedef struct gf_log_rec_ {
+        struct timeval   tv;
+        uint64_t         msgid;
+        int              errnum;
+        int              graph_id;
+        int32_t          line;
+        gf_loglevel_t    level;
+        gf_log_format_t  fmt;
+        char             domain[GF_LOG_REC_NAME_SIZE];
+        char             file[GF_LOG_REC_NAME_SIZE];
+        char             function[GF_LOG_REC_NAME_SIZE];
+        char             msg[GF_LOG_REC_MSG_SIZE];
+} gf_log_rec_t;
+
+typedef struct gf_log_ring_ {
+        struct list_head       list;        /* in ctx->log.async_rings */
+        glusterfs_ctx_t       *ctx;
+        volatile unsigned int  head;        /* written by the owner only */
+        volatile unsigned int  tail;        /* written by the writer only */
+        volatile int           dead;        /* owner thread has exited */
+        volatile int           orphan;      /* writer has stopped */
+        gf_log_rec_t           recs[GF_LOG_RING_SIZE];
+} gf_log_ring_t;
+
+typedef struct gf_log_batch_ent_ {
+        gf_log_ring_t  *ring;
+        unsigned int    idx;
+} gf_log_batch_ent_t;
+
+/* state of one writer thread */
+typedef struct gf_log_writer_ {
+        time_t              window;     /* second @written counts for */
+        uint32_t            written;
+        time_t              reported;   /* last report of drops */
+        gf_log_batch_ent_t  batch[GF_LOG_ASYNC_BATCH];
+        char               *msgs[GF_LOG_ASYNC_BATCH];
+} gf_log_writer_t;
+
+static pthread_key_t   gf_log_ring_key;
+static pthread_once_t  gf_log_ring_once = PTHREAD_ONCE_INIT;
+static int             gf_log_ring_key_ret = -1;
+/* hands a ring over between its owner and gf_log_async_stop() */
+static pthread_mutex_t gf_log_ring_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+gf_log_ring_destroy (void *data)
+{
+        gf_log_ring_t *ring = data;
+
+        pthread_mutex_lock (&gf_log_ring_lock);
+        {
+                if (ring->orphan) {
+                        GF_FREE (ring);
+                } else {
+                        /* the writer frees the ring once it is empty */
+                        __sync_synchronize ();
+                        ring->dead = 1;
+                }
+        }
+        pthread_mutex_unlock (&gf_log_ring_lock);
+}
+
+static void
+gf_log_ring_key_init (void)
+{
+        gf_log_ring_key_ret = pthread_key_create (&gf_log_ring_key,
+                                                  gf_log_ring_destroy);
+}
+
+static gf_log_ring_t *
+gf_log_ring_get (glusterfs_ctx_t *ctx)
+{
+        gf_log_ring_t *ring = NULL;
+
+        ring = pthread_getspecific (gf_log_ring_key);
+        if (ring && ring->orphan) {
+                /* left over from a writer since stopped, which has let go
+                 * of it */
+                GF_FREE (ring);
+                ring = NULL;
+        }
+        if (ring)
+                /* a thread logs asynchronously for one ctx only */
+                return (ring->ctx == ctx) ? ring : NULL;
+
+        ring = GF_CALLOC (1, sizeof (*ring), gf_common_mt_log_ring_t);
+        if (!ring)
+                return NULL;
+
+        INIT_LIST_HEAD (&ring->list);
+        ring->ctx = ctx;
+
+        pthread_mutex_lock (&ctx->log.async_lock);
+        {
+                list_add_tail (&ring->list, &ctx->log.async_rings);
+        }
+        pthread_mutex_unlock (&ctx->log.async_lock);
+
+        (void) pthread_setspecific (gf_log_ring_key, ring);
+
+        return ring;
+}
+
+static inline void
+gf_log_rec_copy_name (char *dst, const char *src)
+{
+        strncpy (dst, src ? src : "", GF_LOG_REC_NAME_SIZE - 1);
+        dst[GF_LOG_REC_NAME_SIZE - 1] = '\0';
+}
+
+/* Returns 0 if the message was queued (or dropped), -1 if it has to be
+ * written synchronously. */
+static int
+gf_log_async_enqueue (glusterfs_ctx_t *ctx, const char *domain,
+                      const char *file, const char *function, int32_t line,
+                      gf_loglevel_t level, int errnum, uint64_t msgid,
+                      const char *appmsgstr, struct timeval tv, int graph_id,
+                      gf_log_format_t fmt)
+{
+        gf_log_ring_t *ring = NULL;
+        gf_log_rec_t  *rec  = NULL;
+        unsigned int   head = 0;
+        size_t         len  = 0;
+
+        len = strlen (appmsgstr);
+        if (len >= GF_LOG_REC_MSG_SIZE)
+                return -1;
+
+        ring = gf_log_ring_get (ctx);
+        if (!ring)
+                return -1;
+
+        head = ring->head;
+        if (head - ring->tail >= GF_LOG_RING_SIZE) {
+                __sync_fetch_and_add (&ctx->log.async_dropped, 1);
+                return 0;
+        }
+
+        rec = &ring->recs[head & (GF_LOG_RING_SIZE - 1)];
+        rec->tv = tv;
+        rec->msgid = msgid;
+        rec->errnum = errnum;
+        rec->graph_id = graph_id;
+        rec->line = line;
+        rec->level = level;
+        rec->fmt = fmt;
+        gf_log_rec_copy_name (rec->domain, domain);
+        gf_log_rec_copy_name (rec->file, file);
+        gf_log_rec_copy_name (rec->function, function);
+        memcpy (rec->msg, appmsgstr, len + 1);
+
+        /* publish the record before the new head, and the new head before
+         * looking at async_idle (the writer does the reverse) */
+        __sync_synchronize ();
+        ring->head = head + 1;
+        __sync_synchronize ();
+
+        if (ctx->log.async_idle) {
+                ctx->log.async_idle = 0;
+                sem_post (&ctx->log.async_sem);
+        }
+
+        return 0;
+}
+
+static int
+gf_log_batch_cmp (const void *a, const void *b)
+{
+        const gf_log_batch_ent_t *ea = a;
+        const gf_log_batch_ent_t *eb = b;
+        const gf_log_rec_t       *ra = NULL;
+        const gf_log_rec_t       *rb = NULL;
+
+        ra = &ea->ring->recs[ea->idx & (GF_LOG_RING_SIZE - 1)];
+        rb = &eb->ring->recs[eb->idx & (GF_LOG_RING_SIZE - 1)];
+
+        if (ra->tv.tv_sec != rb->tv.tv_sec)
+                return (ra->tv.tv_sec < rb->tv.tv_sec) ? -1 : 1;
+        if (ra->tv.tv_usec != rb->tv.tv_usec)
+                return (ra->tv.tv_usec < rb->tv.tv_usec) ? -1 : 1;
+        /* keep the order of messages logged by the same thread */
+        if (ea->ring != eb->ring)
+                return (ea->ring < eb->ring) ? -1 : 1;
+        return (int)(ea->idx - eb->idx);
+}
+
+/* Writes out one batch of queued records, returns the number of records
+ * taken off the rings. Drops are reported at most once a second, or right
+ * away with @final. Called by the writer thread only. */
+static int
+gf_log_async_drain (glusterfs_ctx_t *ctx, gf_log_writer_t *writer, int final)
+{
+        gf_log_batch_ent_t        *batch   = writer->batch;
+        char                     **msgs    = writer->msgs;
+        gf_log_ring_t             *ring    = NULL;
+        gf_log_ring_t             *tmp     = NULL;
+        gf_log_rec_t              *rec     = NULL;
+        char                      *notice  = NULL;
+        char                       dropstr[64];
+        struct timeval             now     = {0,};
+        unsigned int               head    = 0;
+        unsigned int               idx     = 0;
+        int                        dead    = 0;
+        uint64_t                   dropped = 0;
+        int                        count   = 0;
+        int                        i       = 0;
+
+        pthread_mutex_lock (&ctx->log.async_lock);
+        {
+                list_for_each_entry_safe (ring, tmp, &ctx->log.async_rings,
+                                          list) {
+                        /* read 'dead' before 'head', so that a dead ring is
+                         * known to be complete */
+                        dead = ring->dead;
+                        __sync_synchronize ();
+                        head = ring->head;
+                        if (dead && ring->tail == head) {
+                                list_del_init (&ring->list);
+                                GF_FREE (ring);
+                                continue;
+                        }
+
+                        for (idx = ring->tail; idx != head &&
+                                               count < GF_LOG_ASYNC_BATCH;
+                             idx++) {
+                                batch[count].ring = ring;
+                                batch[count].idx = idx;
+                                count++;
+                        }
+                }
+        }
+        pthread_mutex_unlock (&ctx->log.async_lock);
+
+        qsort (batch, count, sizeof (batch[0]), gf_log_batch_cmp);
+
+        gettimeofday (&now, NULL);
+        if (now.tv_sec != writer->window) {
+                writer->window = now.tv_sec;
+                writer->written = 0;
+        }
+
+        for (i = 0; i < count; i++) {
+                msgs[i] = NULL;
+
+                if (ctx->log.async_rate &&
+                    writer->written >= ctx->log.async_rate) {
+                        __sync_fetch_and_add (&ctx->log.async_dropped, 1);
+                        continue;
+                }
+
+                rec = &batch[i].ring->recs[batch[i].idx &
+                                           (GF_LOG_RING_SIZE - 1)];
+                msgs[i] = gf_log_glusterlog_fmt (rec->domain, rec->file,
+                                                 rec->function, rec->line,
+                                                 rec->level, rec->errnum,
+                                                 rec->msgid, rec->msg, NULL,
+                                                 rec->tv, rec->graph_id,
+                                                 rec->fmt);
+                writer->written++;
+                ctx->log.async_written++;
+        }
+
+        dropped = ctx->log.async_dropped;
+        if (dropped != ctx->log.async_dropped_reported &&
+            (final || now.tv_sec != writer->reported)) {
+                snprintf (dropstr, sizeof (dropstr), "%"PRIu64" log messages "
+                          "dropped", dropped - ctx->log.async_dropped_reported);
+                notice = gf_log_glusterlog_fmt ("logging-infra", __FILE__,
+                                                __FUNCTION__, __LINE__,
+                                                GF_LOG_WARNING, 0,
+                                                LG_MSG_LOG_MSGS_DROPPED,
+                                                dropstr, NULL, now, 0,
+                                                ctx->log.logformat);
+                ctx->log.async_dropped_reported = dropped;
+                writer->reported = now.tv_sec;
+        }
+
+        if (count || notice) {
+                gf_log_rotate (ctx);
+
+                pthread_mutex_lock (&ctx->log.logfile_mutex);
+                {
+                        for (i = 0; i < count; i++) {
+                                if (!msgs[i])
+                                        continue;
+                                rec = &batch[i].ring->recs[batch[i].idx &
+                                                   (GF_LOG_RING_SIZE - 1)];
+                                __gf_log_glusterlog_write (ctx, rec->level,
+                                                           msgs[i]);
+                        }
+                        if (notice)
+                                __gf_log_glusterlog_write (ctx, GF_LOG_WARNING,
+                                                           notice);
+                        __gf_log_glusterlog_flush (ctx);
+                }
+                pthread_mutex_unlock (&ctx->log.logfile_mutex);
+        }
+
+        /* hand the slots back; the time stamps of one thread need not be
+         * monotonic, so never move a tail backwards */
+        __sync_synchronize ();
+        for (i = 0; i < count; i++) {
+                GF_FREE (msgs[i]);
+                ring = batch[i].ring;
+                if ((int)(batch[i].idx + 1 - ring->tail) > 0)
+                        ring->tail = batch[i].idx + 1;
+        }
+        GF_FREE (notice);
+
+        return count;
+}
+
+static void *
+gf_log_async_writer (void *data)
+{
+        glusterfs_ctx_t *ctx     = data;
+        gf_log_writer_t *writer  = ctx->log.async_state;
+        struct timespec  timeout = {0,};
+        int              stop    = 0;
+
+        for (;;) {
+                stop = ctx->log.async_stop;
+                __sync_synchronize ();
+
+                while (gf_log_async_drain (ctx, writer, 0) > 0)
+                        ;
+
+                if (stop) {
+                        (void) gf_log_async_drain (ctx, writer, 1);
+                        break;
+                }
+
+                /* announce going idle, then look once more, to not miss a
+                 * record queued after the last drain */
+                ctx->log.async_idle = 1;
+                __sync_synchronize ();
+                if (gf_log_async_drain (ctx, writer, 0) > 0) {
+                        ctx->log.async_idle = 0;
+                        continue;
+                }
+
+                clock_gettime (CLOCK_REALTIME, &timeout);
+                timeout.tv_sec += 1;
+                (void) sem_timedwait (&ctx->log.async_sem, &timeout);
+                ctx->log.async_idle = 0;
+        }
+
+        return NULL;
+}
+
+/**
+ * gf_log_async_start - hand messages up to GF_LOG_ERROR over to a writer
+ *                      thread instead of writing them in the caller's thread
+ * @ctx:  glusterfs context
+ * @rate: maximum number of messages written per second, 0 for no limit
+ *
+ * Needs to be called after daemonizing, as the writer is a thread.
+ */
+int
+gf_log_async_start (glusterfs_ctx_t *ctx, uint32_t rate)
+{
+        int ret = -1;
+
+        if (ctx->log.async)
+                return 0;
+
+        (void) pthread_once (&gf_log_ring_once, gf_log_ring_key_init);
+        if (gf_log_ring_key_ret) {
+                gf_msg ("logging-infra", GF_LOG_ERROR, gf_log_ring_key_ret,
+                        LG_MSG_PTHREAD_KEY_CREATE_FAILED, "failed to create "
+                        "the key for per thread log rings");
+                goto out;
+        }
+
+        ctx->log.async_state = GF_CALLOC (1, sizeof (gf_log_writer_t),
+                                          gf_common_mt_log_writer_t);
+        if (!ctx->log.async_state) {
+                ret = -1;
+                goto out;
+        }
+
+        ret = sem_init (&ctx->log.async_sem, 0, 0);
+        if (ret) {
+                gf_msg ("logging-infra", GF_LOG_ERROR, errno,
+                        LG_MSG_PTHREAD_FAILED, "failed to initialize the "
+                        "log writer semaphore");
+                GF_FREE (ctx->log.async_state);
+                ctx->log.async_state = NULL;
+                goto out;
+        }
+
+        ctx->log.async_rate = rate;
+        ctx->log.async_stop = 0;
+
+        ret = gf_thread_create (&ctx->log.async_writer, NULL,
+                                gf_log_async_writer, ctx);
+        if (ret) {
+                gf_msg ("logging-infra", GF_LOG_ERROR, ret,
+                        LG_MSG_PTHREAD_FAILED, "failed to start the log "
+                        "writer thread");
+                sem_destroy (&ctx->log.async_sem);
+                GF_FREE (ctx->log.async_state);
+                ctx->log.async_state = NULL;
+                goto out;
+        }
+
+        ctx->log.async = 1;
+out:
+        return ret;
+}
+
+/* Stops queueing, and waits for the writer to write out what it has. A
+ * message queued by a thread racing with this call may get lost. The rings
+ * of threads that have exited are freed, the others are left to their
+ * owner to free. */
+void
+gf_log_async_stop (glusterfs_ctx_t *ctx)
+{
+        gf_log_ring_t *ring = NULL;
+        gf_log_ring_t *tmp  = NULL;
+
+        if (!__sync_bool_compare_and_swap (&ctx->log.async, 1, 0))
+                return;
+
+        ctx->log.async_stop = 1;
+        __sync_synchronize ();
+        sem_post (&ctx->log.async_sem);
+
+        pthread_join (ctx->log.async_writer, NULL);
+        sem_destroy (&ctx->log.async_sem);
+        GF_FREE (ctx->log.async_state);
+        ctx->log.async_state = NULL;
+
+        pthread_mutex_lock (&ctx->log.async_lock);
+        pthread_mutex_lock (&gf_log_ring_lock);
+        {
+                list_for_each_entry_safe (ring, tmp, &ctx->log.async_rings,
+                                          list) {
+                        list_del_init (&ring->list);
+                        if (ring->dead)
+                                GF_FREE (ring);
+                        else
+                                ring->orphan = 1;
+                }
+        }
+        pthread_mutex_unlock (&gf_log_ring_lock);
+        pthread_mutex_unlock (&ctx->log.async_lock);
+}
+
+static int
+gf_log_glusterlog (glusterfs_ctx_t *ctx, const char *domain, const char *file,
+                   const char *function, int32_t line, gf_loglevel_t level,
+                   int errnum, uint64_t msgid, char **appmsgstr, char *callstr,
+                   struct timeval tv, int graph_id, gf_log_format_t fmt)
+{
+        char            *msg  = NULL;
+
+        /* critical messages and backtraces are never deferred */
+        if (ctx->log.async && !callstr && level > GF_LOG_CRITICAL &&
+            gf_log_async_enqueue (ctx, domain, file, function, line, level,
+                                  errnum, msgid, *appmsgstr, tv, graph_id,
+                                  fmt) == 0)
+                return 0;
+
+        /* rotate if required */
+        gf_log_rotate(ctx);
+
+        msg = gf_log_glusterlog_fmt (domain, file, function, line, level,
+                                     errnum, msgid, *appmsgstr, callstr, tv,
+                                     graph_id, fmt);
+        if (!msg)
+                return -1;
+
+        pthread_mutex_lock (&ctx->log.logfile_mutex);
+        {
+                __gf_log_glusterlog_write (ctx, level, msg);
+                __gf_log_glusterlog_flush (ctx);
         }
 
         /* TODO: Plugin in memory log buffer retention here. For logs not
          * flushed during cores, it would be useful to retain some of the last
          * few messages in memory */
         pthread_mutex_unlock (&ctx->log.logfile_mutex);
-        ret = 0;
 
-err:
         GF_FREE (msg);
-        GF_FREE (header);
-        GF_FREE (footer);
 
-        return ret;
+        return 0;
 }
 
 static int
@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include "list.h"
 
 #ifdef GF_DARWIN_HOST_OS
@@ -116,6 +117,21 @@ typedef struct gf_log_handle_ {
         uint32_t          timeout;
         pthread_mutex_t   log_buf_lock;
         struct _gf_timer *log_flush_timer;
+
+        /* asynchronous logging, see gf_log_async_start() */
+        int               async;          /* enqueue instead of writing */
+        int               async_stop;     /* writer drains and exits */
+        int               async_idle;     /* writer waits on async_sem */
+        uint32_t          async_rate;     /* max. messages written per
+                                             second, 0 for no limit */
+        pthread_t         async_writer;
+        void             *async_state;    /* the writer's batch */
+        sem_t             async_sem;
+        pthread_mutex_t   async_lock;     /* protects async_rings */
+        struct list_head  async_rings;    /* one ring per logging thread */
+        uint64_t          async_written;
+        uint64_t          async_dropped;  /* ring full or rate limited */
+        uint64_t          async_dropped_reported;
 } gf_log_handle_t;
 
 
@@ -316,6 +332,12 @@ gf_log_inject_timer_event (struct _glusterfs_ctx *ctx);
 void
 gf_log_disable_suppression_before_exit (struct _glusterfs_ctx *ctx);
 
+int
+gf_log_async_start (struct _glusterfs_ctx *ctx, uint32_t rate);
+
+void
+gf_log_async_stop (struct _glusterfs_ctx *ctx);
+
 #define GF_DEBUG(xl, format, args...)                           \
         gf_log ((xl)->name, GF_LOG_DEBUG, format, ##args)
 #define GF_INFO(xl, format, args...)                            \
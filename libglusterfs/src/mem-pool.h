@@ -36,6 +36,7 @@
 #define GF_MEM_HEADER_MAGIC  0xCAFEBABE
 #define GF_MEM_TRAILER_MAGIC 0xBAADF00D
 #define GF_MEM_INVALID_MAGIC 0xDEADC0DE
+#define GF_MEM_ARENA_MAGIC   0xA4E4A000
 
 struct mem_acct_rec {
 	const char     *typestr;
@@ -172,6 +172,9 @@ enum gf_common_mem_types_ {
         gf_common_mt_tbf_bucket_t,
         gf_common_mt_tbf_throttle_t,
         gf_common_mt_pthread_t,
+        gf_common_mt_log_ring_t,
+        gf_common_mt_dict_index_t,
+        gf_common_mt_log_writer_t,
         gf_common_mt_end
 };
 #endif
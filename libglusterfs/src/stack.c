@@ -22,14 +22,18 @@ create_frame (xlator_t *xl, call_pool_t *pool)
                 return NULL;
         }
 
-        stack = mem_get0 (pool->stack_mem_pool);
+        stack = mem_get (pool->stack_mem_pool);
         if (!stack)
                 return NULL;
 
+        memset (stack, 0, offsetof (call_stack_t, arena));
         INIT_LIST_HEAD (&stack->myframes);
+        LOCK_INIT (&stack->stack_lock);
+        stack->pool = pool;
 
-        frame = mem_get0 (pool->frame_mem_pool);
+        frame = stack_frame_get (stack);
         if (!frame) {
+                LOCK_DESTROY (&stack->stack_lock);
                 mem_put (stack);
                 return NULL;
         }
@@ -40,7 +44,6 @@ create_frame (xlator_t *xl, call_pool_t *pool)
         INIT_LIST_HEAD (&frame->frames);
         list_add (&frame->frames, &stack->myframes);
 
-        stack->pool = pool;
         stack->ctx = xl->ctx;
 
         if (stack->ctx->measure_latency) {
@@ -59,11 +62,56 @@ create_frame (xlator_t *xl, call_pool_t *pool)
         }
         UNLOCK (&pool->lock);
 
-        LOCK_INIT (&stack->stack_lock);
-
         return frame;
 }
 
+
+void *
+stack_arena_get (call_stack_t *stack, size_t size, stack_arena_fini_t fini)
+{
+#if defined(GF_DISABLE_MEMPOOL)
+        /* mem_put () is GF_FREE () here and would not skip these */
+        return NULL;
+#else
+        struct stack_arena_obj *obj  = NULL;
+        size_t                  need = 0;
+
+        need = (sizeof (*obj) + size + 15) & ~((size_t)15);
+
+        obj = stack_arena_bump (stack, need);
+        if (!obj)
+                return NULL;
+
+        obj->fini = fini;
+        LOCK (&stack->stack_lock);
+        {
+                obj->next = stack->arena_objs;
+                stack->arena_objs = obj;
+        }
+        UNLOCK (&stack->stack_lock);
+
+        obj->hdr.magic = GF_MEM_ARENA_MAGIC;
+        memset (obj + 1, 0, size);
+
+        return obj + 1;
+#endif
+}
+
+
+void
+stack_arena_release (call_stack_t *stack)
+{
+        struct stack_arena_obj *obj = NULL;
+
+        for (obj = stack->arena_objs; obj; obj = obj->next) {
+                if (obj->fini)
+                        obj->fini (obj + 1);
+        }
+
+        stack->arena_objs = NULL;
+        stack->arena_used = 0;
+}
+
 void
 gf_proc_dump_call_frame (call_frame_t *call_frame, const char *key_buf,...)
 {
@@ -174,6 +222,7 @@ gf_proc_dump_call_stack (call_stack_t *call_stack, const char *key_buf,...)
 
         gf_proc_dump_write("type", "%d", call_stack->type);
         gf_proc_dump_write("cnt", "%d", cnt);
+        gf_proc_dump_write("arena-used", "%u", call_stack->arena_used);
 
         list_for_each_entry (trav, &call_stack->myframes, frames) {
                 gf_proc_dump_add_section("%s.frame.%d", prefix, i);
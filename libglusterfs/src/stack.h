@@ -84,6 +84,28 @@ struct _call_frame_t {
 
 #define SMALL_GROUP_COUNT 128
 
+/* Every call stack carries an arena from which its frames, and the locals
+ * of xlators that ask for it, are bump-allocated. Nothing in it is freed
+ * on its own: the whole region goes back with the stack in STACK_DESTROY.
+ * Sized so that call_stack_t still fits a single 8k pool object; once it
+ * is used up allocations fall back to the mem-pools.
+ *
+ * A local taken from here must not be touched once the unwind that may
+ * reach the root has been issued, since STACK_DESTROY can free it right
+ * there. Xlators that mem_put () their local after STACK_UNWIND (afr, dht,
+ * write-behind, io-cache) therefore keep using their pools.
+ */
+#define GF_STACK_ARENA_SIZE 6144
+
+typedef void (*stack_arena_fini_t) (void *ptr);
+
+struct stack_arena_obj {
+        struct stack_arena_obj       *next;
+        stack_arena_fini_t            fini;
+        /* mem_put () finds GF_MEM_ARENA_MAGIC here and leaves it alone */
+        pooled_obj_hdr_t              hdr;
+};
+
 struct _call_stack_t {
         union {
                 struct list_head      all_frames;
@@ -116,6 +138,15 @@ struct _call_stack_t {
         struct timeval                tv;
         xlator_t                     *err_xl;
         int32_t                       error;
+        uint32_t                      queue_delay; /* usec spent waiting in
+                                                      xlator queues, e.g.
+                                                      io-threads */
+
+        /* arena stays last: only the part above it is zeroed */
+        uint32_t                      arena_used;
+        struct stack_arena_obj       *arena_objs;
+        char                          arena[GF_STACK_ARENA_SIZE]
+                                      __attribute__ ((aligned (16)));
 };
 
 
@@ -137,6 +168,56 @@ gf_latency_begin (call_frame_t *frame, void *fn);
 void
 gf_latency_end (call_frame_t *frame);
 
+void *
+stack_arena_get (call_stack_t *stack, size_t size, stack_arena_fini_t fini);
+
+void
+stack_arena_release (call_stack_t *stack);
+
+static inline gf_boolean_t
+stack_arena_owns (call_stack_t *stack, void *ptr)
+{
+        return ((char *)ptr >= stack->arena &&
+                (char *)ptr < stack->arena + GF_STACK_ARENA_SIZE);
+}
+
+/* Reserves @need bytes of the stack's arena without taking stack_lock:
+ * winds on one stack rarely race, so a compare-and-swap on the offset
+ * is all that is needed.  Returns NULL once the arena is full. */
+static inline void *
+stack_arena_bump (call_stack_t *stack, uint32_t need)
+{
+        uint32_t used = 0;
+
+        do {
+                used = stack->arena_used;
+                if (used + need > GF_STACK_ARENA_SIZE)
+                        return NULL;
+        } while (!__sync_bool_compare_and_swap (&stack->arena_used, used,
+                                                used + need));
+
+        return stack->arena + used;
+}
+
+/* Takes a frame out of the stack's arena, or from the frame pool once
+ * the arena is full. */
+static inline call_frame_t *
+stack_frame_get (call_stack_t *stack)
+{
+        call_frame_t *frame = NULL;
+
+#if !defined(GF_DISABLE_MEMPOOL)
+        frame = stack_arena_bump (stack, sizeof (*frame));
+#endif
+
+        if (frame)
+                memset (frame, 0, sizeof (*frame));
+        else
+                frame = mem_get0 (stack->pool->frame_mem_pool);
+
+        return frame;
+}
+
 static inline void
 FRAME_DESTROY (call_frame_t *frame)
 {
@@ -150,7 +231,8 @@ FRAME_DESTROY (call_frame_t *frame)
         }
 
         LOCK_DESTROY (&frame->lock);
-        mem_put (frame);
+        if (!stack_arena_owns (frame->root, frame))
+                mem_put (frame);
 
         if (local)
                 mem_put (local);
@@ -177,6 +259,8 @@ STACK_DESTROY (call_stack_t *stack)
                 FRAME_DESTROY (frame);
         }
 
+        stack_arena_release (stack);
+
 	GF_FREE (stack->groups_large);
 
         mem_put (stack);
@@ -236,19 +320,40 @@ STACK_RESET (call_stack_t *stack)
         } while (0);                                                   \
 
 
+/* If @fn is a fop slot of @obj, skip the xlators that would only forward
+ * it: see xlator_tree_fop_bypass (). Anything else is wound as given. */
+#define STACK_WIND_BYPASS(obj, fn, _obj, _fn)                           \
+        do {                                                            \
+                uintptr_t __off = (uintptr_t) &(fn) -                   \
+                                  (uintptr_t) (obj)->fops;              \
+                xlator_t *__to  = NULL;                                 \
+                                                                        \
+                if (__off >= GF_XLATOR_FOP_SLOTS * sizeof (void *))     \
+                        break;                                          \
+                __to = (obj)->fop_target[__off / sizeof (void *)];      \
+                if (!__to)                                              \
+                        break;                                          \
+                _obj = __to;                                            \
+                _fn = *(typeof (fn) *)((char *)__to->fops + __off);     \
+        } while (0)
+
+
 /* make a call */
 #define STACK_WIND(frame, rfn, obj, fn, params ...)                     \
         do {                                                            \
                 call_frame_t *_new = NULL;                              \
                 xlator_t     *old_THIS = NULL;                          \
+                xlator_t     *_obj = obj;                               \
+                typeof(fn)    _fn = fn;                                 \
                                                                         \
-                _new = mem_get0 (frame->root->pool->frame_mem_pool);    \
+                _new = stack_frame_get (frame->root);                   \
                 if (!_new) {                                            \
                         break;                                          \
                 }                                                       \
                 typeof(fn##_cbk) tmp_cbk = rfn;                         \
+                STACK_WIND_BYPASS (obj, fn, _obj, _fn);                 \
                 _new->root = frame->root;                               \
-                _new->this = obj;                                       \
+                _new->this = _obj;                                      \
                 _new->ret = (ret_fn_t) tmp_cbk;                         \
                 _new->parent = frame;                                   \
                 _new->cookie = _new;                                    \
@@ -264,15 +369,15 @@ STACK_RESET (call_stack_t *stack)
                 }                                                       \
                 UNLOCK(&frame->root->stack_lock);                       \
                 old_THIS = THIS;                                        \
-                THIS = obj;                                             \
+                THIS = _obj;                                            \
                 gf_msg_trace ("stack-trace", 0,                         \
                               "stack-address: %p, "                     \
                               "winding from %s to %s",                  \
                               frame->root, old_THIS->name,              \
                               THIS->name);                              \
                 if (frame->this->ctx->measure_latency)                  \
-                        gf_latency_begin (_new, fn);                    \
-                fn (_new, obj, params);                                 \
+                        gf_latency_begin (_new, _fn);                   \
+                _fn (_new, _obj, params);                               \
                 THIS = old_THIS;                                        \
         } while (0)
 
@@ -284,6 +389,7 @@ STACK_RESET (call_stack_t *stack)
                 xlator_t     *next_xl = obj;                            \
                 typeof(fn)    next_xl_fn = fn;                          \
                                                                         \
+                STACK_WIND_BYPASS (obj, fn, next_xl, next_xl_fn);       \
                 frame->this = next_xl;                                  \
                 frame->wind_to = #fn;                                   \
                 old_THIS = THIS;                                        \
@@ -303,14 +409,17 @@ STACK_RESET (call_stack_t *stack)
         do {                                                            \
                 call_frame_t *_new = NULL;                              \
                 xlator_t     *old_THIS = NULL;                          \
+                xlator_t     *_obj = obj;                               \
+                typeof(fn)    _fn = fn;                                 \
                                                                         \
-                _new = mem_get0 (frame->root->pool->frame_mem_pool);    \
+                _new = stack_frame_get (frame->root);                   \
                 if (!_new) {                                            \
                         break;                                          \
                 }                                                       \
                 typeof(fn##_cbk) tmp_cbk = rfn;                         \
+                STACK_WIND_BYPASS (obj, fn, _obj, _fn);                 \
                 _new->root = frame->root;                               \
-                _new->this = obj;                                       \
+                _new->this = _obj;                                      \
                 _new->ret = (ret_fn_t) tmp_cbk;                         \
                 _new->parent = frame;                                   \
                 _new->cookie = cky;                                     \
@@ -326,15 +435,15 @@ STACK_RESET (call_stack_t *stack)
                 UNLOCK(&frame->root->stack_lock);                       \
                 fn##_cbk = rfn;                                         \
                 old_THIS = THIS;                                        \
-                THIS = obj;                                             \
+                THIS = _obj;                                            \
                 gf_msg_trace ("stack-trace", 0,                         \
                               "stack-address: %p, "                     \
                               "winding from %s to %s",                  \
                               frame->root, old_THIS->name,              \
                               THIS->name);                              \
-                if (obj->ctx->measure_latency)                  \
-                        gf_latency_begin (_new, fn);                    \
-                fn (_new, obj, params);                                 \
+                if (_obj->ctx->measure_latency)                         \
+                        gf_latency_begin (_new, _fn);                   \
+                _fn (_new, _obj, params);                               \
                 THIS = old_THIS;                                        \
         } while (0)
 
@@ -488,15 +597,19 @@ copy_frame (call_frame_t *frame)
                 return NULL;
         }
 
-        newstack = mem_get0 (frame->root->pool->stack_mem_pool);
+        newstack = mem_get (frame->root->pool->stack_mem_pool);
         if (newstack == NULL) {
                 return NULL;
         }
 
+        memset (newstack, 0, offsetof (call_stack_t, arena));
         INIT_LIST_HEAD (&newstack->myframes);
+        LOCK_INIT (&newstack->stack_lock);
+        newstack->pool = frame->root->pool;
 
-        newframe = mem_get0 (frame->root->pool->frame_mem_pool);
+        newframe = stack_frame_get (newstack);
         if (!newframe) {
+                LOCK_DESTROY (&newstack->stack_lock);
                 mem_put (newstack);
                 return NULL;
         }
@@ -535,7 +648,6 @@ copy_frame (call_frame_t *frame)
         }
 
         LOCK_INIT (&newframe->lock);
-        LOCK_INIT (&newstack->stack_lock);
 
         LOCK (&oldstack->pool->lock);
         {
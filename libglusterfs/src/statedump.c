@@ -16,6 +16,7 @@
 #include "stack.h"
 #include "common-utils.h"
 #include "syscall.h"
+#include "event.h"
 
 
 #ifdef HAVE_MALLOC_H
@@ -827,6 +828,18 @@ gf_proc_dump_info (int signum, glusterfs_ctx_t *ctx)
         if (GF_PROC_DUMP_IS_OPTION_ENABLED (callpool))
                 gf_proc_dump_pending_frames (ctx->pool);
 
+        event_pool_dump (ctx->event_pool);
+
+        if (ctx->log.async) {
+                gf_proc_dump_add_section ("logging");
+                gf_proc_dump_write ("mode", "async");
+                gf_proc_dump_write ("rate_limit", "%u", ctx->log.async_rate);
+                gf_proc_dump_write ("written", "%"PRIu64,
+                                    ctx->log.async_written);
+                gf_proc_dump_write ("dropped", "%"PRIu64,
+                                    ctx->log.async_dropped);
+        }
+
         if (ctx->master) {
                 gf_proc_dump_add_section ("fuse");
                 gf_proc_dump_xlator_info (ctx->master);
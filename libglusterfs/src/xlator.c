@@ -383,6 +383,154 @@ xlator_foreach_depth_first (xlator_t *this,
 }
 
 
+#define FOP_SLOT_NAME(fop)                                              \
+        [offsetof (struct xlator_fops, fop) / sizeof (void *)] = #fop
+
+static const char *xlator_fop_slot_names[GF_XLATOR_FOP_SLOTS] = {
+        FOP_SLOT_NAME (lookup),
+        FOP_SLOT_NAME (stat),
+        FOP_SLOT_NAME (fstat),
+        FOP_SLOT_NAME (truncate),
+        FOP_SLOT_NAME (ftruncate),
+        FOP_SLOT_NAME (access),
+        FOP_SLOT_NAME (readlink),
+        FOP_SLOT_NAME (mknod),
+        FOP_SLOT_NAME (mkdir),
+        FOP_SLOT_NAME (unlink),
+        FOP_SLOT_NAME (rmdir),
+        FOP_SLOT_NAME (symlink),
+        FOP_SLOT_NAME (rename),
+        FOP_SLOT_NAME (link),
+        FOP_SLOT_NAME (create),
+        FOP_SLOT_NAME (open),
+        FOP_SLOT_NAME (readv),
+        FOP_SLOT_NAME (writev),
+        FOP_SLOT_NAME (flush),
+        FOP_SLOT_NAME (fsync),
+        FOP_SLOT_NAME (opendir),
+        FOP_SLOT_NAME (readdir),
+        FOP_SLOT_NAME (readdirp),
+        FOP_SLOT_NAME (fsyncdir),
+        FOP_SLOT_NAME (statfs),
+        FOP_SLOT_NAME (setxattr),
+        FOP_SLOT_NAME (getxattr),
+        FOP_SLOT_NAME (fsetxattr),
+        FOP_SLOT_NAME (fgetxattr),
+        FOP_SLOT_NAME (removexattr),
+        FOP_SLOT_NAME (fremovexattr),
+        FOP_SLOT_NAME (lk),
+        FOP_SLOT_NAME (inodelk),
+        FOP_SLOT_NAME (finodelk),
+        FOP_SLOT_NAME (entrylk),
+        FOP_SLOT_NAME (fentrylk),
+        FOP_SLOT_NAME (rchecksum),
+        FOP_SLOT_NAME (xattrop),
+        FOP_SLOT_NAME (fxattrop),
+        FOP_SLOT_NAME (setattr),
+        FOP_SLOT_NAME (fsetattr),
+        FOP_SLOT_NAME (getspec),
+        FOP_SLOT_NAME (fallocate),
+        FOP_SLOT_NAME (discard),
+        FOP_SLOT_NAME (zerofill),
+        FOP_SLOT_NAME (ipc),
+        FOP_SLOT_NAME (seek),
+        FOP_SLOT_NAME (lease),
+        FOP_SLOT_NAME (compound),
+        FOP_SLOT_NAME (getactivelk),
+        FOP_SLOT_NAME (setactivelk),
+};
+
+#undef FOP_SLOT_NAME
+
+
+const char *
+xlator_fop_slot_name (int slot)
+{
+        if (slot < 0 || slot >= GF_XLATOR_FOP_SLOTS)
+                return NULL;
+
+        return xlator_fop_slot_names[slot];
+}
+
+
+/* Whether a wind of @slot to @xl may go straight on to its first child:
+ * the xlator either left the fop to the defaults, which do nothing but
+ * STACK_WIND_TAIL to FIRST_CHILD, or has declared itself pass-through.
+ */
+static gf_boolean_t
+xlator_fop_passes (xlator_t *xl, int slot)
+{
+        void **fops = (void **)xl->fops;
+        void **defs = (void **)default_fops;
+
+        if (!fops || !xl->children)
+                return _gf_false;
+
+        if (xl->pass_through && !xl->children->next)
+                return _gf_true;
+
+        return (defs[slot] != NULL && fops[slot] == defs[slot]);
+}
+
+
+static void
+xlator_fop_bypass (xlator_t *xl, void *data)
+{
+        xlator_t *child = NULL;
+        int       i     = 0;
+
+        for (i = 0; i < GF_XLATOR_FOP_SLOTS; i++) {
+                if (!xlator_fop_passes (xl, i)) {
+                        xl->fop_target[i] = NULL;
+                        continue;
+                }
+
+                child = FIRST_CHILD (xl);
+                xl->fop_target[i] = child->fop_target[i] ?
+                                    child->fop_target[i] : child;
+        }
+}
+
+
+/* Children are visited before their parents, so every xlator can take
+ * over the target of the child it forwards to. Winds racing with the
+ * update land either on the old target or the new one, both of which
+ * are still in the graph.
+ */
+void
+xlator_tree_fop_bypass (xlator_t *top)
+{
+        if (!top)
+                return;
+
+        xlator_foreach_depth_first (top, xlator_fop_bypass, NULL);
+}
+
+
+/* Number of xlators a fop wound to @xl goes through on its longest path
+ * down the graph, with or without the pass-through hops. */
+int
+xlator_fop_depth (xlator_t *xl, int slot, gf_boolean_t bypass)
+{
+        xlator_list_t *trav  = NULL;
+        int            depth = 0;
+        int            sub   = 0;
+
+        if (bypass && xl->fop_target[slot])
+                xl = xl->fop_target[slot];
+        else if (xlator_fop_passes (xl, slot))
+                return xlator_fop_depth (FIRST_CHILD (xl), slot, bypass) + 1;
+
+        for (trav = xl->children; trav; trav = trav->next) {
+                sub = xlator_fop_depth (trav->xlator, slot, bypass);
+                if (sub > depth)
+                        depth = sub;
+        }
+
+        return depth + 1;
+}
+
+
 xlator_t *
 xlator_search_by_name (xlator_t *any, const char *name)
 {
@@ -907,6 +907,10 @@ typedef struct xlator_list {
 } xlator_list_t;
 
 
+/* the fops proper, ahead of the *_cbk typechecking entries */
+#define GF_XLATOR_FOP_SLOTS                                             \
+        (offsetof (struct xlator_fops, lookup_cbk) / sizeof (void *))
+
 struct _xlator {
         /* Built during parsing */
         char          *name;
@@ -956,6 +960,15 @@ struct _xlator {
 
         /* Its used as an index to inode_ctx*/
         uint32_t            xl_id;
+
+        /* Set by an xlator which, as currently configured, forwards every
+           fop untouched to its only child */
+        gf_boolean_t        pass_through;
+
+        /* Per fop slot, where a wind to this xlator really lands once
+           xlators that would only forward it are skipped; NULL if it
+           stops here. See xlator_tree_fop_bypass (). */
+        xlator_t           *fop_target[GF_XLATOR_FOP_SLOTS];
 };
 
 typedef struct {
@@ -1004,6 +1017,10 @@ void xlator_foreach (xlator_t *this,
                                  void *data),
                      void *data);
 
+void xlator_tree_fop_bypass (xlator_t *top);
+int xlator_fop_depth (xlator_t *xl, int slot, gf_boolean_t bypass);
+const char *xlator_fop_slot_name (int slot);
+
 void xlator_foreach_depth_first (xlator_t *this,
 				 void (*fn) (xlator_t *each,
 					     void *data),
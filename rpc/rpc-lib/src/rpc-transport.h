@@ -69,6 +69,8 @@ struct peer_info {
         // OP-VERSION of clients
         uint32_t max_op_version;
         uint32_t min_op_version;
+        // Peer decodes compact dicts, see dict_unserialize()
+        gf_boolean_t compact_dict;
         //Volume mounted by client
         char volname[NAME_MAX];
 };
@@ -167,6 +169,19 @@ struct rpc_transport_pollin {
 };
 typedef struct rpc_transport_pollin rpc_transport_pollin_t;
 
+/* server side per-connection request window, see rpcsvc_flow_update () */
+struct rpc_transport_flow {
+        int32_t             window;
+        int32_t             peak;      /* most requests in flight this
+                                          interval */
+        uint32_t            min_delay; /* lowest queue delay (usec) of the
+                                          requests completed this interval */
+        struct timespec     interval_start;
+        gf_boolean_t        throttled;
+        uint64_t            grown;
+        uint64_t            shrunk;
+};
+
 typedef int (*rpc_transport_notify_t) (rpc_transport_t *, void *mydata,
                                        rpc_transport_event_t, void *data, ...);
 
@@ -186,7 +201,8 @@ struct rpc_transport {
         pthread_mutex_t            lock;
         int32_t                    refcount;
 
-        int32_t                    outstanding_rpc_count;
+        int32_t                    outstanding_rpc_count; /* atomic */
+        struct rpc_transport_flow  flow;
 
         glusterfs_ctx_t           *ctx;
         dict_t                    *options;
@@ -81,6 +81,11 @@ typedef struct rpcsvc_state {
         gf_boolean_t            addr_namelookup;
         /* determine whether throttling is needed, by default OFF */
         gf_boolean_t            throttle;
+
+        /* size the per-client limit from the queueing delay the requests
+         * see, instead of outstanding_rpc_limit; by default OFF */
+        gf_boolean_t            flow_control;
+        uint32_t                flow_target; /* usec */
 } rpcsvc_t;
 
 /* DRC START */
@@ -25,6 +25,7 @@
 #include "syncop.h"
 #include "rpc-drc.h"
 #include "protocol-common.h"
+#include "timespec.h"
 
 #include <errno.h>
 #include <pthread.h>
@@ -171,47 +172,114 @@ rpcsvc_can_outstanding_req_be_ignored (rpcsvc_request_t *req)
         return _gf_false;
 }
 
+/*
+ * AIMD window of one connection, in the spirit of CoDel: if every request
+ * completed over an interval waited longer than the target in the brick's
+ * queues, there is a standing queue and the window is halved; if the client
+ * filled the window and the queue drained, it may send a little more.
+ * Called with trans->lock held, returns the window to enforce.
+ */
+static int
+rpcsvc_flow_update (rpcsvc_request_t *req, int delta)
+{
+        struct rpc_transport_flow *flow    = &req->trans->flow;
+        rpcsvc_t                  *svc     = req->svc;
+        struct timespec            now     = {0, };
+        int64_t                    elapsed = 0;
+
+        if (!flow->window) {
+                flow->window = svc->outstanding_rpc_limit;
+                if (!flow->window ||
+                    flow->window > RPCSVC_FLOW_MAX_WINDOW)
+                        flow->window = RPCSVC_FLOW_MAX_WINDOW;
+                if (flow->window < RPCSVC_FLOW_MIN_WINDOW)
+                        flow->window = RPCSVC_FLOW_MIN_WINDOW;
+                flow->min_delay = UINT32_MAX;
+                timespec_now (&flow->interval_start);
+        }
+
+        if (delta > 0) {
+                if (req->trans->outstanding_rpc_count > flow->peak)
+                        flow->peak = req->trans->outstanding_rpc_count;
+                return flow->window;
+        }
+
+        if (req->queue_delay < flow->min_delay)
+                flow->min_delay = req->queue_delay;
+
+        timespec_now (&now);
+        elapsed = (TS (now) - TS (flow->interval_start)) / 1000000;
+        if (elapsed < RPCSVC_FLOW_INTERVAL)
+                return flow->window;
+
+        if (flow->min_delay > svc->flow_target) {
+                flow->window /= 2;
+                if (flow->window < RPCSVC_FLOW_MIN_WINDOW)
+                        flow->window = RPCSVC_FLOW_MIN_WINDOW;
+                flow->shrunk++;
+        } else if (flow->peak >= flow->window &&
+                   flow->window < RPCSVC_FLOW_MAX_WINDOW) {
+                flow->window += RPCSVC_FLOW_WINDOW_STEP;
+                if (flow->window > RPCSVC_FLOW_MAX_WINDOW)
+                        flow->window = RPCSVC_FLOW_MAX_WINDOW;
+                flow->grown++;
+        }
+
+        flow->interval_start = now;
+        flow->min_delay = UINT32_MAX;
+        flow->peak = req->trans->outstanding_rpc_count;
+
+        return flow->window;
+}
+
 int
 rpcsvc_request_outstanding (rpcsvc_request_t *req, int delta)
 {
-        int             ret = -1;
-        int             old_count = 0;
-        int             new_count = 0;
-        int             limit = 0;
-        gf_boolean_t    throttle = _gf_false;
+        int              ret      = -1;
+        int              limit    = 0;
+        gf_boolean_t     throttle = _gf_false;
+        gf_boolean_t     want     = _gf_false;
+        rpc_transport_t *trans    = NULL;
 
         if (!req)
                 goto out;
 
+        trans = req->trans;
+
+        /* The count is kept whatever the mode, so that it is still right
+         * when throttling or flow control gets switched on while requests
+         * are in flight. Only the limit depends on the mode, and with
+         * neither on (the default) there is nothing to take the lock for. */
         throttle = rpcsvc_get_throttle (req->svc);
-        if (!throttle) {
+
+        if (rpcsvc_can_outstanding_req_be_ignored (req)) {
                 ret = 0;
                 goto out;
         }
 
-        if (rpcsvc_can_outstanding_req_be_ignored (req)) {
+        __sync_add_and_fetch (&trans->outstanding_rpc_count, delta);
+
+        if (!req->svc->flow_control && !throttle && !trans->flow.throttled) {
                 ret = 0;
                 goto out;
         }
 
-        pthread_mutex_lock (&req->trans->lock);
+        pthread_mutex_lock (&trans->lock);
         {
-                limit = req->svc->outstanding_rpc_limit;
-                if (!limit)
-                        goto unlock;
-
-                old_count = req->trans->outstanding_rpc_count;
-                req->trans->outstanding_rpc_count += delta;
-                new_count = req->trans->outstanding_rpc_count;
+                if (req->svc->flow_control)
+                        limit = rpcsvc_flow_update (req, delta);
+                else if (throttle)
+                        limit = req->svc->outstanding_rpc_limit;
 
-                if (old_count <= limit && new_count > limit)
-                        ret = rpc_transport_throttle (req->trans, _gf_true);
-
-                if (old_count > limit && new_count <= limit)
-                        ret = rpc_transport_throttle (req->trans, _gf_false);
+                want = (limit && trans->outstanding_rpc_count > limit);
+                ret = 0;
+                if (want != trans->flow.throttled) {
+                        ret = rpc_transport_throttle (trans, want);
+                        if (ret == 0)
+                                trans->flow.throttled = want;
+                }
         }
-unlock:
-        pthread_mutex_unlock (&req->trans->lock);
+        pthread_mutex_unlock (&trans->lock);
 
 out:
         return ret;
@@ -2240,6 +2308,42 @@ rpcsvc_set_outstanding_rpc_limit (rpcsvc_t *svc, dict_t *options, int defvalue)
         return (0);
 }
 
+/*
+ * Configure() the rpc.flow-control and rpc.flow-target-delay params. With
+ * flow control on, rpc.outstanding-rpc-limit only gives the initial window
+ * of a connection, see rpcsvc_flow_update ().
+ */
+int
+rpcsvc_set_flow_control (rpcsvc_t *svc, dict_t *options, gf_boolean_t defvalue)
+{
+        int             ret       = 0;
+        int             target    = 0;
+        static char    *flowkey   = "rpc.flow-control";
+        static char    *targetkey = "rpc.flow-target-delay";
+
+        if ((!svc) || (!options))
+                return (-1);
+
+        ret = dict_get_str_boolean (options, flowkey, defvalue);
+        if (ret < 0)
+                ret = defvalue;
+
+        if (dict_get_int32 (options, targetkey, &target) < 0)
+                target = RPCSVC_DEFAULT_FLOW_TARGET;
+        if (target < 1 || target > RPCSVC_MAX_FLOW_TARGET)
+                target = RPCSVC_DEFAULT_FLOW_TARGET;
+
+        if (svc->flow_control != ret ||
+            svc->flow_target != target * 1000) {
+                svc->flow_control = ret;
+                svc->flow_target = target * 1000;
+                gf_log (GF_RPCSVC, GF_LOG_INFO, "Configured %s %s, %s %dms",
+                        flowkey, ret ? "on" : "off", targetkey, target);
+        }
+
+        return (0);
+}
+
 /*
  * Enable throttling for rpcsvc_t svc.
  * Returns 0 on success, -1 otherwise.
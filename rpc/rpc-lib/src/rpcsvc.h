@@ -38,6 +38,15 @@
 #define RPCSVC_MAX_OUTSTANDING_RPC_LIMIT 65536
 #define RPCSVC_MIN_OUTSTANDING_RPC_LIMIT 0 /* No limit i.e. Unlimited */
 
+/* adaptive flow control: per-connection window bounds, additive increase
+ * per interval, and the queueing delay (msec) a brick may build up */
+#define RPCSVC_FLOW_MIN_WINDOW          8
+#define RPCSVC_FLOW_MAX_WINDOW          1024
+#define RPCSVC_FLOW_WINDOW_STEP         8
+#define RPCSVC_FLOW_INTERVAL            100     /* msec */
+#define RPCSVC_DEFAULT_FLOW_TARGET      5
+#define RPCSVC_MAX_FLOW_TARGET          1000
+
 #define GF_RPCSVC       "rpc-service"
 #define RPCSVC_THREAD_STACK_SIZE ((size_t)(1024 * GF_UNIT_KB))
 
@@ -246,6 +255,10 @@ struct rpcsvc_request {
 
         /* pointer to cached reply for use in DRC */
         drc_cached_op_t         *reply;
+
+        /* usec the request waited in xlator queues, filled in by the
+         * program before replying; drives rpcsvc_flow_update () */
+        uint32_t                queue_delay;
 };
 
 #define rpcsvc_request_program(req) ((rpcsvc_program_t *)((req)->prog))
@@ -598,6 +611,10 @@ rpcsvc_set_root_squash (rpcsvc_t *svc, dict_t *options);
 int
 rpcsvc_set_outstanding_rpc_limit (rpcsvc_t *svc, dict_t *options, int defvalue);
 
+int
+rpcsvc_set_flow_control (rpcsvc_t *svc, dict_t *options,
+                         gf_boolean_t defvalue);
+
 int
 rpcsvc_set_throttle_on (rpcsvc_t *svc);
 
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+## Records of concurrent creates all make it to the changelog, with one
+## write per fop or grouped, and land before the rollover. Data records
+## may be left to the writer, which gets them out within the delay.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+. $(dirname $0)/../changelog.rc
+
+cleanup;
+
+function journaled_creates {
+    cat $B0/${V0}1/.glusterfs/changelogs/CHANGELOG.* 2>/dev/null | \
+        tr '\0' '\n' | grep -a -c "/$1-[0-9]*$"
+}
+
+function journaled_writes {
+    cat $B0/${V0}1/.glusterfs/changelogs/CHANGELOG.* 2>/dev/null | \
+        tr '\0' '\n' | grep -a -c "^D"
+}
+
+function journaled_writes_since {
+    if [ $(journaled_writes) -ge $(($1 + $2)) ]; then echo Y; else echo N; fi
+}
+
+function create_files {
+    for t in 1 2 3 4; do
+        (for i in $(seq 1 50); do touch $M0/$1-$t$i; done) &
+    done
+    wait
+}
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}1
+TEST $CLI volume set $V0 changelog.changelog on
+TEST $CLI volume set $V0 changelog.rollover-time 3
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+
+TEST create_files sync
+EXPECT_WITHIN 10 "200" journaled_creates sync
+
+TEST $CLI volume set $V0 changelog.group-commit-delay 500
+TEST create_files deferred
+EXPECT_WITHIN 10 "200" journaled_creates deferred
+data_before=$(journaled_writes)
+for i in $(seq 1 20); do
+        echo data >> $M0/deferred-1$i
+done
+EXPECT_WITHIN 10 "Y" journaled_writes_since $data_before 20
+
+TEST $CLI volume set $V0 changelog.group-commit off
+TEST create_files direct
+EXPECT_WITHIN 10 "200" journaled_creates direct
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume start $V0
+
+# well-known (trusted.afr.*, trusted.gfid), prefixed and unknown keys all
+# have to survive both encodings
+function xattr_roundtrip {
+        local f=$M0/$1
+
+        touch $f || return 1
+        setfattr -n user.compact.$1 -v value-$1 $f || return 1
+        setfattr -n user.$1 -v 0x0102030400 $f || return 1
+        [ "$(getfattr --only-values -n user.compact.$1 $f)" == "value-$1" ] \
+                || return 1
+        [ "$(getfattr -e hex --only-values -n user.$1 $f)" == "0x0102030400" ] \
+                || return 1
+        getfattr -d -m . $f > /dev/null
+}
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 1
+TEST xattr_roundtrip compact
+TEST dd if=/dev/zero of=$M0/data bs=64k count=16
+TEST ls -l $M0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# a client that does not want the compact encoding talks to the same bricks
+TEST $CLI volume set $V0 client.compact-dict off
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 1
+TEST xattr_roundtrip legacy
+EXPECT "value-compact" getfattr --only-values -n user.compact.compact \
+                                 $M0/compact
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# and so does one whose bricks do not offer it
+TEST $CLI volume set $V0 client.compact-dict on
+TEST $CLI volume set $V0 server.compact-dict off
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 1
+TEST xattr_roundtrip mixed
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
@@ -0,0 +1,47 @@
+#!/bin/bash
+
+## server.event-pin-workers starts the bricks with --event-pin-workers.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function brick_pinned {
+        local pid=$(get_brick_pid $V0 $H0 $1)
+        tr '\0' '\n' < /proc/$pid/cmdline | grep -c '^--event-pin-workers$'
+}
+
+function brick_event_mode {
+        local sdump=$(generate_brick_statedump $V0 $H0 $1)
+        grep -A1 "^\[event-pool\]" $sdump | grep "^mode=" | cut -d= -f2
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 server.event-threads 4
+TEST $CLI volume set $V0 server.event-pin-workers on
+EXPECT "on" volume_option $V0 server.event-pin-workers
+TEST $CLI volume start $V0
+
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" brick_pinned $B0/${V0}0
+EXPECT "1" brick_pinned $B0/${V0}1
+EXPECT "pinned" brick_event_mode $B0/${V0}0
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+TEST dd if=/dev/zero of=$M0/file bs=64k count=64
+TEST dd if=$M0/file of=/dev/null bs=64k
+
+## the bricks pick up a change only when they are restarted
+TEST $CLI volume set $V0 server.event-pin-workers off
+EXPECT "1" brick_pinned $B0/${V0}0
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume start $V0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "0" brick_pinned $B0/${V0}0
+EXPECT "0" brick_pinned $B0/${V0}1
+
+cleanup;
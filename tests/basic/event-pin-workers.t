@@ -0,0 +1,32 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 client.event-threads 4
+TEST $CLI volume start $V0
+
+TEST glusterfs --event-pin-workers --volfile-server=$H0 --volfile-id=$V0 $M0
+
+TEST dd if=/dev/zero of=$M0/file bs=64k count=64
+
+sdump=$(generate_mount_statedump $V0)
+EXPECT "pinned" echo $(grep -A1 "^\[event-pool\]" $sdump | grep "^mode=" | cut -d= -f2)
+# pinned pollers never have to re-arm an fd after its handler ran
+EXPECT "0" echo $(grep "^rearms=" $sdump | cut -d= -f2 | sort -u)
+
+# shrinking the poller count hands the fds over to the remaining pollers
+TEST $CLI volume set $V0 client.event-threads 1
+TEST dd if=$M0/file of=/dev/null bs=64k
+TEST dd if=/dev/zero of=$M0/file2 bs=64k count=64
+
+cleanup_mount_statedump $V0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
@@ -0,0 +1,47 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function ioc_value {
+        local key=$1
+        local statedump=$(generate_mount_statedump $V0)
+
+        sed -n '/^\[io-cache.priv\]/,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.cache-size 8MB
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume start $V0
+
+# keep the kernel page cache out of the way, every read reaches io-cache
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --direct-io-mode=yes $M0
+
+TEST dd if=/dev/urandom of=$M0/hot bs=128k count=8
+TEST dd if=/dev/zero of=$M0/scan bs=128k count=256
+
+EXPECT "1" ioc_value shards
+
+# read twice, the hot file is frequently used now
+TEST dd if=$M0/hot of=/dev/null bs=128k
+TEST dd if=$M0/hot of=/dev/null bs=128k
+TEST [ $(ioc_value hits) -ge 8 ]
+misses=$(ioc_value misses)
+
+# a scan four times the cache size only cycles through the recent pages
+TEST dd if=$M0/scan of=/dev/null bs=128k
+TEST [ $(ioc_value evictions) -gt 0 ]
+TEST dd if=$M0/hot of=/dev/null bs=128k
+TEST [ $(( $(ioc_value misses) - misses )) -le 256 ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
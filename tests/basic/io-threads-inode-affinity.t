@@ -0,0 +1,47 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function iot_value {
+        local key=$1
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+
+        sed -n '/^\[performance\/io-threads\./,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.io-thread-inode-affinity on
+TEST $CLI volume set $V0 cluster.eager-lock off
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --direct-io-mode=yes $M0
+
+TEST [ "$(iot_value inode_affinity)" == "1" ]
+
+# Many writers on one file: their transactions' inodelks and xattrops go
+# through a single lane on the bricks.
+TEST touch $M0/file
+for i in $(seq 0 7); do
+        dd if=/dev/zero of=$M0/file bs=4k count=256 seek=$((i * 256)) \
+           conv=notrunc oflag=direct 2>/dev/null &
+done
+wait
+
+TEST [ "$(stat -c %s $M0/file)" == "8388608" ]
+EXPECT "^0$" get_pending_heal_count $V0
+EXPECT "^0$" iot_value lanes_busy
+
+TEST $CLI volume set $V0 performance.io-thread-inode-affinity off
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "^0$" iot_value inode_affinity
+TEST dd if=/dev/zero of=$M0/file bs=4k count=256 conv=notrunc oflag=direct
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../traps.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function iot_value {
+        local key=$1
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}$2)
+
+        sed -n '/^\[performance\/io-threads\./,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+function count_brick_processes {
+        pgrep glusterfsd | wc -l
+}
+
+TEST glusterd
+TEST $CLI volume set all cluster.brick-multiplex on
+push_trapfunc "$CLI volume set all cluster.brick-multiplex off"
+push_trapfunc "cleanup"
+
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume start $V0
+EXPECT 1 count_brick_processes
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --direct-io-mode=yes $M0
+
+# both attached bricks run on the one pool
+EXPECT "1" iot_value shared_pool 0
+EXPECT "2" iot_value pool_members 1
+
+for i in $(seq 0 7); do
+        dd if=/dev/zero of=$M0/file$i bs=4k count=256 oflag=direct \
+           2>/dev/null &
+done
+wait
+
+TEST [ "$(stat -c %s $M0/file7)" == "1048576" ]
+EXPECT "^0$" iot_value queue_depth 0
+EXPECT "^0$" iot_value queue_depth 1
+TEST [ "$(iot_value dequeued 1)" -gt 0 ]
+
+TEST $CLI volume set $V0 performance.io-thread-fair-share-weight 4
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "^4$" iot_value fair_share_weight 0
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
@@ -0,0 +1,32 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume start $V0
+
+logfile=$(gluster --print-logdir)/async.log
+rm -f $logfile
+
+TEST glusterfs --log-async --log-level=DEBUG --log-file=$logfile \
+               --volfile-server=$H0 --volfile-id=$V0 $M0
+
+TEST dd if=/dev/zero of=$M0/file bs=4k count=256
+TEST ls -l $M0
+
+sdump=$(generate_mount_statedump $V0)
+EXPECT "async" echo $(grep -A1 "^\[logging\]" $sdump | grep "^mode=" | cut -d= -f2)
+TEST [ $(grep "^written=" $sdump | tail -1 | cut -d= -f2) -gt 0 ]
+cleanup_mount_statedump $V0
+
+# whatever was queued is written out before the process exits
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "1" echo $(grep -c "cleanup_and_exit" $logfile)
+
+cleanup;
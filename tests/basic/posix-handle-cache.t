@@ -0,0 +1,59 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function posix_value {
+        local key=$1
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+
+        sed -n '/^\[storage\/posix\./,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+function brick_gfid {
+        gf_gfid_xattr_to_str $(gf_get_gfid_xattr $B0/${V0}0/$1)
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.handle-cache-size 1024
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --entry-timeout=0 \
+                --attribute-timeout=0 $M0
+
+TEST mkdir -p $M0/a/b/c
+TEST touch $M0/a/b/c/f
+for i in $(seq 1 10); do
+        stat $M0/a/b/c/f > /dev/null
+done
+TEST [ $(posix_value handle_cache_gfid_hits) -gt 0 ]
+TEST [ $(posix_value handle_cache_path_hits) -gt 0 ]
+
+# The old names come back with new directories and files; the brick must
+# hand out their gfids, not the cached ones of what moved away.
+TEST mv $M0/a $M0/z
+TEST mkdir -p $M0/a/b/c
+TEST touch $M0/a/b/c/f
+EXPECT "$(brick_gfid a/b/c/f)" get_gfid_string $M0/a/b/c/f
+EXPECT "$(brick_gfid z/b/c/f)" get_gfid_string $M0/z/b/c/f
+TEST [ "$(brick_gfid a/b/c/f)" != "$(brick_gfid z/b/c/f)" ]
+
+TEST rm -f $M0/z/b/c/f
+TEST touch $M0/z/b/c/f
+EXPECT "$(brick_gfid z/b/c/f)" get_gfid_string $M0/z/b/c/f
+
+TEST $CLI volume set $V0 storage.handle-cache-size 0
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "^0$" posix_value handle_cache_size
+TEST stat $M0/z/b/c/f
+EXPECT "^0$" posix_value handle_cache_entries
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
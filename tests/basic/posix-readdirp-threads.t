@@ -0,0 +1,43 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function listing {
+        ls -ln --time-style=+%s $1 | sort
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.readdirp-threads 4
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.readdir-ahead off
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --entry-timeout=0 \
+                --attribute-timeout=0 $M0
+
+# Entries of one readdirp reply are stat'ed by several helpers; in the root
+# and in a nested directory every one has to come back with its own attrs.
+TEST mkdir -p $M0/a/b
+for d in $M0 $M0/a/b; do
+        for i in $(seq 1 300); do
+                dd if=/dev/zero of=$d/f$i bs=1 count=$i 2>/dev/null
+        done
+done
+
+EXPECT "^301$" echo $(ls $M0 | wc -l)
+EXPECT "^300$" echo $(ls $M0/a/b | wc -l)
+TEST [ "$(listing $M0/a/b)" == "$(listing $B0/${V0}0/a/b)" ]
+TEST [ "$(listing $M0 | grep -v ' a$')" == \
+       "$(listing $B0/${V0}0 | grep -v ' a$')" ]
+
+TEST $CLI volume set $V0 storage.readdirp-threads 0
+TEST [ "$(listing $M0/a/b)" == "$(listing $B0/${V0}0/a/b)" ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
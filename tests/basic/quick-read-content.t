@@ -0,0 +1,68 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+SIZES="1 100 4096 5000 65536"
+declare -A MD5
+
+function write_files {
+        for s in $SIZES; do
+                dd if=/dev/urandom of=$M0/file-$s bs=$s count=1 2>/dev/null
+                MD5[$s]=$(md5sum < $M0/file-$s)
+        done
+}
+
+function check_files {
+        for s in $SIZES; do
+                [ "$(md5sum < $M0/file-$s)" == "${MD5[$s]}" ] || return 1
+        done
+        return 0
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+# Replicated: content comes from a single child and reaches the reply
+# afr hands up even when that is another child's.
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0..2}
+TEST $CLI volume start $V0
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+TEST write_files
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+TEST check_files
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+TEST check_files
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+# Dispersed: every brick returns its fragment and ec decodes the file,
+# also with bricks missing.
+TEST $CLI volume create $V1 disperse 6 redundancy 2 $H0:$B0/${V1}{0..5}
+TEST $CLI volume start $V1
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V1 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V1 0
+TEST write_files
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V1 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V1 0
+TEST check_files
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST kill_brick $V1 $H0 $B0/${V1}0
+TEST kill_brick $V1 $H0 $B0/${V1}3
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V1 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V1 0
+TEST check_files
+
+cleanup;
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+## With the bricks of a volume on more than one node, each quotad leases
+## out only its slice of the space left, so the limit holds however the
+## writes are spread over the nodes.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+. $(dirname $0)/../cluster.rc
+
+cleanup;
+
+QDD=$(dirname $0)/quota
+# compile the test write program and run it
+build_tester $(dirname $0)/quota.c -o $QDD
+
+function written_bytes {
+    stat -c %s $M0/dir/file* 2>/dev/null | \
+        awk '{ s += $1 } END { print s }'
+}
+
+function check_peers {
+    $CLI_1 peer status | grep 'Peer in Cluster (Connected)' | wc -l
+}
+
+TEST launch_cluster 2;
+TEST $CLI_1 peer probe $H2;
+EXPECT_WITHIN $PROBE_TIMEOUT 1 check_peers
+
+# quotausage and friends go through $CLI
+CLI=$CLI_1
+
+TEST $CLI_1 volume create $V0 $H1:$B1/${V0}1 $H2:$B2/${V0}2 \
+                              $H1:$B1/${V0}3 $H2:$B2/${V0}4
+TEST $CLI_1 volume set $V0 performance.write-behind off
+TEST $CLI_1 volume start $V0
+
+TEST $CLI_1 volume quota $V0 enable
+TEST $CLI_1 volume quota $V0 soft-timeout 0
+TEST $CLI_1 volume quota $V0 hard-timeout 0
+TEST $CLI_1 volume set $V0 features.quota-lease-size 4MB
+TEST $CLI_1 volume set $V0 features.quota-lease-timeout 10
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H1 $M0
+
+TEST mkdir $M0/dir
+TEST $CLI_1 volume quota $V0 limit-usage /dir 20MB
+
+## the files land on bricks of both nodes, which all lease space at once
+for i in $(seq 1 8); do
+        $QDD $M0/dir/file$i 256 40 &
+done
+wait
+
+TEST [ $(written_bytes) -le $((20 * 1024 * 1024)) ]
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "Yes" quota_hl_exceeded "/dir"
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+rm -f $QDD
+cleanup;
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+## Writes under space leased from quotad get through, and the limit still
+## holds once the leases run out near it.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+QDD=$(dirname $0)/quota
+# compile the test write program and run it
+build_tester $(dirname $0)/quota.c -o $QDD
+
+function written_bytes {
+    stat -c %s $M0/dir/file1 $M0/dir/file2 2>/dev/null | \
+        awk '{ s += $1 } END { print s }'
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2}
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST $CLI volume quota $V0 enable
+TEST $CLI volume quota $V0 soft-timeout 0
+TEST $CLI volume quota $V0 hard-timeout 0
+TEST $CLI volume set $V0 features.quota-lease-size 2MB
+TEST $CLI volume set $V0 features.quota-lease-timeout 10
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST mkdir $M0/dir
+TEST $CLI volume quota $V0 limit-usage /dir 20MB
+
+TEST $QDD $M0/dir/file1 256 32
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "8.0MB" quotausage "/dir"
+
+## leases shrink to nothing near the limit, which is then enforced
+TEST ! $QDD $M0/dir/file2 256 80
+TEST [ $(written_bytes) -le $((20 * 1024 * 1024)) ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+rm -f $QDD
+cleanup;
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+## Size updates gathered by features.quota-update-delay make it to every
+## directory up to the root, and file and directory counts are right.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function create_files {
+    for d in 1 2 3 4; do
+        (for i in $(seq 1 25); do
+             dd if=/dev/zero of=$M0/$deep/$d/file$i bs=4k count=8 \
+                2>/dev/null
+         done) &
+    done
+    wait
+}
+
+function quota_dirty {
+    getfattr -n trusted.glusterfs.quota.dirty -e hex $B0/${V0}1/$1 \
+        2>/dev/null | awk -F= '/quota.dirty/ { print $2 }'
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}1
+TEST $CLI volume start $V0
+
+TEST $CLI volume quota $V0 enable
+TEST $CLI volume set $V0 features.quota-update-delay 500
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+deep=a/b/c/d/e
+TEST mkdir -p $M0/$deep/{1,2,3,4}
+
+TEST $CLI volume quota $V0 limit-usage / 1GB
+TEST $CLI volume quota $V0 limit-usage /a/b 1GB
+TEST $CLI volume quota $V0 limit-objects /a/b 1000
+
+TEST create_files
+
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "3.1MB" quotausage "/"
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "3.1MB" quotausage "/a/b"
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "100" quota_object_list_field "/a/b" 4
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "8" quota_object_list_field "/a/b" 5
+
+## a parent is held dirty on disk while updates of its children wait
+TEST $CLI volume set $V0 features.quota-update-delay 5000
+TEST dd if=/dev/zero of=$M0/$deep/1/held bs=4k count=8
+EXPECT_WITHIN 4 "0x3100" quota_dirty "$deep/1"
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "0x3000" quota_dirty "$deep/1"
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "3.2MB" quotausage "/a/b"
+
+## updates are propagated at once again
+TEST $CLI volume set $V0 features.quota-update-delay 0
+TEST rm -f $M0/$deep/1/*
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "2.3MB" quotausage "/a/b"
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
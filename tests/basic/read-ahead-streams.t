@@ -0,0 +1,47 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function ra_value {
+        local key=$1
+        local statedump=$(generate_mount_statedump $V0)
+
+        sed -n '/^\[xlator.performance.read-ahead.priv\]/,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead-prefetch-limit 16MB
+TEST $CLI volume start $V0
+
+# keep the kernel page cache out of the way, every read reaches read-ahead
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --direct-io-mode=yes $M0
+
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=32
+
+TEST dd if=$M0/file of=/dev/null bs=128k
+TEST [ $(ra_value sequential_streams) -ge 1 ]
+TEST [ $(ra_value hits) -gt 0 ]
+
+# Reads 512k apart through fds of their own: the fd held open keeps the
+# inode's streams around between them.
+exec 5<$M0/file
+for i in $(seq 0 31); do
+        dd if=$M0/file of=/dev/null bs=64k count=1 skip=$((i * 8)) 2>/dev/null
+done
+TEST [ $(ra_value strided_streams) -ge 1 ]
+exec 5<&-
+
+TEST [ $(ra_value cached_bytes) -le 16777216 ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
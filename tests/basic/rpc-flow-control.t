@@ -0,0 +1,69 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function flow_value {
+        local key=$1
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+
+        grep -a "^client.0.$key=" $statedump | cut -f2 -d'='
+        rm -f $statedump
+}
+
+function window_shrinks_under_load {
+        for i in {1..8}; do
+                dd if=/dev/zero of=$M0/f$i bs=64k count=64 conv=fsync \
+                   2>/dev/null &
+        done
+        wait
+        if [ "$(flow_value window-shrunk)" -gt 0 ]; then
+                echo "Y"
+        else
+                echo "N"
+        fi
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 server.outstanding-rpc-limit 32
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+
+# flow control is off unless asked for
+TEST dd if=/dev/zero of=$M0/data bs=128k count=16 conv=fsync
+EXPECT "" flow_value flow-window
+
+# windows start at outstanding-rpc-limit, a single writer never fills it
+TEST $CLI volume set $V0 server.flow-control on
+TEST dd if=/dev/zero of=$M0/data bs=128k count=64 conv=fsync
+EXPECT "32" flow_value flow-window
+EXPECT "0" flow_value window-shrunk
+EXPECT "0" flow_value throttled
+
+# a brick that tolerates no queueing at all shrinks the window, which stays
+# within bounds
+TEST $CLI volume set $V0 server.flow-target-delay 1
+TEST $CLI volume set $V0 performance.io-thread-count 1
+EXPECT_WITHIN 60 "Y" window_shrinks_under_load
+TEST [ $(flow_value flow-window) -lt 32 ]
+TEST [ $(flow_value flow-window) -ge 8 ]
+TEST cat $M0/f1 > /dev/null
+
+# the outstanding count is kept while flow control is off, so it must have
+# drained back to nothing after switching it off and on under load
+TEST $CLI volume set $V0 server.flow-control off
+for i in {1..4}; do
+        dd if=/dev/zero of=$M0/g$i bs=64k count=64 conv=fsync 2>/dev/null &
+done
+TEST $CLI volume set $V0 server.flow-control on
+wait
+EXPECT_WITHIN 10 "0" flow_value outstanding
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
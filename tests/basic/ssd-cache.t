@@ -0,0 +1,60 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function sc_value {
+        local key=$1
+        local statedump=$(generate_mount_statedump $V0)
+
+        sed -n '/^\[performance.ssd-cache.priv\]/,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+function sc_pages_on_disk {
+        find $B0/ssd-cache -type f ! -name '.tmp-*' | wc -l
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.ssd-cache on
+TEST $CLI volume set $V0 performance.ssd-cache-dir $B0/ssd-cache
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume start $V0
+
+# keep the kernel page cache out of the way, every read reaches ssd-cache
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --direct-io-mode=yes $M0
+
+TEST dd if=/dev/urandom of=$M0/file bs=128k count=8
+sum=$(md5sum < $B0/${V0}0/file)
+
+# the first read misses and writes the pages out behind the reply
+TEST dd if=$M0/file of=/dev/null bs=128k
+EXPECT_WITHIN 10 "8" sc_value admitted
+EXPECT "8" sc_pages_on_disk
+
+EXPECT "$sum" echo $(md5sum < $M0/file)
+TEST [ $(sc_value hits) -ge 8 ]
+
+# a new mount serves the pages left in cache-dir
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --direct-io-mode=yes $M0
+EXPECT "$sum" echo $(md5sum < $M0/file)
+TEST [ $(sc_value hits) -ge 8 ]
+EXPECT "0" sc_value misses
+
+# a changed file is not served from the old pages
+TEST dd if=/dev/urandom of=$M0/file bs=128k count=1 seek=2 conv=notrunc
+sum=$(md5sum < $B0/${V0}0/file)
+EXPECT "$sum" echo $(md5sum < $M0/file)
+TEST [ $(sc_value stale) -ge 1 ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
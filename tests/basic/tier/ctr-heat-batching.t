@@ -0,0 +1,69 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+HOT_BRICK=$B0/hot/${V0}0
+HOT_DB=$HOT_BRICK/.glusterfs/${V0}0.db
+
+function ctr_value {
+        local key=$1
+        local statedump=$(generate_brick_statedump $V0 $H0 $HOT_BRICK)
+
+        sed -n '/^\[xlator\.features\.ctr\.priv\]/,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+function write_heat {
+        local gfid=$(gf_gfid_xattr_to_str $(gf_get_gfid_xattr $HOT_BRICK/$1))
+
+        echo "select WRITE_FREQ_CNTR from gf_file_tb where GF_ID='$gfid';" | \
+                sqlite3 $HOT_DB
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST mkdir -p $B0/cold $B0/hot
+TEST $CLI volume create $V0 $H0:$B0/cold/${V0}0
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST $CLI volume attach-tier $V0 $H0:$HOT_BRICK
+TEST $CLI volume set $V0 cluster.tier-mode test
+TEST $CLI volume set $V0 cluster.tier-promote-frequency 3600
+TEST $CLI volume set $V0 cluster.tier-demote-frequency 3600
+TEST $CLI volume set $V0 features.record-counters on
+TEST $CLI volume set $V0 features.ctr-heat-flush-interval 600000
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 $M0
+
+# The create reaches the database at once, the writes wait in memory until
+# the flusher runs.
+TEST touch $M0/file1
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "^1$" write_heat file1
+for i in $(seq 1 5); do
+        echo $i >> $M0/file1
+done
+EXPECT "^1$" write_heat file1
+EXPECT "^1$" ctr_value heat-backlog
+
+# A shorter interval wakes the flusher, and all five writes are counted.
+TEST $CLI volume set $V0 features.ctr-heat-flush-interval 100
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "^6$" write_heat file1
+EXPECT "^0$" ctr_value heat-backlog
+EXPECT "^0$" ctr_value heat-dropped
+
+# Without batching every write is in the database when it returns.
+TEST $CLI volume set $V0 features.ctr-heat-batch-size 0
+sleep 1
+echo 6 >> $M0/file1
+EXPECT "^7$" write_heat file1
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function wb_value {
+        local key=$1
+        local statedump=$(generate_mount_statedump $V0)
+
+        sed -n '/^\[xlator.performance.write-behind.priv\]/,/^\[/p' $statedump | \
+                grep -a "^$key=" | cut -f2 -d'='
+        rm -f $statedump
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.write-behind-window-size 4MB
+TEST $CLI volume set $V0 performance.write-behind-dirty-limit 4MB
+TEST $CLI volume set $V0 performance.write-behind-writeback-age 1
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-server=$H0 --volfile-id=$V0 --direct-io-mode=yes $M0
+
+TEST [ "$(wb_value dirty_limit)" == "4194304" ]
+
+# Small writes to many files at once cannot all be cached: past the budget
+# the files already holding cached writes get throttled.
+TEST $CLI volume set $V0 performance.write-behind-dirty-limit 256KB
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "262144" wb_value dirty_limit
+for i in $(seq 1 8); do
+        dd if=/dev/zero of=$M0/file$i bs=4k count=1024 conv=notrunc 2>/dev/null &
+done
+wait
+TEST [ $(wb_value collapsed) -gt 0 ]
+TEST [ $(wb_value throttled) -gt 0 ]
+# each held back write is counted once, however often it is looked at
+TEST [ $(wb_value throttled) -le 8192 ]
+
+# A file left open with cached writes gets them written back after the age.
+exec 5>$M0/aged
+echo "aged data" >&5
+EXPECT_WITHIN 10 "^[1-9][0-9]*$" wb_value writebacks
+exec 5>&-
+
+EXPECT_WITHIN 10 "0" wb_value dirty
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
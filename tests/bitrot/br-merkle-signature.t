@@ -0,0 +1,66 @@
+#!/bin/bash
+
+## Objects get chunked signatures, which match after part of the object is
+## rewritten and signed again, and do not once it gets corrupted.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+function signature_type {
+    getfattr -e hex -n trusted.bit-rot.signature $1 2>/dev/null | \
+        sed -n 's/^trusted.bit-rot.signature=0x\(..\).*/\1/p'
+}
+
+function signed_version {
+    getfattr -e hex -n trusted.bit-rot.signature $1 2>/dev/null | \
+        sed -n 's/^trusted.bit-rot.signature=0x..\(.\{16\}\).*/\1/p'
+}
+
+function resigned {
+    [ -n "$(signed_version $1)" ] && [ "$(signed_version $1)" != "$2" ] && \
+        echo "Y" || echo "N"
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}1
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST $CLI volume bitrot $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" get_bitd_count
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" get_scrubd_count
+
+TEST $CLI volume set $V0 features.expiry-time 1
+TEST $CLI volume set $V0 features.signature-chunk-size 128KB
+TEST $CLI volume set $V0 features.hash-threads 4
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+backpath=$B0/${V0}1/FILE1
+
+TEST dd if=/dev/urandom of=$M0/FILE1 bs=1M count=4
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "02" signature_type $backpath
+version=$(signed_version $backpath)
+
+## rewrite a chunk in the middle, the others are not hashed again
+TEST dd if=/dev/urandom of=$M0/FILE1 bs=64K count=1 seek=20 conv=notrunc
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" resigned $backpath $version
+EXPECT "02" signature_type $backpath
+
+TEST $CLI volume bitrot $V0 scrub ondemand
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" scrub_status $V0 'Number of Scrubbed files'
+TEST ! getfattr -n trusted.bit-rot.bad-file $backpath
+
+## corrupt the object on the brick
+TEST dd if=/dev/urandom of=$backpath bs=4K count=1 seek=600 conv=notrunc
+
+TEST $CLI volume bitrot $V0 scrub ondemand
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT 'trusted.bit-rot.bad-file' check_for_xattr 'trusted.bit-rot.bad-file' $backpath
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
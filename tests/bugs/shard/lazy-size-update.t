@@ -0,0 +1,55 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup
+
+# Size updates held back by shard-size-update-interval are seen by the client
+# at once and reach the brick on close, truncate or when the timer fires.
+
+function brick_file_size {
+        printf "%d" 0x$(get_hex_xattr trusted.glusterfs.shard.file-size \
+                        $B0/${V0}0/$1 | cut -c1-16)
+}
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 features.shard on
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 features.shard-size-update-interval 2
+TEST $CLI volume start $V0
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST touch $M0/baz
+exec 5>>$M0/baz
+TEST dd if=/dev/zero bs=1M count=1 >&5
+EXPECT "1048576" stat -c %s $M0/baz
+EXPECT_WITHIN 10 "1048576" brick_file_size baz
+exec 5>&-
+
+TEST $CLI volume set $V0 features.shard-size-update-interval 60
+TEST touch $M0/foo
+exec 5>>$M0/foo
+TEST dd if=/dev/zero bs=1M count=10 >&5
+EXPECT "10485760" stat -c %s $M0/foo
+EXPECT "0" brick_file_size foo
+
+exec 5>&-
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "10485760" brick_file_size foo
+
+# truncate takes the pending changes along with its own
+TEST touch $M0/bar
+exec 5>>$M0/bar
+TEST dd if=/dev/zero bs=1M count=6 >&5
+TEST truncate -s 5M $M0/bar
+EXPECT "5242880" brick_file_size bar
+EXPECT "5242880" stat -c %s $M0/bar
+exec 5>&-
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
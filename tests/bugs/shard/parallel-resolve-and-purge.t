@@ -0,0 +1,83 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup
+
+# Writes, truncates and unlinks spanning more shards than shard-fop-window
+# lets in flight, with shards deleted in the background after unlink.
+
+function shard_count {
+        ls $B0/${V0}0/.shard | grep -c "^$1"
+}
+
+function purge_marks {
+        getfattr -d -m "trusted.glusterfs.shard.purge" -e hex \
+                 $B0/${V0}0/.shard 2>/dev/null | grep -c "^trusted"
+}
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 features.shard on
+TEST $CLI volume set $V0 features.shard-fop-window 2
+TEST $CLI volume start $V0
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# 40M in 4M shards, 9 of them under /.shard
+TEST dd if=/dev/urandom of=/tmp/shard-data.$$ bs=1M count=40
+TEST cp /tmp/shard-data.$$ $M0/foo
+gfid_foo=$(get_gfid_string $M0/foo)
+EXPECT "9" shard_count $gfid_foo
+TEST cmp /tmp/shard-data.$$ $M0/foo
+rm -f /tmp/shard-data.$$
+
+TEST truncate -s 10M $M0/foo
+EXPECT "2" shard_count $gfid_foo
+
+TEST unlink $M0/foo
+EXPECT "0" shard_count $gfid_foo
+
+TEST $CLI volume set $V0 features.shard-background-purge on
+TEST $CLI volume set $V0 features.shard-deletion-rate 2
+
+TEST dd if=/dev/zero of=$M0/bar bs=1M count=40
+gfid_bar=$(get_gfid_string $M0/bar)
+EXPECT "9" shard_count $gfid_bar
+
+TEST unlink $M0/bar
+TEST ! stat $M0/bar
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "0" shard_count $gfid_bar
+# the pending purge was on record in /.shard until done
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "0" purge_marks
+
+# A purge left pending (a client crashed right after the unlink) is picked
+# up by the next client, and one whose unlink never happened is dropped.
+TEST dd if=/dev/zero of=$M0/baz bs=1M count=40
+TEST dd if=/dev/zero of=$M0/qux bs=1M count=40
+gfid_baz=$(get_gfid_string $M0/baz)
+gfid_qux=$(get_gfid_string $M0/qux)
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+for b in $B0/${V0}{0,1}; do
+        # 4MB blocks, 40MB file
+        TEST setfattr -n trusted.glusterfs.shard.purge.$gfid_baz \
+                      -v 0x00000000004000000000000002800000 $b/.shard
+        TEST setfattr -n trusted.glusterfs.shard.purge.$gfid_qux \
+                      -v 0x00000000004000000000000002800000 $b/.shard
+        TEST rm -f $b/baz $b/.glusterfs/${gfid_baz:0:2}/${gfid_baz:2:2}/$gfid_baz
+done
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+# anything past the first block looks /.shard up
+TEST dd if=/dev/zero of=$M0/trigger bs=1M count=8
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "0" shard_count $gfid_baz
+EXPECT "9" shard_count $gfid_qux
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "0" purge_marks
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
@@ -2096,6 +2096,58 @@ afr_first_up_child (call_frame_t *frame, xlator_t *this)
         return 0;
 }
 
+/*
+ * File content is requested from a single child only (see
+ * afr_lookup_content_xattr_req()). If the reply picked to go up came from
+ * another child, move the content over as long as the child which read it
+ * is a good copy of the same data; otherwise drop it.
+ */
+static void
+afr_lookup_content_handover (call_frame_t *frame, xlator_t *this,
+                             int read_subvol)
+{
+        afr_private_t       *priv         = NULL;
+        afr_local_t         *local        = NULL;
+        struct afr_reply    *replies      = NULL;
+        unsigned char       *readable     = NULL;
+        data_t              *content      = NULL;
+        int                  content_subvol = -1;
+
+        priv = this->private;
+        local = frame->local;
+        replies = local->replies;
+        content_subvol = local->cont.lookup.content_subvol;
+
+        if (content_subvol < 0 || read_subvol < 0 ||
+            content_subvol == read_subvol)
+                return;
+        if (!replies[read_subvol].xdata)
+                return;
+
+        if (!replies[content_subvol].valid ||
+            replies[content_subvol].op_ret == -1 ||
+            !replies[content_subvol].xdata)
+                goto out;
+
+        content = dict_get (replies[content_subvol].xdata, GF_CONTENT_KEY);
+        if (!content)
+                goto out;
+
+        readable = alloca0 (priv->child_count);
+        afr_inode_read_subvol_get (local->inode, this, readable, NULL, NULL);
+        if (!readable[content_subvol])
+                goto out;
+
+        if (replies[content_subvol].poststat.ia_size !=
+            replies[read_subvol].poststat.ia_size)
+                goto out;
+
+        if (dict_set (replies[read_subvol].xdata, GF_CONTENT_KEY, content) == 0)
+                return;
+out:
+        dict_del (replies[read_subvol].xdata, GF_CONTENT_KEY);
+}
+
 static void
 afr_lookup_done (call_frame_t *frame, xlator_t *this)
 {
@@ -2219,6 +2271,7 @@ afr_lookup_done (call_frame_t *frame, xlator_t *this)
 		} else {
                         read_subvol = afr_data_subvol_get (local->inode, this,
                                                        NULL, NULL, NULL, &args);
+                        afr_lookup_content_handover (frame, this, read_subvol);
 		}
 	} else {
 	cant_interpret:
@@ -2683,7 +2736,10 @@ afr_discover_done (call_frame_t *frame, xlator_t *this)
                 } else {
                         read_subvol = afr_first_up_child (frame, this);
                 }
-	}
+		dict_del (local->replies[read_subvol].xdata, GF_CONTENT_KEY);
+	} else {
+                afr_lookup_content_handover (frame, this, read_subvol);
+        }
 
 unwind:
 	if (read_subvol == -1) {
@@ -2749,6 +2805,55 @@ afr_discover_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+/*
+ * Small file content only needs to travel once. Ask the child we expect to
+ * read from (or the first up data brick for a fresh inode) for it and send
+ * the remaining children a request without GF_CONTENT_KEY. Returns the
+ * request for those children, or NULL if every child gets local->xattr_req.
+ */
+static dict_t *
+afr_lookup_content_xattr_req (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t       *priv  = NULL;
+        afr_local_t         *local = NULL;
+        dict_t              *xattr_req = NULL;
+        int                  subvol = -1;
+        int                  i = 0;
+
+        priv = this->private;
+        local = frame->local;
+        local->cont.lookup.content_subvol = -1;
+
+        if (!dict_get (local->xattr_req, GF_CONTENT_KEY))
+                return NULL;
+
+        if (!gf_uuid_is_null (local->inode->gfid))
+                subvol = afr_data_subvol_get (local->inode, this, NULL, NULL,
+                                              NULL, NULL);
+        if (subvol < 0 || !local->child_up[subvol] ||
+            AFR_IS_ARBITER_BRICK (priv, subvol)) {
+                subvol = -1;
+                for (i = 0; i < priv->child_count; i++) {
+                        if (local->child_up[i] &&
+                            !AFR_IS_ARBITER_BRICK (priv, i)) {
+                                subvol = i;
+                                break;
+                        }
+                }
+        }
+        if (subvol < 0)
+                return NULL;
+
+        xattr_req = dict_copy_with_ref (local->xattr_req, NULL);
+        if (!xattr_req)
+                return NULL;
+        dict_del (xattr_req, GF_CONTENT_KEY);
+
+        local->cont.lookup.content_subvol = subvol;
+        return xattr_req;
+}
+
+
 int
 afr_discover_do (call_frame_t *frame, xlator_t *this, int err)
 {
@@ -2757,6 +2862,8 @@ afr_discover_do (call_frame_t *frame, xlator_t *this, int err)
 	afr_local_t *local = NULL;
 	afr_private_t *priv = NULL;
 	int call_count = 0;
+        dict_t *xattr_req = NULL;
+        int content_subvol = -1;
 
 	local = frame->local;
 	priv = this->private;
@@ -2778,18 +2885,26 @@ afr_discover_do (call_frame_t *frame, xlator_t *this, int err)
                 goto out;
         }
 
+        xattr_req = afr_lookup_content_xattr_req (frame, this);
+        content_subvol = local->cont.lookup.content_subvol;
+
         for (i = 0; i < priv->child_count; i++) {
                 if (local->child_up[i]) {
                         STACK_WIND_COOKIE (frame, afr_discover_cbk,
                                            (void *) (long) i,
                                            priv->children[i],
                                            priv->children[i]->fops->lookup,
-                                           &local->loc, local->xattr_req);
+                                           &local->loc,
+                                           (xattr_req && i != content_subvol) ?
+                                           xattr_req : local->xattr_req);
                         if (!--call_count)
                                 break;
                 }
         }
 
+        if (xattr_req)
+                dict_unref (xattr_req);
+
 	return 0;
 out:
 	AFR_STACK_UNWIND (lookup, frame, -1, local->op_errno, 0, 0, 0, 0);
@@ -2872,6 +2987,8 @@ afr_lookup_do (call_frame_t *frame, xlator_t *this, int err)
 	afr_local_t *local = NULL;
 	afr_private_t *priv = NULL;
 	int call_count = 0;
+        dict_t *xattr_req = NULL;
+        int content_subvol = -1;
 
 	local = frame->local;
 	priv = this->private;
@@ -2893,17 +3010,25 @@ afr_lookup_do (call_frame_t *frame, xlator_t *this, int err)
                 goto out;
         }
 
+        xattr_req = afr_lookup_content_xattr_req (frame, this);
+        content_subvol = local->cont.lookup.content_subvol;
+
         for (i = 0; i < priv->child_count; i++) {
                 if (local->child_up[i]) {
                         STACK_WIND_COOKIE (frame, afr_lookup_cbk,
                                            (void *) (long) i,
                                            priv->children[i],
                                            priv->children[i]->fops->lookup,
-                                           &local->loc, local->xattr_req);
+                                           &local->loc,
+                                           (xattr_req && i != content_subvol) ?
+                                           xattr_req : local->xattr_req);
                         if (!--call_count)
                                 break;
                 }
         }
+
+        if (xattr_req)
+                dict_unref (xattr_req);
 	return 0;
 out:
 	AFR_STACK_UNWIND (lookup, frame, -1, local->op_errno, 0, 0, 0, 0);
@@ -498,6 +498,8 @@ typedef struct _afr_local {
                 struct {
                         gf_boolean_t needs_fresh_lookup;
                         uuid_t gfid_req;
+                        /* only child asked for GF_CONTENT_KEY, or -1 */
+                        int content_subvol;
                 } lookup;
 
                 struct {
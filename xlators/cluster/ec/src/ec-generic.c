@@ -629,11 +629,93 @@ out:
 
 /* FOP: lookup */
 
+/* Each brick answers a content request with its own fragment of the file.
+ * Once 'fragments' answers of the same group carry a full fragment, the
+ * original data can be decoded here and handed up exactly as a replicated
+ * volume would, so small files need no further reads. */
+static int32_t
+ec_lookup_content_rebuild (ec_t *ec, ec_cbk_data_t *cbk, uint64_t fsize,
+                           uint64_t size)
+{
+    void *blocks[ec->fragments];
+    uint32_t values[ec->fragments];
+    int32_t idx[ec->fragments];
+    data_t *data[ec->fragments];
+    ec_cbk_data_t *ans = NULL;
+    struct iobref *iobref = NULL;
+    uintptr_t mask = 0;
+    void *ptr = NULL;
+    char *content = NULL;
+    uint32_t count = 0;
+    int32_t pos, i, err = -EIO;
+
+    if ((fsize == 0) || (fsize % EC_METHOD_CHUNK_SIZE != 0) ||
+        (size > fsize * ec->fragments)) {
+        goto out;
+    }
+
+    for (ans = cbk; (ans != NULL) && (count < ec->fragments);
+         ans = ans->next) {
+        if (ans->xdata == NULL) {
+            continue;
+        }
+        data[count] = dict_get (ans->xdata, GF_CONTENT_KEY);
+        if ((data[count] == NULL) || (data[count]->len != fsize)) {
+            continue;
+        }
+        idx[count++] = ans->idx;
+        mask |= 1ULL << ans->idx;
+    }
+    if (count < ec->fragments) {
+        goto out;
+    }
+
+    err = ec_buffer_alloc (ec->xl, 2 * fsize * ec->fragments, &iobref,
+                           &ptr);
+    if (err != 0) {
+        goto out;
+    }
+
+    /* The decoder wants the fragments ordered by brick and aligned. */
+    for (i = 0; i < count; i++) {
+        pos = gf_bits_count (mask & ((1ULL << idx[i]) - 1));
+        values[pos] = idx[i] + 1;
+        blocks[pos] = ptr + pos * fsize;
+        memcpy (blocks[pos], data[i]->data, fsize);
+    }
+
+    ptr += fsize * ec->fragments;
+    err = ec_method_decode (&ec->matrix, fsize, mask, values, blocks, ptr);
+    if (err != 0) {
+        goto out;
+    }
+
+    err = -ENOMEM;
+    content = GF_MALLOC (size ? size : 1, gf_common_mt_char);
+    if (content == NULL) {
+        goto out;
+    }
+    memcpy (content, ptr, size);
+
+    err = dict_set_bin (cbk->xdata, GF_CONTENT_KEY, content, size);
+    if (err != 0) {
+        GF_FREE (content);
+    }
+
+out:
+    if (iobref != NULL) {
+        iobref_unref (iobref);
+    }
+
+    return err;
+}
+
 void ec_lookup_rebuild(ec_t * ec, ec_fop_data_t * fop, ec_cbk_data_t * cbk)
 {
     ec_inode_t * ctx = NULL;
     uint64_t size = 0;
-    int32_t have_size = 0, err;
+    uint64_t version[EC_VERSION_SIZE] = {0, 0};
+    int32_t have_size = 0, have_version = 0, err;
 
     if (cbk->op_ret < 0) {
         return;
@@ -653,6 +735,9 @@ void ec_lookup_rebuild(ec_t * ec, ec_fop_data_t * fop, ec_cbk_data_t * cbk)
     if (ctx != NULL)
     {
         if (ctx->have_version) {
+            version[0] = cbk->version[0];
+            version[1] = cbk->version[1];
+            have_version = 1;
             cbk->version[0] = ctx->post_version[0];
             cbk->version[1] = ctx->post_version[1];
         }
@@ -673,6 +758,20 @@ void ec_lookup_rebuild(ec_t * ec, ec_fop_data_t * fop, ec_cbk_data_t * cbk)
             cbk->iatt[0].ia_size = size;
         }
     }
+
+    if ((cbk->xdata == NULL) || !dict_get(cbk->xdata, GF_CONTENT_KEY)) {
+        return;
+    }
+
+    /* Fragments read from disk are only meaningful if nothing newer is
+     * pending on the inode from this client. */
+    if ((cbk->iatt[0].ia_type != IA_IFREG) ||
+        (have_version && ((version[0] != cbk->version[0]) ||
+                          (version[1] != cbk->version[1]))) ||
+        (ec_lookup_content_rebuild(ec, cbk, cbk->size,
+                                   cbk->iatt[0].ia_size) != 0)) {
+        dict_del(cbk->xdata, GF_CONTENT_KEY);
+    }
 }
 
 int32_t ec_combine_lookup(ec_fop_data_t * fop, ec_cbk_data_t * dst,
@@ -790,9 +889,6 @@ int32_t ec_manager_lookup(ec_fop_data_t * fop, int32_t state)
 
                     return EC_STATE_REPORT;
                 }
-            } else {
-                /*TODO: To be handled once we have 'syndromes' */
-                dict_del (fop->xdata, GF_CONTENT_KEY);
             }
             err = dict_set_uint64(fop->xdata, EC_XATTR_SIZE, 0);
             if (err == 0) {
@@ -0,0 +1,624 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <pthread.h>
+
+#include "glusterfs.h"
+#include "logging.h"
+#include "common-utils.h"
+#include "byte-order.h"
+
+#include "bit-rot-merkle.h"
+#include "bit-rot-bitd-messages.h"
+
+#define BR_CHUNK_BIT(i)  (1ULL << (i))
+
+/**
+ * Chunks of an object to be hashed. The thread signing or scrubbing the
+ * object hashes chunks along with the helpers and returns once the last
+ * chunk is done, so the job lives on its stack.
+ */
+typedef struct br_hash_job {
+        struct list_head  list;         /* on hasher->jobs while there are
+                                           chunks to hand out */
+        xlator_t         *this;
+        br_child_t       *child;
+        fd_t             *fd;
+        pid_t             pid;
+
+        uint64_t          size;
+        uint8_t           chunkshift;
+        int               nchunks;
+        br_digest_t      *digests;      /* filled in, or to be matched
+                                           when verifying */
+        gf_boolean_t      verify;
+
+        uint64_t          skip;         /* chunks to leave alone */
+        uint64_t          done;         /* chunks hashed (and matched) */
+        int               next;         /* next chunk to hand out */
+        int               busy;         /* chunks being hashed */
+
+        int32_t           ret;
+        int32_t           bad;          /* first chunk found to not match */
+        gf_boolean_t      abort;        /* hand out no more chunks */
+        gf_boolean_t      finished;
+
+        /* verified chunks are noted here when a scrub is interrupted */
+        inode_t          *inode;
+        unsigned long     version;
+
+        pthread_cond_t    cond;         /* last busy chunk is done */
+} br_hash_job_t;
+
+struct br_hash_chunk_ctx {
+        br_hash_job_t *job;
+        int            chunk;
+};
+
+static int
+br_merkle_nchunks (uint64_t size, uint8_t chunkshift)
+{
+        return (size >> chunkshift)
+                + ((size & (BR_CHUNK_BIT (chunkshift) - 1)) ? 1 : 0);
+}
+
+static int
+br_merkle_geometry (uint64_t size, uint64_t minchunk, uint8_t *chunkshift)
+{
+        uint8_t shift = 0;
+
+        while (BR_CHUNK_BIT (shift) < minchunk)
+                shift++;
+        while (br_merkle_nchunks (size, shift) > BR_MERKLE_MAX_CHUNKS)
+                shift++;
+
+        *chunkshift = shift;
+        return br_merkle_nchunks (size, shift);
+}
+
+static void
+br_merkle_root (br_merkle_signature_t *sign, br_digest_t root)
+{
+        SHA256_CTX sha256;
+
+        SHA256_Init (&sha256);
+        SHA256_Update (&sha256, (const unsigned char *) sign,
+                       offsetof (br_merkle_signature_t, root));
+        SHA256_Update (&sha256, (const unsigned char *) sign->chunks,
+                       sign->nchunks * sizeof (br_digest_t));
+        SHA256_Final (root, &sha256);
+}
+
+static gf_boolean_t
+br_merkle_signature_valid (br_merkle_signature_t *sign, size_t signlen)
+{
+        br_digest_t root = {0,};
+
+        if (signlen < sizeof (*sign))
+                return _gf_false;
+        if ((sign->chunkshift >= 64)
+            || (sign->nchunks > BR_MERKLE_MAX_CHUNKS)
+            || (signlen != br_merkle_signature_len (sign->nchunks)))
+                return _gf_false;
+        if (br_merkle_nchunks (ntoh64 (sign->size), sign->chunkshift)
+            != sign->nchunks)
+                return _gf_false;
+
+        br_merkle_root (sign, root);
+
+        return (memcmp (root, sign->root, sizeof (root)) == 0);
+}
+
+static void
+_br_hasher_unlock (void *arg)
+{
+        pthread_mutex_unlock (arg);
+}
+
+static int
+__br_hash_job_next (br_hash_job_t *job)
+{
+        while ((job->next < job->nchunks)
+               && (job->skip & BR_CHUNK_BIT (job->next)))
+                job->next++;
+
+        if (job->abort || (job->next >= job->nchunks))
+                return -1;
+
+        job->busy++;
+        return job->next++;
+}
+
+static void
+__br_hash_job_done (br_hash_job_t *job,
+                    int chunk, int32_t ret, br_digest_t digest)
+{
+        job->busy--;
+
+        if (ret < 0) {
+                job->ret = -1;
+                job->abort = _gf_true;
+        } else if (!job->verify) {
+                memcpy (job->digests[chunk], digest, sizeof (br_digest_t));
+                job->done |= BR_CHUNK_BIT (chunk);
+        } else if (memcmp (job->digests[chunk], digest,
+                           sizeof (br_digest_t)) == 0) {
+                job->done |= BR_CHUNK_BIT (chunk);
+        } else {
+                if ((job->bad < 0) || (chunk < job->bad))
+                        job->bad = chunk;
+                job->abort = _gf_true;
+        }
+
+        if (job->busy == 0)
+                pthread_cond_signal (&job->cond);
+}
+
+static void
+br_hash_chunk_abandon (void *arg)
+{
+        struct br_hash_chunk_ctx *cctx   = arg;
+        br_private_t             *priv   = NULL;
+        struct br_hasher         *hasher = NULL;
+
+        priv = cctx->job->this->private;
+        hasher = &priv->hasher;
+
+        pthread_mutex_lock (&hasher->lock);
+        {
+                __br_hash_job_done (cctx->job, cctx->chunk, -1, NULL);
+        }
+        pthread_mutex_unlock (&hasher->lock);
+}
+
+/**
+ * Hash a chunk block by block. Called with cancellation masked, so that
+ * the job is let go of at the block boundaries only (see br_hash_chunk_
+ * abandon()), and the threads do not get stuck behind a chunk of several
+ * GBs when the job is aborted.
+ */
+static int32_t
+br_hash_chunk (br_hash_job_t *job, int chunk, br_digest_t digest,
+               gf_boolean_t cancellable)
+{
+        int32_t                  ret    = 0;
+        uint64_t                 offset = 0;
+        uint64_t                 end    = 0;
+        struct br_hash_chunk_ctx cctx   = {0,};
+        SHA256_CTX               sha256;
+
+        offset = (uint64_t) chunk << job->chunkshift;
+        end = min (offset + BR_CHUNK_BIT (job->chunkshift), job->size);
+
+        cctx.job = job;
+        cctx.chunk = chunk;
+
+        SHA256_Init (&sha256);
+
+        pthread_cleanup_push (br_hash_chunk_abandon, &cctx);
+        while (offset < end) {
+                if (cancellable) {
+                        _unmask_cancellation ();
+                        pthread_testcancel ();
+                        _mask_cancellation ();
+                }
+
+                if (job->abort) {
+                        ret = -1;
+                        break;
+                }
+
+                ret = br_object_read_block_and_sign
+                        (job->this, job->fd, job->child, offset,
+                         min (end - offset, BR_HASH_CALC_READ_SIZE), &sha256);
+                if (ret < 0) {
+                        gf_msg (job->this->name, GF_LOG_ERROR, 0,
+                                BRB_MSG_BLOCK_READ_FAILED, "reading block "
+                                "with offset %"PRIu64" of object %s failed",
+                                offset, uuid_utoa (job->fd->inode->gfid));
+                        break;
+                }
+
+                /* object is shorter than signed, which won't match */
+                if (ret == 0)
+                        break;
+
+                offset += ret;
+        }
+        pthread_cleanup_pop (0);
+
+        if (ret < 0)
+                return -1;
+
+        SHA256_Final (digest, &sha256);
+        return 0;
+}
+
+static void *
+br_hasher_proc (void *arg)
+{
+        int32_t                  ret    = 0;
+        int                      chunk  = 0;
+        xlator_t                *this   = NULL;
+        br_private_t            *priv   = NULL;
+        struct br_hasher        *hasher = NULL;
+        struct br_hasher_thread *helper = NULL;
+        br_hash_job_t           *job    = NULL;
+        br_digest_t              digest = {0,};
+
+        helper = arg;
+        THIS = this = helper->this;
+        priv = this->private;
+        hasher = &priv->hasher;
+
+        _mask_cancellation ();
+
+        pthread_mutex_lock (&hasher->lock);
+        for (;;) {
+                /* the thread asking for a job to be done is the first */
+                if (helper->id + 1 >= hasher->nthreads)
+                        break;
+
+                if (list_empty (&hasher->jobs)) {
+                        pthread_cleanup_push (_br_hasher_unlock,
+                                              &hasher->lock);
+                        _unmask_cancellation ();
+                        pthread_cond_wait (&hasher->cond, &hasher->lock);
+                        _mask_cancellation ();
+                        pthread_cleanup_pop (0);
+                        continue;
+                }
+
+                job = list_first_entry (&hasher->jobs, br_hash_job_t, list);
+                chunk = __br_hash_job_next (job);
+                if (chunk < 0) {
+                        list_del_init (&job->list);
+                        continue;
+                }
+                pthread_mutex_unlock (&hasher->lock);
+
+                syncopctx_setfspid (&job->pid);
+                ret = br_hash_chunk (job, chunk, digest, _gf_true);
+
+                pthread_mutex_lock (&hasher->lock);
+                __br_hash_job_done (job, chunk, ret, digest);
+        }
+        helper->alive = _gf_false;
+        pthread_mutex_unlock (&hasher->lock);
+
+        return NULL;
+}
+
+static void
+__br_hasher_spawn (xlator_t *this, struct br_hasher *hasher)
+{
+        int                      i      = 0;
+        int32_t                  ret    = 0;
+        struct br_hasher_thread *helper = NULL;
+
+        for (i = 0; i + 1 < hasher->nthreads; i++) {
+                helper = &hasher->helpers[i];
+                if (helper->alive)
+                        continue;
+
+                /* exited after "hash-threads" was turned down */
+                if (helper->started) {
+                        pthread_join (helper->thread, NULL);
+                        helper->started = _gf_false;
+                }
+
+                helper->id = i;
+                helper->this = this;
+                ret = gf_thread_create (&helper->thread, NULL,
+                                        br_hasher_proc, helper);
+                if (ret) {
+                        gf_msg (this->name, GF_LOG_WARNING, 0,
+                                BRB_MSG_SPAWN_FAILED, "could not spawn a "
+                                "hashing thread, running with %d", i + 1);
+                        break;
+                }
+
+                helper->started = helper->alive = _gf_true;
+        }
+}
+
+static void
+br_hash_job_finish (void *arg)
+{
+        uint64_t          version  = 0;
+        uint64_t          verified = 0;
+        br_hash_job_t    *job      = arg;
+        br_private_t     *priv     = NULL;
+        struct br_hasher *hasher   = NULL;
+
+        priv = job->this->private;
+        hasher = &priv->hasher;
+
+        pthread_mutex_lock (&hasher->lock);
+        {
+                if (!job->finished)
+                        job->abort = _gf_true;
+                list_del_init (&job->list);
+
+                while (job->busy)
+                        pthread_cond_wait (&job->cond, &hasher->lock);
+        }
+        pthread_mutex_unlock (&hasher->lock);
+
+        pthread_cond_destroy (&job->cond);
+
+        /* let the scrub pick up from here once the object is requeued */
+        if (!job->finished && job->inode) {
+                version = job->version;
+                verified = job->done | job->skip;
+                (void) inode_ctx_set2 (job->inode, job->this,
+                                       &version, &verified);
+        }
+}
+
+static int32_t
+br_hash_job_run (xlator_t *this, br_hash_job_t *job)
+{
+        int32_t           ret      = 0;
+        int               chunk    = 0;
+        int               oldstate = 0;
+        br_private_t     *priv     = NULL;
+        struct br_hasher *hasher   = NULL;
+        br_digest_t       digest   = {0,};
+
+        priv = this->private;
+        hasher = &priv->hasher;
+
+        job->bad = -1;
+        INIT_LIST_HEAD (&job->list);
+        pthread_cond_init (&job->cond, NULL);
+
+        (void) pthread_setcancelstate (PTHREAD_CANCEL_DISABLE, &oldstate);
+
+        pthread_mutex_lock (&hasher->lock);
+        {
+                if ((hasher->nthreads > 1) && (job->nchunks > 1)) {
+                        list_add_tail (&job->list, &hasher->jobs);
+                        __br_hasher_spawn (this, hasher);
+                        pthread_cond_broadcast (&hasher->cond);
+                }
+        }
+        pthread_mutex_unlock (&hasher->lock);
+
+        pthread_cleanup_push (br_hash_job_finish, job);
+        for (;;) {
+                pthread_mutex_lock (&hasher->lock);
+                {
+                        chunk = __br_hash_job_next (job);
+                }
+                pthread_mutex_unlock (&hasher->lock);
+
+                if (chunk < 0)
+                        break;
+
+                ret = br_hash_chunk (job, chunk, digest,
+                                     (oldstate == PTHREAD_CANCEL_ENABLE));
+
+                pthread_mutex_lock (&hasher->lock);
+                {
+                        __br_hash_job_done (job, chunk, ret, digest);
+                }
+                pthread_mutex_unlock (&hasher->lock);
+        }
+        job->finished = _gf_true;
+        pthread_cleanup_pop (1);
+
+        (void) pthread_setcancelstate (oldstate, NULL);
+
+        return job->ret;
+}
+
+/**
+ * Sign an object of @size bytes in chunks. If @prev is the chunked
+ * signature the stub laid down last, and @dirty the range modified since,
+ * chunks outside of it are not read again.
+ */
+int32_t
+br_merkle_sign (xlator_t *this, br_child_t *child, fd_t *fd, pid_t pid,
+                uint64_t size, br_merkle_signature_t *prev, size_t prevlen,
+                br_dirty_range_t *dirty, br_merkle_signature_t **signature,
+                size_t *signaturelen)
+{
+        int32_t                ret      = -1;
+        int                    i        = 0;
+        int                    nchunks  = 0;
+        int                    rehashed = 0;
+        uint8_t                shift    = 0;
+        uint64_t               start    = 0;
+        uint64_t               end      = 0;
+        uint64_t               prevsize = 0;
+        size_t                 len      = 0;
+        br_private_t          *priv     = NULL;
+        br_merkle_signature_t *sign     = NULL;
+        br_hash_job_t          job      = {{0,},};
+
+        priv = this->private;
+
+        nchunks = br_merkle_geometry (size, priv->chunk_size, &shift);
+        len = br_merkle_signature_len (nchunks);
+
+        sign = GF_CALLOC (1, len, gf_br_stub_mt_signature_t);
+        if (!sign)
+                goto out;
+
+        sign->chunkshift = shift;
+        sign->nchunks = nchunks;
+        sign->size = hton64 (size);
+
+        if (prev && dirty && (prev->chunkshift == shift)
+            && br_merkle_signature_valid (prev, prevlen)) {
+                prevsize = ntoh64 (prev->size);
+
+                for (i = 0; (i < nchunks) && (i < prev->nchunks); i++) {
+                        start = (uint64_t) i << shift;
+                        end = start + BR_CHUNK_BIT (shift);
+
+                        /* grown or shrunk into this chunk */
+                        if (min (end, size) != min (end, prevsize))
+                                continue;
+                        if ((dirty->start < dirty->end)
+                            && (dirty->start < end) && (start < dirty->end))
+                                continue;
+
+                        memcpy (sign->chunks[i], prev->chunks[i],
+                                sizeof (br_digest_t));
+                        job.skip |= BR_CHUNK_BIT (i);
+                }
+        }
+
+        job.this = this;
+        job.child = child;
+        job.fd = fd;
+        job.pid = pid;
+        job.size = size;
+        job.chunkshift = shift;
+        job.nchunks = nchunks;
+        job.digests = sign->chunks;
+
+        ret = br_hash_job_run (this, &job);
+        if (ret) {
+                GF_FREE (sign);
+                goto out;
+        }
+
+        br_merkle_root (sign, sign->root);
+
+        for (i = 0; i < nchunks; i++)
+                rehashed += (job.done & BR_CHUNK_BIT (i)) ? 1 : 0;
+        gf_msg_debug (this->name, 0, "hashed %d of %d chunk(s) of object %s",
+                      rehashed, nchunks, uuid_utoa (fd->inode->gfid));
+
+        *signature = sign;
+        *signaturelen = len;
+
+ out:
+        return ret;
+}
+
+/**
+ * Verify an object of @size bytes against its chunked signature of version
+ * @version. Returns 0 if it matches, 1 if it does not, with the first chunk
+ * not matching in @badchunk (-1 if the signature itself is damaged, the
+ * number of chunks if the object is not of the signed size), and -1 on
+ * errors.
+ */
+int32_t
+br_merkle_verify (xlator_t *this, br_child_t *child, fd_t *fd, pid_t pid,
+                  unsigned long version, uint64_t size,
+                  br_merkle_signature_t *sign, size_t signlen,
+                  int32_t *badchunk)
+{
+        int32_t       ret        = 0;
+        uint64_t      ctxversion = 0;
+        uint64_t      verified   = 0;
+        br_hash_job_t job        = {{0,},};
+
+        if (!br_merkle_signature_valid (sign, signlen)) {
+                *badchunk = -1;
+                return 1;
+        }
+
+        if (ntoh64 (sign->size) != size) {
+                *badchunk = sign->nchunks;
+                return 1;
+        }
+
+        job.this = this;
+        job.child = child;
+        job.fd = fd;
+        job.pid = pid;
+        job.size = size;
+        job.chunkshift = sign->chunkshift;
+        job.nchunks = sign->nchunks;
+        job.digests = sign->chunks;
+        job.verify = _gf_true;
+        job.inode = fd->inode;
+        job.version = version;
+
+        ret = inode_ctx_get2 (fd->inode, this, &ctxversion, &verified);
+        if (!ret && (ctxversion == version)) {
+                job.skip = verified;
+                gf_msg_debug (this->name, 0, "resuming scrub of object %s",
+                              uuid_utoa (fd->inode->gfid));
+        }
+
+        ret = br_hash_job_run (this, &job);
+        (void) inode_ctx_del2 (fd->inode, this, NULL, NULL);
+        if (ret)
+                return -1;
+
+        if (job.bad >= 0) {
+                *badchunk = job.bad;
+                return 1;
+        }
+
+        return 0;
+}
+
+int32_t
+br_hasher_handle_options (xlator_t *this, br_private_t *priv, dict_t *options)
+{
+        int32_t nthreads = 0;
+
+        if (options)
+                GF_OPTION_RECONF ("hash-threads", nthreads,
+                                  options, int32, error_return);
+        else
+                GF_OPTION_INIT ("hash-threads", nthreads,
+                                int32, error_return);
+
+        pthread_mutex_lock (&priv->hasher.lock);
+        {
+                priv->hasher.nthreads = nthreads;
+
+                /* let the helpers beyond that go */
+                pthread_cond_broadcast (&priv->hasher.cond);
+        }
+        pthread_mutex_unlock (&priv->hasher.lock);
+
+        return 0;
+
+ error_return:
+        return -1;
+}
+
+int32_t
+br_hasher_init (xlator_t *this, br_private_t *priv)
+{
+        struct br_hasher *hasher = &priv->hasher;
+
+        pthread_mutex_init (&hasher->lock, NULL);
+        pthread_cond_init (&hasher->cond, NULL);
+        INIT_LIST_HEAD (&hasher->jobs);
+
+        /* helpers are spawned along with the first job */
+        return br_hasher_handle_options (this, priv, NULL);
+}
+
+void
+br_hasher_fini (xlator_t *this, br_private_t *priv)
+{
+        int               i      = 0;
+        struct br_hasher *hasher = &priv->hasher;
+
+        for (i = 0; i < BR_HASH_THREADS_MAX - 1; i++) {
+                if (hasher->helpers[i].started)
+                        (void) gf_thread_cleanup_xint
+                                                (hasher->helpers[i].thread);
+        }
+
+        pthread_cond_destroy (&hasher->cond);
+        pthread_mutex_destroy (&hasher->lock);
+}
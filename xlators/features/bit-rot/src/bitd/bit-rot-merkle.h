@@ -0,0 +1,63 @@
+/*
+   Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef __BIT_ROT_MERKLE_H__
+#define __BIT_ROT_MERKLE_H__
+
+#include "xlator.h"
+#include "bit-rot.h"
+
+/**
+ * Chunked (BR_SIGNATURE_TYPE_SHA256_MERKLE) signature: the object is cut in
+ * chunks of 2^chunkshift bytes, each hashed on its own, and root is the hash
+ * of the header and of all the chunk hashes, i.e. a Merkle tree of depth
+ * two. Chunks are hashed in parallel, scrubbed one by one (and a scrub
+ * picks up from the chunks it verified last time it got interrupted) and
+ * only those modified since the last signature are hashed again. root lets
+ * a damaged signature be told apart from a damaged object.
+ *
+ * The chunk size doubles as needed to keep to BR_MERKLE_MAX_CHUNKS chunks,
+ * which keeps the signature xattr around 2KB.
+ */
+#define BR_MERKLE_MAX_CHUNKS  64
+#define BR_MERKLE_MIN_CHUNK   BR_HASH_CALC_READ_SIZE
+
+typedef unsigned char br_digest_t[SHA256_DIGEST_LENGTH];
+
+typedef struct __attribute__ ((__packed__)) br_merkle_signature {
+        uint8_t     chunkshift;
+        uint8_t     nchunks;
+        uint64_t    size;             /* object size, network byte order */
+        br_digest_t root;
+        br_digest_t chunks[0];
+} br_merkle_signature_t;
+
+#define br_merkle_signature_len(n) \
+        (sizeof (br_merkle_signature_t) + (n) * sizeof (br_digest_t))
+
+int32_t
+br_hasher_init (xlator_t *, br_private_t *);
+
+void
+br_hasher_fini (xlator_t *, br_private_t *);
+
+int32_t
+br_hasher_handle_options (xlator_t *, br_private_t *, dict_t *);
+
+int32_t
+br_merkle_sign (xlator_t *, br_child_t *, fd_t *, pid_t, uint64_t,
+                br_merkle_signature_t *, size_t, br_dirty_range_t *,
+                br_merkle_signature_t **, size_t *);
+
+int32_t
+br_merkle_verify (xlator_t *, br_child_t *, fd_t *, pid_t, unsigned long,
+                  uint64_t, br_merkle_signature_t *, size_t, int32_t *);
+
+#endif /* __BIT_ROT_MERKLE_H__ */
@@ -17,6 +17,7 @@
 #include "common-utils.h"
 
 #include "bit-rot-scrub.h"
+#include "bit-rot-merkle.h"
 #include <pthread.h>
 #include "bit-rot-bitd-messages.h"
 #include "bit-rot-scrub-status.h"
@@ -144,6 +145,7 @@ static int32_t
 bitd_signature_staleness (xlator_t *this,
                           br_child_t *child, fd_t *fd,
                           int *stale, unsigned long *version,
+                          int8_t *signaturetype,
                           br_scrub_stats_t *scrub_stat, gf_boolean_t skip_stat)
 {
         int32_t ret = -1;
@@ -163,6 +165,7 @@ bitd_signature_staleness (xlator_t *this,
          */
         *stale = signptr->stale ? 1 : 0;
         *version = signptr->version;
+        *signaturetype = signptr->signaturetype;
 
         dict_unref (xattr);
 
@@ -181,6 +184,7 @@ bitd_signature_staleness (xlator_t *this,
 int32_t
 bitd_scrub_pre_compute_check (xlator_t *this, br_child_t *child,
                               fd_t *fd, unsigned long *version,
+                              int8_t *signaturetype,
                               br_scrub_stats_t *scrub_stat,
                               gf_boolean_t skip_stat)
 {
@@ -195,7 +199,7 @@ bitd_scrub_pre_compute_check (xlator_t *this, br_child_t *child,
         }
 
         ret = bitd_signature_staleness (this, child, fd, &stale, version,
-                                        scrub_stat, skip_stat);
+                                        signaturetype, scrub_stat, skip_stat);
         if (!ret && stale) {
                 if (!skip_stat)
                         br_inc_unsigned_file_count (scrub_stat);
@@ -209,6 +213,43 @@ bitd_scrub_pre_compute_check (xlator_t *this, br_child_t *child,
         return ret;
 }
 
+static int
+bitd_mark_bad_object (xlator_t *this, inode_t *linked_inode,
+                      fd_t *fd, br_child_t *child, loc_t *loc)
+{
+        int     ret   = -1;
+        dict_t *xattr = NULL;
+
+        xattr = dict_new ();
+        if (!xattr)
+                goto out;
+
+        ret = dict_set_int32 (xattr, BITROT_OBJECT_BAD_KEY, _gf_true);
+        if (ret) {
+                gf_msg (this->name, GF_LOG_ERROR, 0, BRB_MSG_MARK_BAD_FILE,
+                        "Error setting bad-file marker for %s [GFID: %s | "
+                        "Brick: %s]", loc->path, uuid_utoa (linked_inode->gfid),
+                        child->brick_path);
+                goto dictfree;
+        }
+
+        gf_msg (this->name, GF_LOG_ALERT, 0, BRB_MSG_MARK_CORRUPTED, "Marking"
+                " %s [GFID: %s | Brick: %s] as corrupted..", loc->path,
+                uuid_utoa (linked_inode->gfid), child->brick_path);
+        gf_event (EVENT_BITROT_BAD_FILE, "gfid=%s;path=%s;brick=%s",
+                  uuid_utoa (linked_inode->gfid), loc->path, child->brick_path);
+        ret = syncop_fsetxattr (child->xl, fd, xattr, 0, NULL, NULL);
+        if (ret)
+                gf_msg (this->name, GF_LOG_ERROR, 0, BRB_MSG_MARK_BAD_FILE,
+                        "Error marking object %s [GFID: %s] as corrupted",
+                        loc->path, uuid_utoa (linked_inode->gfid));
+
+ dictfree:
+        dict_unref (xattr);
+ out:
+        return ret;
+}
+
 /* static int */
 int
 bitd_compare_ckum (xlator_t *this,
@@ -217,7 +258,6 @@ bitd_compare_ckum (xlator_t *this,
                    gf_dirent_t *entry, fd_t *fd, br_child_t *child, loc_t *loc)
 {
         int   ret = -1;
-        dict_t *xattr = NULL;
 
         GF_VALIDATE_OR_GOTO ("bit-rot", this, out);
         GF_VALIDATE_OR_GOTO (this->name, sign, out);
@@ -243,35 +283,96 @@ bitd_compare_ckum (xlator_t *this,
                 "CORRUPTION DETECTED: Object %s {Brick: %s | GFID: %s}",
                 loc->path, child->brick_path, uuid_utoa (linked_inode->gfid));
 
-        /* Perform bad-file marking */
-        xattr = dict_new ();
-        if (!xattr) {
-                ret = -1;
+        ret = bitd_mark_bad_object (this, linked_inode, fd, child, loc);
+ out:
+        return ret;
+}
+
+/**
+ * Verify an object signed in chunks (c.f. bit-rot-merkle.h). Unlike the
+ * whole object checksum, chunks are compared as they get hashed and the
+ * first one not matching stops the scrub of the object.
+ */
+static int
+bitd_scrub_merkle (xlator_t *this, br_child_t *child, fd_t *fd,
+                   struct iatt *iatt, unsigned long signedversion,
+                   inode_t *linked_inode, loc_t *loc, gf_boolean_t skip_stat)
+{
+        int32_t              ret      = -1;
+        int32_t              badchunk = 0;
+        br_private_t        *priv     = NULL;
+        br_isignature_out_t *sign     = NULL;
+        br_isignature_out_t *check    = NULL;
+        br_merkle_signature_t *msign  = NULL;
+
+        priv = this->private;
+
+        /* chunks are compared as they are hashed, so fetch it upfront.. */
+        ret = bitd_scrub_post_compute_check (this, child, fd, signedversion,
+                                             &sign, &priv->scrub_stat,
+                                             skip_stat);
+        if (ret)
                 goto out;
+
+        msign = (br_merkle_signature_t *) sign->signature;
+        ret = br_merkle_verify (this, child, fd, GF_CLIENT_PID_SCRUB,
+                                signedversion, iatt->ia_size, msign,
+                                sign->signaturelen, &badchunk);
+        if (ret < 0) {
+                gf_msg (this->name, GF_LOG_ERROR, 0, BRB_MSG_CALC_ERROR,
+                        "error calculating hash for object [GFID: %s]",
+                        uuid_utoa (fd->inode->gfid));
+                goto free_sign;
         }
 
-        ret = dict_set_int32 (xattr, BITROT_OBJECT_BAD_KEY, _gf_true);
+        /* ..and make sure it still holds now that they are */
+        if (bitd_scrub_post_compute_check (this, child, fd, signedversion,
+                                           &check, &priv->scrub_stat,
+                                           skip_stat)) {
+                ret = -1;
+                goto free_sign;
+        }
+        GF_FREE (check);
+
         if (ret) {
-                gf_msg (this->name, GF_LOG_ERROR, 0, BRB_MSG_MARK_BAD_FILE,
-                        "Error setting bad-file marker for %s [GFID: %s | "
-                        "Brick: %s]", loc->path, uuid_utoa (linked_inode->gfid),
-                        child->brick_path);
-                goto dictfree;
+                if (badchunk < 0)
+                        gf_msg (this->name, GF_LOG_ALERT, 0,
+                                BRB_MSG_SIGNATURE_DAMAGED, "CORRUPTION "
+                                "DETECTED: signature of object %s is damaged "
+                                "{Brick: %s | GFID: %s}", loc->path,
+                                child->brick_path,
+                                uuid_utoa (linked_inode->gfid));
+                else if (badchunk >= msign->nchunks)
+                        gf_msg (this->name, GF_LOG_ALERT, 0,
+                                BRB_MSG_CHECKSUM_MISMATCH, "CORRUPTION "
+                                "DETECTED: Object %s is not of its signed "
+                                "size {Brick: %s | GFID: %s}", loc->path,
+                                child->brick_path,
+                                uuid_utoa (linked_inode->gfid));
+                else
+                        gf_msg (this->name, GF_LOG_ALERT, 0,
+                                BRB_MSG_CHUNK_MISMATCH, "CORRUPTION "
+                                "DETECTED: Object %s, chunk %d at offset "
+                                "%"PRIu64" {Brick: %s | GFID: %s}", loc->path,
+                                badchunk,
+                                (uint64_t) badchunk << msign->chunkshift,
+                                child->brick_path,
+                                uuid_utoa (linked_inode->gfid));
+
+                ret = bitd_mark_bad_object (this, linked_inode, fd, child,
+                                            loc);
+        } else {
+                gf_msg_debug (this->name, 0, "%s [GFID: %s | Brick: %s] "
+                              "matches its chunked signature", loc->path,
+                              uuid_utoa (linked_inode->gfid),
+                              child->brick_path);
         }
 
-        gf_msg (this->name, GF_LOG_ALERT, 0, BRB_MSG_MARK_CORRUPTED, "Marking"
-                " %s [GFID: %s | Brick: %s] as corrupted..", loc->path,
-                uuid_utoa (linked_inode->gfid), child->brick_path);
-        gf_event (EVENT_BITROT_BAD_FILE, "gfid=%s;path=%s;brick=%s",
-                  uuid_utoa (linked_inode->gfid), loc->path, child->brick_path);
-        ret = syncop_fsetxattr (child->xl, fd, xattr, 0, NULL, NULL);
-        if (ret)
-                gf_msg (this->name, GF_LOG_ERROR, 0, BRB_MSG_MARK_BAD_FILE,
-                        "Error marking object %s [GFID: %s] as corrupted",
-                        loc->path, uuid_utoa (linked_inode->gfid));
+        if (!skip_stat)
+                br_inc_scrubbed_file (&priv->scrub_stat);
 
- dictfree:
-        dict_unref (xattr);
+ free_sign:
+        GF_FREE (sign);
  out:
         return ret;
 }
@@ -297,6 +398,7 @@ br_scrubber_scrub_begin (xlator_t *this, struct br_fsscan_entry *fsentry)
         inode_t               *linked_inode  = NULL;
         br_isignature_out_t   *sign          = NULL;
         unsigned long          signedversion = 0;
+        int8_t                 signaturetype = BR_SIGNATURE_TYPE_VOID;
         gf_dirent_t           *entry         = NULL;
         br_private_t          *priv          = NULL;
         loc_t                 *parent        = NULL;
@@ -384,10 +486,18 @@ br_scrubber_scrub_begin (xlator_t *this, struct br_fsscan_entry *fsentry)
          *  - signature staleness
          */
         ret = bitd_scrub_pre_compute_check (this, child, fd, &signedversion,
+                                            &signaturetype,
                                             &priv->scrub_stat, skip_stat);
         if (ret)
                 goto unrefd; /* skip this object */
 
+        if (signaturetype == BR_SIGNATURE_TYPE_SHA256_MERKLE) {
+                ret = bitd_scrub_merkle (this, child, fd, &iatt,
+                                         signedversion, linked_inode, &loc,
+                                         skip_stat);
+                goto unrefd;
+        }
+
         /* if all's good, proceed to calculate the hash */
         md = GF_CALLOC (SHA256_DIGEST_LENGTH, sizeof (*md),
                         gf_common_mt_char);
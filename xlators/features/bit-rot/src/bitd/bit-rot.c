@@ -18,13 +18,12 @@
 
 #include "bit-rot.h"
 #include "bit-rot-scrub.h"
+#include "bit-rot-merkle.h"
 #include <pthread.h>
 #include "bit-rot-bitd-messages.h"
 
 #include "tw.h"
 
-#define BR_HASH_CALC_READ_SIZE  (128 * 1024)
-
 typedef int32_t (br_child_handler)(xlator_t *, br_child_t *);
 
 struct br_child_event {
@@ -273,7 +272,7 @@ out:
  * read 128k block from the object @object from the offset @offset
  * and return the buffer.
  */
-static int32_t
+int32_t
 br_object_read_block_and_sign (xlator_t *this, fd_t *fd, br_child_t *child,
                                off_t offset, size_t size, SHA256_CTX *sha256)
 {
@@ -380,50 +379,25 @@ br_object_checksum (unsigned char *md,
 }
 
 static int32_t
-br_object_read_sign (inode_t *linked_inode, fd_t *fd, br_object_t *object,
-                     struct iatt *iatt)
+br_object_set_signature (xlator_t *this, br_object_t *object, fd_t *fd,
+                         const unsigned char *md, unsigned long len,
+                         int8_t type)
 {
-        int32_t          ret           = -1;
-        xlator_t        *this          = NULL;
-        dict_t          *xattr         = NULL;
-        unsigned char   *md            = NULL;
-        br_isignature_t *sign          = NULL;
-
-        GF_VALIDATE_OR_GOTO ("bit-rot", object, out);
-        GF_VALIDATE_OR_GOTO ("bit-rot", linked_inode, out);
-        GF_VALIDATE_OR_GOTO ("bit-rot", fd, out);
-
-        this = object->this;
+        int32_t          ret   = -1;
+        dict_t          *xattr = NULL;
+        br_isignature_t *sign  = NULL;
 
-        md = GF_CALLOC (SHA256_DIGEST_LENGTH, sizeof (*md), gf_common_mt_char);
-        if (!md) {
-                gf_msg (this->name, GF_LOG_ERROR, ENOMEM, BRB_MSG_NO_MEMORY,
-                        "failed to allocate memory for saving hash of the "
-                        "object %s", uuid_utoa (fd->inode->gfid));
-                goto out;
-        }
-
-        ret = br_object_checksum (md, object, fd, iatt);
-        if (ret) {
-                gf_msg (this->name, GF_LOG_ERROR, 0,
-                        BRB_MSG_CALC_CHECKSUM_FAILED, "calculating checksum "
-                        "for the object %s failed",
-                        uuid_utoa (linked_inode->gfid));
-                goto free_signature;
-        }
-
-        sign = br_prepare_signature (md, SHA256_DIGEST_LENGTH,
-                                     BR_SIGNATURE_TYPE_SHA256, object);
+        sign = br_prepare_signature (md, len, type, object);
         if (!sign) {
                 gf_msg (this->name, GF_LOG_ERROR, 0, BRB_MSG_GET_SIGN_FAILED,
                         "failed to get the signature for the object %s",
                         uuid_utoa (fd->inode->gfid));
-                goto free_signature;
+                goto out;
         }
 
         xattr = dict_for_key_value
                 (GLUSTERFS_SET_OBJECT_SIGNATURE,
-                 (void *)sign, signature_size (SHA256_DIGEST_LENGTH));
+                 (void *)sign, signature_size (len));
 
         if (!xattr) {
                 gf_msg (this->name, GF_LOG_ERROR, 0, BRB_MSG_SET_SIGN_FAILED,
@@ -446,6 +420,116 @@ br_object_read_sign (inode_t *linked_inode, fd_t *fd, br_object_t *object,
         dict_unref (xattr);
  free_isign:
         GF_FREE (sign);
+ out:
+        return ret;
+}
+
+/**
+ * Sign the object in chunks, hashing again only the chunks modified since
+ * the previous chunked signature if the stub kept track of them (it does
+ * not after a brick restart or once the inode is forgotten).
+ */
+static int32_t
+br_object_read_merkle_sign (inode_t *linked_inode, fd_t *fd,
+                            br_object_t *object, struct iatt *iatt)
+{
+        int32_t                ret      = -1;
+        xlator_t              *this     = NULL;
+        dict_t                *xattr    = NULL;
+        dict_t                *rxattr   = NULL;
+        br_isignature_out_t   *prev     = NULL;
+        br_dirty_range_t      *dirty    = NULL;
+        br_merkle_signature_t *sign     = NULL;
+        size_t                 signlen  = 0;
+
+        this = object->this;
+
+        ret = syncop_fgetxattr (object->child->xl, fd, &xattr,
+                                GLUSTERFS_GET_OBJECT_SIGNATURE, NULL, NULL);
+        if (!ret)
+                ret = dict_get_ptr (xattr, GLUSTERFS_GET_OBJECT_SIGNATURE,
+                                    (void **) &prev);
+        if (ret || (prev->signaturetype != BR_SIGNATURE_TYPE_SHA256_MERKLE))
+                prev = NULL;
+
+        if (prev) {
+                ret = syncop_fgetxattr (object->child->xl, fd, &rxattr,
+                                        BR_DIRTY_RANGE_KEY, NULL, NULL);
+                if (!ret)
+                        ret = dict_get_ptr (rxattr, BR_DIRTY_RANGE_KEY,
+                                            (void **) &dirty);
+                if (ret || (dirty->base != prev->version))
+                        dirty = NULL;
+        }
+
+        ret = br_merkle_sign (this, object->child, fd, GF_CLIENT_PID_BITD,
+                              iatt->ia_size,
+                              prev ? (br_merkle_signature_t *) prev->signature
+                                   : NULL,
+                              prev ? prev->signaturelen : 0, dirty,
+                              &sign, &signlen);
+        if (ret) {
+                gf_msg (this->name, GF_LOG_ERROR, 0,
+                        BRB_MSG_CALC_CHECKSUM_FAILED, "calculating checksum "
+                        "for the object %s failed",
+                        uuid_utoa (linked_inode->gfid));
+                goto out;
+        }
+
+        ret = br_object_set_signature (this, object, fd,
+                                       (unsigned char *) sign, signlen,
+                                       BR_SIGNATURE_TYPE_SHA256_MERKLE);
+        GF_FREE (sign);
+
+ out:
+        if (rxattr)
+                dict_unref (rxattr);
+        if (xattr)
+                dict_unref (xattr);
+        return ret;
+}
+
+static int32_t
+br_object_read_sign (inode_t *linked_inode, fd_t *fd, br_object_t *object,
+                     struct iatt *iatt)
+{
+        int32_t          ret           = -1;
+        xlator_t        *this          = NULL;
+        br_private_t    *priv          = NULL;
+        unsigned char   *md            = NULL;
+
+        GF_VALIDATE_OR_GOTO ("bit-rot", object, out);
+        GF_VALIDATE_OR_GOTO ("bit-rot", linked_inode, out);
+        GF_VALIDATE_OR_GOTO ("bit-rot", fd, out);
+
+        this = object->this;
+        priv = this->private;
+
+        if (priv->chunk_size)
+                return br_object_read_merkle_sign (linked_inode, fd,
+                                                   object, iatt);
+
+        md = GF_CALLOC (SHA256_DIGEST_LENGTH, sizeof (*md), gf_common_mt_char);
+        if (!md) {
+                gf_msg (this->name, GF_LOG_ERROR, ENOMEM, BRB_MSG_NO_MEMORY,
+                        "failed to allocate memory for saving hash of the "
+                        "object %s", uuid_utoa (fd->inode->gfid));
+                goto out;
+        }
+
+        ret = br_object_checksum (md, object, fd, iatt);
+        if (ret) {
+                gf_msg (this->name, GF_LOG_ERROR, 0,
+                        BRB_MSG_CALC_CHECKSUM_FAILED, "calculating checksum "
+                        "for the object %s failed",
+                        uuid_utoa (linked_inode->gfid));
+                goto free_signature;
+        }
+
+        ret = br_object_set_signature (this, object, fd, md,
+                                       SHA256_DIGEST_LENGTH,
+                                       BR_SIGNATURE_TYPE_SHA256);
+
  free_signature:
         GF_FREE (md);
  out:
@@ -1840,6 +1924,16 @@ br_signer_handle_options (xlator_t *this, br_private_t *priv, dict_t *options)
                 GF_OPTION_INIT ("expiry-time", priv->expiry_time,
                                 uint32, error_return);
 
+        if (options)
+                GF_OPTION_RECONF ("signature-chunk-size", priv->chunk_size,
+                                  options, size_uint64, error_return);
+        else
+                GF_OPTION_INIT ("signature-chunk-size", priv->chunk_size,
+                                size_uint64, error_return);
+
+        if (priv->chunk_size && (priv->chunk_size < BR_MERKLE_MIN_CHUNK))
+                priv->chunk_size = BR_MERKLE_MIN_CHUNK;
+
         return 0;
 
 error_return:
@@ -2004,6 +2098,10 @@ init (xlator_t *this)
 
 	this->private = priv;
 
+        ret = br_hasher_init (this, priv);
+        if (ret)
+                goto cleanup;
+
         if (!priv->iamscrubber) {
                 ret = br_signer_init (this, priv);
                 if (!ret)
@@ -2057,6 +2155,8 @@ fini (xlator_t *this)
         else
                 (void) br_free_scrubber_monitor (this, priv);
 
+        br_hasher_fini (this, priv);
+
         br_free_children (this, priv, priv->child_count);
 
         this->private = NULL;
@@ -2128,6 +2228,9 @@ reconfigure (xlator_t *this, dict_t *options)
         else
                 ret = br_reconfigure_signer (this, options);
 
+        if (!ret)
+                ret = br_hasher_handle_options (this, priv, options);
+
         return ret;
 }
 
@@ -2169,5 +2272,24 @@ struct volume_options options[] = {
           .description = "Pause/Resume scrub. Upon resume, scrubber "
                          "continues from where it left off.",
         },
+        { .key = {"signature-chunk-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "1MB",
+          .min = 0,
+          .max = 1 * GF_UNIT_GB,
+          .description = "Objects are signed in chunks of (at least) this "
+                         "size, which are hashed in parallel and scrubbed "
+                         "one by one, and only the chunks modified since "
+                         "the last signature are hashed again. 0 signs "
+                         "objects as a whole.",
+        },
+        { .key = {"hash-threads"},
+          .type = GF_OPTION_TYPE_INT,
+          .default_value = "4",
+          .min = 1,
+          .max = BR_HASH_THREADS_MAX,
+          .description = "Number of threads hashing the chunks of an "
+                         "object.",
+        },
 	{ .key  = {NULL} },
 };
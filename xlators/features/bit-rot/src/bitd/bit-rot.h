@@ -36,6 +36,11 @@
  */
 #define BR_WORKERS 4
 
+#define BR_HASH_CALC_READ_SIZE  (128 * 1024)
+
+/* threads hashing chunks of an object, counting the one asking for it */
+#define BR_HASH_THREADS_MAX 64
+
 typedef enum scrub_throttle {
         BR_SCRUB_THROTTLE_VOID       = -1,
         BR_SCRUB_THROTTLE_LAZY       = 0,
@@ -175,6 +180,29 @@ struct br_monitor {
         br_scrub_state_t state;   /* current scrub state */
 };
 
+struct br_hasher_thread {
+        pthread_t thread;
+        gf_boolean_t started;             /* yet to be joined */
+        gf_boolean_t alive;               /* yet to exit */
+        int id;
+        xlator_t *this;
+};
+
+/**
+ * helpers hashing chunks of objects being signed or scrubbed, shared by all
+ * the signer (or scrubber) threads. c.f. bit-rot-merkle.c
+ */
+struct br_hasher {
+        pthread_mutex_t lock;
+        pthread_cond_t  cond;
+
+        struct list_head jobs;            /* objects with chunks yet to be
+                                             handed out */
+        int nthreads;                     /* "hash-threads", the helpers
+                                             beyond that exit once idle */
+        struct br_hasher_thread helpers[BR_HASH_THREADS_MAX - 1];
+};
+
 typedef struct br_obj_n_workers br_obj_n_workers_t;
 
 typedef struct br_private br_private_t;
@@ -218,6 +246,11 @@ struct br_private {
         struct br_scrubber fsscrub;       /* scrubbers for this subvolume */
 
         struct br_monitor scrub_monitor;  /* scrubber monitor */
+
+        uint64_t chunk_size;              /* minimum size of the chunks
+                                             objects are signed in, 0 to
+                                             sign them as a whole */
+        struct br_hasher hasher;
 };
 
 struct br_object {
@@ -249,6 +282,10 @@ int32_t
 br_calculate_obj_checksum (unsigned char *,
                            br_child_t *, fd_t *, struct iatt *);
 
+int32_t
+br_object_read_block_and_sign (xlator_t *, fd_t *, br_child_t *,
+                               off_t, size_t, SHA256_CTX *);
+
 int32_t
 br_prepare_loc (xlator_t *, br_child_t *, loc_t *, gf_dirent_t *, loc_t *);
 
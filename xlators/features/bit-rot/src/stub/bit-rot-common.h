@@ -121,12 +121,28 @@ typedef enum {
         BR_SIGNATURE_TYPE_VOID   = -1,   /* object is not signed       */
         BR_SIGNATURE_TYPE_ZERO   = 0,    /* min boundary               */
         BR_SIGNATURE_TYPE_SHA256 = 1,    /* signed with SHA256         */
-        BR_SIGNATURE_TYPE_MAX    = 2,    /* max boundary               */
+        BR_SIGNATURE_TYPE_SHA256_MERKLE = 2, /* SHA256 of each chunk,
+                                                c.f. bit-rot-merkle.h  */
+        BR_SIGNATURE_TYPE_MAX    = 3,    /* max boundary               */
 } br_signature_type;
 
 /* BitRot stub start time (virtual xattr) */
 #define GLUSTERFS_GET_BR_STUB_INIT_TIME  "trusted.glusterfs.bit-rot.stub-init"
 
+/**
+ * Byte range of an object modified since the signature of version @base
+ * was laid down (virtual xattr, fetched by the signer on an fd). The stub
+ * knows it only if it laid that signature down itself, else ENODATA.
+ */
+#define BR_DIRTY_RANGE_KEY  "trusted.glusterfs.bit-rot.dirty-range"
+
+typedef struct br_dirty_range {
+        unsigned long base;
+        uint64_t start;
+        uint64_t end;                    /* exclusive, start == end if
+                                            nothing was modified      */
+} br_dirty_range_t;
+
 /* signing/reopen hint */
 #define BR_OBJECT_RESIGN 0
 #define BR_OBJECT_REOPEN  1
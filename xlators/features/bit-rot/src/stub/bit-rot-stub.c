@@ -543,6 +543,34 @@ br_stub_mark_inode_modified (xlator_t *this, br_stub_local_t *local)
         return -1;
 }
 
+/**
+ * Note down the range a modification is about to touch, for the signer to
+ * hash only the chunks in there again (c.f. BR_DIRTY_RANGE_KEY). It's done
+ * before winding, as a failed modification could still have changed part
+ * of the range, but only once the object is versioned for it: till then a
+ * signature of the current version can still come in and reset the range
+ * (c.f. br_stub_compare_sign_version ()), losing the modification.
+ */
+static void
+br_stub_track_modification (xlator_t *this, inode_t *inode,
+                            br_stub_inode_ctx_t *ctx,
+                            uint64_t start, uint64_t end)
+{
+        uint64_t ctx_addr = 0;
+
+        if (!ctx) {
+                if (br_stub_get_inode_ctx (this, inode, &ctx_addr))
+                        return;
+                ctx = (br_stub_inode_ctx_t *) (long) ctx_addr;
+        }
+
+        LOCK (&inode->lock);
+        {
+                __br_stub_add_dirty_range (ctx, start, end);
+        }
+        UNLOCK (&inode->lock);
+}
+
 /**
  * The possible return values from br_stub_is_bad_object () are:
  * 1) 0  => as per the inode context object is not bad
@@ -831,6 +859,10 @@ br_stub_compare_sign_version (xlator_t *this,
                                       "(%lu)", ctx->currentversion,
                                       sbuf->signedversion);
                         *fakesuccess = 1;
+                } else {
+                        /* modifications from here on have to be hashed
+                           again to get the next signature */
+                        __br_stub_reset_dirty_range (ctx, sbuf->signedversion);
                 }
         }
         UNLOCK (&inode->lock);
@@ -1581,6 +1613,57 @@ br_stub_send_stub_init_time (call_frame_t *frame, xlator_t *this)
                 dict_unref (xattr);
 }
 
+static void
+br_stub_send_dirty_range (call_frame_t *frame, xlator_t *this, fd_t *fd)
+{
+        int                  op_ret   = -1;
+        int                  op_errno = ENODATA;
+        uint64_t             ctx_addr = 0;
+        dict_t              *xattr    = NULL;
+        br_dirty_range_t    *range    = NULL;
+        br_stub_inode_ctx_t *ctx      = NULL;
+
+        if (br_stub_get_inode_ctx (this, fd->inode, &ctx_addr))
+                goto unwind;
+        ctx = (br_stub_inode_ctx_t *) (long) ctx_addr;
+
+        op_errno = ENOMEM;
+        xattr = dict_new ();
+        range = GF_CALLOC (1, sizeof (*range), gf_br_stub_mt_signature_t);
+        if (!xattr || !range)
+                goto unwind;
+
+        op_errno = ENODATA;
+        LOCK (&fd->inode->lock);
+        {
+                if (ctx->dirtytracked) {
+                        *range = ctx->dirty;
+                        op_ret = 0;
+                }
+        }
+        UNLOCK (&fd->inode->lock);
+
+        if (op_ret)
+                goto unwind;
+
+        op_ret = dict_set_bin (xattr, BR_DIRTY_RANGE_KEY,
+                               (void *) range, sizeof (*range));
+        if (op_ret < 0) {
+                op_errno = EINVAL;
+                goto unwind;
+        }
+        range = NULL;
+
+        op_ret = sizeof (br_dirty_range_t);
+
+ unwind:
+        STACK_UNWIND (frame, op_ret, op_errno, xattr, NULL);
+
+        GF_FREE (range);
+        if (xattr)
+                dict_unref (xattr);
+}
+
 int
 br_stub_getxattr (call_frame_t *frame, xlator_t *this,
                   loc_t *loc, const char *name, dict_t *xdata)
@@ -1705,6 +1788,11 @@ br_stub_fgetxattr (call_frame_t *frame, xlator_t *this,
         if (!IA_ISREG (fd->inode->ia_type))
                 goto wind;
 
+        if (strcmp (name, BR_DIRTY_RANGE_KEY) == 0) {
+                br_stub_send_dirty_range (frame, this, fd);
+                return 0;
+        }
+
         if (name && (strncmp (name, GLUSTERFS_GET_OBJECT_SIGNATURE,
                               strlen (GLUSTERFS_GET_OBJECT_SIGNATURE)) == 0)) {
                 cookie = (void *) BR_STUB_REQUEST_COOKIE;
@@ -1802,6 +1890,9 @@ br_stub_writev_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
                        struct iovec *vector, int32_t count, off_t offset,
                        uint32_t flags, struct iobref *iobref, dict_t *xdata)
 {
+        br_stub_track_modification (this, fd->inode, NULL, offset,
+                                    offset + iov_length (vector, count));
+
         STACK_WIND (frame, br_stub_writev_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->writev, fd, vector, count,
                     offset, flags, iobref, xdata);
@@ -1885,6 +1976,9 @@ br_stub_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
         return br_stub_perform_incversioning (this, frame, stub, fd, ctx);
 
  wind:
+        br_stub_track_modification (this, fd->inode, ctx, offset,
+                                    offset + iov_length (vector, count));
+
         STACK_WIND (frame, cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->writev,
                     fd, vector, count, offset, flags, iobref, xdata);
@@ -1936,6 +2030,8 @@ int32_t
 br_stub_ftruncate_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
                           off_t offset, dict_t *xdata)
 {
+        br_stub_track_modification (this, fd->inode, NULL, offset, UINT64_MAX);
+
         STACK_WIND (frame, br_stub_ftruncate_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->ftruncate, fd, offset, xdata);
         return 0;
@@ -1995,6 +2091,8 @@ br_stub_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd,
         return br_stub_perform_incversioning (this, frame, stub, fd, ctx);
 
  wind:
+        br_stub_track_modification (this, fd->inode, ctx, offset, UINT64_MAX);
+
         STACK_WIND (frame, cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->ftruncate, fd, offset, xdata);
         return 0;
@@ -2045,6 +2143,9 @@ br_stub_truncate_resume (call_frame_t *frame, xlator_t *this, loc_t *loc,
 {
         br_stub_local_t *local = frame->local;
 
+        br_stub_track_modification (this, loc->inode, NULL, offset,
+                                    UINT64_MAX);
+
         fd_unref (local->u.context.fd);
         STACK_WIND (frame, br_stub_ftruncate_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->truncate, loc, offset, xdata);
@@ -2129,6 +2230,8 @@ br_stub_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc,
         return br_stub_perform_incversioning (this, frame, stub, fd, ctx);
 
  wind:
+        br_stub_track_modification (this, fd->inode, ctx, offset, UINT64_MAX);
+
         STACK_WIND (frame, cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->truncate, loc, offset, xdata);
         fd_unref (fd);
@@ -2147,6 +2250,49 @@ br_stub_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc,
         return 0;
 }
 
+/**
+ * fallocate(), discard() and zerofill() do not version the object, but the
+ * next signer run has to hash what they changed nonetheless.
+ */
+int32_t
+br_stub_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   int32_t keep_size, off_t offset, size_t len, dict_t *xdata)
+{
+        br_stub_track_modification (this, fd->inode, NULL,
+                                    offset, offset + len);
+
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->fallocate, fd, keep_size,
+                         offset, len, xdata);
+        return 0;
+}
+
+int32_t
+br_stub_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len, dict_t *xdata)
+{
+        br_stub_track_modification (this, fd->inode, NULL,
+                                    offset, offset + len);
+
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->discard, fd, offset, len,
+                         xdata);
+        return 0;
+}
+
+int32_t
+br_stub_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  off_t offset, off_t len, dict_t *xdata)
+{
+        br_stub_track_modification (this, fd->inode, NULL,
+                                    offset, offset + len);
+
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->zerofill, fd, offset, len,
+                         xdata);
+        return 0;
+}
+
 /** }}} */
 
 
@@ -3225,6 +3371,9 @@ struct xlator_fops fops = {
         .writev    = br_stub_writev,
         .truncate  = br_stub_truncate,
         .ftruncate = br_stub_ftruncate,
+        .fallocate = br_stub_fallocate,
+        .discard   = br_stub_discard,
+        .zerofill  = br_stub_zerofill,
         .mknod     = br_stub_mknod,
         .readv     = br_stub_readv,
         .removexattr = br_stub_removexattr,
@@ -42,6 +42,11 @@ typedef struct br_stub_inode_ctx {
         struct list_head fd_list; /* list of open fds or fds participating in
                                      write operations */
         gf_boolean_t bad_object;
+
+        gf_boolean_t dirtytracked;      /* laid down the signature of
+                                           ->dirty.base, and tracking the
+                                           modifications since */
+        br_dirty_range_t dirty;
 } br_stub_inode_ctx_t;
 
 typedef struct br_stub_fd {
@@ -194,6 +199,34 @@ br_stub_require_release_call (xlator_t *this, fd_t *fd, br_stub_fd_t **fd_ctx)
         return ret;
 }
 
+/* modification tracking for incremental signing */
+static inline void
+__br_stub_reset_dirty_range (br_stub_inode_ctx_t *ctx, unsigned long version)
+{
+        ctx->dirtytracked = _gf_true;
+        ctx->dirty.base = version;
+        ctx->dirty.start = ctx->dirty.end = 0;
+}
+
+static inline void
+__br_stub_add_dirty_range (br_stub_inode_ctx_t *ctx,
+                           uint64_t start, uint64_t end)
+{
+        if (!ctx->dirtytracked || (start >= end))
+                return;
+
+        if (ctx->dirty.start == ctx->dirty.end) {
+                ctx->dirty.start = start;
+                ctx->dirty.end = end;
+                return;
+        }
+
+        if (start < ctx->dirty.start)
+                ctx->dirty.start = start;
+        if (end > ctx->dirty.end)
+                ctx->dirty.end = end;
+}
+
 /* get/set inode context helpers */
 
 static inline int
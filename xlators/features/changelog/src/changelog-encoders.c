@@ -10,6 +10,25 @@
 
 #include "changelog-encoders.h"
 
+/* decimal form of @nr, without the trailing '\0' snprintf() would add */
+static size_t
+changelog_utoa (unsigned int nr, char *buffer)
+{
+        char   tmp[10];
+        size_t len = 0;
+        size_t i   = 0;
+
+        do {
+                tmp[len++] = '0' + (nr % 10);
+                nr /= 10;
+        } while (nr);
+
+        for (i = 0; i < len; i++)
+                buffer[i] = tmp[len - i - 1];
+
+        return len;
+}
+
 size_t
 entry_fn (void *data, char *buffer, gf_boolean_t encode)
 {
@@ -68,15 +87,13 @@ del_entry_fn (void *data, char *buffer, gf_boolean_t encode)
 size_t
 fop_fn (void *data, char *buffer, gf_boolean_t encode)
 {
-        char buf[10]          = {0,};
         size_t         bufsz = 0;
         glusterfs_fop_t fop   = 0;
 
         fop = *(glusterfs_fop_t *) data;
 
         if (encode) {
-                (void) snprintf (buf, sizeof (buf), "%d", fop);
-                CHANGELOG_FILL_BUFFER (buffer, bufsz, buf, strlen (buf));
+                bufsz = changelog_utoa ((unsigned int) fop, buffer);
         } else
                 CHANGELOG_FILL_BUFFER (buffer, bufsz, &fop, sizeof (fop));
 
@@ -88,13 +105,11 @@ number_fn (void *data, char *buffer, gf_boolean_t encode)
 {
         size_t       bufsz = 0;
         unsigned int nr    = 0;
-        char buf[20]       = {0,};
 
         nr = *(unsigned int *) data;
 
         if (encode) {
-                (void) snprintf (buf, sizeof (buf), "%u", nr);
-                CHANGELOG_FILL_BUFFER (buffer, bufsz, buf, strlen (buf));
+                bufsz = changelog_utoa (nr, buffer);
         } else
                 CHANGELOG_FILL_BUFFER (buffer, bufsz, &nr, sizeof (unsigned int));
 
@@ -167,13 +182,12 @@ changelog_encode_write_xtra (changelog_log_data_t *cld,
         *off = offset;
 }
 
-int
-changelog_encode_ascii (xlator_t *this, changelog_log_data_t *cld)
+size_t
+changelog_fill_ascii (xlator_t *this, changelog_log_data_t *cld, char *buffer)
 {
         size_t            off      = 0;
         size_t            gfid_len = 0;
         char             *gfid_str = NULL;
-        char             *buffer   = NULL;
         changelog_priv_t *priv     = NULL;
 
         priv = this->private;
@@ -181,8 +195,6 @@ changelog_encode_ascii (xlator_t *this, changelog_log_data_t *cld)
         gfid_str = uuid_utoa (cld->cld_gfid);
         gfid_len = strlen (gfid_str);
 
-        /* extra bytes for decorations */
-        buffer = alloca (gfid_len + cld->cld_ptr_len + 10);
         CHANGELOG_STORE_ASCII (priv, buffer,
                                off, gfid_str, gfid_len, cld);
 
@@ -191,20 +203,29 @@ changelog_encode_ascii (xlator_t *this, changelog_log_data_t *cld)
 
         CHANGELOG_FILL_BUFFER (buffer, off, "\0", 1);
 
-        return changelog_write_change (priv, buffer, off);
+        return off;
 }
 
 int
-changelog_encode_binary (xlator_t *this, changelog_log_data_t *cld)
+changelog_encode_ascii (xlator_t *this, changelog_log_data_t *cld)
+{
+        size_t  off    = 0;
+        char   *buffer = NULL;
+
+        buffer = alloca (CHANGELOG_RECORD_MAX_LEN (cld));
+        off = changelog_fill_ascii (this, cld, buffer);
+
+        return changelog_write_change (this->private, buffer, off);
+}
+
+size_t
+changelog_fill_binary (xlator_t *this, changelog_log_data_t *cld, char *buffer)
 {
-        size_t            off    = 0;
-        char             *buffer = NULL;
-        changelog_priv_t *priv   = NULL;
+        size_t            off  = 0;
+        changelog_priv_t *priv = NULL;
 
         priv = this->private;
 
-        /* extra bytes for decorations */
-        buffer = alloca (sizeof (uuid_t) + cld->cld_ptr_len + 10);
         CHANGELOG_STORE_BINARY (priv, buffer, off, cld->cld_gfid, cld);
 
         if (cld->cld_xtra_records)
@@ -212,7 +233,19 @@ changelog_encode_binary (xlator_t *this, changelog_log_data_t *cld)
 
         CHANGELOG_FILL_BUFFER (buffer, off, "\0", 1);
 
-        return changelog_write_change (priv, buffer, off);
+        return off;
+}
+
+int
+changelog_encode_binary (xlator_t *this, changelog_log_data_t *cld)
+{
+        size_t  off    = 0;
+        char   *buffer = NULL;
+
+        buffer = alloca (CHANGELOG_RECORD_MAX_LEN (cld));
+        off = changelog_fill_binary (this, cld, buffer);
+
+        return changelog_write_change (this->private, buffer, off);
 }
 
 static struct changelog_encoder
@@ -221,11 +254,13 @@ cb_encoder[] = {
         {
                 .encoder = CHANGELOG_ENCODE_BINARY,
                 .encode = changelog_encode_binary,
+                .fill = changelog_fill_binary,
         },
         [CHANGELOG_ENCODE_ASCII] =
         {
                 .encoder = CHANGELOG_ENCODE_ASCII,
                 .encode = changelog_encode_ascii,
+                .fill = changelog_fill_ascii,
         },
 };
 
@@ -30,6 +30,11 @@
                                        off, gfid, sizeof (uuid_t));     \
         } while (0)
 
+/* room for one record in either encoding: the gfid in its ascii form, the
+ * extra records and the separators */
+#define CHANGELOG_RECORD_MAX_LEN(cld)                                   \
+        (UUID_CANONICAL_FORM_LEN + (cld)->cld_ptr_len + 10)
+
 size_t
 entry_fn (void *data, char *buffer, gf_boolean_t encode);
 size_t
@@ -42,6 +47,10 @@ void
 entry_free_fn (void *data);
 void
 del_entry_free_fn (void *data);
+size_t
+changelog_fill_binary (xlator_t *, changelog_log_data_t *, char *);
+size_t
+changelog_fill_ascii (xlator_t *, changelog_log_data_t *, char *);
 int
 changelog_encode_binary (xlator_t *, changelog_log_data_t *);
 int
@@ -91,6 +91,9 @@ struct changelog_bootstrap {
 struct changelog_encoder {
         changelog_encoder_t encoder;
         int (*encode) (xlator_t *, changelog_log_data_t *);
+        /* lays a record out in a buffer of CHANGELOG_RECORD_MAX_LEN bytes
+         * and returns its length, for the caller to write */
+        size_t (*fill) (xlator_t *, changelog_log_data_t *, char *);
 };
 
 
@@ -247,6 +250,12 @@ struct changelog_priv {
         /* operation mode */
         changelog_mode_t op_mode;
 
+        /* append records of concurrent fops with one write */
+        gf_boolean_t group_commit;
+
+        /* msecs fops do not wait for their records to be written for */
+        uint32_t group_commit_delay;
+
         /* bootstrap routine for 'current' logger */
         struct changelog_bootstrap *cb;
 
@@ -13,7 +13,9 @@
 #include "logging.h"
 
 #include "changelog-rt.h"
+#include "changelog-encoders.h"
 #include "changelog-mem-types.h"
+#include "changelog-messages.h"
 
 int
 changelog_rt_init (xlator_t *this, changelog_dispatcher_t *cd)
@@ -25,7 +27,21 @@ changelog_rt_init (xlator_t *this, changelog_dispatcher_t *cd)
         if (!crt)
                 return -1;
 
+        crt->gc_buf = GF_MALLOC (CHANGELOG_RT_BUF_SIZE,
+                                 gf_changelog_mt_rt_buf_t);
+        crt->gc_spare = GF_MALLOC (CHANGELOG_RT_BUF_SIZE,
+                                   gf_changelog_mt_rt_buf_t);
+        if (!crt->gc_buf || !crt->gc_spare) {
+                GF_FREE (crt->gc_buf);
+                GF_FREE (crt->gc_spare);
+                GF_FREE (crt);
+                return -1;
+        }
+
         LOCK_INIT (&crt->lock);
+        pthread_mutex_init (&crt->gc_lock, NULL);
+        pthread_cond_init (&crt->gc_cond, NULL);
+        INIT_LIST_HEAD (&crt->gc_waiters);
 
         cd->cd_data = crt;
         cd->dispatchfn = &changelog_rt_enqueue;
@@ -33,6 +49,155 @@ changelog_rt_init (xlator_t *this, changelog_dispatcher_t *cd)
         return 0;
 }
 
+/**
+ * Writes out everything laid out so far and lets go of the waiters it
+ * covers. Called by the leader with gc_lock held, which is dropped while
+ * writing so that fops keep laying records out in the spare buffer.
+ */
+static void
+changelog_rt_write_batch (xlator_t *this, changelog_priv_t *priv,
+                          changelog_rt_t *crt)
+{
+        changelog_rt_waiter_t *waiter = NULL;
+        changelog_rt_waiter_t *tmp    = NULL;
+        char                  *buf    = NULL;
+        size_t                 len    = 0;
+        uint64_t               upto   = 0;
+        int                    ret    = 0;
+
+        buf = crt->gc_buf;
+        len = crt->gc_len;
+        upto = crt->gc_queued;
+
+        crt->gc_buf = crt->gc_spare;
+        crt->gc_spare = NULL;
+        crt->gc_len = 0;
+
+        pthread_mutex_unlock (&crt->gc_lock);
+
+        LOCK (&crt->lock);
+        {
+                /**
+                 * changelog got disabled by a reconfigure with these
+                 * records still in flight, see changelog_handle_change().
+                 */
+                if (len && priv->changelog_fd != -1) {
+                        ret = changelog_write (priv->changelog_fd, buf, len);
+                        if (ret) {
+                                gf_msg (this->name, GF_LOG_ERROR, errno,
+                                        CHANGELOG_MSG_WRITE_FAILED,
+                                        "error writing changelog to disk");
+                        }
+                }
+        }
+        UNLOCK (&crt->lock);
+
+        pthread_mutex_lock (&crt->gc_lock);
+
+        crt->gc_spare = buf;
+        crt->gc_written = upto;
+
+        /* waiters are queued in the order of their records */
+        list_for_each_entry_safe (waiter, tmp, &crt->gc_waiters, list) {
+                if (waiter->seq > upto)
+                        break;
+
+                /* it lives on the stack of its fop, which may return as
+                 * soon as it is done */
+                list_del_init (&waiter->list);
+                waiter->ret = ret;
+                waiter->done = _gf_true;
+                if (waiter->sleeping)
+                        pthread_cond_signal (&waiter->cond);
+        }
+}
+
+/* returns once the records up to @seq are written, gc_lock held */
+static int
+changelog_rt_commit (xlator_t *this, changelog_priv_t *priv,
+                     changelog_rt_t *crt, uint64_t seq)
+{
+        changelog_rt_waiter_t  waiter = {{0,},};
+        changelog_rt_waiter_t *next   = NULL;
+
+        if (crt->gc_written >= seq)
+                return 0;
+
+        waiter.seq = seq;
+        list_add_tail (&waiter.list, &crt->gc_waiters);
+
+        if (crt->gc_leader) {
+                pthread_cond_init (&waiter.cond, NULL);
+                waiter.sleeping = _gf_true;
+                while (!waiter.done && !waiter.lead)
+                        pthread_cond_wait (&waiter.cond, &crt->gc_lock);
+        } else {
+                crt->gc_leader = _gf_true;
+                waiter.lead = _gf_true;
+        }
+
+        if (waiter.lead) {
+                changelog_rt_write_batch (this, priv, crt);
+
+                /* the first of those who queued meanwhile writes the next
+                 * batch, so that nobody is woken up more than once */
+                if (list_empty (&crt->gc_waiters)) {
+                        crt->gc_leader = _gf_false;
+                } else {
+                        next = list_first_entry (&crt->gc_waiters,
+                                                 changelog_rt_waiter_t, list);
+                        next->lead = _gf_true;
+                        pthread_cond_signal (&next->cond);
+                }
+        }
+
+        if (waiter.sleeping)
+                pthread_cond_destroy (&waiter.cond);
+
+        return waiter.ret;
+}
+
+static void *
+changelog_rt_writer (void *data)
+{
+        xlator_t         *this     = data;
+        changelog_priv_t *priv     = NULL;
+        changelog_rt_t   *crt      = NULL;
+        struct timeval    now      = {0,};
+        struct timespec   deadline = {0,};
+        uint64_t          usec     = 0;
+
+        priv = this->private;
+        crt = priv->cd.cd_data;
+
+        pthread_mutex_lock (&crt->gc_lock);
+        while (!crt->gc_fini) {
+                if (crt->gc_written == crt->gc_queued) {
+                        pthread_cond_wait (&crt->gc_cond, &crt->gc_lock);
+                        continue;
+                }
+
+                /* let the batch grow, unless it is half full already */
+                if (priv->group_commit_delay &&
+                    crt->gc_len < CHANGELOG_RT_BUF_SIZE / 2) {
+                        gettimeofday (&now, NULL);
+                        usec = now.tv_usec +
+                                (uint64_t)priv->group_commit_delay * 1000;
+                        deadline.tv_sec = now.tv_sec + usec / 1000000;
+                        deadline.tv_nsec = (usec % 1000000) * 1000;
+                        pthread_cond_timedwait (&crt->gc_cond, &crt->gc_lock,
+                                                &deadline);
+                        if (crt->gc_fini)
+                                break;
+                }
+
+                (void) changelog_rt_commit (this, priv, crt, crt->gc_queued);
+        }
+        pthread_mutex_unlock (&crt->gc_lock);
+
+        return NULL;
+}
+
 int
 changelog_rt_fini (xlator_t *this, changelog_dispatcher_t *cd)
 {
@@ -40,28 +205,160 @@ changelog_rt_fini (xlator_t *this, changelog_dispatcher_t *cd)
 
         crt = cd->cd_data;
 
+        if (crt->gc_writer_running) {
+                pthread_mutex_lock (&crt->gc_lock);
+                {
+                        crt->gc_fini = _gf_true;
+                        pthread_cond_signal (&crt->gc_cond);
+                }
+                pthread_mutex_unlock (&crt->gc_lock);
+
+                pthread_join (crt->gc_writer, NULL);
+                crt->gc_writer_running = _gf_false;
+        }
+
+        /* records the writer had not got to */
+        pthread_mutex_lock (&crt->gc_lock);
+        {
+                (void) changelog_rt_commit (this, this->private, crt,
+                                            crt->gc_queued);
+        }
+        pthread_mutex_unlock (&crt->gc_lock);
+
         LOCK_DESTROY (&crt->lock);
+        pthread_cond_destroy (&crt->gc_cond);
+        pthread_mutex_destroy (&crt->gc_lock);
+        GF_FREE (crt->gc_buf);
+        GF_FREE (crt->gc_spare);
         GF_FREE (crt);
 
         return 0;
 }
 
+/**
+ * rollover and fsync act on the records laid out before them: write those
+ * out first, and keep fops from laying out more until they are done.
+ */
+static int
+changelog_rt_handle_event (xlator_t *this, changelog_priv_t *priv,
+                           changelog_rt_t *crt, changelog_log_data_t *cld)
+{
+        int ret = 0;
+
+        pthread_mutex_lock (&crt->gc_lock);
+        {
+                while (crt->gc_written < crt->gc_queued)
+                        (void) changelog_rt_commit (this, priv, crt,
+                                                    crt->gc_queued);
+
+                LOCK (&crt->lock);
+                {
+                        ret = changelog_handle_change (this, priv, cld);
+                }
+                UNLOCK (&crt->lock);
+        }
+        pthread_mutex_unlock (&crt->gc_lock);
+
+        return ret;
+}
+
 int
 changelog_rt_enqueue (xlator_t *this, changelog_priv_t *priv, void *cbatch,
                       changelog_log_data_t *cld_0, changelog_log_data_t *cld_1)
 {
-        int             ret = 0;
-        changelog_rt_t *crt = NULL;
+        int                       ret      = 0;
+        int                       i        = 0;
+        uint64_t                  seq      = 0;
+        gf_boolean_t              deferred = _gf_false;
+        gf_boolean_t              wakeup   = _gf_false;
+        changelog_rt_t           *crt      = NULL;
+        changelog_log_data_t     *cld[2]   = {cld_0, cld_1};
+        struct changelog_encoder *ce[2]    = {NULL,};
+        char                     *rec[2]   = {NULL,};
+        size_t                    len[2]   = {0,};
 
         crt = (changelog_rt_t *) cbatch;
 
-        LOCK (&crt->lock);
+        if (CHANGELOG_TYPE_IS_ROLLOVER (cld_0->cld_type) ||
+            CHANGELOG_TYPE_IS_FSYNC (cld_0->cld_type))
+                return changelog_rt_handle_event (this, priv, crt, cld_0);
+
+        if (!priv->group_commit) {
+                LOCK (&crt->lock);
+                {
+                        ret = changelog_handle_change (this, priv, cld_0);
+                        if (!ret && cld_1)
+                                ret = changelog_handle_change (this, priv,
+                                                               cld_1);
+                }
+                UNLOCK (&crt->lock);
+
+                return ret;
+        }
+
+        /* encode outside of the lock */
+        for (i = 0; i < 2 && cld[i]; i++) {
+                rec[i] = alloca (CHANGELOG_RECORD_MAX_LEN (cld[i]));
+                ce[i] = priv->ce;
+                len[i] = ce[i]->fill (this, cld[i], rec[i]);
+        }
+
+        /* an O_SYNC changelog wants each record on disk before the fop
+         * returns. So does a namespace change: a lost data or metadata
+         * record is made up for by the next change to the gfid, a lost
+         * create, unlink or rename is not. */
+        deferred = (priv->group_commit_delay && priv->fsync_interval &&
+                    !CHANGELOG_TYPE_IS_ENTRY (cld_0->cld_type) &&
+                    !(cld_1 && CHANGELOG_TYPE_IS_ENTRY (cld_1->cld_type)));
+
+        pthread_mutex_lock (&crt->gc_lock);
         {
-                ret = changelog_handle_change (this, priv, cld_0);
-                if (!ret && cld_1)
-                        ret = changelog_handle_change (this, priv, cld_1);
+                for (i = 0; i < 2 && cld[i]; i++) {
+                        while (crt->gc_len + CHANGELOG_RECORD_MAX_LEN (cld[i])
+                               > CHANGELOG_RT_BUF_SIZE)
+                                (void) changelog_rt_commit (this, priv, crt,
+                                                            crt->gc_queued);
+
+                        wakeup = wakeup || (crt->gc_len == 0);
+
+                        /* a rollover switched the encoding since */
+                        if (ce[i] != priv->ce) {
+                                len[i] = priv->ce->fill (this, cld[i],
+                                                         crt->gc_buf +
+                                                         crt->gc_len);
+                        } else {
+                                memcpy (crt->gc_buf + crt->gc_len,
+                                        rec[i], len[i]);
+                        }
+                        crt->gc_len += len[i];
+                        seq = ++crt->gc_queued;
+                }
+
+                if (deferred && !crt->gc_writer_running) {
+                        ret = gf_thread_create (&crt->gc_writer, NULL,
+                                                changelog_rt_writer, this);
+                        if (ret) {
+                                gf_msg (this->name, GF_LOG_ERROR, errno,
+                                        CHANGELOG_MSG_PTHREAD_ERROR,
+                                        "failed to start the changelog "
+                                        "writer, fops will wait for their "
+                                        "records to be written");
+                                deferred = _gf_false;
+                        } else {
+                                crt->gc_writer_running = _gf_true;
+                        }
+                }
+
+                if (deferred) {
+                        ret = 0;
+                        if (wakeup ||
+                            crt->gc_len >= CHANGELOG_RT_BUF_SIZE / 2)
+                                pthread_cond_signal (&crt->gc_cond);
+                } else {
+                        ret = changelog_rt_commit (this, priv, crt, seq);
+                }
         }
-        UNLOCK (&crt->lock);
+        pthread_mutex_unlock (&crt->gc_lock);
 
         return ret;
 }
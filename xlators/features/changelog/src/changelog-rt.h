@@ -17,11 +17,57 @@
 
 #include "changelog-helpers.h"
 
-/* unused as of now - may be you would need it later */
+/* records laid out while a batch is being written */
+#define CHANGELOG_RT_BUF_SIZE  (128 * 1024)
+
+/**
+ * Group commit: fops lay their records out one after the other in a shared
+ * buffer and the buffer is appended to the changelog with one write. With
+ * no delay a fop waits for its record to be written, as it would have
+ * waited for the lock: the first one to find no batch being written
+ * becomes the leader and writes everything laid out so far, the others
+ * sleep until their records are written or until they are handed the next
+ * batch. With a delay, fops do not wait at all and the writer thread
+ * appends the buffer every so many msecs, or once it is half full.
+ *
+ * Rollover and fsync write the buffer out before they act, so a record
+ * always lands in the changelog that was current when it was laid out.
+ */
 typedef struct changelog_rt {
+        /* serialises writes to the changelog */
         gf_lock_t lock;
+
+        pthread_mutex_t  gc_lock;
+        char            *gc_buf;
+        size_t           gc_len;
+        /* NULL while a batch is written out of it */
+        char            *gc_spare;
+        /* records laid out, and of those, written out */
+        uint64_t         gc_queued;
+        uint64_t         gc_written;
+        struct list_head gc_waiters;
+        /* a batch is being written, or handed over to a waiter */
+        gf_boolean_t     gc_leader;
+
+        pthread_cond_t   gc_cond;
+        pthread_t        gc_writer;
+        gf_boolean_t     gc_writer_running;
+        gf_boolean_t     gc_fini;
 } changelog_rt_t;
 
+typedef struct changelog_rt_waiter {
+        struct list_head list;
+        /* waits for the records up to this one */
+        uint64_t         seq;
+        int              ret;
+        gf_boolean_t     done;
+        /* writes the next batch */
+        gf_boolean_t     lead;
+        /* set up only for a waiter that has to sleep */
+        gf_boolean_t     sleeping;
+        pthread_cond_t   cond;
+} changelog_rt_waiter_t;
+
 int
 changelog_rt_init (xlator_t *this, changelog_dispatcher_t *cd);
 int
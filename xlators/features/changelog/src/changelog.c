@@ -2581,6 +2581,11 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("capture-del-path", priv->capture_del_path, options,
                           bool, out);
 
+        GF_OPTION_RECONF ("group-commit", priv->group_commit, options,
+                          bool, out);
+        GF_OPTION_RECONF ("group-commit-delay", priv->group_commit_delay,
+                          options, uint32, out);
+
         if (active_now || active_earlier) {
                 ret = changelog_fill_rollover_data (&cld, !active_now);
                 if (ret)
@@ -2689,6 +2694,9 @@ changelog_init_options (xlator_t *this, changelog_priv_t *priv)
         GF_OPTION_INIT ("changelog", priv->active, bool, dealloc_2);
         GF_OPTION_INIT ("capture-del-path", priv->capture_del_path,
                         bool, dealloc_2);
+        GF_OPTION_INIT ("group-commit", priv->group_commit, bool, dealloc_2);
+        GF_OPTION_INIT ("group-commit-delay", priv->group_commit_delay,
+                        uint32, dealloc_2);
 
         GF_OPTION_INIT ("op-mode", tmp, str, dealloc_2);
         changelog_assign_opmode (priv, tmp);
@@ -2975,6 +2983,29 @@ struct volume_options options[] = {
          .default_value = "off",
          .description = "enable/disable capturing paths of deleted entries"
         },
+        {.key = {"group-commit"},
+         .type = GF_OPTION_TYPE_BOOL,
+         .default_value = "on",
+         .description = "append the records of concurrent fops to the "
+                        "changelog with one write instead of one write "
+                        "per fop"
+        },
+        {.key = {"group-commit-delay"},
+         .type = GF_OPTION_TYPE_INT,
+         .min = 0,
+         .max = 1000,
+         .default_value = "0",
+         .description = "with group-commit on, data and metadata fops no "
+                        "longer wait for their records to be written: these "
+                        "are appended every so many milliseconds, or once "
+                        "64KB of them are pending. Such a fop is acknowledged "
+                        "before its record is written, so if the brick dies "
+                        "the records of the last few milliseconds are lost "
+                        "even though the client saw the fops succeed. Entry "
+                        "fops (create, unlink, rename, ...) always wait for "
+                        "their records. 0 to wait, as it is done when "
+                        "fsync-interval is 0"
+        },
         {.key = {NULL}
         },
 };
@@ -14,6 +14,7 @@
 #include "ctr-helper.h"
 #include "ctr-messages.h"
 #include "syscall.h"
+#include "statedump.h"
 
 #include "changetimerecorder.h"
 #include "tier-ctr-interface.h"
@@ -1824,8 +1825,11 @@ ctr_compact_thread (void *args)
         gf_msg ("ctr-compact", GF_LOG_INFO, 0, CTR_MSG_SET,
                 "Starting compaction");
 
+        /* no heat batch may be open while the database is vacuumed */
+        pthread_mutex_lock (&priv->heat.db_lock);
         ret = compact_db(db_conn, compact_active,
                          compact_mode_switched);
+        pthread_mutex_unlock (&priv->heat.db_lock);
 
         if (ret) {
                 gf_msg ("ctr-compact", GF_LOG_ERROR, 0, CTR_MSG_SET,
@@ -1885,6 +1889,9 @@ ctr_ipc_helper (xlator_t *this, dict_t *in_dict,
         if (strncmp (ctr_ipc_ops, GFDB_IPC_CTR_CLEAR_OPS,
                         strlen (GFDB_IPC_CTR_CLEAR_OPS)) == 0) {
 
+                /* heat still in memory predates the clear */
+                ctr_heat_flush (this, &priv->heat);
+
                 ret = clear_files_heat (priv->_db_conn);
                 if (ret)
                         goto out;
@@ -1909,6 +1916,9 @@ ctr_ipc_helper (xlator_t *this, dict_t *in_dict,
                         goto out;
                 }
 
+                /* the query has to see the heat recorded so far */
+                ctr_heat_flush (this, &priv->heat);
+
                 ret = ctr_db_query (this, priv->_db_conn, query_file,
                                 ipc_ctr_params);
 
@@ -2086,6 +2096,26 @@ out:
 }
 
 
+int32_t
+ctr_priv_dump (xlator_t *this)
+{
+        gf_ctr_private_t *priv  = NULL;
+        char key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+        priv = this->private;
+        if (!priv)
+                return 0;
+
+        gf_proc_dump_build_key (key_prefix, "xlator.features.ctr",
+                                "priv");
+        gf_proc_dump_add_section (key_prefix);
+
+        gf_proc_dump_write ("enabled", "%d", priv->enabled);
+        ctr_heat_dump (this, &priv->heat);
+
+        return 0;
+}
+
 /******************************************************************************/
 int
 reconfigure (xlator_t *this, dict_t *options)
@@ -2127,6 +2157,22 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("record-entry", priv->ctr_record_wind, options,
                           bool, out);
 
+        GF_OPTION_RECONF ("ctr-heat-batch-size", priv->heat.batch_size,
+                          options, uint32, out);
+
+        GF_OPTION_RECONF ("ctr-heat-flush-interval",
+                          priv->heat.flush_interval, options, uint32, out);
+
+        GF_OPTION_RECONF ("ctr-heat-max-backlog", priv->heat.max_backlog,
+                          options, uint32, out);
+
+        /* have the flusher pick up the new batch size and interval */
+        pthread_mutex_lock (&priv->heat.lock);
+        {
+                pthread_cond_signal (&priv->heat.cond);
+        }
+        pthread_mutex_unlock (&priv->heat.lock);
+
 
 
 
@@ -2211,6 +2257,9 @@ init (xlator_t *this)
                                 CTR_DEFAULT_HARDLINK_EXP_PERIOD;
         priv->ctr_lookupheal_inode_timeout =
                                 CTR_DEFAULT_INODE_EXP_PERIOD;
+        priv->heat.batch_size          = CTR_DEFAULT_HEAT_BATCH_SIZE;
+        priv->heat.flush_interval      = CTR_DEFAULT_HEAT_FLUSH_INTERVAL;
+        priv->heat.max_backlog         = CTR_DEFAULT_HEAT_MAX_BACKLOG;
 
         /* For compaction */
         priv->compact_active = _gf_false;
@@ -2268,6 +2317,15 @@ init (xlator_t *this)
                         goto error;
         }
 
+        /*Start batching heat of inode fops*/
+        ret_db = ctr_heat_init (this, &priv->heat);
+        if (ret_db) {
+                gf_msg (this->name, GF_LOG_ERROR, 0,
+                        CTR_MSG_FATAL_ERROR,
+                        "FATAL: Failed initializing heat table");
+                goto error;
+        }
+
 
         ret_db = 0;
         goto out;
@@ -2279,6 +2337,8 @@ error:
                 mem_pool_destroy (this->local_pool);
 
         if (priv) {
+                if (priv->_db_conn)
+                        fini_db (priv->_db_conn);
                 GF_FREE (priv->ctr_db_path);
         }
         GF_FREE (priv);
@@ -2325,6 +2385,8 @@ fini (xlator_t *this)
         priv = this->private;
 
         if (priv) {
+                /* write out the heat still held in memory */
+                ctr_heat_fini (this, &priv->heat);
                 if (fini_db (priv->_db_conn)) {
                         gf_msg (this->name, GF_LOG_WARNING, 0,
                                 CTR_MSG_CLOSE_DB_CONN_FAILED, "Failed closing "
@@ -2371,6 +2433,10 @@ struct xlator_cbks cbks = {
         .forget = ctr_forget
 };
 
+struct xlator_dumpops dumpops = {
+        .priv = ctr_priv_dump,
+};
+
 struct volume_options options[] = {
         { .key  = {"ctr-enabled",},
           .type = GF_OPTION_TYPE_BOOL,
@@ -2411,6 +2477,34 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_INT,
           .default_value = "300"
         },
+        { .key  = {"ctr-heat-batch-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 1048576,
+          .default_value = "4096",
+          .description = "Number of files whose heat is gathered in memory "
+                         "before it is written to the database in a single "
+                         "transaction. 0 writes the heat of every fop "
+                         "synchronously."
+        },
+        { .key  = {"ctr-heat-flush-interval"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 10,
+          .max  = 600000,
+          .default_value = "1000",
+          .description = "Milliseconds after which heat gathered in memory is "
+                         "written to the database, even if fewer files than "
+                         "ctr-heat-batch-size are pending."
+        },
+        { .key  = {"ctr-heat-max-backlog"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 16777216,
+          .default_value = "262144",
+          .description = "Number of files whose heat may wait for the "
+                         "database. Heat of further files is dropped and "
+                         "counted until the backlog drains. 0 for no limit."
+        },
         { .key  = {"hot-brick"},
           .type = GF_OPTION_TYPE_BOOL,
           .value = {"on", "off"},
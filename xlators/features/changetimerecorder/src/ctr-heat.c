@@ -0,0 +1,348 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include "ctr-heat.h"
+#include "ctr-helper.h"
+#include "ctr-messages.h"
+#include "statedump.h"
+
+static inline uint32_t
+ctr_heat_hash (uuid_t gfid)
+{
+        /* gfids are random, their tail is as good a hash as any */
+        return (gfid[12] << 24) | (gfid[13] << 16) | (gfid[14] << 8) |
+                gfid[15];
+}
+
+static inline void
+ctr_heat_time_merge (gfdb_time_t *dst, gfdb_time_t *src)
+{
+        if (timercmp (src, dst, >))
+                *dst = *src;
+}
+
+static ctr_heat_entry_t *
+__ctr_heat_entry_get (struct list_head *bucket, uuid_t gfid)
+{
+        ctr_heat_entry_t *entry = NULL;
+
+        list_for_each_entry (entry, bucket, hash) {
+                if (gf_uuid_compare (entry->record.gfid, gfid) == 0)
+                        return entry;
+        }
+
+        return NULL;
+}
+
+/* Folds the times and counters of one fop into the heat of its file. This
+ * is what gf_sql_insert_wind/gf_sql_insert_unwind would have written for an
+ * inode fop, only deferred to the flusher. */
+int
+ctr_heat_record (xlator_t *this, ctr_heat_table_t *heat,
+                 gfdb_db_record_t *db_record)
+{
+        ctr_heat_stripe_t *stripe  = NULL;
+        struct list_head  *bucket  = NULL;
+        ctr_heat_entry_t  *entry   = NULL;
+        gfdb_time_t       *src     = NULL;
+        gfdb_time_t       *dst     = NULL;
+        gf_boolean_t       wind    = _gf_false;
+        gf_boolean_t       read    = _gf_false;
+        gf_boolean_t       wakeup  = _gf_false;
+        uint32_t           hash    = 0;
+        int64_t            backlog = 0;
+
+        wind = iswindpath (db_record->gfdb_fop_path);
+        read = isreadfop (db_record->gfdb_fop_type);
+
+        if (!db_record->do_record_times)
+                return 0;
+        if (!wind && !db_record->do_record_uwind_time)
+                return 0;
+
+        if (wind) {
+                src = &db_record->gfdb_wind_change_time;
+        } else {
+                src = &db_record->gfdb_unwind_change_time;
+        }
+
+        hash = ctr_heat_hash (db_record->gfid);
+        stripe = &heat->stripes[hash % CTR_HEAT_STRIPES];
+        bucket = &stripe->buckets[(hash / CTR_HEAT_STRIPES) %
+                                  CTR_HEAT_STRIPE_BUCKETS];
+
+        LOCK (&stripe->lock);
+        {
+                entry = __ctr_heat_entry_get (bucket, db_record->gfid);
+                if (entry) {
+                        GF_ATOMIC_INC (heat->merged);
+                } else {
+                        if (heat->max_backlog &&
+                            GF_ATOMIC_GET (heat->backlog) >=
+                            heat->max_backlog) {
+                                UNLOCK (&stripe->lock);
+                                GF_ATOMIC_INC (heat->dropped);
+                                return 0;
+                        }
+
+                        entry = GF_CALLOC (1, sizeof (*entry),
+                                           gf_ctr_mt_heat_entry_t);
+                        if (!entry) {
+                                UNLOCK (&stripe->lock);
+                                GF_ATOMIC_INC (heat->dropped);
+                                return -1;
+                        }
+                        gf_uuid_copy (entry->record.gfid, db_record->gfid);
+                        list_add (&entry->hash, bucket);
+                        list_add_tail (&entry->list, &stripe->entries);
+                        backlog = GF_ATOMIC_INC (heat->backlog);
+                        wakeup = (backlog == heat->batch_size);
+                }
+
+                if (read) {
+                        dst = wind ? &entry->record.read_wind_time
+                                   : &entry->record.read_unwind_time;
+                } else {
+                        dst = wind ? &entry->record.write_wind_time
+                                   : &entry->record.write_unwind_time;
+                }
+                ctr_heat_time_merge (dst, src);
+
+                /* counters are only bumped on the way down, as the
+                 * synchronous path does */
+                if (wind && db_record->do_record_counters) {
+                        if (read)
+                                entry->record.read_freq++;
+                        else
+                                entry->record.write_freq++;
+                }
+        }
+        UNLOCK (&stripe->lock);
+
+        if (wakeup) {
+                pthread_mutex_lock (&heat->lock);
+                {
+                        pthread_cond_signal (&heat->cond);
+                }
+                pthread_mutex_unlock (&heat->lock);
+        }
+
+        return 0;
+}
+
+/* Takes every pending entry out of the table and writes them in one
+ * transaction. Fops keep folding into fresh entries meanwhile. */
+int
+ctr_heat_flush (xlator_t *this, ctr_heat_table_t *heat)
+{
+        gf_ctr_private_t   *priv    = NULL;
+        ctr_heat_stripe_t  *stripe  = NULL;
+        ctr_heat_entry_t   *entry   = NULL;
+        ctr_heat_entry_t   *tmp     = NULL;
+        gfdb_heat_record_t *records = NULL;
+        struct list_head    pending;
+        int                 count   = 0;
+        int                 i       = 0;
+        int                 ret     = 0;
+
+        priv = this->private;
+        INIT_LIST_HEAD (&pending);
+
+        pthread_mutex_lock (&heat->db_lock);
+
+        for (i = 0; i < CTR_HEAT_STRIPES; i++) {
+                stripe = &heat->stripes[i];
+
+                LOCK (&stripe->lock);
+                {
+                        list_for_each_entry (entry, &stripe->entries, list) {
+                                list_del_init (&entry->hash);
+                                count++;
+                        }
+                        list_splice_init (&stripe->entries, &pending);
+                }
+                UNLOCK (&stripe->lock);
+        }
+
+        if (!count)
+                goto unlock;
+
+        GF_ATOMIC_SUB (heat->backlog, count);
+
+        records = GF_MALLOC (count * sizeof (*records),
+                             gf_ctr_mt_heat_record_t);
+        i = 0;
+        list_for_each_entry_safe (entry, tmp, &pending, list) {
+                if (records)
+                        records[i++] = entry->record;
+                list_del (&entry->list);
+                GF_FREE (entry);
+        }
+
+        if (!records) {
+                GF_ATOMIC_ADD (heat->dropped, count);
+                ret = -1;
+                goto unlock;
+        }
+
+        ret = insert_heat_records (priv->_db_conn, records, count);
+        if (ret) {
+                gf_msg (this->name, GF_LOG_ERROR, 0,
+                        CTR_MSG_HEAT_FLUSH_FAILED, "Failed writing the heat "
+                        "of %d files to the database", count);
+                GF_ATOMIC_ADD (heat->dropped, count);
+        } else {
+                GF_ATOMIC_ADD (heat->flushed, count);
+        }
+        heat->batches++;
+
+unlock:
+        pthread_mutex_unlock (&heat->db_lock);
+        GF_FREE (records);
+        return ret;
+}
+
+static void *
+ctr_heat_flusher (void *data)
+{
+        xlator_t         *this     = data;
+        gf_ctr_private_t *priv     = NULL;
+        ctr_heat_table_t *heat     = NULL;
+        struct timeval    now      = {0, };
+        struct timespec   deadline = {0, };
+        uint64_t          usec     = 0;
+
+        THIS = this;
+        priv = this->private;
+        heat = &priv->heat;
+
+        pthread_mutex_lock (&heat->lock);
+        while (!heat->fini) {
+                if (GF_ATOMIC_GET (heat->backlog) < heat->batch_size ||
+                    !heat->batch_size) {
+                        gettimeofday (&now, NULL);
+                        usec = now.tv_usec +
+                                (uint64_t)heat->flush_interval * 1000;
+                        deadline.tv_sec = now.tv_sec + usec / 1000000;
+                        deadline.tv_nsec = (usec % 1000000) * 1000;
+                        pthread_cond_timedwait (&heat->cond, &heat->lock,
+                                                &deadline);
+                        if (heat->fini)
+                                break;
+                }
+                pthread_mutex_unlock (&heat->lock);
+
+                ctr_heat_flush (this, heat);
+
+                pthread_mutex_lock (&heat->lock);
+        }
+        pthread_mutex_unlock (&heat->lock);
+
+        return NULL;
+}
+
+int
+ctr_heat_init (xlator_t *this, ctr_heat_table_t *heat)
+{
+        ctr_heat_stripe_t *stripe = NULL;
+        int                i      = 0;
+        int                j      = 0;
+        int                ret    = -1;
+
+        heat->stripes = GF_CALLOC (CTR_HEAT_STRIPES, sizeof (*heat->stripes),
+                                   gf_ctr_mt_heat_stripe_t);
+        if (!heat->stripes)
+                goto out;
+
+        for (i = 0; i < CTR_HEAT_STRIPES; i++) {
+                stripe = &heat->stripes[i];
+                LOCK_INIT (&stripe->lock);
+                INIT_LIST_HEAD (&stripe->entries);
+                for (j = 0; j < CTR_HEAT_STRIPE_BUCKETS; j++)
+                        INIT_LIST_HEAD (&stripe->buckets[j]);
+        }
+
+        GF_ATOMIC_INIT (heat->backlog, 0);
+        GF_ATOMIC_INIT (heat->merged, 0);
+        GF_ATOMIC_INIT (heat->flushed, 0);
+        GF_ATOMIC_INIT (heat->dropped, 0);
+
+        pthread_mutex_init (&heat->db_lock, NULL);
+        pthread_mutex_init (&heat->lock, NULL);
+        pthread_cond_init (&heat->cond, NULL);
+
+        ret = gf_thread_create (&heat->flusher, NULL, ctr_heat_flusher, this);
+        if (ret) {
+                gf_msg (this->name, GF_LOG_ERROR, errno,
+                        CTR_MSG_HEAT_FLUSHER_FAILED, "Failed to start the "
+                        "heat flusher thread");
+                pthread_cond_destroy (&heat->cond);
+                pthread_mutex_destroy (&heat->lock);
+                pthread_mutex_destroy (&heat->db_lock);
+                GF_FREE (heat->stripes);
+                heat->stripes = NULL;
+                goto out;
+        }
+        heat->flusher_running = _gf_true;
+
+        ret = 0;
+out:
+        return ret;
+}
+
+/* Stops the flusher and writes whatever is still pending */
+void
+ctr_heat_fini (xlator_t *this, ctr_heat_table_t *heat)
+{
+        int i = 0;
+
+        if (!heat->stripes)
+                return;
+
+        if (heat->flusher_running) {
+                pthread_mutex_lock (&heat->lock);
+                {
+                        heat->fini = _gf_true;
+                        pthread_cond_signal (&heat->cond);
+                }
+                pthread_mutex_unlock (&heat->lock);
+                pthread_join (heat->flusher, NULL);
+                heat->flusher_running = _gf_false;
+        }
+
+        ctr_heat_flush (this, heat);
+
+        for (i = 0; i < CTR_HEAT_STRIPES; i++)
+                LOCK_DESTROY (&heat->stripes[i].lock);
+
+        pthread_cond_destroy (&heat->cond);
+        pthread_mutex_destroy (&heat->lock);
+        pthread_mutex_destroy (&heat->db_lock);
+        GF_FREE (heat->stripes);
+        heat->stripes = NULL;
+}
+
+void
+ctr_heat_dump (xlator_t *this, ctr_heat_table_t *heat)
+{
+        gf_proc_dump_write ("heat-batch-size", "%u", heat->batch_size);
+        gf_proc_dump_write ("heat-flush-interval", "%u",
+                            heat->flush_interval);
+        gf_proc_dump_write ("heat-max-backlog", "%u", heat->max_backlog);
+        gf_proc_dump_write ("heat-backlog", "%"PRId64,
+                            GF_ATOMIC_GET (heat->backlog));
+        gf_proc_dump_write ("heat-merged", "%"PRId64,
+                            GF_ATOMIC_GET (heat->merged));
+        gf_proc_dump_write ("heat-flushed", "%"PRId64,
+                            GF_ATOMIC_GET (heat->flushed));
+        gf_proc_dump_write ("heat-dropped", "%"PRId64,
+                            GF_ATOMIC_GET (heat->dropped));
+        gf_proc_dump_write ("heat-batches", "%"PRIu64, heat->batches);
+}
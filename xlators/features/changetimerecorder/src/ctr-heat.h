@@ -0,0 +1,90 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef __CTR_HEAT_H
+#define __CTR_HEAT_H
+
+#include "xlator.h"
+#include "ctr_mem_types.h"
+#include "glusterfs.h"
+#include "locking.h"
+#include "atomic.h"
+#include "list.h"
+#include "gfdb_data_store.h"
+#include <pthread.h>
+
+/* The heat table is split in stripes, each behind its own lock, so that
+ * fops on different files seldom contend */
+#define CTR_HEAT_STRIPES                64
+#define CTR_HEAT_STRIPE_BUCKETS         64
+
+#define CTR_DEFAULT_HEAT_BATCH_SIZE     4096
+#define CTR_DEFAULT_HEAT_FLUSH_INTERVAL 1000    /* msec */
+#define CTR_DEFAULT_HEAT_MAX_BACKLOG    262144
+
+typedef struct ctr_heat_entry {
+        struct list_head        hash;   /* in a stripe bucket */
+        struct list_head        list;   /* in the stripe's entries */
+        gfdb_heat_record_t      record;
+} ctr_heat_entry_t;
+
+typedef struct ctr_heat_stripe {
+        gf_lock_t               lock;
+        struct list_head        buckets[CTR_HEAT_STRIPE_BUCKETS];
+        struct list_head        entries;
+} ctr_heat_stripe_t;
+
+/*
+ * Heat of inode fops is folded into this table in the fop path and written
+ * to the database by the flusher thread, in one transaction per batch, once
+ * batch_size files are pending or every flush_interval msecs. Dentry fops
+ * still go to the database synchronously as they carry the link records.
+ *
+ * backlog : files whose heat is waiting to be written
+ * merged  : fops folded into a file already in the table
+ * flushed : files written to the database
+ * dropped : fops not recorded because max_backlog files were pending
+ * */
+typedef struct ctr_heat_table {
+        ctr_heat_stripe_t       *stripes;
+        uint32_t                batch_size;
+        uint32_t                flush_interval;
+        uint32_t                max_backlog;
+        gf_atomic_t             backlog;
+        gf_atomic_t             merged;
+        gf_atomic_t             flushed;
+        gf_atomic_t             dropped;
+        uint64_t                batches;
+        /* serialises batches against each other and against compaction */
+        pthread_mutex_t         db_lock;
+        pthread_mutex_t         lock;
+        pthread_cond_t          cond;
+        pthread_t               flusher;
+        gf_boolean_t            flusher_running;
+        gf_boolean_t            fini;
+} ctr_heat_table_t;
+
+int
+ctr_heat_init (xlator_t *this, ctr_heat_table_t *heat);
+
+void
+ctr_heat_fini (xlator_t *this, ctr_heat_table_t *heat);
+
+int
+ctr_heat_record (xlator_t *this, ctr_heat_table_t *heat,
+                 gfdb_db_record_t *db_record);
+
+int
+ctr_heat_flush (xlator_t *this, ctr_heat_table_t *heat);
+
+void
+ctr_heat_dump (xlator_t *this, ctr_heat_table_t *heat);
+
+#endif
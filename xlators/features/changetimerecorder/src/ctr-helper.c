@@ -294,6 +294,14 @@ int extract_ctr_options (xlator_t *this, gf_ctr_private_t *_priv) {
                         _priv->ctr_lookupheal_link_timeout,
                         uint64, out);
 
+        /*Extract heat batching options*/
+        GF_OPTION_INIT ("ctr-heat-batch-size", _priv->heat.batch_size,
+                        uint32, out);
+        GF_OPTION_INIT ("ctr-heat-flush-interval", _priv->heat.flush_interval,
+                        uint32, out);
+        GF_OPTION_INIT ("ctr-heat-max-backlog", _priv->heat.max_backlog,
+                        uint32, out);
+
         /*Extract flag for hot tier brick*/
         GF_OPTION_INIT ("hot-brick", _priv->ctr_hot_brick, bool, out);
 
@@ -26,6 +26,7 @@
 
 #include "gfdb_data_store.h"
 #include "ctr-xlator-ctx.h"
+#include "ctr-heat.h"
 #include "ctr-messages.h"
 
 #define CTR_DEFAULT_HARDLINK_EXP_PERIOD 300  /* Five mins */
@@ -56,6 +57,7 @@ typedef struct gf_ctr_private {
         gf_boolean_t                    compact_active;
         gf_boolean_t                    compact_mode_switched;
         pthread_mutex_t                 compact_lock;
+        ctr_heat_table_t                heat;
 } gf_ctr_private_t;
 
 
@@ -425,6 +427,13 @@ do {\
                 goto label;\
  } while (0)
 
+/*
+ * Heat of inode fops goes to the heat table, unless batching is off.
+ * Dentry fops always carry link records and are written synchronously.
+ * */
+#define CTR_HEAT_IS_BATCHED(_priv, fop_type)\
+        ((_priv)->heat.batch_size && !isdentryfop (fop_type))
+
 int
 fill_db_record_for_unwind (xlator_t              *this,
                           gf_ctr_local_t        *ctr_local,
@@ -532,9 +541,13 @@ ctr_insert_wind (call_frame_t                    *frame,
                         goto out;
                 }
 
-                /*Insert the db record*/
-                ret = insert_record (_priv->_db_conn,
-                                &ctr_local->gfdb_db_record);
+                /*Insert the db record, heat of inode fops is batched*/
+                if (CTR_HEAT_IS_BATCHED (_priv, ctr_inode_cx->fop_type))
+                        ret = ctr_heat_record (this, &_priv->heat,
+                                               &ctr_local->gfdb_db_record);
+                else
+                        ret = insert_record (_priv->_db_conn,
+                                             &ctr_local->gfdb_db_record);
                 if (ret) {
                         gf_msg (this->name, GF_LOG_ERROR, 0,
                                 CTR_MSG_INSERT_RECORD_WIND_FAILED,
@@ -599,8 +612,12 @@ ctr_insert_unwind (call_frame_t          *frame,
                         goto out;
                 }
 
-                ret = insert_record(_priv->_db_conn,
-                                        &ctr_local->gfdb_db_record);
+                if (CTR_HEAT_IS_BATCHED (_priv, fop_type))
+                        ret = ctr_heat_record (this, &_priv->heat,
+                                               &ctr_local->gfdb_db_record);
+                else
+                        ret = insert_record (_priv->_db_conn,
+                                             &ctr_local->gfdb_db_record);
                 if (ret == -1) {
                         gf_msg(this->name, GF_LOG_ERROR, 0,
                                CTR_MSG_FILL_CTR_LOCAL_ERROR_UNWIND,
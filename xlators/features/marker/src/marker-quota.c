@@ -16,6 +16,7 @@
 #include "marker-quota.h"
 #include "marker-quota-helper.h"
 #include "syncop.h"
+#include "timer.h"
 #include "quota-common-utils.h"
 
 int
@@ -1690,6 +1691,530 @@ out:
         return 0;
 }
 
+/**
+ * With quota-update-delay set, the size updates of the fops are not
+ * propagated one by one: the inodes are queued and, once the delay is
+ * over, their contributions are updated all together under a single lock
+ * of each parent, which gets its size updated (and is marked dirty) once
+ * for all of them, and is queued in turn. A directory on the way to the
+ * root thus gets a single update per batch instead of one per fop.
+ *
+ * Contributions and sizes are updated on disk the same way as by
+ * mq_initiate_quota_task(). A parent is marked dirty on disk when the
+ * first of its children is queued, and stays so until the batch has
+ * updated its size: if the brick goes down with updates queued, the size
+ * of the parent is fixed up from the contributions when it is looked up
+ * (c.f. mq_update_dirty_inode_task()), as after an interrupted txn.
+ */
+
+/* Take a hold on the parent of @update being dirty, returns whether it is
+ * the first one, which is to mark it so. */
+static gf_boolean_t
+mq_hold_dirty (quota_inode_ctx_t *parent_ctx, quota_update_t *update)
+{
+        gf_boolean_t first = _gf_false;
+
+        LOCK (&parent_ctx->lock);
+        {
+                first = (parent_ctx->batched++ == 0);
+        }
+        UNLOCK (&parent_ctx->lock);
+
+        update->held = _gf_true;
+        return first;
+}
+
+/* Drop the hold of @update on its parent being dirty, returns whether it
+ * was the last one and the parent was marked dirty for the batch, which is
+ * then to clear it once its size is updated. */
+static gf_boolean_t
+mq_put_dirty (xlator_t *this, quota_update_t *update)
+{
+        gf_boolean_t       last       = _gf_false;
+        quota_inode_ctx_t *parent_ctx = NULL;
+
+        if (!update->held)
+                goto out;
+        update->held = _gf_false;
+
+        if (mq_inode_ctx_get (update->loc.parent, this, &parent_ctx) < 0)
+                goto out;
+
+        LOCK (&parent_ctx->lock);
+        {
+                if (--parent_ctx->batched == 0) {
+                        last = parent_ctx->batch_dirty;
+                        parent_ctx->batch_dirty = _gf_false;
+                }
+        }
+        UNLOCK (&parent_ctx->lock);
+
+out:
+        return last;
+}
+
+static gf_boolean_t
+mq_ctx_batched (quota_inode_ctx_t *ctx)
+{
+        gf_boolean_t batched = _gf_false;
+
+        LOCK (&ctx->lock);
+        {
+                batched = (ctx->batched > 0);
+        }
+        UNLOCK (&ctx->lock);
+
+        return batched;
+}
+
+static void
+mq_free_update (xlator_t *this, quota_update_t *update)
+{
+        quota_inode_ctx_t *ctx = NULL;
+
+        if (mq_inode_ctx_get (update->loc.inode, this, &ctx) == 0)
+                mq_set_ctx_updation_status (ctx, _gf_false);
+
+        /* a parent left dirty is fixed up at its next lookup */
+        mq_put_dirty (this, update);
+
+        if (update->contri)
+                GF_REF_PUT (update->contri);
+
+        loc_wipe (&update->loc);
+        GF_FREE (update);
+}
+
+static quota_update_t *
+mq_new_update (loc_t *loc)
+{
+        int32_t          ret    = -1;
+        quota_update_t  *update = NULL;
+
+        QUOTA_ALLOC_OR_GOTO (update, quota_update_t, ret, out);
+        INIT_LIST_HEAD (&update->list);
+
+        ret = mq_loc_copy (&update->loc, loc);
+        if (ret < 0) {
+                GF_FREE (update);
+                update = NULL;
+        }
+
+out:
+        return update;
+}
+
+/**
+ * Update the contributions of the inodes in @group, which have the same
+ * parent, and the size of the parent by their sum. The parent is queued
+ * in @next if its size changed.
+ */
+static void
+mq_update_batch (xlator_t *this, struct list_head *group,
+                 struct list_head *next)
+{
+        int32_t                ret        = -1;
+        int32_t                prev_dirty = 0;
+        gf_boolean_t           locked     = _gf_false;
+        gf_boolean_t           dirty      = _gf_false;
+        gf_boolean_t           status     = _gf_true;
+        gf_boolean_t           settled    = _gf_false;
+        gf_boolean_t           clear      = _gf_false;
+        loc_t                  parent_loc = {0,};
+        quota_meta_t           sum        = {0,};
+        quota_update_t        *update     = NULL;
+        quota_update_t        *parent     = NULL;
+        quota_inode_ctx_t     *ctx        = NULL;
+        quota_inode_ctx_t     *parent_ctx = NULL;
+        inode_contribution_t  *contri     = NULL;
+        inode_t               *tmp_parent = NULL;
+
+        update = list_first_entry (group, quota_update_t, list);
+
+        ret = mq_inode_loc_fill (NULL, update->loc.parent, &parent_loc);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "parent_loc fill "
+                        "failed for child inode %s: ",
+                        uuid_utoa (update->loc.inode->gfid));
+                goto out;
+        }
+
+        ret = mq_lock (this, &parent_loc, F_WRLCK);
+        if (ret < 0)
+                goto out;
+        locked = _gf_true;
+
+        list_for_each_entry (update, group, list) {
+                ret = mq_inode_ctx_get (update->loc.inode, this, &ctx);
+                if (ret < 0)
+                        continue;
+
+                /* fops from now on need another update */
+                mq_set_ctx_updation_status (ctx, _gf_false);
+
+                /* c.f. mq_initiate_quota_task() for when there is no
+                 * contribution node yet */
+                contri = mq_get_contribution_node (update->loc.parent, ctx);
+                if (contri == NULL) {
+                        tmp_parent = inode_parent (update->loc.inode, 0,
+                                                   NULL);
+                        if (tmp_parent == NULL)
+                                continue;
+
+                        ret = gf_uuid_compare (tmp_parent->gfid,
+                                               parent_loc.gfid);
+                        inode_unref (tmp_parent);
+                        tmp_parent = NULL;
+                        if (ret)
+                                continue;
+
+                        contri = mq_add_new_contribution_node
+                                                (this, ctx, &update->loc);
+                        if (contri == NULL) {
+                                gf_log (this->name, GF_LOG_ERROR, "Failed to "
+                                        "create contribution node for %s",
+                                        update->loc.path);
+                                continue;
+                        }
+                }
+                update->contri = contri;
+
+                ret = mq_get_delta (this, &update->loc, &update->delta, ctx,
+                                    contri);
+                if (ret < 0 || quota_meta_is_null (&update->delta)) {
+                        memset (&update->delta, 0, sizeof (update->delta));
+                        continue;
+                }
+
+                if (!dirty) {
+                        ret = mq_get_set_dirty (this, &parent_loc, 1,
+                                                &prev_dirty);
+                        if (ret < 0)
+                                goto out;
+                        dirty = _gf_true;
+                }
+
+                ret = mq_update_contri (this, &update->loc, contri,
+                                        &update->delta);
+                if (ret < 0) {
+                        memset (&update->delta, 0, sizeof (update->delta));
+                        continue;
+                }
+
+                mq_add_meta (&sum, &update->delta);
+        }
+
+        ret = 0;
+        if (!dirty) {
+                settled = _gf_true;
+                goto out;
+        }
+
+        ret = mq_update_size (this, &parent_loc, &sum);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_DEBUG, "rollback "
+                        "contri updation");
+                list_for_each_entry (update, group, list) {
+                        if (quota_meta_is_null (&update->delta))
+                                continue;
+                        mq_sub_meta (&update->delta, NULL);
+                        mq_update_contri (this, &update->loc, update->contri,
+                                          &update->delta);
+                }
+                goto out;
+        }
+        settled = _gf_true;
+
+        if (prev_dirty == 0) {
+                ret = mq_mark_dirty (this, &parent_loc, 0);
+        } else {
+                ret = mq_inode_ctx_get (parent_loc.inode, this, &parent_ctx);
+                if (ret == 0)
+                        mq_set_ctx_dirty_status (parent_ctx, _gf_false);
+        }
+        dirty = _gf_false;
+        prev_dirty = 0;
+
+        if (quota_meta_is_null (&sum) || __is_root_gfid (parent_loc.gfid))
+                goto out;
+
+        ret = mq_inode_ctx_get (parent_loc.inode, this, &parent_ctx);
+        if (ret < 0)
+                goto out;
+
+        /* already queued, or being updated by a txn of its own */
+        ret = mq_test_and_set_ctx_updation_status (parent_ctx, &status);
+        if (ret < 0 || status == _gf_true)
+                goto out;
+
+        parent = mq_new_update (&parent_loc);
+        if (parent == NULL) {
+                mq_set_ctx_updation_status (parent_ctx, _gf_false);
+                goto out;
+        }
+        list_add_tail (&parent->list, next);
+
+out:
+        if (dirty) {
+                /* c.f. mq_initiate_quota_task() */
+                ret = mq_inode_ctx_get (parent_loc.inode, this, &parent_ctx);
+                if (ret == 0)
+                        mq_set_ctx_dirty_status (parent_ctx, _gf_false);
+        }
+
+        /* the parent was marked dirty when the group was queued, it is
+         * left so for its next lookup if its size could not be updated */
+        list_for_each_entry (update, group, list) {
+                if (mq_put_dirty (this, update))
+                        clear = _gf_true;
+        }
+        if (clear && settled)
+                mq_mark_dirty (this, &parent_loc, 0);
+
+        if (locked)
+                mq_lock (this, &parent_loc, F_UNLCK);
+
+        loc_wipe (&parent_loc);
+}
+
+static int
+mq_flush_updates_task (void *opaque)
+{
+        int32_t           ret    = 0;
+        xlator_t         *this   = NULL;
+        marker_conf_t    *priv   = NULL;
+        quota_update_t   *update = NULL;
+        quota_update_t   *tmp    = NULL;
+        inode_t          *parent = NULL;
+        struct list_head  batch;
+        struct list_head  group;
+        struct list_head  next;
+
+        this = opaque;
+        THIS = this;
+        priv = this->private;
+
+        INIT_LIST_HEAD (&batch);
+        INIT_LIST_HEAD (&group);
+        INIT_LIST_HEAD (&next);
+
+        LOCK (&priv->lock);
+        {
+                list_splice_init (&priv->quota_updates, &batch);
+        }
+        UNLOCK (&priv->lock);
+
+        /* one level of the tree after another, parents of the inodes
+         * updated are updated in the same flush */
+        while (!list_empty (&batch)) {
+                list_for_each_entry_safe (update, tmp, &batch, list) {
+                        if (update->loc.parent)
+                                continue;
+
+                        ret = mq_build_ancestry (this, &update->loc);
+                        if (ret < 0 || update->loc.parent == NULL) {
+                                gf_log (this->name,
+                                        (-ret == ENOENT || -ret == ESTALE)
+                                        ? GF_LOG_DEBUG:GF_LOG_ERROR,
+                                        "build ancestry failed for inode %s",
+                                        uuid_utoa (update->loc.inode->gfid));
+                                list_del_init (&update->list);
+                                mq_free_update (this, update);
+                        }
+                }
+
+                while (!list_empty (&batch)) {
+                        update = list_first_entry (&batch, quota_update_t,
+                                                   list);
+                        parent = update->loc.parent;
+
+                        list_for_each_entry_safe (update, tmp, &batch, list) {
+                                if (update->loc.parent == parent)
+                                        list_move_tail (&update->list,
+                                                        &group);
+                        }
+
+                        mq_update_batch (this, &group, &next);
+
+                        list_for_each_entry_safe (update, tmp, &group, list) {
+                                list_del_init (&update->list);
+                                mq_free_update (this, update);
+                        }
+                }
+
+                list_splice_init (&next, &batch);
+        }
+
+        return 0;
+}
+
+static void
+mq_flush_updates (void *data)
+{
+        int32_t        ret   = -1;
+        xlator_t      *this  = data;
+        marker_conf_t *priv  = NULL;
+
+        THIS = this;
+        priv = this->private;
+
+        /* updates queued from now on are flushed after another delay */
+        LOCK (&priv->lock);
+        {
+                priv->quota_update_timer = NULL;
+        }
+        UNLOCK (&priv->lock);
+
+        ret = synctask_new1 (this->ctx->env, 1024 * 16, mq_flush_updates_task,
+                             NULL, NULL, this);
+        if (ret)
+                gf_log (this->name, GF_LOG_ERROR, "Failed to spawn "
+                        "new synctask, quota updates are delayed till "
+                        "the next one");
+}
+
+static int32_t
+mq_queue_update (xlator_t *this, quota_update_t *update)
+{
+        int32_t          ret    = -1;
+        marker_conf_t   *priv   = NULL;
+        struct timespec  delay  = {0,};
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                if (priv->quota_update_timer == NULL) {
+                        delay.tv_sec = priv->quota_update_delay / 1000;
+                        delay.tv_nsec = (priv->quota_update_delay % 1000)
+                                        * 1000000;
+                        priv->quota_update_timer = gf_timer_call_after
+                                (this->ctx, delay, mq_flush_updates, this);
+                }
+
+                if (priv->quota_update_timer) {
+                        list_add_tail (&update->list, &priv->quota_updates);
+                        ret = 0;
+                }
+        }
+        UNLOCK (&priv->lock);
+
+        return ret;
+}
+
+/**
+ * Queue the update of @args->loc for the next batch, with its parent marked
+ * dirty if it is the first child of it queued. Updated at once if it can't
+ * be queued.
+ */
+static int
+mq_queue_update_task (void *opaque)
+{
+        int32_t             ret        = -1;
+        int32_t             prev_dirty = 0;
+        gf_boolean_t        locked     = _gf_false;
+        loc_t               parent_loc = {0,};
+        quota_synctask_t   *args       = NULL;
+        xlator_t           *this       = NULL;
+        quota_update_t     *update     = NULL;
+        quota_inode_ctx_t  *parent_ctx = NULL;
+
+        GF_VALIDATE_OR_GOTO ("marker", opaque, out);
+
+        args = (quota_synctask_t *) opaque;
+        this = args->this;
+        THIS = this;
+
+        update = mq_new_update (&args->loc);
+        if (update == NULL)
+                goto out;
+
+        if (update->loc.parent == NULL) {
+                ret = mq_build_ancestry (this, &update->loc);
+                if (ret < 0 || update->loc.parent == NULL) {
+                        ret = -1;
+                        goto out;
+                }
+        }
+
+        ret = mq_inode_loc_fill (NULL, update->loc.parent, &parent_loc);
+        if (ret < 0)
+                goto out;
+
+        ret = mq_inode_ctx_get (parent_loc.inode, this, &parent_ctx);
+        if (ret < 0)
+                goto out;
+
+        /* the batch updates the parent under the same lock */
+        ret = mq_lock (this, &parent_loc, F_WRLCK);
+        if (ret < 0)
+                goto out;
+        locked = _gf_true;
+
+        if (mq_hold_dirty (parent_ctx, update)) {
+                ret = mq_get_set_dirty (this, &parent_loc, 1, &prev_dirty);
+                if (ret < 0)
+                        goto out;
+
+                /* dirty from before is left for its lookup to fix up */
+                LOCK (&parent_ctx->lock);
+                {
+                        parent_ctx->batch_dirty = (prev_dirty == 0);
+                }
+                UNLOCK (&parent_ctx->lock);
+        }
+
+        ret = mq_queue_update (this, update);
+        if (ret == 0)
+                update = NULL;
+
+out:
+        if (update) {
+                if (mq_put_dirty (this, update))
+                        mq_mark_dirty (this, &parent_loc, 0);
+                loc_wipe (&update->loc);
+                GF_FREE (update);
+        }
+
+        if (locked)
+                mq_lock (this, &parent_loc, F_UNLCK);
+
+        loc_wipe (&parent_loc);
+
+        if (ret < 0 && opaque)
+                ret = mq_initiate_quota_task (opaque);
+
+        return ret;
+}
+
+void
+mq_cancel_updates (xlator_t *this)
+{
+        marker_conf_t    *priv   = NULL;
+        quota_update_t   *update = NULL;
+        quota_update_t   *tmp    = NULL;
+        struct list_head  updates;
+
+        priv = this->private;
+        INIT_LIST_HEAD (&updates);
+
+        LOCK (&priv->lock);
+        {
+                if (priv->quota_update_timer) {
+                        gf_timer_call_cancel (this->ctx,
+                                              priv->quota_update_timer);
+                        priv->quota_update_timer = NULL;
+                }
+                list_splice_init (&priv->quota_updates, &updates);
+        }
+        UNLOCK (&priv->lock);
+
+        list_for_each_entry_safe (update, tmp, &updates, list) {
+                list_del_init (&update->list);
+                mq_free_update (this, update);
+        }
+}
+
 int
 _mq_initiate_quota_txn (xlator_t *this, loc_t *origin_loc, struct iatt *buf,
                         gf_boolean_t spawn)
@@ -1698,6 +2223,9 @@ _mq_initiate_quota_txn (xlator_t *this, loc_t *origin_loc, struct iatt *buf,
         quota_inode_ctx_t      *ctx          = NULL;
         gf_boolean_t            status       = _gf_true;
         loc_t                   loc          = {0,};
+        marker_conf_t          *priv         = NULL;
+
+        priv = this->private;
 
         ret = mq_prevalidate_txn (this, origin_loc, &loc, &ctx, buf);
         if (ret < 0)
@@ -1712,7 +2240,10 @@ _mq_initiate_quota_txn (xlator_t *this, loc_t *origin_loc, struct iatt *buf,
         if (ret < 0 || status == _gf_true)
                 goto out;
 
-        ret = mq_synctask (this, mq_initiate_quota_task, spawn, &loc);
+        if (spawn && priv->quota_update_delay)
+                ret = mq_synctask (this, mq_queue_update_task, spawn, &loc);
+        else
+                ret = mq_synctask (this, mq_initiate_quota_task, spawn, &loc);
 
 out:
         if (ret < 0 && status == _gf_false)
@@ -1812,6 +2343,15 @@ mq_update_dirty_inode_task (void *opaque)
                 goto out;
         }
 
+        /* marked dirty for a batch still to come, c.f.
+         * mq_queue_update_task() */
+        if (mq_ctx_batched (ctx)) {
+                mq_set_ctx_dirty_status (ctx, _gf_false);
+                dirty = 0;
+                ret = 0;
+                goto out;
+        }
+
         fd = fd_create (loc->inode, 0);
         if (!fd) {
                 gf_log (this->name, GF_LOG_ERROR, "Failed to create fd");
@@ -2011,7 +2551,10 @@ mq_inspect_directory_xattr (xlator_t *this, quota_inode_ctx_t *ctx,
         mq_compute_delta (&delta, &size, &contri);
 
         if (dirty) {
-                ret = mq_update_dirty_inode_txn (this, loc, ctx);
+                /* left for the batch to clear, c.f.
+                 * mq_queue_update_task() */
+                if (!mq_ctx_batched (ctx))
+                        ret = mq_update_dirty_inode_txn (this, loc, ctx);
                 goto out;
         }
 
@@ -106,6 +106,9 @@ struct quota_inode_ctx {
         gf_boolean_t           create_status;
         gf_boolean_t           updation_status;
         gf_boolean_t           dirty_status;
+        int32_t                batched;     /* queued children holding it
+                                               dirty */
+        gf_boolean_t           batch_dirty; /* marked dirty for them */
         gf_lock_t              lock;
         struct list_head       contribution_head;
 };
@@ -132,6 +135,15 @@ struct inode_contribution {
 };
 typedef struct inode_contribution inode_contribution_t;
 
+struct quota_update {
+        struct list_head      list;
+        loc_t                 loc;
+        inode_contribution_t *contri;
+        quota_meta_t          delta;    /* added to the contribution */
+        gf_boolean_t          held;     /* holds the parent dirty */
+};
+typedef struct quota_update quota_update_t;
+
 int32_t
 mq_req_xattr (xlator_t *, loc_t *, dict_t *, char *, char *);
 
@@ -153,4 +165,7 @@ mq_reduce_parent_size_txn (xlator_t *, loc_t *, quota_meta_t *,
 
 int32_t
 mq_forget (xlator_t *, quota_inode_ctx_t *);
+
+void
+mq_cancel_updates (xlator_t *);
 #endif
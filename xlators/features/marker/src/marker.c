@@ -3289,6 +3289,8 @@ marker_priv_cleanup (xlator_t *this)
 
         marker_xtime_priv_cleanup (this);
 
+        mq_cancel_updates (this);
+
         LOCK_DESTROY (&priv->lock);
 
         GF_FREE (priv);
@@ -3332,6 +3334,12 @@ reconfigure (xlator_t *this, dict_t *options)
         if (data)
                 ret = gf_string2int32 (data->data, &version);
 
+        priv->quota_update_delay = 0;
+        data = dict_get (options, "quota-update-delay");
+        if (data)
+                ret = gf_string2uint32 (data->data,
+                                        &priv->quota_update_delay);
+
         if (priv->feature_enabled) {
                 if (version >= 0)
                         priv->version = version;
@@ -3398,6 +3406,7 @@ init (xlator_t *this)
         priv->version = 0;
 
         LOCK_INIT (&priv->lock);
+        INIT_LIST_HEAD (&priv->quota_updates);
 
         data = dict_get (options, "quota");
         if (data) {
@@ -3417,6 +3426,11 @@ init (xlator_t *this)
         if (data)
                 ret = gf_string2int32 (data->data, &priv->version);
 
+        data = dict_get (options, "quota-update-delay");
+        if (data)
+                ret = gf_string2uint32 (data->data,
+                                        &priv->quota_update_delay);
+
         if (priv->feature_enabled && priv->version < 0) {
                 gf_log (this->name, GF_LOG_ERROR, "Invalid quota version %d",
                         priv->version);
@@ -3520,5 +3534,15 @@ struct volume_options options[] = {
         {.key = {"xtime"}},
         {.key = {"gsync-force-xtime"}},
         {.key = {"quota-version"} },
+        {.key = {"quota-update-delay"},
+         .type = GF_OPTION_TYPE_INT,
+         .default_value = "0",
+         .min = 0,
+         .max = 60000,
+         .description = "Milliseconds during which size updates are "
+                        "gathered before they are propagated up the tree "
+                        "together, with a single update of each directory "
+                        "on the way. 0 propagates each update at once."
+        },
         {.key = {NULL}}
 };
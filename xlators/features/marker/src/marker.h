@@ -15,6 +15,7 @@
 #include "defaults.h"
 #include "compat-uuid.h"
 #include "call-stub.h"
+#include "timer.h"
 
 #define MARKER_XATTR_PREFIX "trusted.glusterfs"
 #define XTIME               "xtime"
@@ -143,6 +144,12 @@ struct marker_conf{
         uint64_t     quota_lk_owner;
         gf_lock_t    lock;
         int32_t      version;
+
+        /* size updates waiting to be propagated in a batch, c.f.
+           mq_flush_updates_task() */
+        uint32_t          quota_update_delay;
+        struct list_head  quota_updates;
+        gf_timer_t       *quota_update_timer;
 };
 typedef struct marker_conf marker_conf_t;
 
@@ -593,6 +593,7 @@ quota_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         quota_inode_ctx_t *ctx        = NULL;
         uint64_t           value      = 0;
         quota_meta_t       size       = {0,};
+        int64_t            lease      = 0;
 
         local = frame->local;
 
@@ -627,6 +628,12 @@ quota_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 op_errno = EINVAL;
         }
 
+        /* a lease left over from before is given up for the new one,
+         * which quotad worked out against the current usage
+         */
+        if (dict_get_int64 (xdata, QUOTA_LEASE_KEY, &lease))
+                lease = 0;
+
         local->just_validated = 1; /* so that we don't go into infinite
                                     * loop of validation and checking
                                     * limit when timeout is zero.
@@ -637,6 +644,10 @@ quota_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 ctx->file_count = size.file_count;
                 ctx->dir_count = size.dir_count;
                 gettimeofday (&ctx->tv, NULL);
+
+                ctx->lease = (lease > 0) ? lease : 0;
+                ctx->lease_granted = ctx->lease;
+                ctx->lease_tv = ctx->tv;
         }
         UNLOCK (&ctx->lock);
 
@@ -952,6 +963,8 @@ quota_validate (call_frame_t *frame, inode_t *inode, xlator_t *this,
         quota_local_t     *local = NULL;
         int                ret   = 0;
         dict_t            *xdata = NULL;
+        quota_inode_ctx_t *ctx   = NULL;
+        int64_t            used  = 0;
         quota_priv_t      *priv  = NULL;
 
         local = frame->local;
@@ -999,6 +1012,40 @@ quota_validate (call_frame_t *frame, inode_t *inode, xlator_t *this,
                 goto err;
         }
 
+        if (priv->lease_size > 0) {
+                ret = quota_inode_ctx_get (inode, this, &ctx, 0);
+                if (ret == 0) {
+                        LOCK (&ctx->lock);
+                        {
+                                used = ctx->lease_granted - ctx->lease;
+                        }
+                        UNLOCK (&ctx->lock);
+                }
+
+                ret = dict_set_int64 (xdata, QUOTA_LEASE_KEY,
+                                      priv->lease_size);
+                if (!ret)
+                        ret = dict_set_int32 (xdata, QUOTA_LEASE_SHARE_KEY,
+                                              priv->lease_share);
+                if (!ret)
+                        ret = dict_set_static_bin (xdata,
+                                                   QUOTA_LEASE_OWNER_KEY,
+                                                   priv->lease_owner,
+                                                   sizeof (uuid_t));
+                if (!ret)
+                        ret = dict_set_int64 (xdata, QUOTA_LEASE_USED_KEY,
+                                              used);
+                if (!ret)
+                        ret = dict_set_int32 (xdata, QUOTA_LEASE_TIMEOUT_KEY,
+                                              priv->lease_timeout);
+                if (ret < 0) {
+                        gf_msg (this->name, GF_LOG_WARNING, ENOMEM,
+                                Q_MSG_ENOMEM, "dict set failed");
+                        ret = -ENOMEM;
+                        goto err;
+                }
+        }
+
         ret = quota_enforcer_lookup (frame, this, xdata, cbk_fn);
         if (ret < 0) {
                 ret = -ENOTCONN;
@@ -1167,6 +1214,7 @@ quota_check_size_limit (call_frame_t *frame, quota_inode_ctx_t *ctx,
         gf_boolean_t    hard_limit_exceeded     =  0;
         int64_t         space_available         =  0;
         int64_t         wouldbe_size            =  0;
+        gf_boolean_t    strict                  =  _gf_false;
 
         GF_ASSERT (frame);
         GF_ASSERT (priv);
@@ -1184,10 +1232,20 @@ quota_check_size_limit (call_frame_t *frame, quota_inode_ctx_t *ctx,
                         if ((ctx->soft_lim >= 0)
                             && (wouldbe_size > ctx->soft_lim)) {
                                 timeout = priv->hard_timeout;
+                                /* hard-timeout 0 asks for every write
+                                 * to be checked, lease or not */
+                                strict = (priv->hard_timeout == 0);
                         }
 
-                        if (!just_validated
-                            && quota_timeout (&ctx->tv, timeout)) {
+                        if ((delta > 0) && (ctx->lease >= delta) && !strict
+                            && !quota_timeout (&ctx->lease_tv,
+                                               priv->lease_timeout)) {
+                                /* quotad set this space aside for us, no
+                                 * need to look any further
+                                 */
+                                ctx->lease -= delta;
+                        } else if (!just_validated
+                                   && quota_timeout (&ctx->tv, timeout)) {
                                 need_validate = 1;
                         } else if (wouldbe_size >= ctx->hard_lim) {
                                 hard_limit_exceeded = 1;
@@ -5084,6 +5142,10 @@ init (xlator_t *this)
                         err);
         GF_OPTION_INIT ("soft-timeout", priv->soft_timeout, time, err);
         GF_OPTION_INIT ("hard-timeout", priv->hard_timeout, time, err);
+        GF_OPTION_INIT ("lease-size", priv->lease_size, size_uint64, err);
+        GF_OPTION_INIT ("lease-timeout", priv->lease_timeout, time, err);
+        GF_OPTION_INIT ("lease-share", priv->lease_share, int32, err);
+        gf_uuid_generate (priv->lease_owner);
         GF_OPTION_INIT ("alert-time", priv->log_timeout, time, err);
         GF_OPTION_INIT ("volume-uuid", priv->volume_uuid, str, err);
 
@@ -5139,6 +5201,12 @@ reconfigure (xlator_t *this, dict_t *options)
                           time, out);
         GF_OPTION_RECONF ("hard-timeout", priv->hard_timeout, options,
                           time, out);
+        GF_OPTION_RECONF ("lease-size", priv->lease_size, options,
+                          size_uint64, out);
+        GF_OPTION_RECONF ("lease-timeout", priv->lease_timeout, options,
+                          time, out);
+        GF_OPTION_RECONF ("lease-share", priv->lease_share, options,
+                          int32, out);
 
         if (quota_on) {
                 priv->rpc_clnt = quota_enforcer_init (this,
@@ -5195,6 +5263,10 @@ quota_priv_dump (xlator_t *this)
         else {
                 gf_proc_dump_write("soft-timeout", "%d", priv->soft_timeout);
                 gf_proc_dump_write("hard-timeout", "%d", priv->hard_timeout);
+                gf_proc_dump_write("lease-size", "%"PRIu64,
+                                   priv->lease_size);
+                gf_proc_dump_write("lease-timeout", "%d",
+                                   priv->lease_timeout);
                 gf_proc_dump_write("alert-time", "%d", priv->log_timeout);
                 gf_proc_dump_write("quota-on", "%d", priv->is_quota_on);
                 gf_proc_dump_write("statfs", "%d", priv->consider_statfs);
@@ -5289,6 +5361,31 @@ struct volume_options options[] = {
                         "hard-timeout indicates the timeout for the validity of"
                         " cache after soft-limit has been crossed."
         },
+        {.key = {"lease-size"},
+         .type = GF_OPTION_TYPE_SIZET,
+         .min = 0,
+         .max = 1 * GF_UNIT_GB,
+         .default_value = "0",
+         .description = "largest space lease quotad is asked for on a "
+                        "directory with a limit. Writes that fit in the "
+                        "lease are let through without revalidating the "
+                        "directory size. Leases shrink as usage gets close "
+                        "to the hard-limit. 0 disables leases."
+        },
+        {.key = {"lease-timeout"},
+         .type = GF_OPTION_TYPE_TIME,
+         .min = 1,
+         .max = 60,
+         .default_value = "5",
+         .description = "time for which a space lease is good."
+        },
+        {.key = {"lease-share"},
+         .type = GF_OPTION_TYPE_INT,
+         .min = 1,
+         .default_value = "1",
+         .description = "number of bricks leasing space of the same "
+                        "directory, each gets this part of what is left."
+        },
         { .key   = {"username"},
           .type  = GF_OPTION_TYPE_ANY,
         },
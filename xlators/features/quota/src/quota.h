@@ -39,6 +39,23 @@
 #define VAL_LENGTH              8
 #define READDIR_BUF             4096
 
+/* Space lease: the enforcer asks quotad for up to QUOTA_LEASE_KEY bytes of
+ * a directory's remaining space, quotad grants its QUOTA_LEASE_SHARE_KEY'th
+ * part of its node's slice of it in QUOTA_LEASE_KEY of the reply. Grants smaller than
+ * QUOTA_LEASE_MIN_SIZE are not worth the accounting and are turned down.
+ * The enforcer names itself in QUOTA_LEASE_OWNER_KEY, and tells how much of
+ * its previous lease it used (QUOTA_LEASE_USED_KEY) and for how long leases
+ * are good (QUOTA_LEASE_TIMEOUT_KEY), for quotad to keep track of what it
+ * granted until it runs out.
+ */
+#define QUOTA_LEASE_KEY         "quota-lease"
+#define QUOTA_LEASE_SHARE_KEY   "quota-lease-share"
+#define QUOTA_LEASE_OWNER_KEY   "quota-lease-owner"
+#define QUOTA_LEASE_USED_KEY    "quota-lease-used"
+#define QUOTA_LEASE_TIMEOUT_KEY "quota-lease-timeout"
+#define QUOTA_LEASE_MIN_SIZE    ((int64_t) (128 * GF_UNIT_KB))
+#define QUOTA_LEASE_BUCKETS     256
+
 #ifndef UUID_CANONICAL_FORM_LEN
 #define UUID_CANONICAL_FORM_LEN 36
 #endif
@@ -170,6 +187,9 @@ struct quota_inode_ctx {
         struct list_head parents;
         struct timeval   tv;
         struct timeval   prev_log;
+        int64_t          lease;       /* bytes left of the space lease */
+        int64_t          lease_granted;
+        struct timeval   lease_tv;
         gf_boolean_t     ancestry_built;
         gf_lock_t        lock;
 };
@@ -230,9 +250,27 @@ struct quota_priv {
         char                  *volume_uuid;
         uint64_t               validation_count;
         int32_t                quotad_conn_status;
+        uint64_t               lease_size;
+        uint32_t               lease_timeout;
+        int32_t                lease_share;
+        uuid_t                 lease_owner;
+        /* quotad: quota_lease_t granted, hashed by directory */
+        struct list_head      *leases;
 };
 typedef struct quota_priv      quota_priv_t;
 
+/* space quotad leased out of a directory, counted against what is left
+ * under its limit until @expiry */
+struct quota_lease {
+        struct list_head       list;
+        uuid_t                 gfid;
+        uuid_t                 owner;
+        int64_t                size;
+        time_t                 expiry;
+        gf_boolean_t           current; /* the owner's latest */
+};
+typedef struct quota_lease     quota_lease_t;
+
 int
 quota_enforcer_lookup (call_frame_t *frame, xlator_t *this, dict_t *xdata,
                        fop_lookup_cbk_t cbk);
@@ -42,6 +42,171 @@ mem_acct_init (xlator_t *this)
         return ret;
 }
 
+/* Adds the remote-host of each protocol/client under @xl to @hosts. */
+static void
+qd_collect_hosts (xlator_t *xl, dict_t *hosts)
+{
+        xlator_list_t *child = NULL;
+        char          *host  = NULL;
+
+        if (xl->type && strcmp (xl->type, "protocol/client") == 0) {
+                if ((dict_get_str (xl->options, "remote-host", &host) == 0)
+                    && dict_set_int8 (hosts, host, 1))
+                        gf_msg_debug (xl->name, 0, "dict set failed");
+                return;
+        }
+
+        for (child = xl->children; child; child = child->next)
+                qd_collect_hosts (child->xlator, hosts);
+}
+
+/* The number of nodes the bricks of the volume of @subvol are on, each of
+ * which has a quotad of its own granting leases to its bricks. */
+static int32_t
+qd_lease_nodes (xlator_t *subvol)
+{
+        dict_t  *hosts = NULL;
+        int32_t  nodes = 1;
+
+        if (!subvol)
+                return nodes;
+
+        hosts = dict_new ();
+        if (!hosts)
+                return nodes;
+
+        qd_collect_hosts (subvol, hosts);
+        if (hosts->count > 1)
+                nodes = hosts->count;
+
+        dict_unref (hosts);
+        return nodes;
+}
+
+/* Work out how much of the space left under the directory's hard-limit the
+ * enforcer asking in @req can have, and put it in @rsp. quotad keeps the
+ * leases it granted until they run out: what it can lease is its slice of
+ * the space left under the hard-limit, less what it has leased out, and
+ * each enforcer gets its share of that. On renewal, what the enforcer did
+ * not use of its previous lease is given back, what it used is still
+ * counted until that lease would have run out, as the size may not account
+ * for it yet.
+ *
+ * Bricks lease from the quotad of their own node, which knows nothing of
+ * the grants of the others. So the space left is split evenly between the
+ * @nodes nodes the bricks of the volume are on: what each quotad has out
+ * stays within its slice, and the leases of all of them together within
+ * the space left, short of usage the marker has not accounted for by the
+ * time a lease runs out. What the other nodes leased is thus subtracted on
+ * renewal too, as their slices. None is granted below QUOTA_LEASE_MIN_SIZE.
+ */
+static void
+qd_grant_lease (xlator_t *this, uuid_t gfid, int32_t nodes, dict_t *req,
+                dict_t *rsp)
+{
+        quota_priv_t     *priv        = NULL;
+        quota_limits_t   *limit       = NULL;
+        quota_lease_t    *lease       = NULL;
+        quota_lease_t    *tmp         = NULL;
+        struct list_head *bucket      = NULL;
+        quota_meta_t      size        = {0, };
+        void             *owner       = NULL;
+        int               owner_len   = 0;
+        int64_t           max         = 0;
+        int64_t           used        = 0;
+        int64_t           outstanding = 0;
+        int64_t           grant       = 0;
+        int32_t           share       = 1;
+        int32_t           timeout     = 0;
+        time_t            now         = 0;
+        int               ret         = -1;
+
+        priv = this->private;
+
+        ret = dict_get_int64 (req, QUOTA_LEASE_KEY, &max);
+        if (ret || max <= 0)
+                return;
+
+        ret = dict_get_int32 (req, QUOTA_LEASE_SHARE_KEY, &share);
+        if (ret || share < 1)
+                share = 1;
+
+        /* an enforcer that can't be told apart gets nothing */
+        ret = dict_get_ptr_and_len (req, QUOTA_LEASE_OWNER_KEY, &owner,
+                                    &owner_len);
+        if (ret || owner_len != sizeof (uuid_t) || !priv->leases)
+                goto out;
+
+        if (dict_get_int64 (req, QUOTA_LEASE_USED_KEY, &used) || used < 0)
+                used = 0;
+        if (dict_get_int32 (req, QUOTA_LEASE_TIMEOUT_KEY, &timeout) ||
+            timeout < 1)
+                goto out;
+
+        ret = dict_get_bin (rsp, QUOTA_LIMIT_KEY, (void **) &limit);
+        if (ret || limit == NULL || (int64_t) ntoh64 (limit->hl) <= 0)
+                goto out;
+
+        ret = quota_dict_get_meta (rsp, QUOTA_SIZE_KEY, &size);
+        if (ret)
+                goto out;
+
+        time (&now);
+        bucket = &priv->leases[gfid[15] % QUOTA_LEASE_BUCKETS];
+
+        LOCK (&priv->lock);
+        {
+                list_for_each_entry_safe (lease, tmp, bucket, list) {
+                        if (lease->expiry <= now) {
+                                list_del (&lease->list);
+                                GF_FREE (lease);
+                                continue;
+                        }
+                        if (gf_uuid_compare (lease->gfid, gfid) != 0)
+                                continue;
+
+                        if (lease->current &&
+                            gf_uuid_compare (lease->owner, owner) == 0) {
+                                lease->current = _gf_false;
+                                if (lease->size > used)
+                                        lease->size = used;
+                        }
+                        outstanding += lease->size;
+                }
+
+                grant = (((int64_t) ntoh64 (limit->hl) - size.size) / nodes
+                         - outstanding) / share;
+                if (grant > max)
+                        grant = max;
+                if (grant < QUOTA_LEASE_MIN_SIZE)
+                        grant = 0;
+
+                if (grant > 0) {
+                        lease = GF_CALLOC (1, sizeof (*lease),
+                                           gf_quota_mt_lease_t);
+                        if (lease) {
+                                gf_uuid_copy (lease->gfid, gfid);
+                                gf_uuid_copy (lease->owner, owner);
+                                lease->size = grant;
+                                /* the enforcer starts the clock only once
+                                 * it has the reply */
+                                lease->expiry = now + timeout + 1;
+                                lease->current = _gf_true;
+                                list_add_tail (&lease->list, bucket);
+                        } else {
+                                grant = 0;
+                        }
+                }
+        }
+        UNLOCK (&priv->lock);
+
+out:
+        ret = dict_set_int64 (rsp, QUOTA_LEASE_KEY, grant);
+        if (ret)
+                gf_msg (this->name, GF_LOG_WARNING, ENOMEM, Q_MSG_ENOMEM,
+                        "dict set failed");
+}
+
 int32_t
 qd_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, inode_t *inode,
@@ -49,8 +214,15 @@ qd_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 {
         quotad_aggregator_lookup_cbk_t  lookup_cbk = NULL;
         gfs3_lookup_rsp                 rsp = {0, };
+        quotad_aggregator_state_t      *state = NULL;
 
         lookup_cbk = cookie;
+        state = frame->root->state;
+
+        if ((op_ret == 0) && xdata && state->xdata)
+                qd_grant_lease (this, buf->ia_gfid,
+                                qd_lease_nodes (state->active_subvol),
+                                state->xdata, xdata);
 
         rsp.op_ret = op_ret;
         rsp.op_errno = op_errno;
@@ -135,12 +307,25 @@ qd_nameless_lookup (xlator_t *this, call_frame_t *frame, gfs3_lookup_req *req,
                 goto out;
         }
 
+        if (dict_get (xdata, QUOTA_LEASE_KEY)) {
+                /* the limit is needed to work out the lease */
+                ret = dict_set_int8 (xdata, QUOTA_LIMIT_KEY, 1);
+                if (ret < 0) {
+                        gf_msg (this->name, GF_LOG_WARNING, ENOMEM,
+                                Q_MSG_ENOMEM, "dict set failed");
+                        ret = -ENOMEM;
+                        goto out;
+                }
+        }
+
         subvol = qd_find_subvol (this, volume_uuid);
         if (subvol == NULL) {
                 op_errno = EINVAL;
                 goto out;
         }
 
+        state->active_subvol = subvol;
+
         STACK_WIND_COOKIE (frame, qd_lookup_cbk, lookup_cbk, subvol,
                            subvol->fops->lookup, &loc, xdata);
         return 0;
@@ -166,12 +351,27 @@ void
 qd_fini (xlator_t *this)
 {
         quota_priv_t    *priv           = NULL;
+        quota_lease_t   *lease          = NULL;
+        quota_lease_t   *tmp            = NULL;
+        int              i              = 0;
 
         if (this == NULL || this->private == NULL)
                 goto out;
 
         priv = this->private;
 
+        if (priv->leases) {
+                for (i = 0; i < QUOTA_LEASE_BUCKETS; i++) {
+                        list_for_each_entry_safe (lease, tmp,
+                                                  &priv->leases[i], list) {
+                                list_del (&lease->list);
+                                GF_FREE (lease);
+                        }
+                }
+                GF_FREE (priv->leases);
+                priv->leases = NULL;
+        }
+
         if (priv->rpcsvc) {
                 GF_FREE (priv->rpcsvc);
                 priv->rpcsvc = NULL;
@@ -188,6 +388,7 @@ qd_init (xlator_t *this)
 {
         int32_t          ret            = -1;
         quota_priv_t    *priv           = NULL;
+        int              i              = 0;
 
         if (NULL == this->children) {
                 gf_log (this->name, GF_LOG_ERROR,
@@ -200,11 +401,19 @@ qd_init (xlator_t *this)
         QUOTA_ALLOC_OR_GOTO (priv, quota_priv_t, err);
         LOCK_INIT (&priv->lock);
 
+        priv->leases = GF_CALLOC (QUOTA_LEASE_BUCKETS, sizeof (*priv->leases),
+                                  gf_quota_mt_lease_t);
+        if (!priv->leases)
+                goto err;
+        for (i = 0; i < QUOTA_LEASE_BUCKETS; i++)
+                INIT_LIST_HEAD (&priv->leases[i]);
+
         this->private = priv;
 
         ret = 0;
 err:
-        if (ret) {
+        if (ret && priv) {
+                LOCK_DESTROY (&priv->lock);
                 GF_FREE (priv);
         }
         return ret;
@@ -48,6 +48,8 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("read-only", priv->readonly_or_worm_enabled, bool, out);
 
+        /* when off, every fop goes straight on to the child */
+        this->pass_through = !priv->readonly_or_worm_enabled;
         this->private = priv;
         ret = 0;
 out:
@@ -67,6 +69,7 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("read-only", readonly_or_worm_enabled, options, bool,
                           out);
         priv->readonly_or_worm_enabled = readonly_or_worm_enabled;
+        this->pass_through = !readonly_or_worm_enabled;
         ret = 0;
 out:
         gf_log (this->name, GF_LOG_DEBUG, "returning %d", ret);
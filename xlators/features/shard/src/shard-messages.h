@@ -40,7 +40,7 @@
  */
 
 #define GLFS_COMP_BASE_SHARD      GLFS_MSGID_COMP_SHARD
-#define GLFS_NUM_MESSAGES         18
+#define GLFS_NUM_MESSAGES         20
 #define GLFS_MSGID_END          (GLFS_COMP_BASE_SHARD + GLFS_NUM_MESSAGES + 1)
 
 #define glfs_msg_start_x GLFS_COMP_BASE_SHARD, "Invalid: Start of messages"
@@ -180,5 +180,25 @@
 */
 #define SHARD_MSG_INVALID_FOP                        (GLFS_COMP_BASE_SHARD + 18)
 
+/*!
+ * @messageid 133019
+ * @diagnosis Some of the shards of a file deleted in the background could
+ * not be deleted, or the deletion could not be recorded as pending on
+ * /.shard. Deletions left pending are retried by the next client to look
+ * /.shard up.
+ * @recommendedaction None, unless the message repeats for the same file:
+ * then remove the shards named after the gfid of the file from /.shard.
+*/
+#define SHARD_MSG_PURGE_FAILED                       (GLFS_COMP_BASE_SHARD + 19)
+
+/*!
+ * @messageid 133020
+ * @diagnosis The size and block count changes held back for a file could
+ * not be written to its size xattr in the background. They are written
+ * along with its next size update.
+ * @recommendedaction None
+*/
+#define SHARD_MSG_SIZE_FLUSH_FAILED                  (GLFS_COMP_BASE_SHARD + 20)
+
 #define glfs_msg_end_x GLFS_MSGID_END, "Invalid: End of messages"
 #endif /* !_SHARD_MESSAGES_H_ */
@@ -76,6 +76,7 @@ __shard_inode_ctx_get (inode_t *inode, xlator_t *this, shard_inode_ctx_t **ctx)
                 return ret;
 
         INIT_LIST_HEAD (&ctx_p->ilist);
+        INIT_LIST_HEAD (&ctx_p->unflushed_list);
 
         ret = __inode_ctx_set (inode, this, (uint64_t *)&ctx_p);
         if (ret < 0) {
@@ -411,8 +412,51 @@ shard_local_wipe (shard_local_t *local)
                 gf_dirent_free (&local->entries_head);
 }
 
-int
-shard_modify_size_and_block_count (struct iatt *stbuf, dict_t *dict)
+static gf_boolean_t
+__shard_inode_ctx_is_unflushed (shard_inode_ctx_t *ctx)
+{
+        return (ctx->unflushed_size || ctx->unflushed_blocks ||
+                ctx->flushing);
+}
+
+/* While this client holds back size updates of the file, the size and block
+ * count in its inode ctx are ahead of those on the brick, and are the ones
+ * to go by.
+ */
+static void
+shard_inode_ctx_fill_unflushed_size (xlator_t *this, struct iatt *stbuf)
+{
+        uint64_t            ctx_uint = 0;
+        inode_t            *inode    = NULL;
+        shard_priv_t       *priv     = NULL;
+        shard_inode_ctx_t  *ctx      = NULL;
+
+        priv = this->private;
+
+        if (!GF_ATOMIC_GET (priv->unflushed_count) || !this->itable)
+                return;
+
+        inode = inode_find (this->itable, stbuf->ia_gfid);
+        if (!inode)
+                return;
+
+        LOCK (&inode->lock);
+        {
+                if (__inode_ctx_get (inode, this, &ctx_uint) == 0) {
+                        ctx = (shard_inode_ctx_t *) ctx_uint;
+                        if (__shard_inode_ctx_is_unflushed (ctx)) {
+                                stbuf->ia_size = ctx->stat.ia_size;
+                                stbuf->ia_blocks = ctx->stat.ia_blocks;
+                        }
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        inode_unref (inode);
+}
+
+static int
+shard_get_size_attrs (struct iatt *stbuf, dict_t *dict)
 {
         int                  ret       = -1;
         void                *size_attr = NULL;
@@ -435,6 +479,20 @@ shard_modify_size_and_block_count (struct iatt *stbuf, dict_t *dict)
         return 0;
 }
 
+int
+shard_modify_size_and_block_count (struct iatt *stbuf, dict_t *dict)
+{
+        int ret = -1;
+
+        ret = shard_get_size_attrs (stbuf, dict);
+        if (ret)
+                return ret;
+
+        shard_inode_ctx_fill_unflushed_size (THIS, stbuf);
+
+        return 0;
+}
+
 int
 shard_call_count_return (call_frame_t *frame)
 {
@@ -452,6 +510,104 @@ shard_call_count_return (call_frame_t *frame)
         return call_count;
 }
 
+static void
+shard_window_init (shard_local_t *local, int first_block, int count,
+                   inode_t *inode)
+{
+        local->wind_iter = first_block;
+        local->wind_count = count;
+        local->inflight = 0;
+        local->wind_inode = inode;
+        /* the caller goes on to run the wind loop */
+        local->winding = _gf_true;
+}
+
+/* Returns the next block (from local->wind_iter on) that is resolved to an
+ * inode or not, as asked in @resolved, for the caller to wind a call on.
+ * Returns -1 if the window is full, in which case the calls in flight wind
+ * the rest as they complete. *last is set with the last block to wind.
+ *
+ * Only one wind loop runs at a time: it stops being the one once this
+ * returns -1 or the last block, under the same lock the callbacks free
+ * their slot under, so a freed slot is either seen here or refilled by
+ * the callback freeing it (see shard_window_done ()).
+ *
+ * The thread that starts winding holds a reference of its own in
+ * local->call_count (one more than the number of calls), since the calls it
+ * winds may all complete before it is done looking at local. It drops that
+ * reference once its loop is over and, if it is the last one, runs the
+ * completion of the fop itself.
+ */
+static int
+shard_window_next_block (call_frame_t *frame, xlator_t *this,
+                         gf_boolean_t resolved, gf_boolean_t *last)
+{
+        int             block  = -1;
+        int             cur    = 0;
+        int32_t         window = 0;
+        shard_priv_t   *priv   = NULL;
+        shard_local_t  *local  = NULL;
+
+        priv = this->private;
+        local = frame->local;
+
+        window = (local->purge) ? priv->deletion_rate : priv->fop_window;
+
+        LOCK (&frame->lock);
+        {
+                while ((local->wind_count > 0) && (local->inflight < window) &&
+                       (local->wind_iter <= local->last_block)) {
+                        cur = local->wind_iter++;
+                        if ((local->inode_list[cur - local->first_block]
+                             != NULL) == resolved) {
+                                local->inflight++;
+                                *last = (--local->wind_count == 0);
+                                block = cur;
+                                break;
+                        }
+                }
+                if (block < 0 || *last)
+                        local->winding = _gf_false;
+        }
+        UNLOCK (&frame->lock);
+
+        return block;
+}
+
+/* Frees the window slot of a call that completed. Returns true if the caller
+ * is to run the wind loop to refill the window: that is when there are calls
+ * left to wind and no wind loop is active. A callback unwinding synchronously
+ * from within the wind loop thus returns to it instead of recursing into a
+ * new one, which would grow the stack by a call per shard.
+ */
+static gf_boolean_t
+shard_window_done (call_frame_t *frame, xlator_t *this)
+{
+        int32_t         window = 0;
+        gf_boolean_t    refill = _gf_false;
+        shard_priv_t   *priv   = NULL;
+        shard_local_t  *local  = NULL;
+
+        priv = this->private;
+        local = frame->local;
+
+        window = (local->purge) ? priv->deletion_rate : priv->fop_window;
+
+        LOCK (&frame->lock);
+        {
+                local->inflight--;
+                if (!local->winding && (local->wind_count > 0) &&
+                    (local->inflight < window) &&
+                    (local->wind_iter <= local->last_block)) {
+                        local->winding = _gf_true;
+                        refill = _gf_true;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        return refill;
+}
+
 static int
 shard_init_dot_shard_loc (xlator_t *this, shard_local_t *local)
 {
@@ -632,11 +788,22 @@ shard_common_resolve_shards (call_frame_t *frame, xlator_t *this,
                         continue;
                 }
 
-                shard_make_block_abspath (shard_idx_iter, res_inode->gfid, path,
-                                          sizeof(path));
-
                 inode = NULL;
-                inode = inode_resolve (this->itable, path);
+                if (priv->dot_shard_inode) {
+                        /* look the shard up under the linked /.shard
+                         * rather than walking its path from the root
+                         */
+                        shard_make_block_bname (shard_idx_iter,
+                                                res_inode->gfid, path,
+                                                sizeof (path));
+                        inode = inode_grep (this->itable,
+                                            priv->dot_shard_inode, path);
+                } else {
+                        shard_make_block_abspath (shard_idx_iter,
+                                                  res_inode->gfid, path,
+                                                  sizeof (path));
+                        inode = inode_resolve (this->itable, path);
+                }
                 if (inode) {
                         gf_msg_debug (this->name, 0, "Shard %d already "
                                 "present. gfid=%s. Saving inode for future.",
@@ -668,6 +835,182 @@ out:
         return 0;
 }
 
+static void
+shard_size_update_timer_cbk (void *data);
+
+static void
+shard_unflushed_count_update (shard_priv_t *priv, gf_boolean_t was_unflushed,
+                              gf_boolean_t is_unflushed)
+{
+        if (!was_unflushed && is_unflushed)
+                GF_ATOMIC_INC (priv->unflushed_count);
+        else if (was_unflushed && !is_unflushed)
+                GF_ATOMIC_DEC (priv->unflushed_count);
+}
+
+/* Queues the base file for the size update timer. Returns -1 if the timer
+ * could not be armed, in which case the caller is to flush by itself.
+ */
+static int
+shard_queue_size_update (xlator_t *this, inode_t *inode,
+                         shard_inode_ctx_t *ctx)
+{
+        int              ret   = 0;
+        shard_priv_t    *priv  = NULL;
+        struct timespec  delay = {0,};
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                if (list_empty (&ctx->unflushed_list)) {
+                        ctx->unflushed_inode = inode_ref (inode);
+                        list_add_tail (&ctx->unflushed_list,
+                                       &priv->unflushed_head);
+                }
+
+                if (!priv->size_update_timer) {
+                        delay.tv_sec = max (priv->size_update_interval, 1);
+                        priv->size_update_timer = gf_timer_call_after
+                                (this->ctx, delay, shard_size_update_timer_cbk,
+                                 this);
+                        if (!priv->size_update_timer)
+                                ret = -1;
+                }
+        }
+        UNLOCK (&priv->lock);
+
+        return ret;
+}
+
+/* Hands the size and block count changes held back in the inode ctx over to
+ * the size update about to be wound on @local. Only flush, fsync, truncate
+ * and the background update of the timer and release do that: a write
+ * winding its own size update leaves them to those, so that it does not
+ * serialise behind the writes before it.
+ */
+static void
+shard_inode_ctx_take_unflushed_size (inode_t *inode, xlator_t *this,
+                                     shard_local_t *local)
+{
+        uint64_t            ctx_uint = 0;
+        shard_inode_ctx_t  *ctx      = NULL;
+
+        switch (local->fop) {
+        case GF_FOP_NULL:       /* shard_update_file_size_bg () */
+        case GF_FOP_FLUSH:
+        case GF_FOP_FSYNC:
+        case GF_FOP_TRUNCATE:
+        case GF_FOP_FTRUNCATE:
+                break;
+        default:
+                return;
+        }
+
+        LOCK (&inode->lock);
+        {
+                if (__inode_ctx_get (inode, this, &ctx_uint) != 0)
+                        goto unlock;
+
+                ctx = (shard_inode_ctx_t *) ctx_uint;
+                if (!ctx->unflushed_size && !ctx->unflushed_blocks)
+                        goto unlock;
+
+                local->flushed_size = ctx->unflushed_size;
+                local->flushed_blocks = ctx->unflushed_blocks;
+                local->flushing = _gf_true;
+                ctx->unflushed_size = 0;
+                ctx->unflushed_blocks = 0;
+                ctx->flushing++;
+        }
+unlock:
+        UNLOCK (&inode->lock);
+}
+
+/* Called once the size update carrying changes taken off the inode ctx is
+ * done. If it failed, they are put back to go with the next one, unless the
+ * file is gone.
+ */
+static void
+shard_inode_ctx_flushed_size (inode_t *inode, xlator_t *this,
+                              shard_local_t *local, int32_t op_errno)
+{
+        int                 ret           = -1;
+        uint64_t            ctx_uint      = 0;
+        gf_boolean_t        is_unflushed  = _gf_false;
+        gf_boolean_t        requeue       = _gf_false;
+        shard_priv_t       *priv          = NULL;
+        shard_inode_ctx_t  *ctx           = NULL;
+
+        if (!local->flushing)
+                return;
+
+        priv = this->private;
+        local->flushing = _gf_false;
+
+        LOCK (&inode->lock);
+        {
+                ret = __inode_ctx_get (inode, this, &ctx_uint);
+                if (ret == 0) {
+                        ctx = (shard_inode_ctx_t *) ctx_uint;
+                        ctx->flushing--;
+                        if (op_errno && op_errno != ENOENT &&
+                            op_errno != ESTALE) {
+                                ctx->unflushed_size += local->flushed_size;
+                                ctx->unflushed_blocks += local->flushed_blocks;
+                                requeue = _gf_true;
+                        }
+                        is_unflushed = __shard_inode_ctx_is_unflushed (ctx);
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        if (ret)
+                return;
+
+        shard_unflushed_count_update (priv, _gf_true, is_unflushed);
+        if (requeue)
+                shard_queue_size_update (this, inode, ctx);
+}
+
+/* Adds the changes still held back to a size just read off the brick. */
+static void
+shard_inode_ctx_add_unflushed_size (inode_t *inode, xlator_t *this,
+                                    struct iatt *stbuf)
+{
+        uint64_t            ctx_uint = 0;
+        shard_inode_ctx_t  *ctx      = NULL;
+
+        LOCK (&inode->lock);
+        {
+                if (__inode_ctx_get (inode, this, &ctx_uint) == 0) {
+                        ctx = (shard_inode_ctx_t *) ctx_uint;
+                        stbuf->ia_size += ctx->unflushed_size;
+                        stbuf->ia_blocks += ctx->unflushed_blocks;
+                }
+        }
+        UNLOCK (&inode->lock);
+}
+
+gf_boolean_t
+shard_inode_ctx_has_unflushed_size (inode_t *inode, xlator_t *this)
+{
+        uint64_t            ctx_uint = 0;
+        gf_boolean_t        flag     = _gf_false;
+        shard_inode_ctx_t  *ctx      = NULL;
+
+        LOCK (&inode->lock);
+        {
+                if (__inode_ctx_get (inode, this, &ctx_uint) == 0) {
+                        ctx = (shard_inode_ctx_t *) ctx_uint;
+                        flag = (ctx->unflushed_size || ctx->unflushed_blocks);
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        return flag;
+}
+
 int
 shard_update_file_size_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                             int32_t op_ret, int32_t op_errno, dict_t *dict,
@@ -687,16 +1030,21 @@ shard_update_file_size_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 gf_msg (this->name, GF_LOG_ERROR, op_errno,
                         SHARD_MSG_UPDATE_FILE_SIZE_FAILED, "Update to file size"
                         " xattr failed on %s", uuid_utoa (inode->gfid));
+                shard_inode_ctx_flushed_size (inode, this, local, op_errno);
                 local->op_ret = op_ret;
                 local->op_errno = op_errno;
                 goto err;
         }
 
-        if (shard_modify_size_and_block_count (&local->postbuf, dict)) {
+        shard_inode_ctx_flushed_size (inode, this, local, 0);
+
+        if (shard_get_size_attrs (&local->postbuf, dict)) {
                 local->op_ret = -1;
                 local->op_errno = ENOMEM;
                 goto err;
         }
+        /* writes that happened since are yet to reach the brick */
+        shard_inode_ctx_add_unflushed_size (inode, this, &local->postbuf);
 
         if (local->fop == GF_FOP_FTRUNCATE || local->fop == GF_FOP_TRUNCATE)
                 shard_inode_ctx_set (inode, this, &local->postbuf, 0,
@@ -761,15 +1109,22 @@ shard_update_file_size (call_frame_t *frame, xlator_t *this, fd_t *fd,
         else
                 inode = loc->inode;
 
+        /* Size changes of earlier writes held back in the inode ctx go along,
+         * unless this is the size update of a write
+         */
+        shard_inode_ctx_take_unflushed_size (inode, this, local);
+
         /* If both size and block count have not changed, then skip the xattrop.
          */
-        if ((local->delta_size + local->hole_size == 0) &&
-            (local->delta_blocks == 0)) {
+        if ((local->delta_size + local->hole_size + local->flushed_size == 0)
+            && (local->delta_blocks + local->flushed_blocks == 0)) {
                 goto out;
         }
 
-        ret = shard_set_size_attrs (local->delta_size + local->hole_size,
-                                    local->delta_blocks, &size_attr);
+        ret = shard_set_size_attrs (local->delta_size + local->hole_size +
+                                    local->flushed_size,
+                                    local->delta_blocks + local->flushed_blocks,
+                                    &size_attr);
         if (ret) {
                 gf_msg (this->name, GF_LOG_ERROR, 0, SHARD_MSG_SIZE_SET_FAILED,
                         "Failed to set size attrs for %s",
@@ -808,23 +1163,136 @@ shard_update_file_size (call_frame_t *frame, xlator_t *this, fd_t *fd,
 out:
         if (xattr_req)
                 dict_unref (xattr_req);
+        if (inode)
+                shard_inode_ctx_flushed_size (inode, this, local,
+                                              (local->op_ret < 0) ?
+                                              local->op_errno : 0);
         handler (frame, this);
         return 0;
 
 }
 
+int
+shard_post_update_size_bg_handler (call_frame_t *frame, xlator_t *this)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (local->op_ret < 0)
+                gf_msg (this->name, GF_LOG_WARNING, local->op_errno,
+                        SHARD_MSG_SIZE_FLUSH_FAILED, "Failed to update the "
+                        "size of %s", uuid_utoa (local->loc.inode->gfid));
+
+        frame->local = NULL;
+        shard_local_wipe (local);
+        mem_put (local);
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+/* Writes the size changes held back for @inode on a frame of its own. */
+static void
+shard_update_file_size_bg (xlator_t *this, inode_t *inode)
+{
+        call_frame_t  *frame = NULL;
+        shard_local_t *local = NULL;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame)
+                goto err;
+
+        local = mem_get0 (this->local_pool);
+        if (!local)
+                goto err;
+        frame->local = local;
+
+        local->loc.inode = inode_ref (inode);
+        gf_uuid_copy (local->loc.gfid, inode->gfid);
+
+        shard_update_file_size (frame, this, NULL, &local->loc,
+                                shard_post_update_size_bg_handler);
+        return;
+err:
+        gf_msg (this->name, GF_LOG_WARNING, ENOMEM,
+                SHARD_MSG_SIZE_FLUSH_FAILED, "Failed to update the size of %s",
+                uuid_utoa (inode->gfid));
+        if (frame)
+                STACK_DESTROY (frame->root);
+}
+
+static void
+shard_size_update_timer_cbk (void *data)
+{
+        xlator_t          *this  = NULL;
+        inode_t           *inode = NULL;
+        shard_priv_t      *priv  = NULL;
+        shard_inode_ctx_t *ctx   = NULL;
+        struct list_head   list;
+
+        this = data;
+        THIS = this;
+        priv = this->private;
+        INIT_LIST_HEAD (&list);
+
+        LOCK (&priv->lock);
+        {
+                priv->size_update_timer = NULL;
+                list_splice_init (&priv->unflushed_head, &list);
+        }
+        UNLOCK (&priv->lock);
+
+        for (;;) {
+                inode = NULL;
+                LOCK (&priv->lock);
+                {
+                        if (!list_empty (&list)) {
+                                ctx = list_first_entry (&list,
+                                                        shard_inode_ctx_t,
+                                                        unflushed_list);
+                                list_del_init (&ctx->unflushed_list);
+                                inode = ctx->unflushed_inode;
+                                ctx->unflushed_inode = NULL;
+                        }
+                }
+                UNLOCK (&priv->lock);
+
+                if (!inode)
+                        break;
+
+                shard_update_file_size_bg (this, inode);
+                inode_unref (inode);
+        }
+}
+
+static void
+shard_purge_resume (xlator_t *this);
+
 static inode_t *
 shard_link_dot_shard_inode (shard_local_t *local, inode_t *inode,
                             struct iatt *buf)
 {
         inode_t       *linked_inode = NULL;
         shard_priv_t  *priv         = NULL;
+        gf_boolean_t   resume       = _gf_false;
 
         priv = THIS->private;
 
         linked_inode = inode_link (inode, inode->table->root, ".shard", buf);
         inode_lookup (linked_inode);
         priv->dot_shard_inode = linked_inode;
+
+        /* the first time round, pick up the purges left pending */
+        LOCK (&priv->lock);
+        {
+                resume = !priv->purge_resumed;
+                priv->purge_resumed = _gf_true;
+        }
+        UNLOCK (&priv->lock);
+
+        if (resume)
+                shard_purge_resume (THIS);
+
         return linked_inode;
 }
 
@@ -1494,26 +1962,20 @@ shard_unlink_shards_do_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                             struct iatt *preparent, struct iatt *postparent,
                             dict_t *xdata);
 
+int
+shard_unlink_shards_wind (call_frame_t *frame, xlator_t *this);
+
+int
+shard_unlink_shards_done (call_frame_t *frame, xlator_t *this);
+
 int
 shard_truncate_htol (call_frame_t *frame, xlator_t *this, inode_t *inode)
 {
         int i = 1;
-        int ret = -1;
         int call_count = 0;
-        uint32_t cur_block = 0;
-        uint32_t last_block = 0;
-        char path[PATH_MAX] = {0,};
-        char *bname = NULL;
-        loc_t loc = {0,};
-        gf_boolean_t wind_failed = _gf_false;
         shard_local_t *local = NULL;
-        shard_priv_t *priv = NULL;
 
         local = frame->local;
-        priv = this->private;
-
-        cur_block = local->first_block + 1;
-        last_block = local->last_block;
 
         /* Determine call count */
         for (i = 1; i < local->num_blocks; i++) {
@@ -1542,60 +2004,14 @@ shard_truncate_htol (call_frame_t *frame, xlator_t *this, inode_t *inode)
                 return 0;
         }
 
-        local->call_count = call_count;
-        i = 1;
+        local->call_count = call_count + 1;
 
         SHARD_SET_ROOT_FS_ID (frame, local);
-        while (cur_block <= last_block) {
-                if (!local->inode_list[i]) {
-                        cur_block++;
-                        i++;
-                        continue;
-                }
-                if (wind_failed) {
-                        shard_unlink_shards_do_cbk (frame,
-                                                    (void *)(long) cur_block,
-                                                    this, -1, ENOMEM, NULL,
-                                                    NULL, NULL);
-                        goto next;
-                }
+        shard_window_init (local, local->first_block + 1, call_count, inode);
+        shard_unlink_shards_wind (frame, this);
 
-                shard_make_block_abspath (cur_block, inode->gfid, path,
-                                          sizeof (path));
-                bname = strrchr (path, '/') + 1;
-                loc.parent = inode_ref (priv->dot_shard_inode);
-                ret = inode_path (loc.parent, bname, (char **)&(loc.path));
-                if (ret < 0) {
-                        gf_msg (this->name, GF_LOG_ERROR, 0,
-                                SHARD_MSG_INODE_PATH_FAILED, "Inode path failed"
-                                " on %s. Base file gfid = %s", bname,
-                                uuid_utoa (inode->gfid));
-                        local->op_ret = -1;
-                        local->op_errno = ENOMEM;
-                        loc_wipe (&loc);
-                        wind_failed = _gf_true;
-                        shard_unlink_shards_do_cbk (frame,
-                                                    (void *)(long) cur_block,
-                                                    this, -1, ENOMEM, NULL,
-                                                    NULL, NULL);
-                        goto next;
-                }
-                loc.name = strrchr (loc.path, '/');
-                if (loc.name)
-                        loc.name++;
-                loc.inode = inode_ref (local->inode_list[i]);
-
-                STACK_WIND_COOKIE (frame, shard_unlink_shards_do_cbk,
-                                   (void *) (long) cur_block, FIRST_CHILD(this),
-                                   FIRST_CHILD (this)->fops->unlink, &loc,
-                                   0, NULL);
-                loc_wipe (&loc);
-next:
-                i++;
-                cur_block++;
-                if (!--call_count)
-                        break;
-        }
+        if (shard_call_count_return (frame) == 0)
+                shard_unlink_shards_done (frame, this);
         return 0;
 
 }
@@ -1678,6 +2094,12 @@ shard_link_block_inode (shard_local_t *local, int block_num, inode_t *inode,
         UNLOCK(&priv->lock);
 }
 
+int
+shard_common_lookup_shards_wind (call_frame_t *frame, xlator_t *this);
+
+int
+shard_common_lookup_shards_done (call_frame_t *frame, xlator_t *this);
+
 int
 shard_common_lookup_shards_cbk (call_frame_t *frame, void *cookie,
                                 xlator_t *this, int32_t op_ret,
@@ -1731,18 +2153,24 @@ shard_common_lookup_shards_cbk (call_frame_t *frame, void *cookie,
         shard_link_block_inode (local, shard_block_num, inode, buf);
 
 done:
+        if (shard_window_done (frame, this))
+                shard_common_lookup_shards_wind (frame, this);
+
         call_count = shard_call_count_return (frame);
-        if (call_count == 0) {
-                if (!local->first_lookup_done)
-                        local->first_lookup_done = _gf_true;
-                if (local->op_ret < 0)
-                        goto unwind;
-                else
-                        local->pls_fop_handler (frame, this);
-        }
+        if (call_count == 0)
+                shard_common_lookup_shards_done (frame, this);
         return 0;
+}
 
-unwind:
+int
+shard_common_lookup_shards_done (call_frame_t *frame, xlator_t *this)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (!local->first_lookup_done)
+                local->first_lookup_done = _gf_true;
         local->pls_fop_handler (frame, this);
         return 0;
 }
@@ -1779,42 +2207,34 @@ out:
 }
 
 int
-shard_common_lookup_shards (call_frame_t *frame, xlator_t *this, inode_t *inode,
-                            shard_post_lookup_shards_fop_handler_t handler)
+shard_common_lookup_shards_wind (call_frame_t *frame, xlator_t *this)
 {
-        int            i              = 0;
         int            ret            = 0;
-        int            call_count     = 0;
         int32_t        shard_idx_iter = 0;
-        int            last_block     = 0;
         char           path[PATH_MAX] = {0,};
         char          *bname          = NULL;
         loc_t          loc            = {0,};
+        inode_t       *inode          = NULL;
         shard_local_t *local          = NULL;
         shard_priv_t  *priv           = NULL;
         gf_boolean_t   wind_failed    = _gf_false;
+        gf_boolean_t   last           = _gf_false;
         dict_t        *xattr_req      = NULL;
 
         priv = this->private;
         local = frame->local;
-        call_count = local->call_count;
-        shard_idx_iter = local->first_block;
-        last_block = local->last_block;
-        local->pls_fop_handler = handler;
-
-        while (shard_idx_iter <= last_block) {
-                if (local->inode_list[i]) {
-                        i++;
-                        shard_idx_iter++;
-                        continue;
-                }
+        inode = local->wind_inode;
 
+        while (!last &&
+               (shard_idx_iter = shard_window_next_block (frame, this,
+                                                          _gf_false,
+                                                          &last)) >= 0) {
                 if (wind_failed) {
                         shard_common_lookup_shards_cbk (frame,
                                                  (void *) (long) shard_idx_iter,
                                                  this, -1, ENOMEM, NULL, NULL,
                                                  NULL, NULL);
-                        goto next;
+                        continue;
                 }
 
                 shard_make_block_abspath (shard_idx_iter, inode->gfid, path,
@@ -1838,7 +2258,7 @@ shard_common_lookup_shards (call_frame_t *frame, xlator_t *this, inode_t *inode,
                                                  (void *) (long) shard_idx_iter,
                                                  this, -1, ENOMEM, NULL, NULL,
                                                  NULL, NULL);
-                        goto next;
+                        continue;
                 }
 
                 loc.name = strrchr (loc.path, '/');
@@ -1855,7 +2275,7 @@ shard_common_lookup_shards (call_frame_t *frame, xlator_t *this, inode_t *inode,
                                                  (void *) (long) shard_idx_iter,
                                                  this, -1, ENOMEM, NULL, NULL,
                                                  NULL, NULL);
-                        goto next;
+                        continue;
                 }
 
                 STACK_WIND_COOKIE (frame, shard_common_lookup_shards_cbk,
@@ -1865,17 +2285,33 @@ shard_common_lookup_shards (call_frame_t *frame, xlator_t *this, inode_t *inode,
                                    xattr_req);
                 loc_wipe (&loc);
                 dict_unref (xattr_req);
-next:
-                shard_idx_iter++;
-                i++;
-
-                if (!--call_count)
-                        break;
         }
 
         return 0;
 }
 
+/* Looks up the local->call_count shards not in the inode table yet, keeping
+ * at most shard-fop-window lookups in flight.
+ */
+int
+shard_common_lookup_shards (call_frame_t *frame, xlator_t *this, inode_t *inode,
+                            shard_post_lookup_shards_fop_handler_t handler)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+        local->pls_fop_handler = handler;
+
+        shard_window_init (local, local->first_block, local->call_count,
+                           inode);
+        local->call_count++;
+        shard_common_lookup_shards_wind (frame, this);
+
+        if (shard_call_count_return (frame) == 0)
+                shard_common_lookup_shards_done (frame, this);
+        return 0;
+}
+
 int
 shard_post_resolve_truncate_handler (call_frame_t *frame, xlator_t *this)
 {
@@ -2279,6 +2715,307 @@ err:
         return 0;
 }
 
+/* A pending background purge is recorded in an xattr of /.shard named after
+ * the gfid of the base file (SHARD_PURGE_XATTR_PREFIX), from before the base
+ * file is unlinked until all of its shards are gone. What a crash of the
+ * client or a failed shard unlink leaves pending is picked up again by the
+ * first lookup of /.shard of the next client process (or the same one,
+ * should that fail).
+ */
+static void
+shard_purge_xattr_key (uuid_t gfid, char *key, size_t len)
+{
+        snprintf (key, len, "%s%s", SHARD_PURGE_XATTR_PREFIX,
+                  uuid_utoa (gfid));
+}
+
+/* Fills @loc in for /.shard, which must be linked in the inode table. */
+static int
+shard_dot_shard_loc_fill (xlator_t *this, loc_t *loc)
+{
+        int           ret  = -1;
+        shard_priv_t *priv = NULL;
+
+        priv = this->private;
+
+        loc->inode = inode_find (this->itable, priv->dot_shard_gfid);
+        if (!loc->inode)
+                goto out;
+
+        loc->parent = inode_ref (this->itable->root);
+        gf_uuid_copy (loc->gfid, priv->dot_shard_gfid);
+        ret = inode_path (loc->parent, GF_SHARD_DIR, (char **) &loc->path);
+        if (ret < 0)
+                goto out;
+
+        loc->name = strrchr (loc->path, '/');
+        if (loc->name)
+                loc->name++;
+
+        ret = 0;
+out:
+        if (ret)
+                loc_wipe (loc);
+        return ret;
+}
+
+int
+shard_purge_unmark_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+        if (op_ret < 0 && op_errno != ENODATA && op_errno != ENOATTR)
+                gf_msg (this->name, GF_LOG_WARNING, op_errno,
+                        SHARD_MSG_PURGE_FAILED, "Failed to clear a purge "
+                        "done from the pending ones on /.shard");
+
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+/* Takes the purge of the shards of @gfid off the pending ones. */
+static void
+shard_purge_unmark (xlator_t *this, uuid_t gfid)
+{
+        char           key[sizeof (SHARD_PURGE_XATTR_PREFIX) +
+                           UUID_CANONICAL_FORM_LEN] = {0,};
+        loc_t          loc   = {0,};
+        call_frame_t  *frame = NULL;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame)
+                goto err;
+        frame->root->uid = 0;
+        frame->root->gid = 0;
+
+        if (shard_dot_shard_loc_fill (this, &loc))
+                goto err;
+
+        shard_purge_xattr_key (gfid, key, sizeof (key));
+
+        STACK_WIND (frame, shard_purge_unmark_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->removexattr, &loc, key, NULL);
+        loc_wipe (&loc);
+        return;
+err:
+        gf_msg (this->name, GF_LOG_WARNING, ENOMEM, SHARD_MSG_PURGE_FAILED,
+                "Failed to clear the purge of the shards of %s from the "
+                "pending ones on /.shard", uuid_utoa (gfid));
+        if (frame)
+                STACK_DESTROY (frame->root);
+}
+
+int
+shard_unlink_base_file (call_frame_t *frame, xlator_t *this);
+
+int
+shard_purge_mark_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        SHARD_UNSET_ROOT_FS_ID (frame, local);
+
+        if (op_ret < 0)
+                gf_msg (this->name, GF_LOG_WARNING, op_errno,
+                        SHARD_MSG_PURGE_FAILED, "Failed to record the "
+                        "pending deletion of the shards of %s, deleting "
+                        "them before the unlink returns",
+                        uuid_utoa (local->loc.inode->gfid));
+        else
+                local->purge_marked = _gf_true;
+
+        shard_unlink_base_file (frame, this);
+        return 0;
+}
+
+static void
+shard_purge_mark_wind (call_frame_t *frame, xlator_t *this)
+{
+        char            key[sizeof (SHARD_PURGE_XATTR_PREFIX) +
+                            UUID_CANONICAL_FORM_LEN] = {0,};
+        loc_t           loc   = {0,};
+        int64_t        *value = NULL;
+        dict_t         *xattr = NULL;
+        shard_local_t  *local = NULL;
+
+        local = frame->local;
+
+        if (shard_dot_shard_loc_fill (this, &loc))
+                goto skip;
+
+        xattr = dict_new ();
+        value = GF_CALLOC (2, sizeof (int64_t), gf_shard_mt_int64_t);
+        if (!xattr || !value)
+                goto skip;
+
+        value[0] = hton64 (local->block_size);
+        value[1] = hton64 (local->prebuf.ia_size);
+        shard_purge_xattr_key (local->loc.inode->gfid, key, sizeof (key));
+        if (dict_set_bin (xattr, key, value, 2 * sizeof (int64_t)))
+                goto skip;
+        value = NULL;
+
+        SHARD_SET_ROOT_FS_ID (frame, local);
+        STACK_WIND (frame, shard_purge_mark_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->setxattr, &loc, xattr, 0, NULL);
+        loc_wipe (&loc);
+        dict_unref (xattr);
+        return;
+
+skip:
+        GF_FREE (value);
+        if (xattr)
+                dict_unref (xattr);
+        loc_wipe (&loc);
+        shard_unlink_base_file (frame, this);
+}
+
+int
+shard_purge_mark_lookup_cbk (call_frame_t *frame, void *cookie,
+                             xlator_t *this, int32_t op_ret, int32_t op_errno,
+                             inode_t *inode, struct iatt *buf, dict_t *xdata,
+                             struct iatt *postparent)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        /* with no /.shard there is nothing to purge, and with an error the
+         * shards are deleted before the unlink returns */
+        if (op_ret < 0 || !IA_ISDIR (buf->ia_type)) {
+                shard_unlink_base_file (frame, this);
+                return 0;
+        }
+
+        shard_link_dot_shard_inode (local, inode, buf);
+        shard_purge_mark_wind (frame, this);
+        return 0;
+}
+
+/* Records the pending deletion of the shards of the file about to be
+ * unlinked in @frame, then unlinks it. */
+static void
+shard_purge_mark (call_frame_t *frame, xlator_t *this)
+{
+        int           ret   = -1;
+        loc_t         loc   = {0,};
+        inode_t      *inode = NULL;
+        shard_priv_t *priv  = NULL;
+
+        priv = this->private;
+
+        inode = inode_find (this->itable, priv->dot_shard_gfid);
+        if (inode) {
+                inode_unref (inode);
+                shard_purge_mark_wind (frame, this);
+                return;
+        }
+
+        loc.inode = inode_new (this->itable);
+        loc.parent = inode_ref (this->itable->root);
+        ret = inode_path (loc.parent, GF_SHARD_DIR, (char **) &loc.path);
+        if (ret < 0 || !loc.inode) {
+                loc_wipe (&loc);
+                shard_unlink_base_file (frame, this);
+                return;
+        }
+        loc.name = strrchr (loc.path, '/');
+        if (loc.name)
+                loc.name++;
+
+        STACK_WIND (frame, shard_purge_mark_lookup_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->lookup, &loc, NULL);
+        loc_wipe (&loc);
+}
+
+/* Hands the deletion of the shards of the file unlinked in @frame over to a
+ * frame of its own, so that the unlink can be unwound right away.
+ */
+static call_frame_t *
+shard_purge_frame_new (call_frame_t *frame, xlator_t *this)
+{
+        call_frame_t  *purge_frame = NULL;
+        shard_local_t *local       = NULL;
+        shard_local_t *purge_local = NULL;
+        shard_priv_t  *priv        = NULL;
+
+        local = frame->local;
+        priv = this->private;
+
+        purge_frame = copy_frame (frame);
+        if (!purge_frame)
+                goto err;
+
+        purge_local = mem_get0 (this->local_pool);
+        if (!purge_local)
+                goto err;
+        purge_frame->local = purge_local;
+
+        loc_copy (&purge_local->loc, &local->loc);
+        purge_local->xattr_req = dict_new ();
+        if (!purge_local->xattr_req)
+                goto err;
+
+        purge_local->fop = GF_FOP_UNLINK;
+        purge_local->purge = _gf_true;
+        purge_local->purge_marked = local->purge_marked;
+        purge_local->block_size = local->block_size;
+        purge_local->prebuf = local->prebuf;
+        purge_local->first_block = local->first_block;
+        purge_local->last_block = local->last_block;
+        purge_local->num_blocks = local->num_blocks;
+        purge_local->resolver_base_inode = purge_local->loc.inode;
+
+        LOCK (&priv->lock);
+        {
+                priv->purge_count++;
+        }
+        UNLOCK (&priv->lock);
+
+        return purge_frame;
+err:
+        if (purge_frame) {
+                purge_frame->local = NULL;
+                if (purge_local) {
+                        shard_local_wipe (purge_local);
+                        mem_put (purge_local);
+                }
+                STACK_DESTROY (purge_frame->root);
+        }
+        return NULL;
+}
+
+static void
+shard_purge_done (call_frame_t *frame, xlator_t *this)
+{
+        shard_local_t *local = NULL;
+        shard_priv_t  *priv  = NULL;
+
+        local = frame->local;
+        priv = this->private;
+
+        if (local->op_ret < 0)
+                gf_msg (this->name, GF_LOG_WARNING, local->op_errno,
+                        SHARD_MSG_PURGE_FAILED, "Failed to delete the shards "
+                        "of %s in the background, retrying once /.shard is "
+                        "next looked up", uuid_utoa (local->loc.inode->gfid));
+        else if (local->purge_marked)
+                shard_purge_unmark (this, local->loc.inode->gfid);
+
+        LOCK (&priv->lock);
+        {
+                priv->purge_count--;
+        }
+        UNLOCK (&priv->lock);
+
+        frame->local = NULL;
+        shard_local_wipe (local);
+        mem_put (local);
+        STACK_DESTROY (frame->root);
+}
+
 int
 shard_unlink_shards_do (call_frame_t *frame, xlator_t *this, inode_t *inode);
 
@@ -2290,7 +3027,9 @@ shard_post_lookup_shards_unlink_handler (call_frame_t *frame, xlator_t *this)
         local = frame->local;
 
         if ((local->op_ret < 0) && (local->op_errno != ENOENT)) {
-                if (local->fop == GF_FOP_UNLINK)
+                if (local->purge)
+                        shard_purge_done (frame, this);
+                else if (local->fop == GF_FOP_UNLINK)
                         SHARD_STACK_UNWIND (unlink, frame, local->op_ret,
                                             local->op_errno, NULL, NULL, NULL);
                 else
@@ -2336,7 +3075,9 @@ shard_post_resolve_unlink_handler (call_frame_t *frame, xlator_t *this)
                                 shard_rename_cbk (frame, this);
                         return 0;
                 } else {
-                        if (local->fop == GF_FOP_UNLINK)
+                        if (local->purge)
+                                shard_purge_done (frame, this);
+                        else if (local->fop == GF_FOP_UNLINK)
                                 SHARD_STACK_UNWIND (unlink, frame,
                                                     local->op_ret,
                                                     local->op_errno, NULL, NULL,
@@ -2357,21 +3098,54 @@ shard_post_resolve_unlink_handler (call_frame_t *frame, xlator_t *this)
         return 0;
 }
 
+/* Resolves the shards of the file unlinked in @frame, deleting them once
+ * done. */
+static int
+shard_unlink_resolve_shards (call_frame_t *frame, xlator_t *this)
+{
+        int            ret   = -1;
+        shard_local_t *local = NULL;
+        shard_priv_t  *priv  = NULL;
+
+        local = frame->local;
+        priv = this->private;
+
+        local->inode_list = GF_CALLOC (local->num_blocks, sizeof (inode_t *),
+                                       gf_shard_mt_inode_list);
+        if (!local->inode_list)
+                return -1;
+
+        local->dot_shard_loc.inode = inode_find (this->itable,
+                                                 priv->dot_shard_gfid);
+        if (!local->dot_shard_loc.inode) {
+                ret = shard_init_dot_shard_loc (this, local);
+                if (ret)
+                        return -1;
+                shard_lookup_dot_shard (frame, this,
+                                        shard_post_resolve_unlink_handler);
+        } else {
+                local->post_res_handler = shard_post_resolve_unlink_handler;
+                shard_refresh_dot_shard (frame, this);
+        }
+
+        return 0;
+}
+
 int
 shard_unlink_base_file_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                             int32_t op_ret, int32_t op_errno,
                             struct iatt *preparent, struct iatt *postparent,
                             dict_t *xdata)
 {
-        int                  ret        = 0;
-        uint32_t             link_count = 0;
-        shard_local_t       *local      = NULL;
-        shard_priv_t        *priv       = NULL;
+        uint32_t             link_count  = 0;
+        call_frame_t        *purge_frame = NULL;
+        shard_local_t       *local       = NULL;
 
         local = frame->local;
-        priv = this->private;
 
         if (op_ret < 0) {
+                if (local->purge_marked)
+                        shard_purge_unmark (this, local->loc.inode->gfid);
                 SHARD_STACK_UNWIND (unlink, frame, op_ret, op_errno, NULL, NULL,
                                     NULL);
                 return 0;
@@ -2382,8 +3156,11 @@ shard_unlink_base_file_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
          * link count is 1. We can return safely now.
          */
         if ((xdata) && (!dict_get_uint32 (xdata, GET_LINK_COUNT, &link_count))
-            && (link_count > 1))
+            && (link_count > 1)) {
+                if (local->purge_marked)
+                        shard_purge_unmark (this, local->loc.inode->gfid);
                 goto unwind;
+        }
 
         local->first_block = get_lowest_block (0, local->block_size);
         local->last_block = get_highest_block (0, local->prebuf.ia_size,
@@ -2395,13 +3172,11 @@ shard_unlink_base_file_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
          * shard block size. So unlink boils down to unlinking just the
          * base file. We can safely return now.
          */
-        if (local->num_blocks == 1)
-                goto unwind;
-
-        local->inode_list = GF_CALLOC (local->num_blocks, sizeof (inode_t *),
-                                       gf_shard_mt_inode_list);
-        if (!local->inode_list)
+        if (local->num_blocks == 1) {
+                if (local->purge_marked)
+                        shard_purge_unmark (this, local->loc.inode->gfid);
                 goto unwind;
+        }
 
         /* Save the xdata and preparent and postparent iatts now. This will be
          * used at the time of unwinding the call to the parent xl.
@@ -2411,27 +3186,210 @@ shard_unlink_base_file_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         if (xdata)
                 local->xattr_rsp = dict_ref (xdata);
 
-        local->dot_shard_loc.inode = inode_find (this->itable,
-                                                 priv->dot_shard_gfid);
-        if (!local->dot_shard_loc.inode) {
-                ret = shard_init_dot_shard_loc (this, local);
-                if (ret)
-                        goto unwind;
-                shard_lookup_dot_shard (frame, this,
-                                        shard_post_resolve_unlink_handler);
-        } else {
-                local->post_res_handler = shard_post_resolve_unlink_handler;
-                shard_refresh_dot_shard (frame, this);
+        /* With the base file gone the shards can't be reached anymore, so
+         * once their deletion is on record as pending, they may as well be
+         * deleted after the unlink returns. Failing to record it or to get
+         * a frame for it, they are deleted before.
+         */
+        if (local->purge_marked) {
+                purge_frame = shard_purge_frame_new (frame, this);
+                if (purge_frame) {
+                        SHARD_STACK_UNWIND (unlink, frame, op_ret, op_errno,
+                                            preparent, postparent, xdata);
+                        frame = purge_frame;
+                        local = frame->local;
+                }
         }
 
+        if (shard_unlink_resolve_shards (frame, this))
+                goto unwind;
+
         return 0;
 
 unwind:
+        if (local->purge) {
+                local->op_ret = -1;
+                local->op_errno = ENOMEM;
+                shard_purge_done (frame, this);
+                return 0;
+        }
         SHARD_STACK_UNWIND (unlink, frame, op_ret, op_errno,  preparent,
                             postparent, xdata);
         return 0;
 }
 
+int
+shard_purge_resume_lookup_cbk (call_frame_t *frame, void *cookie,
+                               xlator_t *this, int32_t op_ret,
+                               int32_t op_errno, inode_t *inode,
+                               struct iatt *buf, dict_t *xdata,
+                               struct iatt *postparent)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret == 0) {
+                /* the unlink never made it, the shards are still in use */
+                local->op_ret = 0;
+                goto done;
+        }
+
+        if (op_errno != ENOENT && op_errno != ESTALE) {
+                local->op_ret = op_ret;
+                local->op_errno = op_errno;
+                goto done;
+        }
+
+        local->first_block = get_lowest_block (0, local->block_size);
+        local->last_block = get_highest_block (0, local->prebuf.ia_size,
+                                               local->block_size);
+        local->num_blocks = local->last_block - local->first_block + 1;
+        local->resolver_base_inode = local->loc.inode;
+
+        if (local->num_blocks == 1)
+                goto done;
+
+        if (shard_unlink_resolve_shards (frame, this)) {
+                local->op_ret = -1;
+                local->op_errno = ENOMEM;
+                goto done;
+        }
+        return 0;
+
+done:
+        shard_purge_done (frame, this);
+        return 0;
+}
+
+/* Purges the shards of @gfid, left pending, once sure the base file is
+ * gone. */
+static void
+shard_purge_resume_one (xlator_t *this, uuid_t gfid, int64_t block_size,
+                        int64_t size)
+{
+        call_frame_t  *frame = NULL;
+        shard_local_t *local = NULL;
+        shard_priv_t  *priv  = NULL;
+
+        priv = this->private;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame)
+                goto err;
+        frame->root->uid = 0;
+        frame->root->gid = 0;
+
+        local = mem_get0 (this->local_pool);
+        if (!local)
+                goto err;
+        frame->local = local;
+
+        local->loc.inode = inode_new (this->itable);
+        local->xattr_req = dict_new ();
+        if (!local->loc.inode || !local->xattr_req)
+                goto err;
+        /* the base file is looked up, and its shards named, by gfid alone */
+        gf_uuid_copy (local->loc.gfid, gfid);
+        gf_uuid_copy (local->loc.inode->gfid, gfid);
+
+        local->fop = GF_FOP_UNLINK;
+        local->purge = _gf_true;
+        local->purge_marked = _gf_true;
+        local->block_size = block_size;
+        local->prebuf.ia_size = size;
+
+        LOCK (&priv->lock);
+        {
+                priv->purge_count++;
+        }
+        UNLOCK (&priv->lock);
+
+        STACK_WIND (frame, shard_purge_resume_lookup_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->lookup, &local->loc, NULL);
+        return;
+err:
+        gf_msg (this->name, GF_LOG_WARNING, ENOMEM, SHARD_MSG_PURGE_FAILED,
+                "Failed to resume the deletion of the shards of %s",
+                uuid_utoa (gfid));
+        if (frame) {
+                frame->local = NULL;
+                if (local) {
+                        shard_local_wipe (local);
+                        mem_put (local);
+                }
+                STACK_DESTROY (frame->root);
+        }
+}
+
+static int
+shard_purge_resume_xattr (dict_t *dict, char *key, data_t *value, void *data)
+{
+        xlator_t *this  = data;
+        int64_t  *sizes = NULL;
+        uuid_t    gfid  = {0,};
+
+        if (gf_uuid_parse (key + strlen (SHARD_PURGE_XATTR_PREFIX), gfid) ||
+            value->len != 2 * sizeof (int64_t))
+                return 0;
+
+        sizes = (int64_t *) value->data;
+        shard_purge_resume_one (this, gfid, ntoh64 (sizes[0]),
+                                ntoh64 (sizes[1]));
+        return 0;
+}
+
+int
+shard_purge_resume_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *dict,
+                        dict_t *xdata)
+{
+        shard_priv_t *priv = NULL;
+
+        priv = this->private;
+
+        if (op_ret < 0) {
+                gf_msg (this->name, GF_LOG_WARNING, op_errno,
+                        SHARD_MSG_PURGE_FAILED, "Failed to get the pending "
+                        "purges off /.shard");
+                /* the next lookup of /.shard tries again */
+                LOCK (&priv->lock);
+                {
+                        priv->purge_resumed = _gf_false;
+                }
+                UNLOCK (&priv->lock);
+        } else if (dict) {
+                dict_foreach_fnmatch (dict, SHARD_PURGE_XATTR_PREFIX "*",
+                                      shard_purge_resume_xattr, this);
+        }
+
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+/* Resumes the purges left pending on /.shard. */
+static void
+shard_purge_resume (xlator_t *this)
+{
+        loc_t          loc   = {0,};
+        call_frame_t  *frame = NULL;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame)
+                return;
+        frame->root->uid = 0;
+        frame->root->gid = 0;
+
+        if (shard_dot_shard_loc_fill (this, &loc)) {
+                STACK_DESTROY (frame->root);
+                return;
+        }
+
+        STACK_WIND (frame, shard_purge_resume_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->getxattr, &loc, NULL, NULL);
+        loc_wipe (&loc);
+}
+
 int
 shard_unlink_base_file (call_frame_t *frame, xlator_t *this)
 {
@@ -2491,6 +3449,14 @@ shard_unlink_cbk (call_frame_t *frame, xlator_t *this)
 {
         shard_local_t *local = frame->local;
 
+        if (local->purge) {
+                shard_purge_done (frame, this);
+                return 0;
+        }
+
+        if (local->purge_marked && local->op_ret == 0)
+                shard_purge_unmark (this, local->loc.inode->gfid);
+
 	SHARD_STACK_UNWIND (unlink, frame, local->op_ret, local->op_errno,
 			    &local->preoldparent, &local->postoldparent,
                             local->xattr_rsp);
@@ -2509,7 +3475,8 @@ shard_unlink_shards_do_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         local = frame->local;
 
-        if (op_ret < 0) {
+        /* a purge resumed may find shards already gone */
+        if (op_ret < 0 && !(local->purge && op_errno == ENOENT)) {
                 local->op_ret = op_ret;
                 local->op_errno = op_errno;
                 goto done;
@@ -2518,17 +3485,107 @@ shard_unlink_shards_do_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         shard_unlink_block_inode (local, shard_block_num);
 
 done:
+        if (shard_window_done (frame, this))
+                shard_unlink_shards_wind (frame, this);
+
         call_count = shard_call_count_return (frame);
-        if (call_count == 0) {
-                SHARD_UNSET_ROOT_FS_ID (frame, local);
+        if (call_count == 0)
+                shard_unlink_shards_done (frame, this);
+
+        return 0;
+}
+
+int
+shard_unlink_shards_done (call_frame_t *frame, xlator_t *this)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        SHARD_UNSET_ROOT_FS_ID (frame, local);
+
+        if (local->fop == GF_FOP_UNLINK)
+                shard_unlink_cbk (frame, this);
+        else if (local->fop == GF_FOP_RENAME)
+                shard_rename_cbk (frame, this);
+        else
+                shard_truncate_last_shard (frame, this, local->inode_list[0]);
+
+        return 0;
+}
+
+int
+shard_unlink_shards_wind (call_frame_t *frame, xlator_t *this)
+{
+        int               ret            = -1;
+        int               xflag          = 0;
+        int               cur_block      = 0;
+        char             *bname          = NULL;
+        char              path[PATH_MAX] = {0,};
+        loc_t             loc            = {0,};
+        inode_t          *inode          = NULL;
+        dict_t           *xattr_req      = NULL;
+        gf_boolean_t      wind_failed    = _gf_false;
+        gf_boolean_t      last           = _gf_false;
+        shard_local_t    *local          = NULL;
+        shard_priv_t     *priv           = NULL;
+
+        priv = this->private;
+        local = frame->local;
+        inode = local->wind_inode;
+
+        /* Shards beyond the new size of a truncated file are unlinked with
+         * neither the flags nor the xdata of the fop.
+         */
+        if ((local->fop != GF_FOP_TRUNCATE) &&
+            (local->fop != GF_FOP_FTRUNCATE)) {
+                xflag = local->xflag;
+                xattr_req = local->xattr_req;
+        }
+
+        while (!last &&
+               (cur_block = shard_window_next_block (frame, this, _gf_true,
+                                                     &last)) >= 0) {
+                if (wind_failed) {
+                        shard_unlink_shards_do_cbk (frame,
+                                                    (void *) (long) cur_block,
+                                                    this, -1, ENOMEM, NULL,
+                                                    NULL, NULL);
+                        continue;
+                }
+
+                shard_make_block_abspath (cur_block, inode->gfid, path,
+                                          sizeof (path));
+                bname = strrchr (path, '/') + 1;
+                loc.parent = inode_ref (priv->dot_shard_inode);
+                ret = inode_path (loc.parent, bname, (char **) &(loc.path));
+                if (ret < 0) {
+                        gf_msg (this->name, GF_LOG_ERROR, 0,
+                                SHARD_MSG_INODE_PATH_FAILED, "Inode path failed"
+                                " on %s, base file gfid = %s", bname,
+                                uuid_utoa (inode->gfid));
+                        local->op_ret = -1;
+                        local->op_errno = ENOMEM;
+                        loc_wipe (&loc);
+                        wind_failed = _gf_true;
+                        shard_unlink_shards_do_cbk (frame,
+                                                    (void *) (long) cur_block,
+                                                    this, -1, ENOMEM, NULL,
+                                                    NULL, NULL);
+                        continue;
+                }
+
+                loc.name = strrchr (loc.path, '/');
+                if (loc.name)
+                        loc.name++;
+                loc.inode = inode_ref (local->inode_list[cur_block -
+                                                         local->first_block]);
 
-                if (local->fop == GF_FOP_UNLINK)
-                        shard_unlink_cbk (frame, this);
-                else if (local->fop == GF_FOP_RENAME)
-                        shard_rename_cbk (frame, this);
-                else
-                        shard_truncate_last_shard (frame, this,
-                                                   local->inode_list[0]);
+                STACK_WIND_COOKIE (frame, shard_unlink_shards_do_cbk,
+                                   (void *) (long) cur_block, FIRST_CHILD(this),
+                                   FIRST_CHILD (this)->fops->unlink, &loc,
+                                   xflag, xattr_req);
+                loc_wipe (&loc);
         }
 
         return 0;
@@ -2538,27 +3595,11 @@ int
 shard_unlink_shards_do (call_frame_t *frame, xlator_t *this, inode_t *inode)
 {
         int               i              = 0;
-        int               ret            = -1;
         int               count          = 0;
-        int               call_count     = 0;
-        uint32_t          last_block     = 0;
-        uint32_t          cur_block      = 0;
-        char             *bname          = NULL;
-        char              path[PATH_MAX] = {0,};
-        loc_t             loc            = {0,};
-        gf_boolean_t      wind_failed    = _gf_false;
         shard_local_t    *local          = NULL;
-        shard_priv_t     *priv           = NULL;
 
-        priv = this->private;
         local = frame->local;
 
-        /* local->num_blocks includes the base file block. This function only
-         * deletes the shards under /.shard. So subtract num_blocks by 1.
-         */
-        local->call_count = call_count = local->num_blocks - 1;
-        last_block = local->last_block;
-
         /* Ignore the inode associated with the base file and start counting
          * from 1.
          */
@@ -2587,64 +3628,16 @@ shard_unlink_shards_do (call_frame_t *frame, xlator_t *this, inode_t *inode)
                 return 0;
         }
 
-        local->call_count = call_count = count;
-        cur_block = 1;
+        local->call_count = count + 1;
         SHARD_SET_ROOT_FS_ID (frame, local);
 
-        /* Ignore the base file and start iterating from the first block shard.
+        /* Ignore the base file and start winding from the first block shard.
          */
-        while (cur_block <= last_block) {
-                if (!local->inode_list[cur_block]) {
-                        cur_block++;
-                        continue;
-                }
-
-                if (wind_failed) {
-                        shard_unlink_shards_do_cbk (frame,
-                                                    (void *) (long) cur_block,
-                                                    this, -1, ENOMEM, NULL,
-                                                    NULL, NULL);
-                        goto next;
-                }
-
-                shard_make_block_abspath (cur_block, inode->gfid, path,
-                                          sizeof (path));
-                bname = strrchr (path, '/') + 1;
-                loc.parent = inode_ref (priv->dot_shard_inode);
-                ret = inode_path (loc.parent, bname, (char **) &(loc.path));
-                if (ret < 0) {
-                        gf_msg (this->name, GF_LOG_ERROR, 0,
-                                SHARD_MSG_INODE_PATH_FAILED, "Inode path failed"
-                                " on %s, base file gfid = %s", bname,
-                                uuid_utoa (inode->gfid));
-                        local->op_ret = -1;
-                        local->op_errno = ENOMEM;
-                        loc_wipe (&loc);
-                        wind_failed = _gf_true;
-                        shard_unlink_shards_do_cbk (frame,
-                                                    (void *) (long) cur_block,
-                                                    this, -1, ENOMEM, NULL,
-                                                    NULL, NULL);
-                        goto next;
-                }
-
-                loc.name = strrchr (loc.path, '/');
-                if (loc.name)
-                        loc.name++;
-                loc.inode = inode_ref (local->inode_list[cur_block]);
-
-                STACK_WIND_COOKIE (frame, shard_unlink_shards_do_cbk,
-                                   (void *) (long) cur_block, FIRST_CHILD(this),
-                                   FIRST_CHILD (this)->fops->unlink, &loc,
-                                   local->xflag, local->xattr_req);
-                loc_wipe (&loc);
-
-next:
-                cur_block++;
-                if (!--call_count)
-                        break;
-        }
+        shard_window_init (local, 1, count, inode);
+        shard_unlink_shards_wind (frame, this);
 
+        if (shard_call_count_return (frame) == 0)
+                shard_unlink_shards_done (frame, this);
         return 0;
 }
 
@@ -2652,8 +3645,10 @@ int
 shard_post_lookup_unlink_handler (call_frame_t *frame, xlator_t *this)
 {
         shard_local_t *local = NULL;
+        shard_priv_t  *priv  = NULL;
 
         local = frame->local;
+        priv = this->private;
 
         if (local->op_ret < 0) {
                 SHARD_STACK_UNWIND (unlink, frame, local->op_ret,
@@ -2661,7 +3656,12 @@ shard_post_lookup_unlink_handler (call_frame_t *frame, xlator_t *this)
                 return 0;
         }
 
-        shard_unlink_base_file (frame, this);
+        /* a file past its first block may leave shards to purge */
+        if (priv->background_purge &&
+            get_highest_block (0, local->prebuf.ia_size, local->block_size))
+                shard_purge_mark (frame, this);
+        else
+                shard_unlink_base_file (frame, this);
         return 0;
 }
 
@@ -3214,6 +4214,12 @@ next:
         return 0;
 }
 
+int
+shard_common_mknod_wind (call_frame_t *frame, xlator_t *this);
+
+int
+shard_common_mknod_done (call_frame_t *frame, xlator_t *this);
+
 int
 shard_common_mknod_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         int32_t op_ret, int32_t op_errno, inode_t *inode,
@@ -3241,73 +4247,61 @@ shard_common_mknod_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         shard_link_block_inode (local, shard_block_num, inode, buf);
 
 done:
+        if (shard_window_done (frame, this))
+                shard_common_mknod_wind (frame, this);
+
         call_count = shard_call_count_return (frame);
-        if (call_count == 0) {
-                SHARD_UNSET_ROOT_FS_ID (frame, local);
-                local->create_count = 0;
-                local->post_mknod_handler (frame, this);
-        }
+        if (call_count == 0)
+                shard_common_mknod_done (frame, this);
 
         return 0;
 }
 
 int
-shard_common_resume_mknod (call_frame_t *frame, xlator_t *this,
-                           shard_post_mknod_fop_handler_t post_mknod_handler)
+shard_common_mknod_done (call_frame_t *frame, xlator_t *this)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        SHARD_UNSET_ROOT_FS_ID (frame, local);
+        local->create_count = 0;
+        local->post_mknod_handler (frame, this);
+        return 0;
+}
+
+int
+shard_common_mknod_wind (call_frame_t *frame, xlator_t *this)
 {
-        int                 i              = 0;
-        int                 shard_idx_iter = 0;
-        int                 last_block     = 0;
         int                 ret            = 0;
-        int                 call_count     = 0;
+        int                 shard_idx_iter = 0;
         char                path[PATH_MAX] = {0,};
-        mode_t              mode           = 0;
         char               *bname          = NULL;
         shard_priv_t       *priv           = NULL;
-        shard_inode_ctx_t   ctx_tmp        = {0,};
         shard_local_t      *local          = NULL;
         gf_boolean_t        wind_failed    = _gf_false;
-        fd_t               *fd             = NULL;
+        gf_boolean_t        last           = _gf_false;
+        inode_t            *inode          = NULL;
         loc_t               loc            = {0,};
         dict_t             *xattr_req      = NULL;
 
         local = frame->local;
         priv = this->private;
-        fd = local->fd;
-        shard_idx_iter = local->first_block;
-        last_block = local->last_block;
-        call_count = local->call_count = local->create_count;
-        local->post_mknod_handler = post_mknod_handler;
-
-        SHARD_SET_ROOT_FS_ID (frame, local);
-
-        ret = shard_inode_ctx_get_all (fd->inode, this, &ctx_tmp);
-        if (ret) {
-                gf_msg (this->name, GF_LOG_ERROR, 0,
-                        SHARD_MSG_INODE_CTX_GET_FAILED, "Failed to get inode "
-                        "ctx for %s", uuid_utoa (fd->inode->gfid));
-                local->op_ret = -1;
-                local->op_errno = ENOMEM;
-                goto err;
-        }
-        mode = st_mode_from_ia (ctx_tmp.stat.ia_prot, ctx_tmp.stat.ia_type);
-
-        while (shard_idx_iter <= last_block) {
-                if (local->inode_list[i]) {
-                        shard_idx_iter++;
-                        i++;
-                        continue;
-                }
+        inode = local->wind_inode;
 
+        while (!last &&
+               (shard_idx_iter = shard_window_next_block (frame, this,
+                                                          _gf_false,
+                                                          &last)) >= 0) {
                 if (wind_failed) {
                         shard_common_mknod_cbk (frame,
                                                 (void *) (long) shard_idx_iter,
                                                 this, -1, ENOMEM, NULL, NULL,
                                                 NULL, NULL, NULL);
-                        goto next;
+                        continue;
                 }
 
-                shard_make_block_abspath (shard_idx_iter, fd->inode->gfid,
+                shard_make_block_abspath (shard_idx_iter, inode->gfid,
                                           path, sizeof(path));
 
                 xattr_req = shard_create_gfid_dict (local->xattr_req);
@@ -3319,7 +4313,7 @@ shard_common_resume_mknod (call_frame_t *frame, xlator_t *this,
                                                 (void *) (long) shard_idx_iter,
                                                 this, -1, ENOMEM, NULL, NULL,
                                                 NULL, NULL, NULL);
-                        goto next;
+                        continue;
                 }
 
                 bname = strrchr (path, '/') + 1;
@@ -3331,7 +4325,7 @@ shard_common_resume_mknod (call_frame_t *frame, xlator_t *this,
                         gf_msg (this->name, GF_LOG_ERROR, 0,
                                 SHARD_MSG_INODE_PATH_FAILED, "Inode path failed"
                                 "on %s, base file gfid = %s", bname,
-                                uuid_utoa (fd->inode->gfid));
+                                uuid_utoa (inode->gfid));
                         local->op_ret = -1;
                         local->op_errno = ENOMEM;
                         wind_failed = _gf_true;
@@ -3341,7 +4335,7 @@ shard_common_resume_mknod (call_frame_t *frame, xlator_t *this,
                                                 (void *) (long) shard_idx_iter,
                                                 this, -1, ENOMEM, NULL, NULL,
                                                 NULL, NULL, NULL);
-                        goto next;
+                        continue;
                 }
 
                 loc.name = strrchr (loc.path, '/');
@@ -3352,22 +4346,55 @@ shard_common_resume_mknod (call_frame_t *frame, xlator_t *this,
                                    (void *) (long) shard_idx_iter,
                                    FIRST_CHILD(this),
                                    FIRST_CHILD(this)->fops->mknod, &loc,
-                                   mode, ctx_tmp.stat.ia_rdev, 0, xattr_req);
+                                   local->mode, local->rdev, 0, xattr_req);
                 loc_wipe (&loc);
                 dict_unref (xattr_req);
+        }
 
-next:
-                shard_idx_iter++;
-                i++;
-                if (!--call_count)
-                        break;
+        return 0;
+}
+
+int
+shard_common_resume_mknod (call_frame_t *frame, xlator_t *this,
+                           shard_post_mknod_fop_handler_t post_mknod_handler)
+{
+        int                 ret            = 0;
+        shard_inode_ctx_t   ctx_tmp        = {0,};
+        shard_local_t      *local          = NULL;
+        fd_t               *fd             = NULL;
+
+        local = frame->local;
+        fd = local->fd;
+        local->call_count = local->create_count;
+        local->post_mknod_handler = post_mknod_handler;
+
+        SHARD_SET_ROOT_FS_ID (frame, local);
+
+        ret = shard_inode_ctx_get_all (fd->inode, this, &ctx_tmp);
+        if (ret) {
+                gf_msg (this->name, GF_LOG_ERROR, 0,
+                        SHARD_MSG_INODE_CTX_GET_FAILED, "Failed to get inode "
+                        "ctx for %s", uuid_utoa (fd->inode->gfid));
+                local->op_ret = -1;
+                local->op_errno = ENOMEM;
+                goto err;
         }
+        local->mode = st_mode_from_ia (ctx_tmp.stat.ia_prot,
+                                       ctx_tmp.stat.ia_type);
+        local->rdev = ctx_tmp.stat.ia_rdev;
 
+        shard_window_init (local, local->first_block, local->call_count,
+                           fd->inode);
+        local->call_count++;
+        shard_common_mknod_wind (frame, this);
+
+        if (shard_call_count_return (frame) == 0)
+                shard_common_mknod_done (frame, this);
         return 0;
 err:
         /*
          * This block is for handling failure in shard_inode_ctx_get_all().
-         * Failures in the while-loop are handled within the loop.
+         * Failures to wind are handled in shard_common_mknod_wind().
          */
         SHARD_UNSET_ROOT_FS_ID (frame, local);
         post_mknod_handler (frame, this);
@@ -3670,6 +4697,73 @@ shard_get_delta_size_from_inode_ctx (shard_local_t *local, inode_t *inode,
         return ret;
 }
 
+/* With shard-size-update-interval set, the size and block count changes of
+ * a write are kept in the inode ctx of the base file, and written to its
+ * size xattr by the next fsync, flush, truncate, release or the timer. If
+ * the timer cannot be armed, the write takes its own changes back and
+ * updates the size with them as it would without the interval.
+ */
+int
+shard_common_inode_write_update_size (call_frame_t *frame, xlator_t *this)
+{
+        int                 ret           = -1;
+        gf_boolean_t        was_unflushed = _gf_false;
+        gf_boolean_t        is_unflushed  = _gf_false;
+        inode_t            *inode         = NULL;
+        shard_priv_t       *priv          = NULL;
+        shard_local_t      *local         = NULL;
+        shard_inode_ctx_t  *ctx           = NULL;
+
+        priv = this->private;
+        local = frame->local;
+        inode = local->fd->inode;
+
+        if (!priv->size_update_interval ||
+            ((local->delta_size == 0) && (local->delta_blocks == 0)))
+                goto update;
+
+        LOCK (&inode->lock);
+        {
+                ret = __shard_inode_ctx_get (inode, this, &ctx);
+                if (ret == 0) {
+                        was_unflushed = __shard_inode_ctx_is_unflushed (ctx);
+                        ctx->unflushed_size += local->delta_size;
+                        ctx->unflushed_blocks += local->delta_blocks;
+                        ctx->stat.ia_blocks += local->delta_blocks;
+                        local->postbuf = ctx->stat;
+                        is_unflushed = __shard_inode_ctx_is_unflushed (ctx);
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        if (ret)
+                goto update;
+
+        shard_unflushed_count_update (priv, was_unflushed, is_unflushed);
+
+        if (shard_queue_size_update (this, inode, ctx) == 0) {
+                shard_common_inode_write_post_update_size_handler (frame,
+                                                                   this);
+                return 0;
+        }
+
+        LOCK (&inode->lock);
+        {
+                was_unflushed = __shard_inode_ctx_is_unflushed (ctx);
+                ctx->unflushed_size -= local->delta_size;
+                ctx->unflushed_blocks -= local->delta_blocks;
+                is_unflushed = __shard_inode_ctx_is_unflushed (ctx);
+        }
+        UNLOCK (&inode->lock);
+
+        shard_unflushed_count_update (priv, was_unflushed, is_unflushed);
+
+update:
+        shard_update_file_size (frame, this, local->fd, NULL,
+                             shard_common_inode_write_post_update_size_handler);
+        return 0;
+}
+
 int
 shard_common_inode_write_do_cbk (call_frame_t *frame, void *cookie,
                                  xlator_t *this, int32_t op_ret,
@@ -3717,8 +4811,7 @@ shard_common_inode_write_do_cbk (call_frame_t *frame, void *cookie,
                         local->hole_size = 0;
                         if (xdata)
                                 local->xattr_rsp = dict_ref (xdata);
-                        shard_update_file_size (frame, this, local->fd, NULL,
-                             shard_common_inode_write_post_update_size_handler);
+                        shard_common_inode_write_update_size (frame, this);
                 }
         }
 
@@ -4100,10 +5193,50 @@ shard_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 int
-shard_flush (call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+shard_post_update_size_flush_handler (call_frame_t *frame, xlator_t *this)
 {
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (local->op_ret < 0) {
+                SHARD_STACK_UNWIND (flush, frame, local->op_ret,
+                                    local->op_errno, NULL);
+                return 0;
+        }
+
         STACK_WIND (frame, shard_flush_cbk, FIRST_CHILD(this),
-                    FIRST_CHILD(this)->fops->flush, fd, xdata);
+                    FIRST_CHILD(this)->fops->flush, local->fd,
+                    local->xattr_req);
+        return 0;
+}
+
+int
+shard_flush (call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+{
+        shard_local_t *local = NULL;
+
+        if (!shard_inode_ctx_has_unflushed_size (fd->inode, this)) {
+                STACK_WIND (frame, shard_flush_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->flush, fd, xdata);
+                return 0;
+        }
+
+        local = mem_get0 (this->local_pool);
+        if (!local)
+                goto err;
+
+        frame->local = local;
+        local->fop = GF_FOP_FLUSH;
+        local->fd = fd_ref (fd);
+        if (xdata)
+                local->xattr_req = dict_ref (xdata);
+
+        shard_update_file_size (frame, this, fd, NULL,
+                                shard_post_update_size_flush_handler);
+        return 0;
+err:
+        SHARD_STACK_UNWIND (flush, frame, -1, ENOMEM, NULL);
         return 0;
 }
 
@@ -4123,12 +5256,54 @@ out:
         return 0;
 }
 
+int
+shard_post_update_size_fsync_handler (call_frame_t *frame, xlator_t *this)
+{
+        shard_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (local->op_ret < 0) {
+                SHARD_STACK_UNWIND (fsync, frame, local->op_ret,
+                                    local->op_errno, NULL, NULL, NULL);
+                return 0;
+        }
+
+        STACK_WIND (frame, shard_fsync_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fsync, local->fd, local->flags,
+                    local->xattr_req);
+        return 0;
+}
+
 int
 shard_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
              dict_t *xdata)
 {
-        STACK_WIND (frame, shard_fsync_cbk, FIRST_CHILD(this),
-                    FIRST_CHILD(this)->fops->fsync, fd, datasync, xdata);
+        shard_local_t *local = NULL;
+
+        if (!shard_inode_ctx_has_unflushed_size (fd->inode, this)) {
+                STACK_WIND (frame, shard_fsync_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->fsync, fd, datasync,
+                            xdata);
+                return 0;
+        }
+
+        local = mem_get0 (this->local_pool);
+        if (!local)
+                goto err;
+
+        frame->local = local;
+        local->fop = GF_FOP_FSYNC;
+        local->fd = fd_ref (fd);
+        local->flags = datasync;
+        if (xdata)
+                local->xattr_req = dict_ref (xdata);
+
+        shard_update_file_size (frame, this, fd, NULL,
+                                shard_post_update_size_fsync_handler);
+        return 0;
+err:
+        SHARD_STACK_UNWIND (fsync, frame, -1, ENOMEM, NULL, NULL, NULL);
         return 0;
 }
 
@@ -4917,6 +6092,12 @@ init (xlator_t *this)
                 goto out;
 
         GF_OPTION_INIT ("shard-block-size", priv->block_size, size_uint64, out);
+        GF_OPTION_INIT ("shard-fop-window", priv->fop_window, int32, out);
+        GF_OPTION_INIT ("shard-background-purge", priv->background_purge, bool,
+                        out);
+        GF_OPTION_INIT ("shard-deletion-rate", priv->deletion_rate, int32, out);
+        GF_OPTION_INIT ("shard-size-update-interval",
+                        priv->size_update_interval, time, out);
 
         this->local_pool = mem_pool_new (shard_local_t, 128);
         if (!this->local_pool) {
@@ -4928,6 +6109,8 @@ init (xlator_t *this)
         this->private = priv;
         LOCK_INIT (&priv->lock);
         INIT_LIST_HEAD (&priv->ilist_head);
+        INIT_LIST_HEAD (&priv->unflushed_head);
+        GF_ATOMIC_INIT (priv->unflushed_count, 0);
         ret = 0;
 out:
         if  (ret) {
@@ -4942,7 +6125,9 @@ out:
 void
 fini (xlator_t *this)
 {
-        shard_priv_t *priv = NULL;
+        shard_priv_t      *priv = NULL;
+        shard_inode_ctx_t *ctx  = NULL;
+        shard_inode_ctx_t *tmp  = NULL;
 
         GF_VALIDATE_OR_GOTO ("shard", this, out);
 
@@ -4953,6 +6138,18 @@ fini (xlator_t *this)
         if (!priv)
                 goto out;
 
+        /* Size changes still held back by now are lost; flush and fsync
+         * would have written them.
+         */
+        if (priv->size_update_timer)
+                gf_timer_call_cancel (this->ctx, priv->size_update_timer);
+        list_for_each_entry_safe (ctx, tmp, &priv->unflushed_head,
+                                  unflushed_list) {
+                list_del_init (&ctx->unflushed_list);
+                inode_unref (ctx->unflushed_inode);
+                ctx->unflushed_inode = NULL;
+        }
+
         this->private = NULL;
         LOCK_DESTROY (&priv->lock);
         GF_FREE (priv);
@@ -4971,6 +6168,14 @@ reconfigure (xlator_t *this, dict_t *options)
 
         GF_OPTION_RECONF ("shard-block-size", priv->block_size, options, size,
                           out);
+        GF_OPTION_RECONF ("shard-fop-window", priv->fop_window, options, int32,
+                          out);
+        GF_OPTION_RECONF ("shard-background-purge", priv->background_purge,
+                          options, bool, out);
+        GF_OPTION_RECONF ("shard-deletion-rate", priv->deletion_rate, options,
+                          int32, out);
+        GF_OPTION_RECONF ("shard-size-update-interval",
+                          priv->size_update_interval, options, time, out);
 
         ret = 0;
 
@@ -4998,7 +6203,9 @@ shard_forget (xlator_t *this, inode_t *inode)
 int
 shard_release (xlator_t *this, fd_t *fd)
 {
-        /* TBD */
+        /* Not every close goes through flush */
+        if (shard_inode_ctx_has_unflushed_size (fd->inode, this))
+                shard_update_file_size_bg (this, fd->inode);
         return 0;
 }
 
@@ -5018,6 +6225,14 @@ shard_priv_dump (xlator_t *this)
         gf_proc_dump_write ("inode-count", "%d", priv->inode_count);
         gf_proc_dump_write ("ilist_head", "%p", &priv->ilist_head);
         gf_proc_dump_write ("lru-max-limit", "%d", SHARD_MAX_INODES);
+        gf_proc_dump_write ("fop-window", "%d", priv->fop_window);
+        gf_proc_dump_write ("background-purge", "%d", priv->background_purge);
+        gf_proc_dump_write ("deletion-rate", "%d", priv->deletion_rate);
+        gf_proc_dump_write ("purges-in-progress", "%d", priv->purge_count);
+        gf_proc_dump_write ("size-update-interval", "%u",
+                            priv->size_update_interval);
+        gf_proc_dump_write ("files-with-unflushed-size", "%"PRId64,
+                            GF_ATOMIC_GET (priv->unflushed_count));
 
         return 0;
 }
@@ -5079,5 +6294,43 @@ struct volume_options options[] = {
            .description = "The size unit used to break a file into multiple "
                           "chunks",
         },
+        {  .key = {"shard-fop-window"},
+           .type = GF_OPTION_TYPE_INT,
+           .default_value = "64",
+           .min = 1,
+           .max = 1024,
+           .description = "The number of lookups, creates or deletes of shards "
+                          "a fop keeps in flight at most",
+        },
+        {  .key = {"shard-background-purge"},
+           .type = GF_OPTION_TYPE_BOOL,
+           .default_value = "off",
+           .description = "When enabled, unlink of a sharded file returns as "
+                          "soon as the base file is gone and its shards are "
+                          "deleted in the background. The pending deletion "
+                          "is recorded on /.shard first, and resumed by the "
+                          "next client should this one go down before it is "
+                          "done",
+        },
+        {  .key = {"shard-deletion-rate"},
+           .type = GF_OPTION_TYPE_INT,
+           .default_value = "16",
+           .min = 1,
+           .max = 1024,
+           .description = "The number of deletes of shards a background purge "
+                          "keeps in flight at most",
+        },
+        {  .key = {"shard-size-update-interval"},
+           .type = GF_OPTION_TYPE_TIME,
+           .default_value = "0",
+           .min = 0,
+           .max = 60,
+           .description = "When non-zero, size and block count changes of "
+                          "writes are kept on the client and written to the "
+                          "size xattr of the file at most this many seconds "
+                          "later, or on fsync, flush or close, which saves "
+                          "writes extending or filling in a file an xattrop "
+                          "each. Other clients see such changes late.",
+        },
         { .key = {NULL} },
 };
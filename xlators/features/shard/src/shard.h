@@ -15,12 +15,16 @@
 #include "xlator.h"
 #include "compat-errno.h"
 #include "shard-messages.h"
+#include "timer.h"
 
 #define GF_SHARD_DIR ".shard"
 #define SHARD_MIN_BLOCK_SIZE  (4 * GF_UNIT_MB)
 #define SHARD_MAX_BLOCK_SIZE  (4 * GF_UNIT_TB)
 #define SHARD_XATTR_PREFIX "trusted.glusterfs.shard."
 #define GF_XATTR_SHARD_BLOCK_SIZE "trusted.glusterfs.shard.block-size"
+/* xattr of /.shard recording a pending background purge, suffixed with the
+ * gfid of the base file and holding its block size and size */
+#define SHARD_PURGE_XATTR_PREFIX SHARD_XATTR_PREFIX "purge."
 #define SHARD_INODE_LRU_LIMIT 4096
 #define SHARD_MAX_INODES 16384
 /**
@@ -179,6 +183,15 @@ typedef struct shard_priv {
         gf_lock_t lock;
         int inode_count;
         struct list_head ilist_head;
+        int32_t fop_window;
+        int32_t deletion_rate;
+        gf_boolean_t background_purge;
+        int purge_count;
+        gf_boolean_t purge_resumed;
+        uint32_t size_update_interval;
+        gf_timer_t *size_update_timer;
+        struct list_head unflushed_head;
+        gf_atomic_t unflushed_count;
 } shard_priv_t;
 
 typedef struct {
@@ -256,6 +269,24 @@ typedef struct shard_local {
         } lock;
         inode_t *resolver_base_inode;
         gf_boolean_t first_lookup_done;
+        /* Calls on the shards are wound through a window of
+         * shard-fop-window (shard-deletion-rate when purging) calls in
+         * flight. wind_iter is the next block to consider, wind_count the
+         * number of calls left to wind. winding is set while a wind loop
+         * is on some stack: callbacks then leave the refill to it.
+         */
+        int wind_iter;
+        int wind_count;
+        int inflight;
+        gf_boolean_t winding;
+        inode_t *wind_inode;
+        mode_t mode;
+        dev_t rdev;
+        gf_boolean_t purge;
+        gf_boolean_t purge_marked;
+        int64_t flushed_size;
+        int64_t flushed_blocks;
+        gf_boolean_t flushing;
 } shard_local_t;
 
 typedef struct shard_inode_ctx {
@@ -270,6 +301,16 @@ typedef struct shard_inode_ctx {
         uuid_t base_gfid;
         int block_num;
         gf_boolean_t refreshed;
+        /* Base file only: size and block count changes not yet written to
+         * GF_XATTR_SHARD_FILE_SIZE, and the number of xattrops carrying
+         * such changes still in flight. stat is authoritative as long as
+         * either is non-zero.
+         */
+        int64_t unflushed_size;
+        int64_t unflushed_blocks;
+        int flushing;
+        struct list_head unflushed_list;
+        inode_t *unflushed_inode;
 } shard_inode_ctx_t;
 
 #endif /* __SHARD_H__ */
@@ -96,7 +96,7 @@
 int
 send_attach_req (xlator_t *this, struct rpc_clnt *rpc, char *path, int op);
 
-static gf_boolean_t
+gf_boolean_t
 is_brick_mx_enabled ()
 {
         char            *value = NULL;
@@ -1978,6 +1978,10 @@ retry:
         if (volinfo->memory_accounting)
                 runner_add_arg (&runner, "--mem-accounting");
 
+        if (dict_get_str_boolean (volinfo->dict, "server.event-pin-workers",
+                                  _gf_false) > 0)
+                runner_add_arg (&runner, "--event-pin-workers");
+
         runner_log (&runner, "", 0, "Starting GlusterFS");
 
         brickinfo->port = port;
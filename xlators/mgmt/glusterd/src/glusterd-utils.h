@@ -382,6 +382,9 @@ glusterd_get_all_volnames (dict_t *dict);
 gf_boolean_t
 glusterd_is_fuse_available ();
 
+gf_boolean_t
+is_brick_mx_enabled ();
+
 int
 glusterd_brick_statedump (glusterd_volinfo_t *volinfo,
                           glusterd_brickinfo_t *brickinfo,
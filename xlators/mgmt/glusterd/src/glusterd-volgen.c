@@ -1799,6 +1799,13 @@ brick_graph_add_iot (volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
                                 volinfo->volname);
         if (!xl)
                 goto out;
+
+        /* bricks attached to one process share its io-threads workers */
+        if (is_brick_mx_enabled ()) {
+                ret = xlator_set_option (xl, "shared-pool", "on");
+                if (ret)
+                        goto out;
+        }
         ret = 0;
 out:
         return ret;
@@ -2020,6 +2027,7 @@ brick_graph_add_quota (volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
         int             ret = -1;
         xlator_t        *xl = NULL;
         char            *value = NULL;
+        char             buf[32] = {0,};
 
         if (!graph || !volinfo || !set_dict)
                 goto out;
@@ -2032,6 +2040,12 @@ brick_graph_add_quota (volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
         if (ret)
                 goto out;
 
+        /* every brick may hold a lease on the same directory */
+        snprintf (buf, sizeof (buf), "%d", volinfo->brick_count);
+        ret = xlator_set_option (xl, "lease-share", buf);
+        if (ret)
+                goto out;
+
         ret = glusterd_volinfo_get (volinfo, VKEY_FEATURES_QUOTA, &value);
         if (value) {
                 ret = xlator_set_option (xl, "server-quota", value);
@@ -4339,6 +4353,13 @@ bitrot_option_handler (volgen_graph_t *graph, struct volopt_map_entry *vme,
                         return -1;
         }
 
+        if (!strcmp (vme->option, "signature-chunk-size") ||
+            !strcmp (vme->option, "hash-threads")) {
+                ret = xlator_set_option (xl, vme->option, vme->value);
+                if (ret)
+                        return -1;
+        }
+
         return ret;
 }
 
@@ -4364,6 +4385,12 @@ scrubber_option_handler (volgen_graph_t *graph, struct volopt_map_entry *vme,
                         return -1;
         }
 
+        if (!strcmp (vme->option, "hash-threads")) {
+                ret = xlator_set_option (xl, vme->option, vme->value);
+                if (ret)
+                        return -1;
+        }
+
         if (!strcmp (vme->option, "scrub-frequency")) {
                 ret = gf_asprintf (&scrub_option, "scrub-freq");
                 if (ret != -1) {
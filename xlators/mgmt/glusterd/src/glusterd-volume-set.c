@@ -1518,6 +1518,21 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .voltype     = "performance/io-threads",
           .op_version  = 1
         },
+        { .key         = "performance.io-thread-inode-affinity",
+          .voltype     = "performance/io-threads",
+          .option      = "inode-affinity",
+          .op_version  = GD_OP_VERSION_4_0_0
+        },
+        { .key         = "performance.io-thread-shared-pool",
+          .voltype     = "performance/io-threads",
+          .option      = "shared-pool",
+          .op_version  = GD_OP_VERSION_4_0_0
+        },
+        { .key         = "performance.io-thread-fair-share-weight",
+          .voltype     = "performance/io-threads",
+          .option      = "fair-share-weight",
+          .op_version  = GD_OP_VERSION_4_0_0
+        },
 
         /* Other perf xlators' options */
         { .key        = "performance.cache-size",
@@ -1544,6 +1559,24 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "performance.write-behind-aggregate-size",
+          .voltype    = "performance/write-behind",
+          .option     = "aggregate-size",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "performance.write-behind-dirty-limit",
+          .voltype    = "performance/write-behind",
+          .option     = "dirty-limit",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "performance.write-behind-writeback-age",
+          .voltype    = "performance/write-behind",
+          .option     = "writeback-age",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "performance.resync-failed-syncs-after-fsync",
           .voltype    = "performance/write-behind",
           .option     = "resync-failed-syncs-after-fsync",
@@ -1600,12 +1633,54 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 3,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "performance.ssd-cache-dir",
+          .voltype    = "performance/ssd-cache",
+          .option     = "cache-dir",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "performance.ssd-cache-size",
+          .voltype    = "performance/ssd-cache",
+          .option     = "cache-size",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "performance.ssd-cache-timeout",
+          .voltype    = "performance/ssd-cache",
+          .option     = "cache-timeout",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "performance.ssd-cache-admit-policy",
+          .voltype    = "performance/ssd-cache",
+          .option     = "admit-policy",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "performance.ssd-cache-min-file-size",
+          .voltype    = "performance/ssd-cache",
+          .option     = "min-file-size",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "performance.ssd-cache-max-file-size",
+          .voltype    = "performance/ssd-cache",
+          .option     = "max-file-size",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "performance.read-ahead-page-count",
           .voltype    = "performance/read-ahead",
           .option     = "page-count",
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "performance.read-ahead-prefetch-limit",
+          .voltype    = "performance/read-ahead",
+          .option     = "prefetch-limit",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "performance.md-cache-timeout",
           .voltype    = "performance/md-cache",
           .option     = "md-cache-timeout",
@@ -1788,6 +1863,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type        = GLOBAL_DOC,
           .op_version  = 3
         },
+        { .key         = "server.flow-control",
+          .voltype     = "protocol/server",
+          .option      = "rpc.flow-control",
+          .op_version  = GD_OP_VERSION_4_0_0,
+        },
+        { .key         = "server.flow-target-delay",
+          .voltype     = "protocol/server",
+          .option      = "rpc.flow-target-delay",
+          .op_version  = GD_OP_VERSION_4_0_0,
+        },
         { .key         = "features.lock-heal",
           .voltype     = "protocol/server",
           .option      = "lk-heal",
@@ -1827,6 +1912,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type        = NO_DOC,
           .op_version  = GD_OP_VERSION_3_6_0,
         },
+        { .key         = "client.compact-dict",
+          .voltype     = "protocol/client",
+          .option      = "compact-dict",
+          .op_version  = GD_OP_VERSION_4_0_0,
+        },
+        { .key         = "server.compact-dict",
+          .voltype     = "protocol/server",
+          .option      = "compact-dict",
+          .op_version  = GD_OP_VERSION_4_0_0,
+        },
         { .key         = "server.gid-timeout",
           .voltype     = "protocol/server",
           .op_version  = GD_OP_VERSION_3_6_0,
@@ -1841,6 +1936,14 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .voltype     = "protocol/server",
           .op_version  = GD_OP_VERSION_3_7_0,
         },
+        { .key         = "server.event-pin-workers",
+          .voltype     = "mgmt/glusterd",
+          .value       = "off",
+          .op_version  = GD_OP_VERSION_4_0_0,
+          .description = "Start the bricks with --event-pin-workers, so that "
+                         "every connection stays on one event thread. Takes "
+                         "effect when the bricks are (re)started."
+        },
 
         /* Generic transport options */
         { .key         = SSL_OWN_CERT_OPT,
@@ -1891,6 +1994,17 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         },
 
         /* Performance xlators enable/disbable options */
+        { .key         = "performance.ssd-cache",
+          .voltype     = "performance/ssd-cache",
+          .option      = "!perf",
+          .value       = "off",
+          .op_version  = GD_OP_VERSION_4_0_0,
+          .description = "enable/disable the local SSD page cache "
+                         "translator in the volume. Takes "
+                         "performance.ssd-cache-dir as the directory to "
+                         "keep the pages in.",
+          .flags       = OPT_FLAG_CLIENT_OPT | OPT_FLAG_XLATOR_OPT
+        },
         { .key         = "performance.write-behind",
           .voltype     = "performance/write-behind",
           .option      = "!perf",
@@ -2131,6 +2245,25 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type          = NO_DOC,
           .op_version    = 3,
         },
+        { .key           = "features.quota-lease-size",
+          .voltype       = "features/quota",
+          .option        = "lease-size",
+          .value         = "0",
+          .op_version    = GD_OP_VERSION_4_0_0,
+          .description   = "Largest lease of a directory's free space a "
+                           "brick can get from quotad. Writes that fit in "
+                           "the lease are not checked again against the "
+                           "limit. Leases get smaller as usage gets close to "
+                           "the hard-limit. 0 disables leases."
+        },
+        { .key           = "features.quota-lease-timeout",
+          .voltype       = "features/quota",
+          .option        = "lease-timeout",
+          .value         = "5",
+          .op_version    = GD_OP_VERSION_4_0_0,
+          .description   = "Number of seconds a lease of quota space is good "
+                           "for."
+        },
         { .key           = "features.quota-deem-statfs",
           .voltype       = "features/quota",
           .option        = "deem-statfs",
@@ -2189,6 +2322,14 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .flags       = OPT_FLAG_NEVER_RESET,
           .op_version  = 1
         },
+        { .key         = "features.quota-update-delay",
+          .voltype     = "features/marker",
+          .option      = "quota-update-delay",
+          .op_version  = GD_OP_VERSION_4_0_0,
+          .description = "Milliseconds during which the size updates of a "
+                         "brick are gathered before they are propagated up "
+                         "the tree together. 0 propagates each one at once."
+        },
         { .key         = VKEY_FEATURES_BITROT,
           .voltype     = "features/bit-rot",
           .option      = "bitrot",
@@ -2554,6 +2695,14 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .voltype     = "storage/posix",
           .op_version  = 3
         },
+        { .key         = "storage.readdirp-threads",
+          .voltype     = "storage/posix",
+          .op_version  = GD_OP_VERSION_4_0_0
+        },
+        { .key         = "storage.handle-cache-size",
+          .voltype     = "storage/posix",
+          .op_version  = GD_OP_VERSION_4_0_0
+        },
         { .option      = "update-link-count-parent",
           .key         = "storage.build-pgfid",
           .voltype     = "storage/posix",
@@ -2620,6 +2769,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type        = NO_DOC,
           .op_version  = 3
         },
+        { .key         = "changelog.group-commit",
+          .voltype     = "features/changelog",
+          .type        = NO_DOC,
+          .op_version  = GD_OP_VERSION_4_0_0
+        },
+        { .key         = "changelog.group-commit-delay",
+          .voltype     = "features/changelog",
+          .type        = NO_DOC,
+          .op_version  = GD_OP_VERSION_4_0_0
+        },
         { .key         = "features.barrier",
           .voltype     = "features/barrier",
           .value       = "disable",
@@ -2924,6 +3083,34 @@ struct volopt_map_entry glusterd_volopt_map[] = {
                          "The max value is 262144 pages i.e 1 GB and "
                          "the min value is 1000 pages i.e ~4 MB."
         },
+        { .key         = "features.ctr-heat-batch-size",
+          .voltype     = "features/changetimerecorder",
+          .value       = "4096",
+          .option      = "ctr-heat-batch-size",
+          .op_version  = GD_OP_VERSION_4_0_0,
+          .description = "Number of files whose heat is gathered in memory "
+                         "by changetimerecorder before it is written to the "
+                         "database in a single transaction. 0 writes the "
+                         "heat of every fop synchronously."
+        },
+        { .key         = "features.ctr-heat-flush-interval",
+          .voltype     = "features/changetimerecorder",
+          .value       = "1000",
+          .option      = "ctr-heat-flush-interval",
+          .op_version  = GD_OP_VERSION_4_0_0,
+          .description = "Milliseconds after which heat gathered in memory "
+                         "by changetimerecorder is written to the database."
+        },
+        { .key         = "features.ctr-heat-max-backlog",
+          .voltype     = "features/changetimerecorder",
+          .value       = "262144",
+          .option      = "ctr-heat-max-backlog",
+          .op_version  = GD_OP_VERSION_4_0_0,
+          .type        = NO_DOC,
+          .description = "Number of files whose heat may wait for the "
+                         "database. Heat of further files is dropped until "
+                         "the backlog drains."
+        },
 #endif /* USE_GFDB */
         { .key         = "locks.trace",
           .voltype     = "features/locks",
@@ -2966,6 +3153,26 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = GD_OP_VERSION_3_7_0,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "features.shard-fop-window",
+          .voltype    = "features/shard",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "features.shard-background-purge",
+          .voltype    = "features/shard",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "features.shard-deletion-rate",
+          .voltype    = "features/shard",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "features.shard-size-update-interval",
+          .voltype    = "features/shard",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "features.scrub-throttle",
           .voltype    = "features/bit-rot",
           .value      = "lazy",
@@ -2994,6 +3201,18 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = GD_OP_VERSION_3_7_0,
           .type       = NO_DOC,
         },
+        { .key        = "features.signature-chunk-size",
+          .voltype    = "features/bit-rot",
+          .option     = "signature-chunk-size",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .type       = NO_DOC,
+        },
+        { .key        = "features.hash-threads",
+          .voltype    = "features/bit-rot",
+          .option     = "hash-threads",
+          .op_version = GD_OP_VERSION_4_0_0,
+          .type       = NO_DOC,
+        },
         /* Upcall translator options */
         { .key         = "features.cache-invalidation",
           .voltype     = "features/upcall",
@@ -109,8 +109,8 @@ __ioc_inode_flush (ioc_inode_t *ioc_inode)
         int64_t     destroy_size = 0;
         int64_t     ret          = 0;
 
-        list_for_each_entry_safe (curr, next, &ioc_inode->cache.page_lru,
-                                  page_lru) {
+        list_for_each_entry_safe (curr, next, &ioc_inode->cache.pages,
+                                  page_list) {
                 ret = __ioc_page_destroy (curr);
 
                 if (ret != -1)
@@ -123,22 +123,12 @@ __ioc_inode_flush (ioc_inode_t *ioc_inode)
 void
 ioc_inode_flush (ioc_inode_t *ioc_inode)
 {
-        int64_t destroy_size = 0;
-
         ioc_inode_lock (ioc_inode);
         {
-                destroy_size = __ioc_inode_flush (ioc_inode);
+                __ioc_inode_flush (ioc_inode);
         }
         ioc_inode_unlock (ioc_inode);
 
-        if (destroy_size) {
-                ioc_table_lock (ioc_inode->table);
-                {
-                        ioc_inode->table->cache_used -= destroy_size;
-                }
-                ioc_table_unlock (ioc_inode->table);
-        }
-
         return;
 }
 
@@ -239,13 +229,6 @@ ioc_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 ioc_inode_flush (ioc_inode);
         }
 
-        ioc_table_lock (ioc_inode->table);
-        {
-                list_move_tail (&ioc_inode->inode_lru,
-                                &table->inode_lru[ioc_inode->weight]);
-        }
-        ioc_table_unlock (ioc_inode->table);
-
 out:
         if (frame->local != NULL) {
                 local = frame->local;
@@ -348,7 +331,6 @@ ioc_cache_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 {
         ioc_local_t *local        = NULL;
         ioc_inode_t *ioc_inode    = NULL;
-        size_t       destroy_size = 0;
         struct iatt *local_stbuf  = NULL;
 
         local = frame->local;
@@ -366,7 +348,7 @@ ioc_cache_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                  */
                 ioc_inode_lock (ioc_inode);
                 {
-                        destroy_size = __ioc_inode_flush (ioc_inode);
+                        __ioc_inode_flush (ioc_inode);
                         if (op_ret >= 0) {
                                 ioc_inode->cache.mtime = stbuf->ia_mtime;
                                 ioc_inode->cache.mtime_nsec
@@ -377,14 +359,6 @@ ioc_cache_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 local_stbuf = NULL;
         }
 
-        if (destroy_size) {
-                ioc_table_lock (ioc_inode->table);
-                {
-                        ioc_inode->table->cache_used -= destroy_size;
-                }
-                ioc_table_unlock (ioc_inode->table);
-        }
-
         if (op_ret < 0)
                 local_stbuf = NULL;
 
@@ -565,13 +539,6 @@ ioc_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
                         goto out;
                 }
 
-                ioc_table_lock (ioc_inode->table);
-                {
-                        list_move_tail (&ioc_inode->inode_lru,
-                                        &table->inode_lru[ioc_inode->weight]);
-                }
-                ioc_table_unlock (ioc_inode->table);
-
                 ioc_inode_lock (ioc_inode);
                 {
                         if ((table->min_file_size > ioc_inode->ia_size)
@@ -896,18 +863,16 @@ ioc_release (xlator_t *this, fd_t *fd)
 int32_t
 ioc_need_prune (ioc_table_t *table)
 {
-        int64_t cache_difference = 0;
+        struct ioc_shard *shard = NULL;
+        int32_t           i     = 0;
 
-        ioc_table_lock (table);
-        {
-                cache_difference = table->cache_used - table->cache_size;
+        for (i = 0; i < table->nshards; i++) {
+                shard = &table->shards[i];
+                if (GF_ATOMIC_GET (shard->used) > shard->size)
+                        return 1;
         }
-        ioc_table_unlock (table);
 
-        if (cache_difference > 0)
-                return 1;
-        else
-                return 0;
+        return 0;
 }
 
 /*
@@ -986,6 +951,8 @@ ioc_dispatch_requests (call_frame_t *frame, ioc_inode_t *ioc_inode, fd_t *fd,
                                 }
                         }
 
+                        __ioc_page_touch (trav, local_offset, trav_size);
+
                         __ioc_wait_on_page (trav, frame, local_offset,
                                             trav_size);
 
@@ -1093,7 +1060,6 @@ ioc_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
         uint64_t     tmp_ioc_inode = 0;
         ioc_inode_t *ioc_inode     = NULL;
         ioc_local_t *local         = NULL;
-        uint32_t     weight        = 0;
         ioc_table_t *table         = NULL;
         int32_t      op_errno      = -1;
 
@@ -1177,15 +1143,6 @@ ioc_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
                       "= %"PRId64" && size = %"GF_PRI_SIZET"",
                       frame, offset, size);
 
-        weight = ioc_inode->weight;
-
-        ioc_table_lock (ioc_inode->table);
-        {
-                list_move_tail (&ioc_inode->inode_lru,
-                                &ioc_inode->table->inode_lru[weight]);
-        }
-        ioc_table_unlock (ioc_inode->table);
-
         ioc_dispatch_requests (frame, ioc_inode, fd, offset, size);
         return 0;
 
@@ -1695,6 +1652,7 @@ reconfigure (xlator_t *this, dict_t *options)
                         goto unlock;
                 }
                 table->cache_size = cache_size_new;
+                ioc_shards_resize (table);
 
                 ret = 0;
         }
@@ -1715,7 +1673,6 @@ init (xlator_t *this)
 {
         ioc_table_t     *table             = NULL;
         dict_t          *xl_options        = NULL;
-        uint32_t         index             = 0;
         int32_t          ret               = -1;
         glusterfs_ctx_t *ctx               = NULL;
         data_t          *data              = 0;
@@ -1789,16 +1746,12 @@ init (xlator_t *this)
                 goto out;
         }
 
-        table->inode_lru = GF_CALLOC (table->max_pri,
-                                      sizeof (struct list_head),
-                                      gf_ioc_mt_list_head);
-        if (table->inode_lru == NULL) {
+        if (ioc_shards_init (table)) {
+                gf_msg (this->name, GF_LOG_ERROR, ENOMEM,
+                        IO_CACHE_MSG_NO_MEMORY, "out of memory");
                 goto out;
         }
 
-        for (index = 0; index < (table->max_pri); index++)
-                INIT_LIST_HEAD (&table->inode_lru[index]);
-
         this->local_pool = mem_pool_new (ioc_local_t, 64);
         if (!this->local_pool) {
                 ret = -1;
@@ -1830,7 +1783,7 @@ init (xlator_t *this)
 out:
         if (ret == -1) {
                 if (table != NULL) {
-                        GF_FREE (table->inode_lru);
+                        ioc_shards_destroy (table);
                         GF_FREE (table);
                 }
         }
@@ -2014,6 +1967,63 @@ out:
         return ret;
 }
 
+static void
+ioc_shards_dump (ioc_table_t *table)
+{
+        struct ioc_shard *shard                    = NULL;
+        uint64_t          used                     = 0;
+        uint64_t          hits                     = 0;
+        uint64_t          misses                   = 0;
+        uint64_t          ghost_recent_hits        = 0;
+        uint64_t          ghost_frequent_hits      = 0;
+        uint64_t          evictions                = 0;
+        int32_t           i                        = 0;
+        char              key[GF_DUMP_MAX_BUF_LEN] = {0, };
+
+        gf_proc_dump_write ("shards", "%d", table->nshards);
+
+        for (i = 0; i < table->nshards; i++) {
+                shard = &table->shards[i];
+
+                /* as with the table, do not block on a shard in statedump */
+                if (pthread_mutex_trylock (&shard->lock))
+                        continue;
+                {
+                        used += GF_ATOMIC_GET (shard->used);
+                        hits += shard->hits;
+                        misses += shard->misses;
+                        ghost_recent_hits += shard->ghost_recent_hits;
+                        ghost_frequent_hits += shard->ghost_frequent_hits;
+                        evictions += shard->evictions;
+
+                        sprintf (key, "shard[%d].recent", i);
+                        gf_proc_dump_write (key, "%"PRIu64,
+                                            shard->recent_size);
+                        sprintf (key, "shard[%d].frequent", i);
+                        gf_proc_dump_write (key, "%"PRIu64,
+                                            shard->frequent_size);
+                        sprintf (key, "shard[%d].ghost_recent", i);
+                        gf_proc_dump_write (key, "%"PRIu64,
+                                            shard->ghost_recent_size);
+                        sprintf (key, "shard[%d].ghost_frequent", i);
+                        gf_proc_dump_write (key, "%"PRIu64,
+                                            shard->ghost_frequent_size);
+                        sprintf (key, "shard[%d].recent_target", i);
+                        gf_proc_dump_write (key, "%"PRIu64, shard->target);
+                }
+                pthread_mutex_unlock (&shard->lock);
+        }
+
+        gf_proc_dump_write ("cache_used", "%"PRIu64, used);
+        gf_proc_dump_write ("hits", "%"PRIu64, hits);
+        gf_proc_dump_write ("misses", "%"PRIu64, misses);
+        gf_proc_dump_write ("ghost_recent_hits", "%"PRIu64,
+                            ghost_recent_hits);
+        gf_proc_dump_write ("ghost_frequent_hits", "%"PRIu64,
+                            ghost_frequent_hits);
+        gf_proc_dump_write ("evictions", "%"PRIu64, evictions);
+}
+
 int
 ioc_priv_dump (xlator_t *this)
 {
@@ -2037,13 +2047,14 @@ ioc_priv_dump (xlator_t *this)
         {
                 gf_proc_dump_write ("page_size", "%ld", priv->page_size);
                 gf_proc_dump_write ("cache_size", "%ld", priv->cache_size);
-                gf_proc_dump_write ("cache_used", "%ld", priv->cache_used);
                 gf_proc_dump_write ("inode_count", "%u", priv->inode_count);
                 gf_proc_dump_write ("cache_timeout", "%u", priv->cache_timeout);
                 gf_proc_dump_write ("min-file-size", "%u", priv->min_file_size);
                 gf_proc_dump_write ("max-file-size", "%u", priv->max_file_size);
         }
         pthread_mutex_unlock (&priv->table_lock);
+
+        ioc_shards_dump (priv);
 out:
         if (ret && priv) {
                 if (!add_section) {
@@ -2089,15 +2100,11 @@ fini (xlator_t *this)
                 GF_FREE (curr);
         }
 
-        /* inode_lru and inodes list can be empty in case fini() is
-         * called soon after init()? Hence commenting the below asserts.
+        /* inodes list can be empty in case fini() is called soon after
+         * init()? Hence commenting the below assert.
          */
-        /*for (i = 0; i < table->max_pri; i++) {
-                GF_ASSERT (list_empty (&table->inode_lru[i]));
-        }
-
-        GF_ASSERT (list_empty (&table->inodes));
-        */
+        /* GF_ASSERT (list_empty (&table->inodes)); */
+        ioc_shards_destroy (table);
         pthread_mutex_destroy (&table->table_lock);
         GF_FREE (table);
 
@@ -24,17 +24,29 @@
 #include "hashfn.h"
 #include <sys/time.h>
 #include <fnmatch.h>
+#include "atomic.h"
 #include "io-cache-messages.h"
 
 #define IOC_PAGE_SIZE    (1024 * 128)   /* 128KB */
 #define IOC_CACHE_SIZE   (32 * 1024 * 1024)
 #define IOC_PAGE_TABLE_BUCKET_COUNT 1
 
+#define IOC_MAX_SHARDS          8
+#define IOC_SHARD_MIN_PAGES     64      /* smallest shard, in pages */
+#define IOC_GHOST_BUCKETS       256
+#define IOC_PRUNE_MAX_SKIP      16      /* busy pages passed over */
+
 struct ioc_table;
 struct ioc_local;
 struct ioc_page;
 struct ioc_inode;
 
+typedef enum {
+        IOC_ARC_NONE = 0,       /* not filled yet */
+        IOC_ARC_RECENT,         /* read once since it was cached */
+        IOC_ARC_FREQUENT,       /* read again, or faulted in from a ghost */
+} ioc_arc_t;
+
 struct ioc_priority {
         struct list_head list;
         char             *pattern;
@@ -95,12 +107,62 @@ struct ioc_local {
         dict_t           *xattr_req;
 };
 
+/*
+ * ioc_ghost - identity of a page evicted not long ago. faulting in a page
+ *             which still has a ghost means it was evicted too early, and
+ *             moves the balance between the recent and frequent lists of
+ *             its shard towards the list it was evicted from.
+ */
+struct ioc_ghost {
+        struct list_head  list;       /* ghost lru of the shard */
+        struct list_head  hash;
+        uint64_t          key;
+        uint64_t          size;
+        char              frequent;   /* evicted from the frequent list */
+};
+
+/*
+ * ioc_shard - pages are spread over the shards by a hash of their gfid and
+ *             offset. each shard is an adaptive replacement cache (ARC) of
+ *             its share of cache-size, with its own lock: pages read once
+ *             sit on the recent list, pages read again move to the frequent
+ *             list, and a one-shot scan only ever cycles through the recent
+ *             one. each list keeps one lru per priority and lower
+ *             priorities are evicted first.
+ */
+struct ioc_shard {
+        pthread_mutex_t   lock;
+        uint64_t          size;            /* share of cache-size */
+        gf_atomic_t       used;            /* recent_size + frequent_size */
+        uint64_t          target;          /* what recent may use, in bytes */
+        struct list_head *recent;          /* [arc_levels] */
+        struct list_head *frequent;        /* [arc_levels] */
+        uint64_t          recent_size;
+        uint64_t          frequent_size;
+        struct list_head  ghost_recent;
+        struct list_head  ghost_frequent;
+        uint64_t          ghost_recent_size;
+        uint64_t          ghost_frequent_size;
+        struct list_head  ghosts[IOC_GHOST_BUCKETS];
+        uint64_t          hits;
+        uint64_t          misses;
+        uint64_t          ghost_recent_hits;
+        uint64_t          ghost_frequent_hits;
+        uint64_t          evictions;
+};
+
 /*
  * ioc_page - structure to store page of data from file
  *
  */
 struct ioc_page {
-        struct list_head    page_lru;
+        struct list_head    page_list;  /* pages of the inode */
+        struct list_head    arc_list;   /* lru of the shard, under its lock */
+        ioc_arc_t           arc;
+        uint32_t            shard;
+        uint64_t            key;
+        uint64_t            arc_size;   /* bytes accounted to the shard */
+        off_t               arc_seen;   /* end of the last read served */
         struct ioc_inode    *inode;   /* inode this page belongs to */
         struct ioc_priority *priority;
         char                dirty;
@@ -118,7 +180,7 @@ struct ioc_page {
 
 struct ioc_cache {
         rbthash_table_t  *page_table;
-        struct list_head  page_lru;
+        struct list_head  pages;
         time_t            mtime;       /*
                                         * seconds component of file mtime
                                         */
@@ -138,7 +200,6 @@ struct ioc_inode {
                                             * list of inodes, maintained by
                                             * io-cache translator
                                             */
-        struct list_head       inode_lru;
         struct ioc_waitq      *waitq;
         pthread_mutex_t        inode_lock;
         uint32_t               weight;      /*
@@ -151,12 +212,10 @@ struct ioc_inode {
 struct ioc_table {
         uint64_t         page_size;
         uint64_t         cache_size;
-        uint64_t         cache_used;
         uint64_t         min_file_size;
         uint64_t         max_file_size;
         struct list_head inodes; /* list of inodes cached */
         struct list_head active;
-        struct list_head *inode_lru;
         struct list_head priority_list;
         int32_t          readv_count;
         pthread_mutex_t  table_lock;
@@ -165,6 +224,9 @@ struct ioc_table {
         int32_t          cache_timeout;
         int32_t          max_pri;
         struct mem_pool  *mem_pool;
+        struct ioc_shard *shards;
+        int32_t          nshards;
+        int32_t          arc_levels;  /* priorities the shards were made for */
 };
 
 typedef struct ioc_table ioc_table_t;
@@ -205,6 +267,21 @@ __ioc_page_wakeup (ioc_page_t *page, int32_t op_errno);
 void
 ioc_page_flush (ioc_page_t *page);
 
+void
+__ioc_page_touch (ioc_page_t *page, off_t offset, size_t size);
+
+void
+__ioc_page_account (ioc_page_t *page);
+
+int
+ioc_shards_init (ioc_table_t *table);
+
+void
+ioc_shards_resize (ioc_table_t *table);
+
+void
+ioc_shards_destroy (ioc_table_t *table);
+
 ioc_waitq_t *
 __ioc_page_error (ioc_page_t *page, int32_t op_ret, int32_t op_errno);
 
@@ -186,7 +186,7 @@ ioc_inode_update (ioc_table_t *table, inode_t *inode, uint32_t weight)
 
         ioc_inode->inode = inode;
         ioc_inode->table = table;
-        INIT_LIST_HEAD (&ioc_inode->cache.page_lru);
+        INIT_LIST_HEAD (&ioc_inode->cache.pages);
         pthread_mutex_init (&ioc_inode->inode_lock, NULL);
         ioc_inode->weight = weight;
 
@@ -194,13 +194,11 @@ ioc_inode_update (ioc_table_t *table, inode_t *inode, uint32_t weight)
         {
                 table->inode_count++;
                 list_add (&ioc_inode->inode_list, &table->inodes);
-                list_add_tail (&ioc_inode->inode_lru,
-                               &table->inode_lru[weight]);
         }
         ioc_table_unlock (table);
 
         gf_msg_trace (table->xl->name, 0,
-                      "adding to inode_lru[%d]", weight);
+                      "adding inode(%p) with weight %d", ioc_inode, weight);
 
 out:
         return ioc_inode;
@@ -227,7 +225,6 @@ ioc_inode_destroy (ioc_inode_t *ioc_inode)
         {
                 table->inode_count--;
                 list_del (&ioc_inode->inode_list);
-                list_del (&ioc_inode->inode_lru);
         }
         ioc_table_unlock (table);
 
@@ -24,7 +24,7 @@ ioc_empty (struct ioc_cache *cache)
 
         GF_VALIDATE_OR_GOTO ("io-cache", cache, out);
 
-        is_empty = list_empty (&cache->page_lru);
+        is_empty = list_empty (&cache->pages);
 
 out:
         return is_empty;
@@ -48,11 +48,6 @@ __ioc_page_get (ioc_inode_t *ioc_inode, off_t offset)
         page = rbthash_get (ioc_inode->cache.page_table, &rounded_offset,
                             sizeof (rounded_offset));
 
-        if (page != NULL) {
-                /* push the page to the end of the lru list */
-                list_move_tail (&page->page_lru, &ioc_inode->cache.page_lru);
-        }
-
 out:
         return page;
 }
@@ -78,6 +73,348 @@ out:
 }
 
 
+/*
+ * ioc_page_key - identity of a page, which outlives the page itself in the
+ *                ghost lists of its shard
+ *
+ * @ioc_inode:
+ * @offset: rounded offset of the page
+ *
+ */
+static uint64_t
+ioc_page_key (ioc_inode_t *ioc_inode, off_t offset)
+{
+        uint64_t  hi  = 0;
+        uint64_t  lo  = 0;
+        uint64_t  key = 0;
+
+        memcpy (&hi, &ioc_inode->inode->gfid[0], sizeof (hi));
+        memcpy (&lo, &ioc_inode->inode->gfid[8], sizeof (lo));
+
+        key = (hi ^ lo ^ (uint64_t) offset) * 0x9e3779b97f4a7c15ULL;
+
+        return key ^ (key >> 29);
+}
+
+
+static struct list_head *
+ioc_shard_list (ioc_table_t *table, struct ioc_shard *shard, ioc_page_t *page,
+                ioc_arc_t arc)
+{
+        uint32_t level = 0;
+
+        level = min (page->inode->weight, (uint32_t)(table->arc_levels - 1));
+
+        if (arc == IOC_ARC_RECENT)
+                return &shard->recent[level];
+
+        return &shard->frequent[level];
+}
+
+
+static void
+__ioc_shard_link (ioc_table_t *table, struct ioc_shard *shard,
+                  ioc_page_t *page, ioc_arc_t arc)
+{
+        list_add_tail (&page->arc_list,
+                       ioc_shard_list (table, shard, page, arc));
+        page->arc = arc;
+
+        if (arc == IOC_ARC_RECENT)
+                shard->recent_size += page->arc_size;
+        else
+                shard->frequent_size += page->arc_size;
+
+        GF_ATOMIC_ADD (shard->used, page->arc_size);
+}
+
+
+static void
+__ioc_shard_unlink (struct ioc_shard *shard, ioc_page_t *page)
+{
+        list_del_init (&page->arc_list);
+
+        if (page->arc == IOC_ARC_RECENT)
+                shard->recent_size -= page->arc_size;
+        else
+                shard->frequent_size -= page->arc_size;
+
+        GF_ATOMIC_SUB (shard->used, page->arc_size);
+        page->arc = IOC_ARC_NONE;
+}
+
+
+static struct ioc_ghost *
+__ioc_shard_ghost_get (struct ioc_shard *shard, uint64_t key)
+{
+        struct ioc_ghost *ghost = NULL;
+
+        list_for_each_entry (ghost, &shard->ghosts[key % IOC_GHOST_BUCKETS],
+                             hash) {
+                if (ghost->key == key)
+                        return ghost;
+        }
+
+        return NULL;
+}
+
+
+static void
+__ioc_shard_ghost_del (struct ioc_shard *shard, struct ioc_ghost *ghost)
+{
+        list_del (&ghost->list);
+        list_del (&ghost->hash);
+
+        if (ghost->frequent)
+                shard->ghost_frequent_size -= ghost->size;
+        else
+                shard->ghost_recent_size -= ghost->size;
+
+        GF_FREE (ghost);
+}
+
+
+/* remember @page, which is being evicted, on the ghost list of the list it
+ * was evicted from. failing to is harmless, the page is just forgotten. */
+static void
+__ioc_shard_ghost_add (struct ioc_shard *shard, ioc_page_t *page)
+{
+        struct ioc_ghost *ghost = NULL;
+
+        ghost = GF_CALLOC (1, sizeof (*ghost), gf_ioc_mt_ioc_ghost_t);
+        if (ghost == NULL)
+                return;
+
+        ghost->key = page->key;
+        ghost->size = page->arc_size;
+        ghost->frequent = (page->arc == IOC_ARC_FREQUENT);
+
+        list_add (&ghost->hash, &shard->ghosts[ghost->key % IOC_GHOST_BUCKETS]);
+
+        if (ghost->frequent) {
+                list_add_tail (&ghost->list, &shard->ghost_frequent);
+                shard->ghost_frequent_size += ghost->size;
+        } else {
+                list_add_tail (&ghost->list, &shard->ghost_recent);
+                shard->ghost_recent_size += ghost->size;
+        }
+}
+
+
+/* recent pages and their ghosts fit in the shard, and all pages and all
+ * ghosts fit in twice the shard */
+static void
+__ioc_shard_ghost_trim (struct ioc_shard *shard)
+{
+        struct ioc_ghost *ghost = NULL;
+
+        while (!list_empty (&shard->ghost_recent) &&
+               (shard->recent_size + shard->ghost_recent_size > shard->size)) {
+                ghost = list_first_entry (&shard->ghost_recent,
+                                          struct ioc_ghost, list);
+                __ioc_shard_ghost_del (shard, ghost);
+        }
+
+        while (!list_empty (&shard->ghost_frequent) &&
+               (shard->recent_size + shard->frequent_size +
+                shard->ghost_recent_size + shard->ghost_frequent_size >
+                2 * shard->size)) {
+                ghost = list_first_entry (&shard->ghost_frequent,
+                                          struct ioc_ghost, list);
+                __ioc_shard_ghost_del (shard, ghost);
+        }
+}
+
+
+/*
+ * __ioc_page_touch - a read of @size bytes at @offset is being served from
+ *                    @page. reading on past what was read from the page
+ *                    before is still the same pass over it, only going back
+ *                    to data already read makes the page frequently used.
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_page_touch (ioc_page_t *page, off_t offset, size_t size)
+{
+        ioc_table_t      *table = NULL;
+        struct ioc_shard *shard = NULL;
+
+        table = page->inode->table;
+        shard = &table->shards[page->shard];
+
+        pthread_mutex_lock (&shard->lock);
+        {
+                if (page->ready)
+                        shard->hits++;
+
+                if ((page->arc != IOC_ARC_NONE) && (offset < page->arc_seen)) {
+                        __ioc_shard_unlink (shard, page);
+                        __ioc_shard_link (table, shard, page,
+                                          IOC_ARC_FREQUENT);
+                }
+
+                page->arc_seen = max (page->arc_seen, (off_t)(offset + size));
+        }
+        pthread_mutex_unlock (&shard->lock);
+}
+
+
+/*
+ * __ioc_page_account - charge a page which was just filled to its shard. a
+ *                      page that still has a ghost was evicted before its
+ *                      time: it goes straight to the frequent list, and the
+ *                      shard moves room towards the list the ghost came
+ *                      from.
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_page_account (ioc_page_t *page)
+{
+        ioc_table_t      *table = NULL;
+        struct ioc_shard *shard = NULL;
+        struct ioc_ghost *ghost = NULL;
+        uint64_t          delta = 0;
+        ioc_arc_t         arc   = IOC_ARC_RECENT;
+
+        table = page->inode->table;
+        shard = &table->shards[page->shard];
+
+        pthread_mutex_lock (&shard->lock);
+        {
+                if (page->arc != IOC_ARC_NONE)
+                        __ioc_shard_unlink (shard, page);
+
+                page->arc_size = page->iobref ? iobref_size (page->iobref) : 0;
+                shard->misses++;
+
+                ghost = __ioc_shard_ghost_get (shard, page->key);
+                if (ghost) {
+                        delta = max (ghost->size, 1);
+                        /* by the ratio of the other ghost list to this
+                         * one, and at least by the page */
+                        if (ghost->frequent) {
+                                shard->ghost_frequent_hits++;
+                                if (shard->ghost_frequent_size &&
+                                    (shard->ghost_recent_size >
+                                     shard->ghost_frequent_size))
+                                        delta *= shard->ghost_recent_size /
+                                                 shard->ghost_frequent_size;
+                                shard->target -= min (delta, shard->target);
+                        } else {
+                                shard->ghost_recent_hits++;
+                                if (shard->ghost_recent_size &&
+                                    (shard->ghost_frequent_size >
+                                     shard->ghost_recent_size))
+                                        delta *= shard->ghost_frequent_size /
+                                                 shard->ghost_recent_size;
+                                shard->target = min (shard->target + delta,
+                                                     shard->size);
+                        }
+
+                        __ioc_shard_ghost_del (shard, ghost);
+                        arc = IOC_ARC_FREQUENT;
+                }
+
+                __ioc_shard_link (table, shard, page, arc);
+                __ioc_shard_ghost_trim (shard);
+        }
+        pthread_mutex_unlock (&shard->lock);
+}
+
+
+/*
+ * __ioc_page_unaccount - take a page which is going away off its shard
+ *
+ * assumes ioc_inode is locked
+ */
+static void
+__ioc_page_unaccount (ioc_page_t *page)
+{
+        struct ioc_shard *shard = NULL;
+
+        if (page->arc == IOC_ARC_NONE)
+                return;
+
+        shard = &page->inode->table->shards[page->shard];
+
+        pthread_mutex_lock (&shard->lock);
+        {
+                __ioc_shard_unlink (shard, page);
+        }
+        pthread_mutex_unlock (&shard->lock);
+}
+
+
+/*
+ * __ioc_shard_victim - the page to evict next: the least recently used one
+ *                      of the lowest priority which has pages, from the
+ *                      recent list as long as that is over its target.
+ */
+static ioc_page_t *
+__ioc_shard_victim (ioc_table_t *table, struct ioc_shard *shard)
+{
+        struct list_head *list = NULL;
+        int32_t           i    = 0;
+
+        for (i = 0; i < table->arc_levels; i++) {
+                if (list_empty (&shard->recent[i]) &&
+                    list_empty (&shard->frequent[i]))
+                        continue;
+
+                if (!list_empty (&shard->recent[i]) &&
+                    (list_empty (&shard->frequent[i]) ||
+                     (shard->recent_size > shard->target)))
+                        list = &shard->recent[i];
+                else
+                        list = &shard->frequent[i];
+
+                return list_first_entry (list, ioc_page_t, arc_list);
+        }
+
+        return NULL;
+}
+
+
+/*
+ * __ioc_page_free - unhook a page nobody waits on from its inode and free it
+ *
+ * @page:
+ *
+ */
+static int64_t
+__ioc_page_free (ioc_page_t *page)
+{
+        int64_t  page_size = 0;
+
+        if (page->iobref)
+                page_size = iobref_size (page->iobref);
+
+        rbthash_remove (page->inode->cache.page_table, &page->offset,
+                        sizeof (page->offset));
+        list_del (&page->page_list);
+
+        gf_msg_trace (page->inode->table->xl->name, 0,
+                      "destroying page = %p, offset = %"PRId64" "
+                      "&& inode = %p",
+                      page, page->offset, page->inode);
+
+        if (page->vector){
+                iobref_unref (page->iobref);
+                GF_FREE (page->vector);
+                page->vector = NULL;
+        }
+
+        page->inode = NULL;
+
+        pthread_mutex_destroy (&page->page_lock);
+        GF_FREE (page);
+
+        return page_size;
+}
+
+
 /*
  * __ioc_page_destroy -
  *
@@ -91,35 +428,13 @@ __ioc_page_destroy (ioc_page_t *page)
 
         GF_VALIDATE_OR_GOTO ("io-cache", page, out);
 
-        if (page->iobref)
-                page_size = iobref_size (page->iobref);
-
         if (page->waitq) {
                 /* frames waiting on this page, do not destroy this page */
                 page_size = -1;
                 page->stale = 1;
         } else {
-                rbthash_remove (page->inode->cache.page_table, &page->offset,
-                                sizeof (page->offset));
-                list_del (&page->page_lru);
-
-                gf_msg_trace (page->inode->table->xl->name, 0,
-                              "destroying page = %p, offset = %"PRId64" "
-                              "&& inode = %p",
-                              page, page->offset, page->inode);
-
-                if (page->vector){
-                        iobref_unref (page->iobref);
-                        GF_FREE (page->vector);
-                        page->vector = NULL;
-                }
-
-                page->inode = NULL;
-        }
-
-        if (page_size != -1) {
-                pthread_mutex_destroy (&page->page_lock);
-                GF_FREE (page);
+                __ioc_page_unaccount (page);
+                page_size = __ioc_page_free (page);
         }
 
 out:
@@ -148,44 +463,61 @@ out:
         return ret;
 }
 
-int32_t
-__ioc_inode_prune (ioc_inode_t *curr, uint64_t *size_pruned,
-                   uint64_t size_to_prune, uint32_t index)
+/*
+ * ioc_shard_prune - evict pages from @shard until it is back within its
+ *                   share of cache-size. the inode lock nests outside the
+ *                   shard lock, so pages whose inode is busy, and pages
+ *                   frames are waiting on, are passed over.
+ */
+static void
+ioc_shard_prune (ioc_table_t *table, struct ioc_shard *shard)
 {
-        ioc_page_t  *page  = NULL, *next = NULL;
-        int32_t      ret   = 0;
-        ioc_table_t *table = NULL;
+        ioc_page_t  *page    = NULL;
+        ioc_inode_t *inode   = NULL;
+        int32_t      skipped = 0;
 
-        if (curr == NULL) {
-                goto out;
-        }
+        pthread_mutex_lock (&shard->lock);
+        {
+                while ((GF_ATOMIC_GET (shard->used) > shard->size) &&
+                       (skipped < IOC_PRUNE_MAX_SKIP)) {
+                        page = __ioc_shard_victim (table, shard);
+                        if (page == NULL)
+                                break;
 
-        table = curr->table;
+                        inode = page->inode;
+                        if (pthread_mutex_trylock (&inode->inode_lock)) {
+                                list_move_tail (&page->arc_list,
+                                                ioc_shard_list (table, shard,
+                                                                page,
+                                                                page->arc));
+                                skipped++;
+                                continue;
+                        }
 
-        list_for_each_entry_safe (page, next, &curr->cache.page_lru, page_lru) {
-                *size_pruned += page->size;
-                ret = __ioc_page_destroy (page);
+                        if (page->waitq) {
+                                pthread_mutex_unlock (&inode->inode_lock);
+                                list_move_tail (&page->arc_list,
+                                                ioc_shard_list (table, shard,
+                                                                page,
+                                                                page->arc));
+                                skipped++;
+                                continue;
+                        }
 
-                if (ret != -1)
-                        table->cache_used -= ret;
+                        __ioc_shard_ghost_add (shard, page);
+                        __ioc_shard_unlink (shard, page);
+                        shard->evictions++;
+                        __ioc_page_free (page);
 
-                gf_msg_trace (table->xl->name, 0,
-                              "index = %d && "
-                              "table->cache_used = %"PRIu64" && table->"
-                              "cache_size = %"PRIu64, index, table->cache_used,
-                              table->cache_size);
+                        pthread_mutex_unlock (&inode->inode_lock);
 
-                if ((*size_pruned) >= size_to_prune)
-                        break;
+                        __ioc_shard_ghost_trim (shard);
+                }
         }
+        pthread_mutex_unlock (&shard->lock);
+}
 
-        if (ioc_empty (&curr->cache)) {
-                list_del_init (&curr->inode_lru);
-        }
 
-out:
-        return 0;
-}
 /*
  * ioc_prune - prune the cache. we have a limit to the number of pages we
  *             can have in-memory.
@@ -196,44 +528,141 @@ out:
 int32_t
 ioc_prune (ioc_table_t *table)
 {
-        ioc_inode_t *curr          = NULL, *next_ioc_inode = NULL;
-        int32_t      index         = 0;
-        uint64_t     size_to_prune = 0;
-        uint64_t     size_pruned   = 0;
+        struct ioc_shard *shard = NULL;
+        int32_t           i     = 0;
 
         GF_VALIDATE_OR_GOTO ("io-cache", table, out);
 
-        ioc_table_lock (table);
-        {
-                size_to_prune = table->cache_used - table->cache_size;
-                /* take out the least recently used inode */
-                for (index=0; index < table->max_pri; index++) {
-                        list_for_each_entry_safe (curr, next_ioc_inode,
-                                                  &table->inode_lru[index],
-                                                  inode_lru) {
-                                /* prune page-by-page for this inode, till
-                                 * we reach the equilibrium */
-                                ioc_inode_lock (curr);
-                                {
-                                        __ioc_inode_prune (curr, &size_pruned,
-                                                           size_to_prune,
-                                                           index);
-                                }
-                                ioc_inode_unlock (curr);
+        for (i = 0; i < table->nshards; i++) {
+                shard = &table->shards[i];
+                if (GF_ATOMIC_GET (shard->used) > shard->size)
+                        ioc_shard_prune (table, shard);
+        }
 
-                                if (size_pruned >= size_to_prune)
-                                        break;
-                        } /* list_for_each_entry_safe (curr...) */
+out:
+        return 0;
+}
 
-                        if (size_pruned >= size_to_prune)
-                                break;
-                } /* for(index=0;...) */
+/*
+ * ioc_shards_init - split cache-size into shards of at least
+ *                   IOC_SHARD_MIN_PAGES pages each
+ *
+ * @table:
+ *
+ */
+int
+ioc_shards_init (ioc_table_t *table)
+{
+        struct ioc_shard *shard = NULL;
+        uint64_t          pages = 0;
+        int32_t           i     = 0;
+        int32_t           j     = 0;
+
+        pages = table->cache_size / table->page_size;
+        table->nshards = min (max (pages / IOC_SHARD_MIN_PAGES, 1),
+                              IOC_MAX_SHARDS);
+        table->arc_levels = table->max_pri;
+
+        table->shards = GF_CALLOC (table->nshards, sizeof (*shard),
+                                   gf_ioc_mt_ioc_shard_t);
+        if (table->shards == NULL)
+                goto err;
 
-        } /* ioc_inode_table locked region end */
-        ioc_table_unlock (table);
+        for (i = 0; i < table->nshards; i++) {
+                shard = &table->shards[i];
+
+                shard->recent = GF_CALLOC (table->arc_levels,
+                                           sizeof (struct list_head),
+                                           gf_ioc_mt_list_head);
+                shard->frequent = GF_CALLOC (table->arc_levels,
+                                             sizeof (struct list_head),
+                                             gf_ioc_mt_list_head);
+                if (!shard->recent || !shard->frequent) {
+                        GF_FREE (shard->recent);
+                        GF_FREE (shard->frequent);
+                        shard->recent = NULL;
+                        goto err;
+                }
+
+                for (j = 0; j < table->arc_levels; j++) {
+                        INIT_LIST_HEAD (&shard->recent[j]);
+                        INIT_LIST_HEAD (&shard->frequent[j]);
+                }
+
+                INIT_LIST_HEAD (&shard->ghost_recent);
+                INIT_LIST_HEAD (&shard->ghost_frequent);
+                for (j = 0; j < IOC_GHOST_BUCKETS; j++)
+                        INIT_LIST_HEAD (&shard->ghosts[j]);
+
+                pthread_mutex_init (&shard->lock, NULL);
+                shard->size = table->cache_size / table->nshards;
+                GF_ATOMIC_INIT (shard->used, 0);
+        }
 
-out:
         return 0;
+
+err:
+        ioc_shards_destroy (table);
+        return -1;
+}
+
+
+/*
+ * ioc_shards_resize - cache-size was reconfigured
+ *
+ * @table:
+ *
+ */
+void
+ioc_shards_resize (ioc_table_t *table)
+{
+        struct ioc_shard *shard = NULL;
+        int32_t           i     = 0;
+
+        for (i = 0; i < table->nshards; i++) {
+                shard = &table->shards[i];
+
+                pthread_mutex_lock (&shard->lock);
+                {
+                        shard->size = table->cache_size / table->nshards;
+                        shard->target = min (shard->target, shard->size);
+                        __ioc_shard_ghost_trim (shard);
+                }
+                pthread_mutex_unlock (&shard->lock);
+        }
+}
+
+
+void
+ioc_shards_destroy (ioc_table_t *table)
+{
+        struct ioc_shard *shard = NULL;
+        struct ioc_ghost *ghost = NULL;
+        struct ioc_ghost *tmp   = NULL;
+        int32_t           i     = 0;
+
+        if (table->shards == NULL)
+                return;
+
+        for (i = 0; i < table->nshards; i++) {
+                shard = &table->shards[i];
+                if (shard->recent == NULL)
+                        continue;
+
+                list_for_each_entry_safe (ghost, tmp, &shard->ghost_recent,
+                                          list)
+                        GF_FREE (ghost);
+                list_for_each_entry_safe (ghost, tmp, &shard->ghost_frequent,
+                                          list)
+                        GF_FREE (ghost);
+
+                GF_FREE (shard->recent);
+                GF_FREE (shard->frequent);
+                pthread_mutex_destroy (&shard->lock);
+        }
+
+        GF_FREE (table->shards);
+        table->shards = NULL;
 }
 
 /*
@@ -271,12 +700,15 @@ __ioc_page_create (ioc_inode_t *ioc_inode, off_t offset)
 
         newpage->offset = rounded_offset;
         newpage->inode = ioc_inode;
+        newpage->key = ioc_page_key (ioc_inode, rounded_offset);
+        newpage->shard = (newpage->key >> 32) % table->nshards;
+        INIT_LIST_HEAD (&newpage->arc_list);
         pthread_mutex_init (&newpage->page_lock, NULL);
 
         rbthash_insert (ioc_inode->cache.page_table, newpage, &rounded_offset,
                         sizeof (rounded_offset));
 
-        list_add_tail (&newpage->page_lru, &ioc_inode->cache.page_lru);
+        list_add_tail (&newpage->page_list, &ioc_inode->cache.pages);
 
         page = newpage;
 
@@ -416,10 +848,8 @@ ioc_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         ioc_inode_t *ioc_inode        = NULL;
         ioc_table_t *table            = NULL;
         ioc_page_t  *page             = NULL;
-        int32_t      destroy_size     = 0;
         size_t       page_size        = 0;
         ioc_waitq_t *waitq            = NULL;
-        size_t       iobref_page_size = 0;
         char         zero_filled      = 0;
 
         GF_ASSERT (frame);
@@ -444,7 +874,7 @@ ioc_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         gf_msg_trace (ioc_inode->table->xl->name, 0,
                                       "cache for inode(%p) is invalid. flushing "
                                       "all pages", ioc_inode);
-                        destroy_size = __ioc_inode_flush (ioc_inode);
+                        __ioc_inode_flush (ioc_inode);
                 }
 
                 if ((op_ret >= 0) && !zero_filled) {
@@ -515,7 +945,7 @@ ioc_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                                 page->size = page_size;
                                 page->op_errno = op_errno;
 
-                                iobref_page_size = iobref_size (page->iobref);
+                                __ioc_page_account (page);
 
                                 if (page->waitq) {
                                         /* wake up all the frames waiting on
@@ -532,22 +962,6 @@ unlock:
 
         ioc_waitq_return (waitq);
 
-        if (iobref_page_size) {
-                ioc_table_lock (table);
-                {
-                        table->cache_used += iobref_page_size;
-                }
-                ioc_table_unlock (table);
-        }
-
-        if (destroy_size) {
-                ioc_table_lock (table);
-                {
-                        table->cache_used -= destroy_size;
-                }
-                ioc_table_unlock (table);
-        }
-
         if (ioc_need_prune (ioc_inode->table)) {
                 ioc_prune (ioc_inode->table);
         }
@@ -656,7 +1070,6 @@ __ioc_frame_fill (ioc_page_t *page, call_frame_t *frame, off_t offset,
         off_t        src_offset = 0;
         off_t        dst_offset = 0;
         ssize_t      copy_size  = 0;
-        ioc_inode_t *ioc_inode  = NULL;
         ioc_fill_t  *new        = NULL;
         int8_t       found      = 0;
         int32_t      ret        = -1;
@@ -675,15 +1088,11 @@ __ioc_frame_fill (ioc_page_t *page, call_frame_t *frame, off_t offset,
                 goto out;
         }
 
-        ioc_inode = page->inode;
-
         gf_msg_trace (frame->this->name, 0,
                       "frame (%p) offset = %"PRId64" && size = %"GF_PRI_SIZET" "
                       "&& page->size = %"GF_PRI_SIZET" && wait_count = %d",
                       frame, offset, size, page->size, local->wait_count);
 
-        /* immediately move this page to the end of the page_lru list */
-        list_move_tail (&page->page_lru, &ioc_inode->cache.page_lru);
         /* fill local->pending_size bytes from local->pending_offset */
         if (local->op_ret != -1) {
                 local->op_errno = op_errno;
@@ -986,8 +1395,6 @@ __ioc_page_error (ioc_page_t *page, int32_t op_ret, int32_t op_errno)
 {
         ioc_waitq_t  *waitq = NULL, *trav = NULL;
         call_frame_t *frame = NULL;
-        int64_t       ret   = 0;
-        ioc_table_t  *table = NULL;
         ioc_local_t  *local = NULL;
 
         GF_VALIDATE_OR_GOTO ("io-cache", page, out);
@@ -1013,12 +1420,7 @@ __ioc_page_error (ioc_page_t *page, int32_t op_ret, int32_t op_errno)
                 ioc_local_unlock (local);
         }
 
-        table = page->inode->table;
-        ret = __ioc_page_destroy (page);
-
-        if (ret != -1) {
-                table->cache_used -= ret;
-        }
+        __ioc_page_destroy (page);
 
 out:
         return waitq;
@@ -19,11 +19,13 @@
 #include <sys/time.h>
 #include <time.h>
 #include "locking.h"
+#include "timespec.h"
 #include "io-threads-messages.h"
 
 void *iot_worker (void *arg);
 int iot_workers_scale (iot_conf_t *conf);
 int __iot_workers_scale (iot_conf_t *conf);
+static int iot_stub_pri (iot_conf_t *conf, call_stub_t *stub);
 struct volume_options options[];
 
 #define IOT_FOP(name, frame, this, args ...)                                   \
@@ -48,32 +50,85 @@ struct volume_options options[];
                 }                                                              \
         } while (0)
 
+/* one ctx per shard and priority, created under conf->mutex so that two
+ * shards cannot race to attach one to the same client */
 iot_client_ctx_t *
 iot_get_ctx (xlator_t *this, client_t *client)
 {
+        iot_conf_t              *conf   = this->private;
         iot_client_ctx_t        *ctx    = NULL;
         int                      i;
 
-        if (client_ctx_get (client, this, (void **)&ctx) != 0) {
-                ctx = GF_CALLOC (IOT_PRI_MAX, sizeof(*ctx),
+        if (client_ctx_get (client, this, (void **)&ctx) == 0)
+                return ctx;
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                if (client_ctx_get (client, this, (void **)&ctx) == 0)
+                        goto unlock;
+
+                ctx = GF_CALLOC (conf->nshards * IOT_PRI_MAX, sizeof(*ctx),
                                  gf_iot_mt_client_ctx_t);
-                if (ctx) {
-                        for (i = 0; i < IOT_PRI_MAX; ++i) {
-                                INIT_LIST_HEAD (&ctx[i].clients);
-                                INIT_LIST_HEAD (&ctx[i].reqs);
-                        }
-                        if (client_ctx_set (client, this, ctx) != 0) {
-                                GF_FREE (ctx);
-                                ctx = NULL;
-                        }
+                if (!ctx)
+                        goto unlock;
+
+                for (i = 0; i < conf->nshards * IOT_PRI_MAX; ++i) {
+                        INIT_LIST_HEAD (&ctx[i].clients);
+                        INIT_LIST_HEAD (&ctx[i].reqs);
+                }
+                if (client_ctx_set (client, this, ctx) != 0) {
+                        GF_FREE (ctx);
+                        ctx = NULL;
                 }
         }
+unlock:
+        pthread_mutex_unlock (&conf->mutex);
 
         return ctx;
 }
 
+/* The shard a thread queues on, plus one: its own if it is one of our
+ * workers, otherwise one handed out round-robin the first time it shows
+ * up.  Shared by all io-threads instances in the process. */
+static pthread_key_t  iot_shard_key;
+static pthread_once_t iot_shard_once = PTHREAD_ONCE_INIT;
+
+static void
+iot_shard_key_init (void)
+{
+        (void) pthread_key_create (&iot_shard_key, NULL);
+}
+
+static iot_shard_t *
+iot_shard_of_thread (iot_conf_t *conf)
+{
+        static int  next_shard;
+        intptr_t    idx = 0;
+
+        idx = (intptr_t) pthread_getspecific (iot_shard_key);
+        if (!idx) {
+                idx = __sync_fetch_and_add (&next_shard, 1) % IOT_MAX_SHARDS
+                      + 1;
+                (void) pthread_setspecific (iot_shard_key, (void *) idx);
+        }
+
+        return &conf->shards[(idx - 1) % conf->nshards];
+}
+
+/* takes a priority slot if its ac_iot_limit allows */
+static gf_boolean_t
+iot_pri_get (iot_conf_t *conf, int pri)
+{
+        if (GF_ATOMIC_INC (conf->ac_iot_count[pri]) <=
+            conf->ac_iot_limit[pri])
+                return _gf_true;
+
+        GF_ATOMIC_DEC (conf->ac_iot_count[pri]);
+        return _gf_false;
+}
+
 call_stub_t *
-__iot_dequeue (iot_conf_t *conf, int *pri)
+__iot_dequeue (iot_conf_t *conf, iot_shard_t *shard, int *pri)
 {
         call_stub_t             *stub = NULL;
         int                     i = 0;
@@ -82,24 +137,17 @@ __iot_dequeue (iot_conf_t *conf, int *pri)
         *pri = -1;
         for (i = 0; i < IOT_PRI_MAX; i++) {
 
-                if (conf->ac_iot_count[i] >= conf->ac_iot_limit[i]) {
+                if (!shard->queue_sizes[i]) {
                         continue;
                 }
 
-                if (list_empty (&conf->clients[i])) {
+                if (!iot_pri_get (conf, i)) {
                         continue;
                 }
 
                 /* Get the first per-client queue for this priority. */
-                ctx = list_first_entry (&conf->clients[i],
+                ctx = list_first_entry (&shard->clients[i],
                                         iot_client_ctx_t, clients);
-                if (!ctx) {
-                        continue;
-                }
-
-                if (list_empty (&ctx->reqs)) {
-                        continue;
-                }
 
                 /* Get the first request on that queue. */
                 stub = list_first_entry (&ctx->reqs, call_stub_t, list);
@@ -107,10 +155,9 @@ __iot_dequeue (iot_conf_t *conf, int *pri)
                 if (list_empty (&ctx->reqs)) {
                         list_del_init (&ctx->clients);
                 } else {
-                        list_rotate_left (&conf->clients[i]);
+                        list_rotate_left (&shard->clients[i]);
                 }
 
-                conf->ac_iot_count[i]++;
                 *pri = i;
                 break;
         }
@@ -118,132 +165,624 @@ __iot_dequeue (iot_conf_t *conf, int *pri)
         if (!stub)
                 return NULL;
 
-        conf->queue_size--;
-        conf->queue_sizes[*pri]--;
+        shard->queue_size--;
+        shard->queue_sizes[*pri]--;
+        GF_ATOMIC_DEC (conf->queue_size);
+        GF_ATOMIC_DEC (conf->queue_sizes[*pri]);
 
         return stub;
 }
 
 
 void
-__iot_enqueue (iot_conf_t *conf, call_stub_t *stub, int pri)
+__iot_enqueue (iot_conf_t *conf, iot_shard_t *shard, call_stub_t *stub,
+               int pri, iot_client_ctx_t *ctx)
 {
-        client_t                *client = stub->frame->root->client;
-        iot_client_ctx_t        *ctx;
-
         if (pri < 0 || pri >= IOT_PRI_MAX)
                 pri = IOT_PRI_MAX-1;
 
-        if (client) {
-                ctx = iot_get_ctx (THIS, client);
-                if (ctx) {
-                        ctx = &ctx[pri];
-                }
+        if (ctx) {
+                ctx = &ctx[(shard - conf->shards) * IOT_PRI_MAX + pri];
         } else {
-                ctx = NULL;
-        }
-        if (!ctx) {
-                ctx = &conf->no_client[pri];
+                ctx = &shard->no_client[pri];
         }
 
         if (list_empty (&ctx->reqs)) {
-                list_add_tail (&ctx->clients, &conf->clients[pri]);
+                list_add_tail (&ctx->clients, &shard->clients[pri]);
         }
         list_add_tail (&stub->list, &ctx->reqs);
+        timespec_now (&stub->queued);
+
+        shard->queue_size++;
+        shard->queue_sizes[pri]++;
+        GF_ATOMIC_INC (conf->queue_size);
+        GF_ATOMIC_INC (conf->queue_sizes[pri]);
+
+        /* before any sleeper can be signalled, see iot_worker_sleep () */
+        GF_ATOMIC_INC (conf->queued_seq);
+}
+
+/* Own shard first, then the others in order.  Busy shards are skipped
+ * rather than waited for, and reported in @missed so the caller does not
+ * go to sleep on work it has not seen. */
+static call_stub_t *
+iot_dequeue (iot_conf_t *conf, iot_shard_t *home, int *pri,
+             gf_boolean_t *missed)
+{
+        iot_shard_t     *shard = NULL;
+        call_stub_t     *stub  = NULL;
+        int              i     = 0;
+
+        pthread_mutex_lock (&home->mutex);
+        {
+                stub = __iot_dequeue (conf, home, pri);
+                if (stub)
+                        home->dequeued++;
+        }
+        pthread_mutex_unlock (&home->mutex);
+
+        for (i = 1; !stub && i < conf->nshards; i++) {
+                shard = &conf->shards[(home - conf->shards + i) %
+                                      conf->nshards];
+                if (!shard->queue_size)
+                        continue;
+                if (pthread_mutex_trylock (&shard->mutex) != 0) {
+                        *missed = _gf_true;
+                        continue;
+                }
+                {
+                        stub = __iot_dequeue (conf, shard, pri);
+                        if (stub)
+                                shard->stolen++;
+                }
+                pthread_mutex_unlock (&shard->mutex);
+        }
+
+        return stub;
+}
+
+/* protocol/server hands this back to rpcsvc, which sizes the client's
+ * request window from it */
+static void
+iot_account_queue_delay (iot_conf_t *conf, call_stub_t *stub)
+{
+        struct timespec  now   = {0, };
+        uint64_t         wait  = 0;
+        uint64_t         delay = 0;
+
+        GF_ATOMIC_INC (conf->dequeued);
+
+        timespec_now (&now);
+        if (TS (now) <= TS (stub->queued))
+                return;
+
+        wait = (TS (now) - TS (stub->queued)) / 1000;
+        GF_ATOMIC_ADD (conf->queue_wait, wait);
+        /* unlocked, it is only for statedump */
+        if (wait > conf->queue_wait_max)
+                conf->queue_wait_max = wait;
+
+        delay = stub->frame->root->queue_delay + wait;
+        stub->frame->root->queue_delay = min (delay, UINT32_MAX);
+}
+
+/* Returns _gf_true if the worker should exit.  A worker only sleeps if
+ * nothing was queued anywhere since it started looking, which pairs with
+ * the sleepers check in iot_wake_one (). */
+static gf_boolean_t
+iot_worker_sleep (iot_conf_t *conf, iot_shard_t *home, int64_t seq)
+{
+        struct timespec   sleep_till = {0, };
+        gf_boolean_t      bye        = _gf_false;
+        int               ret        = 0;
+
+        sleep_till.tv_sec = time (NULL) + conf->idle_time;
+
+        pthread_mutex_lock (&home->mutex);
+        {
+                GF_ATOMIC_INC (home->sleepers);
+                GF_ATOMIC_INC (conf->sleep_count);
+                __sync_synchronize ();
+
+                while (GF_ATOMIC_GET (conf->queued_seq) == seq) {
+                        if (conf->down) {
+                                bye = (GF_ATOMIC_GET (conf->queue_size) == 0);
+                                break;
+                        }
+
+                        ret = pthread_cond_timedwait (&home->cond,
+                                                      &home->mutex,
+                                                      &sleep_till);
+                        if (conf->down || ret == ETIMEDOUT) {
+                                bye = (GF_ATOMIC_GET (conf->queue_size) == 0);
+                                break;
+                        }
+                }
+
+                GF_ATOMIC_DEC (conf->sleep_count);
+                GF_ATOMIC_DEC (home->sleepers);
+        }
+        pthread_mutex_unlock (&home->mutex);
+
+        if (!bye)
+                return _gf_false;
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                if (conf->down || conf->curr_count > IOT_MIN_THREADS) {
+                        conf->curr_count--;
+                        home->workers--;
+                        if (conf->curr_count == 0)
+                                pthread_cond_broadcast (&conf->cond);
+                        gf_msg_debug (conf->this->name, 0,
+                                      "terminated. "
+                                      "conf->curr_count=%d",
+                                      conf->curr_count);
+                } else {
+                        bye = _gf_false;
+                }
+        }
+        pthread_mutex_unlock (&conf->mutex);
+
+        return bye;
+}
+
+static iot_lane_t *
+iot_lane_of (iot_conf_t *conf, call_stub_t *stub)
+{
+        inode_t         *inode = NULL;
+        unsigned char   *gfid  = NULL;
+        uint32_t         hash  = 0;
+
+        switch (stub->fop) {
+        case GF_FOP_XATTROP:
+        case GF_FOP_INODELK:
+        case GF_FOP_ENTRYLK:
+        case GF_FOP_SETXATTR:
+        case GF_FOP_REMOVEXATTR:
+                inode = stub->args.loc.inode;
+                break;
+        case GF_FOP_FXATTROP:
+        case GF_FOP_FINODELK:
+        case GF_FOP_FENTRYLK:
+        case GF_FOP_FSETXATTR:
+        case GF_FOP_FREMOVEXATTR:
+                if (stub->args.fd)
+                        inode = stub->args.fd->inode;
+                break;
+        default:
+                return NULL;
+        }
+
+        if (!inode || gf_uuid_is_null (inode->gfid))
+                return NULL;
+
+        gfid = inode->gfid;
+        hash = ((uint32_t) gfid[12] << 24) | (gfid[13] << 16) |
+               (gfid[14] << 8) | gfid[15];
+
+        return &conf->lanes[hash % IOT_LANES];
+}
+
+/* Returns _gf_false if @stub has to wait for the lane to drain to it. */
+static gf_boolean_t
+iot_lane_enter (iot_conf_t *conf, iot_lane_t *lane, call_stub_t *stub)
+{
+        gf_boolean_t    go = _gf_true;
+
+        LOCK (&lane->lock);
+        {
+                if (lane->busy) {
+                        list_add_tail (&stub->list, &lane->waiting);
+                        GF_ATOMIC_INC (conf->lane_waits);
+                        go = _gf_false;
+                } else {
+                        lane->busy = _gf_true;
+                        lane->queued = stub;
+                }
+        }
+        UNLOCK (&lane->lock);
+
+        return go;
+}
 
-        conf->queue_size++;
-        conf->queue_sizes[pri]++;
+/* The lane @stub holds, if any.  Taken before the stub runs, as it is
+ * gone once call_resume () returns. */
+static iot_lane_t *
+iot_lane_claim (iot_conf_t *conf, call_stub_t *stub)
+{
+        iot_lane_t      *lane = NULL;
+        gf_boolean_t     mine = _gf_false;
+
+        lane = iot_lane_of (conf, stub);
+        if (!lane)
+                return NULL;
+
+        LOCK (&lane->lock);
+        {
+                if (lane->queued == stub) {
+                        lane->queued = NULL;
+                        mine = _gf_true;
+                }
+        }
+        UNLOCK (&lane->lock);
+
+        return mine ? lane : NULL;
 }
 
+/* Queues the next waiter of @lane on @home without waking anybody, the
+ * calling worker looks at its own shard next. */
+static void
+iot_lane_leave (iot_conf_t *conf, iot_shard_t *home, iot_lane_t *lane)
+{
+        call_stub_t      *next   = NULL;
+        iot_client_ctx_t *ctx    = NULL;
+        client_t         *client = NULL;
+
+        LOCK (&lane->lock);
+        {
+                if (list_empty (&lane->waiting)) {
+                        lane->busy = _gf_false;
+                } else {
+                        next = list_first_entry (&lane->waiting, call_stub_t,
+                                                 list);
+                        list_del_init (&next->list);
+                        lane->queued = next;
+                }
+        }
+        UNLOCK (&lane->lock);
+
+        if (!next)
+                return;
+
+        client = next->frame->root->client;
+        if (client)
+                ctx = iot_get_ctx (conf->this, client);
+
+        pthread_mutex_lock (&home->mutex);
+        {
+                __iot_enqueue (conf, home, next, iot_stub_pri (conf, next),
+                               ctx);
+        }
+        pthread_mutex_unlock (&home->mutex);
+}
 
 void *
 iot_worker (void *data)
 {
+        iot_shard_t      *home = NULL;
         iot_conf_t       *conf = NULL;
         xlator_t         *this = NULL;
         call_stub_t      *stub = NULL;
-        struct timespec   sleep_till = {0, };
-        int               ret = 0;
-        int               pri = -1;
-        gf_boolean_t      bye = _gf_false;
+        iot_lane_t       *lane = NULL;
+        int64_t           seq  = 0;
+        int               pri  = -1;
+        gf_boolean_t      missed = _gf_false;
 
-        conf = data;
+        home = data;
+        conf = home->conf;
         this = conf->this;
         THIS = this;
+        (void) pthread_setspecific (iot_shard_key,
+                                    (void *) (intptr_t) (home - conf->shards
+                                                         + 1));
 
         for (;;) {
-                sleep_till.tv_sec = time (NULL) + conf->idle_time;
+                if (pri != -1) {
+                        GF_ATOMIC_DEC (conf->ac_iot_count[pri]);
+                        pri = -1;
+                }
+
+                seq = GF_ATOMIC_GET (conf->queued_seq);
 
-                pthread_mutex_lock (&conf->mutex);
+                missed = _gf_false;
+                stub = iot_dequeue (conf, home, &pri, &missed);
+                if (stub) {
+                        lane = iot_lane_claim (conf, stub);
+                        iot_account_queue_delay (conf, stub);
+                        call_resume (stub);
+                        if (lane)
+                                iot_lane_leave (conf, home, lane);
+                        continue;
+                }
+
+                if (missed)
+                        continue;
+
+                if (iot_worker_sleep (conf, home, seq))
+                        break;
+        }
+
+        return NULL;
+}
+
+/* rouses a sleeping worker, preferably on @shard */
+static void
+iot_wake_one (iot_conf_t *conf, iot_shard_t *shard)
+{
+        iot_shard_t     *victim = NULL;
+        int              i      = 0;
+
+        __sync_synchronize ();
+        if (!GF_ATOMIC_GET (conf->sleep_count))
+                return;
+
+        for (i = 0; i < conf->nshards; i++) {
+                victim = &conf->shards[(shard - conf->shards + i) %
+                                       conf->nshards];
+                if (!GF_ATOMIC_GET (victim->sleepers))
+                        continue;
+
+                pthread_mutex_lock (&victim->mutex);
                 {
-                        if (pri != -1) {
-                                conf->ac_iot_count[pri]--;
-                                pri = -1;
-                        }
-                        while (conf->queue_size == 0) {
-                                if (conf->down) {
-                                        bye = _gf_true;/*Avoid sleep*/
-                                        break;
-                                }
-
-                                conf->sleep_count++;
-
-                                ret = pthread_cond_timedwait (&conf->cond,
-                                                              &conf->mutex,
-                                                              &sleep_till);
-                                conf->sleep_count--;
-
-                                if (conf->down || ret == ETIMEDOUT) {
-                                        bye = _gf_true;
-                                        break;
-                                }
-                        }
+                        pthread_cond_signal (&victim->cond);
+                }
+                pthread_mutex_unlock (&victim->mutex);
+                break;
+        }
+}
 
-                        if (bye) {
-                                if (conf->down || conf->curr_count > IOT_MIN_THREADS) {
-                                        conf->curr_count--;
-                                        if (conf->curr_count == 0)
-                                           pthread_cond_broadcast (&conf->cond);
-                                        gf_msg_debug (conf->this->name, 0,
-                                                      "terminated. "
-                                                      "conf->curr_count=%d",
-                                                      conf->curr_count);
-                                } else {
-                                        bye = _gf_false;
-                                }
-                        }
+static iot_pool_t     iot_pool;
+static pthread_once_t iot_pool_once = PTHREAD_ONCE_INIT;
+
+static void
+iot_pool_init (void)
+{
+        iot_pool_t      *pool = &iot_pool;
+
+        pthread_mutex_init (&pool->mutex, NULL);
+        pthread_cond_init (&pool->cond, NULL);
+        pthread_cond_init (&pool->drained, NULL);
+        INIT_LIST_HEAD (&pool->active);
+
+        pthread_attr_init (&pool->w_attr);
+        (void) pthread_attr_setstacksize (&pool->w_attr,
+                                          IOT_THREAD_STACK_SIZE);
+}
+
+/* Called with the pool mutex held, once a worker is done with @conf. */
+static void
+__iot_pool_requeue (iot_pool_t *pool, iot_conf_t *conf,
+                    gf_boolean_t idle)
+{
+        /* If the stubs left could not be had (priority limits), one of the
+         * workers still at it puts it back when done. */
+        if (!GF_ATOMIC_GET (conf->queue_size) ||
+            (idle && conf->pool_running)) {
+                list_del_init (&conf->pool_list);
+        } else if (list_empty (&conf->pool_list)) {
+                conf->pool_credit = conf->weight;
+                list_add_tail (&conf->pool_list, &pool->active);
+        }
+
+        if (conf->down && list_empty (&conf->pool_list) &&
+            !conf->pool_running)
+                pthread_cond_broadcast (&pool->drained);
+}
+
+/* the most workers @conf may keep busy at a time */
+static int32_t
+__iot_pool_share (iot_pool_t *pool, iot_conf_t *conf)
+{
+        int32_t share = 0;
+
+        share = pool->max_count / max (pool->members, 1);
+        share = min (share, conf->max_count);
+
+        return max (share, 1);
+}
+
+/* the first instance in line that is not running its share already */
+static iot_conf_t *
+__iot_pool_next (iot_pool_t *pool)
+{
+        iot_conf_t      *conf = NULL;
+
+        list_for_each_entry (conf, &pool->active, pool_list) {
+                if (conf->pool_running < __iot_pool_share (pool, conf))
+                        return conf;
+        }
+
+        return NULL;
+}
+
+void *
+iot_pool_worker (void *data)
+{
+        iot_pool_t       *pool   = NULL;
+        iot_conf_t       *conf   = NULL;
+        iot_shard_t      *home   = NULL;
+        call_stub_t      *stub   = NULL;
+        iot_lane_t       *lane   = NULL;
+        intptr_t          idx    = 0;
+        int               pri    = -1;
+        int               ret    = 0;
+        gf_boolean_t      missed = _gf_false;
+        struct timespec   sleep_till = {0, };
+
+        pool = data;
+        idx = __sync_fetch_and_add (&pool->next_worker, 1) % IOT_MAX_SHARDS
+              + 1;
+        (void) pthread_setspecific (iot_shard_key, (void *) idx);
 
-                        if (!bye)
-                                stub = __iot_dequeue (conf, &pri);
+        pthread_mutex_lock (&pool->mutex);
+        for (;;) {
+                /* the instances at their share get a worker back as soon
+                 * as one of theirs is done */
+                conf = __iot_pool_next (pool);
+                if (!conf) {
+                        sleep_till.tv_sec = time (NULL) + IOT_DEFAULT_IDLE;
+                        pool->sleep_count++;
+                        ret = pthread_cond_timedwait (&pool->cond,
+                                                      &pool->mutex,
+                                                      &sleep_till);
+                        pool->sleep_count--;
+                        if (ret == ETIMEDOUT && list_empty (&pool->active) &&
+                            pool->curr_count > IOT_MIN_THREADS) {
+                                pool->curr_count--;
+                                break;
+                        }
+                        continue;
                 }
-                pthread_mutex_unlock (&conf->mutex);
 
-                if (stub) /* guard against spurious wakeups */
+                if (--conf->pool_credit <= 0) {
+                        /* that was the last one of its turn */
+                        conf->pool_credit = conf->weight;
+                        list_move_tail (&conf->pool_list, &pool->active);
+                }
+                conf->pool_running++;
+                pthread_mutex_unlock (&pool->mutex);
+
+                THIS = conf->this;
+                home = &conf->shards[(idx - 1) % conf->nshards];
+                pri = -1;
+                missed = _gf_false;
+
+                stub = iot_dequeue (conf, home, &pri, &missed);
+                if (stub) {
+                        lane = iot_lane_claim (conf, stub);
+                        iot_account_queue_delay (conf, stub);
                         call_resume (stub);
-                stub = NULL;
+                        GF_ATOMIC_DEC (conf->ac_iot_count[pri]);
+                        if (lane)
+                                iot_lane_leave (conf, home, lane);
+                }
 
-                if (bye)
-                        break;
+                pthread_mutex_lock (&pool->mutex);
+                conf->pool_running--;
+                __iot_pool_requeue (pool, conf, (!stub && !missed));
         }
+        pthread_mutex_unlock (&pool->mutex);
 
         return NULL;
 }
 
+/* puts @conf in line for the pool, and a worker on it */
+static void
+iot_pool_kick (iot_conf_t *conf)
+{
+        iot_pool_t      *pool   = &iot_pool;
+        pthread_t        thread;
+        int              ret    = 0;
+
+        pthread_mutex_lock (&pool->mutex);
+        {
+                if (list_empty (&conf->pool_list)) {
+                        conf->pool_credit = conf->weight;
+                        list_add_tail (&conf->pool_list, &pool->active);
+                }
+
+                if (pool->sleep_count) {
+                        pthread_cond_signal (&pool->cond);
+                } else if (pool->curr_count < pool->max_count) {
+                        ret = gf_thread_create (&thread, &pool->w_attr,
+                                                iot_pool_worker, pool);
+                        if (ret == 0)
+                                pool->curr_count++;
+                }
+        }
+        pthread_mutex_unlock (&pool->mutex);
+
+        /* the stub stays queued for the next one to get a worker going */
+        if (ret)
+                gf_msg (conf->this->name, GF_LOG_WARNING, 0,
+                        IO_THREADS_MSG_INIT_FAILED,
+                        "cannot start a shared pool worker (%d running)",
+                        pool->curr_count);
+}
+
+/* The pool has as many workers as the largest thread-count of the
+ * instances sharing it. */
+static void
+iot_pool_resize (iot_conf_t *conf)
+{
+        iot_pool_t      *pool = &iot_pool;
+
+        pthread_mutex_lock (&pool->mutex);
+        {
+                pool->max_count = max (pool->max_count, conf->max_count);
+        }
+        pthread_mutex_unlock (&pool->mutex);
+}
+
+static void
+iot_pool_join (iot_conf_t *conf)
+{
+        iot_pool_t      *pool = &iot_pool;
+
+        (void) pthread_once (&iot_pool_once, iot_pool_init);
+
+        pthread_mutex_lock (&pool->mutex);
+        {
+                pool->members++;
+                pool->max_count = max (pool->max_count, conf->max_count);
+                conf->pool_joined = _gf_true;
+        }
+        pthread_mutex_unlock (&pool->mutex);
+}
+
+/* waits for the stubs of @conf to be run */
+static void
+iot_pool_leave (iot_conf_t *conf)
+{
+        iot_pool_t      *pool = &iot_pool;
+
+        pthread_mutex_lock (&pool->mutex);
+        {
+                while (!list_empty (&conf->pool_list) || conf->pool_running)
+                        pthread_cond_wait (&pool->drained, &pool->mutex);
+
+                if (conf->pool_joined) {
+                        pool->members--;
+                        conf->pool_joined = _gf_false;
+                }
+        }
+        pthread_mutex_unlock (&pool->mutex);
+}
 
 int
 do_iot_schedule (iot_conf_t *conf, call_stub_t *stub, int pri)
 {
-        int   ret = 0;
+        iot_shard_t      *shard  = NULL;
+        iot_client_ctx_t *ctx    = NULL;
+        client_t         *client = stub->frame->root->client;
+        int               ret    = 0;
+        gf_boolean_t      woken  = _gf_false;
+        iot_lane_t       *lane   = NULL;
+
+        if (conf->inode_affinity) {
+                lane = iot_lane_of (conf, stub);
+                if (lane && !iot_lane_enter (conf, lane, stub))
+                        return 0;
+        }
 
-        pthread_mutex_lock (&conf->mutex);
+        if (client)
+                ctx = iot_get_ctx (conf->this, client);
+
+        shard = iot_shard_of_thread (conf);
+
+        pthread_mutex_lock (&shard->mutex);
         {
-                __iot_enqueue (conf, stub, pri);
+                __iot_enqueue (conf, shard, stub, pri, ctx);
 
-                pthread_cond_signal (&conf->cond);
+                if (!conf->shared_pool && GF_ATOMIC_GET (shard->sleepers)) {
+                        pthread_cond_signal (&shard->cond);
+                        woken = _gf_true;
+                }
+        }
+        pthread_mutex_unlock (&shard->mutex);
 
-                ret = __iot_workers_scale (conf);
+        if (conf->shared_pool) {
+                iot_pool_kick (conf);
+                return 0;
         }
-        pthread_mutex_unlock (&conf->mutex);
+
+        if (!woken)
+                iot_wake_one (conf, shard);
+
+        if (!GF_ATOMIC_GET (conf->sleep_count) &&
+            conf->curr_count < conf->max_count)
+                ret = iot_workers_scale (conf);
 
         return ret;
 }
@@ -272,17 +811,14 @@ iot_get_pri_meaning (iot_pri_t pri)
         return name;
 }
 
-int
-iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
+static int
+iot_stub_pri (iot_conf_t *conf, call_stub_t *stub)
 {
-        int             ret = -1;
         iot_pri_t       pri = IOT_PRI_MAX - 1;
-        iot_conf_t      *conf = this->private;
 
-        if ((frame->root->pid < GF_CLIENT_PID_MAX) && conf->least_priority) {
-                pri = IOT_PRI_LEAST;
-                goto out;
-        }
+        if ((stub->frame->root->pid < GF_CLIENT_PID_MAX) &&
+            conf->least_priority)
+                return IOT_PRI_LEAST;
 
         switch (stub->fop) {
         case GF_FOP_OPEN:
@@ -351,7 +887,20 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         default:
                 return -EINVAL;
         }
-out:
+
+        return pri;
+}
+
+int
+iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
+{
+        int             ret = -1;
+        int             pri = -1;
+
+        pri = iot_stub_pri (this->private, stub);
+        if (pri < 0)
+                return pri;
+
         gf_msg_debug (this->name, 0, "%s scheduled as %s fop",
                       gf_fop_list[stub->fop], iot_get_pri_meaning (pri));
         ret = do_iot_schedule (this->private, stub, pri);
@@ -781,6 +1330,7 @@ iot_setactivelk (call_frame_t *frame, xlator_t *this, loc_t *loc,
 int
 __iot_workers_scale (iot_conf_t *conf)
 {
+        iot_shard_t *home = NULL;
         int       scale = 0;
         int       diff = 0;
         pthread_t thread;
@@ -788,7 +1338,8 @@ __iot_workers_scale (iot_conf_t *conf)
         int       i = 0;
 
         for (i = 0; i < IOT_PRI_MAX; i++)
-                scale += min (conf->queue_sizes[i], conf->ac_iot_limit[i]);
+                scale += min (GF_ATOMIC_GET (conf->queue_sizes[i]),
+                              conf->ac_iot_limit[i]);
 
         if (scale < IOT_MIN_THREADS)
                 scale = IOT_MIN_THREADS;
@@ -803,13 +1354,22 @@ __iot_workers_scale (iot_conf_t *conf)
         while (diff) {
                 diff --;
 
-                ret = gf_thread_create (&thread, &conf->w_attr, iot_worker, conf);
+                /* spread workers evenly over the shards */
+                home = &conf->shards[0];
+                for (i = 1; i < conf->nshards; i++)
+                        if (conf->shards[i].workers < home->workers)
+                                home = &conf->shards[i];
+
+                ret = gf_thread_create (&thread, &conf->w_attr, iot_worker,
+                                        home);
                 if (ret == 0) {
                         conf->curr_count++;
+                        home->workers++;
                         gf_msg_debug (conf->this->name, 0,
-                                      "scaled threads to %d (queue_size=%d/%d)",
-                                      conf->curr_count,
-                                      conf->queue_size, scale);
+                                      "scaled threads to %d (queue_size=%"
+                                      PRId64"/%d)", conf->curr_count,
+                                      GF_ATOMIC_GET (conf->queue_size),
+                                      scale);
                 } else {
                         break;
                 }
@@ -892,7 +1452,13 @@ int
 iot_priv_dump (xlator_t *this)
 {
         iot_conf_t     *conf   =   NULL;
+        iot_shard_t    *shard  =   NULL;
         char           key_prefix[GF_DUMP_MAX_BUF_LEN];
+        char           key[GF_DUMP_MAX_BUF_LEN];
+        int            i       =   0;
+        int            pri     =   0;
+        int            busy    =   0;
+        int64_t        dequeued =  0;
 
         if (!this)
                 return 0;
@@ -908,7 +1474,8 @@ iot_priv_dump (xlator_t *this)
 
         gf_proc_dump_write("maximum_threads_count", "%d", conf->max_count);
         gf_proc_dump_write("current_threads_count", "%d", conf->curr_count);
-        gf_proc_dump_write("sleep_count", "%d", conf->sleep_count);
+        gf_proc_dump_write("sleep_count", "%"PRId64,
+                           GF_ATOMIC_GET (conf->sleep_count));
         gf_proc_dump_write("idle_time", "%d", conf->idle_time);
         gf_proc_dump_write("stack_size", "%zd", conf->stack_size);
         gf_proc_dump_write("high_priority_threads", "%d",
@@ -919,6 +1486,55 @@ iot_priv_dump (xlator_t *this)
                            conf->ac_iot_limit[IOT_PRI_LO]);
         gf_proc_dump_write("least_priority_threads", "%d",
                            conf->ac_iot_limit[IOT_PRI_LEAST]);
+        gf_proc_dump_write("shards", "%d", conf->nshards);
+        gf_proc_dump_write("inode_affinity", "%d", conf->inode_affinity);
+        gf_proc_dump_write("lane_waits", "%"PRId64,
+                           GF_ATOMIC_GET (conf->lane_waits));
+        for (i = 0, busy = 0; i < IOT_LANES; i++)
+                busy += conf->lanes[i].busy;
+        gf_proc_dump_write("lanes_busy", "%d", busy);
+
+        dequeued = GF_ATOMIC_GET (conf->dequeued);
+        gf_proc_dump_write("queue_depth", "%"PRId64,
+                           GF_ATOMIC_GET (conf->queue_size));
+        gf_proc_dump_write("dequeued", "%"PRId64, dequeued);
+        gf_proc_dump_write("avg_queue_latency_usec", "%"PRId64,
+                           dequeued ? GF_ATOMIC_GET (conf->queue_wait) /
+                           dequeued : 0);
+        gf_proc_dump_write("max_queue_latency_usec", "%"PRIu64,
+                           conf->queue_wait_max);
+
+        gf_proc_dump_write("shared_pool", "%d", conf->shared_pool);
+        if (conf->shared_pool && conf->pool_joined) {
+                gf_proc_dump_write("fair_share_weight", "%d", conf->weight);
+                gf_proc_dump_write("pool_threads_count", "%d",
+                                   iot_pool.curr_count);
+                gf_proc_dump_write("pool_maximum_threads_count", "%d",
+                                   iot_pool.max_count);
+                gf_proc_dump_write("pool_sleep_count", "%d",
+                                   iot_pool.sleep_count);
+                gf_proc_dump_write("pool_members", "%d", iot_pool.members);
+        }
+
+        /* unlocked, the numbers move while we look anyway */
+        for (i = 0; i < conf->nshards; i++) {
+                shard = &conf->shards[i];
+                gf_proc_dump_build_key (key, "shard", "%d.workers", i);
+                gf_proc_dump_write (key, "%d", shard->workers);
+                gf_proc_dump_build_key (key, "shard", "%d.sleepers", i);
+                gf_proc_dump_write (key, "%"PRId64,
+                                    GF_ATOMIC_GET (shard->sleepers));
+                for (pri = 0; pri < IOT_PRI_MAX; pri++) {
+                        gf_proc_dump_build_key (key, "shard",
+                                                "%d.queue_size[%d]", i, pri);
+                        gf_proc_dump_write (key, "%d",
+                                            shard->queue_sizes[pri]);
+                }
+                gf_proc_dump_build_key (key, "shard", "%d.dequeued", i);
+                gf_proc_dump_write (key, "%"PRIu64, shard->dequeued);
+                gf_proc_dump_build_key (key, "shard", "%d.stolen", i);
+                gf_proc_dump_write (key, "%"PRIu64, shard->stolen);
+        }
 
         return 0;
 }
@@ -951,18 +1567,48 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("enable-least-priority", conf->least_priority,
                           options, bool, out);
 
+        GF_OPTION_RECONF ("inode-affinity", conf->inode_affinity, options,
+                          bool, out);
+
+        GF_OPTION_RECONF ("fair-share-weight", conf->weight, options, int32,
+                          out);
+        if (conf->shared_pool)
+                iot_pool_resize (conf);
+
 	ret = 0;
 out:
 	return ret;
 }
 
 
+static void
+iot_shards_destroy (iot_conf_t *conf)
+{
+        int     i = 0;
+
+        if (conf->lanes_inited) {
+                for (i = 0; i < IOT_LANES; i++)
+                        LOCK_DESTROY (&conf->lanes[i].lock);
+                conf->lanes_inited = _gf_false;
+        }
+
+        for (i = 0; i < conf->nshards; i++) {
+                if (!conf->shards[i].inited)
+                        continue;
+                pthread_cond_destroy (&conf->shards[i].cond);
+                pthread_mutex_destroy (&conf->shards[i].mutex);
+                conf->shards[i].inited = _gf_false;
+        }
+}
+
 int
 init (xlator_t *this)
 {
         iot_conf_t *conf = NULL;
         int         ret  = -1;
         int         i    = 0;
+        int         pri  = 0;
+        long        ncpu = 0;
 
 	if (!this->children || this->children->next) {
 		gf_msg ("io-threads", GF_LOG_ERROR, 0,
@@ -1021,16 +1667,61 @@ init (xlator_t *this)
         GF_OPTION_INIT ("idle-time", conf->idle_time, int32, out);
         GF_OPTION_INIT ("enable-least-priority", conf->least_priority,
                         bool, out);
+        GF_OPTION_INIT ("inode-affinity", conf->inode_affinity, bool, out);
+        GF_OPTION_INIT ("shared-pool", conf->shared_pool, bool, out);
+        GF_OPTION_INIT ("fair-share-weight", conf->weight, int32, out);
 
         conf->this = this;
-
+        INIT_LIST_HEAD (&conf->pool_list);
+        GF_ATOMIC_INIT (conf->sleep_count, 0);
+        GF_ATOMIC_INIT (conf->queued_seq, 0);
+        GF_ATOMIC_INIT (conf->queue_size, 0);
         for (i = 0; i < IOT_PRI_MAX; i++) {
-                INIT_LIST_HEAD (&conf->clients[i]);
-                INIT_LIST_HEAD (&conf->no_client[i].clients);
-                INIT_LIST_HEAD (&conf->no_client[i].reqs);
+                GF_ATOMIC_INIT (conf->ac_iot_count[i], 0);
+                GF_ATOMIC_INIT (conf->queue_sizes[i], 0);
+        }
+        GF_ATOMIC_INIT (conf->dequeued, 0);
+        GF_ATOMIC_INIT (conf->queue_wait, 0);
+
+        for (i = 0; i < IOT_LANES; i++) {
+                LOCK_INIT (&conf->lanes[i].lock);
+                INIT_LIST_HEAD (&conf->lanes[i].waiting);
         }
+        conf->lanes_inited = _gf_true;
+        GF_ATOMIC_INIT (conf->lane_waits, 0);
 
-	ret = iot_workers_scale (conf);
+        (void) pthread_once (&iot_shard_once, iot_shard_key_init);
+
+        ncpu = sysconf (_SC_NPROCESSORS_ONLN);
+        conf->nshards = (ncpu < 1) ? 1 : min (ncpu, IOT_MAX_SHARDS);
+
+        for (i = 0; i < conf->nshards; i++) {
+                iot_shard_t *shard = &conf->shards[i];
+
+                GF_ATOMIC_INIT (shard->sleepers, 0);
+                if ((ret = pthread_mutex_init (&shard->mutex, NULL)) != 0 ||
+                    (ret = pthread_cond_init (&shard->cond, NULL)) != 0) {
+                        gf_msg (this->name, GF_LOG_ERROR, 0,
+                                IO_THREADS_MSG_INIT_FAILED,
+                                "shard %d init failed (%d)", i, ret);
+                        goto out;
+                }
+                shard->inited = _gf_true;
+                shard->conf = conf;
+
+                for (pri = 0; pri < IOT_PRI_MAX; pri++) {
+                        INIT_LIST_HEAD (&shard->clients[pri]);
+                        INIT_LIST_HEAD (&shard->no_client[pri].clients);
+                        INIT_LIST_HEAD (&shard->no_client[pri].reqs);
+                }
+        }
+
+        if (conf->shared_pool) {
+                iot_pool_join (conf);
+                ret = 0;
+        } else {
+                ret = iot_workers_scale (conf);
+        }
 
         if (ret == -1) {
                 gf_msg (this->name, GF_LOG_ERROR, 0,
@@ -1042,8 +1733,10 @@ init (xlator_t *this)
 	this->private = conf;
         ret = 0;
 out:
-        if (ret)
+        if (ret && conf) {
+                iot_shards_destroy (conf);
                 GF_FREE (conf);
+        }
 
 	return ret;
 }
@@ -1051,11 +1744,27 @@ out:
 static void
 iot_exit_threads (iot_conf_t *conf)
 {
+        int     i = 0;
+
+        conf->down = _gf_true;
+
+        if (conf->shared_pool) {
+                if (conf->pool_joined)
+                        iot_pool_leave (conf);
+                return;
+        }
+
+        /*Let all the threads know that xl is going down*/
+        for (i = 0; i < conf->nshards; i++) {
+                pthread_mutex_lock (&conf->shards[i].mutex);
+                {
+                        pthread_cond_broadcast (&conf->shards[i].cond);
+                }
+                pthread_mutex_unlock (&conf->shards[i].mutex);
+        }
+
         pthread_mutex_lock (&conf->mutex);
         {
-                conf->down = _gf_true;
-                /*Let all the threads know that xl is going down*/
-                pthread_cond_broadcast (&conf->cond);
                 while (conf->curr_count)/*Wait for threads to exit*/
                         pthread_cond_wait (&conf->cond, &conf->mutex);
         }
@@ -1092,6 +1801,8 @@ fini (xlator_t *this)
         if (conf->mutex_inited)
                 pthread_mutex_destroy (&conf->mutex);
 
+        iot_shards_destroy (conf);
+
 	GF_FREE (conf);
 
 	this->private = NULL;
@@ -1220,6 +1931,32 @@ struct volume_options options[] = {
           .default_value = "on",
           .description = "Enable/Disable least priority"
         },
+        { .key  = {"inode-affinity"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Run xattrop, inodelk, entrylk and xattr updates "
+                         "on one inode in order, one at a time, instead of "
+                         "handing them to as many threads only to have them "
+                         "wait on each other below"
+        },
+        { .key  = {"shared-pool"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Run fops on a pool of threads shared by all the "
+                         "io-threads instances of the process that have "
+                         "this on, which take turns at it, instead of on "
+                         "threads of their own. Meant for multiplexed "
+                         "bricks. Takes effect when the brick is restarted"
+        },
+        { .key  = {"fair-share-weight"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 64,
+          .default_value = "1",
+          .description = "With shared-pool on, the number of fops this "
+                         "instance gets run in its turn before the next "
+                         "instance with fops queued gets the shared threads"
+        },
         {.key   = {"idle-time"},
          .type  = GF_OPTION_TYPE_INT,
          .min   = 1,
@@ -24,6 +24,7 @@
 #include "iot-mem-types.h"
 #include <semaphore.h>
 #include "statedump.h"
+#include "atomic.h"
 
 
 struct iot_conf;
@@ -39,6 +40,10 @@ struct iot_conf;
 
 #define IOT_THREAD_STACK_SIZE   ((size_t)(256*1024))
 
+#define IOT_MAX_SHARDS          8
+
+#define IOT_LANES               256
+
 
 typedef enum {
         IOT_PRI_HI = 0, /* low latency */
@@ -53,15 +58,16 @@ typedef struct {
         struct list_head        reqs;
 } iot_client_ctx_t;
 
-struct iot_conf {
+/*
+ * Stubs are queued on the shard of the thread winding them and run by the
+ * workers living on that shard; a worker that finds its own shard empty
+ * steals from the others before it goes to sleep.  Within a shard clients
+ * are served round-robin per priority, as they used to be globally.
+ */
+typedef struct {
         pthread_mutex_t      mutex;
         pthread_cond_t       cond;
-
-        int32_t              max_count;   /* configured maximum */
-        int32_t              curr_count;  /* actual number of threads running */
-        int32_t              sleep_count;
-
-        int32_t              idle_time;   /* in seconds */
+        struct iot_conf     *conf;
 
         struct list_head     clients[IOT_PRI_MAX];
         /*
@@ -72,13 +78,96 @@ struct iot_conf {
          */
         iot_client_ctx_t     no_client[IOT_PRI_MAX];
 
-        int32_t              ac_iot_limit[IOT_PRI_MAX];
-        int32_t              ac_iot_count[IOT_PRI_MAX];
         int                  queue_sizes[IOT_PRI_MAX];
         int                  queue_size;
+        int32_t              workers;     /* living here, under conf->mutex */
+        gf_atomic_t          sleepers;
+        uint64_t             dequeued;    /* by its own workers */
+        uint64_t             stolen;      /* by other shards' workers */
+        gf_boolean_t         inited;
+} iot_shard_t;
+
+/*
+ * With inode-affinity on, the fops that xlators below us serialize per inode
+ * (xattrop, inode and entry locks, xattr updates) are ordered through the
+ * lane their gfid hashes to.  A lane has at most one stub queued or running;
+ * the rest wait on the lane in arrival order and the worker finishing one
+ * queues the next on its own shard.  A burst on a hot inode then keeps one
+ * worker busy instead of parking many on the same mutex further down,
+ * while fops on other inodes still run in parallel.
+ */
+typedef struct {
+        gf_lock_t            lock;
+        call_stub_t         *queued;      /* handed to a shard, not run yet */
+        gf_boolean_t         busy;
+        struct list_head     waiting;
+} iot_lane_t;
+
+/*
+ * With shared-pool on, an instance starts no workers of its own.  Its stubs
+ * are queued as usual, on its own shards, and run by one pool of workers
+ * serving all such instances of the process, i.e. all the bricks attached
+ * to it with brick multiplexing.  Instances with work queued take turns in
+ * the order they got it, each running up to fair-share-weight stubs before
+ * going to the back of the line, so a busy brick cannot starve the others.
+ * Nor can one whose fops block: an instance never has more than its share
+ * of the workers (max_count / members, and at most its own thread-count)
+ * running its stubs at a time.
+ */
+typedef struct iot_pool {
+        pthread_mutex_t      mutex;
+        pthread_cond_t       cond;        /* for work */
+        pthread_cond_t       drained;     /* for a leaving instance */
+        struct list_head     active;      /* iot_conf_t with stubs queued */
+        int32_t              max_count;   /* largest thread-count of all */
+        int32_t              curr_count;
+        int32_t              sleep_count;
+        int32_t              members;
+        int                  next_worker;
+        pthread_attr_t       w_attr;
+} iot_pool_t;
+
+struct iot_conf {
+        pthread_mutex_t      mutex;       /* thread count, client ctxs */
+        pthread_cond_t       cond;
+
+        int32_t              max_count;   /* configured maximum */
+        int32_t              curr_count;  /* actual number of threads running */
+        gf_atomic_t          sleep_count;
+
+        int32_t              idle_time;   /* in seconds */
+
+        iot_shard_t          shards[IOT_MAX_SHARDS];
+        int                  nshards;
+        /* bumped on every enqueue, lets a worker tell whether anything
+         * arrived since it last looked at the shards */
+        gf_atomic_t          queued_seq;
+
+        int32_t              ac_iot_limit[IOT_PRI_MAX];
+        gf_atomic_t          ac_iot_count[IOT_PRI_MAX];
+        gf_atomic_t          queue_sizes[IOT_PRI_MAX];
+        gf_atomic_t          queue_size;
         pthread_attr_t       w_attr;
         gf_boolean_t         least_priority; /*Enable/Disable least-priority */
 
+        gf_boolean_t         inode_affinity;
+        iot_lane_t           lanes[IOT_LANES];
+        gf_atomic_t          lane_waits;  /* stubs that found their lane busy */
+        gf_boolean_t         lanes_inited;
+
+        gf_boolean_t         shared_pool;
+        int32_t              weight;
+        /* the following are under the pool mutex */
+        struct list_head     pool_list;   /* on iot_pool_t active */
+        int32_t              pool_credit; /* stubs left in this turn */
+        int32_t              pool_running;
+        gf_boolean_t         pool_joined;
+
+        /* time spent queued by the stubs run so far, in usecs */
+        gf_atomic_t          dequeued;
+        gf_atomic_t          queue_wait;
+        uint64_t             queue_wait_max;
+
         xlator_t            *this;
         size_t               stack_size;
         gf_boolean_t         down; /*PARENT_DOWN event is notified*/
@@ -140,14 +140,26 @@ typedef struct mdc_local mdc_local_t;
 
 #define MDC_STACK_UNWIND(fop, frame, params ...) do {           \
                 mdc_local_t *__local = NULL;                    \
+                mdc_local_t  __held;                            \
                 xlator_t    *__xl    = NULL;                    \
                 if (frame) {                                    \
                         __xl         = frame->this;             \
                         __local      = frame->local;            \
                         frame->local = NULL;                    \
                 }                                               \
-                STACK_UNWIND_STRICT (fop, frame, params);       \
-                mdc_local_wipe (__xl, __local);                 \
+                /* an arena local lives as long as the stack:   \
+                   carry its refs out so they are dropped at    \
+                   unwind, not when the whole stack goes */     \
+                if (__local &&                                  \
+                    stack_arena_owns (frame->root, __local)) {  \
+                        __held = *__local;                      \
+                        memset (__local, 0, sizeof (*__local)); \
+                        STACK_UNWIND_STRICT (fop, frame, params); \
+                        mdc_local_fini (&__held);               \
+                } else {                                        \
+                        STACK_UNWIND_STRICT (fop, frame, params); \
+                        mdc_local_wipe (__xl, __local);         \
+                }                                               \
         } while (0)
 
 
@@ -243,6 +255,9 @@ mdc_inode_ctx_set (xlator_t *this, inode_t *inode, struct md_cache *mdc)
 }
 
 
+static void
+mdc_local_fini (void *data);
+
 mdc_local_t *
 mdc_local_get (call_frame_t *frame)
 {
@@ -252,7 +267,11 @@ mdc_local_get (call_frame_t *frame)
         if (local)
                 goto out;
 
-        local = GF_CALLOC (sizeof (*local), 1, gf_mdc_mt_mdc_local_t);
+        local = stack_arena_get (frame->root, sizeof (*local),
+                                 mdc_local_fini);
+        if (!local)
+                local = GF_CALLOC (sizeof (*local), 1,
+                                   gf_mdc_mt_mdc_local_t);
         if (!local)
                 goto out;
 
@@ -262,11 +281,10 @@ out:
 }
 
 
-void
-mdc_local_wipe (xlator_t *this, mdc_local_t *local)
+static void
+mdc_local_fini (void *data)
 {
-        if (!local)
-                return;
+        mdc_local_t *local = data;
 
         loc_wipe (&local->loc);
 
@@ -281,6 +299,16 @@ mdc_local_wipe (xlator_t *this, mdc_local_t *local)
 
         if (local->xattr)
                 dict_unref (local->xattr);
+}
+
+
+void
+mdc_local_wipe (xlator_t *this, mdc_local_t *local)
+{
+        if (!local)
+                return;
+
+        mdc_local_fini (local);
 
         GF_FREE (local);
         return;
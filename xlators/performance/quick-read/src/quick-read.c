@@ -180,7 +180,8 @@ qr_inode_set_priority (xlator_t *this, inode_t *inode, const char *path)
 void
 __qr_inode_prune (qr_inode_table_t *table, qr_inode_t *qr_inode)
 {
-	GF_FREE (qr_inode->data);
+	if (qr_inode->data)
+		mem_put (qr_inode->data);
 	qr_inode->data = NULL;
 
 	if (!list_empty (&qr_inode->lru)) {
@@ -261,17 +262,25 @@ qr_cache_prune (xlator_t *this)
 }
 
 
+/* Cached files are small and come and go with the inode table, so keep
+   their content in the size-class pools rather than the general heap.
+   max-file-size keeps every copy within the largest class. */
 void *
 qr_content_extract (dict_t *xdata)
 {
-	data_t  *data = NULL;
-	void    *content = NULL;
+	data_t           *data = NULL;
+	void             *content = NULL;
+	struct mem_pool  *pool = NULL;
 
 	data = dict_get (xdata, GF_CONTENT_KEY);
 	if (!data)
 		return NULL;
 
-	content = GF_CALLOC (1, data->len, gf_qr_mt_content_t);
+	pool = mem_pool_new_fn (max (data->len, 1), 0, "qr_content");
+	if (!pool)
+		return NULL;
+
+	content = mem_get (pool);
 	if (!content)
 		return NULL;
 
@@ -426,7 +435,7 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 		qr_inode = qr_inode_ctx_get_or_new (this, inode);
 		if (!qr_inode) {
 			/* no harm done */
-			GF_FREE (content);
+			mem_put (content);
 			goto out;
 		}
 		qr_content_update (this, qr_inode, content, buf);
@@ -13,6 +13,7 @@
 #include "dict.h"
 #include "xlator.h"
 #include "read-ahead.h"
+#include "timespec.h"
 #include <assert.h>
 #include "read-ahead-messages.h"
 
@@ -66,6 +67,8 @@ ra_page_create (ra_file_t *file, off_t offset)
                 page->prev->next = newpage;
                 page->prev = newpage;
 
+                GF_ATOMIC_ADD (file->conf->cached, file->page_size);
+
                 page = newpage;
         }
 
@@ -139,6 +142,8 @@ ra_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         ra_waitq_t   *waitq          = NULL;
         fd_t         *fd             = NULL;
         uint64_t      tmp_file       = 0;
+        struct timespec now          = {0, };
+        uint64_t      usecs          = 0;
 
         GF_ASSERT (frame);
 
@@ -159,10 +164,16 @@ ra_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
+        timespec_now (&now);
+        usecs = (TS (now) - TS (local->wound)) / 1000;
+
         ra_file_lock (file);
         {
-                if (op_ret >= 0)
+                if (op_ret >= 0) {
                         file->stbuf = *stbuf;
+                        file->latency = file->latency
+                                ? (file->latency * 7 + usecs) / 8 : usecs;
+                }
 
                 page = ra_page_get (file, pending_offset);
 
@@ -263,12 +274,15 @@ ra_page_fault (ra_file_t *file, call_frame_t *frame, off_t offset)
         fault_local->pending_offset = offset;
         fault_local->pending_size = file->page_size;
 
-        fault_local->fd = fd_ref (file->fd);
+        /* the file is shared by the fds of the inode, fault through the
+           one being read from */
+        fault_local->fd = fd_ref (((ra_local_t *)frame->local)->fd);
+        timespec_now (&fault_local->wound);
 
         STACK_WIND (fault_frame, ra_fault_cbk,
                     FIRST_CHILD (fault_frame->this),
                     FIRST_CHILD (fault_frame->this)->fops->readv,
-                    file->fd, file->page_size, offset, 0, NULL);
+                    fault_local->fd, file->page_size, offset, 0, NULL);
 
         return;
 
@@ -523,6 +537,10 @@ ra_page_purge (ra_page_t *page)
         page->prev->next = page->next;
         page->next->prev = page->prev;
 
+        GF_ATOMIC_SUB (page->file->conf->cached, page->file->page_size);
+        if (page->dirty && page->ready)
+                GF_ATOMIC_INC (page->file->conf->wasted);
+
         if (page->iobref) {
                 iobref_unref (page->iobref);
         }
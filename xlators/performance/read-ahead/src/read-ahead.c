@@ -21,49 +21,35 @@
 #include "xlator.h"
 #include "read-ahead.h"
 #include "statedump.h"
+#include "timespec.h"
 #include <assert.h>
 #include <sys/time.h>
 #include "read-ahead-messages.h"
 
 static void
-read_ahead (call_frame_t *frame, ra_file_t *file);
+read_ahead (call_frame_t *frame, ra_file_t *file, int idx);
 
+static void
+ra_fd_detach (xlator_t *this, fd_t *fd, ra_file_t *file);
 
-int
-ra_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
-             int32_t op_ret, int32_t op_errno, fd_t *fd, dict_t *xdata)
-{
-        ra_conf_t  *conf    = NULL;
-        ra_file_t  *file    = NULL;
-        int         ret     = 0;
-
-        GF_ASSERT (frame);
-        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
-
-        conf  = this->private;
 
-        if (op_ret == -1) {
-                goto unwind;
-        }
+static ra_file_t *
+ra_file_new (ra_conf_t *conf, int disabled)
+{
+        ra_file_t *file = NULL;
 
         file = GF_CALLOC (1, sizeof (*file), gf_ra_mt_ra_file_t);
-        if (!file) {
-                op_ret = -1;
-                op_errno = ENOMEM;
-                goto unwind;
-        }
-
-        /* If O_DIRECT open, we disable caching on it */
-
-        if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY))
-                file->disabled = 1;
+        if (!file)
+                goto out;
 
-        file->offset = (unsigned long long) 0;
+        file->disabled = disabled;
         file->conf = conf;
         file->pages.next = &file->pages;
         file->pages.prev = &file->pages;
         file->pages.offset = (unsigned long long) 0;
         file->pages.file = file;
+        file->page_size = conf->page_size;
+        pthread_mutex_init (&file->file_lock, NULL);
 
         ra_conf_lock (conf);
         {
@@ -74,23 +60,101 @@ ra_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
         ra_conf_unlock (conf);
 
-        file->fd = fd;
-        file->page_count = conf->page_count;
-        file->page_size = conf->page_size;
-        pthread_mutex_init (&file->file_lock, NULL);
+out:
+        return file;
+}
+
 
-        if (!file->disabled) {
-                file->page_count = 1;
+/* Readers on different fds of an inode share its pages and streams, so the
+ * file hangs off the inode ctx and is refcounted by the fds using it.  fds
+ * opened O_DIRECT or write-only get a disabled file of their own. */
+static int
+ra_fd_attach (xlator_t *this, fd_t *fd)
+{
+        ra_conf_t *conf     = NULL;
+        ra_file_t *file     = NULL;
+        uint64_t   tmp_file = 0;
+        int        ret      = -1;
+
+        conf = this->private;
+
+        if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY)) {
+                file = ra_file_new (conf, 1);
+                if (file)
+                        file->refcount = 1;
+        } else {
+                LOCK (&fd->inode->lock);
+                {
+                        __inode_ctx_get (fd->inode, this, &tmp_file);
+                        file = (ra_file_t *)(long)tmp_file;
+                        if (!file) {
+                                file = ra_file_new (conf, 0);
+                                if (file &&
+                                    __inode_ctx_set (fd->inode, this,
+                                                     (uint64_t *)&file)) {
+                                        ra_file_destroy (file);
+                                        file = NULL;
+                                }
+                        }
+                        if (file)
+                                file->refcount++;
+                }
+                UNLOCK (&fd->inode->lock);
         }
 
+        if (!file)
+                goto out;
+
         ret = fd_ctx_set (fd, this, (uint64_t)(long)file);
         if (ret == -1) {
-                gf_msg (frame->this->name, GF_LOG_WARNING,
+                gf_msg (this->name, GF_LOG_WARNING,
                         0, READ_AHEAD_MSG_NO_MEMORY,
                         "cannot set read-ahead context"
                         "information in fd (%p)",
                         fd);
+                ra_fd_detach (this, fd, file);
+        }
+
+out:
+        return ret;
+}
+
+
+static void
+ra_fd_detach (xlator_t *this, fd_t *fd, ra_file_t *file)
+{
+        int32_t refcount = 0;
+
+        if (file->disabled) {
+                ra_file_destroy (file);
+                return;
+        }
+
+        LOCK (&fd->inode->lock);
+        {
+                refcount = --file->refcount;
+                if (!refcount)
+                        __inode_ctx_put (fd->inode, this, 0);
+        }
+        UNLOCK (&fd->inode->lock);
+
+        if (!refcount)
                 ra_file_destroy (file);
+}
+
+
+int
+ra_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, fd_t *fd, dict_t *xdata)
+{
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+
+        if (op_ret == -1) {
+                goto unwind;
+        }
+
+        if (ra_fd_attach (this, fd)) {
                 op_ret = -1;
                 op_errno = ENOMEM;
         }
@@ -110,61 +174,14 @@ ra_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                struct iatt *buf, struct iatt *preparent,
                struct iatt *postparent, dict_t *xdata)
 {
-        ra_conf_t  *conf = NULL;
-        ra_file_t  *file = NULL;
-        int         ret  = 0;
-
         GF_ASSERT (frame);
         GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
 
-        conf  = this->private;
-
         if (op_ret == -1) {
                 goto unwind;
         }
 
-        file = GF_CALLOC (1, sizeof (*file), gf_ra_mt_ra_file_t);
-        if (!file) {
-                op_ret = -1;
-                op_errno = ENOMEM;
-                goto unwind;
-        }
-
-        /* If O_DIRECT open, we disable caching on it */
-
-        if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY))
-                file->disabled = 1;
-
-        file->offset = (unsigned long long) 0;
-        //file->size = fd->inode->buf.ia_size;
-        file->conf = conf;
-        file->pages.next = &file->pages;
-        file->pages.prev = &file->pages;
-        file->pages.offset = (unsigned long long) 0;
-        file->pages.file = file;
-
-        ra_conf_lock (conf);
-        {
-                file->next = conf->files.next;
-                conf->files.next = file;
-                file->next->prev = file;
-                file->prev = &conf->files;
-        }
-        ra_conf_unlock (conf);
-
-        file->fd = fd;
-        file->page_count = conf->page_count;
-        file->page_size = conf->page_size;
-        pthread_mutex_init (&file->file_lock, NULL);
-
-        ret = fd_ctx_set (fd, this, (uint64_t)(long)file);
-        if (ret == -1) {
-                gf_msg (this->name, GF_LOG_WARNING,
-                        0, READ_AHEAD_MSG_NO_MEMORY,
-                        "cannot set read ahead context"
-                        "information in fd (%p)",
-                        fd);
-                ra_file_destroy (file);
+        if (ra_fd_attach (this, fd)) {
                 op_ret = -1;
                 op_errno = ENOMEM;
         }
@@ -257,7 +274,7 @@ ra_release (xlator_t *this, fd_t *fd)
         ret = fd_ctx_del (fd, this, &tmp_file);
 
         if (!ret) {
-                ra_file_destroy ((ra_file_t *)(long)tmp_file);
+                ra_fd_detach (this, fd, (ra_file_t *)(long)tmp_file);
         }
 
 out:
@@ -265,75 +282,248 @@ out:
 }
 
 
-void
-read_ahead (call_frame_t *frame, ra_file_t *file)
+static uint64_t
+ra_usecs (void)
 {
-        off_t      ra_offset   = 0;
-        size_t     ra_size     = 0;
-        off_t      trav_offset = 0;
-        ra_page_t *trav        = NULL;
-        off_t      cap         = 0;
-        char       fault       = 0;
+        struct timespec now = {0, };
 
-        GF_VALIDATE_OR_GOTO ("read-ahead", frame, out);
-        GF_VALIDATE_OR_GOTO (frame->this->name, file, out);
+        timespec_now (&now);
+        return TS (now) / 1000;
+}
 
-        if (!file->page_count) {
-                goto out;
-        }
 
-        ra_size   = file->page_size * file->page_count;
-        ra_offset = floor (file->offset, file->page_size);
-        cap       = file->size ? file->size : file->offset + ra_size;
+/* Find the stream which the read of @size at @offset continues, or start a
+ * new one in place of the least recently used.  Called with the file
+ * locked. */
+static int
+__ra_stream_get (ra_file_t *file, off_t offset, size_t size)
+{
+        ra_conf_t        *conf   = NULL;
+        struct ra_stream *s      = NULL;
+        uint64_t          now    = 0;
+        off_t             reach  = 0;
+        int               formed = 0;
+        int               idx    = -1;
+        int               i      = 0;
+
+        conf = file->conf;
+        now = ra_usecs ();
+
+        /* right where a stream was expected to go next */
+        for (i = 0; i < RA_MAX_STREAMS; i++) {
+                s = &file->streams[i];
+                if (!s->stamp)
+                        continue;
+
+                if ((!s->stride && offset == s->next) ||
+                    (s->stride && offset == s->last + s->stride)) {
+                        idx = i;
+                        goto found;
+                }
+        }
 
-        while (ra_offset < min (file->offset + ra_size, cap)) {
+        /* The reads of a sequential stream may be issued in parallel and
+           arrive out of order, so anything within what is being read ahead
+           still counts.  A stream seen only once may turn out strided. */
+        for (i = 0; i < RA_MAX_STREAMS; i++) {
+                s = &file->streams[i];
+                if (!s->stamp || s->stride)
+                        continue;
+
+                reach = max (s->next, s->ra_end);
+                if (s->seq && offset + (off_t)file->page_size > s->last &&
+                    offset <= reach) {
+                        idx = i;
+                        goto found;
+                }
 
-                ra_file_lock (file);
-                {
-                        trav = ra_page_get (file, ra_offset);
+                if (!s->seq && offset > s->next &&
+                    offset - s->last <= RA_MAX_STRIDE_PAGES * file->page_size) {
+                        s->stride = offset - s->last;
+                        formed = 1;
+                        idx = i;
+                        goto found;
                 }
-                ra_file_unlock (file);
+        }
 
-                if (!trav)
-                        break;
+        idx = 0;
+        for (i = 1; i < RA_MAX_STREAMS; i++) {
+                if (file->streams[i].stamp < file->streams[idx].stamp)
+                        idx = i;
+        }
+
+        s = &file->streams[idx];
+        memset (s, 0, sizeof (*s));
+        s->last = offset;
+        s->next = offset + size;
+        s->stamp = now;
 
-                ra_offset += file->page_size;
+        return idx;
+
+found:
+        if (!formed && ++s->seq == 1) {
+                if (s->stride)
+                        GF_ATOMIC_INC (conf->strided);
+                else
+                        GF_ATOMIC_INC (conf->sequential);
         }
 
-        if (trav) {
-                /* comfortable enough */
-                goto out;
+        s->interval = s->interval ? (s->interval * 7 + (now - s->stamp)) / 8
+                                  : now - s->stamp;
+        s->stamp = now;
+
+        if (s->stride || offset > s->last)
+                s->last = offset;
+        if (s->stride || offset + size > s->next)
+                s->next = offset + size;
+
+        return idx;
+}
+
+
+/* Drop the pages which no stream is going to read any more.  Pages being
+   read ahead, or waited on, are left alone.  Called with the file locked. */
+static void
+__ra_file_prune (ra_file_t *file)
+{
+        struct ra_stream *s    = NULL;
+        ra_page_t        *trav = NULL;
+        ra_page_t        *next = NULL;
+        int               keep = 0;
+        int               i    = 0;
+
+        for (trav = file->pages.next; trav != &file->pages; trav = next) {
+                next = trav->next;
+
+                if (trav->waitq || !trav->ready)
+                        continue;
+
+                keep = 0;
+                for (i = 0; i < RA_MAX_STREAMS && !keep; i++) {
+                        s = &file->streams[i];
+                        if (!s->stamp)
+                                continue;
+
+                        keep = (trav->offset >= floor (s->last, file->page_size)
+                                && trav->offset < max (s->next, s->ra_end));
+                }
+
+                if (!keep)
+                        ra_page_purge (trav);
         }
+}
 
-        trav_offset = ra_offset;
 
-        cap  = file->size ? file->size : ra_offset + ra_size;
+/* Size the window of @s so that what is read ahead arrives before the
+   stream gets to it: as many reads as fit in a page fault, doubled each time
+   a read still had to wait, and halved back when it is well over that. */
+static void
+__ra_stream_window (ra_file_t *file, struct ra_stream *s, char late)
+{
+        ra_conf_t *conf = NULL;
+        uint64_t   need = 0;
+
+        conf = file->conf;
+
+        need = roof (s->next - s->last, file->page_size) / file->page_size;
+        need = max (need, 1) * (1 + file->latency / max (s->interval, 1));
+
+        if (!s->window)
+                s->window = need;
+        else if (late)
+                s->window *= 2;
+        else if (s->window > 2 * need)
+                s->window /= 2;
+
+        s->window = max (s->window, need);
+        s->window = min (s->window, conf->page_count);
+}
+
+
+static void
+read_ahead (call_frame_t *frame, ra_file_t *file, int idx)
+{
+        ra_conf_t        *conf     = NULL;
+        ra_local_t       *local    = NULL;
+        struct ra_stream *s        = NULL;
+        ra_page_t        *trav     = NULL;
+        off_t             faults[RA_MAX_PAGE_COUNT];
+        off_t             target   = 0;
+        off_t             trav_offset = 0;
+        off_t             end      = 0;
+        uint32_t          count    = 0;
+        int               nfaults  = 0;
+        int               i        = 0;
+
+        GF_VALIDATE_OR_GOTO ("read-ahead", frame, out);
+        GF_VALIDATE_OR_GOTO (frame->this->name, file, out);
+
+        conf  = file->conf;
+        local = frame->local;
+
+        ra_file_lock (file);
+        {
+                s = &file->streams[idx];
+
+                if (s->seq)
+                        __ra_stream_window (file, s, local->late);
+
+                __ra_file_prune (file);
+
+                if (!s->seq || s->next == s->last)
+                        goto unlock;
+
+                /* a contiguous stream reads ahead the pages following it, a
+                   strided one the pages of its next reads */
+                for (i = 1; count < s->window; i++) {
+                        target = s->stride ? s->last + i * s->stride : s->next;
+                        trav_offset = floor (target, file->page_size);
+                        end = s->stride
+                                ? roof (target + (s->next - s->last),
+                                        file->page_size)
+                                : trav_offset + s->window * file->page_size;
+
+                        for (; trav_offset < end && count < s->window;
+                             trav_offset += file->page_size) {
+                                if (file->stbuf.ia_size &&
+                                    trav_offset >= file->stbuf.ia_size)
+                                        goto unlock;
+
+                                count++;
+                                s->ra_end = max (s->ra_end, trav_offset +
+                                                 (off_t)file->page_size);
+
+                                if (ra_page_get (file, trav_offset))
+                                        continue;
+
+                                if (GF_ATOMIC_GET (conf->cached) +
+                                    file->page_size > conf->prefetch_limit) {
+                                        GF_ATOMIC_INC (conf->throttled);
+                                        goto unlock;
+                                }
 
-        while (trav_offset < min(ra_offset + ra_size, cap)) {
-                fault = 0;
-                ra_file_lock (file);
-                {
-                        trav = ra_page_get (file, trav_offset);
-                        if (!trav) {
-                                fault = 1;
                                 trav = ra_page_create (file, trav_offset);
-                                if (trav)
-                                        trav->dirty = 1;
+                                if (!trav) {
+                                        /* OUT OF MEMORY */
+                                        goto unlock;
+                                }
+
+                                trav->dirty = 1;
+                                faults[nfaults++] = trav_offset;
                         }
-                }
-                ra_file_unlock (file);
 
-                if (!trav) {
-                        /* OUT OF MEMORY */
-                        break;
+                        if (!s->stride)
+                                break;
                 }
+        }
+unlock:
+        ra_file_unlock (file);
 
-                if (fault) {
-                        gf_msg_trace (frame->this->name, 0,
-                                      "RA at offset=%"PRId64, trav_offset);
-                        ra_page_fault (file, frame, trav_offset);
-                }
-                trav_offset += file->page_size;
+        for (i = 0; i < nfaults; i++) {
+                gf_msg_trace (frame->this->name, 0,
+                              "RA at offset=%"PRId64, faults[i]);
+                GF_ATOMIC_INC (conf->prefetched);
+                ra_page_fault (file, frame, faults[i]);
         }
 
 out:
@@ -393,6 +583,15 @@ dispatch_requests (call_frame_t *frame, ra_file_t *file)
                                 fault = 1;
                                 need_atime_update = 0;
                         }
+
+                        if (trav->dirty) {
+                                if (trav->ready) {
+                                        GF_ATOMIC_INC (conf->hits);
+                                } else {
+                                        GF_ATOMIC_INC (conf->late);
+                                        local->late = 1;
+                                }
+                        }
                         trav->dirty = 0;
 
                         if (trav->ready) {
@@ -420,6 +619,7 @@ dispatch_requests (call_frame_t *frame, ra_file_t *file)
                         gf_msg_trace (frame->this->name, 0,
                                       "MISS at offset=%"PRId64".",
                                       trav_offset);
+                        GF_ATOMIC_INC (conf->misses);
                         ra_page_fault (file, frame, trav_offset);
                 }
 
@@ -437,7 +637,7 @@ dispatch_requests (call_frame_t *frame, ra_file_t *file)
                 STACK_WIND (ra_frame, ra_need_atime_cbk,
                             FIRST_CHILD (frame->this),
                             FIRST_CHILD (frame->this)->fops->readv,
-                            file->fd, 1, 1, 0, NULL);
+                            local->fd, 1, 1, 0, NULL);
         }
 
 out:
@@ -464,19 +664,16 @@ int
 ra_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
           off_t offset, uint32_t flags, dict_t *xdata)
 {
-        ra_file_t   *file            = NULL;
-        ra_local_t  *local           = NULL;
-        ra_conf_t   *conf            = NULL;
-        int          op_errno        = EINVAL;
-        char         expected_offset = 1;
-        uint64_t     tmp_file        = 0;
+        ra_file_t   *file     = NULL;
+        ra_local_t  *local    = NULL;
+        int          op_errno = EINVAL;
+        int          idx      = 0;
+        uint64_t     tmp_file = 0;
 
         GF_ASSERT (frame);
         GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
         GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
 
-        conf = this->private;
-
         gf_msg_trace (this->name, 0,
                       "NEW REQ at offset=%"PRId64" for size=%"GF_PRI_SIZET"",
                       offset, size);
@@ -488,30 +685,6 @@ ra_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 goto disabled;
         }
 
-        if (file->offset != offset) {
-                gf_msg_trace (this->name, 0,
-                              "unexpected offset (%"PRId64" != %"PRId64") "
-                              "resetting",
-                              file->offset, offset);
-
-                expected_offset = file->expected = file->page_count = 0;
-        } else {
-                gf_msg_trace (this->name, 0,
-                              "expected offset (%"PRId64") when page_count=%d",
-                              offset, file->page_count);
-
-                if (file->expected < (file->page_size * conf->page_count)) {
-                        file->expected += size;
-                        file->page_count = min ((file->expected
-                                                 / file->page_size),
-                                                conf->page_count);
-                }
-        }
-
-        if (!expected_offset) {
-                flush_region (frame, file, 0, file->pages.prev->offset + 1, 0);
-        }
-
         local = mem_get0 (this->local_pool);
         if (!local) {
                 op_errno = ENOMEM;
@@ -530,15 +703,21 @@ ra_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
         frame->local = local;
 
-        dispatch_requests (frame, file);
+        ra_file_lock (file);
+        {
+                idx = __ra_stream_get (file, offset, size);
+        }
+        ra_file_unlock (file);
 
-        flush_region (frame, file, 0, floor (offset, file->page_size), 0);
+        gf_msg_trace (this->name, 0, "offset=%"PRId64" in stream %d "
+                      "(%u reads, stride %"PRId64")", offset, idx,
+                      file->streams[idx].seq, file->streams[idx].stride);
 
-        read_ahead (frame, file);
+        dispatch_requests (frame, file);
 
-        ra_frame_return (frame);
+        read_ahead (frame, file, idx);
 
-        file->offset = offset + size;
+        ra_frame_return (frame);
 
         return 0;
 
@@ -677,8 +856,12 @@ ra_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
         if (file) {
                 flush_region (frame, file, 0, file->pages.prev->offset+1, 1);
                 frame->local = file;
-                /* reset the read-ahead counters too */
-                file->expected = file->page_count = 0;
+                /* reset the read-ahead streams too */
+                ra_file_lock (file);
+                {
+                        memset (file->streams, 0, sizeof (file->streams));
+                }
+                ra_file_unlock (file);
         }
 
         STACK_WIND (frame, ra_writev_cbk,
@@ -805,6 +988,7 @@ ra_fdctx_dump (xlator_t *this, fd_t *fd)
 {
 	ra_file_t    *file     = NULL;
         ra_page_t    *page     = NULL;
+        struct ra_stream *stream = NULL;
         int32_t       ret      = 0, i = 0;
         uint64_t      tmp_file = 0;
         char         *path     = NULL;
@@ -842,10 +1026,25 @@ ra_fdctx_dump (xlator_t *this, fd_t *fd)
 
         gf_proc_dump_write ("page-size", "%"PRId64, file->page_size);
 
-        gf_proc_dump_write ("page-count", "%u", file->page_count);
+        gf_proc_dump_write ("refcount", "%d", file->refcount);
 
-        gf_proc_dump_write ("next-expected-offset-for-sequential-reads",
-                            "%"PRId64, file->offset);
+        gf_proc_dump_write ("fault-latency-usecs", "%"PRIu64, file->latency);
+
+        for (i = 0; i < RA_MAX_STREAMS; i++) {
+                stream = &file->streams[i];
+                if (!stream->stamp)
+                        continue;
+
+                sprintf (key, "stream[%d]", i);
+                gf_proc_dump_write (key, "next=%"PRId64" stride=%"PRId64
+                                    " reads=%u window=%u ra-end=%"PRId64
+                                    " interval-usecs=%"PRIu64, stream->next,
+                                    stream->stride, stream->seq,
+                                    stream->window, stream->ra_end,
+                                    stream->interval);
+        }
+
+        i = 0;
 
         for (page = file->pages.next; page != &file->pages;
              page = page->next) {
@@ -1079,9 +1278,27 @@ ra_priv_dump (xlator_t *this)
                 gf_proc_dump_write ("page_count", "%d", conf->page_count);
                 gf_proc_dump_write ("force_atime_update", "%d",
                                     conf->force_atime_update);
+                gf_proc_dump_write ("prefetch_limit", "%"PRIu64,
+                                    conf->prefetch_limit);
         }
         pthread_mutex_unlock (&conf->conf_lock);
 
+        gf_proc_dump_write ("cached_bytes", "%"PRId64,
+                            GF_ATOMIC_GET (conf->cached));
+        gf_proc_dump_write ("hits", "%"PRId64, GF_ATOMIC_GET (conf->hits));
+        gf_proc_dump_write ("late_hits", "%"PRId64,
+                            GF_ATOMIC_GET (conf->late));
+        gf_proc_dump_write ("misses", "%"PRId64, GF_ATOMIC_GET (conf->misses));
+        gf_proc_dump_write ("prefetched", "%"PRId64,
+                            GF_ATOMIC_GET (conf->prefetched));
+        gf_proc_dump_write ("wasted", "%"PRId64, GF_ATOMIC_GET (conf->wasted));
+        gf_proc_dump_write ("throttled", "%"PRId64,
+                            GF_ATOMIC_GET (conf->throttled));
+        gf_proc_dump_write ("sequential_streams", "%"PRId64,
+                            GF_ATOMIC_GET (conf->sequential));
+        gf_proc_dump_write ("strided_streams", "%"PRId64,
+                            GF_ATOMIC_GET (conf->strided));
+
         ret = 0;
 out:
         if (ret && conf) {
@@ -1132,6 +1349,9 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("page-size", conf->page_size, options, size_uint64,
                           out);
 
+        GF_OPTION_RECONF ("prefetch-limit", conf->prefetch_limit, options,
+                          size_uint64, out);
+
         ret = 0;
  out:
         return ret;
@@ -1172,6 +1392,19 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("force-atime-update", conf->force_atime_update, bool, out);
 
+        GF_OPTION_INIT ("prefetch-limit", conf->prefetch_limit, size_uint64,
+                        out);
+
+        GF_ATOMIC_INIT (conf->cached, 0);
+        GF_ATOMIC_INIT (conf->hits, 0);
+        GF_ATOMIC_INIT (conf->late, 0);
+        GF_ATOMIC_INIT (conf->misses, 0);
+        GF_ATOMIC_INIT (conf->prefetched, 0);
+        GF_ATOMIC_INIT (conf->wasted, 0);
+        GF_ATOMIC_INIT (conf->throttled, 0);
+        GF_ATOMIC_INIT (conf->sequential, 0);
+        GF_ATOMIC_INIT (conf->strided, 0);
+
         conf->files.next = &conf->files;
         conf->files.prev = &conf->files;
 
@@ -1262,9 +1495,21 @@ struct volume_options options[] = {
         { .key  = {"page-count"},
           .type = GF_OPTION_TYPE_INT,
           .min  = 1,
-          .max  = 16,
-          .default_value = "4",
-          .description = "Number of pages that will be pre-fetched"
+          .max  = RA_MAX_PAGE_COUNT,
+          .default_value = "16",
+          .description = "Maximum number of pages read ahead of each "
+                         "sequential or strided stream of reads.  The window "
+                         "of a stream grows up to this while its reads keep "
+                         "catching up with the pages being read ahead."
+        },
+        { .key  = {"prefetch-limit"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 1048576,
+          .max  = 16 * GF_UNIT_GB,
+          .default_value = "64MB",
+          .description = "Memory all the read ahead pages of the volume may "
+                         "take together.  Nothing more is read ahead while "
+                         "they are over it."
         },
 	{ .key = {"page-size"},
 	  .type = GF_OPTION_TYPE_SIZET,
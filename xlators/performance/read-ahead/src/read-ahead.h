@@ -17,8 +17,14 @@
 #include "dict.h"
 #include "xlator.h"
 #include "common-utils.h"
+#include "atomic.h"
 #include "read-ahead-mem-types.h"
 
+#define RA_MAX_STREAMS          8
+#define RA_MAX_PAGE_COUNT       256
+/* farthest apart two reads may start and still be taken for a stride */
+#define RA_MAX_STRIDE_PAGES     64
+
 struct ra_conf;
 struct ra_local;
 struct ra_page;
@@ -55,6 +61,9 @@ struct ra_local {
         fd_t             *fd;
         int32_t           wait_count;
         pthread_mutex_t   local_lock;
+        char              late;     /* waited on a page still being
+                                       read ahead */
+        struct timespec   wound;    /* when a page fault was sent */
 };
 
 
@@ -75,31 +84,60 @@ struct ra_page {
 };
 
 
+/* One sequence of reads which follow each other, either contiguously or a
+ * fixed @stride apart.  A file tracks several, so that interleaved readers
+ * on one fd, or readers on several fds of the inode, each get their own
+ * window. */
+struct ra_stream {
+        off_t              last;     /* start of the last read */
+        off_t              next;     /* end of the last read */
+        off_t              stride;   /* between read starts, 0 if
+                                        contiguous */
+        off_t              ra_end;   /* end of what was read ahead */
+        uint32_t           seq;      /* reads which kept to the pattern */
+        uint32_t           window;   /* pages read ahead of the stream */
+        uint64_t           interval; /* usecs between reads, averaged */
+        uint64_t           stamp;    /* usecs, last read; 0 if unused */
+};
+
+
+/* Shared by all the fds of an inode through the inode ctx, except for fds
+ * opened O_DIRECT or write-only, which get one of their own, disabled. */
 struct ra_file {
         struct ra_file    *next;
         struct ra_file    *prev;
         struct ra_conf    *conf;
-        fd_t              *fd;
         int                disabled;
-        size_t             expected;
         struct ra_page     pages;
-        off_t              offset;
-        size_t             size;
         int32_t            refcount;
         pthread_mutex_t    file_lock;
         struct iatt        stbuf;
         uint64_t           page_size;
-        uint32_t           page_count;
+        uint64_t           latency;  /* usecs a page fault takes,
+                                        averaged */
+        struct ra_stream   streams[RA_MAX_STREAMS];
 };
 
 
 struct ra_conf {
         uint64_t          page_size;
-        uint32_t          page_count;
+        uint32_t          page_count;   /* largest window, in pages */
+        uint64_t          prefetch_limit;
         void             *cache_block;
         struct ra_file    files;
         gf_boolean_t      force_atime_update;
         pthread_mutex_t   conf_lock;
+
+        gf_atomic_t       cached;       /* bytes in pages of all files */
+        gf_atomic_t       hits;         /* read ahead pages found ready */
+        gf_atomic_t       late;         /* ... found still in flight */
+        gf_atomic_t       misses;       /* pages faulted on demand */
+        gf_atomic_t       prefetched;   /* pages faulted ahead */
+        gf_atomic_t       wasted;       /* read ahead pages never read */
+        gf_atomic_t       throttled;    /* pages not read ahead for
+                                           prefetch-limit */
+        gf_atomic_t       sequential;   /* streams detected */
+        gf_atomic_t       strided;
 };
 
 
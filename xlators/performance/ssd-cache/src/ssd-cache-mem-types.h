@@ -0,0 +1,26 @@
+/*
+  Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef __SSD_CACHE_MEM_TYPES_H__
+#define __SSD_CACHE_MEM_TYPES_H__
+
+#include "mem-types.h"
+
+enum gf_sc_mem_types_ {
+        gf_sc_mt_sc_private_t = gf_common_mt_end + 1,
+        gf_sc_mt_sc_inode_t,
+        gf_sc_mt_sc_page_t,
+        gf_sc_mt_sc_admit_t,
+        gf_sc_mt_sc_scan_entry_t,
+        gf_sc_mt_list_head,
+        gf_sc_mt_uint64_t,
+        gf_sc_mt_end
+};
+#endif
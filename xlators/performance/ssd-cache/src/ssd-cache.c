@@ -0,0 +1,1692 @@
+/*
+  Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+/*
+ * ssd-cache: a second level read cache below the in-memory caches, kept in
+ * a directory on a local SSD.  It survives remounts, so clients which read
+ * the same large data sets over and over (render nodes, CI builders) read
+ * them from the local disk instead of the network after the first run.
+ *
+ * Reads are served from the page files when the file's mtime/ctime match
+ * the ones the page was written under.  The attributes are those returned
+ * by the last fop on the inode through this client and are refreshed with
+ * an fstat once they are older than cache-timeout, or right away after a
+ * cache invalidation upcall from the bricks.  On a miss the page aligned
+ * range is read from the child, the reply is sliced out of it and the
+ * pages are written to cache-dir in the background.
+ */
+
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include "ssd-cache.h"
+#include "defaults.h"
+#include "statedump.h"
+#include "syncop.h"
+#include "syscall.h"
+#include "iobuf.h"
+#include "upcall-utils.h"
+
+/* larger reads are passed through, they are not worth a page aligned copy */
+#define SC_MAX_READ_SIZE        (8 * GF_UNIT_MB)
+
+#define SC_STACK_UNWIND(fop, frame, params ...) do {            \
+                sc_local_t *__local = NULL;                     \
+                if (frame) {                                    \
+                        __local = frame->local;                 \
+                        frame->local = NULL;                    \
+                }                                               \
+                STACK_UNWIND_STRICT (fop, frame, params);       \
+                sc_local_wipe (__local);                        \
+        } while (0)
+
+struct sc_scan_entry {
+        uuid_t    gfid;
+        uint64_t  index;
+        uint64_t  size;
+        time_t    mtime;
+};
+typedef struct sc_scan_entry sc_scan_entry_t;
+
+struct sc_scan {
+        sc_scan_entry_t  *entries;
+        int               count;
+        int               alloc;
+};
+
+
+static void
+sc_local_wipe (sc_local_t *local)
+{
+        if (!local)
+                return;
+
+        if (local->fd)
+                fd_unref (local->fd);
+        if (local->xdata)
+                dict_unref (local->xdata);
+        if (local->iobref)
+                iobref_unref (local->iobref);
+
+        mem_put (local);
+}
+
+
+static uint64_t
+sc_key (uuid_t gfid, uint64_t index)
+{
+        uint64_t hash = 0;
+
+        /* the tail of a gfid is random enough to hash on */
+        memcpy (&hash, gfid + 8, sizeof (hash));
+
+        return hash ^ (index * 0x9e3779b97f4a7c15ULL);
+}
+
+
+static int
+sc_gfid_dir (sc_private_t *priv, uuid_t gfid, char *path, size_t len)
+{
+        return snprintf (path, len, "%s/%02x/%s", priv->cache_dir, gfid[0],
+                         uuid_utoa (gfid));
+}
+
+
+static int
+sc_page_path (sc_private_t *priv, uuid_t gfid, uint64_t index, char *path,
+              size_t len)
+{
+        return snprintf (path, len, "%s/%02x/%s/%"PRIu64, priv->cache_dir,
+                         gfid[0], uuid_utoa (gfid), index);
+}
+
+
+static gf_boolean_t
+sc_size_cacheable (sc_private_t *priv, uint64_t size)
+{
+        if (size < priv->min_file_size)
+                return _gf_false;
+
+        if (priv->max_file_size && size > priv->max_file_size)
+                return _gf_false;
+
+        return _gf_true;
+}
+
+
+/* index of the pages in cache-dir, for capacity management */
+
+static sc_page_t *
+__sc_page_find (sc_private_t *priv, uuid_t gfid, uint64_t index)
+{
+        struct list_head *bucket = NULL;
+        sc_page_t        *page   = NULL;
+
+        bucket = &priv->hash[sc_key (gfid, index) % SC_HASH_BUCKETS];
+
+        list_for_each_entry (page, bucket, hash) {
+                if (page->index == index && !gf_uuid_compare (page->gfid,
+                                                              gfid))
+                        return page;
+        }
+
+        return NULL;
+}
+
+
+static void
+__sc_page_remove (sc_private_t *priv, sc_page_t *page)
+{
+        list_del_init (&page->lru);
+        list_del_init (&page->hash);
+
+        priv->used -= page->size;
+        priv->pages--;
+
+        GF_FREE (page);
+}
+
+
+/* @recent pages go to the hot end of the lru, the ones found by the scan
+ * of cache-dir to the cold end */
+static int
+__sc_page_insert (sc_private_t *priv, uuid_t gfid, uint64_t index,
+                  uint64_t size, gf_boolean_t recent)
+{
+        sc_page_t *page = NULL;
+
+        page = __sc_page_find (priv, gfid, index);
+        if (page) {
+                priv->used = priv->used - page->size + size;
+                page->size = size;
+                if (recent)
+                        list_move_tail (&page->lru, &priv->lru);
+                return 0;
+        }
+
+        page = GF_CALLOC (1, sizeof (*page), gf_sc_mt_sc_page_t);
+        if (!page)
+                return -1;
+
+        INIT_LIST_HEAD (&page->lru);
+        INIT_LIST_HEAD (&page->hash);
+        gf_uuid_copy (page->gfid, gfid);
+        page->index = index;
+        page->size = size;
+
+        list_add (&page->hash,
+                  &priv->hash[sc_key (gfid, index) % SC_HASH_BUCKETS]);
+        if (recent)
+                list_add_tail (&page->lru, &priv->lru);
+        else
+                list_add (&page->lru, &priv->lru);
+
+        priv->used += size;
+        priv->pages++;
+
+        return 0;
+}
+
+
+/* moves pages off the cold end of the lru to @victims until the cache is
+ * back within cache-size, the files are unlinked without the lock held */
+static void
+__sc_evict (sc_private_t *priv, struct list_head *victims)
+{
+        sc_page_t *page = NULL;
+
+        while (priv->used > priv->cache_size && !list_empty (&priv->lru)) {
+                page = list_first_entry (&priv->lru, sc_page_t, lru);
+
+                list_move_tail (&page->lru, victims);
+                list_del_init (&page->hash);
+
+                priv->used -= page->size;
+                priv->pages--;
+        }
+}
+
+
+static void
+sc_evict_pages (xlator_t *this, struct list_head *victims)
+{
+        sc_private_t *priv = this->private;
+        sc_page_t    *page = NULL;
+        sc_page_t    *tmp  = NULL;
+        char          path[PATH_MAX] = {0,};
+
+        list_for_each_entry_safe (page, tmp, victims, lru) {
+                list_del_init (&page->lru);
+
+                sc_page_path (priv, page->gfid, page->index, path,
+                              sizeof (path));
+                sys_unlink (path);
+
+                /* fails while the file has other pages cached */
+                sc_gfid_dir (priv, page->gfid, path, sizeof (path));
+                sys_rmdir (path);
+
+                GF_ATOMIC_INC (priv->evicted);
+                GF_FREE (page);
+        }
+}
+
+
+static void
+sc_index_update (xlator_t *this, uuid_t gfid, uint64_t index, uint64_t size)
+{
+        sc_private_t     *priv    = this->private;
+        struct list_head  victims;
+
+        INIT_LIST_HEAD (&victims);
+
+        LOCK (&priv->lock);
+        {
+                __sc_page_insert (priv, gfid, index, size, _gf_true);
+                __sc_evict (priv, &victims);
+        }
+        UNLOCK (&priv->lock);
+
+        sc_evict_pages (this, &victims);
+}
+
+
+static void
+sc_index_remove (xlator_t *this, uuid_t gfid, uint64_t index)
+{
+        sc_private_t *priv = this->private;
+        sc_page_t    *page = NULL;
+
+        LOCK (&priv->lock);
+        {
+                page = __sc_page_find (priv, gfid, index);
+                if (page)
+                        __sc_page_remove (priv, page);
+        }
+        UNLOCK (&priv->lock);
+}
+
+
+static gf_boolean_t
+sc_index_has (xlator_t *this, uuid_t gfid, uint64_t index)
+{
+        sc_private_t *priv  = this->private;
+        gf_boolean_t  found = _gf_false;
+
+        LOCK (&priv->lock);
+        {
+                found = (__sc_page_find (priv, gfid, index) != NULL);
+        }
+        UNLOCK (&priv->lock);
+
+        return found;
+}
+
+
+/* re-read admits a page the second time it misses while its key is still
+ * in the table, so one pass over a large file does not wash out the
+ * pages which are read again and again */
+static gf_boolean_t
+sc_admit_page (sc_private_t *priv, uuid_t gfid, uint64_t index)
+{
+        uint64_t      key   = 0;
+        uint64_t     *slot  = NULL;
+        gf_boolean_t  admit = _gf_false;
+
+        if (priv->admit_policy == SC_ADMIT_ALL)
+                return _gf_true;
+
+        key = sc_key (gfid, index) | 1;
+
+        LOCK (&priv->lock);
+        {
+                slot = &priv->recent[key % SC_ADMIT_SLOTS];
+                if (*slot == key) {
+                        *slot = 0;
+                        admit = _gf_true;
+                } else {
+                        *slot = key;
+                }
+        }
+        UNLOCK (&priv->lock);
+
+        return admit;
+}
+
+
+/* inode ctx: the attributes the cached pages are validated against */
+
+static void
+sc_inode_set (xlator_t *this, inode_t *inode, struct iatt *stat)
+{
+        sc_inode_t *sc_inode = NULL;
+        uint64_t    value    = 0;
+
+        if (!inode || !stat || stat->ia_type != IA_IFREG)
+                return;
+
+        LOCK (&inode->lock);
+        {
+                __inode_ctx_get (inode, this, &value);
+                sc_inode = (sc_inode_t *)(long) value;
+                if (!sc_inode) {
+                        sc_inode = GF_CALLOC (1, sizeof (*sc_inode),
+                                              gf_sc_mt_sc_inode_t);
+                        if (!sc_inode)
+                                goto unlock;
+                        value = (uint64_t)(long) sc_inode;
+                        if (__inode_ctx_set (inode, this, &value)) {
+                                GF_FREE (sc_inode);
+                                goto unlock;
+                        }
+                }
+
+                /* a reply which raced with a later change must not take
+                 * the place of the attributes after that change */
+                if (sc_inode->valid &&
+                    (stat->ia_ctime < sc_inode->stat.ia_ctime ||
+                     (stat->ia_ctime == sc_inode->stat.ia_ctime &&
+                      stat->ia_ctime_nsec < sc_inode->stat.ia_ctime_nsec)))
+                        goto unlock;
+
+                sc_inode->stat = *stat;
+                sc_inode->refreshed = time (NULL);
+                sc_inode->valid = _gf_true;
+        }
+unlock:
+        UNLOCK (&inode->lock);
+}
+
+
+static void
+sc_inode_invalidate (xlator_t *this, inode_t *inode)
+{
+        sc_inode_t *sc_inode = NULL;
+        uint64_t    value    = 0;
+
+        if (!inode)
+                return;
+
+        LOCK (&inode->lock);
+        {
+                __inode_ctx_get (inode, this, &value);
+                sc_inode = (sc_inode_t *)(long) value;
+                if (sc_inode)
+                        sc_inode->valid = _gf_false;
+        }
+        UNLOCK (&inode->lock);
+}
+
+
+/* 0 and the attributes in @stat if they are recent enough to trust */
+static int
+sc_inode_get (xlator_t *this, inode_t *inode, struct iatt *stat)
+{
+        sc_private_t *priv     = this->private;
+        sc_inode_t   *sc_inode = NULL;
+        uint64_t      value    = 0;
+        int           ret      = -1;
+
+        LOCK (&inode->lock);
+        {
+                __inode_ctx_get (inode, this, &value);
+                sc_inode = (sc_inode_t *)(long) value;
+                if (sc_inode && sc_inode->valid &&
+                    time (NULL) - sc_inode->refreshed < priv->cache_timeout) {
+                        *stat = sc_inode->stat;
+                        ret = 0;
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        return ret;
+}
+
+
+/* page files */
+
+/* copies @size bytes at @start of the page into @buf, -1 when the page is
+ * not cached or was written under other attributes than @stat */
+static ssize_t
+sc_page_read (xlator_t *this, uuid_t gfid, uint64_t index, struct iatt *stat,
+              size_t start, size_t size, char *buf)
+{
+        sc_private_t       *priv   = this->private;
+        struct sc_page_hdr  hdr    = {0,};
+        char                path[PATH_MAX] = {0,};
+        uint64_t            length = 0;
+        ssize_t             ret    = -1;
+        int                 fd     = -1;
+
+        sc_page_path (priv, gfid, index, path, sizeof (path));
+
+        fd = sys_open (path, O_RDONLY, 0);
+        if (fd < 0) {
+                /* an eviction may have raced with writing it again */
+                sc_index_remove (this, gfid, index);
+                return -1;
+        }
+
+        length = min (SC_PAGE_SIZE, stat->ia_size - index * SC_PAGE_SIZE);
+
+        if (sys_pread (fd, &hdr, sizeof (hdr), 0) != sizeof (hdr) ||
+            hdr.magic != SC_PAGE_MAGIC || hdr.version != SC_PAGE_VERSION ||
+            hdr.mtime != stat->ia_mtime ||
+            hdr.mtime_nsec != stat->ia_mtime_nsec ||
+            hdr.ctime != stat->ia_ctime ||
+            hdr.ctime_nsec != stat->ia_ctime_nsec || hdr.length != length) {
+                sys_close (fd);
+                sys_unlink (path);
+                sc_index_remove (this, gfid, index);
+                GF_ATOMIC_INC (priv->stale);
+                return -1;
+        }
+
+        size = min (size, length - start);
+        ret = sys_pread (fd, buf, size, sizeof (hdr) + start);
+        sys_close (fd);
+        if (ret != size)
+                return -1;
+
+        /* also picks up the pages the scan has not got to yet */
+        sc_index_update (this, gfid, index, sizeof (hdr) + length);
+
+        return ret;
+}
+
+
+/* written to a temporary file and renamed into place, so a page file is
+ * always complete even when the client dies half way */
+static int
+sc_page_write (xlator_t *this, uuid_t gfid, uint64_t index, struct iatt *stat,
+               char *data, size_t size)
+{
+        sc_private_t       *priv = this->private;
+        struct sc_page_hdr  hdr  = {0,};
+        char                tmp[PATH_MAX]  = {0,};
+        char                path[PATH_MAX] = {0,};
+        int                 fd   = -1;
+        int                 ret  = -1;
+
+        hdr.magic = SC_PAGE_MAGIC;
+        hdr.version = SC_PAGE_VERSION;
+        hdr.mtime = stat->ia_mtime;
+        hdr.mtime_nsec = stat->ia_mtime_nsec;
+        hdr.ctime = stat->ia_ctime;
+        hdr.ctime_nsec = stat->ia_ctime_nsec;
+        hdr.length = size;
+
+        ret = snprintf (tmp, sizeof (tmp), "%s/"SC_TMP_PREFIX"%d-%"PRId64,
+                        priv->cache_dir, getpid (),
+                        GF_ATOMIC_INC (priv->tmp_seq));
+        if (ret < 0 || ret >= sizeof (tmp)) {
+                errno = ENAMETOOLONG;
+                goto out;
+        }
+
+        /* the directories created below are prefixes of this one */
+        ret = sc_page_path (priv, gfid, index, path, sizeof (path));
+        if (ret < 0 || ret >= sizeof (path)) {
+                errno = ENAMETOOLONG;
+                goto out;
+        }
+
+        fd = sys_open (tmp, O_CREAT | O_EXCL | O_WRONLY, 0600);
+        if (fd < 0)
+                goto out;
+
+        if (sys_pwrite (fd, &hdr, sizeof (hdr), 0) != sizeof (hdr) ||
+            sys_pwrite (fd, data, size, sizeof (hdr)) != size) {
+                sys_close (fd);
+                goto unlink;
+        }
+        sys_close (fd);
+
+        ret = sys_rename (tmp, path);
+        if (ret && errno == ENOENT) {
+                snprintf (path, sizeof (path), "%s/%02x", priv->cache_dir,
+                          gfid[0]);
+                sys_mkdir (path, 0700);
+                sc_gfid_dir (priv, gfid, path, sizeof (path));
+                sys_mkdir (path, 0700);
+
+                sc_page_path (priv, gfid, index, path, sizeof (path));
+                ret = sys_rename (tmp, path);
+        }
+        if (ret)
+                goto unlink;
+
+        sc_index_update (this, gfid, index, sizeof (hdr) + size);
+        GF_ATOMIC_INC (priv->admitted);
+
+        return 0;
+
+unlink:
+        sys_unlink (tmp);
+out:
+        if (GF_ATOMIC_INC (priv->write_errors) % GF_UNIVERSAL_ANSWER == 1)
+                gf_msg (this->name, GF_LOG_WARNING, errno,
+                        SSD_CACHE_MSG_PAGE_WRITE_FAILED,
+                        "could not cache page %"PRIu64" of %s in %s", index,
+                        uuid_utoa (gfid), priv->cache_dir);
+        return -1;
+}
+
+
+static int
+sc_admit_task (void *opaque)
+{
+        sc_admit_t *admit  = opaque;
+        xlator_t   *this   = admit->this;
+        uint64_t    index  = 0;
+        size_t      offset = 0;
+        size_t      size   = 0;
+
+        for (offset = 0; offset < admit->size; offset += SC_PAGE_SIZE) {
+                index = admit->first + offset / SC_PAGE_SIZE;
+                size = min (SC_PAGE_SIZE, admit->size - offset);
+
+                /* a short page is only whole at the end of the file */
+                if (size < SC_PAGE_SIZE &&
+                    index * SC_PAGE_SIZE + size != admit->stat.ia_size)
+                        break;
+
+                if (sc_index_has (this, admit->gfid, index))
+                        continue;
+
+                if (!sc_admit_page (this->private, admit->gfid, index))
+                        continue;
+
+                sc_page_write (this, admit->gfid, index, &admit->stat,
+                               admit->base + offset, size);
+        }
+
+        return 0;
+}
+
+
+static int
+sc_admit_done (int ret, call_frame_t *frame, void *opaque)
+{
+        sc_admit_t *admit = opaque;
+
+        iobref_unref (admit->iobref);
+        GF_FREE (admit);
+
+        return 0;
+}
+
+
+static void
+sc_admit (xlator_t *this, inode_t *inode, struct iatt *stat, off_t offset,
+          char *base, size_t size, struct iobref *iobref)
+{
+        sc_private_t *priv  = this->private;
+        sc_admit_t   *admit = NULL;
+
+        if (!size || !sc_size_cacheable (priv, stat->ia_size) ||
+            gf_uuid_is_null (inode->gfid))
+                return;
+
+        admit = GF_CALLOC (1, sizeof (*admit), gf_sc_mt_sc_admit_t);
+        if (!admit)
+                return;
+
+        admit->this = this;
+        gf_uuid_copy (admit->gfid, inode->gfid);
+        admit->stat = *stat;
+        admit->first = offset / SC_PAGE_SIZE;
+        admit->base = base;
+        admit->size = size;
+        admit->iobref = iobref_ref (iobref);
+
+        if (synctask_new (this->ctx->env, sc_admit_task, sc_admit_done, NULL,
+                          admit))
+                sc_admit_done (-1, NULL, admit);
+}
+
+
+/* fops */
+
+int32_t
+sc_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iovec *vector,
+              int32_t count, struct iatt *stbuf, struct iobref *iobref,
+              dict_t *xdata)
+{
+        sc_local_t    *local  = frame->local;
+        struct iobref *ref    = NULL;
+        struct iobuf  *iobuf  = NULL;
+        struct iovec   iov    = {0,};
+        char          *base   = NULL;
+        off_t          start  = 0;
+
+        if (op_ret < 0) {
+                sc_inode_invalidate (this, local->fd->inode);
+                goto unwind;
+        }
+
+        sc_inode_set (this, local->fd->inode, stbuf);
+
+        if (local->state != SC_READ_MISS || op_ret == 0)
+                goto unwind;
+
+        /* the pages are written out of one buffer */
+        if (count == 1) {
+                base = vector[0].iov_base;
+                ref = iobref_ref (iobref);
+        } else {
+                iobuf = iobuf_get2 (this->ctx->iobuf_pool, op_ret);
+                ref = iobref_new ();
+                if (!iobuf || !ref) {
+                        if (iobuf)
+                                iobuf_unref (iobuf);
+                        if (ref)
+                                iobref_unref (ref);
+                        op_ret = -1;
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+                iobref_add (ref, iobuf);
+                iobuf_unref (iobuf);
+                base = iobuf_ptr (iobuf);
+                iov_unload (base, vector, count);
+        }
+
+        sc_admit (this, local->fd->inode, stbuf, local->span_offset, base,
+                  op_ret, ref);
+
+        start = local->offset - local->span_offset;
+        iov.iov_base = base + start;
+        iov.iov_len = (op_ret > start) ? min (local->size, op_ret - start) : 0;
+
+        SC_STACK_UNWIND (readv, frame, iov.iov_len, 0, &iov, 1, stbuf, ref,
+                         xdata);
+        iobref_unref (ref);
+        return 0;
+
+unwind:
+        SC_STACK_UNWIND (readv, frame, op_ret, op_errno, vector, count, stbuf,
+                         iobref, xdata);
+        return 0;
+}
+
+
+static int
+sc_read_task (void *opaque)
+{
+        sc_local_t    *local  = opaque;
+        xlator_t      *this   = THIS;
+        sc_private_t  *priv   = this->private;
+        inode_t       *inode  = local->fd->inode;
+        struct iatt   *stat   = &local->stat;
+        struct iobuf  *iobuf  = NULL;
+        char          *buf    = NULL;
+        uint64_t       index  = 0;
+        off_t          end    = 0;
+        off_t          pos    = 0;
+        size_t         want   = 0;
+        int            ret    = 0;
+
+        local->state = SC_READ_BYPASS;
+
+        if (sc_inode_get (this, inode, stat)) {
+                ret = syncop_fstat (FIRST_CHILD (this), local->fd, stat,
+                                    NULL, NULL);
+                if (ret)
+                        return 0;
+                sc_inode_set (this, inode, stat);
+        }
+
+        if (!sc_size_cacheable (priv, stat->ia_size) ||
+            local->offset >= stat->ia_size || gf_uuid_is_null (inode->gfid)) {
+                GF_ATOMIC_INC (priv->bypassed);
+                return 0;
+        }
+
+        end = min (local->offset + local->size, stat->ia_size);
+        local->span_offset = (local->offset / SC_PAGE_SIZE) * SC_PAGE_SIZE;
+        local->span_size = roof (end, SC_PAGE_SIZE) - local->span_offset;
+        local->state = SC_READ_MISS;
+
+        iobuf = iobuf_get2 (this->ctx->iobuf_pool, end - local->offset);
+        if (!iobuf)
+                goto miss;
+        buf = iobuf_ptr (iobuf);
+
+        for (pos = local->offset; pos < end; pos += want) {
+                index = pos / SC_PAGE_SIZE;
+                want = min (end - pos, (index + 1) * SC_PAGE_SIZE - pos);
+
+                if (sc_page_read (this, inode->gfid, index, stat,
+                                  pos - index * SC_PAGE_SIZE, want,
+                                  buf + (pos - local->offset)) != want)
+                        goto miss;
+        }
+
+        local->iobref = iobref_new ();
+        if (!local->iobref)
+                goto miss;
+        iobref_add (local->iobref, iobuf);
+        iobuf_unref (iobuf);
+
+        local->vector.iov_base = buf;
+        local->vector.iov_len = end - local->offset;
+        local->op_ret = end - local->offset;
+        local->state = SC_READ_HIT;
+        GF_ATOMIC_INC (priv->hits);
+
+        return 0;
+
+miss:
+        if (iobuf)
+                iobuf_unref (iobuf);
+        GF_ATOMIC_INC (priv->misses);
+
+        return 0;
+}
+
+
+static int
+sc_read_done (int ret, call_frame_t *frame, void *opaque)
+{
+        sc_local_t *local = opaque;
+        xlator_t   *this  = frame->this;
+
+        if (ret)
+                local->state = SC_READ_BYPASS;
+
+        switch (local->state) {
+        case SC_READ_HIT:
+                SC_STACK_UNWIND (readv, frame, local->op_ret, 0,
+                                 &local->vector, 1, &local->stat,
+                                 local->iobref, NULL);
+                break;
+        case SC_READ_MISS:
+                STACK_WIND (frame, sc_readv_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->readv, local->fd,
+                            local->span_size, local->span_offset,
+                            local->flags, local->xdata);
+                break;
+        default:
+                STACK_WIND (frame, sc_readv_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->readv, local->fd,
+                            local->size, local->offset, local->flags,
+                            local->xdata);
+                break;
+        }
+
+        return 0;
+}
+
+
+int32_t
+sc_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+          off_t offset, uint32_t flags, dict_t *xdata)
+{
+        sc_private_t *priv  = this->private;
+        sc_local_t   *local = NULL;
+
+        if (!priv->cache_dir || !this->ctx->env || !size ||
+            size > SC_MAX_READ_SIZE ||
+            fd->inode->ia_type != IA_IFREG || (fd->flags & O_DIRECT))
+                goto wind;
+
+        local = mem_get0 (this->local_pool);
+        if (!local)
+                goto wind;
+
+        local->fd = fd_ref (fd);
+        local->size = size;
+        local->offset = offset;
+        local->flags = flags;
+        if (xdata)
+                local->xdata = dict_ref (xdata);
+
+        frame->local = local;
+
+        if (synctask_new (this->ctx->env, sc_read_task, sc_read_done, frame,
+                          local)) {
+                frame->local = NULL;
+                sc_local_wipe (local);
+                goto wind;
+        }
+
+        return 0;
+
+wind:
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->readv, fd, size, offset,
+                         flags, xdata);
+        return 0;
+}
+
+
+/* the fops below keep the attributes of the inode current, so most reads
+ * after them are validated without an fstat */
+
+int32_t
+sc_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, inode_t *inode,
+               struct iatt *buf, dict_t *xdata, struct iatt *postparent)
+{
+        if (op_ret == 0)
+                sc_inode_set (this, inode, buf);
+
+        STACK_UNWIND_STRICT (lookup, frame, op_ret, op_errno, inode, buf,
+                             xdata, postparent);
+        return 0;
+}
+
+
+int32_t
+sc_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+        STACK_WIND (frame, sc_lookup_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->lookup, loc, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, struct iatt *buf, dict_t *xdata)
+{
+        if (op_ret == 0)
+                sc_inode_set (this, cookie, buf);
+
+        STACK_UNWIND_STRICT (stat, frame, op_ret, op_errno, buf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_stat (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_stat_cbk, loc->inode, FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->stat, loc, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *buf,
+              dict_t *xdata)
+{
+        if (op_ret == 0)
+                sc_inode_set (this, cookie, buf);
+
+        STACK_UNWIND_STRICT (fstat, frame, op_ret, op_errno, buf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_fstat (call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_fstat_cbk, fd->inode, FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->fstat, fd, xdata);
+        return 0;
+}
+
+
+static void
+sc_inode_modified (xlator_t *this, inode_t *inode, int32_t op_ret,
+                   struct iatt *postbuf)
+{
+        if (op_ret >= 0)
+                sc_inode_set (this, inode, postbuf);
+        else
+                sc_inode_invalidate (this, inode);
+}
+
+
+int32_t
+sc_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+               struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (writev, frame, op_ret, op_errno, prebuf, postbuf,
+                             xdata);
+        return 0;
+}
+
+
+int32_t
+sc_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
+           int32_t count, off_t offset, uint32_t flags, struct iobref *iobref,
+           dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_writev_cbk, fd->inode, FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->writev, fd, vector, count,
+                           offset, flags, iobref, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (truncate, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
+             dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_truncate_cbk, loc->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->truncate, loc, offset,
+                           xdata);
+        return 0;
+}
+
+
+int32_t
+sc_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (ftruncate, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_ftruncate_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->ftruncate, fd, offset,
+                           xdata);
+        return 0;
+}
+
+
+int32_t
+sc_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (setattr, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_setattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+            struct iatt *stbuf, int32_t valid, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_setattr_cbk, loc->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->setattr, loc, stbuf,
+                           valid, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (fsetattr, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             struct iatt *stbuf, int32_t valid, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_fsetattr_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->fsetattr, fd, stbuf,
+                           valid, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t keep_size,
+              off_t offset, size_t len, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_fallocate_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->fallocate, fd, keep_size,
+                           offset, len, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_discard_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->discard, fd, offset, len,
+                           xdata);
+        return 0;
+}
+
+
+int32_t
+sc_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+        sc_inode_modified (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+        return 0;
+}
+
+
+int32_t
+sc_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             off_t len, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, sc_zerofill_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->zerofill, fd, offset, len,
+                           xdata);
+        return 0;
+}
+
+
+int32_t
+sc_forget (xlator_t *this, inode_t *inode)
+{
+        uint64_t value = 0;
+
+        inode_ctx_del (inode, this, &value);
+        GF_FREE ((sc_inode_t *)(long) value);
+
+        return 0;
+}
+
+
+static void
+sc_invalidate (xlator_t *this, void *data)
+{
+        sc_private_t                        *priv    = this->private;
+        struct gf_upcall                    *up_data = data;
+        struct gf_upcall_cache_invalidation *up_ci   = NULL;
+        inode_table_t                       *itable  = NULL;
+        inode_t                             *inode   = NULL;
+
+        if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+                return;
+
+        up_ci = up_data->data;
+        if (!(up_ci->flags & (UP_WRITE_FLAGS | UP_NLINK | UP_RENAME_FLAGS |
+                              UP_FORGET | UP_INVAL_ATTR | UP_EXPLICIT_LOOKUP)))
+                return;
+
+        if (!this->graph || !this->graph->top)
+                return;
+
+        itable = ((xlator_t *)this->graph->top)->itable;
+        inode = inode_find (itable, up_data->gfid);
+        if (!inode)
+                return;
+
+        sc_inode_invalidate (this, inode);
+        GF_ATOMIC_INC (priv->invalidations);
+
+        inode_unref (inode);
+}
+
+
+int32_t
+notify (xlator_t *this, int32_t event, void *data, ...)
+{
+        if (event == GF_EVENT_UPCALL)
+                sc_invalidate (this, data);
+
+        return default_notify (this, event, data);
+}
+
+
+/* scan of the pages a previous mount left in cache-dir */
+
+static int
+sc_scan_add (struct sc_scan *scan, uuid_t gfid, uint64_t index,
+             struct stat *st)
+{
+        sc_scan_entry_t *entries = NULL;
+        int              alloc   = 0;
+
+        if (scan->count == scan->alloc) {
+                alloc = scan->alloc ? scan->alloc * 2 : 1024;
+                entries = GF_REALLOC (scan->entries,
+                                      alloc * sizeof (*entries));
+                if (!entries)
+                        return -1;
+                scan->entries = entries;
+                scan->alloc = alloc;
+        }
+
+        gf_uuid_copy (scan->entries[scan->count].gfid, gfid);
+        scan->entries[scan->count].index = index;
+        scan->entries[scan->count].size = st->st_size;
+        scan->entries[scan->count].mtime = st->st_mtime;
+        scan->count++;
+
+        return 0;
+}
+
+
+static int
+sc_scan_gfid (xlator_t *this, char *dirpath, uuid_t gfid,
+              struct sc_scan *scan)
+{
+        sc_private_t   *priv  = this->private;
+        DIR            *dir   = NULL;
+        struct dirent  *entry = NULL;
+        struct dirent   scratch[2] = {{0,},};
+        struct stat     st    = {0,};
+        char            path[PATH_MAX] = {0,};
+        uint64_t        index = 0;
+        int             ret   = 0;
+
+        dir = sys_opendir (dirpath);
+        if (!dir)
+                return 0;
+
+        while (!priv->stop && (entry = sys_readdir (dir, scratch))) {
+                if (gf_string2uint64 (entry->d_name, &index))
+                        continue;
+
+                snprintf (path, sizeof (path), "%s/%s", dirpath,
+                          entry->d_name);
+                if (sys_stat (path, &st) || !S_ISREG (st.st_mode))
+                        continue;
+
+                ret = sc_scan_add (scan, gfid, index, &st);
+                if (ret)
+                        break;
+        }
+
+        sys_closedir (dir);
+
+        return ret;
+}
+
+
+static int
+sc_scan_dir (xlator_t *this, struct sc_scan *scan)
+{
+        sc_private_t   *priv  = this->private;
+        DIR            *top   = NULL;
+        DIR            *dir   = NULL;
+        struct dirent  *entry = NULL;
+        struct dirent  *sub   = NULL;
+        struct dirent   scratch[2]     = {{0,},};
+        struct dirent   sub_scratch[2] = {{0,},};
+        char            path[PATH_MAX] = {0,};
+        char            gfid_path[PATH_MAX] = {0,};
+        uuid_t          gfid  = {0,};
+        int             ret   = 0;
+
+        top = sys_opendir (priv->cache_dir);
+        if (!top)
+                return -1;
+
+        while (!ret && !priv->stop && (entry = sys_readdir (top, scratch))) {
+                snprintf (path, sizeof (path), "%s/%s", priv->cache_dir,
+                          entry->d_name);
+
+                /* left over by a client which died while writing a page */
+                if (!strncmp (entry->d_name, SC_TMP_PREFIX,
+                              strlen (SC_TMP_PREFIX))) {
+                        sys_unlink (path);
+                        continue;
+                }
+
+                if (strlen (entry->d_name) != 2)
+                        continue;
+
+                dir = sys_opendir (path);
+                if (!dir)
+                        continue;
+
+                while (!ret && !priv->stop &&
+                       (sub = sys_readdir (dir, sub_scratch))) {
+                        if (gf_uuid_parse (sub->d_name, gfid))
+                                continue;
+
+                        snprintf (gfid_path, sizeof (gfid_path), "%s/%s",
+                                  path, sub->d_name);
+                        ret = sc_scan_gfid (this, gfid_path, gfid, scan);
+                }
+
+                sys_closedir (dir);
+        }
+
+        sys_closedir (top);
+
+        return ret;
+}
+
+
+static int
+sc_scan_cmp (const void *a, const void *b)
+{
+        const sc_scan_entry_t *x = a;
+        const sc_scan_entry_t *y = b;
+
+        if (x->mtime != y->mtime)
+                return (x->mtime < y->mtime) ? -1 : 1;
+        return 0;
+}
+
+
+static void *
+sc_scan (void *data)
+{
+        xlator_t         *this = data;
+        sc_private_t     *priv = this->private;
+        struct sc_scan    scan = {0,};
+        struct list_head  victims;
+        int               ret  = 0;
+        int               i    = 0;
+
+        THIS = this;
+        INIT_LIST_HEAD (&victims);
+
+        ret = sc_scan_dir (this, &scan);
+        if (ret)
+                gf_msg (this->name, GF_LOG_WARNING, errno,
+                        SSD_CACHE_MSG_SCAN_FAILED,
+                        "could not index all pages in %s", priv->cache_dir);
+
+        /* the most recently written pages end up at the hot end, pages
+         * read in the meantime are already there and stay hotter */
+        qsort (scan.entries, scan.count, sizeof (*scan.entries), sc_scan_cmp);
+
+        LOCK (&priv->lock);
+        {
+                for (i = scan.count - 1; i >= 0; i--)
+                        if (__sc_page_insert (priv, scan.entries[i].gfid,
+                                              scan.entries[i].index,
+                                              scan.entries[i].size,
+                                              _gf_false))
+                                break;
+                __sc_evict (priv, &victims);
+                priv->scanning = _gf_false;
+        }
+        UNLOCK (&priv->lock);
+
+        sc_evict_pages (this, &victims);
+
+        gf_msg_debug (this->name, 0, "indexed %d pages in %s", scan.count,
+                      priv->cache_dir);
+
+        GF_FREE (scan.entries);
+
+        return NULL;
+}
+
+
+/* statedump and setup */
+
+int
+sc_priv_dump (xlator_t *this)
+{
+        sc_private_t *priv = NULL;
+        char          key_prefix[GF_DUMP_MAX_BUF_LEN] = {0,};
+        int           ret  = -1;
+
+        if (!this || !this->private)
+                return 0;
+
+        priv = this->private;
+
+        gf_proc_dump_build_key (key_prefix, "performance.ssd-cache", "priv");
+        gf_proc_dump_add_section (key_prefix);
+
+        gf_proc_dump_write ("cache_dir", "%s",
+                            priv->cache_dir ? priv->cache_dir : "(none)");
+        gf_proc_dump_write ("cache_size", "%"PRIu64, priv->cache_size);
+        gf_proc_dump_write ("cache_timeout", "%d", priv->cache_timeout);
+        gf_proc_dump_write ("admit_policy", "%s",
+                            (priv->admit_policy == SC_ADMIT_REREAD) ?
+                            "re-read" : "all");
+        gf_proc_dump_write ("min_file_size", "%"PRIu64, priv->min_file_size);
+        gf_proc_dump_write ("max_file_size", "%"PRIu64, priv->max_file_size);
+
+        ret = TRY_LOCK (&priv->lock);
+        if (!ret) {
+                gf_proc_dump_write ("cache_used", "%"PRIu64, priv->used);
+                gf_proc_dump_write ("pages", "%"PRIu64, priv->pages);
+                gf_proc_dump_write ("scanning", "%d", priv->scanning);
+                UNLOCK (&priv->lock);
+        }
+
+        gf_proc_dump_write ("hits", "%"PRId64, GF_ATOMIC_GET (priv->hits));
+        gf_proc_dump_write ("misses", "%"PRId64,
+                            GF_ATOMIC_GET (priv->misses));
+        gf_proc_dump_write ("bypassed", "%"PRId64,
+                            GF_ATOMIC_GET (priv->bypassed));
+        gf_proc_dump_write ("admitted", "%"PRId64,
+                            GF_ATOMIC_GET (priv->admitted));
+        gf_proc_dump_write ("evicted", "%"PRId64,
+                            GF_ATOMIC_GET (priv->evicted));
+        gf_proc_dump_write ("stale", "%"PRId64, GF_ATOMIC_GET (priv->stale));
+        gf_proc_dump_write ("invalidations", "%"PRId64,
+                            GF_ATOMIC_GET (priv->invalidations));
+        gf_proc_dump_write ("write_errors", "%"PRId64,
+                            GF_ATOMIC_GET (priv->write_errors));
+
+        return 0;
+}
+
+
+int32_t
+mem_acct_init (xlator_t *this)
+{
+        int ret = -1;
+
+        ret = xlator_mem_acct_init (this, gf_sc_mt_end + 1);
+
+        if (ret)
+                gf_msg (this->name, GF_LOG_ERROR, ENOMEM,
+                        SSD_CACHE_MSG_NO_MEMORY,
+                        "Memory accounting init failed");
+
+        return ret;
+}
+
+
+static sc_admit_policy_t
+sc_admit_policy (char *str)
+{
+        if (str && !strcmp (str, "re-read"))
+                return SC_ADMIT_REREAD;
+
+        return SC_ADMIT_ALL;
+}
+
+
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        sc_private_t     *priv   = this->private;
+        char             *policy = NULL;
+        uint64_t          size   = 0;
+        struct list_head  victims;
+        int               ret    = -1;
+
+        INIT_LIST_HEAD (&victims);
+
+        GF_OPTION_RECONF ("cache-timeout", priv->cache_timeout, options,
+                          int32, out);
+        GF_OPTION_RECONF ("min-file-size", priv->min_file_size, options,
+                          size_uint64, out);
+        GF_OPTION_RECONF ("max-file-size", priv->max_file_size, options,
+                          size_uint64, out);
+
+        GF_OPTION_RECONF ("admit-policy", policy, options, str, out);
+        priv->admit_policy = sc_admit_policy (policy);
+
+        GF_OPTION_RECONF ("cache-size", size, options, size_uint64, out);
+
+        LOCK (&priv->lock);
+        {
+                priv->cache_size = size;
+                __sc_evict (priv, &victims);
+        }
+        UNLOCK (&priv->lock);
+
+        sc_evict_pages (this, &victims);
+
+        ret = 0;
+out:
+        return ret;
+}
+
+
+int
+init (xlator_t *this)
+{
+        sc_private_t *priv   = NULL;
+        char         *policy = NULL;
+        int           i      = 0;
+
+        if (!this->children || this->children->next) {
+                gf_msg (this->name, GF_LOG_ERROR, 0,
+                        SSD_CACHE_MSG_XLATOR_CHILD_MISCONFIGURED,
+                        "FATAL: ssd-cache not configured with exactly one "
+                        "child");
+                return -1;
+        }
+
+        if (!this->parents)
+                gf_msg (this->name, GF_LOG_WARNING, 0,
+                        SSD_CACHE_MSG_VOL_MISCONFIGURED,
+                        "dangling volume. check volfile ");
+
+        priv = GF_CALLOC (1, sizeof (*priv), gf_sc_mt_sc_private_t);
+        if (!priv)
+                goto err;
+
+        LOCK_INIT (&priv->lock);
+        INIT_LIST_HEAD (&priv->lru);
+        GF_ATOMIC_INIT (priv->tmp_seq, 0);
+        GF_ATOMIC_INIT (priv->hits, 0);
+        GF_ATOMIC_INIT (priv->misses, 0);
+        GF_ATOMIC_INIT (priv->bypassed, 0);
+        GF_ATOMIC_INIT (priv->admitted, 0);
+        GF_ATOMIC_INIT (priv->evicted, 0);
+        GF_ATOMIC_INIT (priv->stale, 0);
+        GF_ATOMIC_INIT (priv->invalidations, 0);
+        GF_ATOMIC_INIT (priv->write_errors, 0);
+
+        GF_OPTION_INIT ("cache-dir", priv->cache_dir, path, err);
+        GF_OPTION_INIT ("cache-size", priv->cache_size, size_uint64, err);
+        GF_OPTION_INIT ("cache-timeout", priv->cache_timeout, int32, err);
+        GF_OPTION_INIT ("min-file-size", priv->min_file_size, size_uint64,
+                        err);
+        GF_OPTION_INIT ("max-file-size", priv->max_file_size, size_uint64,
+                        err);
+        GF_OPTION_INIT ("admit-policy", policy, str, err);
+        priv->admit_policy = sc_admit_policy (policy);
+
+        priv->hash = GF_CALLOC (SC_HASH_BUCKETS, sizeof (*priv->hash),
+                                gf_sc_mt_list_head);
+        priv->recent = GF_CALLOC (SC_ADMIT_SLOTS, sizeof (*priv->recent),
+                                  gf_sc_mt_uint64_t);
+        if (!priv->hash || !priv->recent)
+                goto err;
+
+        for (i = 0; i < SC_HASH_BUCKETS; i++)
+                INIT_LIST_HEAD (&priv->hash[i]);
+
+        this->local_pool = mem_pool_new (sc_local_t, 64);
+        if (!this->local_pool) {
+                gf_msg (this->name, GF_LOG_ERROR, ENOMEM,
+                        SSD_CACHE_MSG_NO_MEMORY,
+                        "failed to create local_t's memory pool");
+                goto err;
+        }
+
+        this->private = priv;
+
+        if (!priv->cache_dir) {
+                gf_msg (this->name, GF_LOG_WARNING, 0,
+                        SSD_CACHE_MSG_NO_CACHE_DIR,
+                        "cache-dir not set, reads will not be cached");
+                return 0;
+        }
+
+        priv->cache_dir = gf_strdup (priv->cache_dir);
+        if (!priv->cache_dir)
+                goto err;
+
+        /* a cache which cannot be used must not keep the volume from
+         * being mounted */
+        if (mkdir_p (priv->cache_dir, 0700, _gf_true)) {
+                gf_msg (this->name, GF_LOG_ERROR, errno,
+                        SSD_CACHE_MSG_CACHE_DIR_FAILED,
+                        "cannot use %s, reads will not be cached",
+                        priv->cache_dir);
+                GF_FREE (priv->cache_dir);
+                priv->cache_dir = NULL;
+                return 0;
+        }
+
+        priv->scanning = _gf_true;
+        if (gf_thread_create (&priv->scanner, NULL, sc_scan, this)) {
+                gf_msg (this->name, GF_LOG_WARNING, errno,
+                        SSD_CACHE_MSG_SCAN_FAILED,
+                        "cannot start indexing %s, pages from earlier "
+                        "mounts are indexed as they are read",
+                        priv->cache_dir);
+                priv->scanning = _gf_false;
+        } else {
+                priv->scanner_running = _gf_true;
+        }
+
+        return 0;
+
+err:
+        this->private = NULL;
+        if (this->local_pool) {
+                mem_pool_destroy (this->local_pool);
+                this->local_pool = NULL;
+        }
+        if (priv) {
+                GF_FREE (priv->hash);
+                GF_FREE (priv->recent);
+                GF_FREE (priv);
+        }
+
+        return -1;
+}
+
+
+void
+fini (xlator_t *this)
+{
+        sc_private_t *priv = this->private;
+        sc_page_t    *page = NULL;
+        sc_page_t    *tmp  = NULL;
+
+        if (!priv)
+                return;
+
+        this->private = NULL;
+
+        priv->stop = _gf_true;
+        if (priv->scanner_running)
+                pthread_join (priv->scanner, NULL);
+
+        /* the pages stay on disk for the next mount */
+        list_for_each_entry_safe (page, tmp, &priv->lru, lru)
+                __sc_page_remove (priv, page);
+
+        if (this->local_pool) {
+                mem_pool_destroy (this->local_pool);
+                this->local_pool = NULL;
+        }
+
+        LOCK_DESTROY (&priv->lock);
+        GF_FREE (priv->cache_dir);
+        GF_FREE (priv->hash);
+        GF_FREE (priv->recent);
+        GF_FREE (priv);
+
+        return;
+}
+
+
+struct xlator_fops fops = {
+        .lookup      = sc_lookup,
+        .stat        = sc_stat,
+        .fstat       = sc_fstat,
+        .readv       = sc_readv,
+        .writev      = sc_writev,
+        .truncate    = sc_truncate,
+        .ftruncate   = sc_ftruncate,
+        .setattr     = sc_setattr,
+        .fsetattr    = sc_fsetattr,
+        .fallocate   = sc_fallocate,
+        .discard     = sc_discard,
+        .zerofill    = sc_zerofill,
+};
+
+
+struct xlator_cbks cbks = {
+        .forget      = sc_forget,
+};
+
+
+struct xlator_dumpops dumpops = {
+        .priv        = sc_priv_dump,
+};
+
+
+struct volume_options options[] = {
+        { .key  = {"cache-dir"},
+          .type = GF_OPTION_TYPE_PATH,
+          .description = "Directory on a local SSD to keep the cached pages "
+          "in. Pages found there at mount time are served as long as the "
+          "files are unchanged. Without it reads are not cached. Changes take "
+          "effect on the next mount."
+        },
+        { .key  = {"cache-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 64 * GF_UNIT_MB,
+          .max  = 16 * GF_UNIT_TB,
+          .default_value = "10GB",
+          .description = "Space the cached pages may take in cache-dir. "
+          "The least recently read pages are removed beyond it."
+        },
+        { .key  = {"cache-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60,
+          .default_value = "1",
+          .description = "Seconds the attributes the cached pages are checked "
+          "against are trusted before they are fetched again. Cache "
+          "invalidation from the bricks, when enabled, makes them be fetched "
+          "again right away."
+        },
+        { .key  = {"admit-policy"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = {"all", "re-read"},
+          .default_value = "all",
+          .description = "Pages read from the network which are written to "
+          "cache-dir: \"all\" of them, or only those read again soon after "
+          "(\"re-read\"), which keeps one-off scans from pushing out the "
+          "pages read over and over."
+        },
+        { .key  = {"min-file-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Minimum size of the files whose pages are cached."
+        },
+        { .key  = {"max-file-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Maximum size of the files whose pages are cached, "
+          "0 for no limit."
+        },
+        { .key = {NULL} },
+};
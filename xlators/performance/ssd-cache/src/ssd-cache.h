@@ -0,0 +1,142 @@
+/*
+  Copyright (c) 2017 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef __SSD_CACHE_H__
+#define __SSD_CACHE_H__
+
+#include "glusterfs.h"
+#include "logging.h"
+#include "dict.h"
+#include "xlator.h"
+#include "common-utils.h"
+#include "list.h"
+#include "locking.h"
+#include "atomic.h"
+#include "iatt.h"
+#include "ssd-cache-mem-types.h"
+#include "ssd-cache-messages.h"
+
+/* Pages are kept one per file under cache-dir, as
+ *
+ *     <cache-dir>/<first byte of gfid>/<gfid>/<page index>
+ *
+ * each starting with a struct sc_page_hdr.  The header carries the
+ * mtime/ctime the data was read under, so a page left behind by an
+ * earlier mount (or by this one before the file changed) is only served
+ * while the file is unchanged.
+ */
+#define SC_PAGE_SIZE            (128 * GF_UNIT_KB)
+#define SC_PAGE_MAGIC           0x53534443      /* "SSDC" */
+#define SC_PAGE_VERSION         1
+#define SC_HASH_BUCKETS         32768
+#define SC_ADMIT_SLOTS          65536
+#define SC_TMP_PREFIX           ".tmp-"
+
+typedef enum {
+        SC_ADMIT_ALL,           /* every page read from the network */
+        SC_ADMIT_REREAD,        /* pages missed twice in a short while */
+} sc_admit_policy_t;
+
+struct sc_page_hdr {
+        uint32_t  magic;
+        uint32_t  version;
+        uint64_t  mtime;
+        uint64_t  ctime;
+        uint32_t  mtime_nsec;
+        uint32_t  ctime_nsec;
+        uint32_t  length;       /* bytes of data following the header */
+        uint32_t  reserved;
+};
+
+/* in-memory index entry of a page file, on priv->lru in use order */
+struct sc_page {
+        struct list_head  lru;
+        struct list_head  hash;
+        uuid_t            gfid;
+        uint64_t          index;
+        uint64_t          size;         /* on disk, header included */
+};
+typedef struct sc_page sc_page_t;
+
+struct sc_inode {
+        struct iatt       stat;         /* last known attributes */
+        time_t            refreshed;    /* when @stat was last refreshed */
+        gf_boolean_t      valid;
+};
+typedef struct sc_inode sc_inode_t;
+
+typedef enum {
+        SC_READ_BYPASS,
+        SC_READ_HIT,
+        SC_READ_MISS,
+} sc_read_state_t;
+
+struct sc_local {
+        fd_t             *fd;
+        size_t            size;
+        off_t             offset;
+        uint32_t          flags;
+        dict_t           *xdata;
+        sc_read_state_t   state;
+        struct iatt       stat;
+        struct iovec      vector;
+        struct iobref    *iobref;
+        int32_t           op_ret;
+        int32_t           op_errno;
+        off_t             span_offset;  /* page aligned read on a miss */
+        size_t            span_size;
+};
+typedef struct sc_local sc_local_t;
+
+/* pages read from the network, written to cache-dir in the background */
+struct sc_admit {
+        xlator_t         *this;
+        uuid_t            gfid;
+        struct iatt       stat;
+        uint64_t          first;
+        char             *base;
+        size_t            size;
+        struct iobref    *iobref;
+};
+typedef struct sc_admit sc_admit_t;
+
+struct sc_private {
+        char               *cache_dir;
+        uint64_t            cache_size;
+        int32_t             cache_timeout;
+        sc_admit_policy_t   admit_policy;
+        uint64_t            min_file_size;
+        uint64_t            max_file_size;
+
+        gf_lock_t           lock;
+        struct list_head    lru;
+        struct list_head   *hash;
+        uint64_t           *recent;     /* keys missed once, for re-read */
+        uint64_t            used;
+        uint64_t            pages;
+
+        pthread_t           scanner;
+        gf_boolean_t        scanner_running;
+        gf_boolean_t        scanning;
+        gf_boolean_t        stop;
+
+        gf_atomic_t         tmp_seq;
+        gf_atomic_t         hits;
+        gf_atomic_t         misses;
+        gf_atomic_t         bypassed;
+        gf_atomic_t         admitted;
+        gf_atomic_t         evicted;
+        gf_atomic_t         stale;
+        gf_atomic_t         invalidations;
+        gf_atomic_t         write_errors;
+};
+typedef struct sc_private sc_private_t;
+
+#endif /* __SSD_CACHE_H__ */
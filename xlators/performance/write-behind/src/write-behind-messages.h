@@ -40,7 +40,7 @@
  */
 
 #define GLFS_WRITE_BEHIND_BASE                   GLFS_MSGID_COMP_WRITE_BEHIND
-#define GLFS_WRITE_BEHIND_NUM_MESSAGES           7
+#define GLFS_WRITE_BEHIND_NUM_MESSAGES           8
 #define GLFS_MSGID_END  (GLFS_WRITE_BEHIND_BASE +\
         GLFS_WRITE_BEHIND_NUM_MESSAGES + 1)
 
@@ -113,6 +113,17 @@
 
 #define WRITE_BEHIND_MSG_RES_UNAVAILABLE        (GLFS_WRITE_BEHIND_BASE + 7)
 
+/*!
+ * @messageid
+ * @diagnosis The thread writing back aged cached writes could not be
+ *            started. Cached writes are still written back when the window
+ *            fills, or on flush and fsync.
+ * @recommendedaction  None
+ *
+ */
+
+#define WRITE_BEHIND_MSG_FLUSHER_FAILED        (GLFS_WRITE_BEHIND_BASE + 8)
+
 
 /*------------*/
 #define glfs_msg_end_x GLFS_MSGID_END, "Invalid: End of messages"
@@ -20,17 +20,32 @@
 #include "call-stub.h"
 #include "statedump.h"
 #include "defaults.h"
+#include "rb.h"
 #include "write-behind-mem-types.h"
 #include "write-behind-messages.h"
 
 #define MAX_VECTOR_COUNT          8
 #define WB_AGGREGATE_SIZE         131072 /* 128 KB */
 #define WB_WINDOW_SIZE            1048576 /* 1MB */
+#define WB_WRITEBACK_BATCH        64     /* inodes per flusher pass */
 
 typedef struct list_head list_head_t;
 struct wb_conf;
 struct wb_inode;
 
+/* Requests of a queue by ordering.off, so that the ones a byte range can
+   overlap are found without walking the queue. */
+typedef struct wb_index {
+        struct rb_table *tree;
+        uint64_t         sizes;     /* bit n set while @tree holds requests
+                                       with 2^n <= ordering.size < 2^(n+1) */
+        uint32_t         count[64]; /* of those requests, for each n */
+        int              unindexed; /* requests of the queue not in @tree:
+                                       those without an end (truncates,
+                                       appends) or failing allocation.
+                                       The queue is walked while any. */
+} wb_index_t;
+
 typedef struct wb_inode {
         ssize_t      window_conf;
         ssize_t      window_current;
@@ -78,12 +93,18 @@ typedef struct wb_inode {
 				     write-behind from this list, and therefore
 				     get "upgraded" to the "liability" list.
 			     */
+        int          tempted_fulfilled; /* entries of @temptation acked
+                                           by the server, the only ones
+                                           unwound while the window is
+                                           full */
 	list_head_t  wip; /* List of write calls in progress, SYNC or non-SYNC
 			     which are currently STACK_WIND'ed towards the server.
 			     This is for guaranteeing that no two overlapping
 			     writes are in progress at the same time. Modules
 			     like eager-lock in AFR depend on this behavior.
 			  */
+        wb_index_t   liability_index;
+        wb_index_t   wip_index;
 	uint64_t     gen;    /* Liability generation number. Represents
 				the current 'state' of liability. Every
 				new addition to the liability list bumps
@@ -115,6 +136,13 @@ typedef struct wb_inode {
                                 * error during fulfill.
                                 */
 
+        inode_t     *inode;
+        list_head_t  dirty;   /* in conf->dirty_inodes while window_current
+                                 is positive, oldest first. The requests
+                                 then pending keep the inode alive.
+                              */
+        time_t       dirty_since;
+
 } wb_inode_t;
 
 
@@ -151,6 +179,10 @@ typedef struct wb_request {
 	struct iobref        *iobref;
 	uint64_t              gen;  /* inode liability state at the time of
 				       request arrival */
+        size_t                capacity;  /* of the buffer small writes are
+                                            collapsed into */
+        gf_boolean_t          throttled; /* held back for dirty-limit, and
+                                            counted as such */
 
 	fd_t                 *fd;
         int                   wind_count;    /* number of sync-attempts. Only
@@ -177,11 +209,26 @@ typedef struct wb_request {
 typedef struct wb_conf {
         uint64_t         aggregate_size;
         uint64_t         window_size;
+        uint64_t         dirty_limit;
+        uint32_t         writeback_age;
         gf_boolean_t     flush_behind;
         gf_boolean_t     trickling_writes;
 	gf_boolean_t     strict_write_ordering;
 	gf_boolean_t     strict_O_DIRECT;
         gf_boolean_t     resync_after_fsync;
+
+        gf_atomic_t      dirty;       /* sum of the window_current of all
+                                         inodes of this instance */
+        gf_atomic_t      throttled;   /* writes held back for dirty-limit */
+        gf_atomic_t      writebacks;  /* inodes written back for their age */
+        gf_atomic_t      collapsed;   /* small writes collapsed */
+
+        pthread_mutex_t  lock;        /* dirty_inodes and the flusher */
+        pthread_cond_t   cond;
+        list_head_t      dirty_inodes;
+        pthread_t        flusher;
+        gf_boolean_t     flusher_running;
+        gf_boolean_t     fini;
 } wb_conf_t;
 
 
@@ -189,6 +236,64 @@ void
 wb_process_queue (wb_inode_t *wb_inode);
 
 
+/* Cached writes of all write-behind instances in the process: a client
+ * mounting many volumes, or a graph switch leaving the old graph busy,
+ * must not get a dirty-limit of its own per instance. */
+static gf_atomic_t    wb_dirty_total;
+static pthread_once_t wb_dirty_once = PTHREAD_ONCE_INIT;
+
+static void
+wb_dirty_total_init (void)
+{
+        GF_ATOMIC_INIT (wb_dirty_total, 0);
+}
+
+
+/* Grow (or shrink) the window of @wb_inode by @delta bytes, keeping the
+ * instance and process wide totals with it and the inode on the flusher's
+ * list while it is positive. */
+static void
+__wb_window_add (wb_inode_t *wb_inode, ssize_t delta)
+{
+        wb_conf_t *conf = NULL;
+
+        conf = wb_inode->this->private;
+
+        wb_inode->window_current += delta;
+        GF_ATOMIC_ADD (conf->dirty, delta);
+        GF_ATOMIC_ADD (wb_dirty_total, delta);
+
+        if ((wb_inode->window_current > 0) == !list_empty (&wb_inode->dirty))
+                return;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                if (wb_inode->window_current > 0) {
+                        wb_inode->dirty_since = time (NULL);
+                        list_add_tail (&wb_inode->dirty, &conf->dirty_inodes);
+                } else {
+                        list_del_init (&wb_inode->dirty);
+                }
+        }
+        pthread_mutex_unlock (&conf->lock);
+}
+
+
+/* Whether @wb_inode, holding cached writes, must write them back before it
+ * caches more, because all inodes of the process together hold more than
+ * dirty-limit. */
+static gf_boolean_t
+__wb_over_dirty_limit (wb_inode_t *wb_inode)
+{
+        wb_conf_t *conf = NULL;
+
+        conf = wb_inode->this->private;
+
+        return (conf->dirty_limit && wb_inode->window_current > 0 &&
+                GF_ATOMIC_GET (wb_dirty_total) > conf->dirty_limit);
+}
+
+
 wb_inode_t *
 __wb_inode_ctx_get (xlator_t *this, inode_t *inode)
 {
@@ -307,10 +412,196 @@ wb_requests_conflict (wb_request_t *lie, wb_request_t *req)
 }
 
 
+static int
+wb_index_compare (const void *item1, const void *item2, void *param)
+{
+        const wb_request_t *req1 = item1;
+        const wb_request_t *req2 = item2;
+
+        if (req1->ordering.off != req2->ordering.off)
+                return (req1->ordering.off < req2->ordering.off) ? -1 : 1;
+
+        if (req1 != req2)
+                return (req1 < req2) ? -1 : 1;
+
+        return 0;
+}
+
+
+static void
+__wb_index_account (wb_index_t *index, size_t size, int delta)
+{
+        int n = 63 - __builtin_clzll (size);
+
+        index->count[n] += delta;
+        if (index->count[n])
+                index->sizes |= (1ULL << n);
+        else
+                index->sizes &= ~(1ULL << n);
+}
+
+
+/* no request in @index is larger than this */
+static uint64_t
+wb_index_span (wb_index_t *index)
+{
+        int n = 63 - __builtin_clzll (index->sizes);
+
+        return (n == 63) ? ULLONG_MAX : (1ULL << (n + 1)) - 1;
+}
+
+
+static void
+__wb_index_add (wb_index_t *index, wb_request_t *req)
+{
+        if (!req->ordering.size || req->ordering.append ||
+            !rb_probe (index->tree, req)) {
+                index->unindexed++;
+                return;
+        }
+
+        __wb_index_account (index, req->ordering.size, 1);
+}
+
+
+static void
+__wb_index_del (wb_index_t *index, wb_request_t *req)
+{
+        if (!rb_delete (index->tree, req))
+                index->unindexed--;
+        else
+                __wb_index_account (index, req->ordering.size, -1);
+}
+
+
+/* ordering.size of @req, in @index, grows by @size */
+static void
+__wb_index_grow (wb_index_t *index, wb_request_t *req, size_t size)
+{
+        __wb_index_account (index, req->ordering.size, -1);
+        req->ordering.size += size;
+        __wb_index_account (index, req->ordering.size, 1);
+}
+
+
+typedef gf_boolean_t (*wb_index_match_t) (wb_request_t *each,
+                                          wb_request_t *req);
+
+/* first request under @node starting within [@lo, @hi] which @match */
+static wb_request_t *
+wb_index_search (struct rb_node *node, uint64_t lo, uint64_t hi,
+                 wb_request_t *req, wb_index_match_t match)
+{
+        wb_request_t *each  = NULL;
+        wb_request_t *found = NULL;
+
+        while (node) {
+                each = node->rb_data;
+
+                if ((uint64_t)each->ordering.off < lo) {
+                        node = node->rb_link[1];
+                        continue;
+                }
+
+                if ((uint64_t)each->ordering.off > hi) {
+                        node = node->rb_link[0];
+                        continue;
+                }
+
+                if (match (each, req))
+                        return each;
+
+                found = wb_index_search (node->rb_link[0], lo, hi, req, match);
+                if (found)
+                        return found;
+
+                node = node->rb_link[1];
+        }
+
+        return NULL;
+}
+
+
+/* A request of @index can overlap @req only if it starts less than its
+   largest ordering.size before it. */
+static wb_request_t *
+wb_index_lookup (wb_index_t *index, wb_request_t *req, wb_index_match_t match)
+{
+        uint64_t span = 0;
+        uint64_t lo   = 0;
+        uint64_t hi   = ULLONG_MAX;
+
+        if (!index->tree->rb_count)
+                return NULL;
+
+        span = wb_index_span (index);
+        if ((uint64_t)req->ordering.off >= span)
+                lo = req->ordering.off - span + 1;
+
+        if (req->ordering.size)
+                hi = req->ordering.off + req->ordering.size - 1;
+
+        return wb_index_search (index->tree->rb_root, lo, hi, req, match);
+}
+
+
+/* take @req off @liability or @temptation, whichever it is in */
+static void
+__wb_lie_del (wb_request_t *req)
+{
+        if (list_empty (&req->lie))
+                return;
+
+        if (req->ordering.lied)
+                __wb_index_del (&req->wb_inode->liability_index, req);
+        else if (req->ordering.fulfilled)
+                req->wb_inode->tempted_fulfilled--;
+
+        list_del_init (&req->lie);
+}
+
+
+static void
+__wb_wip_del (wb_request_t *req)
+{
+        if (!list_empty (&req->wip))
+                __wb_index_del (&req->wb_inode->wip_index, req);
+
+        list_del_init (&req->wip);
+}
+
+
+static gf_boolean_t
+wb_liability_conflicts (wb_request_t *lie, wb_request_t *req)
+{
+        /* A fulfilled request shouldn't block another request (even a
+         * dependent one) from winding.
+         */
+        return wb_requests_conflict (lie, req) && !lie->ordering.fulfilled;
+}
+
+
+static gf_boolean_t
+wb_wip_conflicts (wb_request_t *wip, wb_request_t *req)
+{
+        return (wip != req) && wb_requests_overlap (wip, req);
+}
+
+
 wb_request_t *
 wb_liability_has_conflict (wb_inode_t *wb_inode, wb_request_t *req)
 {
         wb_request_t *each     = NULL;
+        wb_conf_t    *conf     = NULL;
+
+        conf = wb_inode->this->private;
+
+        /* with strict-write-ordering every older lie conflicts, whatever
+           its range */
+        if (!wb_inode->liability_index.unindexed &&
+            !conf->strict_write_ordering)
+                return wb_index_lookup (&wb_inode->liability_index, req,
+                                        wb_liability_conflicts);
 
         list_for_each_entry (each, &wb_inode->liability, lie) {
 		if (wb_requests_conflict (each, req)
@@ -334,6 +625,10 @@ wb_wip_has_conflict (wb_inode_t *wb_inode, wb_request_t *req)
 		/* non-writes fundamentally never conflict with WIP requests */
 		return NULL;
 
+        if (!wb_inode->wip_index.unindexed)
+                return wb_index_lookup (&wb_inode->wip_index, req,
+                                        wb_wip_conflicts);
+
         list_for_each_entry (each, &wb_inode->wip, wip) {
 		if (each == req)
 			/* request never conflicts with itself,
@@ -381,14 +676,14 @@ __wb_request_unref (wb_request_t *req)
                                   gf_fop_list[req->fop], gfid, req->gen);
 
                 list_del_init (&req->todo);
-                list_del_init (&req->lie);
-		list_del_init (&req->wip);
+                __wb_lie_del (req);
+                __wb_wip_del (req);
 
 		list_del_init (&req->all);
 		if (list_empty (&wb_inode->all)) {
 			wb_inode->gen = 0;
 			/* in case of accounting errors? */
-			wb_inode->window_current = 0;
+			__wb_window_add (wb_inode, -wb_inode->window_current);
 		}
 
 		list_del_init (&req->winds);
@@ -645,21 +940,35 @@ __wb_inode_create (xlator_t *this, inode_t *inode)
         INIT_LIST_HEAD (&wb_inode->liability);
         INIT_LIST_HEAD (&wb_inode->temptation);
         INIT_LIST_HEAD (&wb_inode->wip);
+        INIT_LIST_HEAD (&wb_inode->dirty);
+
+        wb_inode->liability_index.tree = rb_create (wb_index_compare, NULL,
+                                                    NULL);
+        wb_inode->wip_index.tree = rb_create (wb_index_compare, NULL, NULL);
+        if (!wb_inode->liability_index.tree || !wb_inode->wip_index.tree)
+                goto free;
 
         wb_inode->this = this;
+        wb_inode->inode = inode;
 
         wb_inode->window_conf = conf->window_size;
 
         LOCK_INIT (&wb_inode->lock);
 
         ret = __inode_ctx_put (inode, this, (uint64_t)(unsigned long)wb_inode);
-        if (ret) {
-                GF_FREE (wb_inode);
-                wb_inode = NULL;
-        }
+        if (ret)
+                goto free;
 
 out:
         return wb_inode;
+
+free:
+        if (wb_inode->liability_index.tree)
+                rb_destroy (wb_inode->liability_index.tree, NULL);
+        if (wb_inode->wip_index.tree)
+                rb_destroy (wb_inode->wip_index.tree, NULL);
+        GF_FREE (wb_inode);
+        return NULL;
 }
 
 
@@ -704,7 +1013,7 @@ __wb_fulfill_request (wb_request_t *req)
 	wb_inode = req->wb_inode;
 
 	req->ordering.fulfilled = 1;
-	wb_inode->window_current -= req->total_size;
+	__wb_window_add (wb_inode, -req->total_size);
 	wb_inode->transit -= req->total_size;
 
         uuid_utoa_r (req->gfid, gfid);
@@ -722,11 +1031,13 @@ __wb_fulfill_request (wb_request_t *req)
                    2. If no, request is in temptation queue and hence should be
                       left in the queue so that wb_pick_unwinds picks it up
                 */
-                list_del_init (&req->lie);
+                __wb_lie_del (req);
         } else {
 		/* TODO: fail the req->frame with error if
 		   necessary
 		*/
+                if (!list_empty (&req->lie))
+                        wb_inode->tempted_fulfilled++;
 	}
 
 	__wb_request_unref (req);
@@ -773,7 +1084,7 @@ __wb_add_request_for_retry (wb_request_t *req)
 
         list_del_init (&req->winds);
         list_del_init (&req->todo);
-        list_del_init (&req->wip);
+        __wb_wip_del (req);
 
         /* sanitize ordering flags to retry */
         req->ordering.go = 0;
@@ -1222,20 +1533,41 @@ __wb_pick_unwinds (wb_inode_t *wb_inode, list_head_t *lies)
         wb_request_t *req      = NULL;
         wb_request_t *tmp      = NULL;
         char          gfid[64] = {0,};
+        wb_conf_t    *conf     = NULL;
+
+        conf = wb_inode->this->private;
 
 	list_for_each_entry_safe (req, tmp, &wb_inode->temptation, lie) {
 		if (!req->ordering.fulfilled &&
-		    wb_inode->window_current > wb_inode->window_conf)
+		    wb_inode->window_current > wb_inode->window_conf) {
+                        /* the window only grows further in this loop */
+                        if (!wb_inode->tempted_fulfilled)
+                                break;
 			continue;
+                }
 
-		list_del_init (&req->lie);
+                if (!req->ordering.fulfilled &&
+                    __wb_over_dirty_limit (wb_inode)) {
+                        /* writeback throttling: the writer waits for its
+                           own cached writes to reach the server */
+                        if (!req->throttled) {
+                                req->throttled = _gf_true;
+                                GF_ATOMIC_INC (conf->throttled);
+                        }
+                        if (!wb_inode->tempted_fulfilled)
+                                break;
+                        continue;
+                }
+
+		__wb_lie_del (req);
 		list_move_tail (&req->unwinds, lies);
 
-		wb_inode->window_current += req->orig_size;
+		__wb_window_add (wb_inode, req->orig_size);
 
 		if (!req->ordering.fulfilled) {
 			/* burden increased */
 			list_add_tail (&req->lie, &wb_inode->liability);
+                        __wb_index_add (&wb_inode->liability_index, req);
 
 			req->ordering.lied = 1;
 
@@ -1266,6 +1598,9 @@ __wb_collapse_small_writes (wb_request_t *holder, wb_request_t *req)
         ssize_t        required_size = 0;
         size_t         holder_len = 0;
         size_t         req_len = 0;
+        wb_conf_t     *conf   = NULL;
+
+        conf = req->wb_inode->this->private;
 
         if (!holder->iobref) {
                 holder_len = iov_length (holder->stub->args.vector,
@@ -1273,7 +1608,7 @@ __wb_collapse_small_writes (wb_request_t *holder, wb_request_t *req)
                 req_len = iov_length (req->stub->args.vector,
                                       req->stub->args.count);
 
-                required_size = max ((THIS->ctx->page_size),
+                required_size = max ((conf->aggregate_size),
                                      (holder_len + req_len));
                 iobuf = iobuf_get2 (req->wb_inode->this->ctx->iobuf_pool,
                                     required_size);
@@ -1309,6 +1644,7 @@ __wb_collapse_small_writes (wb_request_t *holder, wb_request_t *req)
                 iobuf_unref (iobuf);
 
                 holder->iobref = iobref_ref (iobref);
+                holder->capacity = required_size;
         }
 
         ptr = holder->stub->args.vector[0].iov_base + holder->write_size;
@@ -1318,7 +1654,14 @@ __wb_collapse_small_writes (wb_request_t *holder, wb_request_t *req)
 
         holder->stub->args.vector[0].iov_len += req->write_size;
         holder->write_size += req->write_size;
-        holder->ordering.size += req->write_size;
+        if (holder->ordering.lied &&
+            rb_find (holder->wb_inode->liability_index.tree, holder))
+                __wb_index_grow (&holder->wb_inode->liability_index, holder,
+                                 req->write_size);
+        else
+                holder->ordering.size += req->write_size;
+
+        GF_ATOMIC_INC (conf->collapsed);
 
         ret = 0;
 out:
@@ -1336,7 +1679,7 @@ __wb_preprocess_winds (wb_inode_t *wb_inode)
 	wb_request_t *holder          = NULL;
 	wb_conf_t    *conf            = NULL;
         int           ret             = 0;
-	ssize_t       page_size       = 0;
+        off_t         boundary        = 0;
         char          gfid[64]        = {0, };
 
 	/* With asynchronous IO from a VM guest (as a file), there
@@ -1348,7 +1691,6 @@ __wb_preprocess_winds (wb_inode_t *wb_inode)
 	   through the interleaved ops
 	*/
 
-	page_size = wb_inode->this->ctx->page_size;
 	conf = wb_inode->this->private;
 
         list_for_each_entry_safe (req, tmp, &wb_inode->todo, todo) {
@@ -1407,7 +1749,17 @@ __wb_preprocess_winds (wb_inode_t *wb_inode)
                         continue;
                 }
 
-		space_left = page_size - holder->write_size;
+                /* Collapse up to the next aggregate-size boundary only, so
+                   that a run of small writes goes out in large writes
+                   aligned to it.  The buffer collapsed into must have room
+                   too, aggregate-size may have been changed since. */
+                boundary = floor (holder->stub->args.offset,
+                                  conf->aggregate_size) + conf->aggregate_size;
+		space_left = boundary - offset_expected;
+                if (holder->iobref)
+                        space_left = min (space_left, (ssize_t)
+                                          (holder->capacity -
+                                           holder->write_size));
 
 		if (space_left < req->write_size) {
 			holder->ordering.go = 1;
@@ -1419,6 +1771,10 @@ __wb_preprocess_winds (wb_inode_t *wb_inode)
 		if (ret)
 			continue;
 
+                if (offset_expected + req->write_size == boundary)
+                        /* a whole aligned chunk, nothing more to wait for */
+                        holder->ordering.go = 1;
+
 		/* collapsed request is as good as wound
 		   (from its p.o.v)
 		*/
@@ -1442,6 +1798,11 @@ __wb_preprocess_winds (wb_inode_t *wb_inode)
 	if (conf->trickling_writes && !wb_inode->transit && holder)
 		holder->ordering.go = 1;
 
+        /* nor when over dirty-limit: writes held back from being
+           acknowledged must not wait for the holder to fill up */
+        if (holder && !wb_inode->transit && __wb_over_dirty_limit (wb_inode))
+                holder->ordering.go = 1;
+
         if (wb_inode->dontsync > 0)
                 wb_inode->dontsync--;
 
@@ -1489,7 +1850,7 @@ __wb_handle_failed_conflict (wb_request_t *req, wb_request_t *conflict,
                                  * wb_do_unwinds too. Otherwise there'll be
                                  * a double wind.
                                  */
-                                list_del_init (&req->lie);
+                                __wb_lie_del (req);
 
                                 gf_msg_debug (req->wb_inode->this->name, 0,
                                               "(unique=%"PRIu64", fop=%s, "
@@ -1632,6 +1993,7 @@ __wb_pick_winds (wb_inode_t *wb_inode, list_head_t *tasks,
                         }
 
 			list_add_tail (&req->wip, &wb_inode->wip);
+                        __wb_index_add (&wb_inode->wip_index, req);
                         req->wind_count++;
 
 			if (!req->ordering.tempted)
@@ -1722,6 +2084,85 @@ wb_process_queue (wb_inode_t *wb_inode)
 }
 
 
+/* Let the cached writes of @wb_inode go to the server without waiting for
+   more small writes to collapse into them. */
+static void
+wb_writeback (wb_inode_t *wb_inode)
+{
+        wb_request_t *req = NULL;
+
+        LOCK (&wb_inode->lock);
+        {
+                list_for_each_entry (req, &wb_inode->todo, todo) {
+                        if (req->ordering.tempted && req->ordering.lied)
+                                req->ordering.go = 1;
+                }
+        }
+        UNLOCK (&wb_inode->lock);
+
+        wb_process_queue (wb_inode);
+}
+
+
+/* Writes back every writeback-age seconds the inodes which have held cached
+ * writes for longer than that, so that they do not all pile up for the
+ * close. */
+static void *
+wb_flusher (void *data)
+{
+        xlator_t        *this     = data;
+        wb_conf_t       *conf     = NULL;
+        wb_inode_t      *wb_inode = NULL;
+        wb_inode_t      *tmp      = NULL;
+        inode_t         *inodes[WB_WRITEBACK_BATCH];
+        struct timespec  deadline = {0, };
+        time_t           now      = 0;
+        int              count    = 0;
+        int              i        = 0;
+
+        THIS = this;
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        while (!conf->fini) {
+                deadline.tv_sec = time (NULL) +
+                        max (conf->writeback_age / 2, 1);
+                pthread_cond_timedwait (&conf->cond, &conf->lock, &deadline);
+                if (conf->fini || !conf->writeback_age)
+                        continue;
+
+                now = time (NULL);
+                count = 0;
+
+                list_for_each_entry_safe (wb_inode, tmp, &conf->dirty_inodes,
+                                          dirty) {
+                        if (now - wb_inode->dirty_since < conf->writeback_age ||
+                            count == WB_WRITEBACK_BATCH)
+                                break;
+
+                        inodes[count++] = inode_ref (wb_inode->inode);
+                        wb_inode->dirty_since = now;
+                        list_move_tail (&wb_inode->dirty, &conf->dirty_inodes);
+                }
+                pthread_mutex_unlock (&conf->lock);
+
+                for (i = 0; i < count; i++) {
+                        wb_inode = wb_inode_ctx_get (this, inodes[i]);
+                        if (wb_inode) {
+                                wb_writeback (wb_inode);
+                                GF_ATOMIC_INC (conf->writebacks);
+                        }
+                        inode_unref (inodes[i]);
+                }
+
+                pthread_mutex_lock (&conf->lock);
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        return NULL;
+}
+
+
 void
 wb_set_inode_size(wb_inode_t *wb_inode, struct iatt *postbuf)
 {
@@ -2733,7 +3174,10 @@ wb_forget (xlator_t *this, inode_t *inode)
         GF_ASSERT (list_empty (&wb_inode->todo));
         GF_ASSERT (list_empty (&wb_inode->liability));
         GF_ASSERT (list_empty (&wb_inode->temptation));
+        GF_ASSERT (list_empty (&wb_inode->dirty));
 
+        rb_destroy (wb_inode->liability_index.tree, NULL);
+        rb_destroy (wb_inode->wip_index.tree, NULL);
         GF_FREE (wb_inode);
 
         return 0;
@@ -2772,6 +3216,17 @@ wb_priv_dump (xlator_t *this)
         gf_proc_dump_write ("window_size", "%d", conf->window_size);
         gf_proc_dump_write ("flush_behind", "%d", conf->flush_behind);
         gf_proc_dump_write ("trickling_writes", "%d", conf->trickling_writes);
+        gf_proc_dump_write ("dirty_limit", "%"PRIu64, conf->dirty_limit);
+        gf_proc_dump_write ("writeback_age", "%u", conf->writeback_age);
+        gf_proc_dump_write ("dirty", "%"PRId64, GF_ATOMIC_GET (conf->dirty));
+        gf_proc_dump_write ("dirty_process", "%"PRId64,
+                            GF_ATOMIC_GET (wb_dirty_total));
+        gf_proc_dump_write ("throttled", "%"PRId64,
+                            GF_ATOMIC_GET (conf->throttled));
+        gf_proc_dump_write ("writebacks", "%"PRId64,
+                            GF_ATOMIC_GET (conf->writebacks));
+        gf_proc_dump_write ("collapsed", "%"PRId64,
+                            GF_ATOMIC_GET (conf->collapsed));
 
         ret = 0;
 out:
@@ -2886,6 +3341,12 @@ wb_inode_dump (xlator_t *this, inode_t *inode)
 
         gf_proc_dump_write ("dontsync", "%d", wb_inode->dontsync);
 
+        gf_proc_dump_write ("liability_unindexed", "%d",
+                            wb_inode->liability_index.unindexed);
+
+        gf_proc_dump_write ("wip_unindexed", "%d",
+                            wb_inode->wip_index.unindexed);
+
         ret = TRY_LOCK (&wb_inode->lock);
         if (!ret)
         {
@@ -2932,12 +3393,35 @@ out:
 int
 reconfigure (xlator_t *this, dict_t *options)
 {
-        wb_conf_t *conf = NULL;
-        int        ret  = -1;
+        wb_conf_t *conf           = NULL;
+        uint64_t   window_size    = 0;
+        uint64_t   aggregate_size = 0;
+        int        ret            = -1;
 
         conf = this->private;
 
-        GF_OPTION_RECONF ("cache-size", conf->window_size, options, size_uint64,
+        GF_OPTION_RECONF ("cache-size", window_size, options, size_uint64,
+                          out);
+
+        GF_OPTION_RECONF ("aggregate-size", aggregate_size, options,
+                          size_uint64, out);
+
+        if (window_size < aggregate_size) {
+                gf_msg (this->name, GF_LOG_ERROR, EINVAL,
+                        WRITE_BEHIND_MSG_EXCEEDED_MAX_SIZE,
+                        "aggregate-size(%"PRIu64") cannot be more than "
+                        "window-size(%"PRIu64")", aggregate_size,
+                        window_size);
+                goto out;
+        }
+
+        conf->window_size = window_size;
+        conf->aggregate_size = aggregate_size;
+
+        GF_OPTION_RECONF ("dirty-limit", conf->dirty_limit, options,
+                          size_uint64, out);
+
+        GF_OPTION_RECONF ("writeback-age", conf->writeback_age, options, time,
                           out);
 
         GF_OPTION_RECONF ("flush-behind", conf->flush_behind, options, bool,
@@ -2987,7 +3471,8 @@ init (xlator_t *this)
         }
 
         /* configure 'options aggregate-size <size>' */
-        conf->aggregate_size = WB_AGGREGATE_SIZE;
+        GF_OPTION_INIT ("aggregate-size", conf->aggregate_size, size_uint64,
+                        out);
 
         /* configure 'option window-size <size>' */
         GF_OPTION_INIT ("cache-size", conf->window_size, size_uint64, out);
@@ -3023,7 +3508,32 @@ init (xlator_t *this)
         GF_OPTION_INIT ("resync-failed-syncs-after-fsync",
                         conf->resync_after_fsync, bool, out);
 
+        GF_OPTION_INIT ("dirty-limit", conf->dirty_limit, size_uint64, out);
+
+        GF_OPTION_INIT ("writeback-age", conf->writeback_age, time, out);
+
+        (void) pthread_once (&wb_dirty_once, wb_dirty_total_init);
+
+        GF_ATOMIC_INIT (conf->dirty, 0);
+        GF_ATOMIC_INIT (conf->throttled, 0);
+        GF_ATOMIC_INIT (conf->writebacks, 0);
+        GF_ATOMIC_INIT (conf->collapsed, 0);
+
+        INIT_LIST_HEAD (&conf->dirty_inodes);
+        pthread_mutex_init (&conf->lock, NULL);
+        pthread_cond_init (&conf->cond, NULL);
+
         this->private = conf;
+
+        if (gf_thread_create (&conf->flusher, NULL, wb_flusher, this)) {
+                gf_msg (this->name, GF_LOG_WARNING, errno,
+                        WRITE_BEHIND_MSG_FLUSHER_FAILED,
+                        "failed to start the thread writing back aged "
+                        "cached writes");
+        } else {
+                conf->flusher_running = _gf_true;
+        }
+
         ret = 0;
 
 out:
@@ -3046,7 +3556,20 @@ fini (xlator_t *this)
                 goto out;
         }
 
+        if (conf->flusher_running) {
+                pthread_mutex_lock (&conf->lock);
+                {
+                        conf->fini = _gf_true;
+                        pthread_cond_signal (&conf->cond);
+                }
+                pthread_mutex_unlock (&conf->lock);
+
+                pthread_join (conf->flusher, NULL);
+        }
+
         this->private = NULL;
+        pthread_cond_destroy (&conf->cond);
+        pthread_mutex_destroy (&conf->lock);
         GF_FREE (conf);
 
 out:
@@ -3108,6 +3631,36 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "on",
         },
+        { .key  = {"aggregate-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 4 * GF_UNIT_KB,
+          .max  = 4 * GF_UNIT_MB,
+          .default_value = "128KB",
+          .description = "Consecutive small writes are collapsed into "
+                         "writes of up to this size, aligned to it in the "
+                         "file. It cannot be more than cache-size."
+        },
+        { .key  = {"dirty-limit"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 0,
+          .max  = 64 * GF_UNIT_GB,
+          .default_value = "256MB",
+          .description = "Cached writes all the files of all the volumes "
+                         "the process mounts may hold together. "
+                         "Past it, writes to a file which already holds "
+                         "cached writes are acknowledged only once those "
+                         "reach the server. 0 leaves only the cache-size "
+                         "of each file."
+        },
+        { .key  = {"writeback-age"},
+          .type = GF_OPTION_TYPE_TIME,
+          .min  = 0,
+          .max  = 3600,
+          .default_value = "2",
+          .description = "Seconds after which cached writes are written "
+                         "back even though more could have been collapsed "
+                         "into them. 0 disables it."
+        },
         { .key = {"strict-O_DIRECT"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "off",
@@ -34,8 +34,8 @@ client_pre_stat (xlator_t *this, gfs3_stat_req *req, loc_t *loc,
                                       !gf_uuid_is_null (*((uuid_t *)req->gfid)),
                                       out, op_errno, EINVAL);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -60,8 +60,8 @@ client_pre_readlink (xlator_t *this, gfs3_readlink_req *req, loc_t *loc,
                                       !gf_uuid_is_null (*((uuid_t *)req->gfid)),
                                       out, op_errno, EINVAL);
         req->size = size;
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -90,8 +90,8 @@ client_pre_mknod (xlator_t *this, gfs3_mknod_req *req, loc_t *loc,
         req->umask = umask;
 
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -120,8 +120,8 @@ client_pre_mkdir (xlator_t *this, gfs3_mkdir_req *req, loc_t *loc,
         req->mode  = mode;
         req->umask = umask;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -148,8 +148,8 @@ client_pre_unlink (xlator_t *this, gfs3_unlink_req *req, loc_t *loc,
         req->bname = (char *)loc->name;
         req->xflags = flags;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -176,8 +176,8 @@ client_pre_rmdir (xlator_t *this, gfs3_rmdir_req *req, loc_t *loc,
         req->bname = (char *)loc->name;
         req->xflags = flags;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -205,8 +205,8 @@ client_pre_symlink (xlator_t *this, gfs3_symlink_req *req, loc_t *loc,
         req->bname    = (char *)loc->name;
         req->umask = umask;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -241,8 +241,8 @@ client_pre_rename (xlator_t *this, gfs3_rename_req *req, loc_t *oldloc,
         req->oldbname =  (char *)oldloc->name;
         req->newbname = (char *)newloc->name;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -278,8 +278,8 @@ client_pre_link (xlator_t *this,
                                    out, op_errno, EINVAL);
         req->newbname = (char *)newloc->name;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -305,8 +305,8 @@ client_pre_truncate (xlator_t *this, gfs3_truncate_req *req,
                                       out, op_errno, EINVAL);
         req->offset = offset;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -331,8 +331,8 @@ client_pre_open (xlator_t *this, gfs3_open_req *req, loc_t *loc, fd_t *fd,
                                       out, op_errno, EINVAL);
         req->flags = gf_flags_from_flags (flags);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -356,8 +356,8 @@ client_pre_readv (xlator_t *this, gfs3_read_req *req, fd_t *fd, size_t size,
 
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -390,8 +390,8 @@ client_pre_writev (xlator_t *this, gfs3_write_req *req,
                             "testing-the-xdata-value");
 #endif
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, *xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, *xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -420,8 +420,8 @@ client_pre_statfs (xlator_t *this, gfs3_statfs_req *req, loc_t *loc,
                                       !gf_uuid_is_null (*((uuid_t *)req->gfid)),
                                       out, op_errno, EINVAL);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -440,8 +440,8 @@ client_pre_flush (xlator_t *this, gfs3_flush_req *req, fd_t *fd, dict_t *xdata)
         req->fd = remote_fd;
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -462,8 +462,8 @@ client_pre_fsync (xlator_t *this, gfs3_fsync_req *req, fd_t *fd,
         req->data = flags;
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -488,16 +488,16 @@ client_pre_setxattr (xlator_t *this, gfs3_setxattr_req *req, loc_t *loc,
                                       !gf_uuid_is_null (*((uuid_t *)req->gfid)),
                                       out, op_errno, EINVAL);
         if (xattr) {
-                GF_PROTOCOL_DICT_SERIALIZE (this, xattr,
-                                            (&req->dict.dict_val),
-                                            req->dict.dict_len,
-                                            op_errno, out);
+                CLIENT_DICT_SERIALIZE (this, xattr,
+                                       (&req->dict.dict_val),
+                                       req->dict.dict_len,
+                                       op_errno, out);
         }
 
         req->flags = flags;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -531,8 +531,8 @@ client_pre_getxattr (xlator_t *this, gfs3_getxattr_req *req, loc_t *loc,
                 req->namelen = 0;
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -558,8 +558,8 @@ client_pre_removexattr (xlator_t *this, gfs3_removexattr_req *req,
                                       out, op_errno, EINVAL);
         req->name = (char *)name;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -585,8 +585,8 @@ client_pre_opendir (xlator_t *this,
                                       !gf_uuid_is_null (*((uuid_t *)req->gfid)),
                                       out, op_errno, EINVAL);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -607,8 +607,8 @@ client_pre_fsyncdir (xlator_t *this, gfs3_fsyncdir_req *req, fd_t *fd,
         req->data = flags;
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -634,8 +634,8 @@ client_pre_access (xlator_t *this, gfs3_access_req *req, loc_t *loc,
                                       out, op_errno, EINVAL);
         req->mask = mask;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -664,8 +664,8 @@ client_pre_create (xlator_t *this, gfs3_create_req *req,
         req->flags = gf_flags_from_flags (flags);
         req->umask = umask;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -686,8 +686,8 @@ client_pre_ftruncate (xlator_t *this, gfs3_ftruncate_req *req, fd_t *fd,
         req->fd     = remote_fd;
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -706,8 +706,8 @@ client_pre_fstat (xlator_t *this, gfs3_fstat_req *req, fd_t *fd,
         req->fd = remote_fd;
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -754,8 +754,8 @@ client_pre_lk (xlator_t *this, gfs3_lk_req *req,
 
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -788,10 +788,10 @@ client_pre_lookup (xlator_t *this, gfs3_lookup_req *req, loc_t *loc,
                 req->bname = "";
 
         if (xdata) {
-                GF_PROTOCOL_DICT_SERIALIZE (this, xdata,
-                                            (&req->xdata.xdata_val),
-                                            req->xdata.xdata_len,
-                                            op_errno, out);
+                CLIENT_DICT_SERIALIZE (this, xdata,
+                                       (&req->xdata.xdata_val),
+                                       req->xdata.xdata_len,
+                                       op_errno, out);
         }
         return 0;
 out:
@@ -813,8 +813,8 @@ client_pre_readdir (xlator_t *this, gfs3_readdir_req *req, fd_t *fd,
         req->fd = remote_fd;
 
         memcpy (req->gfid, fd->inode->gfid, 16);
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -871,8 +871,8 @@ client_pre_inodelk (xlator_t *this, gfs3_inodelk_req *req, loc_t *loc,
         req->type   = gf_type;
         gf_proto_flock_from_flock (&req->flock, flock);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -923,8 +923,8 @@ client_pre_finodelk (xlator_t *this, gfs3_finodelk_req *req, fd_t *fd,
         gf_proto_flock_from_flock (&req->flock, flock);
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -957,8 +957,8 @@ client_pre_entrylk (xlator_t *this, gfs3_entrylk_req *req, loc_t *loc,
                 req->namelen = 1;
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -987,8 +987,8 @@ client_pre_fentrylk (xlator_t *this, gfs3_fentrylk_req *req, fd_t *fd,
         }
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1013,16 +1013,16 @@ client_pre_xattrop (xlator_t *this, gfs3_xattrop_req *req, loc_t *loc,
                                       !gf_uuid_is_null (*((uuid_t *)req->gfid)),
                                       out, op_errno, EINVAL);
         if (xattr) {
-                GF_PROTOCOL_DICT_SERIALIZE (this, xattr,
-                                            (&req->dict.dict_val),
-                                            req->dict.dict_len,
-                                            op_errno, out);
+                CLIENT_DICT_SERIALIZE (this, xattr,
+                                       (&req->dict.dict_val),
+                                       req->dict.dict_len,
+                                       op_errno, out);
         }
 
         req->flags = flags;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1044,14 +1044,14 @@ client_pre_fxattrop (xlator_t *this, gfs3_fxattrop_req *req, fd_t *fd,
         memcpy (req->gfid, fd->inode->gfid, 16);
 
         if (xattr) {
-                GF_PROTOCOL_DICT_SERIALIZE (this, xattr,
-                                            (&req->dict.dict_val),
-                                            req->dict.dict_len,
-                                            op_errno, out);
+                CLIENT_DICT_SERIALIZE (this, xattr,
+                                       (&req->dict.dict_val),
+                                       req->dict.dict_len,
+                                       op_errno, out);
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1077,8 +1077,8 @@ client_pre_fgetxattr (xlator_t *this, gfs3_fgetxattr_req *req, fd_t *fd,
         }
         memcpy (req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1100,14 +1100,14 @@ client_pre_fsetxattr (xlator_t *this, gfs3_fsetxattr_req *req, fd_t *fd,
         memcpy (req->gfid, fd->inode->gfid, 16);
 
         if (xattr) {
-                GF_PROTOCOL_DICT_SERIALIZE (this, xattr,
-                                            (&req->dict.dict_val),
-                                            req->dict.dict_len,
-                                            op_errno, out);
+                CLIENT_DICT_SERIALIZE (this, xattr,
+                                       (&req->dict.dict_val),
+                                       req->dict.dict_len,
+                                       op_errno, out);
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1128,8 +1128,8 @@ client_pre_rchecksum (xlator_t *this, gfs3_rchecksum_req *req, fd_t *fd,
         req->offset = offset;
         req->fd     = remote_fd;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1157,8 +1157,8 @@ client_pre_setattr (xlator_t *this, gfs3_setattr_req *req, loc_t *loc,
         req->valid = valid;
         gf_stat_from_iatt (&req->stbuf, stbuf);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1179,8 +1179,8 @@ client_pre_fsetattr (xlator_t *this, gfs3_fsetattr_req *req, fd_t *fd,
         req->valid = valid;
         gf_stat_from_iatt (&req->stbuf, stbuf);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -1202,8 +1202,8 @@ client_pre_readdirp (xlator_t *this, gfs3_readdirp_req *req, fd_t *fd,
         memcpy (req->gfid, fd->inode->gfid, 16);
 
         /* dict itself is 'xdata' here */
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->dict.dict_val),
-                                    req->dict.dict_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->dict.dict_val),
+                               req->dict.dict_len, op_errno, out);
 
         return 0;
 out:
@@ -1227,8 +1227,8 @@ client_pre_fremovexattr (xlator_t *this, gfs3_fremovexattr_req *req, fd_t *fd,
         req->name = (char *)name;
         req->fd = remote_fd;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1251,8 +1251,8 @@ client_pre_fallocate (xlator_t *this, gfs3_fallocate_req *req, fd_t *fd,
 	req->size = size;
 	memcpy(req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -1273,8 +1273,8 @@ client_pre_discard (xlator_t *this, gfs3_discard_req *req, fd_t *fd,
 	req->size = size;
 	memcpy(req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -1295,8 +1295,8 @@ client_pre_zerofill (xlator_t *this, gfs3_zerofill_req *req, fd_t *fd,
         req->size = size;
         memcpy(req->gfid, fd->inode->gfid, 16);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -1310,8 +1310,8 @@ client_pre_ipc (xlator_t *this, gfs3_ipc_req *req, int32_t cmd,
 
         req->op = cmd;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
         return 0;
 out:
         return -op_errno;
@@ -1332,8 +1332,8 @@ client_pre_seek (xlator_t *this, gfs3_seek_req *req, fd_t *fd,
         req->offset = offset;
         req->what = what;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 
         return 0;
 out:
@@ -1360,8 +1360,8 @@ client_pre_lease (xlator_t *this, gfs3_lease_req *req, loc_t *loc,
 
         gf_proto_lease_from_lease (&req->lease, lease);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
-                                    req->xdata.xdata_len, op_errno, out);
+        CLIENT_DICT_SERIALIZE (this, xdata, (&req->xdata.xdata_val),
+                               req->xdata.xdata_len, op_errno, out);
 out:
         return -op_errno;
 }
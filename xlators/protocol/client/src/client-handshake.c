@@ -1079,6 +1079,7 @@ client_setvolume_cbk (struct rpc_req *req, struct iovec *iov, int count, void *m
         int32_t               op_errno      = 0;
         gf_boolean_t          auth_fail     = _gf_false;
         uint32_t              lk_ver        = 0;
+        int32_t               compact       = 0;
 
         frame = myframe;
         this  = frame->this;
@@ -1176,6 +1177,11 @@ client_setvolume_cbk (struct rpc_req *req, struct iovec *iov, int count, void *m
                 conf->child_up = _gf_true;
         }
 
+        /* servers that do not know the compact dict encoding do not
+         * answer for it */
+        ret = dict_get_int32 (reply, "dict-encoding-compact", &compact);
+        conf->peer_compact_dict = (ret == 0 && compact && conf->compact_dict);
+
         ret = dict_get_uint32 (reply, "clnt-lk-version", &lk_ver);
         if (ret) {
                 gf_msg (this->name, GF_LOG_WARNING, 0, PC_MSG_DICT_GET_FAILED,
@@ -1391,6 +1397,14 @@ client_setvolume (xlator_t *this, struct rpc_clnt *rpc)
                         "Failed to set client opversion in handshake message");
         }
 
+        ret = dict_set_int32 (options, "dict-encoding-compact",
+                              conf->compact_dict);
+        if (ret < 0) {
+                gf_msg (this->name, GF_LOG_WARNING, 0, PC_MSG_DICT_SET_FAILED,
+                        "failed to set 'dict-encoding-compact' in handshake "
+                        "msg");
+        }
+
         ret = dict_serialized_length (options);
         if (ret < 0) {
                 gf_msg (this->name, GF_LOG_ERROR, 0, PC_MSG_DICT_ERROR,
@@ -6154,10 +6154,10 @@ client3_3_compound (call_frame_t *frame, xlator_t *this, void *data)
         req.compound_req_array.compound_req_array_len = c_args->fop_length;
         req.compound_version = 0;
         if (xdata) {
-                GF_PROTOCOL_DICT_SERIALIZE (this, xdata,
-                                            (&req.xdata.xdata_val),
-                                            req.xdata.xdata_len,
-                                            op_errno, unwind);
+                CLIENT_DICT_SERIALIZE (this, xdata,
+                                       (&req.xdata.xdata_val),
+                                       req.xdata.xdata_len,
+                                       op_errno, unwind);
         }
 
         req.compound_req_array.compound_req_array_val = GF_CALLOC (local->length,
@@ -6244,8 +6244,8 @@ client3_3_getactivelk (call_frame_t *frame, xlator_t *this,
                                        unwind, op_errno, EINVAL);
         conf = this->private;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
-                                    req.xdata.xdata_len, op_errno, unwind);
+        CLIENT_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                               req.xdata.xdata_len, op_errno, unwind);
 
         ret = client_submit_request (this, &req, frame, conf->fops,
                                      GFS3_OP_GETACTIVELK,
@@ -6295,8 +6295,8 @@ client3_3_setactivelk (call_frame_t *frame, xlator_t *this,
                                        unwind, op_errno, EINVAL);
         conf = this->private;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
-                                    req.xdata.xdata_len, op_errno, unwind);
+        CLIENT_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                               req.xdata.xdata_len, op_errno, unwind);
 
         ret = serialize_req_locklist (args->locklist, &req);
 
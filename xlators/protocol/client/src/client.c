@@ -2444,6 +2444,8 @@ build_client_config (xlator_t *this, clnt_conf_t *conf)
 
         GF_OPTION_INIT ("send-gids", conf->send_gids, bool, out);
 
+        GF_OPTION_INIT ("compact-dict", conf->compact_dict, bool, out);
+
         conf->client_id = glusterfs_leaf_position(this);
 
         ret = client_check_remote_host (this, this->options);
@@ -2660,6 +2662,10 @@ reconfigure (xlator_t *this, dict_t *options)
 
         GF_OPTION_RECONF ("send-gids", conf->send_gids, options, bool, out);
 
+        /* takes effect on the next handshake */
+        GF_OPTION_RECONF ("compact-dict", conf->compact_dict, options, bool,
+                          out);
+
         ret = client_init_grace_timer (this, options, conf);
         if (ret)
                 goto out;
@@ -3040,6 +3046,13 @@ struct volume_options options[] = {
           .type  = GF_OPTION_TYPE_BOOL,
           .default_value = "on",
         },
+        { .key   = {"compact-dict"},
+          .type  = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "Ask the server to exchange dictionaries in the "
+          "compact encoding, which sends well-known keys as small numbers. "
+          "Servers that do not support it keep using the old encoding."
+        },
         { .key   = {"event-threads"},
           .type  = GF_OPTION_TYPE_INT,
           .min   = 1,
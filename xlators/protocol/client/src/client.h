@@ -107,6 +107,12 @@ typedef enum {
                 free (_this_rsp->xdata.xdata_val);                            \
         } while (0)
 
+/* requests carry dicts in the compact encoding once the server accepted it
+ * in the handshake */
+#define CLIENT_DICT_SERIALIZE(this,from_dict,to,len,ope,labl)           \
+        GF_PROTOCOL_DICT_SERIALIZE_FMT (this, from_dict, to, len, ope, labl, \
+                        ((clnt_conf_t *)(this)->private)->peer_compact_dict)
+
 #define CLIENT_GET_REMOTE_FD(xl, fd, flags, remote_fd, op_errno, label) \
         do {                                                            \
                 int     _ret    = 0;                                    \
@@ -204,6 +210,10 @@ typedef struct clnt_conf {
 
         gf_boolean_t           child_up; /* Set to true, when child is up, and
                                           * false, when child is down */
+
+        gf_boolean_t           compact_dict; /* ask for the compact dict
+                                              * encoding in the handshake */
+        gf_boolean_t           peer_compact_dict; /* server accepted it */
 } clnt_conf_t;
 
 typedef struct _client_fd_ctx {
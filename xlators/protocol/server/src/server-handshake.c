@@ -412,6 +412,7 @@ server_setvolume (rpcsvc_request_t *req)
         rpc_transport_t     *xprt          = NULL;
         int32_t              fop_version   = 0;
         int32_t              mgmt_version  = 0;
+        int32_t              compact       = 0;
 
 
         params = dict_new ();
@@ -778,6 +779,20 @@ server_setvolume (rpcsvc_request_t *req)
         if (ret)
                 gf_msg_debug (this->name, 0, "failed to set 'transport-ptr'");
 
+        /* replies stay in the old dict encoding unless both sides want the
+         * compact one */
+        req->trans->peerinfo.compact_dict = _gf_false;
+        if (conf->compact_dict &&
+            dict_get_int32 (params, "dict-encoding-compact", &compact) == 0 &&
+            compact) {
+                ret = dict_set_int32 (reply, "dict-encoding-compact", 1);
+                if (ret)
+                        gf_msg_debug (this->name, 0, "failed to set "
+                                      "'dict-encoding-compact'");
+                else
+                        req->trans->peerinfo.compact_dict = _gf_true;
+        }
+
 fail:
         rsp = GF_CALLOC (1, sizeof (gf_setvolume_rsp),
                          gf_server_mt_setvolume_rsp_t);
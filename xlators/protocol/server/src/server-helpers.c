@@ -2226,10 +2226,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_stat_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 if (!this_args_cbk->op_ret) {
                         server_post_stat (rsp_args,
                                           &this_args_cbk->stat);
@@ -2245,10 +2245,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_readlink_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 if (this_args_cbk->op_ret >= 0) {
                         server_post_readlink (rsp_args, &this_args_cbk->stat,
                                               this_args_cbk->buf);
@@ -2266,10 +2266,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_mknod_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 if (!this_args_cbk->op_ret) {
                         server_post_mknod (state, rsp_args,
                                            &this_args_cbk->stat,
@@ -2288,10 +2288,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_mkdir_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_mkdir (state, rsp_args,
@@ -2312,10 +2312,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_unlink_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 if (!this_args_cbk->op_ret) {
                         server_post_unlink (state, rsp_args,
                                             &this_args_cbk->preparent,
@@ -2332,10 +2332,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_rmdir_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 if (!this_args_cbk->op_ret) {
                         server_post_rmdir (state, rsp_args,
                                             &this_args_cbk->preparent,
@@ -2352,10 +2352,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_symlink_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_symlink (state, rsp_args,
@@ -2376,10 +2376,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_rename_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_rename (frame, state, rsp_args,
@@ -2400,10 +2400,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_link_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_link (state, rsp_args,
@@ -2424,10 +2424,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_truncate_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_truncate (rsp_args,
@@ -2445,10 +2445,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_open_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_open (frame, this, rsp_args,
@@ -2466,10 +2466,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_read_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (this_args_cbk->op_ret >= 0) {
                         server_post_readv (rsp_args, &this_args_cbk->stat,
@@ -2498,10 +2498,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_write_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (this_args_cbk->op_ret >= 0) {
                         server_post_writev (rsp_args,
@@ -2519,10 +2519,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_statfs_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 if (!this_args_cbk->op_ret) {
                         server_post_statfs (rsp_args,
                                             &this_args_cbk->statvfs);
@@ -2538,10 +2538,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_flush_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2553,10 +2553,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fsync_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_fsync (rsp_args,
@@ -2574,10 +2574,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_setxattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2589,17 +2589,17 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_getxattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (-1 != this_args_cbk->op_ret) {
-                        GF_PROTOCOL_DICT_SERIALIZE (this,
-                                                    this_args_cbk->xattr,
-                                                    &rsp_args->dict.dict_val,
-                                                    rsp_args->dict.dict_len,
-                                                    rsp_args->op_errno, out);
+                        SERVER_DICT_SERIALIZE (frame, this,
+                                               this_args_cbk->xattr,
+                                               &rsp_args->dict.dict_val,
+                                               rsp_args->dict.dict_len,
+                                               rsp_args->op_errno, out);
                 }
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
@@ -2612,10 +2612,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_removexattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2627,10 +2627,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_opendir_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_opendir (frame, this, rsp_args,
@@ -2648,10 +2648,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fsyncdir_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2663,10 +2663,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_access_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2678,10 +2678,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_create_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
@@ -2708,10 +2708,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_ftruncate_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_ftruncate (rsp_args,
@@ -2729,10 +2729,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fstat_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 if (!this_args_cbk->op_ret) {
                         server_post_fstat (rsp_args,
                                           &this_args_cbk->stat);
@@ -2748,10 +2748,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_lk_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_lk (this, rsp_args, &this_args_cbk->lock);
@@ -2768,10 +2768,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_lookup_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_lookup (rsp_args, frame, state,
@@ -2790,10 +2790,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_readdir_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
@@ -2815,10 +2815,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_inodelk_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2830,10 +2830,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_finodelk_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2845,10 +2845,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_entrylk_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2860,10 +2860,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fentrylk_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2875,17 +2875,17 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_xattrop_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
-                        GF_PROTOCOL_DICT_SERIALIZE (this,
-                                                    this_args_cbk->xattr,
-                                                    &rsp_args->dict.dict_val,
-                                                    rsp_args->dict.dict_len,
-                                                    rsp_args->op_errno, out);
+                        SERVER_DICT_SERIALIZE (frame, this,
+                                               this_args_cbk->xattr,
+                                               &rsp_args->dict.dict_val,
+                                               rsp_args->dict.dict_len,
+                                               rsp_args->op_errno, out);
                 }
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
@@ -2898,17 +2898,17 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fxattrop_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
-                        GF_PROTOCOL_DICT_SERIALIZE (this,
-                                                    this_args_cbk->xattr,
-                                                    &rsp_args->dict.dict_val,
-                                                    rsp_args->dict.dict_len,
-                                                    rsp_args->op_errno, out);
+                        SERVER_DICT_SERIALIZE (frame, this,
+                                               this_args_cbk->xattr,
+                                               &rsp_args->dict.dict_val,
+                                               rsp_args->dict.dict_len,
+                                               rsp_args->op_errno, out);
                 }
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
@@ -2921,16 +2921,17 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fgetxattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (-1 != this_args_cbk->op_ret) {
-                        GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xattr,
-                                                    &rsp_args->dict.dict_val,
-                                                    rsp_args->dict.dict_len,
-                                                    rsp_args->op_errno, out);
+                        SERVER_DICT_SERIALIZE (frame, this,
+                                               this_args_cbk->xattr,
+                                               &rsp_args->dict.dict_val,
+                                               rsp_args->dict.dict_len,
+                                               rsp_args->op_errno, out);
                 }
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
@@ -2943,10 +2944,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_setxattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -2958,10 +2959,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_rchecksum_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_rchecksum (rsp_args,
@@ -2979,10 +2980,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_setattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_setattr (rsp_args,
@@ -3000,10 +3001,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fsetattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_fsetattr (rsp_args, &this_args_cbk->prestat,
@@ -3020,10 +3021,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_readdirp_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (this_args_cbk->op_ret > 0) {
                         ret = server_post_readdirp (rsp_args,
@@ -3047,10 +3048,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fremovexattr_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -3062,10 +3063,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_fallocate_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_fallocate (rsp_args,
@@ -3083,10 +3084,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_discard_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_discard (rsp_args,
@@ -3104,10 +3105,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_zerofill_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_zerofill (rsp_args,
@@ -3125,10 +3126,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_seek_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
                 rsp_args->op_ret = this_args_cbk->op_ret;
                 rsp_args->op_errno  = gf_errno_to_error
                                       (this_args_cbk->op_errno);
@@ -3140,10 +3141,10 @@ server_populate_compound_response (xlator_t *this, gfs3_compound_rsp *rsp,
 
                 rsp_args = &this_rsp->compound_rsp_u.compound_lease_rsp;
 
-                GF_PROTOCOL_DICT_SERIALIZE (this, this_args_cbk->xdata,
-                                            &rsp_args->xdata.xdata_val,
-                                            rsp_args->xdata.xdata_len,
-                                            rsp_args->op_errno, out);
+                SERVER_DICT_SERIALIZE (frame, this, this_args_cbk->xdata,
+                                       &rsp_args->xdata.xdata_val,
+                                       rsp_args->xdata.xdata_len,
+                                       rsp_args->op_errno, out);
 
                 if (!this_args_cbk->op_ret) {
                         server_post_lease (rsp_args, &this_args_cbk->lease);
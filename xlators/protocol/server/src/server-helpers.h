@@ -18,6 +18,12 @@
 
 #define XPRT_FROM_FRAME(frame) ((rpc_transport_t *) CALL_STATE(frame)->xprt)
 
+/* replies carry dicts in the compact encoding if the client asked for it
+ * in the handshake */
+#define SERVER_DICT_SERIALIZE(frame,this,from_dict,to,len,ope,labl)     \
+        GF_PROTOCOL_DICT_SERIALIZE_FMT (this, from_dict, to, len, ope, labl, \
+                        XPRT_FROM_FRAME(frame)->peerinfo.compact_dict)
+
 #define SERVER_CONF(frame)                                              \
         ((server_conf_t *)XPRT_FROM_FRAME(frame)->this->private)
 
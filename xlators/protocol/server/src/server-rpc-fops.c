@@ -55,8 +55,8 @@ server_statfs_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         gfs3_statfs_rsp      rsp    = {0,};
         rpcsvc_request_t    *req    = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 gf_msg (this->name, GF_LOG_WARNING, op_errno, PS_MSG_STATFS,
@@ -112,8 +112,8 @@ server_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         gf_stat_from_iatt (&rsp.postparent, postparent);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 if (state->is_revalidate && op_errno == ENOENT) {
@@ -191,8 +191,8 @@ server_lease_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req   = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state = CALL_STATE (frame);
@@ -229,8 +229,8 @@ server_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req   = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state = CALL_STATE (frame);
@@ -267,8 +267,8 @@ server_inodelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t   *state     = NULL;
         rpcsvc_request_t *req       = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -305,8 +305,8 @@ server_finodelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t   *state     = NULL;
         rpcsvc_request_t *req       = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -342,8 +342,8 @@ server_entrylk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t   *state     = NULL;
         rpcsvc_request_t *req       = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -380,8 +380,8 @@ server_fentrylk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t   *state     = NULL;
         rpcsvc_request_t *req       = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -418,8 +418,8 @@ server_access_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req   = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state = CALL_STATE (frame);
@@ -455,8 +455,8 @@ server_rmdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state  = NULL;
         rpcsvc_request_t    *req    = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -497,8 +497,8 @@ server_mkdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state      = NULL;
         rpcsvc_request_t    *req        = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -540,8 +540,8 @@ server_mknod_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state      = NULL;
         rpcsvc_request_t    *req        = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -579,8 +579,8 @@ server_fsyncdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -617,8 +617,8 @@ server_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req   = NULL;
         int                  ret   = 0;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -666,8 +666,8 @@ server_opendir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         gfs3_opendir_rsp     rsp      = {0,};
         uint64_t             fd_no    = 0;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -710,8 +710,8 @@ server_removexattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         gf_loglevel_t        loglevel = GF_LOG_NONE;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret == -1) {
                 state = CALL_STATE (frame);
@@ -752,8 +752,8 @@ server_fremovexattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req   = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret == -1) {
                 state = CALL_STATE (frame);
@@ -790,8 +790,8 @@ server_getxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req   = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret == -1) {
                 state = CALL_STATE (frame);
@@ -805,8 +805,8 @@ server_getxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, dict, &rsp.dict.dict_val,
-                                    rsp.dict.dict_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, dict, &rsp.dict.dict_val,
+                               rsp.dict.dict_len, op_errno, out);
 
 out:
         rsp.op_ret        = op_ret;
@@ -833,8 +833,8 @@ server_fgetxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret == -1) {
                 state = CALL_STATE (frame);
@@ -848,8 +848,8 @@ server_fgetxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, dict, &rsp.dict.dict_val,
-                                    rsp.dict.dict_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, dict, &rsp.dict.dict_val,
+                               rsp.dict.dict_len, op_errno, out);
 
 out:
 
@@ -895,8 +895,8 @@ server_setxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t *req = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret == -1) {
                 state = CALL_STATE (frame);
@@ -960,8 +960,8 @@ server_fsetxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t *req = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret == -1) {
                 state = CALL_STATE (frame);
@@ -1009,8 +1009,8 @@ server_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         char         oldpar_str[50]     = {0,};
         char         newpar_str[50]     = {0,};
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -1052,8 +1052,8 @@ server_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state  = NULL;
         rpcsvc_request_t    *req    = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -1098,8 +1098,8 @@ server_symlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state      = NULL;
         rpcsvc_request_t    *req        = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -1143,8 +1143,8 @@ server_link_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         char              gfid_str[50]   = {0,};
         char              newpar_str[50] = {0,};
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -1186,8 +1186,8 @@ server_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state = CALL_STATE (frame);
@@ -1225,8 +1225,8 @@ server_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state = CALL_STATE (frame);
@@ -1264,8 +1264,8 @@ server_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state = CALL_STATE (frame);
@@ -1302,8 +1302,8 @@ server_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1340,8 +1340,8 @@ server_fsync_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1379,8 +1379,8 @@ server_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1430,8 +1430,8 @@ server_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                                        "testing-xdata-value");
         }
 #endif
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1470,8 +1470,8 @@ server_rchecksum_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req   = NULL;
         server_state_t      *state = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1508,8 +1508,8 @@ server_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         rpcsvc_request_t    *req      = NULL;
         gfs3_open_rsp        rsp      = {0,};
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1550,8 +1550,8 @@ server_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         uint64_t             fd_no      = 0;
         gfs3_create_rsp      rsp        = {0,};
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         state = CALL_STATE (frame);
 
@@ -1603,8 +1603,8 @@ server_readlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1642,8 +1642,8 @@ server_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state  = CALL_STATE (frame);
@@ -1681,8 +1681,8 @@ server_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state = CALL_STATE (frame);
@@ -1719,8 +1719,8 @@ server_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state  = CALL_STATE (frame);
@@ -1759,8 +1759,8 @@ server_xattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1774,8 +1774,8 @@ server_xattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, dict, &rsp.dict.dict_val,
-                                    rsp.dict.dict_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, dict, &rsp.dict.dict_val,
+                               rsp.dict.dict_len, op_errno, out);
 
 out:
         rsp.op_ret        = op_ret;
@@ -1802,8 +1802,8 @@ server_fxattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t      *state = NULL;
         rpcsvc_request_t    *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1817,8 +1817,8 @@ server_fxattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, dict, &rsp.dict.dict_val,
-                                    rsp.dict.dict_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, dict, &rsp.dict.dict_val,
+                               rsp.dict.dict_len, op_errno, out);
 
 out:
         rsp.op_ret        = op_ret;
@@ -1848,8 +1848,8 @@ server_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         state = CALL_STATE (frame);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -1899,8 +1899,8 @@ server_fallocate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t    *state = NULL;
         rpcsvc_request_t  *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state  = CALL_STATE (frame);
@@ -1938,8 +1938,8 @@ server_discard_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         server_state_t    *state = NULL;
         rpcsvc_request_t  *req   = NULL;
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 state  = CALL_STATE (frame);
@@ -1980,8 +1980,8 @@ server_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         req = frame->local;
         state  = CALL_STATE (frame);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, (&rsp.xdata.xdata_val),
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 gf_msg (this->name, fop_log_level (GF_FOP_ZEROFILL, op_errno),
@@ -2021,8 +2021,8 @@ server_ipc_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         req = frame->local;
         state  = CALL_STATE (frame);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, (&rsp.xdata.xdata_val),
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 gf_msg (this->name, GF_LOG_INFO, op_errno,
@@ -2060,8 +2060,8 @@ server_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         req = frame->local;
         state  = CALL_STATE (frame);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, (&rsp.xdata.xdata_val),
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 gf_msg (this->name, fop_log_level (GF_FOP_SEEK, op_errno),
@@ -2098,8 +2098,8 @@ server_setactivelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         state = CALL_STATE (frame);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
@@ -2141,8 +2141,8 @@ server_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         req = frame->local;
         state  = CALL_STATE (frame);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, (&rsp.xdata.xdata_val),
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret) {
                 gf_msg (this->name, fop_log_level (GF_FOP_COMPOUND, op_errno),
@@ -3293,8 +3293,8 @@ server_getactivelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         state = CALL_STATE (frame);
 
-        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
-                                    rsp.xdata.xdata_len, op_errno, out);
+        SERVER_DICT_SERIALIZE (frame, this, xdata, &rsp.xdata.xdata_val,
+                               rsp.xdata.xdata_len, op_errno, out);
 
         if (op_ret < 0) {
                 state = CALL_STATE (frame);
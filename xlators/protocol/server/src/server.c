@@ -154,6 +154,7 @@ server_submit_reply (call_frame_t *frame, rpcsvc_request_t *req, void *arg,
                 state = CALL_STATE (frame);
                 frame->local = NULL;
                 client = frame->root->client;
+                req->queue_delay = frame->root->queue_delay;
         }
 
         if (client)
@@ -292,6 +293,45 @@ out:
         return ret;
 }
 
+/* racy reads, but these are only meant for eyeballing */
+static void
+server_flow_dump (server_conf_t *conf)
+{
+        rpc_transport_t  *xprt = NULL;
+        char              key[GF_DUMP_MAX_BUF_LEN] = {0,};
+        int               count = 0;
+
+        if (pthread_mutex_trylock (&conf->mutex) != 0)
+                return;
+        {
+                list_for_each_entry (xprt, &conf->xprt_list, list) {
+                        gf_proc_dump_build_key (key, "client", "%d.peer",
+                                                count);
+                        gf_proc_dump_write (key, "%s",
+                                            xprt->peerinfo.identifier);
+                        gf_proc_dump_build_key (key, "client",
+                                                "%d.flow-window", count);
+                        gf_proc_dump_write (key, "%d", xprt->flow.window);
+                        gf_proc_dump_build_key (key, "client",
+                                                "%d.outstanding", count);
+                        gf_proc_dump_write (key, "%d",
+                                            xprt->outstanding_rpc_count);
+                        gf_proc_dump_build_key (key, "client",
+                                                "%d.throttled", count);
+                        gf_proc_dump_write (key, "%d", xprt->flow.throttled);
+                        gf_proc_dump_build_key (key, "client",
+                                                "%d.window-grown", count);
+                        gf_proc_dump_write (key, "%"PRIu64, xprt->flow.grown);
+                        gf_proc_dump_build_key (key, "client",
+                                                "%d.window-shrunk", count);
+                        gf_proc_dump_write (key, "%"PRIu64,
+                                            xprt->flow.shrunk);
+                        count++;
+                }
+        }
+        pthread_mutex_unlock (&conf->mutex);
+}
+
 int
 server_priv (xlator_t *this)
 {
@@ -328,6 +368,9 @@ server_priv (xlator_t *this)
         gf_proc_dump_build_key(key, "server", "total-bytes-write");
         gf_proc_dump_write(key, "%"PRIu64, total_write);
 
+        if (conf->rpc && conf->rpc->flow_control)
+                server_flow_dump (conf);
+
         ret = 0;
 out:
         if (ret)
@@ -886,6 +929,10 @@ do_rpc:
         GF_OPTION_RECONF ("dynamic-auth", conf->dync_auth, options,
                         bool, out);
 
+        /* takes effect on the next connect of each client */
+        GF_OPTION_RECONF ("compact-dict", conf->compact_dict, options,
+                          bool, out);
+
         if (conf->dync_auth) {
                 pthread_mutex_lock (&conf->mutex);
                 {
@@ -963,6 +1010,13 @@ do_rpc:
                 goto out;
         }
 
+        ret = rpcsvc_set_flow_control (rpc_conf, options, _gf_false);
+        if (ret < 0) {
+                gf_msg (this->name, GF_LOG_ERROR, 0, PS_MSG_RPC_CONF_ERROR,
+                        "Failed to reconfigure flow-control");
+                goto out;
+        }
+
         list_for_each_entry (listeners, &(rpc_conf->listeners), list) {
                 if (listeners->trans != NULL) {
                         if (listeners->trans->reconfigure )
@@ -1120,6 +1174,8 @@ init (xlator_t *this)
         else
                 conf->dync_auth = ret;
 
+        GF_OPTION_INIT ("compact-dict", conf->compact_dict, bool, out);
+
         /* RPC related */
         conf->rpc = rpcsvc_init (this, this->ctx, this->options, 0);
         if (conf->rpc == NULL) {
@@ -1138,6 +1194,13 @@ init (xlator_t *this)
                 goto out;
         }
 
+        ret = rpcsvc_set_flow_control (conf->rpc, this->options, _gf_false);
+        if (ret < 0) {
+                gf_msg (this->name, GF_LOG_ERROR, 0, PS_MSG_RPC_CONF_ERROR,
+                        "Failed to configure flow-control");
+                goto out;
+        }
+
         /*
          * This is the only place where we want secure_srvr to reflect
          * the data-plane setting.
@@ -1639,6 +1702,23 @@ struct volume_options options[] = {
                          "requests from a client. 0 means no limit (can "
                          "potentially run out of memory)"
         },
+        { .key  = {"rpc.flow-control"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Size the number of requests a client may have "
+                         "outstanding from the time requests wait in the "
+                         "brick's queues. rpc.outstanding-rpc-limit is then "
+                         "only the starting point of each client's window."
+        },
+        { .key  = {"rpc.flow-target-delay"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = RPCSVC_MAX_FLOW_TARGET,
+          .default_value = TOSTRING(RPCSVC_DEFAULT_FLOW_TARGET),
+          .description = "Queueing delay, in milliseconds, a client's "
+                         "requests may see for a whole interval before "
+                         "rpc.flow-control shrinks its window."
+        },
         { .key   = {"manage-gids"},
           .type  = GF_OPTION_TYPE_BOOL,
           .default_value = "off",
@@ -1667,5 +1747,12 @@ struct volume_options options[] = {
                            "transport connection immediately in response to "
                            "*.allow | *.reject volume set options."
         },
+        { .key   = {"compact-dict"},
+          .type  = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description   = "Exchange dictionaries in the compact encoding "
+                           "with clients that support it, which sends "
+                           "well-known keys as small numbers."
+        },
         { .key   = {NULL} },
 };
@@ -105,6 +105,9 @@ struct server_conf {
                                            * false, when child is down */
 
         gf_lock_t               itable_lock;
+
+        gf_boolean_t            compact_dict; /* offer clients the compact
+                                               * dict encoding */
 };
 typedef struct server_conf server_conf_t;
 
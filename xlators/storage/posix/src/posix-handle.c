@@ -17,6 +17,8 @@
 #endif
 
 #include "common-utils.h"
+#include "hashfn.h"
+#include "statedump.h"
 
 #include "posix-handle.h"
 #include "posix.h"
@@ -364,6 +366,571 @@ err:
 }
 
 
+/* Entries are also hashed by the directory they are in, @parent: an entry
+ * (@key, @name) is in @key, the path of a directory (@key, "") in the
+ * directory its handle points into.  Dropping the path of a directory
+ * drops the paths below it, so that the directories whose path is cached
+ * are always a tree hanging off the brick root.
+ */
+typedef struct posix_handle_cache_entry {
+        struct list_head  hash;
+        struct list_head  sibling; /* in the pbuckets of @parent */
+        struct list_head  lru;
+        uint32_t          hashval;
+        uuid_t            key;     /* parent's gfid, or the directory's own */
+        uuid_t            parent;
+        uuid_t            gfid;
+        ino_t             ino;
+        char             *path;    /* of a directory, keyed with name "" */
+        char              name[];
+} posix_handle_cache_entry_t;
+
+
+#define POSIX_HANDLE_CACHE(this) \
+        (&((struct posix_private *)this->private)->handle_cache)
+
+/* parent handles readlink()ed at most to resolve one directory */
+#define POSIX_HANDLE_CACHE_DEPTH 64
+
+
+static uint32_t
+posix_handle_cache_hash (uuid_t key, const char *name)
+{
+        uint32_t hashval = 0;
+
+        memcpy (&hashval, &key[12], sizeof (hashval));
+        if (name[0])
+                hashval ^= gf_dm_hashfn (name, strlen (name));
+
+        return hashval;
+}
+
+
+static posix_handle_cache_entry_t *
+__posix_handle_cache_find (struct posix_handle_cache *cache, uuid_t key,
+                           const char *name, uint32_t hashval)
+{
+        posix_handle_cache_entry_t *entry  = NULL;
+        struct list_head           *bucket = NULL;
+
+        bucket = &cache->buckets[hashval & (cache->nbuckets - 1)];
+
+        list_for_each_entry (entry, bucket, hash) {
+                if (entry->hashval == hashval &&
+                    gf_uuid_compare (entry->key, key) == 0 &&
+                    strcmp (entry->name, name) == 0) {
+                        list_move (&entry->lru, &cache->lru);
+                        return entry;
+                }
+        }
+
+        return NULL;
+}
+
+
+static void
+__posix_handle_cache_drop_below (struct posix_handle_cache *cache,
+                                 uuid_t dir, gf_boolean_t names);
+
+static void
+__posix_handle_cache_drop (struct posix_handle_cache *cache,
+                           posix_handle_cache_entry_t *entry)
+{
+        uuid_t  dir = {0,};
+
+        if (entry->path)
+                gf_uuid_copy (dir, entry->key);
+
+        list_del (&entry->hash);
+        list_del (&entry->sibling);
+        list_del (&entry->lru);
+        cache->count--;
+        GF_FREE (entry);
+
+        if (!gf_uuid_is_null (dir))
+                __posix_handle_cache_drop_below (cache, dir, _gf_false);
+}
+
+
+/* Drops the paths of the directories below @dir and, with @names, what is
+ * cached of the entries in them and in @dir. */
+static void
+__posix_handle_cache_drop_below (struct posix_handle_cache *cache,
+                                 uuid_t dir, gf_boolean_t names)
+{
+        posix_handle_cache_entry_t *entry  = NULL;
+        struct list_head           *bucket = NULL;
+        uuid_t                      child  = {0,};
+
+        bucket = &cache->pbuckets[posix_handle_cache_hash (dir, "") &
+                                  (cache->nbuckets - 1)];
+again:
+        list_for_each_entry (entry, bucket, sibling) {
+                if (gf_uuid_compare (entry->parent, dir) != 0)
+                        continue;
+                if (!entry->path && !names)
+                        continue;
+
+                gf_uuid_copy (child, entry->path ? entry->key : entry->gfid);
+                __posix_handle_cache_drop (cache, entry);
+                if (names)
+                        __posix_handle_cache_drop_below (cache, child,
+                                                         _gf_true);
+                /* that may have taken anything off the bucket */
+                goto again;
+        }
+}
+
+
+static posix_handle_cache_entry_t *
+__posix_handle_cache_add (struct posix_handle_cache *cache, uuid_t key,
+                          const char *name, uuid_t parent, int pathlen)
+{
+        posix_handle_cache_entry_t *entry   = NULL;
+        uint32_t                    hashval = 0;
+        int                         namelen = strlen (name);
+
+        hashval = posix_handle_cache_hash (key, name);
+
+        entry = __posix_handle_cache_find (cache, key, name, hashval);
+        if (entry)
+                __posix_handle_cache_drop (cache, entry);
+
+        while (cache->count >= cache->size)
+                __posix_handle_cache_drop (cache,
+                                           list_entry (cache->lru.prev,
+                                                       posix_handle_cache_entry_t,
+                                                       lru));
+
+        entry = GF_MALLOC (sizeof (*entry) + namelen + 1 +
+                           (pathlen ? pathlen + 1 : 0),
+                           gf_posix_mt_handle_cache_entry_t);
+        if (!entry)
+                return NULL;
+
+        entry->hashval = hashval;
+        gf_uuid_copy (entry->key, key);
+        gf_uuid_copy (entry->parent, parent);
+        memcpy (entry->name, name, namelen + 1);
+        entry->path = pathlen ? &entry->name[namelen + 1] : NULL;
+
+        list_add (&entry->hash,
+                  &cache->buckets[hashval & (cache->nbuckets - 1)]);
+        list_add (&entry->sibling,
+                  &cache->pbuckets[posix_handle_cache_hash (parent, "") &
+                                   (cache->nbuckets - 1)]);
+        list_add (&entry->lru, &cache->lru);
+        cache->count++;
+
+        return entry;
+}
+
+
+int
+posix_handle_cache_init (xlator_t *this, uint32_t size)
+{
+        struct posix_handle_cache *cache    = POSIX_HANDLE_CACHE (this);
+        struct list_head          *buckets  = NULL;
+        uint32_t                   nbuckets = 64;
+        uint32_t                   i        = 0;
+
+        while (nbuckets < size / 2)
+                nbuckets <<= 1;
+
+        if (size) {
+                /* by key, then by parent */
+                buckets = GF_CALLOC (2 * nbuckets, sizeof (*buckets),
+                                     gf_posix_mt_handle_cache_t);
+                if (!buckets)
+                        return -1;
+                for (i = 0; i < 2 * nbuckets; i++)
+                        INIT_LIST_HEAD (&buckets[i]);
+        }
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                if (cache->buckets)
+                        while (!list_empty (&cache->lru))
+                                __posix_handle_cache_drop (cache,
+                                        list_entry (cache->lru.next,
+                                                    posix_handle_cache_entry_t,
+                                                    lru));
+                GF_FREE (cache->buckets);
+
+                cache->buckets = buckets;
+                cache->pbuckets = buckets ? &buckets[nbuckets] : NULL;
+                cache->nbuckets = nbuckets;
+                cache->size = size;
+                cache->gen++;
+        }
+        pthread_mutex_unlock (&cache->lock);
+
+        return 0;
+}
+
+
+void
+posix_handle_cache_fini (xlator_t *this)
+{
+        struct posix_handle_cache *cache = POSIX_HANDLE_CACHE (this);
+
+        posix_handle_cache_init (this, 0);
+        pthread_mutex_destroy (&cache->lock);
+}
+
+
+/* Returns 0 and fills @gfid when (@pargfid, @name) is known to be the
+ * inode @stbuf was taken of.  Otherwise @gen is what to pass
+ * posix_handle_cache_gfid_set() with the gfid read from disk.
+ */
+int
+posix_handle_cache_gfid_get (xlator_t *this, uuid_t pargfid, const char *name,
+                             struct stat *stbuf, uuid_t gfid, uint64_t *gen)
+{
+        struct posix_handle_cache  *cache   = POSIX_HANDLE_CACHE (this);
+        posix_handle_cache_entry_t *entry   = NULL;
+        uint32_t                    hashval = 0;
+        int                         ret     = -1;
+
+        hashval = posix_handle_cache_hash (pargfid, name);
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                *gen = cache->gen;
+                if (!cache->buckets)
+                        goto unlock;
+
+                entry = __posix_handle_cache_find (cache, pargfid, name,
+                                                   hashval);
+                if (entry && entry->ino != stbuf->st_ino) {
+                        __posix_handle_cache_drop (cache, entry);
+                        entry = NULL;
+                }
+
+                if (entry) {
+                        gf_uuid_copy (gfid, entry->gfid);
+                        cache->gfid_hits++;
+                        ret = 0;
+                } else {
+                        cache->gfid_misses++;
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&cache->lock);
+
+        return ret;
+}
+
+
+void
+posix_handle_cache_gfid_set (xlator_t *this, uuid_t pargfid, const char *name,
+                             struct stat *stbuf, uuid_t gfid, uint64_t gen)
+{
+        struct posix_handle_cache  *cache = POSIX_HANDLE_CACHE (this);
+        posix_handle_cache_entry_t *entry = NULL;
+
+        if (gf_uuid_is_null (gfid))
+                return;
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                if (!cache->buckets || cache->gen != gen)
+                        goto unlock;
+
+                entry = __posix_handle_cache_add (cache, pargfid, name,
+                                                  pargfid, 0);
+                if (entry) {
+                        gf_uuid_copy (entry->gfid, gfid);
+                        entry->ino = stbuf->st_ino;
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&cache->lock);
+}
+
+
+static void
+posix_handle_cache_forget_key (xlator_t *this, uuid_t key, const char *name)
+{
+        struct posix_handle_cache  *cache   = POSIX_HANDLE_CACHE (this);
+        posix_handle_cache_entry_t *entry   = NULL;
+        uint32_t                    hashval = 0;
+
+        hashval = posix_handle_cache_hash (key, name);
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                cache->gen++;
+                if (!cache->buckets)
+                        goto unlock;
+
+                entry = __posix_handle_cache_find (cache, key, name, hashval);
+                if (entry)
+                        __posix_handle_cache_drop (cache, entry);
+        }
+unlock:
+        pthread_mutex_unlock (&cache->lock);
+}
+
+
+void
+posix_handle_cache_forget (xlator_t *this, uuid_t pargfid, const char *name)
+{
+        if (!pargfid || gf_uuid_is_null (pargfid) || !name)
+                return;
+
+        posix_handle_cache_forget_key (this, pargfid, name);
+}
+
+
+void
+posix_handle_cache_forget_path (xlator_t *this, uuid_t gfid)
+{
+        posix_handle_cache_forget_key (this, gfid, "");
+}
+
+
+/* Directory @gfid moved, and with it the path of everything below it.
+ * With @removed it went to the landfill, and the entries below it are
+ * forgotten as well. */
+void
+posix_handle_cache_forget_dir (xlator_t *this, uuid_t gfid,
+                               gf_boolean_t removed)
+{
+        struct posix_handle_cache  *cache = POSIX_HANDLE_CACHE (this);
+        posix_handle_cache_entry_t *entry = NULL;
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                cache->gen++;
+                if (!cache->buckets)
+                        goto unlock;
+
+                entry = __posix_handle_cache_find (cache, gfid, "",
+                                         posix_handle_cache_hash (gfid, ""));
+                if (entry)
+                        __posix_handle_cache_drop (cache, entry);
+
+                if (removed)
+                        __posix_handle_cache_drop_below (cache, gfid,
+                                                         _gf_true);
+        }
+unlock:
+        pthread_mutex_unlock (&cache->lock);
+}
+
+
+static const char *
+__posix_handle_cache_path (xlator_t *this, struct posix_handle_cache *cache,
+                           uuid_t gfid)
+{
+        struct posix_private       *priv  = this->private;
+        posix_handle_cache_entry_t *entry = NULL;
+
+        if (__is_root_gfid (gfid))
+                return priv->base_path;
+
+        entry = __posix_handle_cache_find (cache, gfid, "",
+                                           posix_handle_cache_hash (gfid, ""));
+
+        return entry ? entry->path : NULL;
+}
+
+
+/* Copies the real path of directory @gfid into @buf, followed by
+ * "/@basename" when given, if it is cached and fits.
+ */
+static int
+posix_handle_cache_path_get (xlator_t *this, uuid_t gfid, const char *basename,
+                             char *buf, int maxlen, uint64_t *gen)
+{
+        struct posix_handle_cache  *cache   = POSIX_HANDLE_CACHE (this);
+        const char                 *path    = NULL;
+        int                         len     = -1;
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                *gen = cache->gen;
+                if (!cache->buckets)
+                        goto unlock;
+
+                path = __posix_handle_cache_path (this, cache, gfid);
+                if (!path)
+                        goto unlock;
+
+                if (basename)
+                        len = snprintf (buf, maxlen, "%s/%s", path, basename);
+                else
+                        len = snprintf (buf, maxlen, "%s", path);
+
+                if (len >= maxlen) {
+                        len = -1;
+                        goto unlock;
+                }
+                cache->path_hits++;
+        }
+unlock:
+        pthread_mutex_unlock (&cache->lock);
+
+        return len;
+}
+
+
+/* Walks the handle symlinks from directory @gfid up to the brick root, or
+ * to the first directory whose path is cached, and caches the real path
+ * of every directory on the way.  The path of @gfid, with "/@basename"
+ * when given, goes to @buf if it fits.
+ */
+static int
+posix_handle_cache_resolve (xlator_t *this, uuid_t gfid, const char *basename,
+                            char *buf, int maxlen, uint64_t gen)
+{
+        struct posix_private       *priv     = this->private;
+        struct posix_handle_cache  *cache    = POSIX_HANDLE_CACHE (this);
+        posix_handle_cache_entry_t *entry    = NULL;
+        char                        linkname[512]   = {0,};
+        char                        uuid_str[GF_UUID_BUF_SIZE] = {0,};
+        uuid_t                      dirs[POSIX_HANDLE_CACHE_DEPTH];
+        int                         ends[POSIX_HANDLE_CACHE_DEPTH];
+        uuid_t                      cur      = {0,};
+        char                       *handle   = NULL;
+        char                       *prefix   = NULL;
+        char                       *tail     = NULL;
+        const char                 *path     = NULL;
+        int                         prefix_len = 0;
+        int                         pos      = PATH_MAX - 1;
+        int                         depth    = 0;
+        int                         len      = 0;
+        int                         ret      = 0;
+        int                         i        = 0;
+
+        MAKE_HANDLE_ABSPATH (handle, this, gfid);
+        prefix = alloca (PATH_MAX);
+        tail = alloca (PATH_MAX);
+        tail[pos] = '\0';
+
+        gf_uuid_copy (cur, gfid);
+
+        /* build the path from its end, one parent handle at a time */
+        for (;;) {
+                pthread_mutex_lock (&cache->lock);
+                {
+                        path = cache->buckets ?
+                                __posix_handle_cache_path (this, cache, cur) :
+                                NULL;
+                        if (path)
+                                prefix_len = snprintf (prefix, PATH_MAX, "%s",
+                                                       path);
+                }
+                pthread_mutex_unlock (&cache->lock);
+
+                if (path)
+                        break;
+
+                if (depth == POSIX_HANDLE_CACHE_DEPTH)
+                        return -1;
+
+                snprintf (handle, HANDLE_ABSPATH_LEN (this), "%s/%s/%02x/%02x/%s",
+                          priv->base_path, GF_HIDDEN_PATH, cur[0], cur[1],
+                          uuid_utoa (cur));
+                ret = sys_readlink (handle, linkname, sizeof (linkname) - 1);
+                if (ret == -1)
+                        return -1;
+                linkname[ret] = '\0';
+
+                if (ret < 50 || posix_is_malformed_link (this, handle,
+                                                         linkname, ret))
+                        return -1;
+
+                len = ret - 49;
+                if (pos - len - 1 < 0)
+                        return -1;
+
+                gf_uuid_copy (dirs[depth], cur);
+                ends[depth] = pos;
+                depth++;
+
+                pos -= len;
+                memcpy (&tail[pos], &linkname[49], len);
+                tail[--pos] = '/';
+
+                memcpy (uuid_str, &linkname[12], 36);
+                uuid_str[36] = '\0';
+                if (gf_uuid_parse (uuid_str, cur))
+                        return -1;
+        }
+
+        len = prefix_len + (PATH_MAX - 1 - pos);
+        if (basename)
+                len += 1 + strlen (basename);
+        if (len >= maxlen)
+                return -1;
+
+        if (basename)
+                snprintf (buf, maxlen, "%s%s/%s", prefix, &tail[pos],
+                          basename);
+        else
+                snprintf (buf, maxlen, "%s%s", prefix, &tail[pos]);
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                cache->path_misses++;
+
+                /* a directory above moved while we were reading links */
+                if (!cache->buckets || cache->gen != gen)
+                        goto unlock;
+
+                /* from the top, each under a parent still cached */
+                for (i = depth - 1; i >= 0; i--) {
+                        ret = prefix_len + (ends[i] - pos);
+                        entry = __posix_handle_cache_add (cache, dirs[i], "",
+                                                          cur, ret);
+                        if (!entry)
+                                break;
+                        memcpy (entry->path, prefix, prefix_len);
+                        memcpy (entry->path + prefix_len, &tail[pos],
+                                ends[i] - pos);
+                        entry->path[ret] = '\0';
+                        gf_uuid_copy (entry->gfid, dirs[i]);
+                        entry->ino = 0;
+                        /* making room may have pushed the parent out */
+                        if (!__posix_handle_cache_path (this, cache, cur)) {
+                                __posix_handle_cache_drop (cache, entry);
+                                break;
+                        }
+                        gf_uuid_copy (cur, dirs[i]);
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&cache->lock);
+
+        return len;
+}
+
+
+void
+posix_handle_cache_dump (xlator_t *this)
+{
+        struct posix_handle_cache *cache = POSIX_HANDLE_CACHE (this);
+
+        pthread_mutex_lock (&cache->lock);
+        {
+                gf_proc_dump_write ("handle_cache_size", "%u", cache->size);
+                gf_proc_dump_write ("handle_cache_entries", "%u",
+                                    cache->count);
+                gf_proc_dump_write ("handle_cache_gfid_hits", "%"PRIu64,
+                                    cache->gfid_hits);
+                gf_proc_dump_write ("handle_cache_gfid_misses", "%"PRIu64,
+                                    cache->gfid_misses);
+                gf_proc_dump_write ("handle_cache_path_hits", "%"PRIu64,
+                                    cache->path_hits);
+                gf_proc_dump_write ("handle_cache_path_misses", "%"PRIu64,
+                                    cache->path_misses);
+        }
+        pthread_mutex_unlock (&cache->lock);
+}
+
+
 /*
   posix_handle_path differs from posix_handle_gfid_path in the way that the
   path filled in @buf by posix_handle_path will return type IA_IFDIR when
@@ -371,6 +938,9 @@ err:
   to the handle symlink (typically used for the purpose of unlinking it).
 
   posix_handle_path also guarantees immunity to ELOOP on the path returned by it
+
+  For a directory the path is its real one under the brick, from the handle
+  cache, so that using it does not walk the chain of parent handles again.
 */
 
 int
@@ -387,6 +957,7 @@ posix_handle_path (xlator_t *this, uuid_t gfid, const char *basename,
         int                   pfx_len;
         int                   maxlen;
         char                 *buf;
+        uint64_t              gen = 0;
 
         priv = this->private;
 
@@ -400,6 +971,11 @@ posix_handle_path (xlator_t *this, uuid_t gfid, const char *basename,
                 buf = alloca (maxlen);
         }
 
+        len = posix_handle_cache_path_get (this, gfid, basename, buf, maxlen,
+                                           &gen);
+        if (len >= 0)
+                goto out;
+
         base_len = (priv->base_path_length + SLEN(GF_HIDDEN_PATH) + 45);
         base_str = alloca (base_len + 1);
         base_len = snprintf (base_str, base_len + 1, "%s/%s/%02x/%02x/%s",
@@ -419,6 +995,15 @@ posix_handle_path (xlator_t *this, uuid_t gfid, const char *basename,
         if (!(ret == 0 && S_ISLNK(stat.st_mode) && stat.st_nlink == 1))
                 goto out;
 
+        if (priv->handle_cache.size) {
+                ret = posix_handle_cache_resolve (this, gfid, basename, buf,
+                                                  maxlen, gen);
+                if (ret >= 0) {
+                        len = ret;
+                        goto out;
+                }
+        }
+
         do {
                 errno = 0;
                 ret = posix_handle_pump (this, buf, len, maxlen,
@@ -902,6 +1487,7 @@ posix_handle_unset_gfid (xlator_t *this, uuid_t gfid)
         }
 
 out:
+        posix_handle_cache_forget_path (this, gfid);
         return ret;
 }
 
@@ -1011,3 +1597,4 @@ unlock:
 
         return ret;
 }
+
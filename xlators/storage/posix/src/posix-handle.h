@@ -30,6 +30,28 @@
                                   SLEN("/" GF_HIDDEN_PATH "/00/00/" \
                                   UUID0_STR) + 1)
 
+/* Bounded LRU of what the handle namespace would otherwise tell us with
+ * a syscall: (parent gfid, name) -> gfid of the entry, checked against the
+ * entry's st_ino before use, and gfid -> real path of a directory, where
+ * its handle symlink chain ends.  Entry operations of this xlator forget
+ * what they change; @gen moves on with every forget, and results worked
+ * out before that are not inserted.
+ */
+struct posix_handle_cache {
+        pthread_mutex_t    lock;
+        struct list_head  *buckets;
+        struct list_head  *pbuckets;   /* by parent directory */
+        uint32_t           nbuckets;
+        uint32_t           size;
+        uint32_t           count;
+        struct list_head   lru;
+        uint64_t           gen;
+        uint64_t           gfid_hits;
+        uint64_t           gfid_misses;
+        uint64_t           path_hits;
+        uint64_t           path_misses;
+};
+
 #define LOC_HAS_ABSPATH(loc) (loc && (loc->path) && (loc->path[0] == '/'))
 #define LOC_IS_DIR(loc) (loc && (loc->inode) && \
                 (loc->inode->ia_type == IA_IFDIR))
@@ -221,7 +243,8 @@
                 MAKE_REAL_PATH (entp, this, loc->path);                 \
                 __parp = strdupa (entp);                                \
                 parp = dirname (__parp);                                \
-                op_ret = posix_pstat (this, NULL, entp, ent_p);         \
+                op_ret = posix_pstat_entry (this, loc->pargfid, entp,   \
+                                            ent_p);                     \
                 break;                                                  \
         }                                                               \
         errno = 0;                                                      \
@@ -285,4 +308,31 @@ int posix_create_link_if_gfid_exists (xlator_t *this, uuid_t gfid,
 
 int
 posix_handle_trash_init (xlator_t *this);
+
+int
+posix_handle_cache_init (xlator_t *this, uint32_t size);
+
+void
+posix_handle_cache_fini (xlator_t *this);
+
+int
+posix_handle_cache_gfid_get (xlator_t *this, uuid_t pargfid, const char *name,
+                             struct stat *stbuf, uuid_t gfid, uint64_t *gen);
+
+void
+posix_handle_cache_gfid_set (xlator_t *this, uuid_t pargfid, const char *name,
+                             struct stat *stbuf, uuid_t gfid, uint64_t gen);
+
+void
+posix_handle_cache_forget (xlator_t *this, uuid_t pargfid, const char *name);
+
+void
+posix_handle_cache_forget_path (xlator_t *this, uuid_t gfid);
+
+void
+posix_handle_cache_forget_dir (xlator_t *this, uuid_t gfid,
+                               gf_boolean_t removed);
+
+void
+posix_handle_cache_dump (xlator_t *this);
 #endif /* !_POSIX_HANDLE_H */
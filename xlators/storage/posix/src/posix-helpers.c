@@ -490,6 +490,26 @@ posix_fill_gfid_path (xlator_t *this, const char *path, struct iatt *iatt)
 }
 
 
+/* gfid of @name in directory @pargfid, of which @lstatbuf was just taken;
+ * from the handle cache when it knows that inode under that name.
+ */
+static void
+posix_fill_gfid_entry (xlator_t *this, uuid_t pargfid, const char *name,
+                       const char *path, struct stat *lstatbuf,
+                       struct iatt *iatt)
+{
+        uint64_t gen = 0;
+
+        if (posix_handle_cache_gfid_get (this, pargfid, name, lstatbuf,
+                                         iatt->ia_gfid, &gen) == 0)
+                return;
+
+        posix_fill_gfid_path (this, path, iatt);
+        posix_handle_cache_gfid_set (this, pargfid, name, lstatbuf,
+                                     iatt->ia_gfid, gen);
+}
+
+
 int
 posix_fill_gfid_fd (xlator_t *this, int fd, struct iatt *iatt)
 {
@@ -606,7 +626,8 @@ posix_istat (xlator_t *this, uuid_t gfid, const char *basename,
         iatt_from_stat (&stbuf, &lstatbuf);
 
         if (basename)
-                posix_fill_gfid_path (this, real_path, &stbuf);
+                posix_fill_gfid_entry (this, gfid, basename, real_path,
+                                       &lstatbuf, &stbuf);
         else
                 gf_uuid_copy (stbuf.ia_gfid, gfid);
 
@@ -623,10 +644,34 @@ out:
 int
 posix_pstat (xlator_t *this, uuid_t gfid, const char *path,
              struct iatt *buf_p)
+{
+        return posix_pstatat (this, AT_FDCWD, path, gfid, NULL, path, buf_p);
+}
+
+/* posix_pstat () of @path, an entry of directory @pargfid, whose gfid
+ * the handle cache may know.
+ */
+int
+posix_pstat_entry (xlator_t *this, uuid_t pargfid, const char *path,
+                   struct iatt *buf_p)
+{
+        return posix_pstatat (this, AT_FDCWD, path, NULL, pargfid, path,
+                              buf_p);
+}
+
+/* posix_pstat () of @name in the directory open at @dirfd, without
+ * walking the path again for the stat. @path names the same entry and is
+ * used for the gfid xattr, which has no *at() call.  When the gfid is not
+ * given, the directory's @pargfid keys it in the handle cache.
+ */
+int
+posix_pstatat (xlator_t *this, int dirfd, const char *name, uuid_t gfid,
+               uuid_t pargfid, const char *path, struct iatt *buf_p)
 {
         struct stat  lstatbuf = {0, };
         struct iatt  stbuf = {0, };
         int          ret = 0;
+        const char  *basename = NULL;
         struct posix_private *priv = NULL;
 
 
@@ -634,10 +679,13 @@ posix_pstat (xlator_t *this, uuid_t gfid, const char *path,
 
         if (gfid && !gf_uuid_is_null (gfid))
                 gf_uuid_copy (stbuf.ia_gfid, gfid);
-        else
+        else if (pargfid && !gf_uuid_is_null (pargfid)) {
+                basename = strrchr (name, '/');
+                basename = basename ? basename + 1 : name;
+        } else
                 posix_fill_gfid_path (this, path, &stbuf);
 
-        ret = sys_lstat (path, &lstatbuf);
+        ret = sys_fstatat (dirfd, name, &lstatbuf, AT_SYMLINK_NOFOLLOW);
 
         if (ret != 0) {
                 if (ret == -1) {
@@ -667,6 +715,10 @@ posix_pstat (xlator_t *this, uuid_t gfid, const char *path,
         if (!S_ISDIR (lstatbuf.st_mode))
                 lstatbuf.st_nlink --;
 
+        if (basename)
+                posix_fill_gfid_entry (this, pargfid, basename, path,
+                                       &lstatbuf, &stbuf);
+
         iatt_from_stat (&stbuf, &lstatbuf);
 
         posix_fill_ino_from_gfid (this, &stbuf);
@@ -1320,58 +1372,216 @@ janitor_walker (const char *fpath, const struct stat *sb,
 }
 
 
-static struct posix_fd *
-janitor_get_next_fd (xlator_t *this)
+/* The janitor and the health checks each have a few threads serving all
+ * the bricks of the process (with brick multiplexing there can be tens of
+ * them). A brick is taken up by one thread at a time, and a thread is kept
+ * free to take up the others, so a brick whose filesystem hangs holds one
+ * thread up, not the other bricks. Threads beyond the first that stay idle
+ * for POSIX_HELPER_IDLE seconds go away. */
+#define POSIX_HELPER_IDLE 60
+#define POSIX_HELPER_STOP_WAIT 10
+
+struct posix_helper {
+        pthread_mutex_t   lock;
+        pthread_cond_t    cond;
+        struct list_head  bricks;      /* posix_private */
+        int32_t           threads;
+        int32_t           busy;        /* threads taken up by a brick */
+        void           *(*proc) (void *);
+};
+
+static void
+posix_helper_init (struct posix_helper *helper, void *(*proc) (void *))
 {
-        struct posix_private *priv = NULL;
-        struct posix_fd *pfd = NULL;
+        pthread_mutex_init (&helper->lock, NULL);
+        pthread_cond_init (&helper->cond, NULL);
+        INIT_LIST_HEAD (&helper->bricks);
+        helper->proc = proc;
+}
 
-        struct timespec timeout;
+/* Called with helper->lock held, makes sure a thread is free. Returns the
+ * error of pthread_create () if a thread was needed and could not be
+ * started. */
+static int
+__posix_helper_spare (struct posix_helper *helper)
+{
+        pthread_t       thread;
+        int             ret = 0;
 
-        priv = this->private;
+        if (helper->threads > helper->busy)
+                return 0;
 
-        pthread_mutex_lock (&priv->janitor_lock);
-        {
-                if (list_empty (&priv->janitor_fds)) {
-                        time (&timeout.tv_sec);
-                        timeout.tv_sec += priv->janitor_sleep_duration;
-                        timeout.tv_nsec = 0;
-
-                        pthread_cond_timedwait (&priv->janitor_cond,
-                                                &priv->janitor_lock,
-                                                &timeout);
-                        goto unlock;
+        ret = gf_thread_create (&thread, NULL, helper->proc, helper);
+        if (ret != 0)
+                return ret;
+
+        pthread_detach (thread);
+        helper->threads++;
+        return 0;
+}
+
+/* Called with helper->lock held by a thread with nothing to do before
+ * @due (0 if there is nothing due at all). Returns _gf_true if the thread
+ * is to go away. */
+static gf_boolean_t
+__posix_helper_wait (struct posix_helper *helper, time_t due,
+                     time_t *idle_since)
+{
+        struct timespec timeout = {0, };
+        time_t          now     = 0;
+
+        time (&now);
+        if (!*idle_since)
+                *idle_since = now;
+
+        if ((helper->threads - helper->busy) > 1) {
+                if ((now - *idle_since) >= POSIX_HELPER_IDLE) {
+                        helper->threads--;
+                        /* the one staying on might have been waiting for
+                         * longer than what is due now */
+                        pthread_cond_broadcast (&helper->cond);
+                        return _gf_true;
                 }
+                if (!due || due > *idle_since + POSIX_HELPER_IDLE)
+                        due = *idle_since + POSIX_HELPER_IDLE;
+        }
 
-                pfd = list_entry (priv->janitor_fds.next, struct posix_fd,
-                                  list);
+        if (!due) {
+                pthread_cond_wait (&helper->cond, &helper->lock);
+        } else {
+                timeout.tv_sec = due;
+                pthread_cond_timedwait (&helper->cond, &helper->lock,
+                                        &timeout);
+        }
 
-                list_del (priv->janitor_fds.next);
+        return _gf_false;
+}
+
+/* Called with helper->lock held by fini, waits for up to
+ * POSIX_HELPER_STOP_WAIT seconds for a thread working on the brick to be
+ * done with it. A brick whose disk hangs must not hold up the detach of
+ * the others in the process: past that, the caller leaves the brick to
+ * the thread, which lets go of it once done. Returns *busy. */
+static gf_boolean_t
+__posix_helper_drain (struct posix_helper *helper, gf_boolean_t *busy)
+{
+        struct timespec timeout = {0, };
+
+        timeout.tv_sec = time (NULL) + POSIX_HELPER_STOP_WAIT;
+
+        while (*busy) {
+                if (pthread_cond_timedwait (&helper->cond, &helper->lock,
+                                            &timeout) == ETIMEDOUT)
+                        break;
         }
-unlock:
-        pthread_mutex_unlock (&priv->janitor_lock);
 
-        return pfd;
+        return *busy;
 }
 
+void
+posix_priv_put (struct posix_private *priv)
+{
+        if (GF_ATOMIC_DEC (priv->refs) == 0)
+                GF_FREE (priv);
+}
 
-static void *
-posix_janitor_thread_proc (void *data)
+
+static void *posix_janitor_thread_proc (void *data);
+
+static struct posix_helper posix_janitor;
+
+static pthread_once_t posix_janitor_once = PTHREAD_ONCE_INIT;
+
+static void
+posix_janitor_init (void)
 {
-        xlator_t *            this = NULL;
-        struct posix_private *priv = NULL;
-        struct posix_fd *pfd;
+        posix_helper_init (&posix_janitor, posix_janitor_thread_proc);
+}
 
-        time_t now;
+static void
+posix_janitor_close_fds (xlator_t *this, struct list_head *fds)
+{
+        struct posix_fd *pfd = NULL;
+        struct posix_fd *tmp = NULL;
 
-        this = data;
-        priv = this->private;
+        list_for_each_entry_safe (pfd, tmp, fds, list) {
+                list_del (&pfd->list);
+                if (pfd->dir == NULL) {
+                        gf_msg_trace (this->name, 0,
+                                "janitor: closing file fd=%d", pfd->fd);
+                        sys_close (pfd->fd);
+                } else {
+                        gf_msg_debug (this->name, 0, "janitor: closing"
+                                      " dir fd=%p", pfd->dir);
+                        sys_closedir (pfd->dir);
+                }
 
-        THIS = this;
+                GF_FREE (pfd);
+        }
+}
 
+/* closes the fds released on a brick and empties its landfill when due */
+static void *
+posix_janitor_thread_proc (void *data)
+{
+        xlator_t             *this       = NULL;
+        struct posix_private *priv       = NULL;
+        struct posix_private *tmp        = NULL;
+        gf_boolean_t          landfill   = _gf_false;
+        time_t                now        = 0;
+        time_t                due        = 0;
+        time_t                idle_since = 0;
+        struct list_head      fds;
+
+        INIT_LIST_HEAD (&fds);
+
+        pthread_mutex_lock (&posix_janitor.lock);
         while (1) {
                 time (&now);
-                if ((now - priv->last_landfill_check) > priv->janitor_sleep_duration) {
+                due = 0;
+                priv = NULL;
+
+                list_for_each_entry (tmp, &posix_janitor.bricks,
+                                     janitor_list) {
+                        if (tmp->janitor_busy)
+                                continue;
+                        if (!list_empty (&tmp->janitor_fds) ||
+                            (now - tmp->last_landfill_check) >
+                            tmp->janitor_sleep_duration) {
+                                priv = tmp;
+                                break;
+                        }
+                        if (!due ||
+                            tmp->last_landfill_check +
+                            tmp->janitor_sleep_duration < due)
+                                due = tmp->last_landfill_check +
+                                      tmp->janitor_sleep_duration;
+                }
+
+                if (!priv) {
+                        if (__posix_helper_wait (&posix_janitor, due,
+                                                 &idle_since))
+                                break;
+                        continue;
+                }
+                idle_since = 0;
+
+                /* the others get their turn before this one's next */
+                list_move_tail (&priv->janitor_list, &posix_janitor.bricks);
+                list_splice_init (&priv->janitor_fds, &fds);
+                landfill = ((now - priv->last_landfill_check) >
+                            priv->janitor_sleep_duration);
+                if (landfill)
+                        priv->last_landfill_check = now;
+                priv->janitor_busy = _gf_true;
+                posix_janitor.busy++;
+                (void) __posix_helper_spare (&posix_janitor);
+                pthread_mutex_unlock (&posix_janitor.lock);
+
+                this = priv->this;
+                THIS = this;
+
+                if (landfill) {
                         gf_msg_trace (this->name, 0,
                                       "janitor cleaning out %s",
                                       priv->trash_path);
@@ -1380,25 +1590,23 @@ posix_janitor_thread_proc (void *data)
                               janitor_walker,
                               32,
                               FTW_DEPTH | FTW_PHYS);
-
-                        priv->last_landfill_check = now;
                 }
 
-                pfd = janitor_get_next_fd (this);
-                if (pfd) {
-                        if (pfd->dir == NULL) {
-                                gf_msg_trace (this->name, 0,
-                                        "janitor: closing file fd=%d", pfd->fd);
-                                sys_close (pfd->fd);
-                        } else {
-                                gf_msg_debug (this->name, 0, "janitor: closing"
-                                              " dir fd=%p", pfd->dir);
-                                sys_closedir (pfd->dir);
-                        }
+                posix_janitor_close_fds (this, &fds);
 
-                        GF_FREE (pfd);
+                pthread_mutex_lock (&posix_janitor.lock);
+                posix_janitor.busy--;
+                if (priv->janitor_detached) {
+                        /* fini gave up waiting, the brick is gone */
+                        pthread_mutex_unlock (&posix_janitor.lock);
+                        posix_priv_put (priv);
+                        pthread_mutex_lock (&posix_janitor.lock);
+                        continue;
                 }
+                priv->janitor_busy = _gf_false;
+                pthread_cond_broadcast (&posix_janitor.cond);
         }
+        pthread_mutex_unlock (&posix_janitor.lock);
 
         return NULL;
 }
@@ -1408,28 +1616,108 @@ void
 posix_spawn_janitor_thread (xlator_t *this)
 {
         struct posix_private *priv = NULL;
-        int ret = 0;
+        int                   ret  = 0;
 
         priv = this->private;
 
-        LOCK (&priv->lock);
-        {
-                if (!priv->janitor_present) {
-                        ret = gf_thread_create (&priv->janitor, NULL,
-                                                posix_janitor_thread_proc, this);
+        (void) pthread_once (&posix_janitor_once, posix_janitor_init);
 
-                        if (ret < 0) {
-                                gf_msg (this->name, GF_LOG_ERROR, errno,
-                                        P_MSG_THREAD_FAILED, "spawning janitor "
-                                        "thread failed");
-                                goto unlock;
-                        }
+        pthread_mutex_lock (&posix_janitor.lock);
+        {
+                ret = __posix_helper_spare (&posix_janitor);
+                if (ret) {
+                        gf_msg (this->name, GF_LOG_ERROR, ret,
+                                P_MSG_THREAD_FAILED, "spawning janitor "
+                                "thread failed");
+                        goto unlock;
+                }
 
+                if (!priv->janitor_present) {
+                        list_add_tail (&priv->janitor_list,
+                                       &posix_janitor.bricks);
                         priv->janitor_present = _gf_true;
                 }
         }
 unlock:
-        UNLOCK (&priv->lock);
+        pthread_mutex_unlock (&posix_janitor.lock);
+}
+
+void
+posix_janitor_queue_fd (xlator_t *this, struct posix_fd *pfd)
+{
+        struct posix_private *priv = NULL;
+        struct list_head      fds;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&posix_janitor.lock);
+        {
+                INIT_LIST_HEAD (&pfd->list);
+                list_add_tail (&pfd->list, &priv->janitor_fds);
+                if (priv->janitor_present) {
+                        (void) __posix_helper_spare (&posix_janitor);
+                        pthread_cond_broadcast (&posix_janitor.cond);
+                }
+        }
+        pthread_mutex_unlock (&posix_janitor.lock);
+
+        /* nobody to hand it to */
+        if (!priv->janitor_present) {
+                INIT_LIST_HEAD (&fds);
+                pthread_mutex_lock (&posix_janitor.lock);
+                {
+                        list_splice_init (&priv->janitor_fds, &fds);
+                }
+                pthread_mutex_unlock (&posix_janitor.lock);
+                posix_janitor_close_fds (this, &fds);
+        }
+}
+
+void
+posix_janitor_wake (xlator_t *this)
+{
+        pthread_mutex_lock (&posix_janitor.lock);
+        {
+                pthread_cond_broadcast (&posix_janitor.cond);
+        }
+        pthread_mutex_unlock (&posix_janitor.lock);
+}
+
+/* Takes the brick off the janitor, closing what is left of its fds. A
+ * janitor thread still on the brick after POSIX_HELPER_STOP_WAIT seconds
+ * is left a reference of the private. */
+void
+posix_janitor_stop (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        struct list_head      fds;
+
+        priv = this->private;
+        INIT_LIST_HEAD (&fds);
+
+        (void) pthread_once (&posix_janitor_once, posix_janitor_init);
+
+        pthread_mutex_lock (&posix_janitor.lock);
+        {
+                if (__posix_helper_drain (&posix_janitor,
+                                          &priv->janitor_busy)) {
+                        gf_msg (this->name, GF_LOG_WARNING, ETIMEDOUT,
+                                P_MSG_THREAD_FAILED, "janitor still busy "
+                                "with the brick, leaving it to finish on "
+                                "its own");
+                        priv->janitor_detached = _gf_true;
+                        GF_ATOMIC_INC (priv->refs);
+                }
+
+                if (priv->janitor_present) {
+                        list_del_init (&priv->janitor_list);
+                        priv->janitor_present = _gf_false;
+                }
+                list_splice_init (&priv->janitor_fds, &fds);
+        }
+        pthread_mutex_unlock (&posix_janitor.lock);
+
+        posix_janitor_close_fds (this, &fds);
 }
 
 static int
@@ -1783,55 +2071,25 @@ out:
 
 }
 
-static void *
-posix_health_check_thread_proc (void *data)
-{
-        xlator_t             *this               = NULL;
-        struct posix_private *priv               = NULL;
-        uint32_t              interval           = 0;
-        int                   ret                = -1;
-
-        this = data;
-        priv = this->private;
-
-        /* prevent races when the interval is updated */
-        interval = priv->health_check_interval;
-        if (interval == 0)
-                goto out;
-
-        gf_msg_debug (this->name, 0, "health-check thread started, "
-                "interval = %d seconds", interval);
+/* Likewise, a few threads check the health of all the bricks, each at its
+ * own health-check-interval. */
+static void *posix_health_check_thread_proc (void *data);
 
-        while (1) {
-                /* aborting sleep() is a request to exit this thread, sleep()
-                 * will normally not return when cancelled */
-                ret = sleep (interval);
-                if (ret > 0)
-                        break;
+static struct posix_helper posix_health;
 
-                /* prevent thread errors while doing the health-check(s) */
-                pthread_setcancelstate (PTHREAD_CANCEL_DISABLE, NULL);
-
-                /* Do the health-check.*/
-                ret = posix_fs_health_check (this);
-                if (ret < 0)
-                        goto abort;
+static pthread_once_t posix_health_once = PTHREAD_ONCE_INIT;
 
-                pthread_setcancelstate (PTHREAD_CANCEL_ENABLE, NULL);
-        }
-
-out:
-        gf_msg_debug (this->name, 0, "health-check thread exiting");
-
-        LOCK (&priv->lock);
-        {
-                priv->health_check_active = _gf_false;
-        }
-        UNLOCK (&priv->lock);
+static void
+posix_health_init (void)
+{
+        posix_helper_init (&posix_health, posix_health_check_thread_proc);
+}
 
-        return NULL;
+static void
+posix_health_check_abort (xlator_t *this)
+{
+        int ret = -1;
 
-abort:
         /* health-check failed */
         gf_msg (this->name, GF_LOG_EMERG, 0, P_MSG_HEALTHCHECK_FAILED,
                 "health-check failed, going down");
@@ -1851,10 +2109,88 @@ abort:
                         "still alive! -> SIGKILL");
                 kill (getpid(), SIGKILL);
         }
+}
+
+static void *
+posix_health_check_thread_proc (void *data)
+{
+        xlator_t             *this       = NULL;
+        struct posix_private *priv       = NULL;
+        struct posix_private *tmp        = NULL;
+        time_t                now        = 0;
+        time_t                due        = 0;
+        time_t                idle_since = 0;
+        int                   ret        = -1;
+
+        pthread_mutex_lock (&posix_health.lock);
+        while (1) {
+                time (&now);
+                due = 0;
+                priv = NULL;
+
+                list_for_each_entry (tmp, &posix_health.bricks,
+                                     health_check_list) {
+                        if (tmp->health_check_busy)
+                                continue;
+                        if (tmp->health_check_due <= now) {
+                                priv = tmp;
+                                break;
+                        }
+                        if (!due || tmp->health_check_due < due)
+                                due = tmp->health_check_due;
+                }
+
+                if (!priv) {
+                        if (__posix_helper_wait (&posix_health, due,
+                                                 &idle_since))
+                                break;
+                        continue;
+                }
+                idle_since = 0;
+
+                priv->health_check_due = now + priv->health_check_interval;
+                priv->health_check_busy = _gf_true;
+                posix_health.busy++;
+                (void) __posix_helper_spare (&posix_health);
+                pthread_mutex_unlock (&posix_health.lock);
+
+                this = priv->this;
+                THIS = this;
+
+                /* Do the health-check.*/
+                ret = posix_fs_health_check (this);
+
+                pthread_mutex_lock (&posix_health.lock);
+                if (priv->health_check_detached) {
+                        /* fini gave up waiting, the brick is gone */
+                        posix_health.busy--;
+                        pthread_mutex_unlock (&posix_health.lock);
+                        posix_priv_put (priv);
+                        pthread_mutex_lock (&posix_health.lock);
+                        continue;
+                }
+                priv->health_check_busy = _gf_false;
+                pthread_cond_broadcast (&posix_health.cond);
+
+                if (ret < 0) {
+                        list_del_init (&priv->health_check_list);
+                        priv->health_check_active = _gf_false;
+                        pthread_mutex_unlock (&posix_health.lock);
+
+                        /* takes the whole process down */
+                        posix_health_check_abort (this);
+
+                        pthread_mutex_lock (&posix_health.lock);
+                }
+                posix_health.busy--;
+        }
+        pthread_mutex_unlock (&posix_health.lock);
 
         return NULL;
 }
 
+/* (Re)schedules the health checks of the brick after an interval change,
+ * starting a thread doing them if need be. */
 void
 posix_spawn_health_check_thread (xlator_t *xl)
 {
@@ -1863,11 +2199,12 @@ posix_spawn_health_check_thread (xlator_t *xl)
 
         priv = xl->private;
 
-        LOCK (&priv->lock);
+        (void) pthread_once (&posix_health_once, posix_health_init);
+
+        pthread_mutex_lock (&posix_health.lock);
         {
-                /* cancel the running thread  */
                 if (priv->health_check_active == _gf_true) {
-                        pthread_cancel (priv->health_check);
+                        list_del_init (&priv->health_check_list);
                         priv->health_check_active = _gf_false;
                 }
 
@@ -1875,23 +2212,59 @@ posix_spawn_health_check_thread (xlator_t *xl)
                 if (priv->health_check_interval == 0)
                         goto unlock;
 
-                ret = gf_thread_create (&priv->health_check, NULL,
-                                        posix_health_check_thread_proc, xl);
-                if (ret < 0) {
+                ret = __posix_helper_spare (&posix_health);
+                if (ret) {
                         priv->health_check_interval = 0;
-                        priv->health_check_active = _gf_false;
-                        gf_msg (xl->name, GF_LOG_ERROR, errno,
+                        gf_msg (xl->name, GF_LOG_ERROR, ret,
                                 P_MSG_HEALTHCHECK_FAILED,
                                 "unable to setup health-check thread");
                         goto unlock;
                 }
 
-                /* run the thread detached, resources will be freed on exit */
-                pthread_detach (priv->health_check);
+                gf_msg_debug (xl->name, 0, "health-check scheduled, "
+                              "interval = %d seconds",
+                              priv->health_check_interval);
+
+                priv->health_check_due = time (NULL) +
+                                         priv->health_check_interval;
+                list_add_tail (&priv->health_check_list, &posix_health.bricks);
                 priv->health_check_active = _gf_true;
+                pthread_cond_broadcast (&posix_health.cond);
         }
 unlock:
-        UNLOCK (&priv->lock);
+        pthread_mutex_unlock (&posix_health.lock);
+}
+
+/* Takes the brick off the health checks, waiting for one under way for up
+ * to POSIX_HELPER_STOP_WAIT seconds, past which the check is left a
+ * reference of the private. */
+void
+posix_health_check_stop (xlator_t *xl)
+{
+        struct posix_private *priv = NULL;
+
+        priv = xl->private;
+
+        (void) pthread_once (&posix_health_once, posix_health_init);
+
+        pthread_mutex_lock (&posix_health.lock);
+        {
+                if (__posix_helper_drain (&posix_health,
+                                          &priv->health_check_busy)) {
+                        gf_msg (xl->name, GF_LOG_WARNING, ETIMEDOUT,
+                                P_MSG_HEALTHCHECK_FAILED, "health-check "
+                                "still under way, leaving it to finish on "
+                                "its own");
+                        priv->health_check_detached = _gf_true;
+                        GF_ATOMIC_INC (priv->refs);
+                }
+
+                if (priv->health_check_active) {
+                        list_del_init (&priv->health_check_list);
+                        priv->health_check_active = _gf_false;
+                }
+        }
+        pthread_mutex_unlock (&posix_health.lock);
 }
 
 int
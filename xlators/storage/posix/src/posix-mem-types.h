@@ -22,6 +22,8 @@ enum gf_posix_mem_types_ {
         gf_posix_mt_trash_path,
 	gf_posix_mt_paiocb,
         gf_posix_mt_inode_ctx_t,
+        gf_posix_mt_handle_cache_t,
+        gf_posix_mt_handle_cache_entry_t,
         gf_posix_mt_end
 };
 #endif
@@ -1198,8 +1198,6 @@ posix_releasedir (xlator_t *this,
         uint64_t          tmp_pfd  = 0;
         int               ret      = 0;
 
-        struct posix_private *priv = NULL;
-
         VALIDATE_OR_GOTO (this, out);
         VALIDATE_OR_GOTO (fd, out);
 
@@ -1216,15 +1214,7 @@ posix_releasedir (xlator_t *this,
                 goto out;
         }
 
-        priv = this->private;
-
-        pthread_mutex_lock (&priv->janitor_lock);
-        {
-                INIT_LIST_HEAD (&pfd->list);
-                list_add_tail (&pfd->list, &priv->janitor_fds);
-                pthread_cond_signal (&priv->janitor_cond);
-        }
-        pthread_mutex_unlock (&priv->janitor_lock);
+        posix_janitor_queue_fd (this, pfd);
 
 out:
         return 0;
@@ -2114,6 +2104,8 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        posix_handle_cache_forget (this, loc->pargfid, loc->name);
+
         if (fdstat_requested) {
                 op_ret = posix_fdstat (this, fd, &postbuf);
                 if (op_ret == -1) {
@@ -2221,7 +2213,7 @@ posix_rmdir (call_frame_t *frame, xlator_t *this,
                         (void) snprintf (tmp_path, sizeof(tmp_path), "%s/%s",
                                          priv->trash_path, gfid_str);
                         op_ret = sys_rename (real_path, tmp_path);
-                        pthread_cond_signal (&priv->janitor_cond);
+                        posix_janitor_wake (this);
                 }
         } else {
                 op_ret = sys_rmdir (real_path);
@@ -2230,6 +2222,11 @@ posix_rmdir (call_frame_t *frame, xlator_t *this,
 
         if (op_ret == 0) {
                 posix_handle_unset (this, stbuf.ia_gfid, NULL);
+                posix_handle_cache_forget (this, loc->pargfid, loc->name);
+                /* what was below it went to the landfill with it */
+                if (flags)
+                        posix_handle_cache_forget_dir (this, stbuf.ia_gfid,
+                                                       _gf_true);
         }
 
         if (op_errno == EEXIST)
@@ -2637,6 +2634,12 @@ unlock:
                 goto out;
         }
 
+        posix_handle_cache_forget (this, oldloc->pargfid, oldloc->name);
+        posix_handle_cache_forget (this, newloc->pargfid, newloc->name);
+        if (IA_ISDIR (oldloc->inode->ia_type))
+                posix_handle_cache_forget_dir (this, oldloc->inode->gfid,
+                                               _gf_false);
+
         if (was_dir)
                 posix_handle_unset (this, victim, NULL);
 
@@ -3650,13 +3653,7 @@ posix_release (xlator_t *this, fd_t *fd)
                         pfd->dir, fd);
         }
 
-        pthread_mutex_lock (&priv->janitor_lock);
-        {
-                INIT_LIST_HEAD (&pfd->list);
-                list_add_tail (&pfd->list, &priv->janitor_fds);
-                pthread_cond_signal (&priv->janitor_cond);
-        }
-        pthread_mutex_unlock (&priv->janitor_lock);
+        posix_janitor_queue_fd (this, pfd);
 
         LOCK (&priv->lock);
         {
@@ -6287,80 +6284,317 @@ posix_d_type_from_ia_type (ia_type_t type)
 #endif
 
 
-int
-posix_readdirp_fill (xlator_t *this, fd_t *fd, gf_dirent_t *entries, dict_t *dict)
+/* One readdirp worth of entries, shared between the io-thread serving
+ * it and any readdirp helpers. Entries are claimed one at a time under
+ * posix_rdp.lock and filled in place, so the reply keeps the directory
+ * order.
+ */
+typedef struct {
+        struct list_head  list;     /* on posix_rdp.batches until claimed */
+        xlator_t         *this;
+        fd_t             *fd;
+        dict_t           *dict;
+        int               dirfd;
+        char             *prefix;   /* path of the directory, with '/' */
+        int               prefix_len;
+        gf_dirent_t     **entries;
+        int               count;
+        int               next;
+        int               active;   /* helpers working on it */
+        int               helpers;  /* most helpers it may take */
+} posix_rdp_batch_t;
+
+/* below this many entries the hand-off costs more than it saves */
+#define POSIX_RDP_MIN_BATCH 16
+
+/* The readdirp helpers serve all the bricks of the process. They are
+ * started as batches come in, up to the largest readdirp-threads of the
+ * bricks asking, and go away after POSIX_RDP_IDLE seconds without work.
+ * A brick never has to stop them: posix_readdirp_fill () does not return
+ * before every helper is done with its batch. */
+#define POSIX_RDP_IDLE 60
+
+static struct {
+        pthread_mutex_t   lock;
+        pthread_cond_t    cond;
+        pthread_cond_t    done;
+        struct list_head  batches;  /* posix_rdp_batch_t */
+        uint32_t          threads;
+} posix_rdp;
+
+static pthread_once_t posix_rdp_once = PTHREAD_ONCE_INIT;
+
+static void
+posix_rdp_init (void)
+{
+        pthread_mutex_init (&posix_rdp.lock, NULL);
+        pthread_cond_init (&posix_rdp.cond, NULL);
+        pthread_cond_init (&posix_rdp.done, NULL);
+        INIT_LIST_HEAD (&posix_rdp.batches);
+}
+
+
+static void
+posix_readdirp_fill_entry (posix_rdp_batch_t *batch, char *path,
+                           gf_dirent_t *entry)
 {
-        gf_dirent_t     *entry    = NULL;
+        xlator_t        *this     = batch->this;
+        fd_t            *fd       = batch->fd;
         inode_table_t   *itable   = NULL;
 	inode_t         *inode    = NULL;
-	char            *hpath    = NULL;
-	int              len      = 0;
         struct iatt      stbuf    = {0, };
 	uuid_t           gfid;
         int              ret      = -1;
 
-	if (list_empty(&entries->list))
-		return 0;
-
         itable = fd->inode->table;
 
-	len = posix_handle_path (this, fd->inode->gfid, NULL, NULL, 0);
-        if (len <= 0)
-                return -1;
-	hpath = alloca (len + 256); /* NAME_MAX */
-	if (posix_handle_path (this, fd->inode->gfid, NULL, hpath, len) <= 0)
-                return -1;
-	len = strlen (hpath);
-	hpath[len] = '/';
+	memset (gfid, 0, 16);
+	inode = inode_grep (itable, fd->inode, entry->d_name);
+	if (inode)
+		gf_uuid_copy (gfid, inode->gfid);
+
+	strcpy (&path[batch->prefix_len], entry->d_name);
+
+        ret = posix_pstatat (this, batch->dirfd, entry->d_name, gfid,
+                             fd->inode->gfid, path, &stbuf);
+        if (ret == -1) {
+                if (inode)
+                        inode_unref (inode);
+                return;
+        }
 
-        list_for_each_entry (entry, &entries->list, list) {
-		memset (gfid, 0, 16);
-		inode = inode_grep (fd->inode->table, fd->inode,
-				    entry->d_name);
-		if (inode)
-			gf_uuid_copy (gfid, inode->gfid);
+	if (!inode)
+		inode = inode_find (itable, stbuf.ia_gfid);
 
-		strcpy (&hpath[len+1], entry->d_name);
+	if (!inode)
+		inode = inode_new (itable);
 
-                ret = posix_pstat (this, gfid, hpath, &stbuf);
+	entry->inode = inode;
 
-                if (ret == -1) {
-                        if (inode)
-                                inode_unref (inode);
-                      continue;
+        if (batch->dict) {
+                entry->dict =
+                        posix_entry_xattr_fill (this, entry->inode,
+                                                fd, path,
+                                                batch->dict, &stbuf);
+        }
+
+        entry->d_stat = stbuf;
+        if (stbuf.ia_ino)
+                entry->d_ino = stbuf.ia_ino;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+        if (entry->d_type == DT_UNKNOWN && !IA_ISINVAL(stbuf.ia_type)) {
+                /* The platform supports d_type but the underlying
+                   filesystem doesn't. We set d_type to the correct
+                   value from ia_type */
+                entry->d_type =
+                        posix_d_type_from_ia_type (stbuf.ia_type);
+        }
+#endif
+}
+
+
+static void
+posix_readdirp_fill_batch (posix_rdp_batch_t *batch)
+{
+        gf_dirent_t          *entry = NULL;
+        char                 *path  = NULL;
+
+        path = alloca (batch->prefix_len + NAME_MAX + 1);
+        memcpy (path, batch->prefix, batch->prefix_len);
+
+        for (;;) {
+                entry = NULL;
+
+                pthread_mutex_lock (&posix_rdp.lock);
+                {
+                        if (batch->next < batch->count)
+                                entry = batch->entries[batch->next++];
+                        if (batch->next == batch->count)
+                                list_del_init (&batch->list);
                 }
+                pthread_mutex_unlock (&posix_rdp.lock);
 
-		if (!inode)
-			inode = inode_find (itable, stbuf.ia_gfid);
+                if (!entry)
+                        break;
 
-		if (!inode)
-			inode = inode_new (itable);
+                posix_readdirp_fill_entry (batch, path, entry);
+        }
+}
 
-		entry->inode = inode;
 
-                if (dict) {
-                        entry->dict =
-                                posix_entry_xattr_fill (this, entry->inode,
-                                                        fd, hpath,
-                                                        dict, &stbuf);
+static void *
+posix_readdirp_helper (void *data)
+{
+        posix_rdp_batch_t    *batch   = NULL;
+        posix_rdp_batch_t    *tmp     = NULL;
+        gf_boolean_t          idle    = _gf_false;
+        struct timespec       timeout = {0, };
+
+        pthread_mutex_lock (&posix_rdp.lock);
+        while (1) {
+                batch = NULL;
+                list_for_each_entry (tmp, &posix_rdp.batches, list) {
+                        if (tmp->active < tmp->helpers) {
+                                batch = tmp;
+                                break;
+                        }
                 }
 
-                entry->d_stat = stbuf;
-                if (stbuf.ia_ino)
-                        entry->d_ino = stbuf.ia_ino;
+                if (!batch) {
+                        if (idle) {
+                                posix_rdp.threads--;
+                                break;
+                        }
+                        timeout.tv_sec = time (NULL) + POSIX_RDP_IDLE;
+                        if (pthread_cond_timedwait (&posix_rdp.cond,
+                                                    &posix_rdp.lock,
+                                                    &timeout) == ETIMEDOUT)
+                                idle = _gf_true;
+                        continue;
+                }
+                idle = _gf_false;
 
-#ifdef _DIRENT_HAVE_D_TYPE
-                if (entry->d_type == DT_UNKNOWN && !IA_ISINVAL(stbuf.ia_type)) {
-                        /* The platform supports d_type but the underlying
-                           filesystem doesn't. We set d_type to the correct
-                           value from ia_type */
-                        entry->d_type =
-                                posix_d_type_from_ia_type (stbuf.ia_type);
+                batch->active++;
+                pthread_mutex_unlock (&posix_rdp.lock);
+
+                THIS = batch->this;
+                posix_readdirp_fill_batch (batch);
+
+                pthread_mutex_lock (&posix_rdp.lock);
+                if (--batch->active == 0)
+                        pthread_cond_broadcast (&posix_rdp.done);
+        }
+        pthread_mutex_unlock (&posix_rdp.lock);
+
+        return NULL;
+}
+
+
+/* Returns how many helpers are up to take a share of a batch. */
+static int
+posix_readdirp_helpers (xlator_t *this)
+{
+        struct posix_private *priv   = this->private;
+        pthread_t             thread;
+        int                   ret    = 0;
+
+        pthread_mutex_lock (&posix_rdp.lock);
+        {
+                while (posix_rdp.threads < priv->readdirp_threads) {
+                        ret = gf_thread_create (&thread, NULL,
+                                                posix_readdirp_helper, NULL);
+                        if (ret) {
+                                gf_msg (this->name, GF_LOG_WARNING, ret,
+                                        P_MSG_THREAD_FAILED, "readdirp helper "
+                                        "thread creation failed");
+                                break;
+                        }
+                        pthread_detach (thread);
+                        posix_rdp.threads++;
                 }
-#endif
 
-		inode = NULL;
+                ret = min (posix_rdp.threads, priv->readdirp_threads);
+        }
+        pthread_mutex_unlock (&posix_rdp.lock);
+
+        return ret;
+}
+
+
+int
+posix_readdirp_fill (xlator_t *this, fd_t *fd, DIR *dir, gf_dirent_t *entries,
+                     dict_t *dict)
+{
+        struct posix_private *priv     = this->private;
+        posix_rdp_batch_t     batch    = {{0, }, };
+        gf_dirent_t          *entry    = NULL;
+	char                 *hpath    = NULL;
+	int                   len      = 0;
+        int                   count    = 0;
+        int                   i        = 0;
+
+	if (list_empty(&entries->list))
+		return 0;
+
+        INIT_LIST_HEAD (&batch.list);
+        batch.this = this;
+        batch.fd = fd;
+        batch.dict = dict;
+        batch.dirfd = dirfd (dir);
+
+        /* Through the open directory fd the lookup of every entry is a
+           single step, where the handle path of a directory resolves its
+           whole chain of parent handles.  The brick root needs neither. */
+        if (__is_root_gfid (fd->inode->gfid)) {
+                batch.prefix = alloca (priv->base_path_length + 2);
+                batch.prefix_len = sprintf (batch.prefix, "%s/",
+                                            priv->base_path);
+        } else if (priv->proc_fd_paths) {
+                batch.prefix = alloca (64);
+                batch.prefix_len = snprintf (batch.prefix, 64,
+                                             "/proc/self/fd/%d/",
+                                             batch.dirfd);
+        } else {
+                len = posix_handle_path (this, fd->inode->gfid, NULL,
+                                         NULL, 0);
+                if (len <= 0)
+                        return -1;
+                hpath = alloca (len + 1);
+                if (posix_handle_path (this, fd->inode->gfid, NULL, hpath,
+                                       len) <= 0)
+                        return -1;
+                len = strlen (hpath);
+                hpath[len] = '/';
+                batch.prefix = hpath;
+                batch.prefix_len = len + 1;
+        }
+
+        list_for_each_entry (entry, &entries->list, list)
+                count++;
+
+        if (count >= POSIX_RDP_MIN_BATCH && priv->readdirp_threads)
+                batch.entries = GF_CALLOC (count, sizeof (*batch.entries),
+                                           gf_common_mt_pointer);
+
+        if (!batch.entries) {
+                /* one at a time, straight from the list */
+                len = batch.prefix_len;
+                hpath = alloca (len + NAME_MAX + 1);
+                memcpy (hpath, batch.prefix, len);
+
+                list_for_each_entry (entry, &entries->list, list)
+                        posix_readdirp_fill_entry (&batch, hpath, entry);
+
+                return 0;
+        }
+
+        (void) pthread_once (&posix_rdp_once, posix_rdp_init);
+
+        list_for_each_entry (entry, &entries->list, list)
+                batch.entries[i++] = entry;
+        batch.count = count;
+        batch.helpers = posix_readdirp_helpers (this);
+
+        if (batch.helpers) {
+                pthread_mutex_lock (&posix_rdp.lock);
+                {
+                        list_add_tail (&batch.list, &posix_rdp.batches);
+                        pthread_cond_broadcast (&posix_rdp.cond);
+                }
+                pthread_mutex_unlock (&posix_rdp.lock);
+        }
+
+        posix_readdirp_fill_batch (&batch);
+
+        pthread_mutex_lock (&posix_rdp.lock);
+        {
+                while (batch.active)
+                        pthread_cond_wait (&posix_rdp.done, &posix_rdp.lock);
         }
+        pthread_mutex_unlock (&posix_rdp.lock);
+
+        GF_FREE (batch.entries);
 
 	return 0;
 }
@@ -6431,7 +6665,7 @@ posix_do_readdir (call_frame_t *frame, xlator_t *this,
         if (whichop != GF_FOP_READDIRP)
                 goto out;
 
-	posix_readdirp_fill (this, fd, &entries, dict);
+	posix_readdirp_fill (this, fd, dir, &entries, dict);
 
 out:
         STACK_UNWIND_STRICT (readdir, frame, op_ret, op_errno, &entries, NULL);
@@ -6508,6 +6742,10 @@ posix_priv (xlator_t *this)
         gf_proc_dump_write("max_read","%d", priv->read_value);
         gf_proc_dump_write("max_write","%d", priv->write_value);
         gf_proc_dump_write("nr_files","%ld", priv->nr_files);
+        gf_proc_dump_write("readdirp_threads", "%u", priv->readdirp_threads);
+        gf_proc_dump_write("readdirp_helpers_running", "%u",
+                           posix_rdp.threads);
+        posix_handle_cache_dump (this);
 
         return 0;
 }
@@ -6736,6 +6974,7 @@ struct posix_private *priv = NULL;
         int32_t               uid = -1;
         int32_t               gid = -1;
 	char                 *batch_fsync_mode_str = NULL;
+        uint32_t              handle_cache_size = 0;
 
 	priv = this->private;
 
@@ -6793,6 +7032,17 @@ struct posix_private *priv = NULL;
                         " fallback to <hostname>:<export>");
         }
 
+        GF_OPTION_RECONF ("readdirp-threads", priv->readdirp_threads,
+                          options, uint32, out);
+
+        GF_OPTION_RECONF ("handle-cache-size", handle_cache_size, options,
+                          uint32, out);
+        if (handle_cache_size != priv->handle_cache_size) {
+                if (posix_handle_cache_init (this, handle_cache_size))
+                        goto out;
+                priv->handle_cache_size = handle_cache_size;
+        }
+
         GF_OPTION_RECONF ("health-check-interval", priv->health_check_interval,
                           options, uint32, out);
         posix_spawn_health_check_thread (this);
@@ -6979,6 +7229,8 @@ init (xlator_t *this)
                 ret = -1;
                 goto out;
         }
+        _private->this = this;
+        GF_ATOMIC_INIT (_private->refs, 1);
 
         _private->base_path = gf_strdup (dir_data->data);
         _private->base_path_length = strlen (_private->base_path);
@@ -7377,17 +7629,32 @@ init (xlator_t *this)
         }
 
         _private->health_check_active = _gf_false;
+        INIT_LIST_HEAD (&_private->health_check_list);
         GF_OPTION_INIT ("health-check-interval",
                         _private->health_check_interval, uint32, out);
         if (_private->health_check_interval)
                 posix_spawn_health_check_thread (this);
 
-        pthread_mutex_init (&_private->janitor_lock, NULL);
-        pthread_cond_init (&_private->janitor_cond, NULL);
         INIT_LIST_HEAD (&_private->janitor_fds);
+        INIT_LIST_HEAD (&_private->janitor_list);
 
         posix_spawn_janitor_thread (this);
 
+        GF_OPTION_INIT ("readdirp-threads", _private->readdirp_threads,
+                        uint32, out);
+#ifdef GF_LINUX_HOST_OS
+        _private->proc_fd_paths = (sys_access ("/proc/self/fd", X_OK) == 0);
+#endif
+
+        pthread_mutex_init (&_private->handle_cache.lock, NULL);
+        INIT_LIST_HEAD (&_private->handle_cache.lru);
+        GF_OPTION_INIT ("handle-cache-size", _private->handle_cache_size,
+                        uint32, out);
+        if (posix_handle_cache_init (this, _private->handle_cache_size)) {
+                ret = -1;
+                goto out;
+        }
+
 	pthread_mutex_init (&_private->fsync_mutex, NULL);
 	pthread_cond_init (&_private->fsync_cond, NULL);
 	INIT_LIST_HEAD (&_private->fsyncs);
@@ -7436,11 +7703,15 @@ fini (xlator_t *this)
         struct posix_private *priv = this->private;
         if (!priv)
                 return;
+        posix_health_check_stop (this);
+        posix_janitor_stop (this);
+        posix_handle_cache_fini (this);
         this->private = NULL;
         /*unlock brick dir*/
         if (priv->mount_lock)
                 (void) sys_closedir (priv->mount_lock);
-        GF_FREE (priv);
+        priv->mount_lock = NULL;
+        posix_priv_put (priv);
         return;
 }
 struct xlator_dumpops dumpops = {
@@ -7582,6 +7853,25 @@ struct volume_options options[] = {
 	  "\t- reverse-fsync: Perform fsync() of each file in the batch in"
 	  " reverse order."
 	},
+        { .key = {"readdirp-threads"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = POSIX_RDP_MAX_THREADS,
+          .default_value = "4",
+          .description = "Number of helper threads which stat the entries "
+          "of a large readdirp, and fetch their xattrs, in parallel with the "
+          "thread serving the request. The helpers are shared by all the "
+          "bricks of the process. 0 fills entries one by one."
+        },
+        { .key = {"handle-cache-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 4194304,
+          .default_value = "65536",
+          .description = "Number of entry gfids and directory paths the "
+          "brick remembers, so that lookups need not read them again from "
+          "the gfid xattr and the handle symlinks. 0 disables the cache."
+        },
 	{ .key = {"batch-fsync-delay-usec"},
 	  .type = GF_OPTION_TYPE_INT,
 	  .default_value = "0",
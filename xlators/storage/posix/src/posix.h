@@ -77,11 +77,16 @@ struct posix_fd {
 };
 
 
+/* most helpers one brick will run for readdirp */
+#define POSIX_RDP_MAX_THREADS 16
+
 struct posix_private {
 	char   *base_path;
 	int32_t base_path_length;
 	int32_t path_max;
 
+        xlator_t *this;
+
         gf_lock_t lock;
 
         char   *hostname;
@@ -92,9 +97,10 @@ struct posix_private {
 
         time_t last_landfill_check;
         int32_t janitor_sleep_duration;
+        /* under the lock of the janitor shared by all the bricks */
         struct list_head janitor_fds;
-        pthread_cond_t janitor_cond;
-        pthread_mutex_t janitor_lock;
+        struct list_head janitor_list;
+        gf_boolean_t     janitor_busy;    /* a janitor thread is on it */
 
 	int64_t read_value;    /* Total read, from init */
 	int64_t write_value;   /* Total write, from init */
@@ -121,8 +127,7 @@ struct posix_private {
 */
         gf_boolean_t    background_unlink;
 
-/* janitor thread which cleans up /.trash (created by replicate) */
-        pthread_t       janitor;
+/* janitor which cleans up /.trash (created by replicate) */
         gf_boolean_t    janitor_present;
         char *          trash_path;
 /* lock for brick dir */
@@ -161,10 +166,27 @@ struct posix_private {
 	uint32_t        batch_fsync_delay_usec;
         gf_boolean_t    update_pgfid_nlinks;
 
+        /* how many of the process-wide readdirp helpers may stat and
+           fill entries alongside the io-thread serving a readdirp */
+        uint32_t          readdirp_threads;
+        /* entries can be reached as /proc/self/fd/<dirfd>/<name> */
+        gf_boolean_t      proc_fd_paths;
+
+        uint32_t                   handle_cache_size;
+        struct posix_handle_cache  handle_cache;
+
         /* seconds to sleep between health checks */
         uint32_t        health_check_interval;
-        pthread_t       health_check;
+        time_t          health_check_due;
+        struct list_head health_check_list;
         gf_boolean_t    health_check_active;
+        gf_boolean_t    health_check_busy;
+
+        /* fini, plus the janitor or health check thread fini stopped
+         * waiting for: the last one to let go frees the private */
+        gf_atomic_t     refs;
+        gf_boolean_t    janitor_detached;
+        gf_boolean_t    health_check_detached;
 
 #ifdef GF_DARWIN_HOST_OS
         enum {
@@ -243,6 +265,10 @@ int posix_istat (xlator_t *this, uuid_t gfid, const char *basename,
                  struct iatt *iatt);
 int posix_pstat (xlator_t *this, uuid_t gfid, const char *real_path,
                  struct iatt *iatt);
+int posix_pstat_entry (xlator_t *this, uuid_t pargfid, const char *path,
+                       struct iatt *iatt);
+int posix_pstatat (xlator_t *this, int dirfd, const char *name, uuid_t gfid,
+                   uuid_t pargfid, const char *path, struct iatt *iatt);
 dict_t *posix_xattr_fill (xlator_t *this, const char *path, loc_t *loc,
                           fd_t *fd, int fdnum, dict_t *xattr, struct iatt *buf);
 int posix_handle_pair (xlator_t *this, const char *real_path, char *key,
@@ -250,6 +276,10 @@ int posix_handle_pair (xlator_t *this, const char *real_path, char *key,
 int posix_fhandle_pair (xlator_t *this, int fd, char *key, data_t *value,
                         int flags, struct iatt *stbuf);
 void posix_spawn_janitor_thread (xlator_t *this);
+void posix_janitor_queue_fd (xlator_t *this, struct posix_fd *pfd);
+void posix_janitor_wake (xlator_t *this);
+void posix_janitor_stop (xlator_t *this);
+void posix_priv_put (struct posix_private *priv);
 int posix_get_file_contents (xlator_t *this, uuid_t pargfid,
                              const char *name, char **contents);
 int posix_set_file_contents (xlator_t *this, const char *path, char *key,
@@ -269,6 +299,7 @@ void
 __posix_fd_set_odirect (fd_t *fd, struct posix_fd *pfd, int opflags,
 			off_t offset, size_t size);
 void posix_spawn_health_check_thread (xlator_t *this);
+void posix_health_check_stop (xlator_t *this);
 
 void *posix_fsyncer (void *);
 int